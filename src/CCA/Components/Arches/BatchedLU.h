@@ -0,0 +1,279 @@
+#ifndef Uintah_Components_Arches_BatchedLU_h
+#define Uintah_Components_Arches_BatchedLU_h
+
+#include <cmath>
+
+/**
+  * @class    BatchedLU
+  *
+  * @brief    LU decomposition and back-substitution of a block of WIDTH small dense
+  *           systems that all have the same (compile time) dimension DIM, e.g. the
+  *           DQMOM systems of WIDTH neighboring cells.
+  *
+  * @details  The matrices are stored structure-of-arrays, A[row][col][lane], so every
+  *           loop over the systems of the block is innermost, unit stride and free
+  *           of branches, and the compiler can vectorize it.  The only step done
+  *           lane by lane is the row interchange of the partial pivoting.
+  *
+  *           The arithmetic is that of LU (Crout's method with implicit scaling and
+  *           partial pivoting), in the same order, so each lane gets the factors and
+  *           the solution LU gets for that system.  As in LU, a system with a row of
+  *           zeros is flagged singular and its solution is zero; a zero pivot is
+  *           replaced by a tiny value.
+  *
+  *           Fill A, call padLanes() if fewer than WIDTH systems were set, then
+  *           decompose() and back_subs().
+  */
+
+namespace Uintah {
+
+template <int DIM, int WIDTH = 8>
+class BatchedLU {
+  public:
+
+    enum { dimension = DIM, width = WIDTH };
+
+    /** @brief            Sets the systems of lanes [nlanes, WIDTH) to the identity, so a
+      *                   partially filled block decomposes without floating point exceptions
+      * @param nlanes     Number of lanes that hold a system */
+    void padLanes( const int nlanes )
+    {
+      for( int i = 0; i < DIM; ++i ) {
+        for( int j = 0; j < DIM; ++j ) {
+          for( int l = nlanes; l < WIDTH; ++l ) {
+            A[i][j][l] = ( i == j ) ? 1.0 : 0.0;
+          }
+        }
+      }
+    }
+
+    /** @brief      Performs the LU decomposition of every lane using Crout's method with partial pivoting. */
+    void decompose()
+    {
+      const double tiny = 1e-10;
+      double vv[DIM][WIDTH];
+
+      // loop over rows to get the implicit scaling information
+      for( int l = 0; l < WIDTH; ++l ) {
+        singular[l] = false;
+      }
+      for( int i = 0; i < DIM; ++i ) {
+        double big[WIDTH];
+        for( int l = 0; l < WIDTH; ++l ) {
+          big[l] = 0.0;
+        }
+        for( int j = 0; j < DIM; ++j ) {
+          for( int l = 0; l < WIDTH; ++l ) {
+            const double temp = std::fabs( A[i][j][l] );
+            big[l] = ( temp > big[l] ) ? temp : big[l];
+          }
+        }
+        for( int l = 0; l < WIDTH; ++l ) {
+          singular[l] = singular[l] || ( big[l] == 0.0 );
+          vv[i][l] = 1.0 / ( ( big[l] == 0.0 ) ? 1.0 : big[l] );
+        }
+      }
+
+      // LU stops at a singular matrix; here the lane is given the identity instead
+      for( int l = 0; l < WIDTH; ++l ) {
+        if( singular[l] ) {
+          for( int i = 0; i < DIM; ++i ) {
+            for( int j = 0; j < DIM; ++j ) {
+              A[i][j][l] = ( i == j ) ? 1.0 : 0.0;
+            }
+            vv[i][l] = 1.0;
+          }
+        }
+      }
+
+      // Loop over columns for Crout's method
+      for( int j = 0; j < DIM; ++j ) {
+
+        // Inner loop 1: solve for elements of U (don't do i=j)
+        for( int i = 0; i < j; ++i ) {
+          double sum[WIDTH];
+          for( int l = 0; l < WIDTH; ++l ) {
+            sum[l] = A[i][j][l];
+          }
+          for( int k = 0; k < i; ++k ) {
+            for( int l = 0; l < WIDTH; ++l ) {
+              sum[l] -= A[i][k][l] * A[k][j][l];
+            }
+          }
+          for( int l = 0; l < WIDTH; ++l ) {
+            A[i][j][l] = sum[l];
+          }
+        }
+
+        // Inner loop 2: solve for elements of L (include i=j), and find the biggest pivot element
+        double big[WIDTH];
+        int    imax[WIDTH];
+        for( int l = 0; l < WIDTH; ++l ) {
+          big[l]  = 0.0;
+          imax[l] = j;
+        }
+        for( int i = j; i < DIM; ++i ) {
+          double sum[WIDTH];
+          for( int l = 0; l < WIDTH; ++l ) {
+            sum[l] = A[i][j][l];
+          }
+          for( int k = 0; k < j; ++k ) {
+            for( int l = 0; l < WIDTH; ++l ) {
+              sum[l] -= A[i][k][l] * A[k][j][l];
+            }
+          }
+          for( int l = 0; l < WIDTH; ++l ) {
+            A[i][j][l] = sum[l];
+            const double dum = vv[i][l] * std::fabs( sum[l] );
+            const bool better = ( dum >= big[l] );
+            big[l]  = better ? dum : big[l];
+            imax[l] = better ? i   : imax[l];
+          }
+        }
+
+        // Inner loop 3: interchange rows where needed (lane by lane)
+        for( int l = 0; l < WIDTH; ++l ) {
+          const int p = imax[l];
+          if( p != j ) {
+            for( int k = 0; k < DIM; ++k ) {
+              const double dum = A[p][k][l];
+              A[p][k][l] = A[j][k][l];
+              A[j][k][l] = dum;
+            }
+            vv[p][l] = vv[j][l];
+          }
+          indx[j][l] = p;
+        }
+
+        // Inner loop 4: replace zero w/ tiny value
+        for( int l = 0; l < WIDTH; ++l ) {
+          A[j][j][l] = ( A[j][j][l] == 0.0 ) ? tiny : A[j][j][l];
+        }
+
+        // Inner loop 5: divide by the pivot element
+        if( j != DIM-1 ) {
+          double dum[WIDTH];
+          for( int l = 0; l < WIDTH; ++l ) {
+            dum[l] = 1.0 / A[j][j][l];
+          }
+          for( int i = j+1; i < DIM; ++i ) {
+            for( int l = 0; l < WIDTH; ++l ) {
+              A[i][j][l] = A[i][j][l] * dum[l];
+            }
+          }
+        }
+      }
+    }
+
+    /** @brief        Performs back-substitution for every lane; does not overwrite the RHS
+      * @param rhs    Right-hand side vectors, rhs[row][lane]
+      * @param soln   Solution vectors, soln[row][lane] (zero for singular lanes) */
+    void back_subs( const double rhs[DIM][WIDTH], double soln[DIM][WIDTH] ) const
+    {
+      for( int i = 0; i < DIM; ++i ) {
+        for( int l = 0; l < WIDTH; ++l ) {
+          soln[i][l] = rhs[i][l];
+        }
+      }
+
+      // forward substitution (LU skips the leading zeros of the permuted RHS,
+      // which does not change the result)
+      for( int i = 0; i < DIM; ++i ) {
+        for( int l = 0; l < WIDTH; ++l ) {
+          const int ip = indx[i][l];
+          const double sum = soln[ip][l];
+          soln[ip][l] = soln[i][l];
+          soln[i][l]  = sum;
+        }
+        for( int j = 0; j < i; ++j ) {
+          for( int l = 0; l < WIDTH; ++l ) {
+            soln[i][l] -= A[i][j][l] * soln[j][l];
+          }
+        }
+      }
+
+      // back-substitution
+      for( int i = DIM-1; i >= 0; --i ) {
+        double sum[WIDTH];
+        for( int l = 0; l < WIDTH; ++l ) {
+          sum[l] = soln[i][l];
+        }
+        for( int j = i+1; j < DIM; ++j ) {
+          for( int l = 0; l < WIDTH; ++l ) {
+            sum[l] -= A[i][j][l] * soln[j][l];
+          }
+        }
+        for( int l = 0; l < WIDTH; ++l ) {
+          soln[i][l] = singular[l] ? 0.0 : sum[l] / A[i][i][l];
+        }
+      }
+    }
+
+    /** @brief        Residual of every lane, res = A*X - B, where A are the original (not decomposed) matrices */
+    static void getResidual( const double Aorig[DIM][DIM][WIDTH],
+                             const double rhs[DIM][WIDTH],
+                             const double soln[DIM][WIDTH],
+                             double       res[DIM][WIDTH] )
+    {
+      for( int i = 0; i < DIM; ++i ) {
+        double rowsum[WIDTH];
+        for( int l = 0; l < WIDTH; ++l ) {
+          rowsum[l] = 0.0;
+        }
+        for( int j = 0; j < DIM; ++j ) {
+          for( int l = 0; l < WIDTH; ++l ) {
+            rowsum[l] += Aorig[i][j][l] * soln[j][l];
+          }
+        }
+        for( int l = 0; l < WIDTH; ++l ) {
+          res[i][l] = rowsum[l] - rhs[i][l];
+        }
+      }
+    }
+
+    /** @brief        L_infinity norm of every lane of a */
+    static void getNorm( const double a[DIM][WIDTH], double norm[WIDTH] )
+    {
+      for( int l = 0; l < WIDTH; ++l ) {
+        norm[l] = 0.0;
+      }
+      for( int i = 0; i < DIM; ++i ) {
+        for( int l = 0; l < WIDTH; ++l ) {
+          const double temp = std::fabs( a[i][l] );
+          norm[l] = ( temp > norm[l] ) ? temp : norm[l];
+        }
+      }
+    }
+
+    double A[DIM][DIM][WIDTH];  ///< The matrices; after decompose(), their LU factors
+    bool   singular[WIDTH];     ///< Set by decompose() for a matrix with a row of zeros
+
+  private:
+
+    int indx[DIM][WIDTH];       ///< Row permutation of the partial pivoting
+};
+
+/** @brief  The dimensions BatchedLU is instantiated for, (N_xi+1)*N_ for up to six
+  *         environments and four internal coordinates; BATCHEDLU_DIMENSIONS(F)
+  *         expands F(DIM) for each of them.  Systems of any other dimension are
+  *         solved one at a time with LU. */
+#define BATCHEDLU_DIMENSIONS(F) \
+  F(2)  F(3)  F(4)  F(5)  F(6)  F(8)  F(9)  F(10) \
+  F(12) F(15) F(16) F(18) F(20) F(24) F(25) F(30)
+
+/** @brief  Is there a BatchedLU instantiation for systems of dimension dim? */
+inline bool hasBatchedLU( const int dim )
+{
+  switch( dim ) {
+#define BATCHEDLU_CASE(DIM) case DIM:
+    BATCHEDLU_DIMENSIONS(BATCHEDLU_CASE)
+#undef BATCHEDLU_CASE
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // end namespace Uintah
+
+#endif
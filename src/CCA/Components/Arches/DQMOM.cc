@@ -1,5 +1,6 @@
 #include <CCA/Components/Arches/DQMOM.h>
 #include <CCA/Components/Arches/ArchesLabel.h>
+#include <CCA/Components/Arches/BatchedLU.h>
 #include <CCA/Components/Arches/CoalModels/CoalModelFactory.h>
 #include <CCA/Components/Arches/CoalModels/ModelBase.h>
 #include <CCA/Components/Arches/Directives.h>
@@ -31,6 +32,7 @@
 #include <Core/ProblemSpec/ProblemSpec.h>
 #include <Core/Util/Time.h>
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -212,8 +214,12 @@ void DQMOM::problemSetup(const ProblemSpecP& params)
 
     db_linear_solver->getWithDefault("calcConditionNumber", b_calcConditionNumber, false);
 
+    // solve the LU, Optimize and Simplest systems in blocks of cells (no effect on the Lapack solvers)
+    db_linear_solver->getWithDefault("batched", b_batched, true);
+
     db_linear_solver->getWithDefault("type", d_solverType, "LU");
 
+    b_useLapack = false;
     b_optimize = false;
     b_simplest = false;
 
@@ -578,9 +584,25 @@ DQMOM::solveLinearSystem( const ProcessorGroup* pc,
       Source_weights_weightedAbscissas.push_back(tempCCVar);
     }
 
+    // Solve the systems in blocks of cells if there is a batched solver for them
+    bool solvedInBlocks = false;
+#if !defined(VERIFY_LINEAR_SOLVER) && !defined(VERIFY_AB_CONSTRUCTION) && !defined(DEBUG_MATRICES)
+    if( b_batched && !b_useLapack ) {
+      SolutionNorms norms;
+      norms.normB              = &normB;
+      norms.normX              = &normX;
+      norms.normRes            = &normRes;
+      norms.normResNormalizedB = &normResNormalizedB;
+      norms.normResNormalizedX = &normResNormalizedX;
+      solvedInBlocks = solveLinearSystemBlocks( patch, weightCCVars, weightedAbscissaCCVars,
+                                                Source_weights_weightedAbscissas, norms,
+                                                total_AXBConstructionTime, total_SolveTime );
+    }
+#endif
+
     // Cell iterator
     for ( CellIterator iter = patch->getCellIterator();
-          !iter.done(); ++iter) {
+          !solvedInBlocks && !iter.done(); ++iter) {
       IntVector c = *iter;
       vector<double> weights;
       vector<double> weightedAbscissas;
@@ -1402,6 +1424,336 @@ DQMOM::solveLinearSystem( const ProcessorGroup* pc,
 
 
 
+// **********************************************
+// Solve the systems of a patch in blocks of cells
+// **********************************************
+/** @details  The inputs of DQMOMBlock::width cells are gathered structure-of-arrays
+  *           (row = weight or weighted abscissa, column = cell), the systems are
+  *           assembled with the same formulas as constructLinearSystem( LU&, ... )
+  *           and constructBopt_unw(), and solved with BatchedLU (the LU solver), a
+  *           product with the inverted AAopt (Optimize) or a copy (Simplest).  The
+  *           acceptance criteria for the solution are those of the cell by cell path.
+  */
+template <int DIM>
+void
+DQMOM::solveBlocks( const Patch* patch,
+                    vector<constCCVarWrapper_withModels>& weightCCVars,
+                    vector<constCCVarWrapper_withModels>& weightedAbscissaCCVars,
+                    vector<CCVariable<double>* >& sources,
+                    SolutionNorms& norms,
+                    double& constructionTime,
+                    double& solveTime )
+{
+  typedef BatchedLU<DIM> DQMOMBlock;
+  const int W = DQMOMBlock::width;
+
+  // rows 0..N_-1 are the weights, row N_ + i*N_ + alpha is weighted abscissa
+  // i of environment alpha; the models of each row are summed
+  double inputs[DIM][W];
+  double models[DIM][W];
+  double B[DIM][W];
+  double X[DIM][W];
+  IntVector cells[W];
+
+  // Optimize: AAopt is constant and so are the coefficients of the models in B
+  double Aopt[DIM][DIM];
+  double prefixS_opt[DIM][DIM];
+  double productS_opt[DIM][DIM];
+  if( b_optimize ) {
+    for( int i = 0; i < DIM; ++i ) {
+      for( int j = 0; j < DIM; ++j ) {
+        Aopt[i][j] = (*AAopt)[i][j];
+      }
+    }
+    for( unsigned int k = 0; k < momentIndexes.size(); ++k ) {
+      MomentVector thisMoment = momentIndexes[k];
+      for( unsigned int j = 0; j < N_xi; ++j ) {
+        double prefixS  = 1;
+        double productS = 1;
+        for( unsigned int alpha = 0; alpha < N_; ++alpha ) {
+          if ( d_opt_abscissas[j*(N_)+alpha] == 0 && thisMoment[j] == 0) {
+            prefixS = 0;
+          } else {
+            double base = d_opt_abscissas[j*(N_)+alpha];
+            double exponent = thisMoment[j] - 1;
+            prefixS = -(thisMoment[j])*(pow(base, exponent));
+            productS = 1;
+            for (unsigned int n = 0; n < N_xi; ++n) {
+              if (n != j) {
+                double base2 = d_opt_abscissas[n*(N_)+alpha];
+                double exponent2 = thisMoment[n];
+                productS = productS*( pow(base2, exponent2));
+              }
+            }
+          }
+          prefixS_opt[k][j*N_+alpha]  = prefixS;
+          productS_opt[k][j*N_+alpha] = productS;
+        }
+      }
+    }
+  }
+
+  DQMOMBlock A;
+  double Aorig[DIM][DIM][W];
+  double Resid[DIM][W];
+  double Scaled[DIM][W];
+  double normR[W], normRB[W], normRX[W], normBB[W], normXX[W];
+
+  CellIterator iter = patch->getCellIterator();
+  while( !iter.done() ) {
+
+    // gather the next block of cells
+    int n = 0;
+    for( ; n < W && !iter.done(); ++n, ++iter ) {
+      cells[n] = *iter;
+    }
+
+    for( unsigned int r = 0; r < N_; ++r ) {
+      const constCCVarWrapper_withModels& var = weightCCVars[r];
+      for( int l = 0; l < n; ++l ) {
+        double runningsum = 0;
+        for( unsigned int m = 0; m < var.models.size(); ++m ) {
+          runningsum += (var.models[m].data)[cells[l]];
+        }
+        inputs[r][l] = (var.data)[cells[l]];
+        models[r][l] = runningsum;
+      }
+    }
+    for( unsigned int r = 0; r < weightedAbscissaCCVars.size(); ++r ) {
+      const constCCVarWrapper_withModels& var = weightedAbscissaCCVars[r];
+      for( int l = 0; l < n; ++l ) {
+        double runningsum = 0;
+        for( unsigned int m = 0; m < var.models.size(); ++m ) {
+          runningsum += (var.models[m].data)[cells[l]];
+        }
+        inputs[N_+r][l] = (var.data)[cells[l]];
+        models[N_+r][l] = runningsum;
+      }
+    }
+
+    if( b_simplest ) {
+
+      for( int r = 0; r < DIM; ++r ) {
+        for( int l = 0; l < n; ++l ) {
+          (*sources[r])[cells[l]] = models[r][l];
+        }
+      }
+
+    } else if( b_optimize ) {
+
+      double start_AXBConstructionTime = Time::currentSeconds();
+      for( unsigned int k = 0; k < momentIndexes.size(); ++k ) {
+        double totalsumS[W];
+        for( int l = 0; l < W; ++l ) {
+          totalsumS[l] = 0;
+        }
+        for( unsigned int j = 0; j < N_xi; ++j ) {
+          double quadsumS[W];
+          for( int l = 0; l < W; ++l ) {
+            quadsumS[l] = 0;
+          }
+          for( unsigned int alpha = 0; alpha < N_; ++alpha ) {
+            const double prefixS  = prefixS_opt[k][j*N_+alpha];
+            const double productS = productS_opt[k][j*N_+alpha];
+            const double* m = models[N_ + j*N_ + alpha];
+            for( int l = 0; l < W; ++l ) {
+              quadsumS[l] = quadsumS[l] + (-m[l])*prefixS*productS;
+            }
+          }
+          for( int l = 0; l < W; ++l ) {
+            totalsumS[l] = totalsumS[l] + quadsumS[l];
+          }
+        }
+        for( int l = 0; l < W; ++l ) {
+          B[k][l] = totalsumS[l];
+        }
+      }
+      constructionTime += Time::currentSeconds() - start_AXBConstructionTime;
+
+      double start_SolveTime = Time::currentSeconds();
+      for( int i = 0; i < DIM; ++i ) {
+        double sum[W];
+        for( int l = 0; l < W; ++l ) {
+          sum[l] = 0;
+        }
+        for( int j = 0; j < DIM; ++j ) {
+          for( int l = 0; l < W; ++l ) {
+            sum[l] += Aopt[i][j]*B[j][l];
+          }
+        }
+        for( int l = 0; l < W; ++l ) {
+          X[i][l] = sum[l];
+        }
+      }
+      solveTime += Time::currentSeconds() - start_SolveTime;
+
+      for( int r = 0; r < DIM; ++r ) {
+        for( int l = 0; l < n; ++l ) {
+          (*sources[r])[cells[l]] = X[r][l];
+        }
+      }
+
+    } else {
+
+      // same construction as constructLinearSystem( LU&, ... ), one cell at a time
+      double start_AXBConstructionTime = Time::currentSeconds();
+      for( int l = 0; l < n; ++l ) {
+        for ( unsigned int k = 0; k < momentIndexes.size(); ++k) {
+          const MomentVector& thisMoment = momentIndexes[k];
+
+          // weights
+          for ( unsigned int alpha = 0; alpha < N_; ++alpha) {
+            double prefixA = 1;
+            double productA = 1;
+            for ( unsigned int i = 0; i < thisMoment.size(); ++i) {
+              if (inputs[alpha][l] != 0) {
+                prefixA = prefixA - (thisMoment[i]);
+                double base = inputs[N_+i*(N_)+alpha][l] / inputs[alpha][l];
+                double exponent = thisMoment[i];
+                productA = productA*( pow(base, exponent) );
+              } else {
+                prefixA = 0;
+                productA = 0;
+              }
+            }
+            A.A[k][alpha][l] = prefixA*productA;
+          }
+
+          // weighted abscissas
+          double totalsumS = 0;
+          for( unsigned int j = 0; j < N_xi; ++j ) {
+            double prefixA    = 1;
+            double productA   = 1;
+            double prefixS    = 1;
+            double productS   = 1;
+            double quadsumS = 0;
+            for( unsigned int alpha = 0; alpha < N_; ++alpha ) {
+              const double weight = inputs[alpha][l];
+              if (weight == 0) {
+                prefixA = 0;
+                prefixS = 0;
+                productA = 0;
+                productS = 0;
+              } else if ( inputs[N_+j*(N_)+alpha][l] == 0 && thisMoment[j] == 0) {
+                prefixA = 0;
+                prefixS = 0;
+              } else {
+                double base = inputs[N_+j*(N_)+alpha][l] / weight;
+                double exponent = thisMoment[j] - 1;
+                prefixA = (thisMoment[j])*(pow(base, exponent));
+                productA = 1;
+                prefixS = -(thisMoment[j])*(pow(base, exponent));
+                productS = 1;
+                for (unsigned int n2 = 0; n2 < N_xi; ++n2) {
+                  if (n2 != j) {
+                    double base2 = inputs[N_+n2*(N_)+alpha][l]/weight;
+                    double exponent2 = thisMoment[n2];
+                    productA = productA*( pow(base2, exponent2));
+                    productS = productS*( pow(base2, exponent2));
+                  }
+                }
+              }
+              double modelsumS = - models[N_+j*(N_)+alpha][l];
+              A.A[k][(j+1)*N_ + alpha][l] = prefixA*productA;
+              quadsumS = quadsumS + weight*modelsumS*prefixS*productS;
+            }
+            totalsumS = totalsumS + quadsumS;
+          }
+          B[k][l] = totalsumS;
+        }
+      }
+      A.padLanes( n );
+      for( int i = 0; i < DIM; ++i ) {
+        for( int l = n; l < W; ++l ) {
+          B[i][l] = 0.0;
+        }
+      }
+      constructionTime += Time::currentSeconds() - start_AXBConstructionTime;
+
+      // Save original A before decomposition into LU
+      std::copy( &A.A[0][0][0], &A.A[0][0][0] + DIM*DIM*W, &Aorig[0][0][0] );
+
+      double start_SolveTime = Time::currentSeconds();
+      A.decompose();
+      A.back_subs( B, X );
+      solveTime += Time::currentSeconds() - start_SolveTime;
+
+      // residual and its norms, as in the cell by cell path
+      DQMOMBlock::getResidual( Aorig, B, X, Resid );
+      DQMOMBlock::getNorm( Resid, normR );
+
+      for( int i = 0; i < DIM; ++i ) {
+        for( int l = 0; l < W; ++l ) {
+          Scaled[i][l] = ( fabs(B[i][l]) > d_small_normalizer ) ? Resid[i][l] / ( B[i][l] == 0.0 ? 1.0 : B[i][l] ) : Resid[i][l];
+        }
+      }
+      DQMOMBlock::getNorm( Scaled, normRB );
+
+      for( int i = 0; i < DIM; ++i ) {
+        for( int l = 0; l < W; ++l ) {
+          Scaled[i][l] = ( fabs(X[i][l]) > d_small_normalizer ) ? fabs( Resid[i][l] / ( X[i][l] == 0.0 ? 1.0 : X[i][l] ) ) : Resid[i][l];
+        }
+      }
+      DQMOMBlock::getNorm( Scaled, normRX );
+      DQMOMBlock::getNorm( B, normBB );
+      DQMOMBlock::getNorm( X, normXX );
+
+      for( int l = 0; l < n; ++l ) {
+        const IntVector& c = cells[l];
+
+        // a singular system keeps zero norms
+        if( !A.singular[l] ) {
+          (*norms.normRes)[c]            = normR[l];
+          (*norms.normResNormalizedB)[c] = normRB[l];
+          (*norms.normResNormalizedX)[c] = normRX[l];
+          (*norms.normB)[c]              = normBB[l];
+          (*norms.normX)[c]              = normXX[l];
+        }
+
+        // check "acceptable solution" criteria, and assign solution values to source terms
+        const bool rejected = fabs( (*norms.normResNormalizedX)[c] ) > d_solver_tolerance;
+        for( int r = 0; r < DIM; ++r ) {
+          if( rejected || std::isnan( X[r][l] ) ) {
+            (*sources[r])[c] = 0.0;
+          } else {
+            (*sources[r])[c] = X[r][l];
+          }
+        }
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+bool
+DQMOM::solveLinearSystemBlocks( const Patch* patch,
+                                vector<constCCVarWrapper_withModels>& weightCCVars,
+                                vector<constCCVarWrapper_withModels>& weightedAbscissaCCVars,
+                                vector<CCVariable<double>* >& sources,
+                                SolutionNorms& norms,
+                                double& constructionTime,
+                                double& solveTime )
+{
+  // the systems are sized at compile time, see BATCHEDLU_DIMENSIONS
+  const int dimension = (N_xi+1)*N_;
+
+  if( !hasBatchedLU( dimension ) || (int)sources.size() != dimension
+      || (!b_simplest && (int)momentIndexes.size() != dimension) ) {
+    return false;
+  }
+
+  switch( dimension ) {
+#define DQMOM_SOLVE_BLOCKS(DIM) \
+    case DIM: \
+      solveBlocks<DIM>( patch, weightCCVars, weightedAbscissaCCVars, sources, norms, constructionTime, solveTime ); \
+      return true;
+    BATCHEDLU_DIMENSIONS(DQMOM_SOLVE_BLOCKS)
+#undef DQMOM_SOLVE_BLOCKS
+    default:
+      return false;
+  }
+}
+
 // **********************************************
 // Construct A and B matrices for DQMOM
 // **********************************************
@@ -231,6 +231,38 @@ private:
     std::vector<constCCVarWrapperTypeDef> models;
   };
 
+  /** @brief  Norms of the solution of the LU solver, per cell */
+  struct SolutionNorms {
+    CCVariable<double>* normB;
+    CCVariable<double>* normX;
+    CCVariable<double>* normRes;
+    CCVariable<double>* normResNormalizedB;
+    CCVariable<double>* normResNormalizedX;
+  };
+
+  /** @brief  Solve the AX=B systems of a patch a block of cells at a time, with the LU,
+              Optimize or Simplest solver.  Returns false (and does nothing) if there is
+              no batched solver for this dimension; the cells must then be done one by one. */
+  bool solveLinearSystemBlocks( const Patch* patch,
+                                std::vector<constCCVarWrapper_withModels>& weightCCVars,
+                                std::vector<constCCVarWrapper_withModels>& weightedAbscissaCCVars,
+                                std::vector<CCVariable<double>* >& sources,
+                                SolutionNorms& norms,
+                                double& constructionTime,
+                                double& solveTime );
+
+  /** @brief  solveLinearSystemBlocks() for systems of dimension DIM = (N_xi+1)*N_ */
+  template <int DIM>
+  void solveBlocks( const Patch* patch,
+                    std::vector<constCCVarWrapper_withModels>& weightCCVars,
+                    std::vector<constCCVarWrapper_withModels>& weightedAbscissaCCVars,
+                    std::vector<CCVariable<double>* >& sources,
+                    SolutionNorms& norms,
+                    double& constructionTime,
+                    double& solveTime );
+
+  bool b_batched;  ///< solve the LU, Optimize and Simplest systems in blocks of cells?
+
 #if defined(VERIFY_LINEAR_SOLVER)
   /** @brief  Get an A and B matrix from a file, then solve the linear system
               AX=B and compare the solution to the pre-determined solution.
@@ -28,6 +28,7 @@
 #include <CCA/Components/Arches/Radiation/DORadiationModel.h>
 #include <CCA/Components/Arches/Radiation/RadPetscSolver.h>
 #include <CCA/Components/Arches/Radiation/RadiationSolver.h>
+#include <CCA/Components/Arches/Radiation/RadSweepSolver.h>
 #include <CCA/Components/MPMArches/MPMArchesLabel.h>
 #include <CCA/Ports/DataWarehouse.h>
 #include <CCA/Ports/Scheduler.h>
@@ -84,6 +85,7 @@ DORadiationModel::DORadiationModel(const ArchesLabel* label,
 {
 
   d_linearSolver = 0;
+  d_sweepSolver = 0;
   d_perproc_patches = 0;
 
 }
@@ -95,6 +97,7 @@ DORadiationModel::~DORadiationModel()
 {
 
   delete d_linearSolver;
+  delete d_sweepSolver;
 
   if(d_perproc_patches && d_perproc_patches->removeReference()){
     delete d_perproc_patches;
@@ -224,9 +227,19 @@ DORadiationModel::problemSetup( ProblemSpecP& params )
 
     d_linearSolver = scinew RadHypreSolver(d_myworld);
 
+  } else if (linear_sol == "sweep"){
+
+    d_sweepSolver = scinew RadSweepSolver(d_myworld);
+
+  } else {
+    throw ProblemSetupException("Error: DO-radiation <LinearSolver> type must be petsc, hypre or sweep.", __FILE__, __LINE__);
   }
 
-  d_linearSolver->problemSetup(db);
+  if (d_linearSolver){
+    d_linearSolver->problemSetup(db);
+  } else {
+    d_sweepSolver->problemSetup(db->findBlock("LinearSolver"));
+  }
 
   //WARNING: Hack -- flow cells set to -1
   ffield = -1;
@@ -881,6 +894,152 @@ DORadiationModel::intensitysolve(const ProcessorGroup* pg,
   proc0cout << "Total Radiation Solve Time: " << Time::currentSeconds()-solve_start << " seconds\n";
 
 }
+//***************************************************************************
+// Solves for intensity in the D.O method with the sweep solver, for all
+// the patches of this rank at once
+//***************************************************************************
+void
+DORadiationModel::intensitysolveSweep(const ProcessorGroup* pg,
+                                      const PatchSubset* patches,
+                                      std::vector<ArchesVariables*>& vars,
+                                      std::vector<ArchesConstVariables*>& constvars,
+                                      std::vector<CCVariable<double>*>& divQ,
+                                      int matlIndex,
+                                      DataWarehouse* new_dw,
+                                      DataWarehouse* old_dw,
+                                      bool old_DW_isMissingIntensities)
+{
+
+  proc0cout << " Radiation Solve (sweep): " << endl;
+
+  double solve_start = Time::currentSeconds();
+
+  const int nPatches = patches->size();
+
+  std::vector<RadSweepSolver::Ordinate> ordinates(d_totalOrds);
+  for (int direcn = 1; direcn <=d_totalOrds; direcn++){
+    ordinates[direcn-1].mu  = omu[direcn];
+    ordinates[direcn-1].eta = oeta[direcn];
+    ordinates[direcn-1].xi  = oxi[direcn];
+  }
+
+  // the scattering source is lagged: it uses the intensities of the
+  // previous solve, so the ordinates stay independent.  Missing (restart)
+  // intensities are zero, and so is their scattering source.
+  std::vector< StaticArray< constCCVariable<double> > > Intensities;
+  std::vector< constCCVariable<double> > scatkt(nPatches);
+  std::vector< constCCVariable<double> > asymmetryParam(nPatches);
+
+  std::vector<RadSweepSolver::PatchData> data(nPatches);
+
+  for (int p = 0; p < nPatches; p++){
+    const Patch* patch = patches->get(p);
+
+    if(_scatteringOn){
+      if(!old_DW_isMissingIntensities){
+        Intensities.push_back(StaticArray< constCCVariable<double> >(d_totalOrds));
+        for( int ix=0;  ix<d_totalOrds ;ix++){
+          old_dw->get(Intensities[p][ix],_IntensityLabels[ix], matlIndex , patch,Ghost::None, 0  );
+        }
+      }
+      old_dw->get(asymmetryParam[p],_asymmetryLabel, matlIndex , patch,Ghost::None, 0);
+      old_dw->get(scatkt[p],_scatktLabel, matlIndex , patch,Ghost::None, 0);
+    }
+
+    divQ[p]->initialize(0.0);
+    vars[p]->qfluxe.initialize(0.0);
+    vars[p]->qfluxw.initialize(0.0);
+    vars[p]->qfluxn.initialize(0.0);
+    vars[p]->qfluxs.initialize(0.0);
+    vars[p]->qfluxt.initialize(0.0);
+    vars[p]->qfluxb.initialize(0.0);
+
+    data[p].patch       = patch;
+    data[p].cellType    = constvars[p]->cellType;
+    data[p].temperature = constvars[p]->temperature;
+    data[p].abskt       = constvars[p]->ABSKT;
+  }
+
+  RadSweepSolver::ScatterFunc scatter;
+  if(_scatteringOn && !old_DW_isMissingIntensities){
+    scatter = [&](int ordinate, int p, CCVariable<double>& scatIntensitySource){
+      computeScatteringIntensities(ordinate+1, scatkt[p], Intensities[p], scatIntensitySource, asymmetryParam[p], patches->get(p));
+    };
+  }
+
+  // fluxes and incident radiation, and the saved intensities
+  RadSweepSolver::ResultFunc result = [&](int ordinate, int p, CCVariable<double>& intensity){
+    const Patch* patch = patches->get(p);
+    Uintah::BlockRange range(patch->getCellLowIndex(),patch->getCellHighIndex());
+    int direcn = ordinate + 1;
+
+    bool plusX = (omu[direcn]  > 0.0);
+    bool plusY = (oeta[direcn] > 0.0);
+    bool plusZ = (oxi[direcn]  > 0.0);
+
+    compute4Flux doFlux(wt[direcn]*abs(omu[direcn]),wt[direcn]*abs(oeta[direcn]),wt[direcn]*abs(oxi[direcn]),
+                                                                  wt[direcn],  intensity,
+                                                                  plusX ? vars[p]->qfluxe :  vars[p]->qfluxw,
+                                                                  plusY ? vars[p]->qfluxn :  vars[p]->qfluxs,
+                                                                  plusZ ? vars[p]->qfluxt :  vars[p]->qfluxb,
+                                                                  vars[p]->volq);
+    Uintah::parallel_for( range, doFlux );
+
+    if(needIntensitiesBool() || direcn == d_totalOrds){
+      CCVariable<double> cenint;
+      new_dw->getModifiable(cenint,_IntensityLabels[needIntensitiesBool() ? ordinate : 0] , matlIndex, patch );
+      cenint.initialize(0.0);
+      cenint.copyPatch(intensity, patch->getCellLowIndex(), patch->getCellHighIndex());
+    }
+  };
+
+  //__________________________________
+  //begin discrete ordinates
+  for (int bands =1; bands <=d_lambda; bands++){
+
+    for (int p = 0; p < nPatches; p++){
+      const Patch* patch = patches->get(p);
+
+      StaticArray< constCCVariable<double> > abskp(_nQn_part);
+      StaticArray< constCCVariable<double> > partTemp(_nQn_part);
+      for (int ix=0;  ix< _nQn_part; ix++){
+        old_dw->get(abskp[ix],_abskp_label_vector[ix], matlIndex , patch,Ghost::None, 0  );
+        old_dw->get(partTemp[ix],_temperature_label_vector[ix], matlIndex , patch,Ghost::None, 0  );
+      }
+
+      vars[p]->volq.initialize(0.0);
+      vars[p]->ESRCG.initialize(0.0);
+      computeIntensitySource(patch,abskp,partTemp,constvars[p]->ABSKG,constvars[p]->temperature,vars[p]->ESRCG);
+      data[p].emission = vars[p]->ESRCG;
+    }
+
+    d_sweepSolver->solve(data, ordinates, ffield, scatter, result);
+
+    for (int p = 0; p < nPatches; p++){
+      const Patch* patch = patches->get(p);
+      Uintah::BlockRange range(patch->getCellLowIndex(),patch->getCellHighIndex());
+      if(_scatteringOn){
+        computeDivQScat doDivQ(constvars[p]->ABSKT, vars[p]->ESRCG,vars[p]->volq, *divQ[p], scatkt[p]);
+        Uintah::parallel_for( range, doDivQ );
+      }else{
+        computeDivQ doDivQ(constvars[p]->ABSKT, vars[p]->ESRCG,vars[p]->volq, *divQ[p]);
+        Uintah::parallel_for( range, doDivQ );
+      }
+    }
+
+  }  // bands loop
+
+  proc0cout << "Total Radiation Solve Time: " << Time::currentSeconds()-solve_start << " seconds\n";
+
+}
+
+void
+DORadiationModel::setLoadBalancer(LoadBalancer* lb){
+  if(d_sweepSolver){
+    d_sweepSolver->setLoadBalancer(lb);
+  }
+}
+
 // returns the total number of directions, sn*(sn+2)
 int
 DORadiationModel::getIntOrdinates(){
@@ -56,10 +56,14 @@ GENERAL INFORMATION
 #include <Core/Grid/Variables/VarLabel.h>
 #include <Core/Containers/StaticArray.h>
 
+#include <vector>
+
 
 namespace Uintah {
 
   class ArchesLabel;
+  class LoadBalancer;
+  class RadSweepSolver;
 
 class DORadiationModel{
 
@@ -91,6 +95,24 @@ public:
                                   CCVariable<double>& divQ,
                                   int wall_type, int matlIndex, DataWarehouse* new_dw, DataWarehouse* old_dw,
                                   bool old_DW_isMissingIntensities);
+      // Solves for the intensities of all the patches of this rank at
+      // once with the sweep solver (LinearSolver type="sweep").  Must be
+      // called from a task over the per processor patch set.
+      void intensitysolveSweep(const ProcessorGroup* pc,
+                               const PatchSubset* patches,
+                               std::vector<ArchesVariables*>& vars,
+                               std::vector<ArchesConstVariables*>& constvars,
+                               std::vector<CCVariable<double>*>& divQ,
+                               int matlIndex, DataWarehouse* new_dw, DataWarehouse* old_dw,
+                               bool old_DW_isMissingIntensities);
+
+      // Is the sweep solver used instead of a linear solver?
+      inline bool sweepSolverOn(){
+        return d_sweepSolver != 0;
+      }
+
+      void setLoadBalancer(LoadBalancer* lb);
+
       int getIntOrdinates();
 
       bool reflectionsBool();
@@ -120,6 +142,7 @@ private:
       const MPMArchesLabel* d_MAlab;
       const ProcessorGroup* d_myworld;
       const PatchSet* d_perproc_patches;
+      RadSweepSolver* d_sweepSolver;
       
       int d_sn, d_totalOrds; // totalOrdinates = sn*(sn+2)
 
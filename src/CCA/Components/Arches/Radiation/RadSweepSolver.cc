@@ -0,0 +1,460 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <CCA/Components/Arches/Radiation/RadSweepSolver.h>
+#include <CCA/Ports/LoadBalancer.h>
+
+#include <Core/Exceptions/InternalError.h>
+#include <Core/Geometry/Vector.h>
+#include <Core/Grid/Level.h>
+#include <Core/Grid/Variables/BlockRange.hpp>
+#include <Core/Parallel/ProcessorGroup.h>
+#include <Core/ProblemSpec/ProblemSpec.h>
+#include <Core/Util/DebugStream.h>
+
+#include <cmath>
+#include <sstream>
+
+using namespace Uintah;
+
+static DebugStream dbg("RadSweepSolver", false);
+
+namespace {
+
+// layout of a face message: a header followed by the intensities
+enum { H_SEQUENCE = 0, H_ORDINATE, H_PATCH, H_LOW, H_HIGH = H_LOW + 3, H_SIZE = H_HIGH + 3 };
+
+const double SB = 5.67e-8;  // W / m^2 / K^4
+
+inline int octantOf( const RadSweepSolver::Ordinate& o )
+{
+  return (o.mu > 0.0 ? 1 : 0) | (o.eta > 0.0 ? 2 : 0) | (o.xi > 0.0 ? 4 : 0);
+}
+
+// +1 if the ordinates of the octant travel towards +axis, else -1
+inline int directionOf( int octant, int axis )
+{
+  return (octant & (1 << axis)) ? 1 : -1;
+}
+
+} // End anonymous namespace
+
+//______________________________________________________________________
+//
+RadSweepSolver::RadSweepSolver( const ProcessorGroup* myworld )
+  : d_myworld( myworld ),
+    d_lb( 0 ),
+    d_comm( MPI_COMM_NULL ),
+    d_maxConcurrent( 8 ),
+    d_sequence( 0 ),
+    d_numPatches( 0 )
+{
+}
+
+//______________________________________________________________________
+//
+RadSweepSolver::~RadSweepSolver()
+{
+  if (d_comm != MPI_COMM_NULL) {
+    Uintah::MPI::Comm_free(&d_comm);
+  }
+}
+
+//______________________________________________________________________
+//
+void
+RadSweepSolver::problemSetup( const ProblemSpecP& params )
+{
+  ProblemSpecP db = params;
+  if (db) {
+    db->getWithDefault("max_concurrent_sweeps", d_maxConcurrent, 8);
+  }
+  if (d_maxConcurrent < 1) {
+    d_maxConcurrent = 1;
+  }
+
+  // face messages travel on their own communicator so they can not be
+  // matched by the scheduler's receives
+  Uintah::MPI::Comm_dup(d_myworld->getComm(), &d_comm);
+}
+
+//______________________________________________________________________
+//  The neighbors across the upwind (or downwind) faces of a patch, for
+//  the ordinates of an octant, and the cells of the upwind patch the
+//  sweep of the downwind one needs.  Both sides find the same links.
+void
+RadSweepSolver::findLinks( const Patch*       patch,
+                           int                octant,
+                           bool               upwind,
+                           std::vector<Link>& links ) const
+{
+  links.clear();
+
+  const Level*    level = patch->getLevel();
+  const IntVector low   = patch->getCellLowIndex();
+  const IntVector high  = patch->getCellHighIndex();
+
+  for (int axis = 0; axis < 3; axis++) {
+    int  dir    = directionOf(octant, axis);
+    bool lowSide = (dir > 0) == upwind;
+
+    // the layer of cells just outside the face
+    IntVector slabLow  = low;
+    IntVector slabHigh = high;
+    if (lowSide) {
+      slabLow[axis]  = low[axis] - 1;
+      slabHigh[axis] = low[axis];
+    } else {
+      slabLow[axis]  = high[axis];
+      slabHigh[axis] = high[axis] + 1;
+    }
+
+    Patch::selectType neighbors;
+    level->selectPatches(slabLow, slabHigh, neighbors);
+
+    for (int i = 0; i < neighbors.size(); i++) {
+      const Patch* neighbor = neighbors[i];
+      if (neighbor == patch) {
+        continue;
+      }
+
+      Link link;
+      link.to   = neighbor;
+      link.rank = d_lb->getPatchwiseProcessorAssignment(neighbor);
+      std::map<int, int>::const_iterator local = d_localIndex.find(neighbor->getID());
+      link.local = (local == d_localIndex.end()) ? -1 : local->second;
+
+      // an upwind link is described by the cells of the neighbor and a
+      // downwind link by the cells of this patch
+      link.low  = Max(slabLow,  neighbor->getCellLowIndex());
+      link.high = Min(slabHigh, neighbor->getCellHighIndex());
+      if (!upwind) {
+        link.low[axis]  -= dir;
+        link.high[axis] -= dir;
+      }
+      links.push_back(link);
+    }
+  }
+}
+
+//______________________________________________________________________
+//  Sweep one ordinate over one patch.  The matrix is the one built by
+//  computeAMatrix in DORadiationModel, solved in upwind order.
+void
+RadSweepSolver::sweep( const PatchData&          data,
+                       const Ordinate&           ordinate,
+                       int                       flowCell,
+                       const CCVariable<double>* scatSource,
+                       const std::vector<Piece>& upwind,
+                       CCVariable<double>&       intensity ) const
+{
+  const Patch*    patch = data.patch;
+  const IntVector low   = patch->getCellLowIndex();
+  const IntVector high  = patch->getCellHighIndex();
+  const IntVector one(1, 1, 1);
+
+  intensity.allocate(low - one, high + one);
+  intensity.initialize(0.0);
+
+  for (unsigned p = 0; p < upwind.size(); p++) {
+    const Piece& piece = upwind[p];
+    int n = 0;
+    for (int k = piece.low.z(); k < piece.high.z(); k++) {
+      for (int j = piece.low.y(); j < piece.high.y(); j++) {
+        for (int i = piece.low.x(); i < piece.high.x(); i++) {
+          intensity(i, j, k) = piece.values[n++];
+        }
+      }
+    }
+  }
+
+  const Vector Dx     = patch->dCell();
+  const double vol    = Dx.x() * Dx.y() * Dx.z();
+  const double cx     = std::fabs(ordinate.mu)  * Dx.y() * Dx.z();
+  const double cy     = std::fabs(ordinate.eta) * Dx.x() * Dx.z();
+  const double cz     = std::fabs(ordinate.xi)  * Dx.x() * Dx.y();
+  const double wallBB = SB / M_PI;
+
+  const int sx = (ordinate.mu  > 0.0) ? 1 : -1;
+  const int sy = (ordinate.eta > 0.0) ? 1 : -1;
+  const int sz = (ordinate.xi  > 0.0) ? 1 : -1;
+
+  const constCCVariable<int>&    cellType = data.cellType;
+  const constCCVariable<double>& T        = data.temperature;
+  const constCCVariable<double>& abskt    = data.abskt;
+  const constCCVariable<double>& emission = data.emission;
+
+  const IntVector size = high - low;
+  for (int kk = 0; kk < size.z(); kk++) {
+    const int k = (sz > 0) ? low.z() + kk : high.z() - 1 - kk;
+    for (int jj = 0; jj < size.y(); jj++) {
+      const int j = (sy > 0) ? low.y() + jj : high.y() - 1 - jj;
+      for (int ii = 0; ii < size.x(); ii++) {
+        const int i = (sx > 0) ? low.x() + ii : high.x() - 1 - ii;
+
+        if (cellType(i, j, k) != flowCell) {
+          intensity(i, j, k) = wallBB * std::pow(T(i, j, k), 4.0);
+          continue;
+        }
+
+        double b = emission(i, j, k);
+        if (scatSource) {
+          b += (*scatSource)(i, j, k);
+        }
+        b *= vol;
+
+        const int iu = i - sx;
+        const int ju = j - sy;
+        const int ku = k - sz;
+
+        b += (cellType(iu, j, k) == flowCell) ? cx * intensity(iu, j, k) : cx * wallBB * std::pow(T(iu, j, k), 4.0);
+        b += (cellType(i, ju, k) == flowCell) ? cy * intensity(i, ju, k) : cy * wallBB * std::pow(T(i, ju, k), 4.0);
+        b += (cellType(i, j, ku) == flowCell) ? cz * intensity(i, j, ku) : cz * wallBB * std::pow(T(i, j, ku), 4.0);
+
+        intensity(i, j, k) = b / (cx + cy + cz + abskt(i, j, k) * vol);
+      }
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+void
+RadSweepSolver::deliver( const std::vector<double>& message )
+{
+  const int ordinate = (int)message[H_ORDINATE];
+  std::map<int, int>::const_iterator local = d_localIndex.find((int)message[H_PATCH]);
+  if (local == d_localIndex.end()) {
+    std::ostringstream msg;
+    msg << "RadSweepSolver: intensities for patch " << (int)message[H_PATCH]
+        << ", which is not on this rank";
+    throw InternalError(msg.str(), __FILE__, __LINE__);
+  }
+
+  Piece piece;
+  piece.low  = IntVector((int)message[H_LOW],  (int)message[H_LOW + 1],  (int)message[H_LOW + 2]);
+  piece.high = IntVector((int)message[H_HIGH], (int)message[H_HIGH + 1], (int)message[H_HIGH + 2]);
+  piece.values.assign(message.begin() + H_SIZE, message.end());
+
+  const int unit = ordinate * d_numPatches + local->second;
+  d_pieces[unit].push_back(piece);
+  d_received[unit]++;
+}
+
+//______________________________________________________________________
+//  Deliver the face messages that have arrived, waiting for one if
+//  block is set.  Returns whether any message of this solve arrived.
+bool
+RadSweepSolver::receive( bool block )
+{
+  bool any = false;
+
+  while (true) {
+    int        flag = 0;
+    MPI_Status status;
+    if (block && !any) {
+      Uintah::MPI::Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, d_comm, &status);
+      flag = 1;
+    } else {
+      Uintah::MPI::Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, d_comm, &flag, &status);
+    }
+    if (!flag) {
+      return any;
+    }
+
+    int count;
+    Uintah::MPI::Get_count(&status, MPI_DOUBLE, &count);
+    std::vector<double> message(count);
+    Uintah::MPI::Recv(&message[0], count, MPI_DOUBLE, status.MPI_SOURCE, status.MPI_TAG, d_comm, MPI_STATUS_IGNORE);
+
+    // a neighbor may already be sweeping the next solve
+    int sequence = (int)message[H_SEQUENCE];
+    if (sequence == d_sequence) {
+      deliver(message);
+      any = true;
+    } else if (sequence > d_sequence) {
+      d_early.push_back(message);
+    } else {
+      throw InternalError("RadSweepSolver: face message from an earlier solve", __FILE__, __LINE__);
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+void
+RadSweepSolver::solve( const std::vector<PatchData>& patches,
+                       const std::vector<Ordinate>&  ordinates,
+                       int                           flowCell,
+                       const ScatterFunc&            scatter,
+                       const ResultFunc&             result )
+{
+  if (!d_lb) {
+    throw InternalError("RadSweepSolver: no load balancer set", __FILE__, __LINE__);
+  }
+
+  d_sequence++;
+
+  const int nPatches   = patches.size();
+  const int nOrdinates = ordinates.size();
+  const int nUnits     = nPatches * nOrdinates;
+  const int myrank     = d_myworld->myrank();
+
+  d_numPatches = nPatches;
+  d_localIndex.clear();
+  for (int p = 0; p < nPatches; p++) {
+    d_localIndex[patches[p].patch->getID()] = p;
+  }
+
+  // the upwind pieces each unit waits for and the downwind neighbors it
+  // feeds, per octant
+  std::vector<int>                  expected(8 * nPatches);
+  std::vector< std::vector<Link> >  downwind(8 * nPatches);
+  std::vector<bool>                 octantUsed(8, false);
+  for (int d = 0; d < nOrdinates; d++) {
+    octantUsed[octantOf(ordinates[d])] = true;
+  }
+  for (int o = 0; o < 8; o++) {
+    if (!octantUsed[o]) {
+      continue;
+    }
+    std::vector<Link> upwind;
+    for (int p = 0; p < nPatches; p++) {
+      findLinks(patches[p].patch, o, true, upwind);
+      expected[o * nPatches + p] = upwind.size();
+      findLinks(patches[p].patch, o, false, downwind[o * nPatches + p]);
+    }
+  }
+
+  d_pieces.assign(nUnits, std::vector<Piece>());
+  d_received.assign(nUnits, 0);
+
+  // messages of this solve that came in during the last one
+  std::vector< std::vector<double> > early;
+  early.swap(d_early);
+  for (unsigned m = 0; m < early.size(); m++) {
+    if ((int)early[m][H_SEQUENCE] == d_sequence) {
+      deliver(early[m]);
+    } else {
+      d_early.push_back(early[m]);
+    }
+  }
+
+  std::vector<bool>                   done(nUnits, false);
+  std::vector<MPI_Request>            sendRequests;
+  std::vector< std::vector<double>* > sendBuffers;
+  int remaining = nUnits;
+
+  std::vector<int> ready;
+
+  while (remaining > 0) {
+
+    // ordinate first, so that upwind ranks finish an ordinate before
+    // starting the next one and the downwind ranks can follow
+    ready.clear();
+    for (int u = 0; u < nUnits && (int)ready.size() < d_maxConcurrent; u++) {
+      if (!done[u] && d_received[u] == expected[octantOf(ordinates[u / nPatches]) * nPatches + u % nPatches]) {
+        ready.push_back(u);
+      }
+    }
+
+    if (ready.empty()) {
+      receive(true);
+      continue;
+    }
+
+    std::vector< CCVariable<double> > intensity(ready.size());
+    std::vector< CCVariable<double> > scatSource(ready.size());
+
+    Uintah::parallel_for(BlockRange(IntVector(0, 0, 0), IntVector(1, 1, ready.size())), [&](int, int, int r) {
+      const int d = ready[r] / nPatches;
+      const int p = ready[r] % nPatches;
+
+      CCVariable<double>* scat = 0;
+      if (scatter) {
+        scatSource[r].allocate(patches[p].patch->getExtraCellLowIndex(), patches[p].patch->getExtraCellHighIndex());
+        scatter(d, p, scatSource[r]);
+        scat = &scatSource[r];
+      }
+      sweep(patches[p], ordinates[d], flowCell, scat, d_pieces[ready[r]], intensity[r]);
+    });
+
+    for (unsigned r = 0; r < ready.size(); r++) {
+      const int d = ready[r] / nPatches;
+      const int p = ready[r] % nPatches;
+      const std::vector<Link>& links = downwind[octantOf(ordinates[d]) * nPatches + p];
+
+      for (unsigned l = 0; l < links.size(); l++) {
+        const Link& link = links[l];
+        std::vector<double>* message = new std::vector<double>(H_SIZE);
+        std::vector<double>& m = *message;
+        m[H_SEQUENCE] = d_sequence;
+        m[H_ORDINATE] = d;
+        m[H_PATCH]    = link.to->getID();
+        for (int c = 0; c < 3; c++) {
+          m[H_LOW + c]  = link.low[c];
+          m[H_HIGH + c] = link.high[c];
+        }
+        for (int k = link.low.z(); k < link.high.z(); k++) {
+          for (int j = link.low.y(); j < link.high.y(); j++) {
+            for (int i = link.low.x(); i < link.high.x(); i++) {
+              m.push_back(intensity[r](i, j, k));
+            }
+          }
+        }
+
+        if (link.local >= 0) {
+          deliver(m);
+          delete message;
+        } else {
+          MPI_Request request;
+          Uintah::MPI::Isend(&m[0], m.size(), MPI_DOUBLE, link.rank, 0, d_comm, &request);
+          sendRequests.push_back(request);
+          sendBuffers.push_back(message);
+        }
+      }
+
+      result(d, p, intensity[r]);
+
+      done[ready[r]] = true;
+      std::vector<Piece>().swap(d_pieces[ready[r]]);
+      remaining--;
+    }
+
+    receive(false);
+  }
+
+  if (!sendRequests.empty()) {
+    Uintah::MPI::Waitall(sendRequests.size(), &sendRequests[0], MPI_STATUSES_IGNORE);
+  }
+  for (unsigned b = 0; b < sendBuffers.size(); b++) {
+    delete sendBuffers[b];
+  }
+
+  if (dbg.active()) {
+    dbg << "Rank-" << myrank << " swept " << nOrdinates << " ordinates over "
+        << nPatches << " patches, " << sendRequests.size() << " face messages sent\n";
+  }
+}
@@ -0,0 +1,185 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef Uintah_Components_Arches_RadSweepSolver_h
+#define Uintah_Components_Arches_RadSweepSolver_h
+
+#include <Core/Geometry/IntVector.h>
+#include <Core/Grid/Patch.h>
+#include <Core/Grid/Variables/CCVariable.h>
+#include <sci_defs/mpi_defs.h>
+#include <Core/ProblemSpec/ProblemSpecP.h>
+
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace Uintah {
+
+class LoadBalancer;
+class ProcessorGroup;
+
+/**************************************
+
+CLASS
+   RadSweepSolver
+
+GENERAL INFORMATION
+
+   RadSweepSolver.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+KEYWORDS
+   Discrete Ordinates, Radiation, Sweep, KBA
+
+DESCRIPTION
+   Solves the discrete ordinates equations by sweeping each ordinate
+   through the domain from its upwind corner, instead of assembling
+   and solving the (lower triangular) 7 point system with hypre or
+   petsc.  Selected in the DORadiationModel block with
+
+     <LinearSolver type="sweep">
+       <max_concurrent_sweeps> 8 </max_concurrent_sweeps>
+     </LinearSolver>
+
+   A sweep of one ordinate over one patch is the unit of work.  It can
+   start once the intensities on its upwind faces are known, and
+   passes the intensities on its downwind faces to the patches across
+   them, through memory on this rank and with MPI (on a duplicate of
+   the world communicator) to other ranks.  All of a rank's patches are
+   solved in one call, so the sweeps pipeline over patches and ranks
+   (KBA wavefronts) and over ordinates (angle pipelining).  The ready
+   units are taken ordinate first, and up to max_concurrent_sweeps of
+   them are swept at the same time by the threads of parallel_for.
+
+   The solve must be called from a task over the per processor patch
+   set, on every rank that owns patches of the level.
+
+WARNING
+   Periodic boundaries are not supported: a flow cell across a
+   periodic face sees a zero upwind intensity.
+
+****************************************/
+
+class RadSweepSolver {
+
+  public:
+
+    // The inputs of one patch.  cellType and temperature need one layer
+    // of ghost cells.
+    struct PatchData {
+      const Patch*            patch;
+      constCCVariable<int>    cellType;
+      constCCVariable<double> temperature;
+      constCCVariable<double> abskt;
+      constCCVariable<double> emission;       // blackbody intensity source
+    };
+
+    // Direction cosines of an ordinate
+    struct Ordinate {
+      double mu;
+      double eta;
+      double xi;
+    };
+
+    // Fills the (in) scattering source of an ordinate on a patch.  Called
+    // concurrently for different units.
+    typedef std::function<void(int ordinate, int patch, CCVariable<double>& scatSource)> ScatterFunc;
+
+    // Receives the intensity of an ordinate on a patch, in the order
+    // the units finish.  Never called concurrently.
+    typedef std::function<void(int ordinate, int patch, CCVariable<double>& intensity)> ResultFunc;
+
+    RadSweepSolver( const ProcessorGroup* myworld );
+
+    ~RadSweepSolver();
+
+    void problemSetup( const ProblemSpecP& params );
+
+    void setLoadBalancer( LoadBalancer* lb ) { d_lb = lb; }
+
+    // Sweeps every ordinate over every patch.  scatter may be empty.
+    void solve( const std::vector<PatchData>& patches,
+                const std::vector<Ordinate>&  ordinates,
+                int                           flowCell,
+                const ScatterFunc&            scatter,
+                const ResultFunc&             result );
+
+  private:
+
+    // Intensities of the cells [low, high) of an upwind patch
+    struct Piece {
+      IntVector           low;
+      IntVector           high;
+      std::vector<double> values;
+    };
+
+    // A downwind neighbor and the cells of this patch it needs
+    struct Link {
+      const Patch* to;
+      int          rank;
+      int          local;   // index of "to" in this solve, or -1
+      IntVector    low;
+      IntVector    high;
+    };
+
+    void findLinks( const Patch* patch, int octant, bool upwind, std::vector<Link>& links ) const;
+
+    void sweep( const PatchData&            data,
+                const Ordinate&             ordinate,
+                int                         flowCell,
+                const CCVariable<double>*   scatSource,
+                const std::vector<Piece>&   upwind,
+                CCVariable<double>&         intensity ) const;
+
+    void deliver( const std::vector<double>& message );
+
+    bool receive( bool block );
+
+    const ProcessorGroup* d_myworld;
+    LoadBalancer*         d_lb;
+    MPI_Comm              d_comm;
+    int                   d_maxConcurrent;
+    int                   d_sequence;
+
+    // per solve state
+    std::map<int, int>                  d_localIndex;   // patch id -> index
+    int                                 d_numPatches;
+    std::vector< std::vector<Piece> >   d_pieces;       // per unit
+    std::vector<int>                    d_received;     // per unit
+    std::vector< std::vector<double> >  d_early;        // messages of a later solve
+
+    RadSweepSolver( const RadSweepSolver& );
+    RadSweepSolver& operator=( const RadSweepSolver& );
+};
+
+} // End namespace Uintah
+
+#endif
@@ -39,7 +39,8 @@ endif
 
 ifeq ($(HAVE_HYPRE),yes)
   SRCS += $(SRCDIR)/DORadiationModel.cc \
-          $(SRCDIR)/RadHypreSolver.cc   
+          $(SRCDIR)/RadHypreSolver.cc   \
+          $(SRCDIR)/RadSweepSolver.cc
 endif
 
 
@@ -11,6 +11,7 @@
 #include <CCA/Components/Arches/TransportEqns/DQMOMEqn.h>
 #include <CCA/Components/Arches/TransportEqns/EqnFactory.h>
 #include <CCA/Components/Arches/TransportEqns/EqnBase.h>
+#include <CCA/Ports/LoadBalancer.h>
 #include <iomanip>
 
 using namespace std;
@@ -212,7 +213,14 @@ DORadiation::sched_computeSource( const LevelP& level, SchedulerP& sched, int ti
   tsk->requires(Task::OldDW, _labels->d_cellTypeLabel, gac, 1 ); 
   tsk->requires(Task::NewDW, _labels->d_cellInfoLabel, gn);
 
-  sched->addTask(tsk, level->eachPatch(), _shared_state->allArchesMaterials()); 
+  if ( _DO_model->sweepSolverOn() ){
+    // the sweep solver needs all the patches of a rank in one task
+    LoadBalancer* lb = sched->getLoadBalancer();
+    _DO_model->setLoadBalancer( lb );
+    sched->addTask(tsk, lb->getPerProcessorPatchSet(level), _shared_state->allArchesMaterials()); 
+  } else {
+    sched->addTask(tsk, level->eachPatch(), _shared_state->allArchesMaterials()); 
+  }
 
 }
 //---------------------------------------------------------------------------
@@ -226,7 +234,9 @@ DORadiation::computeSource( const ProcessorGroup* pc,
                    DataWarehouse* new_dw, 
                    int timeSubStep )
 {
-  _DO_model->d_linearSolver->matrixCreate( _perproc_patches, patches );
+  if ( _DO_model->d_linearSolver ){
+    _DO_model->d_linearSolver->matrixCreate( _perproc_patches, patches );
+  }
 
     int timestep = _labels->d_sharedState->getCurrentTopLevelTimeStep(); 
     bool do_radiation = false; 
@@ -317,6 +327,11 @@ DORadiation::computeSource( const ProcessorGroup* pc,
     }
 
 
+  // the sweep solver does all the patches at once, after the patch loop
+  std::vector<ArchesVariables>      all_radiation_vars( patches->size() );
+  std::vector<ArchesConstVariables> all_const_radiation_vars( patches->size() );
+  std::vector<CCVariable<double> >  all_divQ( patches->size() );
+
   //patch loop
   for (int p=0; p < patches->size(); p++){
 
@@ -328,11 +343,10 @@ DORadiation::computeSource( const ProcessorGroup* pc,
     new_dw->get(cellInfoP, _labels->d_cellInfoLabel, matlIndex, patch);
     CellInformation* cellinfo = cellInfoP.get().get_rep();
 
-    CCVariable<double> divQ; 
-
+    CCVariable<double>& divQ = all_divQ[p]; 
 
-    ArchesVariables radiation_vars; 
-    ArchesConstVariables const_radiation_vars;
+    ArchesVariables& radiation_vars = all_radiation_vars[p]; 
+    ArchesConstVariables& const_radiation_vars = all_const_radiation_vars[p];
 
     Ghost::GhostType  gac = Ghost::AroundCells;
     Ghost::GhostType  gn = Ghost::None; 
@@ -398,11 +412,28 @@ DORadiation::computeSource( const ProcessorGroup* pc,
         }
 
         //Note: The final divQ is initialized (to zero) and set after the solve in the intensity solve itself.
-        _DO_model->intensitysolve( pc, patch, cellinfo, &radiation_vars, &const_radiation_vars, divQ, BoundaryCondition::WALL, matlIndex, new_dw, old_dw, old_DW_isMissingIntensities ); 
+        if ( !_DO_model->sweepSolverOn() ){
+          _DO_model->intensitysolve( pc, patch, cellinfo, &radiation_vars, &const_radiation_vars, divQ, BoundaryCondition::WALL, matlIndex, new_dw, old_dw, old_DW_isMissingIntensities ); 
+        }
 
       }
     }
   } // end patch loop
+
+  if ( do_radiation && timeSubStep == 0 && _DO_model->sweepSolverOn() ){
+
+    std::vector<ArchesVariables*>      vars;
+    std::vector<ArchesConstVariables*> constvars;
+    std::vector<CCVariable<double>*>   divQs;
+    for (int p=0; p < patches->size(); p++){
+      vars.push_back( &all_radiation_vars[p] );
+      constvars.push_back( &all_const_radiation_vars[p] );
+      divQs.push_back( &all_divQ[p] );
+    }
+
+    int matlIndex = _labels->d_sharedState->getArchesMaterial(0)->getDWIndex(); 
+    _DO_model->intensitysolveSweep( pc, patches, vars, constvars, divQs, matlIndex, new_dw, old_dw, old_DW_isMissingIntensities ); 
+  }
 }
 
 //---------------------------------------------------------------------------
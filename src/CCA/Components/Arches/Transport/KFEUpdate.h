@@ -157,7 +157,7 @@ private:
       KokkosView3<const double> k_flux_z = z_flux.getKokkosView();
 
       //time update:
-      Uintah::parallel_for( range, [&](int i, int j, int k){
+      Uintah::parallel_for( range, Uintah::BlockRangePolicy( Uintah::BlockRangePolicy::Tiled ).vectorized(), [&](int i, int j, int k){
 
         //add in the convective term
         k_rhs(i,j,k) = k_rhs(i,j,k) - ( ax * ( k_flux_x(i+1,j,k) - k_flux_x(i,j,k) ) +
@@ -174,7 +174,7 @@ private:
       timer.start("work");
 #endif
       //time update:
-      Uintah::parallel_for( range, [&](int i, int j, int k){
+      Uintah::parallel_for( range, Uintah::BlockRangePolicy( Uintah::BlockRangePolicy::Tiled ).vectorized(), [&](int i, int j, int k){
 
         //note: the source term should already be in RHS (if any) which is why we have a +=
         //add in the convective term
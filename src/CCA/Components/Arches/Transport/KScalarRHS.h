@@ -335,7 +335,7 @@ private:
       Uintah::ComputeConvectiveFlux<T> get_flux( phi, u, v, w, x_psi, y_psi, z_psi,
                                                  x_flux, y_flux, z_flux, af_x, af_y, af_z );
       Uintah::BlockRange range(patch->getCellLowIndex(), patch->getExtraCellHighIndex());
-      Uintah::parallel_for( range, get_flux );
+      Uintah::parallel_for( range, Uintah::BlockRangePolicy( Uintah::BlockRangePolicy::Tiled ).vectorized(), get_flux );
     }
 
     //Diffusion:
@@ -348,7 +348,7 @@ private:
 
       Uintah::BlockRange range_diff(low_patch_range, high_patch_range);
 
-      Uintah::parallel_for( range_diff, [&](int i, int j, int k){
+      Uintah::parallel_for( range_diff, Uintah::BlockRangePolicy( Uintah::BlockRangePolicy::Tiled ).vectorized(), [&](int i, int j, int k){
 
         rhs(i,j,k) += ax/(2.*Dx.x()) * ( af_x(i+1,j,k) * ( D(i+1,j,k) + D(i,j,k))   * (phi(i+1,j,k) - phi(i,j,k))
                                        - af_x(i,j,k)   * ( D(i,j,k)   + D(i-1,j,k)) * (phi(i,j,k)   - phi(i-1,j,k)) ) +
@@ -369,7 +369,7 @@ private:
       double weight = (*i).weight;
       Uintah::BlockRange src_range(patch->getCellLowIndex(), patch->getCellHighIndex());
 
-      Uintah::parallel_for( src_range, [&](int i, int j, int k){
+      Uintah::parallel_for( src_range, Uintah::BlockRangePolicy( Uintah::BlockRangePolicy::Tiled ).vectorized(), [&](int i, int j, int k){
 
         rhs(i,j,k) += weight * src(i,j,k) * V;
 
@@ -39,6 +39,7 @@
 #include <Core/Grid/Grid.h>
 #include <Core/Grid/Patch.h>
 #include <Core/Grid/Task.h>
+#include <Core/Grid/UdaSidecar.h>
 #include <Core/Grid/Variables/VarTypes.h>
 #include <Core/Parallel/Parallel.h>
 #include <Core/Parallel/ProcessorGroup.h>
@@ -1386,6 +1387,10 @@ DataArchiver::writeto_xml_files(double delt, const GridP& grid)
       int numLevels = grid->numLevels();
       vector<vector<int> > procOnLevel(numLevels);
 
+      // output proc of each patch and the <Data> file list, for grid.bin
+      vector<vector<int> > gridProcMap(numLevels);
+      vector<string>       datafiles;
+
       //  Break out the <Grid> and <Data> sections and write those to a
       // "grid.xml" section using libxml2's TextWriter which is a streaming
       //  output format which doesn't use a DOM tree.
@@ -1548,6 +1553,7 @@ DataArchiver::writeto_xml_files(double delt, const GridP& grid)
           
           int proc = lb->getOutputProc(patch);
           procOnLevel[l][proc] = 1;
+          gridProcMap[l].push_back(proc);
 
           Box box = patch->getExtraBox();
 #ifndef XML_TEXTWRITER
@@ -1668,6 +1674,7 @@ DataArchiver::writeto_xml_files(double delt, const GridP& grid)
           
           ostringstream pname;
           pname << lname.str() << "/p" << setw(5) << setfill('0') << i << ".xml";
+          datafiles.push_back(pname.str());
 #ifndef XML_TEXTWRITER
           ProblemSpecP df = dataElem->appendChild("Datafile");
 #else
@@ -1694,6 +1701,7 @@ DataArchiver::writeto_xml_files(double delt, const GridP& grid)
       }
 
       if (hasGlobals) {
+        datafiles.push_back("global.xml");
 #ifndef XML_TEXTWRITER
         ProblemSpecP df = dataElem->appendChild("Datafile");
         df->setAttribute("href", "global.xml");
@@ -1709,6 +1717,14 @@ DataArchiver::writeto_xml_files(double delt, const GridP& grid)
       xmlTextWriterEndDocument(writer_grid); // Writes output to the timestep.xml file
       xmlFreeTextWriter(writer_grid);
 #endif
+
+      // Binary copy of the <Grid> and <Data> sections that the DataArchive
+      // reads instead of parsing them (see UdaSidecar).
+      string name_gridbin = baseDirs[i]->getName()+"/"+tname.str()+"/grid.bin";
+      if( !UdaSidecar::writeGrid( name_gridbin, grid.get_rep(), gridProcMap, datafiles ) ) {
+        unlink( name_gridbin.c_str() );
+      }
+
       // Add the <Materials> section to the timestep.xml
       SimulationInterface* sim = 
         dynamic_cast<SimulationInterface*>(getPort("sim")); 
@@ -2215,6 +2231,7 @@ DataArchiver::outputVariables(const ProcessorGroup * pg,
       }
       
       doc->output(xmlFilename.c_str());
+      UdaSidecar::writeIndex( UdaSidecar::indexFilename( xmlFilename ), doc );
       //doc->releaseDocument();
       double myTime = Time::currentSeconds()-start;
       double byteToMB = 1024*1024;
@@ -24,6 +24,8 @@
 
 
 #include <CCA/Components/Examples/AMRWave.h>
+#include <Core/Grid/AMR.h>
+#include <Core/Grid/AMR_CoarsenRefine.h>
 #include <Core/Grid/Variables/CellIterator.h>
 #include <Core/Grid/Variables/CCVariable.h>
 #include <Core/Grid/Level.h>
@@ -250,29 +252,6 @@ void AMRWave::refineCell(CCVariable<double>& finevar, constCCVariable<double>& c
 }
 //______________________________________________________________________
 //
-void AMRWave::coarsenCell(CCVariable<double>& coarsevar, constCCVariable<double>& finevar, IntVector coarseIndex,
-                    const Level* fineLevel, const Level* coarseLevel)
-{
-  double tmp=0; 
-
-  // starting coarse point - will interp 8 cells starting here.  On the +x, +y, +z faces, subtract 1
-  IntVector fineStart(coarseLevel->mapCellToFiner(coarseIndex));
-  IntVector crr = fineLevel->getRefinementRatio();
-
-  // amrwave << "coarsenCell on level " << coarseLevel->getIndex() << " coarse Index " << coarseIndex << " " << coarseLevel->getCellPosition(coarseIndex) << " fine range = " 
-  //        << fineStart << " " << fineStart+crr << endl << "  FVs: ";
-
-  // find all the fine cells, average the values; no need to weight, as they are equidistant
-  for(CellIterator inside(IntVector(0,0,0), crr); !inside.done(); inside++){
-    // amrwave << finevar[fineStart + *inside] << ' ';
-    tmp +=finevar[fineStart + *inside];
-  }
-
-  coarsevar[coarseIndex]=tmp/(crr.x()*crr.y()*crr.z());
-  // amrwave << ": " << coarsevar[coarseIndex] << endl;
-}
-//______________________________________________________________________
-//
 void AMRWave::refine(const ProcessorGroup*,
                      const PatchSubset* patches,
                      const MaterialSubset* matls,
@@ -295,8 +274,6 @@ void AMRWave::refine(const ProcessorGroup*,
       
       new_dw->allocateAndPut(phi, phi_label, matl, finePatch);
       new_dw->allocateAndPut(pi, pi_label, matl, finePatch);
-      pi.initialize(0);
-      phi.initialize(0);
 
       IntVector coarsePhiLow  = fineLevel->mapCellToCoarser(phi.getLowIndex()) - IntVector(1,1,1);
       IntVector coarsePhiHigh = fineLevel->mapCellToCoarser(phi.getHighIndex()+fineLevel->getRefinementRatio() - IntVector(1,1,1)) + IntVector(1,1,1);
@@ -308,21 +285,11 @@ void AMRWave::refine(const ProcessorGroup*,
       // amrwave << "   Calling getRegion for Pi: " << coarsePiLow << " " << coarsePiHigh << endl;
       new_dw->getRegion(coarse_pi, pi_label, matl, coarseLevel, coarsePiLow, coarsePiHigh);
 
-      // simple linear interpolation (maybe)
-      for(CellIterator iter(phi.getLowIndex(), phi.getHighIndex()); !iter.done(); iter++){
-        // refine phi
-        refineCell(phi, coarse_phi, *iter, fineLevel, coarseLevel);
-
-        // phi extends (potentially) one more cell than pi.
-        IntVector pilow, pihigh;
-        pilow = pi.getLow();
-        pihigh = pi.getHigh();
-        
-        if ((*iter).x() >= pilow.x() && (*iter).y() >= pilow.y() && (*iter).z() >= pilow.z() &&
-          (*iter).x() < pihigh.x() && (*iter).y() < pihigh.y() && (*iter).z() < pihigh.z()) {
-          refineCell(pi, coarse_pi, *iter, fineLevel, coarseLevel);
-        }
-      }
+      // trilinear interpolation; phi extends (potentially) one more cell than pi.
+      linearInterpolation<double>(coarse_phi, coarseLevel, fineLevel, fineLevel->getRefinementRatio(),
+                                  phi.getLowIndex(), phi.getHighIndex(), phi);
+      linearInterpolation<double>(coarse_pi, coarseLevel, fineLevel, fineLevel->getRefinementRatio(),
+                                  pi.getLowIndex(), pi.getHighIndex(), pi);
     } // matls
   } // finePatches
 }
@@ -335,6 +302,8 @@ void AMRWave::coarsen(const ProcessorGroup*,
 {
   const Level* coarseLevel = getLevel(patches);
   const Level* fineLevel = coarseLevel->getFinerLevel().get_rep();
+  IntVector crr = fineLevel->getRefinementRatio();
+  double ratio = 1. / (crr.x() * crr.y() * crr.z());
 
   for (int p = 0; p < patches->size(); p++) {  
     const Patch* coarsePatch = patches->get(p);
@@ -362,13 +331,14 @@ void AMRWave::coarsen(const ProcessorGroup*,
         new_dw->get(fine_phi, phi_label, matl, finePatch, Ghost::None, 0);
         new_dw->get(fine_pi, pi_label, matl, finePatch, Ghost::None, 0);
 
-        // simple linear interpolation (maybe) - don't coarsen to phi's boundary
-        for(CellIterator iter(Max(pi.getLowIndex(), fineLevel->mapCellToCoarser(fine_pi.getLowIndex())), 
-                              Min(pi.getHighIndex(), fineLevel->mapCellToCoarser(fine_pi.getHighIndex()))); 
-            !iter.done(); iter++){
-          coarsenCell(phi, fine_phi, *iter, fineLevel, coarseLevel);
-          coarsenCell(pi, fine_phi, *iter, fineLevel, coarseLevel);
-        }
+        // average the fine cells - don't coarsen to phi's boundary
+        IntVector cl = Max(pi.getLowIndex(), fineLevel->mapCellToCoarser(fine_pi.getLowIndex()));
+        IntVector ch = Min(pi.getHighIndex(), fineLevel->mapCellToCoarser(fine_pi.getHighIndex()));
+        IntVector fl = coarseLevel->mapCellToFiner(cl);
+        IntVector fh = coarseLevel->mapCellToFiner(ch);
+
+        coarsenDriver_std(cl, ch, fl, fh, crr, ratio, coarseLevel, fine_phi, phi);
+        coarsenDriver_std(cl, ch, fl, fh, crr, ratio, coarseLevel, fine_phi, pi);
       } // finePatches
     } // matls
   } // patches
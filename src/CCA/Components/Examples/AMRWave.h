@@ -103,8 +103,6 @@ WARNING
 
     void refineCell(CCVariable<double>& finevar, constCCVariable<double>& coarsevar, IntVector fineIndex,
                     const Level* fineLevel, const Level* coarseLevel); 
-    void coarsenCell(CCVariable<double>& coarsevar, constCCVariable<double>& finevar, IntVector coarseIndex,
-                    const Level* fineLevel, const Level* coarseLevel); 
 
     AMRWave(const AMRWave&);
     AMRWave& operator=(const AMRWave&);
@@ -24,6 +24,7 @@
 
 #include <CCA/Components/ICE/Advection/SecondOrderAdvector.h>
 #include <CCA/Ports/DataWarehouse.h>
+#include <Core/Grid/Variables/StencilView.h>
 #include <Core/Grid/Variables/VarLabel.h>
 #include <Core/Grid/Patch.h>
 #include <Core/Grid/Level.h>
@@ -574,24 +575,45 @@ void SecondOrderAdvector::q_FC_operator(CellIterator iter,
                                         const CCVariable<double>& q_CC,
                                         T& q_FC)
 { 
-  for(;!iter.done(); iter++){
-    IntVector R = *iter;      
-    IntVector L = R + adj_offset; 
-     
-     // face:           LEFT,   BOTTOM,   BACK  
-     // IF_slab[face]:  RIGHT,  TOP,      FRONT
-    double outfluxVol = OFS[R].d_fflux[face];
-    double influxVol  = OFS[L].d_fflux[IF_slab[face]];
-                       
-    double q_faceFlux = q_OAFS[L].d_data[IF_slab[face]] * influxVol 
-                      - q_OAFS[R].d_data[face] * outfluxVol;
-                      
-    double faceVol = outfluxVol + influxVol;
-    
-    double q_tmp_FC = fabs(q_faceFlux)/(faceVol + 1.0e-100);
-    
-    // if q_tmp_FC = 0.0 then set it equal to q_CC[c]
-    q_FC[R] = equalZero(q_faceFlux, q_CC[R], q_tmp_FC);
+  StencilView<const fflux>             OFS_view(OFS);
+  StencilView<const facedata<double> > q_OAFS_view(q_OAFS);
+  StencilView<const double>            q_CC_view(q_CC);
+  StencilView<double>                  q_FC_view(q_FC);
+
+  // offset of the L cell (R + adj_offset)
+  const long OFS_L    = OFS_view.neighbor(adj_offset);
+  const long q_OAFS_L = q_OAFS_view.neighbor(adj_offset);
+
+  // face:           LEFT,   BOTTOM,   BACK  
+  // IF_slab[face]:  RIGHT,  TOP,      FRONT
+  const int inface = IF_slab[face];
+
+  const IntVector low  = iter.begin();
+  const IntVector high = iter.end();
+
+  for(int k = low.z(); k < high.z(); k++){
+    for(int j = low.y(); j < high.y(); j++){
+      StencilLine<const fflux>             OFS_line    = OFS_view.line(j, k);
+      StencilLine<const facedata<double> > q_OAFS_line = q_OAFS_view.line(j, k);
+      StencilLine<const double>            q_CC_line   = q_CC_view.line(j, k);
+      StencilLine<double>                  q_FC_line   = q_FC_view.line(j, k);
+
+      UINTAH_VECTORIZE_LOOP
+      for(int i = low.x(); i < high.x(); i++){
+        double outfluxVol = OFS_line[i].d_fflux[face];
+        double influxVol  = OFS_line(i, OFS_L).d_fflux[inface];
+
+        double q_faceFlux = q_OAFS_line(i, q_OAFS_L).d_data[inface] * influxVol 
+                          - q_OAFS_line[i].d_data[face] * outfluxVol;
+
+        double faceVol = outfluxVol + influxVol;
+
+        double q_tmp_FC = fabs(q_faceFlux)/(faceVol + 1.0e-100);
+
+        // if q_tmp_FC = 0.0 then set it equal to q_CC[c]
+        q_FC_line[i] = equalZero(q_faceFlux, q_CC_line[i], q_tmp_FC);
+      }
+    }
   }
 }
 
@@ -53,6 +53,7 @@
 #include <Core/Grid/Task.h>
 #include <Core/Grid/Variables/VarTypes.h>
 #include <Core/Grid/Variables/CellIterator.h>
+#include <Core/Grid/Variables/StencilView.h>
 #include <Core/Grid/BoundaryConditions/BCUtils.h>
 
 #include <Core/Exceptions/ParameterNotFound.h>
@@ -2470,6 +2471,119 @@ void ICE::computeThermoTransportProperties(const ProcessorGroup*,
 
 Note:  The nomenclature follows the reference.   
 _____________________________________________________________________*/
+int ICE::solveEquilibrationPressure(const IntVector& c,
+                                    const StaticArray<EquationOfState*>& eos,
+                                    const StaticArray<constCCVariable<double> >& gamma,
+                                    const StaticArray<constCCVariable<double> >& cv,
+                                    const StaticArray<constCCVariable<double> >& Temp,
+                                    const StaticArray<constCCVariable<double> >& rho_CC,
+                                    StaticArray<CCVariable<double> >& rho_micro,
+                                    StaticArray<CCVariable<double> >& vol_frac,
+                                    StaticArray<CCVariable<double> >& speedSound,
+                                    CCVariable<double>& press_new,
+                                    const int    max_iter,
+                                    const double convergence_crit,
+                                    const double SMALL_NUM,
+                                    double& sum,
+                                    vector<EqPress_dbg>* dbgEqPress)
+{
+  int numMatls = eos.size();
+  ASSERT(numMatls <= MAX_MATLS);
+  double press_eos[MAX_MATLS], dp_drho[MAX_MATLS], dp_de[MAX_MATLS];
+
+  double delPress  = 0.;
+  bool   converged = false;
+  int    count     = 0;
+
+  while ( count < max_iter && converged == false) {
+    count++;
+
+    //__________________________________
+    // evaluate press_eos at cell i,j,k
+    for (int m = 0; m < numMatls; m++)  {
+      eos[m]->computePressEOS(rho_micro[m][c],gamma[m][c],
+                              cv[m][c], Temp[m][c],press_eos[m],
+                              dp_drho[m], dp_de[m]);
+    }
+
+    //__________________________________
+    // - compute delPress
+    // - update press_CC     
+    double A = 0., B = 0., C = 0.;
+    for (int m = 0; m < numMatls; m++)   {
+      double Q =  press_new[c] - press_eos[m];
+      double div_y =  (vol_frac[m][c] * vol_frac[m][c])
+                    / (dp_drho[m] * rho_CC[m][c] + SMALL_NUM);
+      A   +=  vol_frac[m][c];
+      B   +=  Q*div_y;
+      C   +=  div_y;
+    }
+    double vol_frac_not_close_packed = 1.0;
+    delPress = (A - vol_frac_not_close_packed - B)/C;
+
+    press_new[c] += delPress;
+
+    //__________________________________
+    // backout rho_micro_CC at this new pressure
+    for (int m = 0; m < numMatls; m++) {
+      rho_micro[m][c] =
+        eos[m]->computeRhoMicro(press_new[c],gamma[m][c],
+                                cv[m][c],Temp[m][c],rho_micro[m][c]);
+
+      double div = 1./rho_micro[m][c];
+
+      // - updated volume fractions
+      vol_frac[m][c]   = rho_CC[m][c]*div;
+    }
+    //__________________________________
+    // - Test for convergence
+    //  If sum of vol_frac_CC ~= vol_frac_not_close_packed then converged
+    sum = 0.0;
+    for (int m = 0; m < numMatls; m++)  {
+      sum += vol_frac[m][c];
+    }
+    if (fabs(sum-1.0) < convergence_crit){
+      converged = true;
+      //__________________________________
+      // Find the speed of sound based on converged solution
+      for (int m = 0; m < numMatls; m++) {
+        eos[m]->computePressEOS(rho_micro[m][c],gamma[m][c],
+                                cv[m][c],Temp[m][c],
+                                press_eos[m],dp_drho[m], dp_de[m]);
+
+        double tmp = dp_drho[m]
+                   + dp_de[m] * press_eos[m]/(rho_micro[m][c] * rho_micro[m][c]);
+        speedSound[m][c] = sqrt(tmp);
+      }
+    }
+
+    // Save iteration data for output in case of crash
+    if(dbgEqPress){
+      EqPress_dbg dbg;
+      dbg.delPress     = delPress;
+      dbg.press_new    = press_new[c];
+      dbg.sumVolFrac   = sum;
+      dbg.count        = count;
+
+      for (int m = 0; m < numMatls; m++) {
+        EqPress_dbgMatl dmatl;
+        dmatl.press_eos   = press_eos[m];
+        dmatl.volFrac     = vol_frac[m][c];
+        dmatl.rhoMicro    = rho_micro[m][c];
+        dmatl.rho_CC      = rho_CC[m][c];
+        dmatl.temp_CC     = Temp[m][c];
+        dmatl.mat         = m;
+        dbg.matl.push_back(dmatl);
+      }
+      dbgEqPress->push_back(dbg);
+    }
+  }   // end of converged
+
+  return count;
+}
+
+//______________________________________________________________________
+//
 void ICE::computeEquilibrationPressure(const ProcessorGroup*,
                                        const PatchSubset* patches,
                                        const MaterialSubset* /*matls*/,
@@ -2486,14 +2600,12 @@ void ICE::computeEquilibrationPressure(const ProcessorGroup*,
     
     double    converg_coeff = 15;              
     double    convergence_crit = converg_coeff * DBL_EPSILON;
-    double    sum=0., tmp;
+    double    sum=0.;
 
     int       numMatls = d_sharedState->getNumICEMatls();
     static int n_passes;                  
     n_passes ++; 
 
-    StaticArray<double> press_eos(numMatls);
-    StaticArray<double> dp_drho(numMatls),dp_de(numMatls);
     StaticArray<CCVariable<double> > vol_frac(numMatls);
     StaticArray<CCVariable<double> > rho_micro(numMatls);
     StaticArray<CCVariable<double> > rho_CC_new(numMatls);
@@ -2555,100 +2667,20 @@ void ICE::computeEquilibrationPressure(const ProcessorGroup*,
 
   //______________________________________________________________________
   // Done with preliminary calcs, now loop over every cell
+    StaticArray<EquationOfState*> eos(numMatls);
+    for (int m = 0; m < numMatls; m++) {
+      eos[m] = d_sharedState->getICEMaterial(m)->getEOS();
+    }
+
     int count, test_max_iter = 0;
     for (CellIterator iter=patch->getExtraCellIterator();!iter.done();iter++) {
       IntVector c = *iter;   
-      double delPress = 0.;
-      bool converged  = false;
-      count           = 0;
       vector<EqPress_dbg> dbgEqPress;
 
-      while ( count < d_max_iter_equilibration && converged == false) {
-        count++;
-
-        //__________________________________
-        // evaluate press_eos at cell i,j,k
-        for (int m = 0; m < numMatls; m++)  {
-          ICEMaterial* ice_matl = d_sharedState->getICEMaterial(m);
-          ice_matl->getEOS()->computePressEOS(rho_micro[m][c],gamma[m][c],
-                                              cv[m][c], Temp[m][c],press_eos[m],
-                                              dp_drho[m], dp_de[m]);
-        }
-
-        //__________________________________
-        // - compute delPress
-        // - update press_CC     
-        double A = 0., B = 0., C = 0.;
-        for (int m = 0; m < numMatls; m++)   {
-          double Q =  press_new[c] - press_eos[m];
-          double div_y =  (vol_frac[m][c] * vol_frac[m][c])
-                        / (dp_drho[m] * rho_CC[m][c] + d_SMALL_NUM);
-          A   +=  vol_frac[m][c];
-          B   +=  Q*div_y;
-          C   +=  div_y;
-        }
-        double vol_frac_not_close_packed = 1.0;
-        delPress = (A - vol_frac_not_close_packed - B)/C;
-
-        press_new[c] += delPress;
-
-        //__________________________________
-        // backout rho_micro_CC at this new pressure
-        for (int m = 0; m < numMatls; m++) {
-          ICEMaterial* ice_matl = d_sharedState->getICEMaterial(m);
-          rho_micro[m][c] =
-           ice_matl->getEOS()->computeRhoMicro(press_new[c],gamma[m][c],
-                                          cv[m][c],Temp[m][c],rho_micro[m][c]);
-
-          double div = 1./rho_micro[m][c];
-
-          // - updated volume fractions
-          vol_frac[m][c]   = rho_CC[m][c]*div;
-        }
-        //__________________________________
-        // - Test for convergence
-        //  If sum of vol_frac_CC ~= vol_frac_not_close_packed then converged
-        sum = 0.0;
-        for (int m = 0; m < numMatls; m++)  {
-          sum += vol_frac[m][c];
-        }
-        if (fabs(sum-1.0) < convergence_crit){
-          converged = true;
-          //__________________________________
-          // Find the speed of sound based on converged solution
-          for (int m = 0; m < numMatls; m++) {
-            ICEMaterial* ice_matl = d_sharedState->getICEMaterial(m);
-            ice_matl->getEOS()->computePressEOS(rho_micro[m][c],gamma[m][c],
-                                            cv[m][c],Temp[m][c],
-                                            press_eos[m],dp_drho[m], dp_de[m]);
-
-            tmp = dp_drho[m]
-                + dp_de[m] * press_eos[m]/(rho_micro[m][c] * rho_micro[m][c]);
-            speedSound_new[m][c] = sqrt(tmp);
-          }
-        }
-
-        // Save iteration data for output in case of crash
-        if(ds_EqPress.active()){
-          EqPress_dbg dbg;
-          dbg.delPress     = delPress;
-          dbg.press_new    = press_new[c];
-          dbg.sumVolFrac   = sum;
-          dbg.count        = count;
-
-          for (int m = 0; m < numMatls; m++) {
-            EqPress_dbgMatl dmatl;
-            dmatl.press_eos   = press_eos[m];
-            dmatl.volFrac     = vol_frac[m][c];
-            dmatl.rhoMicro    = rho_micro[m][c];
-            dmatl.rho_CC      = rho_CC[m][c];
-            dmatl.temp_CC     = Temp[m][c];
-            dmatl.mat         = m;
-            dbg.matl.push_back(dmatl);
-          }
-          dbgEqPress.push_back(dbg);
-        }
-      }   // end of converged
+      count = solveEquilibrationPressure(c, eos, gamma, cv, Temp, rho_CC,
+                                         rho_micro, vol_frac, speedSound_new, press_new,
+                                         d_max_iter_equilibration, convergence_crit, d_SMALL_NUM,
+                                         sum, ds_EqPress.active() ? &dbgEqPress : nullptr);
 
       test_max_iter = std::max(test_max_iter, count);
 
@@ -3199,37 +3231,67 @@ template<class T> void ICE::computeVelFace(int dir,
     one_or_zero=0.0;
   }
   
-  for(;!it.done(); it++){
-    IntVector R = *it;
-    IntVector L = R + adj_offset; 
-
-    double rho_FC = rho_CC[L] + rho_CC[R];
+  StencilView<const double> rho(rho_CC);
+  StencilView<const double> sp_vol(sp_vol_CC);
+  StencilView<const double> press(press_CC);
+  StencilView<const Vector> vel(vel_CC);
+  StencilView<double>       velFC(vel_FC);
+  StencilView<double>       gradP(grad_P_FC);
+
+  // offset of the L cell (R + adj_offset) in each variable
+  const long rho_L    = rho.neighbor(adj_offset);
+  const long sp_vol_L = sp_vol.neighbor(adj_offset);
+  const long press_L  = press.neighbor(adj_offset);
+  const long vel_L    = vel.neighbor(adj_offset);
+
+  const IntVector low  = it.begin();
+  const IntVector high = it.end();
+
+  for(int k = low.z(); k < high.z(); k++){
+    for(int j = low.y(); j < high.y(); j++){
+      StencilLine<const double> rho_line    = rho.line(j, k);
+      StencilLine<const double> sp_vol_line = sp_vol.line(j, k);
+      StencilLine<const double> press_line  = press.line(j, k);
+      StencilLine<const Vector> vel_line    = vel.line(j, k);
+      StencilLine<double>       velFC_line  = velFC.line(j, k);
+      StencilLine<double>       gradP_line  = gradP.line(j, k);
+
+      UINTAH_VECTORIZE_LOOP
+      for(int i = low.x(); i < high.x(); i++){
+        double rho_L_CC = rho_line(i, rho_L);
+        double rho_R_CC = rho_line[i];
+        double rho_FC   = rho_L_CC + rho_R_CC;
 #if SCI_ASSERTION_LEVEL >=2
-    if (rho_FC <= 0.0) {
-      cout << d_myworld->myrank() << " rho_fc <= 0: " << rho_FC << " with L= " << L << " (" 
-           << rho_CC[L] << ") R= " << R << " (" << rho_CC[R]<< ")\n";
-    }
+        if (rho_FC <= 0.0) {
+          IntVector R(i, j, k);
+          IntVector L = R + adj_offset;
+          cout << d_myworld->myrank() << " rho_fc <= 0: " << rho_FC << " with L= " << L << " (" 
+               << rho_L_CC << ") R= " << R << " (" << rho_R_CC << ")\n";
+        }
 #endif
-    ASSERT(rho_FC > 0.0);
+        ASSERT(rho_FC > 0.0);
 
-    //__________________________________
-    // interpolation to the face
-    double term1 = (rho_CC[L] * vel_CC[L][dir] +
-                    rho_CC[R] * vel_CC[R][dir])/(rho_FC);            
-    //__________________________________
-    // pressure term           
-    double sp_vol_brack = 2.*(sp_vol_CC[L] * sp_vol_CC[R])/
-                             (sp_vol_CC[L] + sp_vol_CC[R]); 
-                             
-    grad_P_FC[R] = (press_CC[R] - press_CC[L]) * inv_dx;
-    double term2 = delT * sp_vol_brack * grad_P_FC[R];
-     
-    //__________________________________
-    // gravity term
-    double term3 =  delT * gravity;
-    
-    vel_FC[R] = term1 - one_or_zero*term2 + one_or_zero*term3;
-  } 
+        //__________________________________
+        // interpolation to the face
+        double term1 = (rho_L_CC * vel_line(i, vel_L)[dir] +
+                        rho_R_CC * vel_line[i][dir])/(rho_FC);
+        //__________________________________
+        // pressure term
+        double sp_vol_L_CC  = sp_vol_line(i, sp_vol_L);
+        double sp_vol_brack = 2.*(sp_vol_L_CC * sp_vol_line[i])/
+                                 (sp_vol_L_CC + sp_vol_line[i]);
+
+        gradP_line[i] = (press_line[i] - press_line(i, press_L)) * inv_dx;
+        double term2 = delT * sp_vol_brack * gradP_line[i];
+
+        //__________________________________
+        // gravity term
+        double term3 =  delT * gravity;
+
+        velFC_line[i] = term1 - one_or_zero*term2 + one_or_zero*term3;
+      }
+    }
+  }
 }
                   
 //______________________________________________________________________
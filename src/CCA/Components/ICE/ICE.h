@@ -89,6 +89,7 @@ void launchIceEquilibrationKernelUnified(dim3 dimGrid,
 
 namespace Uintah {
 
+  class EquationOfState;
   class ModelInfo;
   class ModelInterface;
   class Turbulence;
@@ -407,6 +408,26 @@ namespace Uintah {
                                         DataWarehouse*,
                                         DataWarehouse*);
 
+      // The per cell Newton iteration of computeEquilibrationPressure: moves
+      // press_new[c] until the volume fractions sum to one (sum returns that
+      // sum) and sets speedSound once converged.  Returns the number of
+      // iterations.  If dbgEqPress is given, each iteration is recorded.
+      static int solveEquilibrationPressure(const IntVector& c,
+                                            const StaticArray<EquationOfState*>& eos,
+                                            const StaticArray<constCCVariable<double> >& gamma,
+                                            const StaticArray<constCCVariable<double> >& cv,
+                                            const StaticArray<constCCVariable<double> >& Temp,
+                                            const StaticArray<constCCVariable<double> >& rho_CC,
+                                            StaticArray<CCVariable<double> >& rho_micro,
+                                            StaticArray<CCVariable<double> >& vol_frac,
+                                            StaticArray<CCVariable<double> >& speedSound,
+                                            CCVariable<double>& press_new,
+                                            const int    max_iter,
+                                            const double convergence_crit,
+                                            const double SMALL_NUM,
+                                            double& sum,
+                                            std::vector<EqPress_dbg>* dbgEqPress = nullptr);
+
 
 #ifdef HAVE_CUDA
 
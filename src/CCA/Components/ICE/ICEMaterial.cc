@@ -36,6 +36,7 @@
 #include <Core/GeometryPiece/GeometryPieceFactory.h>
 #include <Core/GeometryPiece/UnionGeometryPiece.h>
 
+#include <Core/Grid/Box.h>
 #include <Core/Grid/Patch.h>
 #include <Core/Grid/Variables/CellIterator.h>
 #include <Core/ProblemSpec/ProblemSpec.h>
@@ -254,6 +255,11 @@ void ICEMaterial::initializeCells(CCVariable<double>& rho_micro,
       // For some reason, if I call readPoints here, I get two copies of the
       // points, so evidently the fgp is being carried over from MPMMaterial
   //    fgp->readPoints(patch->getID());
+      // Blocked files replace the points with those of this patch instead
+      // of adding to them, and are only read by patch.
+      if(fgp->isBlocked()){
+        fgp->readPoints(patch);
+      }
       int numPts = fgp->returnPointCount();
       vector<Point>* points = fgp->getPoints();
       if(numMatls > 2)  {
@@ -297,22 +303,38 @@ void ICEMaterial::initializeCells(CCVariable<double>& rho_micro,
       Vector dxpp     = patch->dCell()/ppc;
       Vector dcorner  = dxpp*0.5;
       double totalppc = ppc.x()*ppc.y()*ppc.z();
+      Vector span     = dxpp*(ppc - IntVector(1,1,1));
+
+      vector<Point> cellPoints;
+      vector<bool>  cellInside;
+      cellPoints.reserve((int)totalppc);
 
       for(CellIterator iter = patch->getExtraCellIterator();!iter.done();iter++){
         IntVector c = *iter;
         Point lower = patch->nodePosition(c) + dcorner;
         int count = 0;
 
-        for(int ix=0;ix < ppc.x(); ix++){
-          for(int iy=0;iy < ppc.y(); iy++){
-            for(int iz=0;iz < ppc.z(); iz++){
+        // only test the points of cells the surface passes through
+        GeometryPiece::Classification cls = piece->classify(Box(lower, lower + span));
 
-              IntVector idx(ix, iy, iz);
-              Point p = lower + dxpp*idx;
-              if(piece->inside(p))
-                count++;
+        if(cls == GeometryPiece::Inside){
+          count = (int)totalppc;
+        }
+        else if(cls == GeometryPiece::Boundary){
+          cellPoints.clear();
+          for(int ix=0;ix < ppc.x(); ix++){
+            for(int iy=0;iy < ppc.y(); iy++){
+              for(int iz=0;iz < ppc.z(); iz++){
+                IntVector idx(ix, iy, iz);
+                cellPoints.push_back(lower + dxpp*idx);
+              }
             }
           }
+          piece->insideBatch(cellPoints, cellInside);
+          for(unsigned i = 0; i < cellInside.size(); i++){
+            if(cellInside[i])
+              count++;
+          }
         }
         //__________________________________
         // For single materials with more than one object 
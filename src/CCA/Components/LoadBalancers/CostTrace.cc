@@ -0,0 +1,261 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <CCA/Components/LoadBalancers/CostTrace.h>
+#include <CCA/Ports/LoadBalancer.h>
+
+#include <Core/Exceptions/InternalError.h>
+#include <Core/Grid/Level.h>
+#include <Core/Grid/Patch.h>
+#include <Core/Parallel/Parallel.h>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace Uintah;
+using namespace std;
+
+namespace {
+
+  void readTriple( istream & in, double & x, double & y, double & z )
+  {
+    in >> x >> y >> z;
+  }
+
+  void readTriple( istream & in, IntVector & v )
+  {
+    int x, y, z;
+    in >> x >> y >> z;
+    v = IntVector(x, y, z);
+  }
+
+  void expect( istream & in, const string & token )
+  {
+    string s;
+    in >> s;
+    if( !in || s != token ) {
+      throw InternalError( "CostTrace: expected '" + token + "', found '" + s + "'", __FILE__, __LINE__ );
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+CostTrace::CostTrace( const ProcessorGroup * myworld, const string & filename ) :
+  d_myworld(myworld), d_filename(filename)
+{
+  if( d_myworld->myrank() == 0 ) {
+    d_out.open( d_filename.c_str() );
+    if( !d_out ) {
+      throw InternalError( "CostTrace: unable to open " + d_filename + " for writing", __FILE__, __LINE__ );
+    }
+  }
+}
+
+CostTrace::~CostTrace()
+{
+  if( d_out.is_open() ) {
+    d_out.close();
+  }
+}
+
+//______________________________________________________________________
+//
+void
+CostTrace::addContribution( const PatchSubset * patches, double cost )
+{
+  if( patches == 0 || patches->size() == 0 ) {
+    return;
+  }
+
+  double cells = 0;
+  for( int p = 0; p < patches->size(); p++ ) {
+    cells += patches->get(p)->getNumCells();
+  }
+
+  for( int p = 0; p < patches->size(); p++ ) {
+    const Patch* patch = patches->get(p);
+    double fraction = cells > 0 ? patch->getNumCells() / cells : 1.0 / patches->size();
+    d_costs[patch->getID()] += fraction * cost;
+  }
+}
+
+//______________________________________________________________________
+//
+void
+CostTrace::record( const Grid                    * grid,
+                         int                       timestep,
+                         LoadBalancer            * lb,
+                   const vector< vector<int> >   & num_particles )
+{
+  int num_patches = 0;
+  for( int l = 0; l < grid->numLevels(); l++ ) {
+    num_patches += grid->getLevel(l)->numPatches();
+  }
+
+  // each patch's cost is only known to the processors that ran its tasks
+  vector<double> costs( num_patches, 0 );
+  int index = 0;
+  for( int l = 0; l < grid->numLevels(); l++ ) {
+    const LevelP& level = grid->getLevel(l);
+    for( int p = 0; p < level->numPatches(); p++, index++ ) {
+      map<int, double>::const_iterator iter = d_costs.find( level->getPatch(p)->getID() );
+      if( iter != d_costs.end() ) {
+        costs[index] = iter->second;
+      }
+    }
+  }
+  d_costs.clear();
+
+  vector<double> total_costs( num_patches, 0 );
+  if( d_myworld->size() > 1 ) {
+    Uintah::MPI::Reduce( &costs[0], &total_costs[0], num_patches, MPI_DOUBLE, MPI_SUM, 0, d_myworld->getComm() );
+  }
+  else {
+    total_costs.swap( costs );
+  }
+
+  if( d_myworld->myrank() != 0 ) {
+    return;
+  }
+
+  Step step;
+  step.timestep = timestep;
+  index = 0;
+  for( int l = 0; l < grid->numLevels(); l++ ) {
+    const LevelP& level = grid->getLevel(l);
+
+    LevelRecord level_record;
+    level_record.anchor     = level->getAnchor();
+    level_record.dcell      = level->dCell();
+    level_record.extraCells = level->getExtraCells();
+    level_record.periodic   = level->getPeriodicBoundaries();
+    step.levels.push_back( level_record );
+
+    for( int p = 0; p < level->numPatches(); p++, index++ ) {
+      const Patch* patch = level->getPatch(p);
+
+      PatchRecord patch_record;
+      patch_record.level     = l;
+      patch_record.extraLow  = patch->getExtraCellLowIndex();
+      patch_record.extraHigh = patch->getExtraCellHighIndex();
+      patch_record.low       = patch->getCellLowIndex();
+      patch_record.high      = patch->getCellHighIndex();
+      patch_record.cost      = total_costs[index];
+      patch_record.particles = ( l < (int)num_particles.size() && p < (int)num_particles[l].size() ) ? num_particles[l][p] : 0;
+      patch_record.processor = lb->getPatchwiseProcessorAssignment( patch );
+      step.patches.push_back( patch_record );
+    }
+  }
+
+  write( d_out, step );
+  d_out.flush();
+}
+
+//______________________________________________________________________
+//
+void
+CostTrace::write( ostream & out, const Step & step )
+{
+  out << setprecision(12);
+  out << "timestep " << step.timestep << " levels " << step.levels.size() << " patches " << step.patches.size() << "\n";
+
+  for( unsigned l = 0; l < step.levels.size(); l++ ) {
+    const LevelRecord& level = step.levels[l];
+    out << "level " << l
+        << " " << level.anchor.x()     << " " << level.anchor.y()     << " " << level.anchor.z()
+        << " " << level.dcell.x()      << " " << level.dcell.y()      << " " << level.dcell.z()
+        << " " << level.extraCells.x() << " " << level.extraCells.y() << " " << level.extraCells.z()
+        << " " << level.periodic.x()   << " " << level.periodic.y()   << " " << level.periodic.z() << "\n";
+  }
+
+  for( unsigned p = 0; p < step.patches.size(); p++ ) {
+    const PatchRecord& patch = step.patches[p];
+    out << "patch " << patch.level
+        << " " << patch.extraLow.x()  << " " << patch.extraLow.y()  << " " << patch.extraLow.z()
+        << " " << patch.extraHigh.x() << " " << patch.extraHigh.y() << " " << patch.extraHigh.z()
+        << " " << patch.low.x()  << " " << patch.low.y()  << " " << patch.low.z()
+        << " " << patch.high.x() << " " << patch.high.y() << " " << patch.high.z()
+        << " " << patch.cost << " " << patch.particles << " " << patch.processor << "\n";
+  }
+  out << "end\n";
+}
+
+//______________________________________________________________________
+//
+bool
+CostTrace::read( istream & in, Step & step )
+{
+  string token;
+  if( !(in >> token) ) {
+    return false;
+  }
+  if( token != "timestep" ) {
+    throw InternalError( "CostTrace: expected 'timestep', found '" + token + "'", __FILE__, __LINE__ );
+  }
+
+  int num_levels, num_patches;
+  in >> step.timestep;
+  expect( in, "levels" );
+  in >> num_levels;
+  expect( in, "patches" );
+  in >> num_patches;
+
+  step.levels.resize( num_levels );
+  for( int l = 0; l < num_levels; l++ ) {
+    LevelRecord& level = step.levels[l];
+    int index;
+    double x, y, z;
+    expect( in, "level" );
+    in >> index;
+    readTriple( in, x, y, z );
+    level.anchor = Point(x, y, z);
+    readTriple( in, x, y, z );
+    level.dcell = Vector(x, y, z);
+    readTriple( in, level.extraCells );
+    readTriple( in, level.periodic );
+  }
+
+  step.patches.resize( num_patches );
+  for( int p = 0; p < num_patches; p++ ) {
+    PatchRecord& patch = step.patches[p];
+    expect( in, "patch" );
+    in >> patch.level;
+    readTriple( in, patch.extraLow );
+    readTriple( in, patch.extraHigh );
+    readTriple( in, patch.low );
+    readTriple( in, patch.high );
+    in >> patch.cost >> patch.particles >> patch.processor;
+  }
+  expect( in, "end" );
+
+  if( !in ) {
+    ostringstream msg;
+    msg << "CostTrace: error reading timestep " << step.timestep;
+    throw InternalError( msg.str(), __FILE__, __LINE__ );
+  }
+  return true;
+}
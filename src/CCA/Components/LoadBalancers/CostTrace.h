@@ -0,0 +1,149 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef UINTAH_HOMEBREW_CostTrace_H
+#define UINTAH_HOMEBREW_CostTrace_H
+
+#include <Core/Geometry/IntVector.h>
+#include <Core/Geometry/Point.h>
+#include <Core/Geometry/Vector.h>
+#include <Core/Grid/Grid.h>
+#include <Core/Grid/Variables/ComputeSet.h>
+#include <Core/Parallel/ProcessorGroup.h>
+
+#include <fstream>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Uintah {
+
+  class LoadBalancer;
+
+   /**************************************
+     
+     CLASS
+       CostTrace 
+      
+       Records the measured cost of every patch, every timestep, to a file
+       that can be replayed offline through the load balancers.
+      
+     GENERAL INFORMATION
+      
+       CostTrace.h
+      
+       Department of Computer Science
+       University of Utah
+      
+       Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+      
+             
+     KEYWORDS
+       CostTrace
+       DynamicLoadBalancer
+      
+     DESCRIPTION
+       The scheduler's task times come in through addContribution (the
+       same times the CostProfiler and CostModelForecaster learn from).
+       Each task's time is split over its patches by their number of
+       cells.  At the end of the timestep record() sums the costs over all
+       processors and processor 0 appends one step to the trace:
+
+         timestep <timestep> levels <nlevels> patches <npatches>
+         level <l> <anchor> <dcell> <extraCells> <periodic>
+         ...
+         patch <l> <extraLow> <extraHigh> <low> <high> <cost> <particles> <processor>
+         ...
+         end
+
+       with one patch line per patch, in the order of the grid.  The
+       processor is the assignment the costs were measured with.
+
+       StandAlone/lbreplay reads these traces back with read().
+      
+     WARNING
+      
+     ****************************************/
+
+  class CostTrace {
+  public:
+
+    struct LevelRecord {
+      Point     anchor;
+      Vector    dcell;
+      IntVector extraCells;
+      IntVector periodic;
+    };
+
+    struct PatchRecord {
+      int       level;
+      IntVector extraLow;
+      IntVector extraHigh;
+      IntVector low;
+      IntVector high;
+      double    cost;
+      int       particles;
+      int       processor;
+    };
+
+    struct Step {
+      int                      timestep;
+      std::vector<LevelRecord> levels;
+      std::vector<PatchRecord> patches;
+    };
+
+    CostTrace( const ProcessorGroup * myworld, const std::string & filename );
+    ~CostTrace();
+
+    // add the cost of a task on the given patches
+    void addContribution( const PatchSubset * patches, double cost );
+
+    // append this timestep's costs to the trace (all processors must call)
+    void record( const Grid                            * grid,
+                       int                               timestep,
+                       LoadBalancer                    * lb,
+                 const std::vector< std::vector<int> > & num_particles );
+
+    static void write( std::ostream & out, const Step & step );
+
+    // reads the next step, returns false at the end of the trace
+    static bool read( std::istream & in, Step & step );
+
+  private:
+
+    CostTrace( const CostTrace & );
+    CostTrace& operator=( const CostTrace & );
+
+    const ProcessorGroup * d_myworld;
+    std::string            d_filename;
+    std::ofstream          d_out;
+
+    std::map<int, double>  d_costs;   // patch ID -> cost of this timestep
+  };
+} // End namespace Uintah
+
+
+#endif
@@ -45,6 +45,9 @@
 #include <Core/Util/FancyAssert.h>
 #include <Core/Util/DebugStream.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <iostream> // debug only
 #include <stack>
 #include <vector>
@@ -62,7 +65,7 @@ static DebugStream lbout( "LBOut", false );
 double lbtimes[5] = {0,0,0,0,0};
 
 DynamicLoadBalancer::DynamicLoadBalancer( const ProcessorGroup * myworld ) :
-  LoadBalancerCommon(myworld), d_costForecaster(0)
+  LoadBalancerCommon(myworld), d_costForecaster(0), d_costTrace(0)
 {
   d_lbInterval = 0.0;
   d_lastLbTime = 0.0;
@@ -73,6 +76,10 @@ DynamicLoadBalancer::DynamicLoadBalancer( const ProcessorGroup * myworld ) :
   d_dynamicAlgorithm = patch_factor_lb;  
   d_collectParticles = false;
 
+  d_migrationWeight    = 0.5;
+  d_partitionTolerance = 0.05;
+  d_nodeAware          = false;
+
   d_do_AMR = false;
   d_pspec = 0;
 
@@ -87,6 +94,10 @@ DynamicLoadBalancer::~DynamicLoadBalancer()
     delete d_costForecaster;
     d_costForecaster = 0;
   }
+  if( d_costTrace ) {
+    delete d_costTrace;
+    d_costTrace = 0;
+  }
 }
 //______________________________________________________________________
 //
@@ -255,7 +266,7 @@ DynamicLoadBalancer::collectParticles( const Grid                  * grid,
   }
 
   //if we are not supposed to collect particles just return
-  if( !d_collectParticles || !d_scheduler->get_dw(0) ) {
+  if( !d_collectParticles || !d_scheduler || !d_scheduler->get_dw(0) ) {
     return;
   }
 
@@ -721,6 +732,363 @@ DynamicLoadBalancer::assignPatchesFactor( const GridP & grid, bool force )
   
   return doLoadBalancing;
 }
+//______________________________________________________________________
+//
+void
+DynamicLoadBalancer::placeBoundaries( const vector<double> & targets,
+                                      const vector<int>    & right,
+                                      const vector<double> & cost,
+                                      const vector<double> & cells,
+                                      const vector<int>    & owner,
+                                            int              cb,
+                                            double           offset,
+                                            double           next,
+                                            double           avgCost,
+                                            double           avgCells,
+                                            bool             useMigration,
+                                            vector<int>    & splits,
+                                            vector<double> & prefixes )
+{
+  int n          = (int)cost.size();
+  int numTargets = (int)targets.size();
+
+  // the first boundary past the start of the segment
+  int t = upper_bound(targets.begin(), targets.end(), offset) - targets.begin();
+
+  double prefixStart = offset;
+  for (int i = 0; i < n && t < numTargets; i++) {
+    // the last patch ends where the next segment starts
+    double prefixEnd = (i < n - 1) ? prefixStart + cost[i] : next;
+
+    while (t < numTargets && targets[t] <= prefixEnd) {
+      double target = targets[t];
+      double window = d_partitionTolerance * avgCost;
+      int    r      = right[t];
+
+      // candidate splits: the two on either side of the target and any
+      // other within the tolerance.  prefix[s] is the cost before patch s.
+      int sLo = i;
+      int sHi = i + 1;
+      double prefixLo = prefixStart;
+      double prefixHi = prefixEnd;
+      while (sLo > 0 && fabs(prefixLo - cost[sLo - 1] - target) <= window) {
+        sLo--;
+        prefixLo -= cost[sLo];
+      }
+      while (sHi < n && fabs(prefixHi + cost[sHi] - target) <= window) {
+        prefixHi += cost[sHi];
+        sHi++;
+      }
+
+      // cells in [sLo, sHi) that would move if all of them went to r
+      double moved = 0;
+      if (useMigration) {
+        for (int q = sLo; q < sHi; q++) {
+          moved += (owner[q] != r) ? cells[q] : 0;
+        }
+      }
+
+      // walk the candidates, moving patch s from r to r-1 each step
+      int    bestSplit  = sLo;
+      double bestPrefix = prefixLo;
+      double bestScore  = DBL_MAX;
+      double bestDev    = DBL_MAX;
+      double prefix     = prefixLo;
+
+      for (int s = sLo; s <= sHi; s++) {
+        double dev   = fabs(prefix - target) / avgCost;
+        double score = dev;
+        if (useMigration) {
+          score += d_migrationWeight * moved / avgCells;
+        }
+        if (score < bestScore || (score == bestScore && dev < bestDev)) {
+          bestScore  = score;
+          bestDev    = dev;
+          bestSplit  = s;
+          bestPrefix = prefix;
+        }
+        if (s < sHi) {
+          if (useMigration) {
+            moved += (owner[s] != r - 1) ? cells[s] : 0;
+            moved -= (owner[s] != r)     ? cells[s] : 0;
+          }
+          prefix += cost[s];
+        }
+      }
+      splits[t]   = cb + bestSplit;
+      prefixes[t] = bestPrefix;
+      t++;
+    }
+    prefixStart = prefixEnd;
+  }
+
+  // every rank placed a disjoint set of the boundaries
+  if (d_myworld->size() > 1 && numTargets > 0) {
+    vector<int>    mySplits(splits);
+    vector<double> myPrefixes(prefixes);
+    Uintah::MPI::Allreduce(&mySplits[0],   &splits[0],   numTargets, MPI_INT,    MPI_MAX, d_myworld->getComm());
+    Uintah::MPI::Allreduce(&myPrefixes[0], &prefixes[0], numTargets, MPI_DOUBLE, MPI_MAX, d_myworld->getComm());
+  }
+}
+
+//______________________________________________________________________
+//
+bool
+DynamicLoadBalancer::assignPatchesSFCPartition( const GridP & grid, bool force )
+{
+  doing << d_myworld->myrank() << "   SFCPartition\n";
+  double time = Time::currentSeconds();
+
+  int num_procs = d_myworld->size();
+  int myrank    = d_myworld->myrank();
+
+  vector<vector<double> > patch_costs;
+  getCosts(grid.get_rep(), patch_costs);
+
+  // the current assignment only describes where the data lives if the
+  // patches have not changed (i.e. this is not a regrid or the first lb)
+  bool useMigration = !force && d_migrationWeight > 0 &&
+                      d_processorAssignment.size() == d_tempAssignment.size();
+
+  // Processor slots along the curve: the ranks, ordered by node when node
+  // aware.  The slots of node k are [nodeFirstSlot[k], nodeFirstSlot[k+1]).
+  vector<int> slotRank(num_procs);
+  vector<int> rankSlot(num_procs);
+  for (int r = 0; r < num_procs; r++) {
+    slotRank[r] = r;
+  }
+  int num_nodes = 1;
+  if (d_nodeAware) {
+    const ProcessorGroup* pg = d_myworld;
+    stable_sort(slotRank.begin(), slotRank.end(),
+                [pg](int a, int b) { return pg->getNode(a) < pg->getNode(b); });
+    num_nodes = pg->numNodes();
+  }
+  vector<int> slotNode(num_procs, 0);
+  vector<int> nodeFirstSlot(num_nodes + 1, num_procs);
+  for (int s = num_procs - 1; s >= 0; s--) {
+    rankSlot[slotRank[s]] = s;
+    slotNode[s] = d_nodeAware ? d_myworld->getNode(slotRank[s]) : 0;
+    nodeFirstSlot[slotNode[s]] = s;
+  }
+
+  int level_offset = 0;
+
+  for (int l = 0; l < grid->numLevels(); l++) {
+    const LevelP& level = grid->getLevel(l);
+    int num_patches = level->numPatches();
+
+    //__________________________________
+    //  This rank's segment [cb, cb + n) of the curve.  Only the patches of
+    //  the segment are visited; the ranks exchange the prefix sum of the
+    //  segment costs and the partition boundaries.
+    vector<int> segment;
+    int cb;
+    useSFCSegment(level, segment, cb);
+    int n = (int)segment.size();
+
+    // cost, cells and current processor slot (and node) of the segment's patches
+    vector<double> cost(n);
+    vector<double> cells(n);
+    vector<int>    owner(n, -1);
+    vector<int>    ownerNode(n, -1);
+    double local[2] = {0, 0};   // cost, cells
+
+    for (int i = 0; i < n; i++) {
+      int index = segment[i];
+      cost[i]   = max(patch_costs[l][index], 0.0);
+      cells[i]  = level->getPatch(index)->getNumCells();
+      local[0] += cost[i];
+      local[1] += cells[i];
+      if (useMigration) {
+        owner[i]     = rankSlot[d_processorAssignment[level_offset + index]];
+        ownerNode[i] = slotNode[owner[i]];
+      }
+    }
+
+    // cost on the curve before this segment and before the next one, and
+    // the totals.  The end of a segment is the next rank's offset, not
+    // offset + local cost, so every boundary falls in exactly one segment
+    // whatever the rounding of the scan.
+    double offset    = 0;
+    double next      = DBL_MAX;
+    double totals[2] = {local[0], local[1]};
+    if (num_procs > 1) {
+      Uintah::MPI::Exscan(&local[0], &offset, 1, MPI_DOUBLE, MPI_SUM, d_myworld->getComm());
+      if (myrank == 0) {
+        offset = 0;
+      }
+      int left  = myrank > 0             ? myrank - 1 : MPI_PROC_NULL;
+      int right = myrank < num_procs - 1 ? myrank + 1 : MPI_PROC_NULL;
+      Uintah::MPI::Sendrecv(&offset, 1, MPI_DOUBLE, left, 0, &next, 1, MPI_DOUBLE, right, 0, d_myworld->getComm(), MPI_STATUS_IGNORE);
+      Uintah::MPI::Allreduce(local, totals, 2, MPI_DOUBLE, MPI_SUM, d_myworld->getComm());
+    }
+    double total_cost  = totals[0];
+    double total_cells = totals[1];
+
+    double avgCost  = total_cost / num_procs;
+    double avgCells = total_cells / num_procs;
+
+    // splits[r] is the first patch (in curve order) of processor slot r
+    vector<int> splits(num_procs + 1, -1);
+
+    if (avgCost > 0) {
+      //__________________________________
+      //  Node aware: cut the curve between the nodes first, each node
+      //  getting a share of the cost in proportion to its ranks, with the
+      //  cells moving between nodes weighed against the imbalance.
+      vector<int>    nodeSplits(num_nodes + 1, -1);
+      vector<double> nodeStart(num_nodes + 1, -1);
+      nodeSplits[0]         = 0;
+      nodeStart[0]          = 0;
+      nodeSplits[num_nodes] = num_patches;
+      nodeStart[num_nodes]  = total_cost;
+
+      if (num_nodes > 1) {
+        vector<double> targets(num_nodes - 1);
+        vector<int>    right(num_nodes - 1);
+        for (int k = 1; k < num_nodes; k++) {
+          targets[k - 1] = nodeFirstSlot[k] * avgCost;
+          right[k - 1]   = k;
+        }
+        vector<int>    placed(num_nodes - 1, -1);
+        vector<double> prefixes(num_nodes - 1, -1);
+        placeBoundaries(targets, right, cost, cells, ownerNode, cb, offset, next,
+                        avgCost, avgCells, useMigration, placed, prefixes);
+
+        for (int k = 1; k < num_nodes; k++) {
+          nodeSplits[k] = placed[k - 1];
+          nodeStart[k]  = prefixes[k - 1];
+          if (nodeSplits[k] < 0) {
+            nodeSplits[k] = (int)(((long long)num_patches * nodeFirstSlot[k]) / num_procs);
+            nodeStart[k]  = targets[k - 1];
+          }
+          nodeSplits[k] = min(max(nodeSplits[k], nodeSplits[k - 1]), num_patches);
+          nodeStart[k]  = max(nodeStart[k], nodeStart[k - 1]);
+        }
+      }
+
+      //__________________________________
+      //  Then cut each node's part of the curve evenly between its ranks
+      //  (the whole curve between all ranks when not node aware).
+      vector<double> targets;
+      vector<int>    right;
+      for (int k = 0; k < num_nodes; k++) {
+        int    first    = nodeFirstSlot[k];
+        int    nranks   = nodeFirstSlot[k + 1] - first;
+        double nodeCost = nodeStart[k + 1] - nodeStart[k];
+        for (int m = 1; m < nranks; m++) {
+          targets.push_back(nodeStart[k] + m * nodeCost / nranks);
+          right.push_back(first + m);
+        }
+      }
+      vector<int>    placed(targets.size(), -1);
+      vector<double> prefixes(targets.size(), -1);
+      placeBoundaries(targets, right, cost, cells, owner, cb, offset, next,
+                      avgCost, avgCells, useMigration, placed, prefixes);
+
+      for (int k = 0; k <= num_nodes; k++) {
+        splits[nodeFirstSlot[k]] = nodeSplits[k];
+      }
+      for (unsigned t = 0; t < targets.size(); t++) {
+        // within its node's part of the curve
+        int r = right[t];
+        int k = slotNode[r];
+        if (placed[t] >= 0) {
+          placed[t] = min(max(placed[t], nodeSplits[k]), nodeSplits[k + 1]);
+        }
+        splits[r] = placed[t];
+      }
+    }
+
+    //__________________________________
+    //  Boundaries that were not placed (no costs) split the curve evenly,
+    //  and neighboring windows may overlap when patches are expensive
+    //  relative to the average, so force the splits to be monotonic.
+    splits[0]         = 0;
+    splits[num_procs] = num_patches;
+    for (int r = 1; r < num_procs; r++) {
+      if (splits[r] < 0) {
+        splits[r] = (int)(((long long)num_patches * r) / num_procs);
+      }
+      splits[r] = min(max(splits[r], splits[r - 1]), num_patches);
+    }
+
+    //__________________________________
+    //  The owners of the segment's patches.  The assignment itself is
+    //  replicated (every rank answers getPatchwiseProcessorAssignment for
+    //  every patch), so the (patch, rank) pairs are gathered.
+    vector<int> mine(2 * n);
+    vector<double> slotCost(num_procs, 0);
+    double movedCells = 0;
+    int    slot       = upper_bound(splits.begin(), splits.end(), cb) - splits.begin() - 1;
+
+    for (int i = 0; i < n; i++) {
+      while (cb + i >= splits[slot + 1]) {
+        slot++;
+      }
+      mine[2 * i]     = segment[i];
+      mine[2 * i + 1] = slotRank[slot];
+      slotCost[slot] += cost[i];
+      if (useMigration && owner[i] != slot) {
+        movedCells += cells[i];
+      }
+    }
+
+    vector<int> all(2 * num_patches);
+    if (num_procs > 1) {
+      vector<int> counts(num_procs);
+      vector<int> displs(num_procs);
+      int mycount = 2 * n;
+      Uintah::MPI::Allgather(&mycount, 1, MPI_INT, &counts[0], 1, MPI_INT, d_myworld->getComm());
+      displs[0] = 0;
+      for (int r = 1; r < num_procs; r++) {
+        displs[r] = displs[r - 1] + counts[r - 1];
+      }
+      Uintah::MPI::Allgatherv(&mine[0], mycount, MPI_INT, &all[0], &counts[0], &displs[0], MPI_INT, d_myworld->getComm());
+    }
+    else {
+      all.swap(mine);
+    }
+    for (int i = 0; i < num_patches; i++) {
+      d_tempAssignment[level_offset + all[2 * i]] = all[2 * i + 1];
+    }
+
+    //__________________________________
+    //    debugging output
+    if (stats.active()) {
+      vector<double> procCosts(num_procs, 0);
+      double moved = movedCells;
+      if (num_procs > 1) {
+        Uintah::MPI::Reduce(&slotCost[0], &procCosts[0], num_procs, MPI_DOUBLE, MPI_SUM, 0, d_myworld->getComm());
+        Uintah::MPI::Reduce(&movedCells, &moved, 1, MPI_DOUBLE, MPI_SUM, 0, d_myworld->getComm());
+      }
+      else {
+        procCosts = slotCost;
+      }
+      if (myrank == 0) {
+        double maxCost = *max_element(procCosts.begin(), procCosts.end());
+
+        stats << "SFCPartition Stats level(" << l << "): Mean: " << avgCost << " Max: " << maxCost
+              << " Imbalance: " << (maxCost > 0 ? 1 - avgCost / maxCost : 0)
+              << " Moved cells: " << moved << " of " << total_cells << endl;
+      }
+    }
+
+    level_offset += num_patches;
+  }
+
+  bool doLoadBalancing = force || thresholdExceeded(patch_costs);
+  time = Time::currentSeconds() - time;
+
+  if (d_myworld->myrank() == 0) {
+    dbg << " Time to LB: " << time << endl;
+  }
+  doing << d_myworld->myrank() << "   SFCPartition END\n";
+
+  return doLoadBalancing;
+}
+
 //______________________________________________________________________
 //
 bool
@@ -935,7 +1303,7 @@ DynamicLoadBalancer::getCosts( const Grid * grid, vector< vector<double> > & cos
     
   vector<vector<int> > num_particles;
 
-  DataWarehouse* olddw = d_scheduler->get_dw(0);
+  DataWarehouse* olddw = d_scheduler ? d_scheduler->get_dw(0) : 0;
   bool on_regrid = olddw != 0 && grid != olddw->getGrid();
 
   if( on_regrid ) {
@@ -1027,6 +1395,9 @@ DynamicLoadBalancer::possiblyDynamicallyReallocate( const GridP & grid, int stat
         case random_lb :
           dynamicAllocate = assignPatchesRandom(grid, force);
           break;
+        case sfc_partition_lb :
+          dynamicAllocate = assignPatchesSFCPartition(grid, force);
+          break;
       }
     }
     else  //regridder has called dynamic load balancer so we must dynamically Allocate
@@ -1090,9 +1461,36 @@ DynamicLoadBalancer::possiblyDynamicallyReallocate( const GridP & grid, int stat
 //______________________________________________________________________
 //
 void
+DynamicLoadBalancer::addContribution( DetailedTask * task, double cost )
+{
+  d_costForecaster->addContribution(task, cost);
+
+  if( d_costTrace ) {
+    d_costTrace->addContribution(task->getPatches(), cost);
+  }
+}
+//______________________________________________________________________
+//
+void
 DynamicLoadBalancer::finalizeContributions( const GridP & grid )
 {
   d_costForecaster->finalizeContributions(grid);
+
+  if( d_costTrace ) {
+    vector<vector<int> > num_particles;
+    collectParticles(grid.get_rep(), num_particles);
+    d_costTrace->record(grid.get_rep(), d_sharedState->getCurrentTopLevelTimeStep(), this, num_particles);
+  }
+}
+//______________________________________________________________________
+//
+void
+DynamicLoadBalancer::setCostForecaster( CostForecasterBase * forecaster )
+{
+  if( d_costForecaster ) {
+    delete d_costForecaster;
+  }
+  d_costForecaster = forecaster;
 }
 
 //______________________________________________________________________
@@ -1125,6 +1523,8 @@ DynamicLoadBalancer::problemSetup( ProblemSpecP & pspec, GridP & grid,  Simulati
     p->getWithDefault("gainThreshold",    threshold, 0.05);
     p->getWithDefault("doSpaceCurve",     spaceCurve, true);
     p->getWithDefault("hasParticles",     d_collectParticles, false);
+    p->getWithDefault("migrationWeight",  d_migrationWeight, 0.5);
+    p->getWithDefault("partitionTolerance", d_partitionTolerance, 0.05);
     
     string costAlgo="ModelLS";
     p->get("costAlgorithm",costAlgo);
@@ -1153,6 +1553,12 @@ DynamicLoadBalancer::problemSetup( ProblemSpecP & pspec, GridP & grid,  Simulati
     }
    
     p->getWithDefault("levelIndependent",d_levelIndependent,true);
+
+    string costTrace;
+    if( p->get("costTrace", costTrace) ) {
+      d_costTrace = scinew CostTrace(d_myworld, costTrace);
+      proc0cout << "Recording the patch costs to " << costTrace << "\n";
+    }
   }
 
 
@@ -1169,6 +1575,20 @@ DynamicLoadBalancer::problemSetup( ProblemSpecP & pspec, GridP & grid,  Simulati
   else if (dynamicAlgo == "patchFactor") {
     d_dynamicAlgorithm = patch_factor_lb;
   }
+  else if (dynamicAlgo == "sfcPartition" || dynamicAlgo == "hierarchicalSFC") {
+    d_dynamicAlgorithm = sfc_partition_lb;
+    d_nodeAware        = (dynamicAlgo == "hierarchicalSFC");
+
+    if (d_nodeAware && d_myworld->myrank() == 0) {
+      cout << "Load balancing across " << d_myworld->numNodes() << " nodes, then across the ranks of each node\n";
+    }
+    // the partition is defined along the curve
+    spaceCurve = true;
+
+    if (d_partitionTolerance < 0 || d_partitionTolerance >= 0.5) {
+      throw ProblemSetupException("LoadBalancer partitionTolerance must be in [0, 0.5)", __FILE__, __LINE__);
+    }
+  }
   else if (dynamicAlgo == "patchFactorParticles" || dynamicAlgo == "particle3") {
     // these are for backward-compatibility
     d_dynamicAlgorithm = patch_factor_lb;
@@ -1177,7 +1597,7 @@ DynamicLoadBalancer::problemSetup( ProblemSpecP & pspec, GridP & grid,  Simulati
   else {
     if (d_myworld->myrank() == 0) {
       cout << "Invalid Load Balancer Algorithm: " << dynamicAlgo
-        << "\nPlease select 'cyclic', 'random', 'patchFactor' (default), or 'patchFactorParticles'\n"
+        << "\nPlease select 'cyclic', 'random', 'patchFactor' (default), 'patchFactorParticles', 'sfcPartition' or 'hierarchicalSFC'\n"
         << "\nUsing 'patchFactor' load balancer\n";
     }
     d_dynamicAlgorithm = patch_factor_lb;
@@ -27,6 +27,7 @@
 
 #include <CCA/Components/LoadBalancers/CostForecasterBase.h>
 #include <CCA/Components/LoadBalancers/CostProfiler.h>
+#include <CCA/Components/LoadBalancers/CostTrace.h>
 #include <CCA/Components/LoadBalancers/LoadBalancerCommon.h>
 
 #include <Core/Grid/Grid.h>
@@ -94,7 +95,7 @@ namespace Uintah {
 
     // Cost profiling functions
     // Update the contribution for this patch.
-    virtual void addContribution( DetailedTask * task ,double cost ) { d_costForecaster->addContribution(task,cost); }
+    virtual void addContribution( DetailedTask * task ,double cost );
 
     // Finalize the contributions (updates the weight, should be called once per timestep):
     virtual void finalizeContributions( const GridP & currentGrid );
@@ -104,6 +105,10 @@ namespace Uintah {
 
     // Resets the profiler counters to zero
     virtual void resetCostForecaster() { d_costForecaster->reset(); }
+
+    // Replaces the cost forecaster set up from the input file (takes ownership).
+    // Used to replay recorded costs through the load balancer.
+    void setCostForecaster( CostForecasterBase * forecaster );
     
     // Helper for assignPatchesFactor.  Collects each patch's particles
     void collectParticles(const Grid* grid, std::vector<std::vector<int> >& num_particles);
@@ -124,7 +129,8 @@ namespace Uintah {
 
     std::vector<IntVector> d_minPatchSize;
     CostForecasterBase *d_costForecaster;
-    enum { static_lb, cyclic_lb, random_lb, patch_factor_lb };
+    CostTrace          *d_costTrace;       //records the measured patch costs (<costTrace>), if not null
+    enum { static_lb, cyclic_lb, random_lb, patch_factor_lb, sfc_partition_lb };
 
     DynamicLoadBalancer(const DynamicLoadBalancer&);
     DynamicLoadBalancer& operator=(const DynamicLoadBalancer&);
@@ -136,6 +142,30 @@ namespace Uintah {
     bool assignPatchesRandom(const GridP& grid, bool force);
     bool assignPatchesCyclic(const GridP& grid, bool force);
 
+    /// Partitions the SFC ordered patches of each level by a distributed
+    /// prefix sum of their costs.  Each rank works on its own segment of the
+    /// curve; only the segment cost prefix sums, the partition boundaries and
+    /// the resulting owners are exchanged.  Each partition boundary is placed,
+    /// within d_partitionTolerance of its ideal cost (and within the segment
+    /// holding it), where the fewest cells change processor (weighted by
+    /// d_migrationWeight).  With d_nodeAware the curve is cut between the
+    /// nodes first (cells moving between nodes weighed against the node
+    /// imbalance), then each node's part between the ranks of the node.
+    bool assignPatchesSFCPartition(const GridP& grid, bool force);
+
+    /// Places the boundaries at the (ascending) prefix costs targets that fall
+    /// in this rank's curve segment, which starts at curve position cb, after
+    /// the cost offset, and ends where the cost next of the next segment
+    /// starts.  Boundary t separates group right[t]-1 from group right[t];
+    /// owner holds the current group of each segment patch.  On return every
+    /// rank has splits[t] (curve position) and prefixes[t] (cost before it)
+    /// of all the boundaries that were placed, and -1 for the others.
+    void placeBoundaries(const std::vector<double>& targets, const std::vector<int>& right,
+                         const std::vector<double>& cost, const std::vector<double>& cells,
+                         const std::vector<int>& owner, int cb, double offset, double next,
+                         double avgCost, double avgCells, bool useMigration,
+                         std::vector<int>& splits, std::vector<double>& prefixes);
+
     bool thresholdExceeded(const std::vector<std::vector<double> >& patch_costs);
 
     //Assign costs to a list of patches
@@ -159,6 +189,10 @@ namespace Uintah {
     int  d_dynamicAlgorithm;
     bool d_collectParticles;
 
+    double d_migrationWeight;     //cost of moving a processor's worth of cells, relative to a fully imbalanced boundary
+    double d_partitionTolerance;  //allowed deviation of a partition boundary from its ideal cost, as a fraction of the average
+    bool   d_nodeAware;           //partition across the nodes first, then across the ranks of each node
+
   };
 } // End namespace Uintah
 
@@ -59,7 +59,7 @@ DebugStream neiDebug("Neighborhood", false );
 #define SFC_PARALLEL
 
 LoadBalancerCommon::LoadBalancerCommon( const ProcessorGroup * myworld ) :
-  UintahParallelComponent( myworld ), d_sfc( myworld )
+  UintahParallelComponent( myworld ), d_sfc( myworld ), d_neighborhoodPatchQueries( false )
 {
 }
 
@@ -361,6 +361,97 @@ LoadBalancerCommon::useSFC( const LevelP & level, int * order )
   }
 #endif
 }
+//______________________________________________________________________
+//
+void
+LoadBalancerCommon::useSFCSegment( const LevelP      & level,
+                                         vector<int> & segment,
+                                         int         & segmentBegin )
+{
+  int num_procs   = d_myworld->size();
+  int myrank      = d_myworld->myrank();
+  int num_patches = level->numPatches();
+
+  // the patches are handed to the curve in rank slices (as useSFC does), and
+  // the parallel curve leaves each rank with as many patches as it was given
+  vector<int> sliceStart(num_procs + 1);
+  for (int r = 0; r <= num_procs; r++) {
+    sliceStart[r] = (int)(((long long)num_patches * r + num_procs - 1) / num_procs);
+  }
+  int begin = sliceStart[myrank];
+  int end   = sliceStart[myrank + 1];
+
+  int dim         = d_sharedState->getNumDims();
+  int *dimensions = d_sharedState->getActiveDims();
+
+  // bounds of the level and the minimum patch size, from the slices
+  // (MIN of low, -high and size)
+  int local[9];
+  for (int d = 0; d < 9; d++) {
+    local[d] = INT_MAX;
+  }
+  vector<double> positions;
+  positions.reserve((end - begin) * dim);
+
+  for (int p = begin; p < end; p++) {
+    const Patch* patch = level->getPatch(p);
+    IntVector lo   = patch->getCellLowIndex();
+    IntVector hi   = patch->getCellHighIndex();
+    IntVector size = hi - lo;
+    for (int d = 0; d < 3; d++) {
+      local[d]     = min(local[d],     lo[d]);
+      local[3 + d] = min(local[3 + d], -hi[d]);
+      local[6 + d] = min(local[6 + d], size[d]);
+    }
+
+    Vector point = (lo + hi).asVector() / 2.0;
+    for (int d = 0; d < dim; d++) {
+      positions.push_back(point[dimensions[d]]);
+    }
+  }
+
+  int global[9];
+  if (num_procs > 1) {
+    Uintah::MPI::Allreduce(local, global, 9, MPI_INT, MPI_MIN, d_myworld->getComm());
+  }
+  else {
+    for (int d = 0; d < 9; d++) {
+      global[d] = local[d];
+    }
+  }
+
+  IntVector low(global[0], global[1], global[2]);
+  IntVector high(-global[3], -global[4], -global[5]);
+  IntVector min_patch_size(global[6], global[7], global[8]);
+
+  IntVector range  = high - low;
+  Vector    center = (high + low).asVector() / 2.0;
+
+  double r[3]     = {(double)range[dimensions[0]], (double)range[dimensions[1]], (double)range[dimensions[2]]};
+  double c[3]     = {(double)center[dimensions[0]],(double)center[dimensions[1]], (double)center[dimensions[2]]};
+  double delta[3] = {(double)min_patch_size[dimensions[0]], (double)min_patch_size[dimensions[1]], (double)min_patch_size[dimensions[2]]};
+
+  vector<DistributedIndex> indices;
+
+  d_sfc.SetDimensions(r);
+  d_sfc.SetCenter(c);
+  d_sfc.SetRefinementsByDelta(delta);
+  d_sfc.SetLocations(&positions);
+  d_sfc.SetOutputVector(&indices);
+  d_sfc.SetLocalSize(end - begin);
+  d_sfc.GenerateCurve();
+
+  if ((int)indices.size() != end - begin) {
+    throw InternalError("useSFCSegment: the curve segment does not match the slice size", __FILE__, __LINE__);
+  }
+
+  segmentBegin = begin;
+  segment.resize(indices.size());
+  for (unsigned int i = 0; i < indices.size(); i++) {
+    segment[i] = sliceStart[indices[i].p] + indices[i].i;
+  }
+}
+
 //______________________________________________________________________
 //
 void
@@ -742,8 +833,48 @@ LoadBalancerCommon::createNeighborhood(const GridP& grid, const GridP& oldGrid)
       cout << d_myworld->myrank() << "  Neighborhood: " << (*iter)->getID() << " Proc " << getPatchwiseProcessorAssignment(*iter) << endl;
     }
   }
+
+  if( d_neighborhoodPatchQueries ) {
+    setLevelNeighborhoods( grid, maxGhost );
+  }
 } // end createNeighborhood()
 
+//______________________________________________________________________
+//  Restrict the patch queries of each level to the patches this process
+//  works with: its patches (new and old) and its neighborhood, with a
+//  halo of ghost cells.
+void
+LoadBalancerCommon::setLevelNeighborhoods( const GridP & grid, int maxGhost )
+{
+  int me = d_myworld->myrank();
+  int numLevels = grid->numLevels();
+  vector<vector<const Patch*> > patches( numLevels );
+
+  for( int l = 0; l < numLevels; l++ ) {
+    LevelP level = grid->getLevel(l);
+    for( Level::const_patchIterator iter = level->patchesBegin(); iter != level->patchesEnd(); iter++ ) {
+      const Patch* patch = *iter;
+      if( getPatchwiseProcessorAssignment( patch ) == me || getOldProcessorAssignment( patch ) == me ) {
+        patches[l].push_back( patch );
+      }
+    }
+  }
+
+  for( std::set<const Patch*>::iterator iter = d_neighbors.begin(); iter != d_neighbors.end(); iter++ ) {
+    const Patch* patch = *iter;
+    int l = patch->getLevel()->getIndex();
+    if( l < numLevels && patch->getLevel() == grid->getLevel(l).get_rep() ) {
+      patches[l].push_back( patch );
+    }
+  }
+
+  for( int l = 0; l < numLevels; l++ ) {
+    if( !patches[l].empty() ) {
+      grid->getLevel(l)->setNeighborhood( patches[l], IntVector( maxGhost, maxGhost, maxGhost ) );
+    }
+  }
+}
+
 //______________________________________________________________________
 //
 bool
@@ -778,9 +909,11 @@ LoadBalancerCommon::problemSetup(ProblemSpecP& pspec, GridP& grid, SimulationSta
   d_scheduler = dynamic_cast<Scheduler*>(getPort("scheduler"));
   ProblemSpecP p = pspec->findBlock("LoadBalancer");
   d_outputNthProc = 1;
+  d_neighborhoodPatchQueries = false;
   
   if (p != 0) {
     p->getWithDefault("outputNthProc", d_outputNthProc, 1);
+    p->getWithDefault("neighborhoodPatchQueries", d_neighborhoodPatchQueries, false);
   }
 }
 
@@ -175,6 +175,12 @@ protected:
 
   // Calls space-filling curve on level, and stores results in pre-allocated output
   void useSFC(const LevelP& level, int* output);
+
+  // This rank's piece of the space-filling curve of level: the level indices
+  // of the patches at curve positions [segmentBegin, segmentBegin + segment.size()).
+  // Only this rank's share of the patches is visited, and the curve is not
+  // gathered.  Collective.
+  void useSFCSegment(const LevelP& level, std::vector<int>& segment, int& segmentBegin);
     
   double d_lastLbTime;
 
@@ -216,6 +222,11 @@ protected:
   //! needs it to assign the processor resource.
   int d_outputNthProc;
 
+  //! Restrict each level's patch queries to this processor's neighborhood
+  //! (see Level::setNeighborhood).
+  bool d_neighborhoodPatchQueries;
+  void setLevelNeighborhoods( const GridP & grid, int maxGhost );
+
   std::vector< Handle<const PatchSet> > d_levelPerProcPatchSets;
   Handle< const PatchSet >              d_gridPerProcPatchSet;
   std::vector< Handle<const PatchSet> > d_outputPatchSets;
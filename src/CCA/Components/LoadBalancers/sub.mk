@@ -41,6 +41,7 @@ SRCS += \
 	$(SRCDIR)/CostProfiler.cc \
 	$(SRCDIR)/ProfileDriver.cc \
 	$(SRCDIR)/CostModelForecaster.cc \
+	$(SRCDIR)/CostTrace.cc \
 	$(SRCDIR)/ParticleLoadBalancer.cc
 
 
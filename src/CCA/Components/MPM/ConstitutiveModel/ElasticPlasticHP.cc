@@ -54,6 +54,7 @@
 #include <Core/Math/MinMax.h>
 #include <Core/Math/Gaussian.h>
 #include <Core/Math/Matrix3.h>
+#include <Core/Math/Matrix3Block.h>
 #include <Core/Math/SymmMatrix3.h>
 #include <Core/Math/FastMatrix.h>
 #include <Core/Math/TangentModulusTensor.h>
@@ -717,7 +718,6 @@ ElasticPlasticHP::computeStressTensor(const PatchSubset* patches,
   Matrix3 tensorD(0.0);                   // Rate of deformation
   Matrix3 tensorW(0.0);                   // Spin 
   Matrix3 tensorF; tensorF.Identity();    // Deformation gradient
-  Matrix3 tensorU; tensorU.Identity();    // Right Cauchy-Green stretch
   Matrix3 tensorR; tensorR.Identity();    // Rotation 
   Matrix3 sigma(0.0);                     // The Cauchy stress
   Matrix3 tensorEta(0.0);                 // Deviatoric part of tensor D
@@ -829,10 +829,39 @@ ElasticPlasticHP::computeStressTensor(const PatchSubset* patches,
     d_flow     ->allocateAndPutInternalVars(pset, new_dw);
     d_devStress->allocateAndPutInternalVars(pset, new_dw);
 
+    //______________________________________________________________________
+    // Polar rotations of the old and new deformation gradients, computed
+    // a block of particles at a time.  Particles with a bad new Jacobian
+    // are deleted in the loop below, and use F_new = I.
+    std::vector<Matrix3> rotation_old(pset->numParticles());
+    std::vector<Matrix3> rotation_new(pset->numParticles());
+    {
+      Matrix3Block F_old, F_new, R;
+      int first = 0;
+      ParticleSubset::iterator iter = pset->begin();
+      while(iter != pset->end()){
+        int n = 0;
+        for(; n < Matrix3Block::width && iter != pset->end(); n++, iter++){
+          double J = pDeformGrad_new[*iter].Determinant();
+          F_old.set(n, pDeformGrad[*iter]);
+          F_new.set(n, (!(J > 0.) || J > 1.e5) ? one : pDeformGrad_new[*iter]);
+        }
+        Matrix3Batch::polarRotationRMB(F_old, R, n);
+        for(int l = 0; l < n; l++){
+          rotation_old[first + l] = R.get(l);
+        }
+        Matrix3Batch::polarRotationRMB(F_new, R, n);
+        for(int l = 0; l < n; l++){
+          rotation_new[first + l] = R.get(l);
+        }
+        first += n;
+      }
+    }
+
     //______________________________________________________________________
     // Loop thru particles
     ParticleSubset::iterator iter = pset->begin(); 
-    for( ; iter != pset->end(); iter++){
+    for(int pnum = 0; iter != pset->end(); iter++, pnum++){
       particleIndex idx = *iter;
 
       // Assign zero int. heating by default, modify with appropriate sources
@@ -874,8 +903,8 @@ ElasticPlasticHP::computeStressTensor(const PatchSubset* patches,
       // Calculate rate of deformation tensor (D)
       tensorD = (tensorL + tensorL.Transpose())*0.5;
 
-      // Compute polar decomposition of F (F = RU)
-      pDeformGrad[idx].polarDecompositionRMB(tensorU, tensorR);
+      // Polar decomposition of F (F = RU)
+      tensorR = rotation_old[pnum];
 
       // Rotate the total rate of deformation tensor back to the 
       // material configuration
@@ -1280,8 +1309,8 @@ ElasticPlasticHP::computeStressTensor(const PatchSubset* patches,
       //-----------------------------------------------------------------------
 
       // Rotate the stress back to the laboratory coordinates using new R
-      // Compute polar decomposition of new F (F = RU)
-      tensorF_new.polarDecompositionRMB(tensorU, tensorR);
+      // Polar decomposition of new F (F = RU)
+      tensorR = rotation_new[pnum];
 
       sigma = (tensorR*sigma)*(tensorR.Transpose());
 
@@ -32,6 +32,7 @@
 #include <Core/Grid/Variables/VarTypes.h>
 #include <Core/Labels/MPMLabel.h>
 #include <Core/Math/Matrix3.h>
+#include <Core/Math/Matrix3Block.h>
 #include <CCA/Components/MPM/ConstitutiveModel/MPMMaterial.h>
 #include <CCA/Components/MPM/ConstitutiveModel/PlasticityModels/MPMEquationOfStateFactory.h>
 #include <Core/ProblemSpec/ProblemSpec.h>
@@ -1072,13 +1073,13 @@ void UCNH::computeStressTensor(const PatchSubset* patches,
     const Patch* patch = patches->get(pp);
 
     // Temporary and "get" variables
-    double delgamma = 0.0, fTrial = 0.0, IEl = 0.0, J = 0.0, Jinc = 0.0; 
+    double delgamma = 0.0, fTrial = 0.0, IEl = 0.0, J = 0.0; 
     double muBar = 0.0, p = 0.0, sTnorm = 0.0, U = 0.0, W = 0.0;
     double se=0.0;     // Strain energy placeholder
     double c_dil=0.0;  // Speed of sound
     long64 totalLocalizedParticle = 0;
     Matrix3 pBBar_new(0.0), bEB_new(0.0), bElBarTrial(0.0), pDefGradInc(0.0);
-    Matrix3 fBar(0.0), defGrad(0.0), normal(0.0);
+    Matrix3 defGrad(0.0), normal(0.0);
     Matrix3 tauDev(0.0), tauDevTrial(0.0);
     Vector WaveSpeed(1.e-12,1.e-12,1.e-12);
 
@@ -1162,144 +1163,177 @@ void UCNH::computeStressTensor(const PatchSubset* patches,
     new_dw->allocateAndPut(pdTdt,       lb->pdTdtLabel,            pset);
     new_dw->allocateAndPut(p_q,         lb->p_qLabel_preReloc,     pset);
 
+    // The kinematics (F_inc, the Jacobians and the trial elastic left
+    // Cauchy-Green tensor) are computed a block of particles at a time
+    // with the Matrix3Batch kernels; the return mapping and the rest of
+    // the update are done particle by particle.
+    const int width = Matrix3Block::width;
+    particleIndex idx_block[width];
+    double J_block[width], Jinc_block[width], scale_block[width];
+    Matrix3Block F_old, F_new, F_inc, bEB, bElBarTrial_block, tmp;
+
     ParticleSubset::iterator iter = pset->begin();
-    for(; iter != pset->end(); iter++){
-      particleIndex idx = *iter;
-      
-      // Assign zero internal heating by default - modify if necessary.
-      pdTdt[idx] = 0.0;
-
-      pDefGradInc = pDefGrad_new[idx]*pDefGrad[idx].Inverse();
-      Jinc    = pDefGradInc.Determinant();
-      defGrad = pDefGrad_new[idx];
-
-      // 1) Get the volumetric part of the deformation
-      // 2) Compute the deformed volume and new density
-      J               = defGrad.Determinant();
-      double rho_cur  = rho_orig/J;
-
-      // Check 1: Look at Jacobian
-      if (!(J > 0.0)) {
-        cerr << "matl = "  << dwi              << endl;
-        cerr << "F_old = " << pDefGrad[idx]     << endl;
-        cerr << "F_inc = " << pDefGradInc       << endl;
-        cerr << "F_new = " << pDefGrad_new[idx] << endl;
-        cerr << "J = "     << J                 << endl;
-        constParticleVariable<long64> pParticleID;
-        old_dw->get(pParticleID, lb->pParticleIDLabel, pset);
-        cerr << "ParticleID = " << pParticleID[idx] << endl;
-        cerr << "**ERROR** Negative Jacobian of deformation gradient"
-             << " in particle " << pParticleID[idx]  << " which has mass "
-             << pMass[idx] << endl;
-        throw InvalidValue("**ERROR**:Negative Jacobian in UCNH",
-                            __FILE__, __LINE__);
+    while(iter != pset->end()){
+      int n = 0;
+      for(; n < width && iter != pset->end(); n++, iter++){
+        idx_block[n] = *iter;
+        F_old.set(n, pDefGrad[*iter]);
+        F_new.set(n, pDefGrad_new[*iter]);
+        bEB.set(n, bElBar[*iter]);
+      }
+
+      Matrix3Batch::inverse(F_old, tmp, n);
+      Matrix3Batch::multiply(F_new, tmp, F_inc, n);
+      Matrix3Batch::determinant(F_new, J_block, n);
+
+      if(d_usePlasticity){
+        // fBar*bElBar*fBar^T, with fBar the volume preserving part of the
+        // deformation gradient increment
+        Matrix3Batch::determinant(F_inc, Jinc_block, n);
+        for(int l = 0; l < n; l++){
+          scale_block[l] = 1.0/cbrt(Jinc_block[l]);
+        }
+        Matrix3Batch::scale(F_inc, scale_block, tmp, n);
+        Matrix3Batch::multiply(tmp, bEB, F_old, n);
+        Matrix3Batch::multiplyTranspose(F_old, tmp, bElBarTrial_block, n);
+      } else {
+        // F*F^T/J^(2/3)
+        for(int l = 0; l < n; l++){
+          double cubeRootJ = cbrt(J_block[l]);
+          scale_block[l]   = 1.0/(cubeRootJ*cubeRootJ);
+        }
+        Matrix3Batch::multiplyTranspose(F_new, F_new, tmp, n);
+        Matrix3Batch::scale(tmp, scale_block, bElBarTrial_block, n);
       }
+
+      for(int l = 0; l < n; l++){
+        particleIndex idx = idx_block[l];
       
-      // Get the volume preserving part of the deformation gradient increment
-      fBar = pDefGradInc/cbrt(Jinc);
+        // Assign zero internal heating by default - modify if necessary.
+        pdTdt[idx] = 0.0;
+
+        pDefGradInc = F_inc.get(l);
+        defGrad     = pDefGrad_new[idx];
+
+        // 1) Get the volumetric part of the deformation
+        // 2) Compute the deformed volume and new density
+        J               = J_block[l];
+        double rho_cur  = rho_orig/J;
+
+        // Check 1: Look at Jacobian
+        if (!(J > 0.0)) {
+          cerr << "matl = "  << dwi              << endl;
+          cerr << "F_old = " << pDefGrad[idx]     << endl;
+          cerr << "F_inc = " << pDefGradInc       << endl;
+          cerr << "F_new = " << pDefGrad_new[idx] << endl;
+          cerr << "J = "     << J                 << endl;
+          constParticleVariable<long64> pParticleID;
+          old_dw->get(pParticleID, lb->pParticleIDLabel, pset);
+          cerr << "ParticleID = " << pParticleID[idx] << endl;
+          cerr << "**ERROR** Negative Jacobian of deformation gradient"
+               << " in particle " << pParticleID[idx]  << " which has mass "
+               << pMass[idx] << endl;
+          throw InvalidValue("**ERROR**:Negative Jacobian in UCNH",
+                              __FILE__, __LINE__);
+        }
       
-      // Compute the trial elastic part of the volume preserving 
-      // part of the left Cauchy-Green deformation tensor
-      bElBarTrial = fBar*bElBar[idx]*fBar.Transpose();
-      if(!d_usePlasticity){
-        double cubeRootJ      = cbrt(J);
-        double Jtothetwothirds= cubeRootJ*cubeRootJ;
-        bElBarTrial           = pDefGrad_new[idx]* pDefGrad_new[idx].Transpose()
-                                 /Jtothetwothirds;
-      }
-      IEl   = onethird*bElBarTrial.Trace();
-      muBar = IEl*shear;
+        // The trial elastic part of the volume preserving part of the
+        // left Cauchy-Green deformation tensor
+        bElBarTrial = bElBarTrial_block.get(l);
+        IEl   = onethird*bElBarTrial.Trace();
+        muBar = IEl*shear;
       
-      // tauDevTrial is equal to the shear modulus times dev(bElBar)
-      // Compute ||tauDevTrial||
-      tauDevTrial = (bElBarTrial - Identity*IEl)*shear;
-      sTnorm      = tauDevTrial.Norm();
+        // tauDevTrial is equal to the shear modulus times dev(bElBar)
+        // Compute ||tauDevTrial||
+        tauDevTrial = (bElBarTrial - Identity*IEl)*shear;
+        sTnorm      = tauDevTrial.Norm();
       
-      // Check for plastic loading
-      double alpha;
-      if(d_usePlasticity) { 
-        flow = pYieldStress[idx];
-        alpha  = pPlasticStrain[idx];
-        fTrial = sTnorm - sqtwthds*(K*alpha + flow);
-      }
-      if (d_usePlasticity && (fTrial > 0.0) ) {
-        // plastic
-        // Compute increment of slip in the direction of flow
-        delgamma = (fTrial/(2.0*muBar)) / (1.0 + (K/(3.0*muBar)));
-        normal   = tauDevTrial/sTnorm;
+        // Check for plastic loading
+        double alpha;
+        if(d_usePlasticity) { 
+          flow = pYieldStress[idx];
+          alpha  = pPlasticStrain[idx];
+          fTrial = sTnorm - sqtwthds*(K*alpha + flow);
+        }
+        if (d_usePlasticity && (fTrial > 0.0) ) {
+          // plastic
+          // Compute increment of slip in the direction of flow
+          delgamma = (fTrial/(2.0*muBar)) / (1.0 + (K/(3.0*muBar)));
+          normal   = tauDevTrial/sTnorm;
         
-        // The actual shear stress
-        tauDev = tauDevTrial - normal*2.0*muBar*delgamma;
+          // The actual shear stress
+          tauDev = tauDevTrial - normal*2.0*muBar*delgamma;
         
-        // Deal with history variables
-        pPlasticStrain[idx] = alpha + sqtwthds*delgamma;
-        bElBar_new[idx]     = tauDev/shear + Identity*IEl;
-      } else { 
-        // The actual shear stress
-        tauDev          = tauDevTrial; 
-        bElBar_new[idx] = bElBarTrial;
-      }
+          // Deal with history variables
+          pPlasticStrain[idx] = alpha + sqtwthds*delgamma;
+          bElBar_new[idx]     = tauDev/shear + Identity*IEl;
+        } else { 
+          // The actual shear stress
+          tauDev          = tauDevTrial; 
+          bElBar_new[idx] = bElBarTrial;
+        }
       
-      // get the hydrostatic part of the stress
-      p = d_eos->computePressure(rho_orig, rho_cur);
-      //p = 0.5*bulk*(J - 1.0/J);
+        // get the hydrostatic part of the stress
+        p = d_eos->computePressure(rho_orig, rho_cur);
+        //p = 0.5*bulk*(J - 1.0/J);
       
-      // compute the total stress (volumetric + deviatoric)
-      pStress[idx] = Identity*p + tauDev/J;
-
-      if( d_useDamage){
-        pDamage_new[idx] = pDamage[idx];
-        // Modify the stress if particle has failed/damaged
-        if (d_brittleDamage) {
-          updateDamageAndModifyStress(defGrad, pFailureStrain[idx],
-                                      pFailureStrain_new[idx], pVolume_new[idx],
-                                      pDamage[idx], pDamage_new[idx],
-                                      pStress[idx], pParticleID[idx]);
-          pLocalized_new[idx]= pLocalized[idx]; //not really used.
-          if (pDamage_new[idx]>0.0) totalLocalizedParticle+=1;
-        }
-        else {
-          updateFailedParticlesAndModifyStress(defGrad, pFailureStrain[idx], 
-                                           pLocalized[idx], pLocalized_new[idx],
-                                           pTimeOfLoc[idx], pTimeOfLoc_new[idx],
-                                           pStress[idx], pParticleID[idx],time);
-          if (pLocalized_new[idx]>0){
-            totalLocalizedParticle+=1;
+        // compute the total stress (volumetric + deviatoric)
+        pStress[idx] = Identity*p + tauDev/J;
+
+        if( d_useDamage){
+          pDamage_new[idx] = pDamage[idx];
+          // Modify the stress if particle has failed/damaged
+          if (d_brittleDamage) {
+            updateDamageAndModifyStress(defGrad, pFailureStrain[idx],
+                                        pFailureStrain_new[idx], pVolume_new[idx],
+                                        pDamage[idx], pDamage_new[idx],
+                                        pStress[idx], pParticleID[idx]);
+            pLocalized_new[idx]= pLocalized[idx]; //not really used.
+            if (pDamage_new[idx]>0.0) totalLocalizedParticle+=1;
+          }
+          else {
+            updateFailedParticlesAndModifyStress(defGrad, pFailureStrain[idx], 
+                                             pLocalized[idx], pLocalized_new[idx],
+                                             pTimeOfLoc[idx], pTimeOfLoc_new[idx],
+                                             pStress[idx], pParticleID[idx],time);
+            if (pLocalized_new[idx]>0){
+              totalLocalizedParticle+=1;
+            }
           }
         }
-      }
       
-      // Compute the strain energy for non-localized particles
-      U = d_eos->computeStrainEnergy(rho_orig, rho_cur);
-      bulk = d_eos->computeBulkModulus(rho_orig, rho_cur);
-      //  U = .5*bulk*(.5*(J*J - 1.0) - log(J));
-
-      W = .5*shear*(bElBar_new[idx].Trace() - 3.0);
-      double e = (U + W)*pVolume_new[idx]/J;
-      se += e;
-      if(d_useDamage && !(pLocalized_new[idx] == 0)){
-        se -= e;
-      }
+        // Compute the strain energy for non-localized particles
+        U = d_eos->computeStrainEnergy(rho_orig, rho_cur);
+        bulk = d_eos->computeBulkModulus(rho_orig, rho_cur);
+        //  U = .5*bulk*(.5*(J*J - 1.0) - log(J));
+
+        W = .5*shear*(bElBar_new[idx].Trace() - 3.0);
+        double e = (U + W)*pVolume_new[idx]/J;
+        se += e;
+        if(d_useDamage && !(pLocalized_new[idx] == 0)){
+          se -= e;
+        }
 
-      // Compute the local sound speed (uniaxial strain, p-wave modulus)
-      c_dil = sqrt((bulk + 4.*shear/3.)/rho_cur);
+        // Compute the local sound speed (uniaxial strain, p-wave modulus)
+        c_dil = sqrt((bulk + 4.*shear/3.)/rho_cur);
       
-      // Compute wave speed at each particle, store the maximum
-      Vector pvel = pVelocity[idx];
-      WaveSpeed=Vector(Max(c_dil+fabs(pvel.x()),WaveSpeed.x()),
-                       Max(c_dil+fabs(pvel.y()),WaveSpeed.y()),
-                       Max(c_dil+fabs(pvel.z()),WaveSpeed.z()));
+        // Compute wave speed at each particle, store the maximum
+        Vector pvel = pVelocity[idx];
+        WaveSpeed=Vector(Max(c_dil+fabs(pvel.x()),WaveSpeed.x()),
+                         Max(c_dil+fabs(pvel.y()),WaveSpeed.y()),
+                         Max(c_dil+fabs(pvel.z()),WaveSpeed.z()));
       
-      // Compute artificial viscosity term
-      if (flag->d_artificial_viscosity) {
-        double dx_ave = (dx.x() + dx.y() + dx.z())/3.0;
-        double c_bulk = sqrt(bulk/rho_cur);
-        Matrix3 pDeformRate = (velGrad[idx] + velGrad[idx].Transpose())*0.5;
-        p_q[idx] = artificialBulkViscosity(pDeformRate.Trace(), c_bulk,
-                                           rho_cur, dx_ave);
-      } else {
-        p_q[idx] = 0.;
-      }
+        // Compute artificial viscosity term
+        if (flag->d_artificial_viscosity) {
+          double dx_ave = (dx.x() + dx.y() + dx.z())/3.0;
+          double c_bulk = sqrt(bulk/rho_cur);
+          Matrix3 pDeformRate = (velGrad[idx] + velGrad[idx].Transpose())*0.5;
+          p_q[idx] = artificialBulkViscosity(pDeformRate.Trace(), c_bulk,
+                                             rho_cur, dx_ave);
+        } else {
+          p_q[idx] = 0.;
+        }
+      } // end loop over the particles of the block
     } // end loop over particles
     
     WaveSpeed = dx/WaveSpeed;
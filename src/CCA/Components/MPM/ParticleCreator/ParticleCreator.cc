@@ -25,6 +25,7 @@
 #include <CCA/Components/MPM/ParticleCreator/ParticleCreator.h>
 #include <Core/GeometryPiece/GeometryObject.h>
 #include <Core/Grid/Box.h>
+#include <Core/Grid/Variables/BlockRange.hpp>
 #include <Core/Grid/Variables/CellIterator.h>
 #include <CCA/Ports/DataWarehouse.h>
 #include <Core/Grid/Patch.h>
@@ -537,42 +538,75 @@ void ParticleCreator::createPoints(const Patch* patch, GeometryObject* obj,
   if(hasFiner){
     fineLevel = (Level*) curLevel->getFinerLevel().get_rep();
   }
-  for(CellIterator iter = patch->getCellIterator(); !iter.done(); iter++){
-    Point lower = patch->nodePosition(*iter) + dcorner;
-    IntVector c = *iter;
-    
-    if(hasFiner){ // Don't create particles if a finer level exists here
-      const Point CC = patch->cellPosition(c);
-      bool includeExtraCells=false;
-      const Patch* patchExists = fineLevel->getPatchFromPoint(CC,
-                                                             includeExtraCells);
-      if(patchExists != 0){
-       continue;
-      }
-    }
+  // Classify the cells first, so inside() is only called in the cells
+  // that the surface of the piece passes through.
+  IntVector low  = patch->getCellLowIndex();
+  IntVector high = patch->getCellHighIndex();
+  IntVector size = high - low;
+  vector<char> cellClass;
+  classifyCells(piece, patch, dxpp, ppc, cellClass);
+
+  // Generate the points of each k slab concurrently, then append them in
+  // the CellIterator order.
+  vector< vector<Point> > slabPoints(size.z());
+  vector<char>            slabError(size.z(), 0);
+
+  BlockRange slabs(IntVector(0, 0, low.z()), IntVector(1, 1, high.z()));
+  Uintah::parallel_for(slabs, [&](int, int, int k) {
+    vector<Point>& points = slabPoints[k - low.z()];
+
+    for(int j = low.y(); j < high.y(); j++){
+      for(int i = low.x(); i < high.x(); i++){
+        IntVector c(i, j, k);
+        char cls = cellClass[(i - low.x()) + size.x()*((j - low.y()) + size.y()*(k - low.z()))];
+        if(cls == GeometryPiece::Outside){
+          continue;
+        }
 
-    for(int ix=0;ix < ppc.x(); ix++){
-      for(int iy=0;iy < ppc.y(); iy++){
-        for(int iz=0;iz < ppc.z(); iz++){
-        
-          IntVector idx(ix, iy, iz);
-          Point p = lower + dxpp*idx;
-          if (!b2.contains(p)){
-            throw InternalError("Particle created outside of patch?",
-                                 __FILE__, __LINE__);
-          }
-          if (piece->inside(p)){ 
-            Vector p1(p(0),p(1),p(2));
-            p1=affineTrans_A*p1+affineTrans_b;
-            p(0)=p1[0];
-            p(1)=p1[1];
-            p(2)=p1[2];
-            vars.d_object_points[obj].push_back(p);
+        if(hasFiner){ // Don't create particles if a finer level exists here
+          const Point CC = patch->cellPosition(c);
+          bool includeExtraCells=false;
+          const Patch* patchExists = fineLevel->getPatchFromPoint(CC,
+                                                                 includeExtraCells);
+          if(patchExists != 0){
+           continue;
           }
-        }  // z
-      }  // y
-    }  // x
-  }  // CellIterator
+        }
+
+        Point lower = patch->nodePosition(c) + dcorner;
+        for(int ix=0;ix < ppc.x(); ix++){
+          for(int iy=0;iy < ppc.y(); iy++){
+            for(int iz=0;iz < ppc.z(); iz++){
+
+              IntVector idx(ix, iy, iz);
+              Point p = lower + dxpp*idx;
+              if (!b2.contains(p)){
+                slabError[k - low.z()] = 1;
+                continue;
+              }
+              if (cls == GeometryPiece::Inside || piece->inside(p)){
+                Vector p1(p(0),p(1),p(2));
+                p1=affineTrans_A*p1+affineTrans_b;
+                p(0)=p1[0];
+                p(1)=p1[1];
+                p(2)=p1[2];
+                points.push_back(p);
+              }
+            }  // z
+          }  // y
+        }  // x
+      }  // i
+    }  // j
+  });
+
+  vector<Point>& objectPoints = vars.d_object_points[obj];
+  for(int k = 0; k < size.z(); k++){
+    if (slabError[k]){
+      throw InternalError("Particle created outside of patch?",
+                           __FILE__, __LINE__);
+    }
+    objectPoints.insert(objectPoints.end(), slabPoints[k].begin(), slabPoints[k].end());
+  }
 
 /*
 //  This part is associated with CBDI_CompressiveCylinder.ups input file.
@@ -601,6 +635,67 @@ void ParticleCreator::createPoints(const Patch* patch, GeometryObject* obj,
 
 }
 
+//______________________________________________________________________
+//  Bisects the cells [low, high) of the patch until the region spanned by
+//  their particle positions is inside or outside of the piece, or is a
+//  single cell (which is then on the boundary).
+static void
+classifyRegion(const GeometryPiece* piece, const Patch* patch,
+               const IntVector& low, const IntVector& high,
+               const Vector& dcorner, const Vector& dspan,
+               const IntVector& patchLow, const IntVector& patchSize,
+               vector<char>& cellClass)
+{
+  IntVector size = high - low;
+  Point lo = patch->nodePosition(low) + dcorner;
+  Point hi = patch->nodePosition(high - IntVector(1,1,1)) + dcorner + dspan;
+
+  GeometryPiece::Classification cls = piece->classify(Box(lo, hi));
+
+  if (cls == GeometryPiece::Boundary && size != IntVector(1,1,1)) {
+    int d = 2;
+    if (size.x() >= size.y() && size.x() >= size.z()) {
+      d = 0;
+    } else if (size.y() >= size.z()) {
+      d = 1;
+    }
+    IntVector midHigh = high;
+    IntVector midLow  = low;
+    midHigh[d] = low[d] + size[d]/2;
+    midLow[d]  = midHigh[d];
+    classifyRegion(piece, patch, low,    midHigh, dcorner, dspan, patchLow, patchSize, cellClass);
+    classifyRegion(piece, patch, midLow, high,    dcorner, dspan, patchLow, patchSize, cellClass);
+    return;
+  }
+
+  for (int k = low.z(); k < high.z(); k++) {
+    for (int j = low.y(); j < high.y(); j++) {
+      for (int i = low.x(); i < high.x(); i++) {
+        cellClass[(i - patchLow.x()) + patchSize.x()*((j - patchLow.y()) + patchSize.y()*(k - patchLow.z()))] = cls;
+      }
+    }
+  }
+}
+
+void
+ParticleCreator::classifyCells(const GeometryPieceP piece, const Patch* patch,
+                               const Vector& dxpp, const IntVector& ppc,
+                               vector<char>& cellClass)
+{
+  IntVector low  = patch->getCellLowIndex();
+  IntVector high = patch->getCellHighIndex();
+  IntVector size = high - low;
+
+  cellClass.assign(size.x()*size.y()*size.z(), GeometryPiece::Boundary);
+  if (size.x() <= 0 || size.y() <= 0 || size.z() <= 0) {
+    return;
+  }
+
+  Vector dcorner = dxpp*0.5;
+  Vector dspan   = dxpp*(ppc - IntVector(1,1,1));
+  classifyRegion(piece.get_rep(), patch, low, high, dcorner, dspan, low, size, cellClass);
+}
+
 void 
 ParticleCreator::initializeParticle(const Patch* patch,
                                     vector<GeometryObject*>::const_iterator obj,
@@ -763,7 +858,7 @@ ParticleCreator::countAndCreateParticles(const Patch* patch,
     sgp->setCellSize(patch->dCell());
     if(fgp){
       fgp->setCpti(d_useCPTI);
-      fgp->readPoints(patch->getID());
+      fgp->readPoints(patch);
       numPts = fgp->returnPointCount();
     } else {
       // setParticleSpacing seems to only be used by GUVSphereShell
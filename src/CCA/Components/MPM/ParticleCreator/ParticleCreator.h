@@ -124,6 +124,16 @@ namespace Uintah {
 
     void createPoints(const Patch* patch, GeometryObject* obj, ObjectVars& vars);
 
+    //////////////////////////////////////////////////////////////////////////
+    /*! Classify each cell of the patch as GeometryPiece::Inside, Outside or
+        Boundary, by recursive bisection of the patch using
+        GeometryPiece::classify, so only the particle positions of the
+        boundary cells need to be tested with inside() */
+    //////////////////////////////////////////////////////////////////////////
+    void classifyCells(const GeometryPieceP piece, const Patch* patch,
+                       const Vector& dxpp, const IntVector& ppc,
+                       std::vector<char>& cellClass);
+
 
 
     virtual void initializeParticle(const Patch* patch,
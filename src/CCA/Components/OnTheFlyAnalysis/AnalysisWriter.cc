@@ -0,0 +1,611 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <CCA/Components/OnTheFlyAnalysis/AnalysisWriter.h>
+
+#include <Core/Exceptions/InternalError.h>
+#include <Core/Exceptions/ProblemSetupException.h>
+#include <Core/OS/Dir.h> // for MKDIR
+#include <Core/Parallel/Parallel.h>
+#include <Core/ProblemSpec/ProblemSpec.h>
+#include <Core/Util/DebugStream.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <dirent.h>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+
+using namespace Uintah;
+using namespace std;
+
+//__________________________________
+//  To turn on the output
+//  setenv SCI_DEBUG "ANALYSISWRITER_DBG_COUT:+"
+static DebugStream cout_dbg("ANALYSISWRITER_DBG_COUT", false);
+
+std::map<std::string, int> AnalysisWriter::s_moduleCount;
+
+namespace {
+
+  const int analysisMagic   = 0x55414E41;     // "UANA"
+  const int analysisVersion = 1;
+
+  //______________________________________________________________________
+  //  Readers used by the converter; they return false at the end of the file
+  bool readInt( FILE* fp, int& value )
+  {
+    return fread( &value, sizeof(int), 1, fp ) == 1;
+  }
+
+  bool readString( FILE* fp, string& value )
+  {
+    int length;
+    if( !readInt( fp, length ) || length < 0 ){
+      return false;
+    }
+    value.resize( length );
+    return length == 0 || fread( &value[0], 1, length, fp ) == (size_t)length;
+  }
+
+  //__________________________________
+  //  A chunk of records found in one of the binary files
+  struct RecordChunk {
+    int    stream;      // index into the streams of all files
+    double time;
+    int    file;
+    long   offset;      // of the first value
+    int    nRecords;
+  };
+
+  struct StreamAndTime {
+    bool operator()( const RecordChunk& a, const RecordChunk& b ) const
+    {
+      if( a.stream != b.stream ){
+        return a.stream < b.stream;
+      }
+      return a.time < b.time;
+    }
+  };
+
+  //__________________________________
+  //  Create the directories of the relative path "name" under udaDir
+  void createDirectories( const string& udaDir, const string& name )
+  {
+    for( size_t pos = name.find( '/' ); pos != string::npos; pos = name.find( '/', pos + 1 ) ){
+      string path = udaDir + "/" + name.substr( 0, pos );
+      DIR *check = opendir( path.c_str() );
+      if( check == nullptr ){
+        MKDIR( path.c_str(), 0777 );
+      } else {
+        closedir( check );
+      }
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+AnalysisWriter::AnalysisWriter( const std::string& moduleName,
+                                Output* dataArchiver )
+  : d_dataArchiver( dataArchiver )
+{
+  // more than one instance of a module writes to different files
+  int n = s_moduleCount[moduleName]++;
+
+  ostringstream name;
+  name << moduleName;
+  if( n > 0 ){
+    name << "_" << n;
+  }
+  d_moduleName = name.str();
+
+  d_binary        = false;
+  d_flushInterval = 10;
+  d_bufferSize    = 64 * 1024 * 1024;
+  d_bufferTime    = -DBL_MAX;
+  d_nBufferTimes  = 0;
+  d_fp            = nullptr;
+}
+
+//______________________________________________________________________
+//
+AnalysisWriter::~AnalysisWriter()
+{
+  try {
+    flush();
+  } catch( Exception& e ) {
+    cerr << "AnalysisWriter(" << d_moduleName << "): " << e.message() << endl;
+  }
+
+  if( d_fp ){
+    fclose( d_fp );
+  }
+}
+
+//______________________________________________________________________
+//
+void
+AnalysisWriter::problemSetup( const ProblemSpecP& module_spec )
+{
+  ProblemSpecP out_ps = module_spec->findBlock( "analysisOutput" );
+  if( !out_ps ){
+    return;
+  }
+
+  string format = "text";
+  out_ps->getAttribute( "format", format );
+
+  if( format == "binary" ){
+    d_binary = true;
+  } else if( format != "text" ){
+    throw ProblemSetupException( "AnalysisWriter: <analysisOutput format> must be text or binary, not " + format,
+                                 __FILE__, __LINE__ );
+  }
+
+  double megaBytes;
+  out_ps->getWithDefault( "flushInterval", d_flushInterval, 10 );
+  out_ps->getWithDefault( "bufferSize",    megaBytes,       64.0 );
+
+  // bulletproofing
+  if( d_flushInterval < 1 || megaBytes <= 0.0 ){
+    throw ProblemSetupException( "AnalysisWriter: <flushInterval> and <bufferSize> must be positive",
+                                 __FILE__, __LINE__ );
+  }
+  d_bufferSize = (size_t)( megaBytes * 1024 * 1024 );
+
+  proc0cout << "  " << d_moduleName << ": binary output, flushed every " << d_flushInterval
+            << " output times or " << megaBytes << " MB\n";
+}
+
+//______________________________________________________________________
+//
+int
+AnalysisWriter::defineLayout( const std::string& header,
+                              const std::vector<Column>& columns )
+{
+  ostringstream key;
+  key << header;
+  for( unsigned int c = 0; c < columns.size(); c++ ){
+    key << '\0' << columns[c].type << columns[c].format;
+  }
+
+  std::lock_guard<std::mutex> lock( d_mutex );
+
+  std::map<std::string, int>::iterator iter = d_layouts.find( key.str() );
+  if( iter != d_layouts.end() ){
+    return iter->second;
+  }
+
+  int id = d_layoutColumns.size();
+  d_layouts[key.str()] = id;
+  d_layoutColumns.push_back( columns.size() );
+
+  append( "L", 1 );
+  appendInt( id );
+  appendString( header );
+  appendInt( columns.size() );
+  for( unsigned int c = 0; c < columns.size(); c++ ){
+    append( &columns[c].type, 1 );
+    appendString( columns[c].format );
+  }
+  return id;
+}
+
+//______________________________________________________________________
+//
+int
+AnalysisWriter::openStream( const std::string& name,
+                            const int layout )
+{
+  std::lock_guard<std::mutex> lock( d_mutex );
+
+  std::map<std::string, int>::iterator iter = d_streams.find( name );
+  if( iter != d_streams.end() ){
+    return iter->second;
+  }
+
+  int id = d_streamLayout.size();
+  d_streams[name] = id;
+  d_streamLayout.push_back( layout );
+
+  append( "S", 1 );
+  appendInt( id );
+  appendInt( layout );
+  appendString( name );
+  return id;
+}
+
+//______________________________________________________________________
+//
+void
+AnalysisWriter::write( const int stream,
+                       const std::vector<double>& values )
+{
+  if( values.empty() ){
+    return;
+  }
+
+  double time = d_dataArchiver->getCurrentTime();
+
+  std::lock_guard<std::mutex> lock( d_mutex );
+
+  const int nColumns = d_layoutColumns[ d_streamLayout[stream] ];
+  if( values.size() % nColumns != 0 ){
+    ostringstream warn;
+    warn << "AnalysisWriter(" << d_moduleName << "): " << values.size()
+         << " values is not a whole number of records of " << nColumns << " columns";
+    throw InternalError( warn.str(), __FILE__, __LINE__ );
+  }
+
+  // a new output time
+  if( time != d_bufferTime ){
+    if( d_nBufferTimes >= d_flushInterval ){
+      flushBuffer();
+    }
+    d_bufferTime = time;
+    d_nBufferTimes++;
+  }
+
+  append( "R", 1 );
+  appendInt( stream );
+  append( &time, sizeof(double) );
+  appendInt( values.size() / nColumns );
+  append( &values[0], values.size() * sizeof(double) );
+
+  if( d_buffer.size() >= d_bufferSize ){
+    flushBuffer();
+  }
+}
+
+//______________________________________________________________________
+//
+void
+AnalysisWriter::flush()
+{
+  std::lock_guard<std::mutex> lock( d_mutex );
+  flushBuffer();
+}
+
+//______________________________________________________________________
+//  The caller holds the mutex
+void
+AnalysisWriter::flushBuffer()
+{
+  d_nBufferTimes = 0;
+
+  if( d_buffer.empty() ){
+    return;
+  }
+
+  //__________________________________
+  //  Open the file on the first flush; the uda does not exist
+  //  when the modules are set up.
+  if( !d_fp ){
+    string dirName = d_dataArchiver->getOutputLocation() + "/binaryAnalysis";
+
+    DIR *check = opendir( dirName.c_str() );
+    if( check == nullptr ){
+      MKDIR( dirName.c_str(), 0777 );
+    } else {
+      closedir( check );
+    }
+
+    const int rank = Parallel::getMPIRank();
+
+    ostringstream fname;
+    fname << dirName << "/" << d_moduleName << ".p" << std::setw(5) << std::setfill('0') << rank << ".bin";
+    d_filename = fname.str();
+
+    d_fp = fopen( d_filename.c_str(), "ab" );
+    if( !d_fp ){
+      throw InternalError( "\nERROR:AnalysisWriter: failed opening file " + d_filename, __FILE__, __LINE__ );
+    }
+
+    // session header
+    fwrite( "H", 1, 1, d_fp );
+    fwrite( &analysisMagic,   sizeof(int), 1, d_fp );
+    fwrite( &analysisVersion, sizeof(int), 1, d_fp );
+    fwrite( &rank,            sizeof(int), 1, d_fp );
+  }
+
+  cout_dbg << Parallel::getMPIRank() << " AnalysisWriter: writing " << d_buffer.size()
+           << " bytes to " << d_filename << endl;
+
+  if( fwrite( &d_buffer[0], 1, d_buffer.size(), d_fp ) != d_buffer.size() ){
+    throw InternalError( "\nERROR:AnalysisWriter: failed writing to file " + d_filename, __FILE__, __LINE__ );
+  }
+  fflush( d_fp );
+
+  d_buffer.clear();
+}
+
+//______________________________________________________________________
+//
+void
+AnalysisWriter::append( const void* data, const size_t bytes )
+{
+  const char* c = static_cast<const char*>( data );
+  d_buffer.insert( d_buffer.end(), c, c + bytes );
+}
+
+void
+AnalysisWriter::appendInt( const int value )
+{
+  append( &value, sizeof(int) );
+}
+
+void
+AnalysisWriter::appendString( const std::string& value )
+{
+  appendInt( value.size() );
+  append( value.data(), value.size() );
+}
+
+//______________________________________________________________________
+//  Read all binary files of the uda, sort the records of each stream
+//  by time and write the text files.
+void
+AnalysisWriter::convertToText( const std::string& udaDir,
+                               const bool verbose )
+{
+  string dirName = udaDir + "/binaryAnalysis";
+
+  DIR* dir = opendir( dirName.c_str() );
+  if( dir == nullptr ){
+    throw InternalError( "AnalysisWriter: the directory " + dirName + " does not exist", __FILE__, __LINE__ );
+  }
+
+  vector<string> files;
+  struct dirent* entry;
+  while( ( entry = readdir( dir ) ) != nullptr ){
+    string name = entry->d_name;
+    if( name.size() > 4 && name.compare( name.size() - 4, 4, ".bin" ) == 0 ){
+      files.push_back( dirName + "/" + name );
+    }
+  }
+  closedir( dir );
+  sort( files.begin(), files.end() );
+
+  //__________________________________
+  //  Index the chunks of records of all files
+  vector<string>                   layoutHeader;
+  vector< vector<Column> >         layoutColumns;
+  map<string, int>                 layoutIds;         // key: header + columns
+
+  vector<string>                   streamName;
+  vector<int>                      streamLayout;
+  map<string, int>                 streamIds;
+
+  vector<RecordChunk>              chunks;
+
+  for( unsigned int f = 0; f < files.size(); f++ ){
+    FILE* fp = fopen( files[f].c_str(), "rb" );
+    if( !fp ){
+      throw InternalError( "AnalysisWriter: failed opening file " + files[f], __FILE__, __LINE__ );
+    }
+
+    struct stat st;
+    stat( files[f].c_str(), &st );
+    const long fileSize = st.st_size;
+
+    if( verbose ){
+      cout << "Reading " << files[f] << endl;
+    }
+
+    // session ids -> ids of all files
+    vector<int> sessionLayout;
+    vector<int> sessionStream;
+
+    bool truncated = false;
+    char tag;
+
+    while( !truncated && fread( &tag, 1, 1, fp ) == 1 ){
+
+      switch( tag ){
+
+        case 'H': {
+          int magic, version, rank;
+          if( !readInt( fp, magic ) || !readInt( fp, version ) || !readInt( fp, rank ) ){
+            truncated = true;
+            break;
+          }
+          if( magic != analysisMagic || version > analysisVersion ){
+            fclose( fp );
+            throw InternalError( "AnalysisWriter: " + files[f] + " is not an analysis file of this version and byte order",
+                                 __FILE__, __LINE__ );
+          }
+          sessionLayout.clear();
+          sessionStream.clear();
+          break;
+        }
+
+        case 'L': {
+          int id, nColumns;
+          string header;
+          if( !readInt( fp, id ) || !readString( fp, header ) || !readInt( fp, nColumns ) ){
+            truncated = true;
+            break;
+          }
+
+          vector<Column> columns;
+          ostringstream key;
+          key << header;
+          for( int c = 0; c < nColumns && !truncated; c++ ){
+            char type;
+            string format;
+            if( fread( &type, 1, 1, fp ) != 1 || !readString( fp, format ) ){
+              truncated = true;
+              break;
+            }
+            columns.push_back( Column( type, format ) );
+            key << '\0' << type << format;
+          }
+          if( truncated ){
+            break;
+          }
+
+          if( layoutIds.count( key.str() ) == 0 ){
+            layoutIds[key.str()] = layoutHeader.size();
+            layoutHeader.push_back( header );
+            layoutColumns.push_back( columns );
+          }
+          if( (int)sessionLayout.size() <= id ){
+            sessionLayout.resize( id + 1, -1 );
+          }
+          sessionLayout[id] = layoutIds[key.str()];
+          break;
+        }
+
+        case 'S': {
+          int id, layout;
+          string name;
+          if( !readInt( fp, id ) || !readInt( fp, layout ) || !readString( fp, name ) ){
+            truncated = true;
+            break;
+          }
+
+          if( streamIds.count( name ) == 0 ){
+            streamIds[name] = streamName.size();
+            streamName.push_back( name );
+            streamLayout.push_back( sessionLayout.at( layout ) );
+          }
+          if( (int)sessionStream.size() <= id ){
+            sessionStream.resize( id + 1, -1 );
+          }
+          sessionStream[id] = streamIds[name];
+          break;
+        }
+
+        case 'R': {
+          RecordChunk chunk;
+          int id;
+          if( !readInt( fp, id ) || fread( &chunk.time, sizeof(double), 1, fp ) != 1 ||
+              !readInt( fp, chunk.nRecords ) ){
+            truncated = true;
+            break;
+          }
+          chunk.stream = sessionStream.at( id );
+          chunk.file   = f;
+          chunk.offset = ftell( fp );
+
+          long bytes = (long)chunk.nRecords * layoutColumns[ streamLayout[chunk.stream] ].size() * sizeof(double);
+          if( chunk.offset + bytes > fileSize ){
+            truncated = true;
+            break;
+          }
+          fseek( fp, bytes, SEEK_CUR );
+          chunks.push_back( chunk );
+          break;
+        }
+
+        default:
+          fclose( fp );
+          throw InternalError( "AnalysisWriter: " + files[f] + " is corrupt", __FILE__, __LINE__ );
+      }
+    }
+
+    // a run that died while writing may leave a partial chunk at the end
+    if( truncated ){
+      cerr << "WARNING: AnalysisWriter: " << files[f] << " ends with an incomplete chunk; it is ignored\n";
+    }
+    fclose( fp );
+  }
+
+  //__________________________________
+  //  Write the text files.  The records of a stream may come from
+  //  several ranks (after load balancing) and several sessions.
+  stable_sort( chunks.begin(), chunks.end(), StreamAndTime() );
+
+  FILE* in     = nullptr;
+  int   inFile = -1;
+  FILE* out    = nullptr;
+  vector<double> values;
+
+  for( unsigned int i = 0; i < chunks.size(); i++ ){
+    const RecordChunk& chunk = chunks[i];
+    const vector<Column>& columns = layoutColumns[ streamLayout[chunk.stream] ];
+    const int nColumns = columns.size();
+
+    // a new text file
+    if( i == 0 || chunk.stream != chunks[i-1].stream ){
+      if( out ){
+        fclose( out );
+      }
+      const string& name = streamName[chunk.stream];
+      createDirectories( udaDir, name );
+
+      string filename = udaDir + "/" + name;
+      out = fopen( filename.c_str(), "w" );
+      if( !out ){
+        throw InternalError( "AnalysisWriter: failed opening file " + filename, __FILE__, __LINE__ );
+      }
+      fputs( layoutHeader[ streamLayout[chunk.stream] ].c_str(), out );
+
+      if( verbose ){
+        cout << "  Writing " << filename << endl;
+      }
+    }
+
+    if( chunk.file != inFile ){
+      if( in ){
+        fclose( in );
+      }
+      in     = fopen( files[chunk.file].c_str(), "rb" );
+      inFile = chunk.file;
+    }
+
+    values.resize( (size_t)chunk.nRecords * nColumns );
+    fseek( in, chunk.offset, SEEK_SET );
+    if( fread( &values[0], sizeof(double), values.size(), in ) != values.size() ){
+      throw InternalError( "AnalysisWriter: failed reading " + files[chunk.file], __FILE__, __LINE__ );
+    }
+
+    for( int r = 0; r < chunk.nRecords; r++ ){
+      const double* record = &values[(size_t)r * nColumns];
+      for( int c = 0; c < nColumns; c++ ){
+        if( columns[c].type == 'i' ){
+          fprintf( out, columns[c].format.c_str(), (int)record[c] );
+        } else {
+          fprintf( out, columns[c].format.c_str(), record[c] );
+        }
+      }
+      fprintf( out, "\n" );
+    }
+  }
+
+  if( in ){
+    fclose( in );
+  }
+  if( out ){
+    fclose( out );
+  }
+
+  if( verbose ){
+    cout << "Converted " << chunks.size() << " record chunks of " << streamName.size() << " files" << endl;
+  }
+}
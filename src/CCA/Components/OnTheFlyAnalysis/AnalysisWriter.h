@@ -0,0 +1,178 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef Packages_Uintah_CCA_Components_ontheflyAnalysis_AnalysisWriter_h
+#define Packages_Uintah_CCA_Components_ontheflyAnalysis_AnalysisWriter_h
+
+#include <CCA/Ports/Output.h>
+#include <Core/ProblemSpec/ProblemSpecP.h>
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Uintah {
+
+/**************************************
+
+CLASS
+   AnalysisWriter
+
+GENERAL INFORMATION
+
+   AnalysisWriter.h
+
+   Department of Mechanical Engineering
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+KEYWORDS
+   lineExtract, planeExtract, particleExtract, containerExtract
+
+DESCRIPTION
+   Buffered binary output for the extract analysis modules.  Instead of
+   opening and appending to one text file per point, particle or plane,
+   a module sends its records to the writer, which keeps them in memory
+   and appends them to a single file per module and rank:
+
+     <uda>/binaryAnalysis/<module>.p<rank>.bin
+
+   The text files are described by "streams" (the file name relative to
+   the uda) and "layouts" (the file header and the printf format of each
+   column).  A record is the column values of one line; int columns are
+   stored as doubles.  The file is a sequence of chunks, each starting
+   with a one character tag:
+
+     'H'  session: int magic, int version, int rank
+     'L'  layout:  int id, string header, int nColumns,
+                   nColumns x (char type ('d' or 'i'), string format)
+     'S'  stream:  int id, int layout, string name
+     'R'  records: int stream, double time, int nRecords,
+                   nRecords x nColumns doubles
+
+   where a string is an int length followed by the characters.  Ids are
+   only valid within a session; every restart appends a new one.
+
+   The buffer is written when it grows past <bufferSize> MB or when the
+   records of more than <flushInterval> output times have been collected,
+   and when the module is destroyed.  The records of the last output
+   times are lost if the run dies before that.
+
+   convertToText() (the analysis2text tool) rebuilds the text files
+   the modules write when the binary format is not selected.
+
+   Input file:
+     <Module name="lineExtract">
+       <analysisOutput format="binary">   (default: text)
+         <flushInterval> 10 </flushInterval>
+         <bufferSize>    64 </bufferSize>
+       </analysisOutput>
+
+WARNING
+   The binary files are written in the byte order of the machine and
+   must be converted on a machine with the same byte order.
+
+****************************************/
+
+  class AnalysisWriter {
+  public:
+
+    // one column of a text file
+    struct Column {
+      Column( const char type, const std::string& format ) : type( type ), format( format ) {}
+
+      char        type;        // 'd' (double) or 'i' (int)
+      std::string format;      // printf format, including the leading separator
+    };
+
+    AnalysisWriter( const std::string& moduleName,
+                    Output* dataArchiver );
+
+    ~AnalysisWriter();
+
+    void problemSetup( const ProblemSpecP& module_spec );
+
+    bool isBinary() const { return d_binary; }
+
+    // Returns the id of the layout.  Defining the same layout again
+    // returns the id of the first definition.
+    int defineLayout( const std::string& header,
+                      const std::vector<Column>& columns );
+
+    // Returns the id of the stream writing the text file "name" (relative
+    // to the uda) with the given layout.
+    int openStream( const std::string& name,
+                    const int layout );
+
+    // Adds one or more records (values.size() must be a multiple of the
+    // number of columns) to the stream, stamped with the current time.
+    void write( const int stream,
+                const std::vector<double>& values );
+
+    // Writes the buffer to the file.
+    void flush();
+
+    // Converts the binary files of an uda to the text files.
+    static void convertToText( const std::string& udaDir,
+                               const bool verbose );
+
+  private:
+
+    void flushBuffer();
+
+    void append( const void* data, const size_t bytes );
+    void appendInt( const int value );
+    void appendString( const std::string& value );
+
+    std::string  d_moduleName;
+    Output*      d_dataArchiver;
+
+    bool         d_binary;
+    int          d_flushInterval;     // number of output times kept in the buffer
+    size_t       d_bufferSize;        // bytes
+
+    std::map<std::string, int> d_layouts;        // key: header + columns
+    std::vector<int>           d_layoutColumns;  // number of columns of each layout
+    std::map<std::string, int> d_streams;        // key: name
+    std::vector<int>           d_streamLayout;
+
+    std::vector<char> d_buffer;
+    double            d_bufferTime;   // time of the last record
+    int               d_nBufferTimes; // number of output times in the buffer
+
+    std::string d_filename;
+    FILE*       d_fp;
+
+    std::mutex  d_mutex;
+
+    static std::map<std::string, int> s_moduleCount;
+  };
+}
+
+#endif
@@ -64,8 +64,6 @@ static DebugStream cout_doing("MinMax_DOING_COUT", false);
 //______________________________________________________________________    
 /*  TO DO:
        - Find a way to keep track of the min/max points for each variable
-       - Conditional scheduling of the tasks.  Currently, the reductions
-         are occuring every timestep.
          
        
 ______________________________________________________________________*/
@@ -80,6 +78,7 @@ MinMax::MinMax(ProblemSpecP& module_spec,
   d_dataArchiver = dataArchiver;
   d_matl_set = 0;
   d_zero_matl = 0;
+  d_engine = nullptr;
   d_lb = scinew MinMaxLabel();
 }
 
@@ -103,6 +102,8 @@ MinMax::~MinMax()
     VarLabel::destroy( d_analyzeVars[i].reductionMaxLabel );
   }
   
+  StatisticsEngine::release( d_engine );
+
   delete d_lb;
 }
 
@@ -152,6 +153,8 @@ void MinMax::problemSetup(const ProblemSpecP& prob_spec,
   }
   
   int defaultMatl = d_matl->getDWIndex();
+
+  d_engine = StatisticsEngine::acquire( d_sharedState, d_dataArchiver, this );
   
   //__________________________________
   vector<int> m;
@@ -274,6 +277,17 @@ void MinMax::problemSetup(const ProblemSpecP& prob_spec,
     me.reductionMinLabel = meMin;
     
     d_analyzeVars.push_back(me);
+
+    //__________________________________
+    //  Request the min & max from the statistics engine
+    StatisticsEngine::Request req( label, matl, level );
+    req.statistics        = StatisticsEngine::Min | StatisticsEngine::Max;
+    req.samplingFrequency = d_writeFreq;
+    req.startTime         = d_startTime;
+    req.stopTime          = d_stopTime;
+    req.lastSampleLabel   = d_lb->lastCompTimeLabel;   // checkpointed: keeps the cadence over a restart
+
+    d_requests.push_back( d_engine->request( req ) );
 #ifdef HAVE_VISIT
     if( sharedState->getVisIt() ) {
       d_sharedState->d_analysisVars.push_back(me);
@@ -369,44 +383,33 @@ void MinMax::scheduleDoAnalysis(SchedulerP& sched,
   const int L_indx = level->getIndex();
   
   //__________________________________
-  //  computeMinMax task;     
-  Task* t0 = scinew Task( "MinMax::computeMinMax", 
-                     this,&MinMax::computeMinMax );
-                        
-  t0->requires( Task::OldDW, d_lb->lastCompTimeLabel );
- 
+  //  The min/max are computed by the statistics engine
+  d_engine->scheduleStatistics( sched, level, this );
+
+  bool isAnalyzed = false;
   for ( unsigned int i =0 ; i < d_analyzeVars.size(); i++ ) {
-    VarLabel* label   = d_analyzeVars[i].label;
-    const int myLevel = d_analyzeVars[i].level;
-    
-    // is this the right level for this variable?
-    if ( isRightLevel( myLevel, L_indx, level ) ){
-    
-      // bulletproofing
-      if( label == nullptr ){
-        string name = label->getName();
-        throw InternalError("MinMax: scheduleDoAnalysis label not found: " 
-                           + name , __FILE__, __LINE__);
-      }
+    isAnalyzed = isAnalyzed || isRightLevel( d_analyzeVars[i].level, L_indx, level );
+  }
 
-      MaterialSubset* matSubSet = scinew MaterialSubset();
-      matSubSet->add( d_analyzeVars[i].matl );
-      matSubSet->addReference();
+#ifdef HAVE_VISIT
+  //__________________________________
+  //  VisIt reads the min/max from the reduction variables
+  if( d_sharedState->getVisIt() && isAnalyzed ) {
+    Task* t0 = scinew Task( "MinMax::putReductionVars",
+                       this,&MinMax::putReductionVars );
 
-      t0->requires( Task::NewDW, label, matSubSet, gn, 0 );
-     
-      t0->computes( d_analyzeVars[i].reductionMinLabel, level.get_rep() );
-      t0->computes( d_analyzeVars[i].reductionMaxLabel, level.get_rep() );
+    t0->requires( Task::NewDW, d_engine->getStatisticsLabel(), level.get_rep() );
 
-      if(matSubSet && matSubSet->removeReference()){
-        delete matSubSet;
+    for ( unsigned int i =0 ; i < d_analyzeVars.size(); i++ ) {
+      if ( isRightLevel( d_analyzeVars[i].level, L_indx, level ) ){
+        t0->computes( d_analyzeVars[i].reductionMinLabel, level.get_rep() );
+        t0->computes( d_analyzeVars[i].reductionMaxLabel, level.get_rep() );
       }
     }
+    sched->addTask( t0, level->eachPatch(), d_matl_set );
   }
-  
-  sched->addTask( t0, level->eachPatch(), d_matl_set );
- 
- 
+#endif
+
   //__________________________________
   //  Write min/max to a  file
   // Only write data on patch 0 on each level
@@ -417,14 +420,9 @@ void MinMax::scheduleDoAnalysis(SchedulerP& sched,
   t1->requires( Task::OldDW, d_lb->lastCompTimeLabel );
   t1->requires( Task::OldDW, d_lb->fileVarsStructLabel, d_zero_matl, gn, 0 );
   
-  // schedule the reduction variables
-  for ( unsigned int i =0 ; i < d_analyzeVars.size(); i++ ) {
-  
-    int myLevel = d_analyzeVars[i].level;
-    if ( isRightLevel( myLevel, L_indx, level) ){
-      t1->requires( Task::NewDW, d_analyzeVars[i].reductionMinLabel, level.get_rep() );
-      t1->requires( Task::NewDW, d_analyzeVars[i].reductionMaxLabel, level.get_rep() );
-    }
+  // the results of the statistics engine
+  if( isAnalyzed ){
+    t1->requires( Task::NewDW, d_engine->getStatisticsLabel(), level.get_rep() );
   }
     
   t1->computes( d_lb->lastCompTimeLabel );
@@ -440,124 +438,41 @@ void MinMax::scheduleDoAnalysis(SchedulerP& sched,
 }
 
 //______________________________________________________________________
-//  This task computes and min/max of each variable
-//
-void MinMax::computeMinMax(const ProcessorGroup* pg,
-                           const PatchSubset* patches,
-                           const MaterialSubset*,
-                           DataWarehouse* old_dw,
-                           DataWarehouse* new_dw)
-{ 
-   // the user may want to restart from an uda that wasn't using the DA module
-  // This logic allows that.
-  max_vartype writeTime;
-  double lastWriteTime = 0;
-  if( old_dw->exists( d_lb->lastCompTimeLabel ) ){
-    old_dw->get(writeTime, d_lb->lastCompTimeLabel);
-    lastWriteTime = writeTime;
-  }
-
-  double now = d_dataArchiver->getCurrentTime();
-  if(now < d_startTime || now > d_stopTime){
-    return;
-  }
- 
-  double nextWriteTime = lastWriteTime + 1.0/d_writeFreq;
-  //__________________________________
-  // compute min/max if it's time to write
-  if( now >= nextWriteTime){
-
-    const LevelP level = getLevelP(patches);
-    const int L_indx = level->getIndex();
-    
-    /*  Loop over patches  */
-    for(int p=0;p<patches->size();p++){
-      const Patch* patch = patches->get(p);    
-
-      /* Loop over variables */
-      for (unsigned int i =0 ; i < d_analyzeVars.size(); i++) {
-        VarLabel* label = d_analyzeVars[i].label;
-        string labelName = label->getName();
-
-        // bulletproofing
-        if( label == nullptr ){
-          throw InternalError("MinMax: analyze label not found: " 
-                               + labelName , __FILE__, __LINE__);
-        }    
-      
-        // Are we on the right level for this level
-        const int myLevel = d_analyzeVars[i].level;
-        if ( !isRightLevel( myLevel, L_indx, level) ){
-          continue;
-        }
+//  Put the min/max computed by the statistics engine into the reduction
+//  variables read by VisIt.  Every rank holds the same values.
+void MinMax::putReductionVars(const ProcessorGroup* pg,
+                              const PatchSubset* patches,
+                              const MaterialSubset*,
+                              DataWarehouse* old_dw,
+                              DataWarehouse* new_dw)
+{
+  const LevelP level = getLevelP(patches);
+  const int L_indx = level->getIndex();
 
-        printTask(patches, patch,cout_doing,"Doing MinMax::computeMinMax");
+  for (unsigned int i =0 ; i < d_analyzeVars.size(); i++) {
+    if ( !isRightLevel( d_analyzeVars[i].level, L_indx, level) ){
+      continue;
+    }
 
-        const TypeDescription* td = label->typeDescription();
-        const TypeDescription* subtype = td->getSubType();
+    const StatisticsEngine::Result& result = d_engine->getResult( d_requests[i], L_indx );
+    const VarLabel* meMin = d_analyzeVars[i].reductionMinLabel;
+    const VarLabel* meMax = d_analyzeVars[i].reductionMaxLabel;
 
-        int indx = d_analyzeVars[i].matl;
-        
-        switch(td->getType()){
-          case TypeDescription::CCVariable:             // CC Variables
-            switch(subtype->getType()) {
-            
-            case TypeDescription::double_type:{         // CC double
-              GridIterator iter=patch->getCellIterator();
-              findMinMax <constCCVariable<double>, double > ( new_dw, label, indx, patch, iter );
-              break;
-            }
-            case TypeDescription::Vector: {             // CC Vector
-              GridIterator iter=patch->getCellIterator();
-              findMinMax< constCCVariable<Vector>, Vector > ( new_dw, label, indx, patch, iter );
-              break;
-            }
-            default:
-              throw InternalError("MinMax: invalid data type", __FILE__, __LINE__); 
-            }
-            break;
-            
-          case TypeDescription::NCVariable:             // NC Variables
-            switch(subtype->getType()) {
-            
-            case TypeDescription::double_type:{         // NC double
-              GridIterator iter=patch->getNodeIterator();
-              findMinMax <constNCVariable<double>, double > ( new_dw, label, indx, patch, iter );
-              break;
-            }
-            case TypeDescription::Vector: {             // NC Vector
-              GridIterator iter=patch->getNodeIterator();
-              findMinMax< constNCVariable<Vector>, Vector > ( new_dw, label, indx, patch, iter );
-              break; 
-            }
-            default:
-              throw InternalError("MinMax: invalid data type", __FILE__, __LINE__); 
-            }
-            break;            
-          case TypeDescription::SFCXVariable: {         // SFCX double
-            GridIterator iter=patch->getSFCXIterator();
-            findMinMax <constSFCXVariable<double>, double > ( new_dw, label, indx, patch, iter );
-            break;
-          }
-          case TypeDescription::SFCYVariable: {         // SFCY double
-            GridIterator iter=patch->getSFCYIterator();
-            findMinMax <constSFCYVariable<double>, double > ( new_dw, label, indx, patch, iter );
-            break;
-          }
-          case TypeDescription::SFCZVariable: {         // SFCZ double
-            GridIterator iter=patch->getSFCZIterator();
-            findMinMax <constSFCZVariable<double>, double > ( new_dw, label, indx, patch, iter );
-            break;
-          }
-          default:
-            ostringstream warn;
-            warn << "ERROR:AnalysisModule:MinMax: ("<< label->getName() << " " 
-                 << td->getName() << " ) has not been implemented" << endl;
-            throw InternalError(warn.str(), __FILE__, __LINE__);
-        }
-      }  // VarLabel loop          
-    }  // patches
-  }  // time to write data
+    if( d_analyzeVars[i].label->typeDescription()->getSubType()->getType() == TypeDescription::Vector ){
+      Vector minQ( result.min[0], result.min[1], result.min[2] );
+      Vector maxQ( result.max[0], result.max[1], result.max[2] );
+      if( result.nComponents == 0 ){
+        minQ = maxQ = Vector(0,0,0);      // nothing computed yet
+      }
+      new_dw->put( minvec_vartype( minQ ), meMin, level.get_rep() );
+      new_dw->put( maxvec_vartype( maxQ ), meMax, level.get_rep() );
+    } else {
+      double minQ = ( result.nComponents == 0 ) ? 0.0 : result.min[0];
+      double maxQ = ( result.nComponents == 0 ) ? 0.0 : result.max[0];
+      new_dw->put( min_vartype( minQ ), meMin, level.get_rep() );
+      new_dw->put( max_vartype( maxQ ), meMax, level.get_rep() );
+    }
+  }
 }
 
 //______________________________________________________________________
@@ -588,7 +503,12 @@ void MinMax::doAnalysis(const ProcessorGroup* pg,
     return;
   }
 
-  double nextWriteTime = lastWriteTime + 1.0/d_writeFreq;
+  // the statistics engine sampled the variables at this time
+  bool isSampled = false;
+  for (unsigned int i =0 ; i < d_analyzeVars.size(); i++) {
+    isSampled = isSampled || ( isRightLevel( d_analyzeVars[i].level, L_indx, levelP ) &&
+                               d_engine->isCurrent( d_requests[i], L_indx, now ) );
+  }
   
   for(int p=0;p<patches->size();p++){
     const Patch* patch = patches->get(p);
@@ -615,7 +535,7 @@ void MinMax::doAnalysis(const ProcessorGroup* pg,
     // write data if this processor owns this patch
     // and if it's time to write.  With AMR data the proc
     // may not own the patch
-    if( proc == pg->myrank() && now >= nextWriteTime){  
+    if( proc == pg->myrank() && isSampled ){  
 
       printTask(patches, patch,cout_doing,"Doing MinMax::doAnalysis");
 
@@ -677,39 +597,21 @@ void MinMax::doAnalysis(const ProcessorGroup* pg,
         
         
         //__________________________________
-        //  Now get the data from the DW and write it to the file
-        string VLmax = labelName + "_max";
-        string VLmin = labelName + "_min";
-        const VarLabel* meMin = d_analyzeVars[i].reductionMinLabel;
-        const VarLabel* meMax = d_analyzeVars[i].reductionMaxLabel;
-        
-        
+        //  Now get the results from the statistics engine and write them to the file
+        const StatisticsEngine::Result& result = d_engine->getResult( d_requests[i], L_indx );
+
         const TypeDescription* td = label->typeDescription();
         const TypeDescription* subtype = td->getSubType();
                 
         switch(subtype->getType()) {
 
           case TypeDescription::double_type:{
-            max_vartype maxQ;
-            min_vartype minQ;
-            
-            new_dw->get( maxQ, meMax, level);
-            new_dw->get( minQ, meMin, level); 
-        
-            fprintf( fp, "%16.15E     %16.15E    %16.15E\n",now, (double)minQ, (double)maxQ );
+            fprintf( fp, "%16.15E     %16.15E    %16.15E\n",now, result.min[0], result.max[0] );
            break;
           }
           case TypeDescription::Vector: {
-            maxvec_vartype maxQ;
-            minvec_vartype minQ;
-            
-            new_dw->get( maxQ, meMax, level);
-            new_dw->get( minQ, meMin, level); 
-            Vector maxQ_V = maxQ;
-            Vector minQ_V = minQ;
-            
             fprintf( fp, "%16.15E     [%16.15E %16.15E %16.15E]   [%16.15E %16.15E %16.15E]\n",now,  
-                          minQ_V.x(), minQ_V.y(), minQ_V.z(),maxQ_V.x(), maxQ_V.y(), maxQ_V.z() );
+                          result.min[0], result.min[1], result.min[2], result.max[0], result.max[1], result.max[2] );
           
             break;
           }
@@ -733,62 +635,6 @@ void MinMax::doAnalysis(const ProcessorGroup* pg,
 }
 
 
-//______________________________________________________________________
-//  Find the min/max of the VarLabel along with the 
-//  position.  The position isn't used since we don't have a way 
-//  to save that info in the DW.
-template <class Tvar, class Ttype>
-void MinMax::findMinMax( DataWarehouse*  new_dw,
-                         const VarLabel* varLabel,
-                         const int       indx,
-                         const Patch*    patch,
-                         GridIterator    iter )
-{
-
-  const Level* level = patch->getLevel();
-  Tvar Q_var;
-  Ttype Q;
-  new_dw->get(Q_var, varLabel, indx, patch, Ghost::None, 0);
-  
-  Ttype maxQ( Q_var[*iter] );  // initial values
-  Ttype minQ( maxQ );
-  
-  IntVector maxIndx( *iter );
-  IntVector minIndx( *iter );
-  
-  for (;!iter.done();iter++) {
-    IntVector c = *iter;
-    Q = Q_var[c];
-    
-    // use Max & Min instead of std::max & min
-    // These functions can handle Vectors
-    maxQ = Max(maxQ,Q);  
-    minQ = Min(minQ,Q);
-    
-    if ( Q == maxQ ){
-      maxIndx = c;
-    }
-    if (Q == minQ ){
-      minIndx = c;
-    }
-  }  
-
-  //Point maxPos = level->getCellPosition(maxIndx);
-  //Point minPos = level->getCellPosition(minIndx);          
-
-  // cout_doing << varLabel->getName() << " max: " << maxQ << " " << maxIndx << " maxPos " << maxPos << endl;
-  // cout_doing << "         min: " << minQ << " " << minIndx << " minPos " << minPos << endl; 
-  
-  const string labelName = varLabel->getName();
-  string VLmax = labelName + "_max";
-  string VLmin = labelName + "_min";
-  const VarLabel* meMin = VarLabel::find( VLmin );
-  const VarLabel* meMax = VarLabel::find( VLmax );
-
-  new_dw->put(  ReductionVariable<Ttype, Reductions::Max<Ttype> >(maxQ), meMax,  level );
-  new_dw->put(  ReductionVariable<Ttype, Reductions::Min<Ttype> >(minQ), meMin,  level );
-}
-
 //______________________________________________________________________
 //  Open the file if it doesn't exist and write the file header
 void MinMax::createFile(string& filename,  FILE*& fp, string& levelIndex)
@@ -26,6 +26,7 @@
 #ifndef Packages_Uintah_CCA_Components_ontheflyAnalysis_MinMax_h
 #define Packages_Uintah_CCA_Components_ontheflyAnalysis_MinMax_h
 #include <CCA/Components/OnTheFlyAnalysis/AnalysisModule.h>
+#include <CCA/Components/OnTheFlyAnalysis/StatisticsEngine.h>
 #include <CCA/Ports/Output.h>
 #include <Core/Grid/SimulationState.h>
 #include <Core/Grid/Variables/VarTypes.h>
@@ -50,7 +51,9 @@ GENERAL INFORMATION
    MinMax.h
    
    This computes the minimum and maximum values in the 
-   computational domain.
+   computational domain.  The values are computed by the
+   StatisticsEngine, together with the other statistics requested
+   on the same variables.
 
    Todd Harman
    Department of Mechanical Engineering
@@ -94,12 +97,12 @@ GENERAL INFORMATION
                     DataWarehouse*,
                     DataWarehouse* new_dw);
                     
-    void computeMinMax(const ProcessorGroup* pg,
-                       const PatchSubset* patches,    
-                       const MaterialSubset*,         
-                       DataWarehouse* old_dw,         
-                       DataWarehouse* new_dw);        
-                                               
+    void putReductionVars(const ProcessorGroup* pg,
+                          const PatchSubset* patches,
+                          const MaterialSubset*,
+                          DataWarehouse* old_dw,
+                          DataWarehouse* new_dw);
+
     void doAnalysis(const ProcessorGroup* pg,
                     const PatchSubset* patches,
                     const MaterialSubset*,
@@ -112,14 +115,6 @@ GENERAL INFORMATION
     
     void createDirectory(std::string& lineName);
 
-    template <class Tvar, class Ttype>
-    void findMinMax( DataWarehouse*  new_dw,
-                     const VarLabel* varLabel,
-                     const int       indx,
-                     const Patch*    patch,
-                     GridIterator    iter );
-                    
-    
     // general labels
     class MinMaxLabel {
     public:
@@ -136,6 +131,8 @@ GENERAL INFORMATION
     double d_stopTime;
     
     std::vector<SimulationState::analysisVar> d_analyzeVars;
+    std::vector<int> d_requests;       // StatisticsEngine handle of each variable
+    StatisticsEngine* d_engine;
     
     SimulationStateP d_sharedState;
     Output* d_dataArchiver;
@@ -0,0 +1,898 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <CCA/Components/OnTheFlyAnalysis/StatisticsEngine.h>
+
+#include <CCA/Ports/LoadBalancer.h>
+#include <CCA/Ports/Scheduler.h>
+
+#include <Core/Exceptions/InternalError.h>
+#include <Core/Exceptions/ProblemSetupException.h>
+#include <Core/Grid/DbgOutput.h>
+#include <Core/Grid/Grid.h>
+#include <Core/Grid/Level.h>
+#include <Core/Grid/Patch.h>
+#include <Core/Grid/SimulationState.h>
+#include <Core/Grid/Variables/CCVariable.h>
+#include <Core/Grid/Variables/NCVariable.h>
+#include <Core/Grid/Variables/PerPatch.h>
+#include <Core/Grid/Variables/SFCXVariable.h>
+#include <Core/Grid/Variables/SFCYVariable.h>
+#include <Core/Grid/Variables/SFCZVariable.h>
+#include <Core/Grid/Variables/SoleVariable.h>
+#include <Core/Grid/Variables/VarTypes.h>
+#include <Core/Parallel/ProcessorGroup.h>
+#include <Core/Util/DebugStream.h>
+
+#include <sci_defs/mpi_defs.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <set>
+#include <sstream>
+
+using namespace Uintah;
+using namespace std;
+
+//__________________________________
+//  To turn on the output
+//  setenv SCI_DEBUG "STATISTICSENGINE_DOING_COUT:+"
+static DebugStream cout_doing("STATISTICSENGINE_DOING_COUT", false);
+
+std::map<const SimulationState*, StatisticsEngine*> StatisticsEngine::s_engines;
+
+namespace {
+
+  inline double component( const double& q, const int ) { return q; }
+  inline double component( const Vector& q, const int c ) { return q[c]; }
+
+  //______________________________________________________________________
+  //  The user-defined MPI_Op.  The single element is the whole packed
+  //  buffer: the number of sums, the sums, then the maxima.
+  void statisticsReductionOp( void* invec, void* inoutvec, int* len, MPI_Datatype* )
+  {
+    double* in    = static_cast<double*>(invec);
+    double* inout = static_cast<double*>(inoutvec);
+
+    for (int e = 0; e < *len; e++) {
+      int nSums = (int)inout[0];
+      int nMaxs = (int)inout[1];
+      for (int i = 2; i < 2 + nSums; i++) {
+        inout[i] += in[i];
+      }
+      for (int i = 2 + nSums; i < 2 + nSums + nMaxs; i++) {
+        inout[i] = max(inout[i], in[i]);
+      }
+      in    += 2 + nSums + nMaxs;
+      inout += 2 + nSums + nMaxs;
+    }
+  }
+
+  // created on first use, freed when the last engine is released
+  MPI_Op s_statisticsOp = MPI_OP_NULL;
+
+  MPI_Op statisticsOp()
+  {
+    if (s_statisticsOp == MPI_OP_NULL) {
+      Uintah::MPI::Op_create(statisticsReductionOp, 1, &s_statisticsOp);
+    }
+    return s_statisticsOp;
+  }
+
+  void freeStatisticsOp()
+  {
+    int finalized = 0;
+    Uintah::MPI::Finalized(&finalized);
+    if (s_statisticsOp != MPI_OP_NULL && !finalized) {
+      Uintah::MPI::Op_free(&s_statisticsOp);
+    }
+    s_statisticsOp = MPI_OP_NULL;
+  }
+
+  //______________________________________________________________________
+  //  The index range [lo, hi) of [low, high) whose positions lie inside
+  //  the region.  stagger[d] is 1 if the variable sits on the nodes
+  //  (faces) in direction d, 0 if it sits on the cell centers.
+  void regionRange( const Level* level,
+                    const Box& region,
+                    const IntVector& low,
+                    const IntVector& high,
+                    const IntVector& stagger,
+                    IntVector& lo,
+                    IntVector& hi )
+  {
+    lo = high;
+    hi = high;
+    for (int d = 0; d < 3; d++) {
+      int first = high[d];
+      int last  = low[d] - 1;
+      for (int i = low[d]; i < high[d]; i++) {
+        IntVector c = low;
+        c[d] = i;
+        double x = stagger[d] ? level->getNodePosition(c)(d) : level->getCellPosition(c)(d);
+        if (x >= region.lower()(d) && x <= region.upper()(d)) {
+          first = min(first, i);
+          last  = i;
+        }
+      }
+      if (first > last) {
+        lo = hi = low;      // empty
+        return;
+      }
+      lo[d] = first;
+      hi[d] = last + 1;
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+StatisticsEngine::Request::Request( const VarLabel* label, const int matl, const int level )
+  : label( label ), matl( matl ), level( level ), statistics( 0 ),
+    hasRegion( false ), nBins( 0 ), binMin( 0 ), binMax( 0 ),
+    samplingFrequency( 0 ), startTime( 0 ), stopTime( DBL_MAX ),
+    lastSampleLabel( nullptr )
+{
+}
+
+//______________________________________________________________________
+//
+StatisticsEngine::StatisticsEngine( SimulationStateP& sharedState,
+                                    Output* dataArchiver,
+                                    const AnalysisModule* owner )
+  : d_sharedState( sharedState ), d_dataArchiver( dataArchiver ),
+    d_owner( owner ), d_refCount( 0 ), d_matl_set( 0 )
+{
+  d_statisticsLabel  = VarLabel::create( "statisticsEngine_time",
+                                         SoleVariable<double>::getTypeDescription() );
+  d_accumulatedLabel = VarLabel::create( "statisticsEngine_accumulated",
+                                         PerPatch<double>::getTypeDescription() );
+  d_zero_matl = scinew MaterialSubset();
+  d_zero_matl->add(0);
+  d_zero_matl->addReference();
+
+  d_zero_matl_set = scinew MaterialSet();
+  d_zero_matl_set->add(0);
+  d_zero_matl_set->addReference();
+}
+
+//______________________________________________________________________
+//
+StatisticsEngine::~StatisticsEngine()
+{
+  cout_doing << " Doing: destroying StatisticsEngine " << endl;
+
+  VarLabel::destroy( d_statisticsLabel );
+  VarLabel::destroy( d_accumulatedLabel );
+
+  if( d_matl_set && d_matl_set->removeReference() ) {
+    delete d_matl_set;
+  }
+  if( d_zero_matl_set && d_zero_matl_set->removeReference() ) {
+    delete d_zero_matl_set;
+  }
+  if( d_zero_matl && d_zero_matl->removeReference() ) {
+    delete d_zero_matl;
+  }
+}
+
+//______________________________________________________________________
+//
+StatisticsEngine*
+StatisticsEngine::acquire( SimulationStateP& sharedState,
+                           Output* dataArchiver,
+                           const AnalysisModule* module )
+{
+  StatisticsEngine*& engine = s_engines[ sharedState.get_rep() ];
+  if( engine == nullptr ) {
+    engine = scinew StatisticsEngine( sharedState, dataArchiver, module );
+  }
+  engine->d_refCount++;
+  return engine;
+}
+
+//______________________________________________________________________
+//
+void
+StatisticsEngine::release( StatisticsEngine* engine )
+{
+  if( engine == nullptr || --engine->d_refCount > 0 ) {
+    return;
+  }
+  s_engines.erase( engine->d_sharedState.get_rep() );
+  delete engine;
+
+  if( s_engines.empty() ) {
+    freeStatisticsOp();
+  }
+}
+
+//______________________________________________________________________
+//  Add a request and attach it to the field and accumulator it shares
+//  with the earlier requests.
+int
+StatisticsEngine::request( const Request& req )
+{
+  if( req.label == nullptr ) {
+    throw InternalError( "StatisticsEngine: request without a label", __FILE__, __LINE__ );
+  }
+
+  const TypeDescription* td = req.label->typeDescription();
+  const int baseType = td->getType();
+  const int subType  = td->getSubType() ? td->getSubType()->getType() : TypeDescription::Unknown;
+
+  bool isFace = ( baseType == TypeDescription::SFCXVariable ||
+                  baseType == TypeDescription::SFCYVariable ||
+                  baseType == TypeDescription::SFCZVariable );
+
+  // CC and NC doubles and Vectors, face centered doubles
+  if( ( baseType != TypeDescription::CCVariable && baseType != TypeDescription::NCVariable && !isFace ) ||
+      ( subType != TypeDescription::double_type && subType != TypeDescription::Vector ) ||
+      ( isFace && subType != TypeDescription::double_type ) ) {
+    ostringstream warn;
+    warn << "ERROR:StatisticsEngine: (" << req.label->getName() << " "
+         << td->getName() << " ) has not been implemented" << endl;
+    throw ProblemSetupException( warn.str(), __FILE__, __LINE__ );
+  }
+
+  if( ( req.statistics & Histogram ) && ( req.nBins < 1 || !( req.binMax > req.binMin ) ) ) {
+    ostringstream warn;
+    warn << "ERROR:StatisticsEngine: invalid histogram for " << req.label->getName()
+         << " (nBins " << req.nBins << ", range [" << req.binMin << ", " << req.binMax << "])";
+    throw ProblemSetupException( warn.str(), __FILE__, __LINE__ );
+  }
+
+  const int handle = d_requests.size();
+  d_requests.push_back( req );
+
+  //__________________________________
+  //  the field
+  int field = -1;
+  for( unsigned f = 0; f < d_fields.size(); f++ ) {
+    if( d_fields[f].label == req.label && d_fields[f].matl == req.matl ) {
+      field = f;
+    }
+  }
+  if( field < 0 ) {
+    Field me;
+    me.label       = req.label;
+    me.matl        = req.matl;
+    me.nComponents = ( subType == TypeDescription::Vector ) ? 3 : 1;
+    field = d_fields.size();
+    d_fields.push_back( me );
+  }
+  d_fields[field].requests.push_back( handle );
+
+  //__________________________________
+  //  the accumulator
+  int acc = -1;
+  for( unsigned a = 0; a < d_fields[field].accumulators.size(); a++ ) {
+    const Accumulator& me = d_accumulators[ d_fields[field].accumulators[a] ];
+    if( me.hasRegion == req.hasRegion &&
+        ( !req.hasRegion || ( me.region.lower() == req.region.lower() &&
+                              me.region.upper() == req.region.upper() ) ) ) {
+      acc = d_fields[field].accumulators[a];
+    }
+  }
+  if( acc < 0 ) {
+    Accumulator me;
+    me.field     = field;
+    me.hasRegion = req.hasRegion;
+    me.region    = req.region;
+    acc = d_accumulators.size();
+    d_accumulators.push_back( me );
+    d_fields[field].accumulators.push_back( acc );
+  }
+  d_accumulators[acc].requests.push_back( handle );
+
+  //__________________________________
+  //  the histogram
+  if( req.statistics & Histogram ) {
+    bool found = false;
+    for( unsigned h = 0; h < d_accumulators[acc].histograms.size(); h++ ) {
+      const HistogramSpec& me = d_histograms[ d_accumulators[acc].histograms[h] ];
+      found = found || ( me.nBins == req.nBins && me.binMin == req.binMin && me.binMax == req.binMax );
+    }
+    if( !found ) {
+      HistogramSpec me;
+      me.nBins  = req.nBins;
+      me.binMin = req.binMin;
+      me.binMax = req.binMax;
+      d_accumulators[acc].histograms.push_back( d_histograms.size() );
+      d_histograms.push_back( me );
+    }
+  }
+
+  //__________________________________
+  //  the materials of the accumulate task
+  if( d_matl_set && d_matl_set->removeReference() ) {
+    delete d_matl_set;
+  }
+  vector<int> m;
+  m.push_back( 0 );
+  for( unsigned f = 0; f < d_fields.size(); f++ ) {
+    m.push_back( d_fields[f].matl );
+  }
+  sort( m.begin(), m.end() );
+  m.erase( unique( m.begin(), m.end() ), m.end() );
+
+  d_matl_set = scinew MaterialSet();
+  d_matl_set->addAll( m );
+  d_matl_set->addReference();
+
+  cout_doing << "StatisticsEngine: request " << handle << " " << req.label->getName()
+             << " matl " << req.matl << " level " << req.level
+             << " field " << field << " accumulator " << acc << endl;
+  return handle;
+}
+
+//______________________________________________________________________
+//
+bool
+StatisticsEngine::isRightLevel( const int myLevel,
+                                const int L_indx,
+                                const int numLevels ) const
+{
+  return ( myLevel == allLevels || myLevel == L_indx ||
+           ( myLevel == finestLevel && L_indx == numLevels - 1 ) );
+}
+
+//______________________________________________________________________
+//  Same test as the modules use: inside [startTime, stopTime] and at
+//  least 1/samplingFrequency after the last sample on this level.
+bool
+StatisticsEngine::isDue( const int request,
+                         const int L_indx,
+                         const double now ) const
+{
+  const Request& req = d_requests[request];
+  if( now < req.startTime || now > req.stopTime ) {
+    return false;
+  }
+  if( req.samplingFrequency <= 0 ) {
+    return true;
+  }
+
+  map<pair<int, int>, double>::const_iterator iter = d_lastSample.find( make_pair( request, L_indx ) );
+  if( iter == d_lastSample.end() ) {
+    return true;
+  }
+  return now >= iter->second + 1.0 / req.samplingFrequency;
+}
+
+//______________________________________________________________________
+//
+bool
+StatisticsEngine::isFieldDue( const int field,
+                              const int L_indx,
+                              const double now ) const
+{
+  const Field& me = d_fields[field];
+  for( unsigned r = 0; r < me.requests.size(); r++ ) {
+    if( isDue( me.requests[r], L_indx, now ) ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//______________________________________________________________________
+//  d_lastSample starts out empty, also after a restart.  The requests
+//  with a lastSampleLabel take the time of their last sample from the
+//  old_dw, so the sampling cadence carries over a restart.
+void
+StatisticsEngine::seedLastSamples( DataWarehouse* old_dw,
+                                   const int L_indx )
+{
+  lock_guard<mutex> lock( d_mutex );
+
+  for( unsigned r = 0; r < d_requests.size(); r++ ) {
+    const Request& req = d_requests[r];
+    const pair<int, int> key( r, L_indx );
+
+    if( req.lastSampleLabel == nullptr || d_lastSample.count( key ) > 0 ||
+        !old_dw->exists( req.lastSampleLabel ) ) {
+      continue;
+    }
+    max_vartype lastSample;
+    old_dw->get( lastSample, req.lastSampleLabel );
+    d_lastSample[key] = lastSample;
+  }
+}
+
+//______________________________________________________________________
+//  The layout of the packed buffer of a level: for each accumulator
+//  the count, the sums and sums of squares and the histogram bins,
+//  then, after all the sums, the maxima and the negated minima.
+void
+StatisticsEngine::buildLayout( const LevelP& level )
+{
+  const int L_indx    = level->getIndex();
+  const int numLevels = level->getGrid()->numLevels();
+
+  LevelLayout& layout = d_layouts[L_indx];
+  layout.fields.clear();
+  layout.sumOffset.assign( d_accumulators.size(), -1 );
+  layout.maxOffset.assign( d_accumulators.size(), -1 );
+  layout.nSums = 0;
+  layout.nMaxs = 0;
+
+  for( unsigned f = 0; f < d_fields.size(); f++ ) {
+    const Field& field = d_fields[f];
+
+    bool onLevel = false;
+    for( unsigned r = 0; r < field.requests.size(); r++ ) {
+      onLevel = onLevel || isRightLevel( d_requests[ field.requests[r] ].level, L_indx, numLevels );
+    }
+    if( !onLevel ) {
+      continue;
+    }
+    layout.fields.push_back( f );
+
+    const int nc = field.nComponents;
+    for( unsigned a = 0; a < field.accumulators.size(); a++ ) {
+      const Accumulator& acc = d_accumulators[ field.accumulators[a] ];
+      layout.sumOffset[ field.accumulators[a] ] = layout.nSums;
+      layout.nSums += 1 + 2 * nc;
+      for( unsigned h = 0; h < acc.histograms.size(); h++ ) {
+        layout.nSums += nc * d_histograms[ acc.histograms[h] ].nBins;
+      }
+    }
+  }
+
+  for( unsigned f = 0; f < layout.fields.size(); f++ ) {
+    const Field& field = d_fields[ layout.fields[f] ];
+    for( unsigned a = 0; a < field.accumulators.size(); a++ ) {
+      layout.maxOffset[ field.accumulators[a] ] = layout.nSums + layout.nMaxs;
+      layout.nMaxs += 2 * field.nComponents;
+    }
+  }
+
+  initPartial( layout, layout.partial );
+}
+
+//______________________________________________________________________
+//
+void
+StatisticsEngine::initPartial( const LevelLayout& layout,
+                               vector<double>& buffer ) const
+{
+  buffer.assign( layout.nSums + layout.nMaxs, 0.0 );
+  fill( buffer.begin() + layout.nSums, buffer.end(), -DBL_MAX );
+}
+
+//______________________________________________________________________
+//
+void
+StatisticsEngine::scheduleStatistics( SchedulerP& sched,
+                                      const LevelP& level,
+                                      const AnalysisModule* module )
+{
+  if( module != d_owner ) {
+    return;
+  }
+
+  buildLayout( level );
+
+  const LevelLayout& layout = d_layouts[ level->getIndex() ];
+  if( layout.fields.empty() ) {
+    return;
+  }
+
+  printSchedule( level, cout_doing, "StatisticsEngine::scheduleStatistics" );
+
+  // not copied to a new AMR grid and not checkpointed
+  sched->overrideVariableBehavior( d_statisticsLabel->getName(),  false, false, false, true, true );
+  sched->overrideVariableBehavior( d_accumulatedLabel->getName(), false, false, false, true, true );
+
+  //__________________________________
+  //  one pass over each patch
+  Task* t0 = scinew Task( "StatisticsEngine::accumulate",
+                          this, &StatisticsEngine::accumulate );
+
+  for( unsigned f = 0; f < layout.fields.size(); f++ ) {
+    const Field& field = d_fields[ layout.fields[f] ];
+
+    MaterialSubset* matSubSet = scinew MaterialSubset();
+    matSubSet->add( field.matl );
+    matSubSet->addReference();
+
+    t0->requires( Task::NewDW, field.label, matSubSet, Ghost::None, 0 );
+
+    if( matSubSet && matSubSet->removeReference() ) {
+      delete matSubSet;
+    }
+  }
+  t0->computes( d_accumulatedLabel, d_zero_matl );
+
+  // the modules' times of their last sample, for seedLastSamples()
+  set<const VarLabel*> lastSampleLabels;
+  for( unsigned r = 0; r < d_requests.size(); r++ ) {
+    if( d_requests[r].lastSampleLabel != nullptr ) {
+      lastSampleLabels.insert( d_requests[r].lastSampleLabel );
+    }
+  }
+  for( set<const VarLabel*>::const_iterator iter = lastSampleLabels.begin(); iter != lastSampleLabels.end(); iter++ ) {
+    t0->requires( Task::OldDW, *iter );
+  }
+
+  sched->addTask( t0, level->eachPatch(), d_matl_set );
+
+  //__________________________________
+  //  one reduction per rank
+  Task* t1 = scinew Task( "StatisticsEngine::reduce",
+                          this, &StatisticsEngine::reduce, level->getIndex() );
+
+  t1->setType( Task::OncePerProc );
+  t1->usesMPI( true );
+  t1->requires( Task::NewDW, d_accumulatedLabel, d_zero_matl, Ghost::None, 0 );
+  for( set<const VarLabel*>::const_iterator iter = lastSampleLabels.begin(); iter != lastSampleLabels.end(); iter++ ) {
+    t1->requires( Task::OldDW, *iter );
+  }
+  t1->computes( d_statisticsLabel, level.get_rep() );
+
+  LoadBalancer* lb = sched->getLoadBalancer();
+  sched->addTask( t1, lb->getPerProcessorPatchSet( level ), d_zero_matl_set );
+}
+
+//______________________________________________________________________
+//  One pass over the data of each field that is due; the patch results
+//  are merged into the accumulators of this rank.
+void
+StatisticsEngine::accumulate( const ProcessorGroup*,
+                              const PatchSubset* patches,
+                              const MaterialSubset*,
+                              DataWarehouse* old_dw,
+                              DataWarehouse* new_dw )
+{
+  const Level* level = getLevel( patches );
+  const int L_indx   = level->getIndex();
+  const double now   = d_dataArchiver->getCurrentTime();
+
+  seedLastSamples( old_dw, L_indx );
+
+  const LevelLayout& layout = d_layouts[L_indx];
+
+  for( int p = 0; p < patches->size(); p++ ) {
+    const Patch* patch = patches->get(p);
+
+    printTask( patches, patch, cout_doing, "Doing StatisticsEngine::accumulate" );
+
+    vector<double> buffer;
+    initPartial( layout, buffer );
+
+    for( unsigned f = 0; f < layout.fields.size(); f++ ) {
+      const Field& field = d_fields[ layout.fields[f] ];
+      if( !isFieldDue( layout.fields[f], L_indx, now ) ) {
+        continue;
+      }
+
+      const TypeDescription* td = field.label->typeDescription();
+      const bool isVector = ( td->getSubType()->getType() == TypeDescription::Vector );
+
+      switch( td->getType() ) {
+        case TypeDescription::CCVariable:
+          if( isVector ) {
+            accumulateField< constCCVariable<Vector>, Vector >( new_dw, field, patch, patch->getCellLowIndex(), patch->getCellHighIndex(),
+                                                                IntVector(0, 0, 0), layout, buffer );
+          } else {
+            accumulateField< constCCVariable<double>, double >( new_dw, field, patch, patch->getCellLowIndex(), patch->getCellHighIndex(),
+                                                                IntVector(0, 0, 0), layout, buffer );
+          }
+          break;
+        case TypeDescription::NCVariable:
+          if( isVector ) {
+            accumulateField< constNCVariable<Vector>, Vector >( new_dw, field, patch, patch->getNodeLowIndex(), patch->getNodeHighIndex(),
+                                                                IntVector(1, 1, 1), layout, buffer );
+          } else {
+            accumulateField< constNCVariable<double>, double >( new_dw, field, patch, patch->getNodeLowIndex(), patch->getNodeHighIndex(),
+                                                                IntVector(1, 1, 1), layout, buffer );
+          }
+          break;
+        case TypeDescription::SFCXVariable:
+          accumulateField< constSFCXVariable<double>, double >( new_dw, field, patch, patch->getSFCXLowIndex(), patch->getSFCXHighIndex(),
+                                                                IntVector(1, 0, 0), layout, buffer );
+          break;
+        case TypeDescription::SFCYVariable:
+          accumulateField< constSFCYVariable<double>, double >( new_dw, field, patch, patch->getSFCYLowIndex(), patch->getSFCYHighIndex(),
+                                                                IntVector(0, 1, 0), layout, buffer );
+          break;
+        case TypeDescription::SFCZVariable:
+          accumulateField< constSFCZVariable<double>, double >( new_dw, field, patch, patch->getSFCZLowIndex(), patch->getSFCZHighIndex(),
+                                                                IntVector(0, 0, 1), layout, buffer );
+          break;
+        default:
+          throw InternalError( "StatisticsEngine: invalid variable type", __FILE__, __LINE__ );
+      }
+    }
+
+    //__________________________________
+    //  merge into the accumulators of this rank
+    {
+      lock_guard<mutex> lock( d_mutex );
+      LevelLayout& me = d_layouts[L_indx];
+      for( int i = 0; i < layout.nSums; i++ ) {
+        me.partial[i] += buffer[i];
+      }
+      for( int i = layout.nSums; i < layout.nSums + layout.nMaxs; i++ ) {
+        me.partial[i] = max( me.partial[i], buffer[i] );
+      }
+    }
+
+    PerPatch<double> accumulated( now );
+    new_dw->put( accumulated, d_accumulatedLabel, 0, patch );
+  }
+}
+
+//______________________________________________________________________
+//  The pass over one field: every value is read once and added to all
+//  the accumulators (regions) of the field that contain it.
+template <class Tvar, class Ttype>
+void
+StatisticsEngine::accumulateField( DataWarehouse* new_dw,
+                                   const Field& field,
+                                   const Patch* patch,
+                                   const IntVector& low,
+                                   const IntVector& high,
+                                   const IntVector& stagger,
+                                   const LevelLayout& layout,
+                                   vector<double>& buffer )
+{
+  Tvar Q_var;
+  new_dw->get( Q_var, field.label, field.matl, patch, Ghost::None, 0 );
+
+  const int nc = field.nComponents;
+
+  // the accumulators and their index ranges on this patch
+  struct Range {
+    IntVector lo;
+    IntVector hi;
+    double*   sums;
+    double*   maxs;
+    std::vector<const HistogramSpec*> hists;
+  };
+  vector<Range> ranges;
+
+  for( unsigned a = 0; a < field.accumulators.size(); a++ ) {
+    const Accumulator& acc = d_accumulators[ field.accumulators[a] ];
+
+    Range r;
+    r.lo = low;
+    r.hi = high;
+    if( acc.hasRegion ) {
+      regionRange( patch->getLevel(), acc.region, low, high, stagger, r.lo, r.hi );
+    }
+    if( r.hi.x() <= r.lo.x() || r.hi.y() <= r.lo.y() || r.hi.z() <= r.lo.z() ) {
+      continue;
+    }
+    r.sums = &buffer[ layout.sumOffset[ field.accumulators[a] ] ];
+    r.maxs = &buffer[ layout.maxOffset[ field.accumulators[a] ] ];
+    for( unsigned h = 0; h < acc.histograms.size(); h++ ) {
+      r.hists.push_back( &d_histograms[ acc.histograms[h] ] );
+    }
+    ranges.push_back( r );
+  }
+
+  if( ranges.empty() ) {
+    return;
+  }
+
+  for( int k = low.z(); k < high.z(); k++ ) {
+    for( int j = low.y(); j < high.y(); j++ ) {
+      for( int i = low.x(); i < high.x(); i++ ) {
+        const IntVector c( i, j, k );
+        const Ttype q = Q_var[c];
+
+        for( unsigned a = 0; a < ranges.size(); a++ ) {
+          const Range& r = ranges[a];
+          if( i < r.lo.x() || i >= r.hi.x() ||
+              j < r.lo.y() || j >= r.hi.y() ||
+              k < r.lo.z() || k >= r.hi.z() ) {
+            continue;
+          }
+
+          // layout: count, sum[nc], sumSq[nc], histograms; max[nc], -min[nc]
+          r.sums[0] += 1.0;
+          double* bins = r.sums + 1 + 2 * nc;
+
+          for( int d = 0; d < nc; d++ ) {
+            const double v = component( q, d );
+            r.sums[1 + d]      += v;
+            r.sums[1 + nc + d] += v * v;
+            r.maxs[d]           = max( r.maxs[d],  v );
+            r.maxs[nc + d]      = max( r.maxs[nc + d], -v );
+          }
+
+          for( unsigned h = 0; h < r.hists.size(); h++ ) {
+            const HistogramSpec* hist = r.hists[h];
+            const double scale = hist->nBins / ( hist->binMax - hist->binMin );
+            for( int d = 0; d < nc; d++ ) {
+              const double x = ( component( q, d ) - hist->binMin ) * scale;
+              const int    b = !( x >= 0 ) ? 0 : ( x >= hist->nBins ? hist->nBins - 1 : (int)x );
+              bins[ d * hist->nBins + b ] += 1.0;
+            }
+            bins += nc * hist->nBins;
+          }
+        }
+      }
+    }
+  }
+}
+
+//______________________________________________________________________
+//  One packed allreduce of everything due on this level, then the
+//  results of the requests that are due.
+void
+StatisticsEngine::reduce( const ProcessorGroup* pg,
+                          const PatchSubset*,
+                          const MaterialSubset*,
+                          DataWarehouse* old_dw,
+                          DataWarehouse* new_dw,
+                          const int L_indx )
+{
+  const Level* level = new_dw->getGrid()->getLevel( L_indx ).get_rep();
+  const double now   = d_dataArchiver->getCurrentTime();
+
+  // also on ranks without patches on this level
+  seedLastSamples( old_dw, L_indx );
+
+  LevelLayout& layout = d_layouts[L_indx];
+
+  // every rank makes the same decision
+  bool anyDue = false;
+  for( unsigned f = 0; f < layout.fields.size(); f++ ) {
+    anyDue = anyDue || isFieldDue( layout.fields[f], L_indx, now );
+  }
+
+  if( anyDue ) {
+    cout_doing << pg->myrank() << " Doing StatisticsEngine::reduce on level " << L_indx << endl;
+
+    const int n = 2 + layout.nSums + layout.nMaxs;
+    vector<double> sendbuf( n );
+    vector<double> recvbuf( n );
+    sendbuf[0] = layout.nSums;
+    sendbuf[1] = layout.nMaxs;
+    copy( layout.partial.begin(), layout.partial.end(), sendbuf.begin() + 2 );
+
+    if( pg->size() > 1 ) {
+      MPI_Datatype datatype;
+      Uintah::MPI::Type_contiguous( n, MPI_DOUBLE, &datatype );
+      Uintah::MPI::Type_commit( &datatype );
+
+      int error = Uintah::MPI::Allreduce( &sendbuf[0], &recvbuf[0], 1, datatype, statisticsOp(), pg->getComm() );
+      Uintah::MPI::Type_free( &datatype );
+      if( error ) {
+        throw InternalError( "StatisticsEngine: MPI error", __FILE__, __LINE__ );
+      }
+    } else {
+      recvbuf = sendbuf;
+    }
+
+    const double* global = &recvbuf[2];
+
+    //__________________________________
+    //  the results of the requests that are due
+    for( unsigned f = 0; f < layout.fields.size(); f++ ) {
+      const Field& field = d_fields[ layout.fields[f] ];
+      const int nc = field.nComponents;
+
+      for( unsigned a = 0; a < field.accumulators.size(); a++ ) {
+        const int accIndx = field.accumulators[a];
+        const Accumulator& acc = d_accumulators[accIndx];
+        const double* sums = global + layout.sumOffset[accIndx];
+        const double* maxs = global + layout.maxOffset[accIndx];
+
+        for( unsigned r = 0; r < acc.requests.size(); r++ ) {
+          const int handle = acc.requests[r];
+          const Request& req = d_requests[handle];
+          if( !isRightLevel( req.level, L_indx, level->getGrid()->numLevels() ) || !isDue( handle, L_indx, now ) ) {
+            continue;
+          }
+
+          const pair<int, int> key( handle, L_indx );
+          map<pair<int, int>, Result>::iterator iter = d_results.find( key );
+          const bool first = ( iter == d_results.end() );
+          Result& result = d_results[key];
+          const double dt = first ? 0.0 : now - result.time;
+
+          result.time        = now;
+          result.count       = sums[0];
+          result.nComponents = nc;
+          if( first ) {
+            result.timeWeight = 0.0;
+          }
+
+          for( int d = 0; d < nc; d++ ) {
+            const double count = max( sums[0], 1.0 );
+            const double mean  = sums[1 + d] / count;
+
+            result.max[d]      = maxs[d];
+            result.min[d]      = -maxs[nc + d];
+            result.mean[d]     = mean;
+            result.variance[d] = max( 0.0, sums[1 + nc + d] / count - mean * mean );
+
+            // time average of the mean
+            if( first || result.timeWeight + dt <= 0.0 ) {
+              result.timeAverage[d] = mean;
+            } else {
+              result.timeAverage[d] = ( result.timeAverage[d] * result.timeWeight + mean * dt ) / ( result.timeWeight + dt );
+            }
+          }
+          result.timeWeight += dt;
+
+          result.histogram.clear();
+          if( req.statistics & Histogram ) {
+            const double* bins = sums + 1 + 2 * nc;
+            for( unsigned h = 0; h < acc.histograms.size(); h++ ) {
+              const HistogramSpec& hist = d_histograms[ acc.histograms[h] ];
+              if( hist.nBins == req.nBins && hist.binMin == req.binMin && hist.binMax == req.binMax ) {
+                result.histogram.assign( bins, bins + nc * hist.nBins );
+              }
+              bins += nc * hist.nBins;
+            }
+          }
+
+          d_lastSample[key] = now;
+        }
+      }
+    }
+  }
+
+  initPartial( layout, layout.partial );
+
+  new_dw->put( SoleVariable<double>( now ), d_statisticsLabel, level );
+}
+
+//______________________________________________________________________
+//
+const StatisticsEngine::Result&
+StatisticsEngine::getResult( const int handle,
+                             const int L_indx ) const
+{
+  map<pair<int, int>, Result>::const_iterator iter = d_results.find( make_pair( handle, L_indx ) );
+  if( iter == d_results.end() ) {
+    static Result none = [] {
+      Result me;
+      me.time        = -DBL_MAX;
+      me.count       = 0;
+      me.nComponents = 0;
+      me.timeWeight  = 0;
+      return me;
+    }();
+    return none;
+  }
+  return iter->second;
+}
+
+//______________________________________________________________________
+//
+bool
+StatisticsEngine::isCurrent( const int handle,
+                             const int L_indx,
+                             const double now ) const
+{
+  return getResult( handle, L_indx ).time == now;
+}
@@ -0,0 +1,301 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+
+#ifndef Packages_Uintah_CCA_Components_ontheflyAnalysis_StatisticsEngine_h
+#define Packages_Uintah_CCA_Components_ontheflyAnalysis_StatisticsEngine_h
+
+#include <CCA/Ports/Output.h>
+#include <CCA/Ports/SchedulerP.h>
+#include <Core/Grid/Box.h>
+#include <Core/Grid/LevelP.h>
+#include <Core/Grid/SimulationStateP.h>
+#include <Core/Grid/Task.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace Uintah {
+
+  class AnalysisModule;
+  class DataWarehouse;
+  class ProcessorGroup;
+
+/**************************************
+
+CLASS
+   StatisticsEngine
+
+GENERAL INFORMATION
+
+   StatisticsEngine.h
+
+   Department of Mechanical Engineering
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+KEYWORDS
+   MinMax, Statistics, Histogram, Reduction
+
+DESCRIPTION
+   In-situ statistics shared by the analysis modules of a simulation.
+   A module registers requests during problemSetup:
+
+     StatisticsEngine::Request req( label, matl, level );
+     req.statistics = StatisticsEngine::Min | StatisticsEngine::Max;
+     int handle = d_engine->request( req );
+
+   for the min, max, mean, variance, histogram and time average of a
+   CC or NC double or Vector, or an SFC[XYZ] double, over the whole
+   level or over a region.  Vectors are reduced component by component.
+
+   All requests on the same (label, matl) share one pass over each
+   patch, requests that also share the region share the accumulators,
+   and everything due on a level is reduced with a single allreduce
+   of one packed buffer.  Per level the engine schedules
+
+     - StatisticsEngine::accumulate (each patch): the pass over the
+       patch data, merged into the accumulators of this rank
+     - StatisticsEngine::reduce (once per proc): the allreduce, after
+       which every rank holds the results.  It computes the
+       SoleVariable getStatisticsLabel(), which tasks reading the
+       results on that level must require.
+
+   Statistics are only computed when at least one of the requests on
+   a variable is due (samplingFrequency, startTime, stopTime).  A
+   module calls scheduleStatistics() from scheduleDoAnalysis(); only
+   the first module that acquired the engine actually schedules it.
+
+WARNING
+   The variance is computed from the sums of the values and of their
+   squares.  Values outside [binMin, binMax] are counted in the first
+   and last histogram bins.  The time averages are not checkpointed;
+   they restart with the run.  The sampling times are not either, but a
+   request may name the module's checkpointed max_vartype holding the
+   time of its last sample (lastSampleLabel), from which the engine
+   picks up the cadence after a restart.
+
+****************************************/
+
+  class StatisticsEngine {
+  public:
+
+    enum Statistic {
+      Min         = 1,
+      Max         = 2,
+      Mean        = 4,
+      Variance    = 8,
+      Histogram   = 16,
+      TimeAverage = 32
+    };
+
+    // same convention as the analysis modules
+    enum {
+      allLevels   = 99,
+      finestLevel = -1
+    };
+
+    struct Request {
+      Request( const VarLabel* label, const int matl, const int level );
+
+      const VarLabel* label;
+      int    matl;
+      int    level;               // level index, allLevels or finestLevel
+      int    statistics;          // bitwise or of Statistic
+
+      bool   hasRegion;           // default: the whole level
+      Box    region;
+
+      int    nBins;               // Histogram
+      double binMin;
+      double binMax;
+
+      double samplingFrequency;   // 0: every timestep
+      double startTime;
+      double stopTime;
+
+      const VarLabel* lastSampleLabel;  // optional: old_dw max_vartype, time of the last sample
+    };
+
+    struct Result {
+      double time;                // time of the last sample, -DBL_MAX if none
+      double count;               // number of cells, nodes or faces
+      int    nComponents;         // 1 (double) or 3 (Vector)
+      double min[3];
+      double max[3];
+      double mean[3];
+      double variance[3];
+      double timeAverage[3];      // time average of the mean
+      std::vector<double> histogram;  // nComponents x nBins
+
+      double timeWeight;          // sum of the sampling intervals
+    };
+
+    // Returns the engine shared by the modules of the simulation.  Each
+    // acquire() must be matched by a release().
+    static StatisticsEngine* acquire( SimulationStateP& sharedState,
+                                      Output* dataArchiver,
+                                      const AnalysisModule* module );
+
+    static void release( StatisticsEngine* engine );
+
+    // Registers a request; returns its handle.
+    int request( const Request& req );
+
+    void scheduleStatistics( SchedulerP& sched,
+                             const LevelP& level,
+                             const AnalysisModule* module );
+
+    const VarLabel* getStatisticsLabel() const { return d_statisticsLabel; }
+
+    // The latest result of a request on a level.
+    const Result& getResult( const int handle,
+                             const int L_indx ) const;
+
+    // true if the request was sampled at time "now" on that level
+    bool isCurrent( const int handle,
+                    const int L_indx,
+                    const double now ) const;
+
+  private:
+
+    StatisticsEngine( SimulationStateP& sharedState,
+                      Output* dataArchiver,
+                      const AnalysisModule* owner );
+
+    ~StatisticsEngine();
+
+    StatisticsEngine( const StatisticsEngine& );
+    StatisticsEngine& operator=( const StatisticsEngine& );
+
+    // requests on one (label, matl) and region share the moments
+    struct Accumulator {
+      int    field;
+      bool   hasRegion;
+      Box    region;
+      std::vector<int> histograms;
+      std::vector<int> requests;
+    };
+
+    struct HistogramSpec {
+      int    nBins;
+      double binMin;
+      double binMax;
+    };
+
+    // one (label, matl): one pass per patch
+    struct Field {
+      const VarLabel* label;
+      int    matl;
+      int    nComponents;
+      std::vector<int> accumulators;
+      std::vector<int> requests;
+    };
+
+    // the packed buffer of a level: the sums (count, sum, sum of squares,
+    // histogram bins), then the maxima (max, -min)
+    struct LevelLayout {
+      std::vector<int> fields;
+      std::vector<int> sumOffset;     // per accumulator, -1 if not on this level
+      std::vector<int> maxOffset;
+      int nSums;
+      int nMaxs;
+
+      std::vector<double> partial;    // this rank
+    };
+
+    bool isRightLevel( const int myLevel,
+                       const int L_indx,
+                       const int numLevels ) const;
+
+    bool isDue( const int request,
+                const int L_indx,
+                const double now ) const;
+
+    bool isFieldDue( const int field,
+                     const int L_indx,
+                     const double now ) const;
+
+    void buildLayout( const LevelP& level );
+
+    void seedLastSamples( DataWarehouse* old_dw,
+                          const int L_indx );
+
+    void initPartial( const LevelLayout& layout,
+                      std::vector<double>& buffer ) const;
+
+    void accumulate( const ProcessorGroup* pg,
+                     const PatchSubset* patches,
+                     const MaterialSubset*,
+                     DataWarehouse* old_dw,
+                     DataWarehouse* new_dw );
+
+    void reduce( const ProcessorGroup* pg,
+                 const PatchSubset* patches,
+                 const MaterialSubset*,
+                 DataWarehouse* old_dw,
+                 DataWarehouse* new_dw,
+                 const int L_indx );
+
+    template <class Tvar, class Ttype>
+    void accumulateField( DataWarehouse* new_dw,
+                          const Field& field,
+                          const Patch* patch,
+                          const IntVector& low,
+                          const IntVector& high,
+                          const IntVector& stagger,
+                          const LevelLayout& layout,
+                          std::vector<double>& buffer );
+
+    SimulationStateP d_sharedState;
+    Output*          d_dataArchiver;
+    const AnalysisModule* d_owner;
+    int              d_refCount;
+
+    std::vector<Request>       d_requests;
+    std::vector<Field>         d_fields;
+    std::vector<Accumulator>   d_accumulators;
+    std::vector<HistogramSpec> d_histograms;
+
+    std::map<int, LevelLayout> d_layouts;           // key: level index
+    std::map<std::pair<int, int>, Result> d_results;  // key: (request, level index)
+    std::map<std::pair<int, int>, double> d_lastSample;
+
+    VarLabel*       d_statisticsLabel;
+    VarLabel*       d_accumulatedLabel;
+    MaterialSet*    d_matl_set;
+    MaterialSet*    d_zero_matl_set;
+    MaterialSubset* d_zero_matl;
+
+    std::mutex      d_mutex;
+
+    static std::map<const SimulationState*, StatisticsEngine*> s_engines;
+  };
+}
+
+#endif
@@ -91,6 +91,7 @@ containerExtract::containerExtract(ProblemSpecP& module_spec,
   d_dataArchiver = dataArchiver;
   d_matl_set = 0;
   ps_lb = scinew containerExtractLabel();
+  d_writer = scinew AnalysisWriter("containerExtract", dataArchiver);
 }
 
 //__________________________________
@@ -102,6 +103,7 @@ containerExtract::~containerExtract()
   }
   VarLabel::destroy(ps_lb->lastWriteTimeLabel);
   delete ps_lb;
+  delete d_writer;
   
 
   //delete the container cell list
@@ -341,6 +343,10 @@ void containerExtract::problemSetup(const ProblemSpecP& prob_spec,
     d_containers.push_back(c);
 
   } //foreach container
+  
+  //__________________________________
+  //  Binary output
+  d_writer->problemSetup(d_prob_spec);
 }
 
 //______________________________________________________________________
@@ -564,6 +570,10 @@ void containerExtract::initialize(const ProcessorGroup*,
    ******************/
 
   // create the directory structure
+  if(d_writer->isBinary()){
+    return;
+  }
+  
   for(unsigned int i = 0; i < d_containers.size(); i++) {
     container* cnt = d_containers[i];
     string udaDir = d_dataArchiver->getOutputLocation();
@@ -757,6 +767,8 @@ void containerExtract::doAnalysis(const ProcessorGroup* pg,
         }
       }            
 
+      map<const VarLabel*, int> layouts;    // binary output
+
       for (unsigned int i = 0; i < d_containers.size(); i++) {
         container* cnt = d_containers[i];
 
@@ -780,6 +792,62 @@ void containerExtract::doAnalysis(const ProcessorGroup* pg,
           fname<<path<<*exc;
           string filename = fname.str();
           //cout_dbg << "Fname: "<<filename<<endl;
+          
+          //__________________________________
+          //  Binary output: buffer the record, in the order of fileColumns()
+          if( d_writer->isBinary() ){
+            if( layouts.count(exc->vl) == 0 ){
+              layouts[exc->vl] = d_writer->defineLayout(fileHeader(exc->vl), fileColumns(exc->vl));
+            }
+            ostringstream sname;
+            sname<<cnt->name<<"/"<<levelNum<<"/"<<*exc;
+            int stream = d_writer->openStream(sname.str(), layouts[exc->vl]);
+            
+            Point here = patch->cellPosition(c);
+            vector<double> record;
+            record.push_back(here.x());
+            record.push_back(here.y());
+            record.push_back(here.z());
+            record.push_back(d_dataArchiver->getCurrentTime());
+            
+            // the label names are unique, whatever the variable type
+            const string& name = exc->vl->getName();
+            for (unsigned int i = 0; i < CC_double_data.size(); i++){
+              if (name == ccd_var_labels[i]->getName()){
+                record.push_back(CC_double_data[i][c]);
+              }
+            }
+            for (unsigned int i = 0; i < CC_Vector_data.size(); i++){
+              if (name == ccv_var_labels[i]->getName()){
+                record.push_back(CC_Vector_data[i][c].x());
+                record.push_back(CC_Vector_data[i][c].y());
+                record.push_back(CC_Vector_data[i][c].z());
+              }
+            }
+            for (unsigned int i = 0; i < CC_integer_data.size(); i++){
+              if (name == cci_var_labels[i]->getName()){
+                record.push_back(CC_integer_data[i][c]);
+              }
+            }
+            for (unsigned int i = 0; i < SFCX_double_data.size(); i++){
+              if (name == sfcx_var_labels[i]->getName()){
+                record.push_back(SFCX_double_data[i][c]);
+              }
+            }
+            for (unsigned int i = 0; i < SFCY_double_data.size(); i++){
+              if (name == sfcy_var_labels[i]->getName()){
+                record.push_back(SFCY_double_data[i][c]);
+              }
+            }
+            for (unsigned int i = 0; i < SFCZ_double_data.size(); i++){
+              if (name == sfcz_var_labels[i]->getName()){
+                record.push_back(SFCZ_double_data[i][c]);
+              }
+            }
+            d_writer->write(stream, record);
+            continue;
+          }
+          
           //create file and write the file header  
           ifstream test(filename.c_str());
           if (!test){
@@ -864,15 +932,44 @@ void containerExtract::createFile(string& filename, extractCell& exc)
 { 
   FILE *fp;
   fp = fopen(filename.c_str(), "w");
-  fprintf(fp,"X_CC      Y_CC      Z_CC      Time"); 
-
-  fprintf(fp,"    %s", exc.vl->getName().c_str());
-  
-  fprintf(fp,"\n");
+  fprintf(fp,"%s", fileHeader(exc.vl).c_str());
   fclose(fp);
   cout << Parallel::getMPIRank() << " containerExtract:Created file " << filename << endl;
 }
 //______________________________________________________________________
+//  The file header
+string containerExtract::fileHeader(const VarLabel* vl)
+{
+  return "X_CC      Y_CC      Z_CC      Time    " + vl->getName() + "\n";
+}
+//______________________________________________________________________
+//  The column formats of a line of the file, for the binary output.
+//  These must match the fprintf's in doAnalysis.
+vector<AnalysisWriter::Column> containerExtract::fileColumns(const VarLabel* vl)
+{
+  vector<AnalysisWriter::Column> columns;
+  columns.push_back(AnalysisWriter::Column('d', "%E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  
+  const Uintah::TypeDescription* td = vl->typeDescription();
+  const Uintah::TypeDescription* subtype = td->getSubType();
+
+  if(td->getType() == Uintah::TypeDescription::CCVariable &&
+     subtype->getType() == Uintah::TypeDescription::int_type){
+    columns.push_back(AnalysisWriter::Column('i', "    %16i"));
+  } else if(td->getType() == Uintah::TypeDescription::CCVariable &&
+            subtype->getType() == Uintah::TypeDescription::Vector){
+    for (int d = 0; d < 3; d++){
+      columns.push_back(AnalysisWriter::Column('d', "    %16E"));
+    }
+  } else {
+    columns.push_back(AnalysisWriter::Column('d', "    %16E"));
+  }
+  return columns;
+}
+//______________________________________________________________________
 // create the directory structure   lineName/LevelIndex
 //
 void
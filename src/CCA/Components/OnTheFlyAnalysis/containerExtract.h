@@ -25,6 +25,7 @@
 #ifndef Packages_Uintah_CCA_Components_ontheflyAnalysis_containerExtract_h
 #define Packages_Uintah_CCA_Components_ontheflyAnalysis_containerExtract_h
 #include <CCA/Components/OnTheFlyAnalysis/AnalysisModule.h>
+#include <CCA/Components/OnTheFlyAnalysis/AnalysisWriter.h>
 #include <CCA/Ports/Output.h>
 #include <Core/GeometryPiece/GeometryPiece.h>
 #include <Core/Grid/GridP.h>
@@ -146,6 +147,7 @@ namespace Uintah {
       ProblemSpecP d_prob_spec;
       const Material* d_matl;
       MaterialSet* d_matl_set;
+      AnalysisWriter* d_writer;           // binary output
 
       void initialize(const ProcessorGroup*, 
           const PatchSubset* patches,
@@ -161,6 +163,10 @@ namespace Uintah {
 
       void createFile(std::string& filename, extractCell& e);
 
+      std::string fileHeader(const VarLabel* vl);
+
+      std::vector<AnalysisWriter::Column> fileColumns(const VarLabel* vl);
+
       void createDirectory(std::string& lineName, std::string& levelIndex);
 
 
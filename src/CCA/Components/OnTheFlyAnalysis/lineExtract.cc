@@ -71,6 +71,8 @@ lineExtract::lineExtract(ProblemSpecP& module_spec,
   d_matl_set = 0;
   d_zero_matl = 0;
   ps_lb = scinew lineExtractLabel();
+  d_writer = scinew AnalysisWriter("lineExtract", dataArchiver);
+  d_layout = -1;
 }
 
 //__________________________________
@@ -87,6 +89,7 @@ lineExtract::~lineExtract()
   VarLabel::destroy(ps_lb->lastWriteTimeLabel);
   VarLabel::destroy(ps_lb->fileVarsStructLabel);
   delete ps_lb;
+  delete d_writer;
   
   // delete each line
   vector<line*>::iterator iter;
@@ -334,6 +337,13 @@ void lineExtract::problemSetup(const ProblemSpecP& prob_spec,
     l->stepSize = stepSize;
     d_lines.push_back(l);
   }
+  
+  //__________________________________
+  //  Binary output
+  d_writer->problemSetup(d_prob_spec);
+  if(d_writer->isBinary()){
+    d_layout = d_writer->defineLayout(fileHeader(), fileColumns());
+  }
 }
 
 //______________________________________________________________________
@@ -586,7 +596,7 @@ void lineExtract::doAnalysis(const ProcessorGroup* pg,
         string levelIndex = li.str();
         string path = linePath + "/" + levelIndex;
         
-        if( d_isDirCreated.count(path) == 0){
+        if( !d_writer->isBinary() && d_isDirCreated.count(path) == 0){
           createDirectory(linePath, levelIndex);
           d_isDirCreated.insert(path);
         }
@@ -632,6 +642,45 @@ void lineExtract::doAnalysis(const ProcessorGroup* pg,
             continue;  // just in case - the point-to-cell logic might throw us off on patch boundaries...
             
           IntVector c = *iter;
+          
+          //__________________________________
+          //  Binary output: buffer the record, in the order of fileColumns()
+          if( d_writer->isBinary() ){
+            ostringstream sname;
+            sname<<dirName<<"/"<<levelIndex<<"/i"<< c.x() << "_j" << c.y() << "_k"<< c.z();
+            int stream = d_writer->openStream(sname.str(), d_layout);
+            
+            Point here = patch->cellPosition(c);
+            vector<double> record;
+            record.push_back(here.x());
+            record.push_back(here.y());
+            record.push_back(here.z());
+            record.push_back(d_dataArchiver->getCurrentTime());
+            
+            for (unsigned int i=0 ; i <  CC_integer_data.size(); i++) {
+              record.push_back(CC_integer_data[i][c]);
+            }
+            for (unsigned int i=0 ; i <  CC_double_data.size(); i++) {
+              record.push_back(CC_double_data[i][c]);
+            }
+            for (unsigned int i=0 ; i <  CC_Vector_data.size(); i++) {
+              record.push_back(CC_Vector_data[i][c].x());
+              record.push_back(CC_Vector_data[i][c].y());
+              record.push_back(CC_Vector_data[i][c].z());
+            }
+            for (unsigned int i=0 ; i <  SFCX_double_data.size(); i++) {
+              record.push_back(SFCX_double_data[i][c]);
+            }
+            for (unsigned int i=0 ; i <  SFCY_double_data.size(); i++) {
+              record.push_back(SFCY_double_data[i][c]);
+            }
+            for (unsigned int i=0 ; i <  SFCZ_double_data.size(); i++) {
+              record.push_back(SFCZ_double_data[i][c]);
+            }
+            d_writer->write(stream, record);
+            continue;
+          }
+          
           ostringstream fname;
           fname<<path<<"/i"<< c.x() << "_j" << c.y() << "_k"<< c.z();
           string filename = fname.str();
@@ -718,80 +767,92 @@ void lineExtract::createFile(string& filename,  FILE*& fp)
   }
   
   fp = fopen(filename.c_str(), "w");
-  fprintf(fp,"# X_CC      Y_CC      Z_CC      Time"); 
+  fprintf(fp,"%s", fileHeader().c_str());
+  fflush(fp);
   
-  // All CCVariable<int>
-  for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const Uintah::TypeDescription* td = d_varLabels[i]->typeDescription();
-    const Uintah::TypeDescription* subtype = td->getSubType();
-
-    if(td->getType()      == TypeDescription::CCVariable && 
-       subtype->getType() == TypeDescription::int_type){
+  cout << Parallel::getMPIRank() << " lineExtract:Created file " << filename << endl;
+}
+//______________________________________________________________________
+//  The file header.  The variables are in the order they are written out
+string lineExtract::fileHeader()
+{
+  ostringstream header;
+  header << "# X_CC      Y_CC      Z_CC      Time";
+  
+  const TypeDescription::Type types[6][2] = { {TypeDescription::CCVariable,   TypeDescription::int_type},
+                                              {TypeDescription::CCVariable,   TypeDescription::double_type},
+                                              {TypeDescription::CCVariable,   TypeDescription::Vector},
+                                              {TypeDescription::SFCXVariable, TypeDescription::double_type},
+                                              {TypeDescription::SFCYVariable, TypeDescription::double_type},
+                                              {TypeDescription::SFCZVariable, TypeDescription::double_type} };
+  for (int t = 0; t < 6; t++) {
+    for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
+      const Uintah::TypeDescription* td = d_varLabels[i]->typeDescription();
+      const Uintah::TypeDescription* subtype = td->getSubType();
+
+      if(td->getType() != types[t][0] || subtype->getType() != types[t][1]){
+        continue;
+      }
       string name = d_varLabels[i]->getName();
-      fprintf(fp,"     %s(%i)", name.c_str(),d_varMatl[i]);
+      int m = d_varMatl[i];
+      
+      if(types[t][0] != TypeDescription::CCVariable){
+        header << "     " << name;
+      } else if(types[t][1] == TypeDescription::Vector){
+        header << "     " << name << "(" << m << ").x      " << name << "(" << m << ").y      " << name << "(" << m << ").z";
+      } else {
+        header << "     " << name << "(" << m << ")";
+      }
     }
   }
-  // All CCVariable<double>
-  for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const Uintah::TypeDescription* td = d_varLabels[i]->typeDescription();
-    const Uintah::TypeDescription* subtype = td->getSubType();
+  header << "\n";
+  return header.str();
+}
 
-    if(td->getType()      == TypeDescription::CCVariable && 
-       subtype->getType() == TypeDescription::double_type){
-      string name = d_varLabels[i]->getName();
-      fprintf(fp,"     %s(%i)", name.c_str(),d_varMatl[i]);
-    }
-  }
-  // All CCVariable<Vector>
+//______________________________________________________________________
+//  The column formats of a line of the file, for the binary output.
+//  These must match the fprintf's in doAnalysis.
+vector<AnalysisWriter::Column> lineExtract::fileColumns()
+{
+  vector<AnalysisWriter::Column> columns;
+  columns.push_back(AnalysisWriter::Column('d', "%E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  
+  int nInt = 0, nDouble = 0, nVector = 0, nFC = 0;
   for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
     const Uintah::TypeDescription* td = d_varLabels[i]->typeDescription();
     const Uintah::TypeDescription* subtype = td->getSubType();
-
-    if(td->getType()      == TypeDescription::CCVariable && 
-       subtype->getType() == TypeDescription::Vector){
-      string name = d_varLabels[i]->getName(); 
-      int m = d_varMatl[i];
-      fprintf(fp,"     %s(%i).x      %s(%i).y      %s(%i).z", name.c_str(),m,name.c_str(),m,name.c_str(),m);
+    
+    if(td->getType() != TypeDescription::CCVariable){
+      nFC++;
+    } else if(subtype->getType() == TypeDescription::int_type){
+      nInt++;
+    } else if(subtype->getType() == TypeDescription::double_type){
+      nDouble++;
+    } else {
+      nVector++;
     }
   }
-  // All SFCXVariable<double>
-  for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const Uintah::TypeDescription* td = d_varLabels[i]->typeDescription();
-    const Uintah::TypeDescription* subtype = td->getSubType();
-
-    if(td->getType()      == TypeDescription::SFCXVariable && 
-       subtype->getType() == TypeDescription::double_type){
-      string name = d_varLabels[i]->getName();
-      fprintf(fp,"     %s", name.c_str());
-    }
+  
+  for (int i = 0; i < nInt; i++) {
+    columns.push_back(AnalysisWriter::Column('i', "    %i"));
   }
-  // All SFCYVariable<double>
-  for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const Uintah::TypeDescription* td = d_varLabels[i]->typeDescription();
-    const Uintah::TypeDescription* subtype = td->getSubType();
-
-    if(td->getType()      == TypeDescription::SFCYVariable && 
-       subtype->getType() == TypeDescription::double_type){
-      string name = d_varLabels[i]->getName();
-      fprintf(fp,"     %s", name.c_str());
-    }
+  for (int i = 0; i < nDouble; i++) {
+    columns.push_back(AnalysisWriter::Column('d', "    %16E"));
   }
-  // All SFCZVariable<double>
-  for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const Uintah::TypeDescription* td = d_varLabels[i]->typeDescription();
-    const Uintah::TypeDescription* subtype = td->getSubType();
-
-    if(td->getType()      == TypeDescription::SFCZVariable && 
-       subtype->getType() == TypeDescription::double_type){
-      string name = d_varLabels[i]->getName();
-      fprintf(fp,"     %s", name.c_str());
-    }
+  for (int i = 0; i < nVector; i++) {
+    columns.push_back(AnalysisWriter::Column('d', "    % 16E"));
+    columns.push_back(AnalysisWriter::Column('d', "      %16E"));
+    columns.push_back(AnalysisWriter::Column('d', "      %16E"));
   }
-  fprintf(fp,"\n");
-  fflush(fp);
-  
-  cout << Parallel::getMPIRank() << " lineExtract:Created file " << filename << endl;
+  for (int i = 0; i < nFC; i++) {     // SFCX, SFCY and SFCZ
+    columns.push_back(AnalysisWriter::Column('d', "    %16E"));
+  }
+  return columns;
 }
+
 //______________________________________________________________________
 // create the directory structure   lineName/LevelIndex
 //
@@ -26,6 +26,7 @@
 #ifndef Packages_Uintah_CCA_Components_ontheflyAnalysis_lineExtract_h
 #define Packages_Uintah_CCA_Components_ontheflyAnalysis_lineExtract_h
 #include <CCA/Components/OnTheFlyAnalysis/AnalysisModule.h>
+#include <CCA/Components/OnTheFlyAnalysis/AnalysisWriter.h>
 #include <CCA/Ports/Output.h>
 #include <Core/Grid/Variables/VarTypes.h>
 #include <Core/Grid/Variables/CCVariable.h>
@@ -109,6 +110,10 @@ WARNING
                     
     void createFile(std::string& filename, FILE*& fp);
     
+    std::string fileHeader();
+    
+    std::vector<AnalysisWriter::Column> fileColumns();
+    
     void createDirectory(std::string& lineName, std::string& levelIndex);
                     
     
@@ -146,6 +151,9 @@ WARNING
     MaterialSet* d_matl_set;
     std::set<std::string> d_isDirCreated;
     
+    AnalysisWriter* d_writer;           // binary output
+    int d_layout;
+    
     MaterialSubset* d_zero_matl;
     
   
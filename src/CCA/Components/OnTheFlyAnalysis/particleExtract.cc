@@ -68,6 +68,8 @@ particleExtract::particleExtract(ProblemSpecP& module_spec,
   d_matl_set = 0;
   ps_lb = scinew particleExtractLabel();
   M_lb = scinew MPMLabel();
+  d_writer = scinew AnalysisWriter("particleExtract", dataArchiver);
+  d_layout = -1;
 }
 
 //__________________________________
@@ -83,6 +85,7 @@ particleExtract::~particleExtract()
   VarLabel::destroy(ps_lb->filePointerLabel_preReloc);
   delete ps_lb;
   delete M_lb;
+  delete d_writer;
 }
 
 //______________________________________________________________________
@@ -180,6 +183,14 @@ void particleExtract::problemSetup(const ProblemSpecP& prob_spec,
   sharedState->d_particleState_preReloc[matl].push_back(ps_lb->filePointerLabel_preReloc);
   sharedState->d_particleState[matl].push_back(ps_lb->filePointerLabel);
   
+  //__________________________________
+  //  Binary output
+  d_writer->problemSetup(d_prob_spec);
+  if(d_writer->isBinary()){
+    d_layout = d_writer->defineLayout(fileHeader(), fileColumns());
+    return;
+  }
+  
   //__________________________________
   //  Warning
   proc0cout << "\n\n______________________________________________________________________" << endl;
@@ -498,7 +509,7 @@ void particleExtract::doAnalysis(const ProcessorGroup* pg,
       string levelIndex = li.str();
       string path = pPath + "/" + levelIndex;
       
-      if( d_isDirCreated.count(path) == 0){
+      if( !d_writer->isBinary() && d_isDirCreated.count(path) == 0){
         createDirectory(pPath, levelIndex);
         d_isDirCreated.insert(path);
       }
@@ -511,6 +522,41 @@ void particleExtract::doAnalysis(const ProcessorGroup* pg,
 
         if (pColor[idx] > d_colorThreshold){
         
+          //__________________________________
+          //  Binary output: buffer the record, in the order of fileColumns()
+          if( d_writer->isBinary() ){
+            ostringstream sname;
+            sname<<"particleExtract/"<<levelIndex<<"/"<<pid[idx];
+            int stream = d_writer->openStream(sname.str(), d_layout);
+            
+            vector<double> record;
+            record.push_back(d_dataArchiver->getCurrentTime());
+            record.push_back(px[idx].x());
+            record.push_back(px[idx].y());
+            record.push_back(px[idx].z());
+            
+            for (unsigned int i=0 ; i <  integer_data.size(); i++) {
+              record.push_back(integer_data[i][idx]);
+            }
+            for (unsigned int i=0 ; i <  double_data.size(); i++) {
+              record.push_back(double_data[i][idx]);
+            }
+            for (unsigned int i=0 ; i <  Vector_data.size(); i++) {
+              record.push_back(Vector_data[i][idx].x());
+              record.push_back(Vector_data[i][idx].y());
+              record.push_back(Vector_data[i][idx].z());
+            }
+            for (unsigned int i=0 ; i <  Matrix3_data.size(); i++) {
+              for (int row = 0; row<3; row++){
+                for (int col = 0; col<3; col++){
+                  record.push_back(Matrix3_data[i][idx](row,col));
+                }
+              }
+            }
+            d_writer->write(stream, record);
+            continue;
+          }
+        
           ostringstream fname;
           fname<<path<<"/"<<pid[idx];
           string filename = fname.str();
@@ -598,55 +644,84 @@ void particleExtract::createFile(string& filename, FILE*& fp)
   }
   
   fp = fopen(filename.c_str(), "w");
-  fprintf(fp,"# Time    X      Y      Z     "); 
-  
-  // All ParticleVariable<int>
-  for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const TypeDescription* td = d_varLabels[i]->typeDescription();
-    const TypeDescription* subtype = td->getSubType();
+  fprintf(fp,"%s", fileHeader().c_str());
+  fflush(fp);
 
-    if(subtype->getType() == TypeDescription::int_type){
+  cout << Parallel::getMPIRank() << " particleExtract:Created file " << filename << endl;
+}
+//______________________________________________________________________
+//  The file header.  The variables are in the order they are written out
+string particleExtract::fileHeader()
+{
+  ostringstream header;
+  header << "# Time    X      Y      Z     ";
+  
+  const TypeDescription::Type types[4] = { TypeDescription::int_type,
+                                           TypeDescription::double_type,
+                                           TypeDescription::Vector,
+                                           TypeDescription::Matrix3 };
+  for (int t = 0; t < 4; t++) {
+    for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
+      const TypeDescription* subtype = d_varLabels[i]->typeDescription()->getSubType();
+      
+      if(subtype->getType() != types[t]){
+        continue;
+      }
       string name = d_varLabels[i]->getName();
-      fprintf(fp,"     %s", name.c_str());
+      
+      if(types[t] == TypeDescription::Vector){
+        header << "     " << name << ".x      " << name << ".y      " << name << ".z";
+      } else if(types[t] == TypeDescription::Matrix3){
+        for (int row = 0; row<3; row++){
+          header << "     " << name << "(" << row << ",0)      " << name << "(" << row << ",1)      " 
+                 << name << "(" << row << ",2)";
+        }
+      } else {
+        header << "     " << name;
+      }
     }
   }
-  // All ParticleVariable<double>
-  for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const TypeDescription* td = d_varLabels[i]->typeDescription();
-    const TypeDescription* subtype = td->getSubType();
+  header << "\n";
+  return header.str();
+}
 
-    if(subtype->getType() == TypeDescription::double_type){
-      string name = d_varLabels[i]->getName();
-      fprintf(fp,"     %s", name.c_str());
-    }
-  }
-  // All ParticleVariable<Vector>
+//______________________________________________________________________
+//  The column formats of a line of the file, for the binary output.
+//  These must match the fprintf's in doAnalysis.
+vector<AnalysisWriter::Column> particleExtract::fileColumns()
+{
+  vector<AnalysisWriter::Column> columns;
+  columns.push_back(AnalysisWriter::Column('d', "%E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  columns.push_back(AnalysisWriter::Column('d', "\t %E"));
+  
+  int nInt = 0, nDouble = 0, nVector = 0, nMatrix3 = 0;
   for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const TypeDescription* td = d_varLabels[i]->typeDescription();
-    const TypeDescription* subtype = td->getSubType();
-
-    if(subtype->getType() == TypeDescription::Vector){
-      string name = d_varLabels[i]->getName(); 
-      fprintf(fp,"     %s.x      %s.y      %s.z", name.c_str(),name.c_str(),name.c_str());
+    switch(d_varLabels[i]->typeDescription()->getSubType()->getType()){
+      case TypeDescription::int_type:    nInt++;     break;
+      case TypeDescription::double_type: nDouble++;  break;
+      case TypeDescription::Vector:      nVector++;  break;
+      case TypeDescription::Matrix3:     nMatrix3++; break;
+      default:
+        break;
     }
   }
-  // All ParticleVariable<Matrix3>
-  for (unsigned int i =0 ; i < d_varLabels.size(); i++) {
-    const TypeDescription* td = d_varLabels[i]->typeDescription();
-    const TypeDescription* subtype = td->getSubType();
-
-    if(subtype->getType() == TypeDescription::Matrix3){
-      string name = d_varLabels[i]->getName(); 
-      for (int row = 0; row<3; row++){
-        fprintf(fp,"     %s(%i,0)      %s(%i,1)      %s(%i,2)", name.c_str(),row,name.c_str(),row,name.c_str(),row);
-      }
-    }
+  
+  for (int i = 0; i < nInt; i++) {
+    columns.push_back(AnalysisWriter::Column('i', "    %i"));
   }
-  fprintf(fp,"\n");
-  fflush(fp);
-
-  cout << Parallel::getMPIRank() << " particleExtract:Created file " << filename << endl;
+  for (int i = 0; i < nDouble; i++) {
+    columns.push_back(AnalysisWriter::Column('d', "    %16E"));
+  }
+  for (int i = 0; i < nVector + 3*nMatrix3; i++) {   // each Matrix3 row is written as a Vector
+    columns.push_back(AnalysisWriter::Column('d', "    % 16E"));
+    columns.push_back(AnalysisWriter::Column('d', "      %16E"));
+    columns.push_back(AnalysisWriter::Column('d', "      %16E"));
+  }
+  return columns;
 }
+
 //______________________________________________________________________
 // create the directory structure   dirName/LevelIndex
 //
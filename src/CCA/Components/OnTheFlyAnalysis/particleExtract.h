@@ -28,6 +28,7 @@
 #include <CCA/Components/MPM/ConstitutiveModel/MPMMaterial.h>
 
 #include <CCA/Components/OnTheFlyAnalysis/AnalysisModule.h>
+#include <CCA/Components/OnTheFlyAnalysis/AnalysisWriter.h>
 #include <CCA/Ports/Output.h>
 #include <Core/Grid/GridP.h>
 #include <Core/Grid/LevelP.h>
@@ -114,6 +115,10 @@ WARNING
                     
     void createFile(std::string& filename, FILE*& fp);
     
+    std::string fileHeader();
+    
+    std::vector<AnalysisWriter::Column> fileColumns();
+    
     void createDirectory(std::string& lineName, std::string& levelIndex);
     
     bool doMPMOnLevel(int level, int numLevels);
@@ -144,6 +149,9 @@ WARNING
     MaterialSet* d_matl_set;
     MaterialSubset* d_matl_subset;
     std::set<std::string> d_isDirCreated;
+    
+    AnalysisWriter* d_writer;           // binary output
+    int d_layout;
         
   };
 }
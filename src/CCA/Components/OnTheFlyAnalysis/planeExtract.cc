@@ -65,6 +65,7 @@ planeExtract::planeExtract(ProblemSpecP& module_spec,
   d_matl_set = 0;
   d_zero_matl = 0;
   ps_lb = scinew planeExtractLabel();
+  d_writer = scinew AnalysisWriter("planeExtract", dataArchiver);
 }
 
 //__________________________________
@@ -81,6 +82,7 @@ planeExtract::~planeExtract()
   VarLabel::destroy(ps_lb->lastWriteTimeLabel);
   VarLabel::destroy(ps_lb->fileVarsStructLabel);
   delete ps_lb;
+  delete d_writer;
   
   // delete each plane
   vector<plane*>::iterator iter;
@@ -340,6 +342,10 @@ void planeExtract::problemSetup(const ProblemSpecP& prob_spec,
     p->planeType = planeType;
     d_planes.push_back(p);
   }
+  
+  //__________________________________
+  //  Binary output
+  d_writer->problemSetup(d_prob_spec);
 }
 
 //______________________________________________________________________
@@ -494,7 +500,17 @@ void planeExtract::doAnalysis(const ProcessorGroup* pg,
         string path = planePath + "/" + timestep + "/" + levelIndex;
         
         if( d_isDirCreated.count(path) == 0 ){
-          createDirectory( planePath, timestep, now, levelIndex );
+          if( d_writer->isBinary() ){
+            // one physicalTime record per timestep, from the first patch of level 0
+            if( level->getIndex() == 0 && patch->getLevelIndex() == 0 ){
+              vector<AnalysisWriter::Column> columns( 1, AnalysisWriter::Column('d', "%16.15E") );
+              int layout = d_writer->defineLayout( "", columns );
+              int stream = d_writer->openStream( dirName + "/" + timestep + "/physicalTime", layout );
+              d_writer->write( stream, vector<double>(1, now) );
+            }
+          } else {
+            createDirectory( planePath, timestep, now, levelIndex );
+          }
           d_isDirCreated.insert( path );
         }
         
@@ -551,9 +567,19 @@ void planeExtract::doAnalysis(const ProcessorGroup* pg,
             string filename = fname.str();
 
             //__________________________________
-            //  Open the file pointer 
-            FILE *fp;
-            createFile(filename, varLabel, matl, fp);
+            //  Open the file pointer, or the stream of the binary output 
+            FILE *fp = nullptr;
+            int stream = -1;
+            
+            if( d_writer->isBinary() ){
+              ostringstream sname;
+              sname << dirName << "/" << timestep << "/" << levelIndex << "/"
+                    << patch->getID() << ":"<< labelName <<"_"<< matl<<".dat";
+              int layout = d_writer->defineLayout( fileHeader(varLabel, matl), fileColumns(varLabel) );
+              stream = d_writer->openStream( sname.str(), layout );
+            } else {
+              createFile(filename, varLabel, matl, fp);
+            }
 
             //__________________________________
             //
@@ -574,19 +600,19 @@ void planeExtract::doAnalysis(const ProcessorGroup* pg,
                 switch( subtype->getType( )) {
 
                   case Uintah::TypeDescription::double_type:
-                    writeDataD< constCCVariable<double> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataD< constCCVariable<double> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::Vector:
-                    writeDataV< constCCVariable<Vector> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataV< constCCVariable<Vector> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::int_type:
-                    writeDataI< constCCVariable<int> >(      new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataI< constCCVariable<int> >(      new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::Stencil7:
-                    writeDataS7< constCCVariable<Stencil7> >(new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataS7< constCCVariable<Stencil7> >(new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
                   default:
                     throw InternalError("planeExtract: (CCVariable) invalid data type", __FILE__, __LINE__); 
@@ -603,15 +629,15 @@ void planeExtract::doAnalysis(const ProcessorGroup* pg,
                 switch( subtype->getType( )) {
 
                   case Uintah::TypeDescription::double_type:
-                    writeDataD< constSFCXVariable<double> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataD< constSFCXVariable<double> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::Vector:
-                    writeDataV< constSFCXVariable<Vector> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataV< constSFCXVariable<Vector> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::int_type:
-                    writeDataI< constSFCXVariable<int> >(      new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataI< constSFCXVariable<int> >(      new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   default:
@@ -629,15 +655,15 @@ void planeExtract::doAnalysis(const ProcessorGroup* pg,
                 switch( subtype->getType( )) {
 
                   case Uintah::TypeDescription::double_type:
-                    writeDataD< constSFCYVariable<double> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataD< constSFCYVariable<double> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::Vector:
-                    writeDataV< constSFCYVariable<Vector> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataV< constSFCYVariable<Vector> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::int_type:
-                    writeDataI< constSFCYVariable<int> >(      new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataI< constSFCYVariable<int> >(      new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   default:
@@ -655,15 +681,15 @@ void planeExtract::doAnalysis(const ProcessorGroup* pg,
                 switch( subtype->getType( )) {
 
                   case Uintah::TypeDescription::double_type:
-                    writeDataD< constSFCZVariable<double> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataD< constSFCZVariable<double> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::Vector:
-                    writeDataV< constSFCZVariable<Vector> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataV< constSFCZVariable<Vector> >(   new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   case Uintah::TypeDescription::int_type:
-                    writeDataI< constSFCZVariable<int> >(      new_dw, varLabel, matl, patch, offset, iterLim, fp );
+                    writeDataI< constSFCZVariable<int> >(      new_dw, varLabel, matl, patch, offset, iterLim, fp, stream );
                     break;
 
                   default:
@@ -679,7 +705,9 @@ void planeExtract::doAnalysis(const ProcessorGroup* pg,
                 throw InternalError(warn.str(), __FILE__, __LINE__);
             }
 
-            fclose(fp);
+            if( fp ){
+              fclose(fp);
+            }
           }  //loop over variables 
         }  // doWrite    
       }  // loop over planes 
@@ -712,8 +740,18 @@ void planeExtract::createFile(const string& filename,
   
   //__________________________________
   //Write out the header
-  fprintf(fp,"# X      Y      Z "); 
-
+  fprintf(fp,"%s", fileHeader(varLabel, matl).c_str());
+  fflush(fp);
+  
+  cout_doing << Parallel::getMPIRank() << " planeExtract:Created file " << filename << endl;
+}
+//______________________________________________________________________
+//  The file header
+string planeExtract::fileHeader(const VarLabel* varLabel,
+                                const int matl)
+{
+  ostringstream header;
+  header << "# X      Y      Z ";
   
   const Uintah::TypeDescription* td = varLabel->typeDescription();
   const Uintah::TypeDescription* subtype = td->getSubType();
@@ -722,29 +760,68 @@ void planeExtract::createFile(const string& filename,
   switch( subtype->getType( )) {
 
     case Uintah::TypeDescription::double_type:
-      fprintf(fp,"     %s(%i)", labelName.c_str(), matl);
+    case Uintah::TypeDescription::int_type:
+      header << "     " << labelName << "(" << matl << ")";
+      break;
+
+    case Uintah::TypeDescription::Vector:
+      header << "     " << labelName << "(" << matl << ").x      "
+                        << labelName << "(" << matl << ").y      "
+                        << labelName << "(" << matl << ").z";
+      break;
+
+    case Uintah::TypeDescription::Stencil7:
+      header << "     " << labelName << "(" << matl << ").n      s      e      w      t      b      p";
+      break;
+    default:
+      throw InternalError("planeExtract: invalid data type", __FILE__, __LINE__); 
+  }
+  
+  header << "\n";
+  return header.str();
+}
+
+//______________________________________________________________________
+//  The column formats of a line of the file, for the binary output.
+//  These must match the fprintf's in the writeData functions.
+vector<AnalysisWriter::Column> planeExtract::fileColumns(const VarLabel* varLabel)
+{
+  typedef AnalysisWriter::Column Column;
+  
+  vector<Column> columns;
+  columns.push_back(Column('d', "%16.15E"));
+  columns.push_back(Column('d', "\t %16.15E"));
+  columns.push_back(Column('d', "\t %16.15E\t"));
+  
+  switch( varLabel->typeDescription()->getSubType()->getType( )) {
+
+    case Uintah::TypeDescription::double_type:
+      columns.push_back(Column('d', "    %16.15E"));
       break;
 
     case Uintah::TypeDescription::Vector:
-      fprintf(fp,"     %s(%i).x      %s(%i).y      %s(%i).z", labelName.c_str(), matl, labelName.c_str(), matl, labelName.c_str(), matl);
+      columns.push_back(Column('d', "   %16.15E"));
+      columns.push_back(Column('d', "\t %16.15E"));
+      columns.push_back(Column('d', "\t %16.15E"));
       break;
 
     case Uintah::TypeDescription::int_type:
-      fprintf(fp,"     %s(%i)", labelName.c_str(), matl);
+      columns.push_back(Column('i', "   %i "));
       break;
 
     case Uintah::TypeDescription::Stencil7:
-      fprintf(fp,"     %s(%i).n      s      e      w      t      b      p", labelName.c_str(), matl );
+      columns.push_back(Column('d', "   %16.15E"));
+      for(int i = 0; i < 5; i++){
+        columns.push_back(Column('d', "\t %16.15E"));
+      }
+      columns.push_back(Column('d', "\t %16.15E "));
       break;
     default:
       throw InternalError("planeExtract: invalid data type", __FILE__, __LINE__); 
   }
-  
-  fprintf(fp,"\n");
-  fflush(fp);
-  
-  cout_doing << Parallel::getMPIRank() << " planeExtract:Created file " << filename << endl;
+  return columns;
 }
+
 //______________________________________________________________________
 // create the directory structure   planeName/LevelIndex
 //
@@ -814,19 +891,32 @@ void planeExtract::writeDataD( DataWarehouse*  new_dw,
                               const Patch*    patch,
                               const Vector&   offset,
                               CellIterator    iter,
-                              FILE*     fp )
+                              FILE*     fp,
+                              const int stream )
 {  
   Tvar Q_var;
   new_dw->get(Q_var, varLabel, indx, patch, Ghost::None, 0);
   
+  vector<double> records;    // binary output
+  
   for (;!iter.done();iter++) {
     IntVector c = *iter;
     Point here = patch->cellPosition(c);
     here += offset;
+    
+    if( !fp ){
+      double r[] = { here.x(), here.y(), here.z(), Q_var[c] };
+      records.insert( records.end(), r, r + 4 );
+      continue;
+    }
                       
     fprintf(fp,    "%16.15E\t %16.15E\t %16.15E\t",here.x(),here.y(),here.z());
     fprintf(fp, "    %16.15E\n",Q_var[c]);
   }  
+  
+  if( !fp ){
+    d_writer->write( stream, records );
+  }
 }
 
 //______________________________________________________________________
@@ -837,20 +927,33 @@ void planeExtract::writeDataV( DataWarehouse*  new_dw,
                                const Patch*    patch,
                                const Vector&   offset,
                                CellIterator    iter,
-                               FILE*     fp )
+                               FILE*     fp,
+                               const int stream )
 {  
 
   Tvar Q_var;
   new_dw->get(Q_var, varLabel, indx, patch, Ghost::None, 0);
   
+  vector<double> records;    // binary output
+  
   for (;!iter.done();iter++) {
     IntVector c = *iter;
     Point here = patch->cellPosition(c);
     here += offset;
     
+    if( !fp ){
+      double r[] = { here.x(), here.y(), here.z(), Q_var[c].x(), Q_var[c].y(), Q_var[c].z() };
+      records.insert( records.end(), r, r + 6 );
+      continue;
+    }
+    
     fprintf(fp,    "%16.15E\t %16.15E\t %16.15E\t",here.x(), here.y(), here.z());
     fprintf(fp, "   %16.15E\t %16.15E\t %16.15E\n",Q_var[c].x(), Q_var[c].y(), Q_var[c].z() );
   }  
+  
+  if( !fp ){
+    d_writer->write( stream, records );
+  }
 }
 //______________________________________________________________________
 template <class Tvar>
@@ -860,19 +963,32 @@ void planeExtract::writeDataI( DataWarehouse*  new_dw,
                                const Patch*    patch,
                                const Vector&   offset,
                                CellIterator    iter,
-                               FILE*     fp )
+                               FILE*     fp,
+                               const int stream )
 {  
   Tvar Q_var;
   new_dw->get(Q_var, varLabel, indx, patch, Ghost::None, 0);
   
+  vector<double> records;    // binary output
+  
   for (;!iter.done();iter++) {
     IntVector c = *iter;
     Point here = patch->cellPosition(c);
     here += offset;
+    
+    if( !fp ){
+      double r[] = { here.x(), here.y(), here.z(), (double)Q_var[c] };
+      records.insert( records.end(), r, r + 4 );
+      continue;
+    }
                       
     fprintf(fp,    "%16.15E\t %16.15E\t %16.15E\t",here.x(), here.y(), here.z());
     fprintf(fp, "   %i \n",Q_var[c] );
   }  
+  
+  if( !fp ){
+    d_writer->write( stream, records );
+  }
 }
 //______________________________________________________________________
 template <class Tvar>
@@ -882,20 +998,34 @@ void planeExtract::writeDataS7( DataWarehouse*  new_dw,
                                const Patch*    patch,
                                const Vector&   offset,
                                CellIterator    iter,
-                               FILE*     fp )
+                               FILE*     fp,
+                               const int stream )
 {  
   Tvar Q;
   new_dw->get(Q, varLabel, indx, patch, Ghost::None, 0);
   
+  vector<double> records;    // binary output
+  
   for (;!iter.done();iter++) {
     IntVector c = *iter;
     Point here = patch->cellPosition(c);
     here += offset;
+    
+    if( !fp ){
+      double r[] = { here.x(), here.y(), here.z(),
+                     Q[c].n, Q[c].s, Q[c].e, Q[c].w, Q[c].t, Q[c].b, Q[c].p };
+      records.insert( records.end(), r, r + 10 );
+      continue;
+    }
         
     fprintf(fp,    "%16.15E\t %16.15E\t %16.15E\t",here.x(), here.y(), here.z());
     fprintf(fp, "   %16.15E\t %16.15E\t %16.15E\t %16.15E\t %16.15E\t %16.15E\t %16.15E \n",
             Q[c].n, Q[c].s, Q[c].e, Q[c].w, Q[c].t, Q[c].b, Q[c].p );
   }  
+  
+  if( !fp ){
+    d_writer->write( stream, records );
+  }
 }
 
 //______________________________________________________________________
@@ -26,6 +26,7 @@
 #ifndef Packages_Uintah_CCA_Components_ontheflyAnalysis_planeExtract_h
 #define Packages_Uintah_CCA_Components_ontheflyAnalysis_planeExtract_h
 #include <CCA/Components/OnTheFlyAnalysis/AnalysisModule.h>
+#include <CCA/Components/OnTheFlyAnalysis/AnalysisWriter.h>
 #include <CCA/Ports/Output.h>
 #include <Core/Grid/Variables/VarTypes.h>
 #include <Core/Grid/Variables/CCVariable.h>
@@ -114,6 +115,11 @@ WARNING
                      const int matl,
                      FILE*& fp );
     
+    std::string fileHeader( const VarLabel* varLabel,
+                            const int matl );
+    
+    std::vector<AnalysisWriter::Column> fileColumns( const VarLabel* varLabel );
+    
     void createDirectory( std::string& planeName,
                           std::string& timestep,
                           const double now,
@@ -126,7 +132,8 @@ WARNING
                      const Patch*    patch,
                      const Vector&   offset,
                      CellIterator    iter,
-                     FILE*     fp );
+                     FILE*     fp,
+                     const int stream );
                      
     template <class Tvar>     /* Vector */
     void writeDataV( DataWarehouse*  new_dw,
@@ -135,7 +142,8 @@ WARNING
                      const Patch*    patch,
                      const Vector&   offset,
                      CellIterator    iter,
-                     FILE*     fp );
+                     FILE*     fp,
+                     const int stream );
                      
     template <class Tvar>     /* integer */   
     void writeDataI( DataWarehouse*  new_dw,
@@ -144,7 +152,8 @@ WARNING
                      const Patch*    patch,
                      const Vector&   offset,
                      CellIterator    iter,
-                     FILE*     fp );
+                     FILE*     fp,
+                     const int stream );
                      
     template <class Tvar>     /* Stencil7 */
     void writeDataS7( DataWarehouse*  new_dw,
@@ -153,7 +162,8 @@ WARNING
                       const Patch*    patch,
                       const Vector&   offset,
                       CellIterator    iter,
-                      FILE*     fp );
+                      FILE*     fp,
+                     const int stream );
                       
     CellIterator getIterator( const Uintah::TypeDescription* td, 
                               const Patch* patch,
@@ -198,6 +208,7 @@ WARNING
     Output*          d_dataArchiver;
     ProblemSpecP     d_prob_spec;
     std::set<std::string> d_isDirCreated;
+    AnalysisWriter*  d_writer;          // binary output
     
     MaterialSet*     d_matl_set;
     MaterialSubset* d_zero_matl;
@@ -35,6 +35,7 @@ SRCDIR := CCA/Components/OnTheFlyAnalysis
 SRCS += \
         $(SRCDIR)/AnalysisModuleFactory.cc   \
         $(SRCDIR)/AnalysisModule.cc          \
+        $(SRCDIR)/AnalysisWriter.cc          \
         $(SRCDIR)/1stLawThermo.cc            \
         $(SRCDIR)/containerExtract.cc        \
         $(SRCDIR)/flatPlate_heatFlux.cc      \
@@ -44,6 +45,7 @@ SRCS += \
         $(SRCDIR)/particleExtract.cc         \
         $(SRCDIR)/planeExtract.cc            \
         $(SRCDIR)/radiometer.cc              \
+        $(SRCDIR)/StatisticsEngine.cc        \
         $(SRCDIR)/vorticity.cc
 
 
@@ -161,7 +161,7 @@ Grid* SingleLevelRegridder::regrid(Grid* oldGrid)
         }
       }  // patch loop
 
-      TiledRegridder::GatherTiles( mytiles,tiles[l] );
+      TiledRegridder::GatherTiles( l, mytiles,tiles[l] );
       
     } else {
       // Other levels:
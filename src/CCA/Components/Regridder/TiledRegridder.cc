@@ -30,6 +30,7 @@
 #include <Core/Exceptions/ProblemSetupException.h>
 #include <Core/Grid/Grid.h>
 #include <Core/Grid/PatchBVH/PatchBVH.h>
+#include <Core/Grid/Variables/BlockRange.hpp>
 #include <Core/Grid/Variables/CellIterator.h>
 #include <Core/Parallel/ProcessorGroup.h>
 #include <Core/Util/Time.h>
@@ -38,6 +39,9 @@ using namespace Uintah;
 
 #include <iomanip>
 #include <cstdio>
+#include <cstdint>
+#include <map>
+#include <set>
 using namespace std;
 
 static DebugStream grid_dbg("GridDBG",false);
@@ -48,6 +52,86 @@ int Product(const IntVector &i)
     return i[0]*i[1]*i[2];
 }
 
+//______________________________________________________________________
+//  Refinement flags of a patch, one bit per cell.
+namespace {
+
+  class FlagBits {
+  public:
+    FlagBits(const IntVector& low, const IntVector& high)
+      : d_low(low), d_size(high - low)
+    {
+      d_wordsPerRow = (d_size.x() + 63) / 64;
+      d_words.assign((size_t)d_wordsPerRow * d_size.y() * d_size.z(), 0);
+    }
+
+    // returns false if no cell is flagged
+    bool set(const constCCVariable<int>& flags)
+    {
+      bool anySet = false;
+      for (int k = 0; k < d_size.z(); k++) {
+        for (int j = 0; j < d_size.y(); j++) {
+          uint64_t* row = &d_words[rowIndex(j, k)];
+          for (int i = 0; i < d_size.x(); i++) {
+            if (flags(d_low.x() + i, d_low.y() + j, d_low.z() + k)) {
+              row[i >> 6] |= (uint64_t)1 << (i & 63);
+              anySet = true;
+            }
+          }
+        }
+      }
+      return anySet;
+    }
+
+    // is any cell in [low, high) flagged
+    bool any(const IntVector& low, const IntVector& high) const
+    {
+      const int i0 = low.x() - d_low.x();
+      const int i1 = high.x() - d_low.x();
+      if (i0 >= i1) {
+        return false;
+      }
+      const int w0 = i0 >> 6;
+      const int w1 = (i1 - 1) >> 6;
+      const uint64_t first = ~(uint64_t)0 << (i0 & 63);
+      const uint64_t last  = ~(uint64_t)0 >> (63 - ((i1 - 1) & 63));
+
+      for (int k = low.z() - d_low.z(); k < high.z() - d_low.z(); k++) {
+        for (int j = low.y() - d_low.y(); j < high.y() - d_low.y(); j++) {
+          const uint64_t* row = &d_words[rowIndex(j, k)];
+          if (w0 == w1) {
+            if (row[w0] & first & last) {
+              return true;
+            }
+            continue;
+          }
+          if ((row[w0] & first) || (row[w1] & last)) {
+            return true;
+          }
+          for (int w = w0 + 1; w < w1; w++) {
+            if (row[w]) {
+              return true;
+            }
+          }
+        }
+      }
+      return false;
+    }
+
+  private:
+    size_t rowIndex(int j, int k) const
+    {
+      return ((size_t)k * d_size.y() + j) * d_wordsPerRow;
+    }
+
+    IntVector             d_low;
+    IntVector             d_size;
+    int                   d_wordsPerRow;
+    std::vector<uint64_t> d_words;
+  };
+
+} // end anonymous namespace
+
 TiledRegridder::TiledRegridder(const ProcessorGroup* pg) : RegridderCommon(pg)
 {
 }
@@ -68,30 +152,41 @@ void TiledRegridder::ComputeTiles( vector<IntVector> &tiles,
   const PatchSubset *ps=lb_->getPerProcessorPatchSet(level)->getSubset(d_myworld->myrank());
   int newLevelIndex=level->getIndex()+1;
 
+  // Get the flags first, the patches are then searched concurrently.
+  const int numPatches = ps->size();
+  vector< constCCVariable<int> > flags(numPatches);
+  for(int p=0;p<numPatches;p++) {
+    dw->get(flags[p], d_dilatedCellsRegridLabel, 0, ps->get(p), Ghost::None, 0);
+  }
+
+  vector< vector<IntVector> > patchTiles(numPatches);
+  vector<long>                searched(numPatches, 0);
+
   //for each patch I own
-  for(int p=0;p<ps->size();p++) {
+  BlockRange patchRange(IntVector(0,0,0), IntVector(1,1,numPatches));
+  Uintah::parallel_for(patchRange, BlockRangePolicy(BlockRangePolicy::KSlab, 0, 8, 8, 1), [&](int, int, int p) {
 
     const Patch *patch=ps->get(p);
-    constCCVariable<int> flags;
-    dw->get(flags, d_dilatedCellsRegridLabel, 0, patch, Ghost::None, 0);
+    IntVector low  = patch->getCellLowIndex();
+    IntVector high = patch->getCellHighIndex();
+
+    // Pack the flags into one bit per cell, each i-row padded to a whole
+    // number of words, so that a tile is searched 64 cells at a time.
+    FlagBits bits(low, high);
+    if( !bits.set(flags[p]) ) {
+      searched[p] = patch->getNumCells();
+      return;                       // no flags on this patch, no tiles
+    }
 
     //compute fine level patch extents
-    IntVector patchLow  = patch->getCellLowIndex()  * cellRefinementRatio;
-    IntVector patchHigh = patch->getCellHighIndex() * cellRefinementRatio;
+    IntVector patchLow  = low  * cellRefinementRatio;
+    IntVector patchHigh = high * cellRefinementRatio;
 
     //compute possible tile index's
     IntVector tileLow  = computeTileIndex(patchLow, tile_size);
     IntVector tileHigh = computeTileIndex(patchHigh,tile_size);
     tileHigh += IntVector(1,1,1);   // **** We must use inclusive loops when looping over the tiles ***
 
-    // Bulletproofing:
-#if SCI_ASSERTION_LEVEL > 0
-    CCVariable<int> beenSearched;
-    dw->allocateTemporary( beenSearched, patch);
-    beenSearched.initialize(-9);
-#endif
-
-
     for (CellIterator ti(tileLow,tileHigh); !ti.done(); ti++){
 
       //compute tile extents
@@ -102,56 +197,39 @@ void TiledRegridder::ComputeTiles( vector<IntVector> &tiles,
       IntVector searchLow =Max(cellLow, patchLow)/cellRefinementRatio;
       IntVector searchHigh=Min(cellHigh,patchHigh)/cellRefinementRatio;
 
-#if 0
-      if(patch->getID() == 222082){
-          cout << "   Patch_ID  " << patch->getID() << endl;
-          cout << "   coarsePatch : "<< patch->getCellLowIndex() << " patchHigh: " << patch->getCellHighIndex() << endl;
-          cout << "   finePatch   : " << patchLow << " finePatchHigh: " << patchHigh << endl;
-          cout << "   tileIndex   : " << *ti << " tileLow:  " << tileLow << " tileHigh: " << tileHigh << endl;
-          cout << "   cellLow     : " << cellLow << " cellHigh: " << cellHigh << endl;
-      }
-#endif
-
+      IntVector extent = Max(searchHigh - searchLow, IntVector(0,0,0));
+      searched[p] += (long)extent.x() * extent.y() * extent.z();
 
       //search the tile for a refinement flag
-      for(CellIterator ci(searchLow,searchHigh); !ci.done(); ci++){
-
-#if SCI_ASSERTION_LEVEL == 0
-        if(flags[*ci]){
-          tiles.push_back(*ti);
-          break;
-        }
-#else                               // bulletproofing:  set the beenSearched flag
-        if(flags[*ci]){
-          tiles.push_back(*ti);
-        }
-        beenSearched[*ci] = 1;
-#endif
+      if( bits.any(searchLow, searchHigh) ) {
+        patchTiles[p].push_back(*ti);
       }
     }  // tile loop
+  });
 
-#if SCI_ASSERTION_LEVEL > 0
-    //__________________________________
-    //  BULLET PROOFING If all the cells on the coarse level
-    // haven't been searched then throw an exception
-    int count = 0;
-    for(CellIterator iter=patch->getCellIterator(); !iter.done();iter++) {
-      IntVector c = *iter;
-      if(beenSearched[c] == -9){
-        count +=1;
-      }
-    }
+  // append in patch order so that the result does not depend on the threads
+  for(int p=0;p<numPatches;p++) {
+    tiles.insert(tiles.end(), patchTiles[p].begin(), patchTiles[p].end());
+  }
 
-    if(count != 0){
+#if SCI_ASSERTION_LEVEL > 0
+  //__________________________________
+  //  BULLET PROOFING If all the cells on the coarse level
+  // haven't been searched then throw an exception.  The tiles partition
+  // the patch, so the searched volumes must add up to the patch.
+  for(int p=0;p<numPatches;p++) {
+    const Patch* patch = ps->get(p);
+    long count = patch->getNumCells() - searched[p];
+
+    if(count > 0){
       std::ostringstream msg;
       msg << " ERROR:  TiledRegridder:  Did not search this patch "
           << *patch << " entirely for refinement flags.  Number of cells not searched: " << count << endl;
 
       throw InternalError(msg.str(),__FILE__,__LINE__);
     }
+  }
 #endif
-
-  }  // patch loop
 }
 double rtimes[20]={0};
 //______________________________________________________________________
@@ -186,7 +264,7 @@ Grid* TiledRegridder::regrid(Grid* oldGrid)
     rtimes[1]+=Time::currentSeconds()-start;
     start=Time::currentSeconds();
 
-    GatherTiles(mytiles,tiles[l+1]);
+    GatherTiles(l+1,mytiles,tiles[l+1]);
 
     if(l>0) {
       //add flags to the coarser level to ensure that boundary layers exist and that fine patches have a coarse patches above them.
@@ -674,6 +752,7 @@ struct CompressedIntVector
   unsigned int x : 10;
   unsigned int y : 10;
   unsigned int z : 10;
+  unsigned int removed : 1;     // GatherTiles: the tile was dropped since the last regrid
   int operator[](int index)
   {
     switch (index)
@@ -690,62 +769,94 @@ struct CompressedIntVector
   }
 };
 //______________________________________________________________________
-//
-void TiledRegridder::GatherTiles(vector<IntVector>& mytiles, vector<IntVector> &gatheredTiles )
+//  Only the tiles that changed since the last regrid are exchanged.  Each
+//  process remembers the tiles it contributed to a level, and every process
+//  keeps, for each tile of the level, the number of processes contributing
+//  it.  A process sends the tiles it added and removed, everyone applies
+//  all of the changes to the counts, and the level's tiles are those with a
+//  nonzero count.  Since all processes apply the same changes the result
+//  is the same everywhere, also when patches move between processes.
+void TiledRegridder::GatherTiles(int levelIndex, vector<IntVector>& mytiles, vector<IntVector> &gatheredTiles )
 {
-  set<IntVector> settiles;
+  set<IntVector> settiles(mytiles.begin(), mytiles.end());
+
   if(d_myworld->size()>1)
   {
-    unsigned int mycount=mytiles.size();
-    vector<unsigned int> counts(d_myworld->size());
+    if((int)d_myTiles.size() <= levelIndex) {
+      d_myTiles.resize(levelIndex+1);
+      d_tileCounts.resize(levelIndex+1);
+    }
+    set<IntVector>&      previous = d_myTiles[levelIndex];
+    map<IntVector, int>& counts   = d_tileCounts[levelIndex];
 
-    vector<CompressedIntVector> tiles(mytiles.size()), gtiles;
+    //the tiles added and removed since the last regrid
+    vector<CompressedIntVector> changes;
+    CompressedIntVector change;
 
-    //copy tiles into compressed data structure
-    for(size_t i=0; i<tiles.size();i++)
-    {
-      tiles[i].x=mytiles[i].x();
-      tiles[i].y=mytiles[i].y();
-      tiles[i].z=mytiles[i].z();
+    for(set<IntVector>::const_iterator iter = settiles.begin(); iter != settiles.end(); iter++) {
+      if(previous.find(*iter) == previous.end()) {
+        change.x = iter->x(); change.y = iter->y(); change.z = iter->z(); change.removed = 0;
+        changes.push_back(change);
+      }
     }
+    for(set<IntVector>::const_iterator iter = previous.begin(); iter != previous.end(); iter++) {
+      if(settiles.find(*iter) == settiles.end()) {
+        change.x = iter->x(); change.y = iter->y(); change.z = iter->z(); change.removed = 1;
+        changes.push_back(change);
+      }
+    }
+    previous.swap(settiles);
 
-    //gather the number of tiles on each processor
-    Uintah::MPI::Allgather(&mycount,1,MPI_UNSIGNED,&counts[0],1,MPI_UNSIGNED,d_myworld->getComm());
-
-    //compute the displacements and recieve counts for a gatherv
-    vector<int> displs(d_myworld->size());
+    //gather the number of changes on each processor
+    int mycount = changes.size() * sizeof(CompressedIntVector);
     vector<int> recvcounts(d_myworld->size());
+    Uintah::MPI::Allgather(&mycount,1,MPI_INT,&recvcounts[0],1,MPI_INT,d_myworld->getComm());
 
+    //compute the displacements for a gatherv
+    vector<int> displs(d_myworld->size());
     int pos=0;
     for(int p=0;p<d_myworld->size();p++)
     {
       displs[p]=pos;
-      recvcounts[p]=counts[p]*sizeof(CompressedIntVector);
-      //cout << d_myworld->myrank() << " displs: " << displs[p] << " recvs: " << recvcounts[p] << endl;
       pos+=recvcounts[p];
     }
 
-    gtiles.resize(pos/sizeof(CompressedIntVector));
-
-    //gatherv tiles
-    Uintah::MPI::Allgatherv(&tiles[0],recvcounts[d_myworld->myrank()], MPI_BYTE, &gtiles[0], &recvcounts[0],
-                   &displs[0], MPI_BYTE, d_myworld->getComm());
+    if(pos > 0) {
+      vector<CompressedIntVector> gchanges(pos/sizeof(CompressedIntVector));
+      changes.resize(max(changes.size(), (size_t)1));
+
+      //gatherv changes
+      Uintah::MPI::Allgatherv(&changes[0], mycount, MPI_BYTE, &gchanges[0], &recvcounts[0],
+                     &displs[0], MPI_BYTE, d_myworld->getComm());
+
+      for(size_t i=0;i<gchanges.size();i++) {
+        IntVector tile(gchanges[i].x, gchanges[i].y, gchanges[i].z);
+        if(gchanges[i].removed) {
+          map<IntVector, int>::iterator iter = counts.find(tile);
+          ASSERT(iter != counts.end());
+          if(--iter->second == 0) {
+            counts.erase(iter);
+          }
+        }
+        else {
+          counts[tile]++;
+        }
+      }
+    }
 
-    //tiles might not be unique so add them to a set to make them unique
-    //copy compressed tiles into the tile set
-    for(size_t i=0;i<gtiles.size();i++)
-      settiles.insert(IntVector(gtiles[i].x,gtiles[i].y,gtiles[i].z));
+    rgtimes << d_myworld->myrank() << " GatherTiles level " << levelIndex << ": sent " << mycount / sizeof(CompressedIntVector)
+            << " changed tiles, received " << pos / sizeof(CompressedIntVector) << "\n";
 
-    gtiles.clear();
+    gatheredTiles.clear();
+    gatheredTiles.reserve(counts.size());
+    for(map<IntVector, int>::const_iterator iter = counts.begin(); iter != counts.end(); iter++) {
+      gatheredTiles.push_back(iter->first);
+    }
   }
   else
   {
-    //tiles might not be unique so add them to a set to make them unique
-    for(size_t i=0;i<mytiles.size();i++)
-      settiles.insert(mytiles[i]);
+    //tiles might not be unique so they were added to a set to make them unique
+    //reassign set to a vector
+    gatheredTiles.assign(settiles.begin(),settiles.end());
   }
-
-  //reassign set to a vector
-  gatheredTiles.assign(settiles.begin(),settiles.end());
-
 }
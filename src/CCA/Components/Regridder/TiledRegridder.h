@@ -26,6 +26,8 @@
 #define UINTAH_HOMEBREW_TILEDREGRIDDER_H
 #include <CCA/Components/Regridder/RegridderCommon.h>
 
+#include <map>
+#include <set>
 #include <vector> 
 
 namespace Uintah {
@@ -81,7 +83,7 @@ WARNING
     void CoarsenFlags(GridP oldGrid, int l, std::vector<IntVector> tiles); 
     void OutputGridStats(Grid* newGrid);
     void ComputeTiles(std::vector<IntVector> &tiles, const LevelP level, IntVector tile_size, IntVector cellRefinementRatio);
-    void GatherTiles(std::vector<IntVector>& mytiles, std::vector<IntVector> &gatheredTiles );
+    void GatherTiles(int levelIndex, std::vector<IntVector>& mytiles, std::vector<IntVector> &gatheredTiles );
     
     //maps a cell index to a tile index
     IntVector computeTileIndex(const IntVector& cellIndex, 
@@ -105,6 +107,11 @@ WARNING
     SizeList d_numCells;            //the maximum number of cells in each dimension for each level
 
     bool     d_dynamic_size;        //dynamically grow or shrink the tile size
+
+    //GatherTiles state, per level: the tiles this process contributed at the
+    //last regrid and, for every tile, the number of processes contributing it
+    std::vector< std::set<IntVector> >      d_myTiles;
+    std::vector< std::map<IntVector, int> > d_tileCounts;
   };
 
 } // End namespace Uintah
@@ -142,6 +142,13 @@ DynamicMPIScheduler::problemSetup( const ProblemSpecP&     prob_spec,
   }
 
   SchedulerCommon::problemSetup(prob_spec, state);
+  setupNodeMailbox(prob_spec);
+
+  // phase sync here runs a single reduction task per phase
+  if (d_fuseReductions) {
+    proc0cout << "   WARNING: fuse_reductions is not supported by the DynamicMPI scheduler and is ignored\n";
+    d_fuseReductions = false;
+  }
 }
 
 //______________________________________________________________________
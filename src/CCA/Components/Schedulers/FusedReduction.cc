@@ -0,0 +1,367 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <CCA/Components/Schedulers/FusedReduction.h>
+#include <CCA/Components/Schedulers/DetailedTasks.h>
+#include <CCA/Components/Schedulers/OnDemandDataWarehouse.h>
+
+#include <Core/Exceptions/InternalError.h>
+#include <Core/Grid/Task.h>
+#include <Core/Grid/Variables/ReductionVariableBase.h>
+#include <Core/Util/DebugStream.h>
+#include <Core/Util/FancyAssert.h>
+
+#include <cstring>
+
+using namespace Uintah;
+
+static DebugStream fusedbg( "FusedReduction", false );
+
+namespace {
+
+  enum ElementType { FR_DOUBLE, FR_FLOAT, FR_INT, FR_LONG, FR_LONG_LONG, FR_CHAR };
+  enum Operation   { FR_MIN, FR_MAX, FR_SUM, FR_PROD, FR_LAND, FR_LOR };
+
+  // header: number of segments (padded to 8 bytes), then one
+  // { type, op, count, bytes } record per segment
+  const int HEADER_BYTES  = 2 * sizeof(int);
+  const int SEGMENT_BYTES = 4 * sizeof(int);
+
+  int paddedBytes( int bytes )
+  {
+    return (bytes + 7) & ~7;
+  }
+
+  bool translateType( MPI_Datatype datatype, int& type, int& size )
+  {
+    if      (datatype == MPI_DOUBLE)    { type = FR_DOUBLE;    size = sizeof(double);    }
+    else if (datatype == MPI_FLOAT)     { type = FR_FLOAT;     size = sizeof(float);     }
+    else if (datatype == MPI_INT)       { type = FR_INT;       size = sizeof(int);       }
+    else if (datatype == MPI_LONG)      { type = FR_LONG;      size = sizeof(long);      }
+    else if (datatype == MPI_LONG_LONG) { type = FR_LONG_LONG; size = sizeof(long long); }
+    else if (datatype == MPI_CHAR)      { type = FR_CHAR;      size = sizeof(char);      }
+    else {
+      return false;
+    }
+    return true;
+  }
+
+  bool translateOp( MPI_Op mpiop, int& op )
+  {
+    if      (mpiop == MPI_MIN)  { op = FR_MIN;  }
+    else if (mpiop == MPI_MAX)  { op = FR_MAX;  }
+    else if (mpiop == MPI_SUM)  { op = FR_SUM;  }
+    else if (mpiop == MPI_PROD) { op = FR_PROD; }
+    else if (mpiop == MPI_LAND) { op = FR_LAND; }
+    else if (mpiop == MPI_LOR)  { op = FR_LOR;  }
+    else {
+      return false;
+    }
+    return true;
+  }
+
+  int typeSize( int type )
+  {
+    switch (type) {
+      case FR_DOUBLE    : return sizeof(double);
+      case FR_FLOAT     : return sizeof(float);
+      case FR_INT       : return sizeof(int);
+      case FR_LONG      : return sizeof(long);
+      case FR_LONG_LONG : return sizeof(long long);
+      default           : return sizeof(char);
+    }
+  }
+
+  template<class T>
+  void reduceSegment( const T* in, T* inout, int count, int op )
+  {
+    switch (op) {
+      case FR_MIN :
+        for (int i = 0; i < count; i++) {
+          inout[i] = in[i] < inout[i] ? in[i] : inout[i];
+        }
+        break;
+      case FR_MAX :
+        for (int i = 0; i < count; i++) {
+          inout[i] = in[i] > inout[i] ? in[i] : inout[i];
+        }
+        break;
+      case FR_SUM :
+        for (int i = 0; i < count; i++) {
+          inout[i] += in[i];
+        }
+        break;
+      case FR_PROD :
+        for (int i = 0; i < count; i++) {
+          inout[i] *= in[i];
+        }
+        break;
+      case FR_LAND :
+        for (int i = 0; i < count; i++) {
+          inout[i] = in[i] && inout[i];
+        }
+        break;
+      case FR_LOR :
+        for (int i = 0; i < count; i++) {
+          inout[i] = in[i] || inout[i];
+        }
+        break;
+    }
+  }
+
+  // created on first use, freed by FusedReduction::freeOp()
+  MPI_Op s_fusedOp = MPI_OP_NULL;
+
+#if UINTAH_ENABLE_MPI3
+  // The user-defined MPI_Op.  Every element is a whole packed buffer,
+  // which describes its own layout in the header.
+  void fusedReductionOp( void* invec, void* inoutvec, int* len, MPI_Datatype* datatype )
+  {
+    char* in    = static_cast<char*>(invec);
+    char* inout = static_cast<char*>(inoutvec);
+
+    for (int e = 0; e < *len; e++) {
+      int nsegs = reinterpret_cast<int*>(inout)[0];
+      const int* header = reinterpret_cast<int*>(inout + HEADER_BYTES);
+      int offset = HEADER_BYTES + nsegs * SEGMENT_BYTES;
+
+      for (int s = 0; s < nsegs; s++) {
+        int type  = header[4 * s];
+        int op    = header[4 * s + 1];
+        int count = header[4 * s + 2];
+        int bytes = header[4 * s + 3];
+
+        switch (type) {
+          case FR_DOUBLE :
+            reduceSegment(reinterpret_cast<double*>(in + offset), reinterpret_cast<double*>(inout + offset), count, op);
+            break;
+          case FR_FLOAT :
+            reduceSegment(reinterpret_cast<float*>(in + offset), reinterpret_cast<float*>(inout + offset), count, op);
+            break;
+          case FR_INT :
+            reduceSegment(reinterpret_cast<int*>(in + offset), reinterpret_cast<int*>(inout + offset), count, op);
+            break;
+          case FR_LONG :
+            reduceSegment(reinterpret_cast<long*>(in + offset), reinterpret_cast<long*>(inout + offset), count, op);
+            break;
+          case FR_LONG_LONG :
+            reduceSegment(reinterpret_cast<long long*>(in + offset), reinterpret_cast<long long*>(inout + offset), count, op);
+            break;
+          case FR_CHAR :
+            reduceSegment(reinterpret_cast<char*>(in + offset), reinterpret_cast<char*>(inout + offset), count, op);
+            break;
+        }
+        offset += bytes;
+      }
+      in    += offset;
+      inout += offset;
+    }
+  }
+
+  MPI_Op fusedOp()
+  {
+    if (s_fusedOp == MPI_OP_NULL) {
+      Uintah::MPI::Op_create(fusedReductionOp, 1, &s_fusedOp);
+    }
+    return s_fusedOp;
+  }
+#endif
+
+}
+
+//______________________________________________________________________
+//
+void
+FusedReduction::freeOp()
+{
+  int finalized = 0;
+  Uintah::MPI::Finalized(&finalized);
+  if (s_fusedOp != MPI_OP_NULL && !finalized) {
+    Uintah::MPI::Op_free(&s_fusedOp);
+  }
+  s_fusedOp = MPI_OP_NULL;
+}
+
+//______________________________________________________________________
+//
+FusedReduction::FusedReduction()
+  : d_datatype(MPI_DATATYPE_NULL), d_request(MPI_REQUEST_NULL), d_started(false), d_complete(false)
+{
+}
+
+//______________________________________________________________________
+//
+FusedReduction::~FusedReduction()
+{
+  if (d_datatype != MPI_DATATYPE_NULL) {
+    Uintah::MPI::Type_free(&d_datatype);
+  }
+}
+
+//______________________________________________________________________
+//
+bool
+FusedReduction::addTask( DetailedTask* task, std::vector<OnDemandDataWarehouseP>& dws )
+{
+  ASSERT(!d_started);
+
+  const Task::Dependency* mod = task->getTask()->getModifies();
+  ASSERT(mod && !mod->next);
+
+  OnDemandDataWarehouse* dw = dws[mod->mapDataWarehouse()].get_rep();
+
+  Segment seg;
+  dw->getReductionVariablesForMPI(mod->var, mod->reductionLevel, mod->matls, seg.vars);
+
+  seg.count = 0;
+  seg.countPerVar = 0;
+  int size = 0;
+  for (unsigned i = 0; i < seg.vars.size(); i++) {
+    int count;
+    MPI_Datatype datatype = MPI_DATATYPE_NULL;
+    MPI_Op op = MPI_OP_NULL;
+    seg.vars[i]->getMPIInfo(count, datatype, op);
+
+    int type, frop;
+    if (!translateType(datatype, type, size) || !translateOp(op, frop)) {
+      return false;
+    }
+    if (i == 0) {
+      seg.type = type;
+      seg.op = frop;
+      seg.countPerVar = count;
+    }
+    else if (seg.type != type || seg.op != frop || seg.countPerVar != count) {
+      return false;
+    }
+    seg.count += count;
+  }
+
+  seg.bytes = paddedBytes(seg.count * size);
+  d_segments.push_back(seg);
+  d_tasks.push_back(task);
+  return true;
+}
+
+//______________________________________________________________________
+//
+void
+FusedReduction::start( MPI_Comm comm )
+{
+  ASSERT(!d_started);
+
+  int nsegs = d_segments.size();
+  int totalBytes = HEADER_BYTES + nsegs * SEGMENT_BYTES;
+  for (int s = 0; s < nsegs; s++) {
+    totalBytes += d_segments[s].bytes;
+  }
+
+  d_sendbuf.assign(totalBytes, 0);
+  d_recvbuf.assign(totalBytes, 0);
+
+  int* header = reinterpret_cast<int*>(&d_sendbuf[0]);
+  header[0] = nsegs;
+  header += HEADER_BYTES / sizeof(int);
+
+  int offset = HEADER_BYTES + nsegs * SEGMENT_BYTES;
+  for (int s = 0; s < nsegs; s++) {
+    Segment& seg = d_segments[s];
+    header[4 * s]     = seg.type;
+    header[4 * s + 1] = seg.op;
+    header[4 * s + 2] = seg.count;
+    header[4 * s + 3] = seg.bytes;
+
+    int varBytes = typeSize(seg.type) * seg.countPerVar;
+    for (unsigned i = 0; i < seg.vars.size(); i++) {
+      // not every getMPIData advances the index, so place each variable explicitly
+      int index = offset + i * varBytes;
+      seg.vars[i]->getMPIData(d_sendbuf, index);
+    }
+    offset += seg.bytes;
+  }
+
+  Uintah::MPI::Type_contiguous(totalBytes, MPI_BYTE, &d_datatype);
+  Uintah::MPI::Type_commit(&d_datatype);
+
+  if (fusedbg.active()) {
+    fusedbg << "FusedReduction: reducing " << nsegs << " variables in " << totalBytes << " bytes\n";
+  }
+
+  d_started = true;
+
+#if UINTAH_ENABLE_MPI3
+  Uintah::MPI::Iallreduce(&d_sendbuf[0], &d_recvbuf[0], 1, d_datatype, fusedOp(), comm, &d_request);
+#else
+  // SchedulerCommon::problemSetup turns fuse_reductions off in this build
+  SCI_THROW(InternalError("FusedReduction: fused reductions need UINTAH_ENABLE_MPI3", __FILE__, __LINE__));
+#endif
+}
+
+//______________________________________________________________________
+//
+bool
+FusedReduction::test()
+{
+  ASSERT(d_started);
+
+#if UINTAH_ENABLE_MPI3
+  if (!d_complete) {
+    int flag = 0;
+    Uintah::MPI::Test(&d_request, &flag, MPI_STATUS_IGNORE);
+    d_complete = (flag != 0);
+  }
+#endif
+  return d_complete;
+}
+
+//______________________________________________________________________
+//
+void
+FusedReduction::finish( std::vector<OnDemandDataWarehouseP>& dws )
+{
+  ASSERT(d_started);
+
+#if UINTAH_ENABLE_MPI3
+  if (!d_complete) {
+    Uintah::MPI::Wait(&d_request, MPI_STATUS_IGNORE);
+    d_complete = true;
+  }
+#endif
+
+  int nsegs = d_segments.size();
+  int offset = HEADER_BYTES + nsegs * SEGMENT_BYTES;
+  for (int s = 0; s < nsegs; s++) {
+    Segment& seg = d_segments[s];
+    int varBytes = typeSize(seg.type) * seg.countPerVar;
+    for (unsigned i = 0; i < seg.vars.size(); i++) {
+      int index = offset + i * varBytes;
+      seg.vars[i]->putMPIData(d_recvbuf, index);
+    }
+    offset += seg.bytes;
+  }
+
+  for (unsigned t = 0; t < d_tasks.size(); t++) {
+    d_tasks[t]->done(dws);
+  }
+}
@@ -0,0 +1,137 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CCA_COMPONENTS_SCHEDULERS_FUSEDREDUCTION_H
+#define CCA_COMPONENTS_SCHEDULERS_FUSEDREDUCTION_H
+
+#include <CCA/Components/Schedulers/OnDemandDataWarehouseP.h>
+
+#include <sci_defs/mpi_defs.h>
+
+#include <vector>
+
+namespace Uintah {
+
+class DetailedTask;
+class OnDemandDataWarehouse;
+class ReductionVariableBase;
+
+/**************************************
+
+ CLASS
+   FusedReduction
+
+ GENERAL INFORMATION
+
+   FusedReduction.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+ KEYWORDS
+   Reduction, MPI_Allreduce, MPI_Iallreduce
+
+ DESCRIPTION
+   Packs the reduction variables of several reduction tasks (delT,
+   totals, min/max diagnostics, ...) into one buffer and reduces them
+   with a single allreduce.
+
+   The buffer starts with a small header describing each segment
+   (element type, operation and count) followed by the segment data.
+   It is sent as one element of a contiguous datatype together with a
+   user-defined MPI_Op that applies the per-segment MIN/MAX/SUM/...,
+   so different operations and types travel in the same message.
+
+   The reduction is posted with MPI_Iallreduce and the scheduler keeps
+   executing unrelated tasks until test() reports completion.  It needs
+   UINTAH_ENABLE_MPI3; without it SchedulerCommon turns fuse_reductions
+   off and the reduction tasks run one by one as before.
+
+   Which reduction tasks are fused is decided when the taskgraph is
+   compiled (see TaskGraph::assignFusedReductionPhases) so that every
+   rank fuses the same set, in the same order.
+
+ ****************************************/
+
+class FusedReduction {
+
+  public:
+
+    FusedReduction();
+
+    ~FusedReduction();
+
+    /// Adds the variables reduced by the (Task::Reduction) task.
+    /// Returns false if one of them uses an MPI type or operation that
+    /// cannot be fused; nothing is added in that case.
+    bool addTask( DetailedTask* task, std::vector<OnDemandDataWarehouseP>& dws );
+
+    /// Packs the variables and posts the allreduce on comm.
+    void start( MPI_Comm comm );
+
+    /// Returns true once the allreduce has completed.
+    bool test();
+
+    /// Blocks until the allreduce completes, unpacks the results and
+    /// marks the fused tasks as done.
+    void finish( std::vector<OnDemandDataWarehouseP>& dws );
+
+    bool isStarted() const { return d_started; }
+
+    const std::vector<DetailedTask*>& getTasks() const { return d_tasks; }
+
+    /// Frees the user-defined MPI_Op; it is created again on the next start().
+    /// Must not be called while a fused reduction is in flight.
+    static void freeOp();
+
+  private:
+
+    struct Segment {
+      int  type;
+      int  op;
+      int  count;
+      int  bytes;
+      int  countPerVar;
+      std::vector<ReductionVariableBase*> vars;
+    };
+
+    FusedReduction( const FusedReduction& );
+    FusedReduction& operator=( const FusedReduction& );
+
+    std::vector<DetailedTask*> d_tasks;
+    std::vector<Segment>       d_segments;
+    std::vector<char>          d_sendbuf;
+    std::vector<char>          d_recvbuf;
+    MPI_Datatype               d_datatype;
+    MPI_Request                d_request;
+    bool                       d_started;
+    bool                       d_complete;
+};
+
+} // End namespace Uintah
+
+#endif // End CCA_COMPONENTS_SCHEDULERS_FUSEDREDUCTION_H
@@ -0,0 +1,319 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <CCA/Components/Schedulers/GhostRegionCache.h>
+
+#include <Core/Grid/Grid.h>
+#include <Core/Grid/Level.h>
+#include <Core/Grid/Patch.h>
+#include <Core/Util/DebugStream.h>
+
+using namespace Uintah;
+using namespace std;
+
+static DebugStream grcdbg( "GhostRegionCache", false );
+
+namespace {
+
+  bool lessThan( const IntVector& a, const IntVector& b )
+  {
+    if (a.x() != b.x()) {
+      return a.x() < b.x();
+    }
+    if (a.y() != b.y()) {
+      return a.y() < b.y();
+    }
+    return a.z() < b.z();
+  }
+
+  // do [l1, h1) and [l2, h2) overlap (inclusive of touching faces)?
+  bool touches( const IntVector& l1, const IntVector& h1,
+                const IntVector& l2, const IntVector& h2 )
+  {
+    for (int d = 0; d < 3; d++) {
+      if (h1[d] < l2[d] || h2[d] < l1[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int bcTypes( const Patch* patch )
+  {
+    int types = 0;
+    for (Patch::FaceType face = Patch::startFace; face <= Patch::endFace; face = Patch::nextFace(face)) {
+      types |= patch->getBCType(face) << (2 * face);
+    }
+    return types;
+  }
+
+}
+
+//______________________________________________________________________
+//
+bool
+GhostRegionCache::ExtentsCompare::operator()( const Extents& a, const Extents& b ) const
+{
+  if (a.first != b.first) {
+    return lessThan(a.first, b.first);
+  }
+  return lessThan(a.second, b.second);
+}
+
+//______________________________________________________________________
+//
+bool
+GhostRegionCache::Key::operator<( const Key& other ) const
+{
+  if (basis != other.basis) {
+    return basis < other.basis;
+  }
+  if (patchLow != other.patchLow) {
+    return lessThan(patchLow, other.patchLow);
+  }
+  if (patchHigh != other.patchHigh) {
+    return lessThan(patchHigh, other.patchHigh);
+  }
+  if (low != other.low) {
+    return lessThan(low, other.low);
+  }
+  if (high != other.high) {
+    return lessThan(high, other.high);
+  }
+  return lessThan(boundaryLayer, other.boundaryLayer);
+}
+
+//______________________________________________________________________
+//
+GhostRegionCache::GhostRegionCache()
+  : d_hits(0), d_misses(0), d_evictions(0)
+{
+}
+
+//______________________________________________________________________
+//
+GhostRegionCache::~GhostRegionCache()
+{
+}
+
+//______________________________________________________________________
+//
+void
+GhostRegionCache::clear()
+{
+  d_levels.clear();
+}
+
+//______________________________________________________________________
+//
+void
+GhostRegionCache::update( const Grid* grid )
+{
+  int numLevels = grid->numLevels();
+
+  // levels that no longer exist take their entries with them
+  if ((int)d_levels.size() > numLevels) {
+    for (unsigned i = numLevels; i < d_levels.size(); i++) {
+      d_evictions += d_levels[i].entries.size();
+    }
+    d_levels.resize(numLevels);
+  }
+
+  for (int l = 0; l < numLevels; l++) {
+    const Level* level = grid->getLevel(l).get_rep();
+
+    PatchMap newPatches;
+    for (Level::const_patchIterator iter = level->patchesBegin(); iter != level->patchesEnd(); iter++) {
+      const Patch* patch = *iter;
+      PatchState state = { patch, bcTypes(patch) };
+      newPatches[make_pair(patch->getCellLowIndex(), patch->getCellHighIndex())] = state;
+    }
+
+    if (l == (int)d_levels.size()) {
+      LevelData data;
+      data.dcell      = level->dCell();
+      data.anchor     = level->getAnchor();
+      data.extraCells = level->getExtraCells();
+      data.patches.swap(newPatches);
+      d_levels.push_back(data);
+      continue;
+    }
+
+    LevelData& data = d_levels[l];
+
+    // a different index space invalidates everything on this level
+    if (data.dcell != level->dCell() || data.anchor != level->getAnchor() || data.extraCells != level->getExtraCells()) {
+      d_evictions += data.entries.size();
+      data.entries.clear();
+      data.dcell      = level->dCell();
+      data.anchor     = level->getAnchor();
+      data.extraCells = level->getExtraCells();
+      data.patches.swap(newPatches);
+      continue;
+    }
+
+    // patches present in only one of the two layouts, and patches present
+    // in both whose faces changed between neighbor and boundary
+    vector<Extents> changed;
+    vector<Extents> bcChanged;
+    PatchMap::const_iterator oldIter = data.patches.begin();
+    PatchMap::const_iterator newIter = newPatches.begin();
+    ExtentsCompare less;
+    while (oldIter != data.patches.end() || newIter != newPatches.end()) {
+      if (newIter == newPatches.end() || (oldIter != data.patches.end() && less(oldIter->first, newIter->first))) {
+        changed.push_back(oldIter->first);
+        oldIter++;
+      }
+      else if (oldIter == data.patches.end() || less(newIter->first, oldIter->first)) {
+        changed.push_back(newIter->first);
+        newIter++;
+      }
+      else {
+        if (oldIter->second.bcTypes != newIter->second.bcTypes) {
+          bcChanged.push_back(oldIter->first);
+        }
+        oldIter++;
+        newIter++;
+      }
+    }
+
+    if (changed.size() + bcChanged.size() > MAX_CHANGED_PATCHES) {
+      d_evictions += data.entries.size();
+      data.entries.clear();
+    }
+    else if (!changed.empty() || !bcChanged.empty()) {
+      for (EntryMap::iterator iter = data.entries.begin(); iter != data.entries.end();) {
+        bool invalid = false;
+        for (unsigned i = 0; i < changed.size() && !invalid; i++) {
+          // touching faces count, as node and face based regions reach one past the cells
+          invalid = touches(iter->first.low, iter->first.high, changed[i].first, changed[i].second);
+        }
+        // the part of such a patch a ghost region can be served from grows or
+        // shrinks by its extra cells (or the boundary layer) on the flipped faces
+        IntVector reach = Max(level->getExtraCells(), iter->first.boundaryLayer);
+        for (unsigned i = 0; i < bcChanged.size() && !invalid; i++) {
+          invalid = touches(iter->first.low, iter->first.high, bcChanged[i].first - reach, bcChanged[i].second + reach);
+        }
+        if (invalid) {
+          data.entries.erase(iter++);
+          d_evictions++;
+        }
+        else {
+          iter++;
+        }
+      }
+    }
+
+    // the patch objects are new even when the extents are not
+    data.patches.swap(newPatches);
+
+    if (grcdbg.active()) {
+      grcdbg << "GhostRegionCache: level " << l << " changed patches: " << changed.size()
+             << ", changed boundary types: " << bcChanged.size()
+             << ", cached entries kept: " << data.entries.size() << "\n";
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+bool
+GhostRegionCache::find( const Patch*               patch,
+                              int                  basis,
+                        const IntVector&           boundaryLayer,
+                        const IntVector&           low,
+                        const IntVector&           high,
+                              vector<GhostRegion>& regions ) const
+{
+  int l = patch->getLevel()->getIndex();
+  if (l >= (int)d_levels.size()) {
+    d_misses++;
+    return false;
+  }
+  const LevelData& data = d_levels[l];
+
+  Key key;
+  key.patchLow      = patch->getCellLowIndex();
+  key.patchHigh     = patch->getCellHighIndex();
+  key.low           = low;
+  key.high          = high;
+  key.boundaryLayer = boundaryLayer;
+  key.basis         = basis;
+
+  EntryMap::const_iterator iter = data.entries.find(key);
+  if (iter == data.entries.end()) {
+    d_misses++;
+    return false;
+  }
+
+  const vector<Region>& cached = iter->second;
+  regions.resize(cached.size());
+  for (unsigned i = 0; i < cached.size(); i++) {
+    PatchMap::const_iterator p = data.patches.find(make_pair(cached[i].neighborLow, cached[i].neighborHigh));
+    if (p == data.patches.end()) {
+      // should have been evicted in update(), recompute to be safe
+      regions.clear();
+      d_misses++;
+      return false;
+    }
+    regions[i].neighbor = p->second.patch;
+    regions[i].low      = cached[i].low;
+    regions[i].high     = cached[i].high;
+  }
+  d_hits++;
+  return true;
+}
+
+//______________________________________________________________________
+//
+void
+GhostRegionCache::insert( const Patch*               patch,
+                                int                  basis,
+                          const IntVector&           boundaryLayer,
+                          const IntVector&           low,
+                          const IntVector&           high,
+                          const vector<GhostRegion>& regions )
+{
+  int l = patch->getLevel()->getIndex();
+  if (l >= (int)d_levels.size()) {
+    return;
+  }
+
+  Key key;
+  key.patchLow      = patch->getCellLowIndex();
+  key.patchHigh     = patch->getCellHighIndex();
+  key.low           = low;
+  key.high          = high;
+  key.boundaryLayer = boundaryLayer;
+  key.basis         = basis;
+
+  vector<Region>& cached = d_levels[l].entries[key];
+  cached.resize(regions.size());
+  for (unsigned i = 0; i < regions.size(); i++) {
+    cached[i].neighborLow  = regions[i].neighbor->getCellLowIndex();
+    cached[i].neighborHigh = regions[i].neighbor->getCellHighIndex();
+    cached[i].low          = regions[i].low;
+    cached[i].high         = regions[i].high;
+  }
+}
@@ -0,0 +1,185 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CCA_COMPONENTS_SCHEDULERS_GHOSTREGIONCACHE_H
+#define CCA_COMPONENTS_SCHEDULERS_GHOSTREGIONCACHE_H
+
+#include <Core/Geometry/IntVector.h>
+#include <Core/Geometry/Point.h>
+#include <Core/Geometry/Vector.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace Uintah {
+
+class Grid;
+class Patch;
+
+/**************************************
+
+ CLASS
+   GhostRegionCache
+
+ GENERAL INFORMATION
+
+   GhostRegionCache.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+ KEYWORDS
+   TaskGraph, Regridding, Incremental Compile
+
+ DESCRIPTION
+   Remembers the geometric part of TaskGraph::createDetailedDependencies
+   (which neighbor patches a ghost region touches and the culled region
+   required from each one) across taskgraph compiles.
+
+   Tasks and patches are recreated on every recompile, so entries are
+   keyed on grid-invariant quantities (level index and cell extents)
+   rather than on Patch pointers.  When the grid changes, update() diffs
+   the old and new patch layouts level by level and evicts only the
+   entries whose ghost region touches a patch that was added or removed,
+   or comes within reach of a patch whose face boundary types changed.
+   (A neighbor's extra cells and boundary layer are clipped by whether
+   each of its faces has a neighbor, which a patch added anywhere along
+   that face can flip.)
+   Dependencies for patches away from the regridded region are then
+   replayed from the cache instead of being searched for again.
+
+ WARNING
+   Only same-level ghost dependencies (Task::ThisLevel) that do not touch
+   periodic (virtual) patches are cached.
+
+ ****************************************/
+
+class GhostRegionCache {
+
+  public:
+
+    /// A region required from a neighboring (real) patch.
+    struct GhostRegion {
+      const Patch* neighbor;
+      IntVector    low;
+      IntVector    high;
+    };
+
+    GhostRegionCache();
+
+    ~GhostRegionCache();
+
+    /// Diff the patch layout of grid against the layout seen on the
+    /// previous call and evict the entries invalidated by the change.
+    void update( const Grid* grid );
+
+    /// Returns true and fills regions if a valid entry exists for the
+    /// ghost region [low, high) of patch.
+    bool find( const Patch*               patch,
+                     int                  basis,
+               const IntVector&           boundaryLayer,
+               const IntVector&           low,
+               const IntVector&           high,
+                     std::vector<GhostRegion>& regions ) const;
+
+    void insert( const Patch*                    patch,
+                       int                       basis,
+                 const IntVector&                boundaryLayer,
+                 const IntVector&                low,
+                 const IntVector&                high,
+                 const std::vector<GhostRegion>& regions );
+
+    /// Drop every entry (e.g. when the cache is turned off).
+    void clear();
+
+    unsigned long numHits()      const { return d_hits; }
+    unsigned long numMisses()    const { return d_misses; }
+    unsigned long numEvictions() const { return d_evictions; }
+
+    void resetCounters() { d_hits = d_misses = d_evictions = 0; }
+
+  private:
+
+    typedef std::pair<IntVector, IntVector> Extents;
+
+    struct ExtentsCompare {
+      bool operator()( const Extents& a, const Extents& b ) const;
+    };
+
+    struct Key {
+      IntVector patchLow;
+      IntVector patchHigh;
+      IntVector low;
+      IntVector high;
+      IntVector boundaryLayer;
+      int       basis;
+
+      bool operator<( const Key& other ) const;
+    };
+
+    struct Region {
+      IntVector neighborLow;
+      IntVector neighborHigh;
+      IntVector low;
+      IntVector high;
+    };
+
+    // a patch and the boundary type of each of its faces, 2 bits per face
+    struct PatchState {
+      const Patch* patch;
+      int          bcTypes;
+    };
+
+    typedef std::map<Key, std::vector<Region> >          EntryMap;
+    typedef std::map<Extents, PatchState, ExtentsCompare> PatchMap;
+
+    struct LevelData {
+      Vector    dcell;
+      Point     anchor;
+      IntVector extraCells;
+      PatchMap  patches;
+      EntryMap  entries;
+    };
+
+    // beyond this many added/removed patches on a level, evicting entry by
+    // entry costs more than it saves, so the whole level is dropped
+    static const unsigned int MAX_CHANGED_PATCHES = 64;
+
+    GhostRegionCache( const GhostRegionCache& );
+    GhostRegionCache& operator=( const GhostRegionCache& );
+
+    std::vector<LevelData> d_levels;
+
+    mutable unsigned long d_hits;
+    mutable unsigned long d_misses;
+    unsigned long         d_evictions;
+};
+
+} // End namespace Uintah
+
+#endif // End CCA_COMPONENTS_SCHEDULERS_GHOSTREGIONCACHE_H
@@ -27,13 +27,17 @@
 #include <CCA/Components/Schedulers/SendState.h>
 #include <CCA/Components/Schedulers/CommRecMPI.h>
 #include <CCA/Components/Schedulers/DetailedTasks.h>
+#include <CCA/Components/Schedulers/FusedReduction.h>
+#include <CCA/Components/Schedulers/NodeMailbox.h>
 #include <CCA/Components/Schedulers/TaskGraph.h>
 #include <CCA/Ports/LoadBalancer.h>
 #include <CCA/Ports/Output.h>
 
+#include <Core/Grid/Variables/BlockRange.hpp>
 #include <Core/Grid/Variables/ParticleSubset.h>
 #include <Core/Grid/Variables/ComputeSet.h>
 #include <Core/Malloc/Allocator.h>
+#include <Core/Parallel/Parallel.h>
 #include <Core/Parallel/ProcessorGroup.h>
 #include <Core/Parallel/CrowdMonitor.hpp>
 #include <Core/Util/Time.h>
@@ -92,6 +96,20 @@ static double CurrentWaitTime = 0;
 std::map<std::string, double> waittimes;
 std::map<std::string, double> exectimes;
 
+#ifdef UINTAH_ENABLE_KOKKOS
+namespace {
+
+  // PackBufferInfo::PackLoop over the Kokkos OpenMP threads
+  void parallelPackLoop( int n, const std::function<void(int)>& body )
+  {
+    Uintah::parallel_for(BlockRange(IntVector(0, 0, 0), IntVector(1, 1, n)), [&](int, int, int c) {
+      body(c);
+    });
+  }
+
+}
+#endif //UINTAH_ENABLE_KOKKOS
+
 //______________________________________________________________________
 //
 MPIScheduler::MPIScheduler( const ProcessorGroup* myworld,
@@ -100,8 +118,11 @@ MPIScheduler::MPIScheduler( const ProcessorGroup* myworld,
   : SchedulerCommon(myworld, oport),
     parentScheduler_(parentScheduler),
     oport_(oport),
+    mailbox_(0),
     numMessages_(0),
-    messageVolume_(0)
+    messageVolume_(0),
+    numIntraNodeMessages_(0),
+    intraNodeMessageVolume_(0)
 {
 #ifdef UINTAH_ENABLE_KOKKOS
   Kokkos::initialize();
@@ -145,6 +166,76 @@ MPIScheduler::problemSetup( const ProblemSpecP&     prob_spec,
                                   SimulationStateP& state )
 {
   SchedulerCommon::problemSetup(prob_spec, state);
+  setupNodeMailbox(prob_spec);
+
+  // this scheduler packs and unpacks every message on the main thread;
+  // with Kokkos the OpenMP threads share the copies of the large ones.
+  // Without it parallel_for is serial and there are no threads to share
+  // them with, so the copies are serial as well.
+  ProblemSpecP params = prob_spec->findBlock("Scheduler");
+  bool explicitPacking = false;
+  if (params) {
+    params->getWithDefault("explicit_packing", explicitPacking, false);
+  }
+  if (explicitPacking) {
+#ifdef UINTAH_ENABLE_KOKKOS
+    int parallelBytes = 262144;
+    params->getWithDefault("parallel_pack_bytes", parallelBytes, parallelBytes);
+    PackBufferInfo::setExplicitPacking(true, parallelBytes, parallelPackLoop);
+#else
+    if (params->findBlock("parallel_pack_bytes")) {
+      proc0cout << "WARNING: <Scheduler><parallel_pack_bytes> is ignored: messages are packed serially"
+                << " in builds without Kokkos\n";
+    }
+    PackBufferInfo::setExplicitPacking(true);
+#endif
+  }
+}
+
+//______________________________________________________________________
+//
+void
+MPIScheduler::setupNodeMailbox( const ProblemSpecP& prob_spec )
+{
+  ProblemSpecP params = prob_spec->findBlock("Scheduler");
+  ProblemSpecP mailbox = 0;
+  if (params) {
+    mailbox = params->findBlock("node_mailbox");
+  }
+  // subschedulers share the mailbox of the top level scheduler
+  if (!mailbox || mailbox_ || parentScheduler_ || !Uintah::Parallel::usingMPI()) {
+    return;
+  }
+
+  int slots    = 4;
+  int slotSize = 65536;
+  mailbox->getWithDefault("slots",     slots,    slots);
+  mailbox->getWithDefault("slot_size", slotSize, slotSize);
+
+#if UINTAH_ENABLE_MPI3
+  if (d_myworld->getNodeComm() == MPI_COMM_NULL) {
+    proc0cout << "   WARNING: no node communicator, node_mailbox is ignored\n";
+    return;
+  }
+
+  mailbox_ = scinew NodeMailbox(d_myworld, slots, slotSize);
+  proc0cout << "   Sending messages of up to " << slotSize << " bytes between the ranks of a node through shared memory ("
+            << slots << " slots per rank pair)\n";
+#else
+  proc0cout << "   WARNING: node_mailbox requires MPI-3 (UINTAH_ENABLE_MPI3) and is ignored\n";
+#endif
+}
+
+//______________________________________________________________________
+//
+NodeMailbox*
+MPIScheduler::nodeMailbox()
+{
+  MPIScheduler* top = this;
+  while (top->parentScheduler_) {
+    top = top->parentScheduler_;
+  }
+  return top->mailbox_;
 }
 
 //______________________________________________________________________
@@ -158,6 +249,11 @@ MPIScheduler::~MPIScheduler()
       maxStats.close();
     }
   }
+
+  delete mailbox_;
+
+  FusedReduction::freeOp();
+
 #ifdef UINTAH_ENABLE_KOKKOS
   Kokkos::finalize();
 #endif //UINTAH_ENABLE_KOKKOS
@@ -271,6 +367,73 @@ MPIScheduler::initiateReduction( DetailedTask* task )
   mpi_info_[TotalReduceMPI] += reduceend - reducestart;
 }
 
+//______________________________________________________________________
+//
+FusedReduction*
+MPIScheduler::startFusedReduction( const std::vector<DetailedTask*>& tasks )
+{
+  FusedReduction* fused = scinew FusedReduction();
+  DetailedTask* first = nullptr;
+
+  // every rank sees the same tasks in the same order, so the ones that
+  // cannot be fused are reduced individually in a consistent order
+  for (size_t i = 0; i < tasks.size(); i++) {
+    if (fused->addTask(tasks[i], dws)) {
+      if (!first) {
+        first = tasks[i];
+      }
+    }
+    else {
+      initiateReduction(tasks[i]);
+    }
+  }
+
+  if (!first) {
+    delete fused;
+    return nullptr;
+  }
+
+  if (reductionout.active() && d_myworld->myrank() == 0) {
+    coutLock.lock();
+    reductionout << "Running " << fused->getTasks().size() << " fused Reduction Tasks, starting with: " << first->getName() << std::endl;
+    coutLock.unlock();
+  }
+
+  double reducestart = Time::currentSeconds();
+
+  ASSERT(first->getTask()->d_comm >= 0);
+  fused->start(d_myworld->getgComm(first->getTask()->d_comm));
+
+  double reduceend = Time::currentSeconds();
+
+  mpi_info_[TotalReduce   ] += reduceend - reducestart;
+  mpi_info_[TotalReduceMPI] += reduceend - reducestart;
+
+  return fused;
+}
+
+//______________________________________________________________________
+//
+void
+MPIScheduler::finishFusedReduction( FusedReduction* fused )
+{
+  double reducestart = Time::currentSeconds();
+
+  fused->finish(dws);
+
+  double reduceend = Time::currentSeconds();
+
+  const std::vector<DetailedTask*>& tasks = fused->getTasks();
+  for (size_t i = 0; i < tasks.size(); i++) {
+    emitNode(tasks[i], reducestart, reduceend - reducestart, 0);
+  }
+
+  mpi_info_[TotalReduce   ] += reduceend - reducestart;
+  mpi_info_[TotalReduceMPI] += reduceend - reducestart;
+
+  delete fused;
+}
+
 //______________________________________________________________________
 //
 void
@@ -472,9 +635,18 @@ MPIScheduler::postMPISends( DetailedTask* task,
       MPI_Datatype datatype;
 
 #ifdef USE_PACKING
-      mpibuff.get_type(buf, count, datatype, d_myworld->getComm());
-      mpibuff.pack(d_myworld->getComm(), count);
+      // on the node, pack straight into the receiver's mailbox if it fits
+      NodeMailbox* mailbox = nodeMailbox();
+      bool delivered = mailbox && mailbox->onNode(to) && mailbox->send(to, batch->messageTag, mpibuff, count);
+      if (delivered) {
+        datatype = MPI_PACKED;
+      }
+      else {
+        mpibuff.get_type(buf, count, datatype, d_myworld->getComm());
+        mpibuff.pack(d_myworld->getComm(), count);
+      }
 #else
+      bool delivered = false;
       mpibuff.get_type(buf, count, datatype);
 #endif
 
@@ -497,8 +669,17 @@ MPIScheduler::postMPISends( DetailedTask* task,
 
       Uintah::MPI::Type_size(datatype, &typeSize);
       messageVolume_ += count * typeSize;
+      if (d_myworld->onMyNode(to)) {
+        numIntraNodeMessages_++;
+        intraNodeMessageVolume_ += count * typeSize;
+      }
       volSend += count * typeSize;
 
+      if (delivered) {
+        mpi_info_[TotalSendMPI] += Time::currentSeconds() - start;
+        continue;
+      }
+
       MPI_Request requestid;
       Uintah::MPI::Isend(buf, count, datatype, to, batch->messageTag, d_myworld->getComm(), &requestid);
       int bytes = count;
@@ -542,9 +723,11 @@ MPIScheduler::postMPISends( DetailedTask* task,
 //
 int MPIScheduler::pendingMPIRecvs()
 {
+  NodeMailbox* mailbox = nodeMailbox();
+
   recv_monitor send_lock{ Uintah::CrowdMonitor<recv_tag>::READER };
   {
-    return recvs_.numRequests();
+    return recvs_.numRequests() + (mailbox ? mailbox->numPending(recvs_) : 0);
   }
 }
 
@@ -714,7 +897,25 @@ void MPIScheduler::postMPIRecvs( DetailedTask* task,
         int count;
         MPI_Datatype datatype;
 
+        int from = batch->fromTask->getAssignedResourceIndex();
+        ASSERTRANGE(from, 0, d_myworld->size());
+
 #ifdef USE_PACKING
+        // on the node, the message is unpacked straight from the mailbox
+        // (or received with MPI if the sender could not use it)
+        NodeMailbox* mailbox = nodeMailbox();
+        if (mailbox && mailbox->onNode(from)) {
+          if (mpidbg.active()) {
+            cerrLock.lock();
+            mpidbg << "Rank-" << d_myworld->myrank() << " Posting mailbox recv for message number " << batch->messageTag
+                   << " from rank-" << from << '\n';
+            cerrLock.unlock();
+          }
+          mailbox->postRecv(from, batch->messageTag, p_mpibuff, pBatchRecvHandler, ostr.str(), recvs_);
+          mpi_info_[TotalRecvMPI] += Time::currentSeconds() - start;
+          continue;
+        }
+
         mpibuff.get_type(buf, count, datatype, d_myworld->getComm());
 #else
         mpibuff.get_type(buf, count, datatype);
@@ -725,8 +926,6 @@ void MPIScheduler::postMPIRecvs( DetailedTask* task,
         //if(count>0)
         //{
 
-        int from = batch->fromTask->getAssignedResourceIndex();
-        ASSERTRANGE(from, 0, d_myworld->size());
         MPI_Request requestid;
 
         if (mpidbg.active()) {
@@ -774,7 +973,8 @@ void MPIScheduler::processMPIRecvs(int how_much)
   // Should only have external receives in the MixedScheduler version which
   // shouldn't use this function.
   // ASSERT(outstandingExtRecvs.empty());
-  if (recvs_.numRequests() == 0) {
+  NodeMailbox* mailbox = nodeMailbox();
+  if (recvs_.numRequests() == 0 && (!mailbox || mailbox->numPending(recvs_) == 0)) {
     return;
   }
 
@@ -784,6 +984,9 @@ void MPIScheduler::processMPIRecvs(int how_much)
   {
     switch (how_much) {
       case TEST :
+        if (mailbox) {
+          mailbox->progress(recvs_);
+        }
         recvs_.testsome(d_myworld);
         break;
       case WAIT_ONCE :
@@ -791,7 +994,22 @@ void MPIScheduler::processMPIRecvs(int how_much)
         mpidbg << "Rank-" << d_myworld->myrank() << " Start waiting once (WAIT_ONCE)...\n";
         coutLock.unlock();
 
-        recvs_.waitsome(d_myworld);
+        if (mailbox && mailbox->numPending(recvs_) > 0) {
+          // nothing to block on for the mailbox, so poll both until something arrives
+          for (;;) {
+            if (mailbox->progress(recvs_) > 0) {
+              break;
+            }
+            unsigned long pending = recvs_.numRequests();
+            recvs_.testsome(d_myworld);
+            if (recvs_.numRequests() < pending) {
+              break;
+            }
+          }
+        }
+        else {
+          recvs_.waitsome(d_myworld);
+        }
 
         coutLock.lock();
         mpidbg << "Rank-" << d_myworld->myrank() << " Done waiting once (WAIT_ONCE)...\n";
@@ -804,7 +1022,12 @@ void MPIScheduler::processMPIRecvs(int how_much)
         mpidbg << "Rank-" << d_myworld->myrank() << "  Start waiting (WAIT_ALL)...\n";
         coutLock.unlock();
 
-        while ((recvs_.numRequests() > 0)) {
+        while ((recvs_.numRequests() > 0) || (mailbox && mailbox->numPending(recvs_) > 0)) {
+          if (mailbox && mailbox->numPending(recvs_) > 0) {
+            mailbox->progress(recvs_);
+            recvs_.testsome(d_myworld);
+            continue;
+          }
           bool keep_waiting = recvs_.waitsome(d_myworld);
           if (!keep_waiting) {
             break;
@@ -891,10 +1114,45 @@ MPIScheduler::execute( int tgnum     /* = 0 */,
     dws[dwmap[Task::OldDW]]->exchangeParticleQuantities(dts, getLoadBalancer(), reloc_new_posLabel_, iteration);
   }
 
+  // With fused reductions, the reduction tasks of a phase are held back until
+  // all of them are ready and then reduced together, one phase at a time and
+  // in phase order on every rank.  Other tasks keep running in the meantime.
+  std::map<int, int> phaseReductions;
+  std::map<int, std::vector<DetailedTask*> > pendingReductions;
+  FusedReduction* fusedReduction = nullptr;
+
+  if (fuseReductions()) {
+    for (int i = 0; i < ntasks; i++) {
+      DetailedTask* task = dts->localTask(i);
+      if (task->getTask()->getType() == Task::Reduction) {
+        phaseReductions[task->getTask()->d_phase]++;
+      }
+    }
+  }
+
   int i = 0;
   while (numTasksDone < ntasks) {
     i++;
 
+    // nothing else can run until the posted reduction completes, or until
+    // the receives the remaining tasks wait on have arrived
+    if (dts->numInternalReadyTasks() == 0) {
+      if (fusedReduction) {
+        finishFusedReduction(fusedReduction);
+        fusedReduction = nullptr;
+      }
+      else if (recvs_.numRequests() > 0) {
+        processMPIRecvs(WAIT_ONCE);
+      }
+      else {
+        std::ostringstream msg;
+        msg << "MPIScheduler: no task is ready, " << ntasks - numTasksDone << " tasks left and "
+            << pendingReductions.size() << " reduction phase(s) waiting on tasks that cannot run";
+        throw InternalError(msg.str(), __FILE__, __LINE__);
+      }
+      continue;
+    }
+
     //
     // The following checkMemoryUse() is commented out to allow for
     // maintaining the same functionality as before this commit...
@@ -927,7 +1185,25 @@ MPIScheduler::execute( int tgnum     /* = 0 */,
     }
 
     if (task->getTask()->getType() == Task::Reduction) {
-      if (!abort) {
+      if (!abort && !phaseReductions.empty()) {
+        pendingReductions[task->getTask()->d_phase].push_back(task);
+
+        // start every phase, lowest first, whose reduction tasks are all ready
+        while (!phaseReductions.empty()) {
+          std::map<int, int>::iterator next = phaseReductions.begin();
+          std::vector<DetailedTask*>& group = pendingReductions[next->first];
+          if ((int)group.size() < next->second) {
+            break;
+          }
+          if (fusedReduction) {
+            finishFusedReduction(fusedReduction);
+          }
+          fusedReduction = startFusedReduction(group);
+          pendingReductions.erase(next->first);
+          phaseReductions.erase(next);
+        }
+      }
+      else if (!abort) {
         initiateReduction(task);
       }
     }
@@ -945,6 +1221,11 @@ MPIScheduler::execute( int tgnum     /* = 0 */,
       }
     }
 
+    if (fusedReduction && fusedReduction->test()) {
+      finishFusedReduction(fusedReduction);
+      fusedReduction = nullptr;
+    }
+
     if(!abort && dws[dws.size()-1] && dws[dws.size()-1]->timestepAborted()){
       abort = true;
       abort_point = task->getTask()->getSortedOrder();
@@ -952,6 +1233,10 @@ MPIScheduler::execute( int tgnum     /* = 0 */,
     }
   } // end while( numTasksDone < ntasks )
 
+  if (fusedReduction) {
+    finishFusedReduction(fusedReduction);
+  }
+
   if (timeout.active()) {
     emitTime("MPI send time", mpi_info_[TotalSendMPI]);
     emitTime("MPI Testsome time", mpi_info_[TotalTestMPI]);
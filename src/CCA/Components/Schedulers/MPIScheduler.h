@@ -45,6 +45,8 @@ namespace Uintah {
 
 static DebugStream mpi_stats("MPIStats", false);
 
+class FusedReduction;
+class NodeMailbox;
 class Task;
 
 /**************************************
@@ -105,6 +107,8 @@ class MPIScheduler : public SchedulerCommon {
     void compile() {
       numMessages_   = 0;
       messageVolume_ = 0;
+      numIntraNodeMessages_   = 0;
+      intraNodeMessageVolume_ = 0;
       SchedulerCommon::compile();
     }
 
@@ -122,9 +126,21 @@ class MPIScheduler : public SchedulerCommon {
         Uintah::MPI::Reduce(&numMessages_,&max_messages,1,MPI_UNSIGNED,MPI_MAX,0,d_myworld->getComm());
         Uintah::MPI::Reduce(&messageVolume_,&max_volume,1,MPI_DOUBLE,MPI_MAX,0,d_myworld->getComm());
 
+        // the part of the above that stays on a node
+        unsigned int total_intra_messages;
+        double total_intra_volume;
+        Uintah::MPI::Reduce(&numIntraNodeMessages_,&total_intra_messages,1,MPI_UNSIGNED,MPI_SUM,0,d_myworld->getComm());
+        Uintah::MPI::Reduce(&intraNodeMessageVolume_,&total_intra_volume,1,MPI_DOUBLE,MPI_SUM,0,d_myworld->getComm());
+
         if( d_myworld->myrank() == 0 ) {
           mpi_stats << "MPIStats: Num Messages (avg): " << total_messages/(float)d_myworld->size() << " (max):" << max_messages << std::endl;
           mpi_stats << "MPIStats: Message Volume (avg): " << total_volume/(float)d_myworld->size() << " (max):" << max_volume << std::endl;
+
+          double intra_fraction = total_volume > 0 ? total_intra_volume / total_volume : 0;
+          mpi_stats << "MPIStats: Intra-node Messages: " << total_intra_messages << " Volume: " << total_intra_volume
+                    << " (" << 100 * intra_fraction << "%), Inter-node Messages: " << total_messages - total_intra_messages
+                    << " Volume: " << total_volume - total_intra_volume << " (" << 100 * (1 - intra_fraction) << "%)"
+                    << " on " << d_myworld->numNodes() << " nodes" << std::endl;
         }
       }
     }
@@ -153,6 +169,14 @@ class MPIScheduler : public SchedulerCommon {
     // Performs the reduction task. (In threaded schdeulers, a single worker thread will execute this.)
     virtual void initiateReduction( DetailedTask* task );
 
+    // Reduces the (independent) reduction tasks of one task phase together.
+    // Tasks whose variables cannot be fused are reduced individually first.
+    // Returns the posted fused reduction, or null if nothing was fused.
+    FusedReduction* startFusedReduction( const std::vector<DetailedTask*>& tasks );
+
+    // Completes a reduction returned by startFusedReduction and deletes it.
+    void finishFusedReduction( FusedReduction* fused );
+
     enum {
       TEST,
       WAIT_ONCE,
@@ -171,9 +195,17 @@ class MPIScheduler : public SchedulerCommon {
 
     void outputTimingStats( const char* label );
 
+    // Sets up the shared memory path for the messages between ranks of a
+    // node, if <Scheduler><node_mailbox> is given.  Collective.
+    void setupNodeMailbox( const ProblemSpecP& prob_spec );
+
+    // The mailbox of the top level scheduler (null if not used)
+    NodeMailbox* nodeMailbox();
+
     const Output*               oport_;
     CommRecMPI                  sends_[MAX_THREADS];
     CommRecMPI                  recvs_;
+    NodeMailbox*                mailbox_;
 
     double                      d_lasttime;
     std::vector<const char*>    d_labels;
@@ -185,6 +217,8 @@ class MPIScheduler : public SchedulerCommon {
 
     unsigned int                numMessages_;
     double                      messageVolume_;
+    unsigned int                numIntraNodeMessages_;
+    double                      intraNodeMessageVolume_;
 
     std::mutex                  dlbLock{};                // load balancer lock
     std::mutex                  waittimesLock{};          // MPI wait times lock
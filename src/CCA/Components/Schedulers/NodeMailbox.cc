@@ -0,0 +1,386 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <CCA/Components/Schedulers/NodeMailbox.h>
+
+#include <Core/Exceptions/InternalError.h>
+#include <Core/Malloc/Allocator.h>
+#include <Core/Parallel/Parallel.h>
+#include <Core/Parallel/ProcessorGroup.h>
+#include <Core/Util/DebugStream.h>
+
+#include <new>
+
+using namespace Uintah;
+
+static DebugStream mailboxdbg( "NodeMailbox", false );
+
+namespace {
+
+  enum SlotState {
+    EMPTY = 0,
+    WRITING,
+    FULL
+  };
+
+  // orders the loads and stores on the window's memory (no-op without MPI-3,
+  // where no window is ever created)
+  void syncWindow( MPI_Win win )
+  {
+#if UINTAH_ENABLE_MPI3
+    Uintah::MPI::Win_sync(win);
+#endif
+  }
+
+}
+
+//______________________________________________________________________
+//
+NodeMailbox::NodeMailbox( const ProcessorGroup* pg,
+                                int             slotsPerPeer,
+                                int             slotBytes )
+  : d_myworld(pg),
+    d_win(MPI_WIN_NULL),
+    d_slotsPerPeer(slotsPerPeer),
+    d_slotBytes(slotBytes)
+{
+#if UINTAH_ENABLE_MPI3
+  MPI_Comm nodeComm = pg->getNodeComm();
+  if (nodeComm == MPI_COMM_NULL) {
+    SCI_THROW(InternalError("NodeMailbox: the processor group has no node communicator", __FILE__, __LINE__));
+  }
+
+  Uintah::MPI::Comm_size(nodeComm, &d_nodeSize);
+  Uintah::MPI::Comm_rank(nodeComm, &d_nodeMe);
+
+  // header + data, rounded up to whole cache lines
+  d_slotStride = sizeof(Slot) + ((d_slotBytes + 63) / 64) * 64;
+
+  // each inbox in its own pages, next to its owner
+  MPI_Info info;
+  Uintah::MPI::Info_create(&info);
+  Uintah::MPI::Info_set(info, "alloc_shared_noncontig", "true");
+
+  MPI_Aint bytes = (MPI_Aint)d_nodeSize * d_slotsPerPeer * d_slotStride;
+  char*    base  = 0;
+  Uintah::MPI::Win_allocate_shared(bytes, 1, info, nodeComm, &base, &d_win);
+  Uintah::MPI::Info_free(&info);
+
+  d_inbox.resize(d_nodeSize);
+  for (int r = 0; r < d_nodeSize; r++) {
+    MPI_Aint size;
+    int      disp;
+    Uintah::MPI::Win_shared_query(d_win, r, &size, &disp, &d_inbox[r]);
+  }
+
+  // the window is accessed through loads and stores for its whole life
+  Uintah::MPI::Win_lock_all(MPI_MODE_NOCHECK, d_win);
+
+  for (int s = 0; s < d_nodeSize; s++) {
+    for (int i = 0; i < d_slotsPerPeer; i++) {
+      Slot* empty = new (slot(d_nodeMe, s, i)) Slot();
+      empty->state.store(EMPTY, std::memory_order_relaxed);
+    }
+  }
+
+  // every inbox has to be initialized before anyone sends
+  Uintah::MPI::Win_sync(d_win);
+  Uintah::MPI::Barrier(nodeComm);
+  Uintah::MPI::Win_sync(d_win);
+
+  // where the ranks of pg are in the node
+  MPI_Group worldGroup, nodeGroup;
+  Uintah::MPI::Comm_group(pg->getComm(), &worldGroup);
+  Uintah::MPI::Comm_group(nodeComm, &nodeGroup);
+
+  std::vector<int> worldRanks(pg->size());
+  for (int r = 0; r < pg->size(); r++) {
+    worldRanks[r] = r;
+  }
+  d_nodeRank.resize(pg->size());
+  Uintah::MPI::Group_translate_ranks(worldGroup, pg->size(), &worldRanks[0], nodeGroup, &d_nodeRank[0]);
+
+  d_worldRank.assign(d_nodeSize, MPI_UNDEFINED);
+  for (int r = 0; r < pg->size(); r++) {
+    if (d_nodeRank[r] != MPI_UNDEFINED) {
+      d_worldRank[d_nodeRank[r]] = r;
+    }
+  }
+
+  Uintah::MPI::Group_free(&worldGroup);
+  Uintah::MPI::Group_free(&nodeGroup);
+
+  d_sendHead.assign(d_nodeSize, 0);
+  d_recvTail.assign(d_nodeSize, 0);
+
+  if (mailboxdbg.active()) {
+    mailboxdbg << "Rank-" << pg->myrank() << " NodeMailbox: " << d_nodeSize << " ranks on the node, "
+               << d_slotsPerPeer << " slots of " << d_slotBytes << " bytes per rank, inbox " << bytes << " bytes\n";
+  }
+#else
+  SCI_THROW(InternalError("NodeMailbox requires MPI-3 shared memory windows (UINTAH_ENABLE_MPI3)", __FILE__, __LINE__));
+#endif
+}
+
+//______________________________________________________________________
+//
+NodeMailbox::~NodeMailbox()
+{
+  for (std::map<Key, Recv>::iterator iter = d_posted.begin(); iter != d_posted.end(); ++iter) {
+    delete iter->second.buffer;
+    delete iter->second.handler;
+  }
+
+#if UINTAH_ENABLE_MPI3
+  if (d_win != MPI_WIN_NULL) {
+    Uintah::MPI::Win_unlock_all(d_win);
+    Uintah::MPI::Win_free(&d_win);
+  }
+#endif
+}
+
+//______________________________________________________________________
+//
+bool
+NodeMailbox::send( int             to,
+                   int             tag,
+                   PackBufferInfo& buffer,
+                   int&            bytes )
+{
+  int  peer = d_nodeRank[to];
+  int  size = buffer.packedSize(d_myworld->getComm());
+  Slot* target;
+
+  {
+    std::lock_guard<std::mutex> lock(d_sendLock);
+
+    unsigned int seq = d_sendSeq[Channel(to, tag)]++;
+    if (size > d_slotBytes) {
+      return false;
+    }
+
+    target = slot(peer, d_nodeMe, d_sendHead[peer]);
+    if (target->state.load(std::memory_order_acquire) != EMPTY) {
+      return false;
+    }
+
+    // reserve it; the receiver only looks at full slots
+    target->state.store(WRITING, std::memory_order_relaxed);
+    target->tag = tag;
+    target->seq = seq;
+    d_sendHead[peer] = (d_sendHead[peer] + 1) % d_slotsPerPeer;
+  }
+
+  buffer.pack(target->data(), d_slotBytes, d_myworld->getComm(), bytes);
+  target->bytes = bytes;
+
+  // the data has to be visible in the window before the slot shows full
+  syncWindow(d_win);
+  target->state.store(FULL, std::memory_order_release);
+
+  return true;
+}
+
+//______________________________________________________________________
+//
+void
+NodeMailbox::complete(       Recv& recv,
+                       const void* data,
+                             int   bytes )
+{
+  // unpack before telling the DependencyBatch that the data is there
+  recv.buffer->unpack(data, bytes, d_myworld->getComm());
+  recv.handler->finishedCommunication(d_myworld);
+
+  delete recv.buffer;
+  delete recv.handler;
+}
+
+//______________________________________________________________________
+//
+void
+NodeMailbox::postRecv(       int                  from,
+                             int                  tag,
+                             PackBufferInfo*      buffer,
+                             BatchReceiveHandler* handler,
+                       const std::string&         vars,
+                             CommRecMPI&          recvs )
+{
+  std::lock_guard<std::mutex> lock(d_recvLock);
+
+  Key  key(from, tag, d_recvSeq[Channel(from, tag)]++);
+  Recv recv = { buffer, handler, vars, &recvs };
+
+  std::map<Key, std::vector<char> >::iterator early = d_early.find(key);
+  if (early != d_early.end()) {
+    complete(recv, early->second.data(), early->second.size());
+    d_early.erase(early);
+    return;
+  }
+
+  d_posted[key] = recv;
+}
+
+//______________________________________________________________________
+//
+int
+NodeMailbox::drain( const CommRecMPI& recvs )
+{
+  int done = 0;
+
+  for (int peer = 0; peer < d_nodeSize; peer++) {
+    int& tail = d_recvTail[peer];
+
+    for (;;) {
+      Slot* full = slot(d_nodeMe, peer, tail);
+      if (full->state.load(std::memory_order_acquire) != FULL) {
+        break;
+      }
+      // see the data the sender wrote before it marked the slot full
+      syncWindow(d_win);
+
+      // unpacked here only for the scheduler that posted the receive,
+      // otherwise kept until that scheduler asks for it
+      Key key(d_worldRank[peer], full->tag, full->seq);
+      std::map<Key, Recv>::iterator iter = d_posted.find(key);
+      if (iter != d_posted.end() && iter->second.owner == &recvs) {
+        complete(iter->second, full->data(), full->bytes);
+        d_posted.erase(iter);
+        done++;
+      }
+      else {
+        d_early[key].assign(full->data(), full->data() + full->bytes);
+      }
+
+      // done reading before the sender may reuse the slot
+      syncWindow(d_win);
+      full->state.store(EMPTY, std::memory_order_release);
+      tail = (tail + 1) % d_slotsPerPeer;
+    }
+  }
+
+  // messages set aside earlier, for a scheduler that was busy elsewhere
+  std::map<Key, Recv>::iterator iter = d_posted.begin();
+  while (iter != d_posted.end()) {
+    std::map<Key, std::vector<char> >::iterator early;
+    if (iter->second.owner != &recvs || (early = d_early.find(iter->first)) == d_early.end()) {
+      ++iter;
+      continue;
+    }
+    complete(iter->second, early->second.data(), early->second.size());
+    d_early.erase(early);
+    d_posted.erase(iter++);
+    done++;
+  }
+
+  return done;
+}
+
+//______________________________________________________________________
+//
+int
+NodeMailbox::progress( CommRecMPI& recvs )
+{
+  std::lock_guard<std::mutex> lock(d_recvLock);
+
+  int done = drain(recvs);
+
+#if UINTAH_ENABLE_MPI3
+  // the rest may have been sent with MPI
+  std::vector<Key> waiting;
+  for (std::map<Key, Recv>::iterator iter = d_posted.begin(); iter != d_posted.end(); ++iter) {
+    if (iter->second.owner == &recvs) {
+      waiting.push_back(iter->first);
+    }
+  }
+
+  for (unsigned int w = 0; w < waiting.size(); w++) {
+    const Key& key  = waiting[w];
+    int        from = std::get<0>(key);
+    int        tag  = std::get<1>(key);
+
+    std::map<Key, Recv>::iterator iter = d_posted.find(key);
+    if (iter == d_posted.end()) {
+      continue;
+    }
+
+    std::deque<MPI_Message>& probed = d_probed[Channel(from, tag)];
+    if (probed.empty()) {
+      int         flag = 0;
+      MPI_Message message;
+      MPI_Status  status;
+      Uintah::MPI::Improbe(from, tag, d_myworld->getComm(), &flag, &message, &status);
+      if (!flag) {
+        continue;
+      }
+      probed.push_back(message);
+
+      // whatever went through the mailbox before this message is visible
+      // by now; if that includes this receive's message, the MPI message
+      // is a later one and stays probed.
+      done += drain(recvs);
+      iter = d_posted.find(key);
+      if (iter == d_posted.end()) {
+        continue;
+      }
+    }
+
+    // otherwise the oldest probed message is this receive's
+    MPI_Message message = probed.front();
+    probed.pop_front();
+
+    Recv&        recv = iter->second;
+    void*        buf;
+    int          count;
+    MPI_Datatype datatype;
+    recv.buffer->get_type(buf, count, datatype, d_myworld->getComm());
+
+    MPI_Request requestid;
+    Uintah::MPI::Imrecv(buf, count, datatype, &message, &requestid);
+    recvs.add(requestid, count, scinew ReceiveHandler(recv.buffer, recv.handler), recv.vars, tag);
+
+    d_posted.erase(iter);
+    done++;
+  }
+#endif
+
+  return done;
+}
+
+//______________________________________________________________________
+//
+int
+NodeMailbox::numPending( const CommRecMPI& recvs )
+{
+  std::lock_guard<std::mutex> lock(d_recvLock);
+
+  int pending = 0;
+  for (std::map<Key, Recv>::const_iterator iter = d_posted.begin(); iter != d_posted.end(); ++iter) {
+    if (iter->second.owner == &recvs) {
+      pending++;
+    }
+  }
+  return pending;
+}
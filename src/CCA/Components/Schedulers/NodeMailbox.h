@@ -0,0 +1,196 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef CCA_COMPONENTS_SCHEDULERS_NODEMAILBOX_H
+#define CCA_COMPONENTS_SCHEDULERS_NODEMAILBOX_H
+
+#include <CCA/Components/Schedulers/CommRecMPI.h>
+#include <Core/Parallel/PackBufferInfo.h>
+
+#include <sci_defs/mpi_defs.h>
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Uintah {
+
+class ProcessorGroup;
+
+/**************************************
+
+ CLASS
+   NodeMailbox
+
+ GENERAL INFORMATION
+
+   NodeMailbox.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+ KEYWORDS
+   MPIScheduler, Shared Memory, Ghost Cells
+
+ DESCRIPTION
+   Moves the messages of DependencyBatches between ranks of the same
+   node through an MPI-3 shared memory window instead of MPI point to
+   point calls.
+
+   Every rank owns an inbox in the window with a small ring of slots for
+   each rank of its node.  The sender packs the ghost region straight
+   from its variables into a free slot of the receiver's inbox and marks
+   the slot full with an atomic store; the receiver unpacks straight
+   from the slot into its variables and marks it empty again.  No
+   intermediate message buffer is allocated on either side and MPI is
+   not involved.
+
+   A message that does not fit in a slot, or finds the receiver's ring
+   full, is sent with MPI as usual (with the same tag), so a sender
+   never waits for a receiver.  Both sides number the messages of each
+   (rank, tag) channel, which lets the receiver tell which one a slot or
+   a matched MPI message belongs to when a tag is reused before the
+   previous message was received.
+
+   A scheduler and its subschedulers share the mailbox of the top level
+   scheduler.  Every receive belongs to the receive records (CommRecMPI)
+   of the scheduler that posted it, and is unpacked or handed to MPI only
+   when that scheduler makes progress, so the receives of a parent never
+   complete inside a subscheduler.
+
+   Each rank holds a passive target epoch (MPI_Win_lock_all) on the
+   window for its lifetime.  The slot states are atomics; MPI_Win_sync
+   orders the slot data against them.
+
+ WARNING
+   The constructor and destructor are collective over the ranks of the
+   node.  Requires UINTAH_ENABLE_MPI3.
+
+ ****************************************/
+
+class NodeMailbox {
+
+  public:
+
+    NodeMailbox( const ProcessorGroup* pg, int slotsPerPeer, int slotBytes );
+
+    ~NodeMailbox();
+
+    // True if messages from/to rank can use the mailbox
+    bool onNode( int rank ) const { return d_nodeRank[rank] != MPI_UNDEFINED; }
+
+    int slotBytes() const { return d_slotBytes; }
+
+    // Packs the message into a slot of the inbox of "to".  Returns false
+    // (packing nothing) if it is too large or no slot is free; the caller
+    // must then send it with MPI.  Every message to an on-node rank has to
+    // go through here, whichever way it travels, to keep the numbering.
+    bool send( int to, int tag, PackBufferInfo& buffer, int& bytes );
+
+    // Takes ownership of buffer and handler; the batch is marked received
+    // once the message arrived and was unpacked.  recvs are the receive
+    // records of the posting scheduler, the only ones to complete it.
+    void postRecv( int from, int tag, PackBufferInfo* buffer, BatchReceiveHandler* handler, const std::string& vars,
+                   CommRecMPI& recvs );
+
+    // Unpacks the messages of the receives posted with recvs that arrived
+    // in this rank's inbox, and posts into recvs the receives of those that
+    // were sent with MPI.  Messages for other schedulers are set aside.
+    // Returns the number of receives completed (or handed to recvs).
+    int progress( CommRecMPI& recvs );
+
+    // Receives posted with recvs still waiting in the mailbox
+    int numPending( const CommRecMPI& recvs );
+
+  private:
+
+    struct Slot {
+      std::atomic<int> state;
+      int              tag;
+      int              bytes;
+      unsigned int     seq;
+      char             pad[48];   // keep the data cache line aligned
+
+      char* data() { return reinterpret_cast<char*>(this) + sizeof(Slot); }
+    };
+
+    struct Recv {
+      PackBufferInfo*      buffer;
+      BatchReceiveHandler* handler;
+      std::string          vars;
+      const CommRecMPI*    owner;
+    };
+
+    typedef std::pair<int, int>                     Channel;   // (rank, tag)
+    typedef std::tuple<int, int, unsigned int>      Key;       // (rank, tag, seq)
+
+    Slot* slot( int owner, int sender, int index )
+    {
+      return reinterpret_cast<Slot*>(d_inbox[owner] + ((long)sender * d_slotsPerPeer + index) * d_slotStride);
+    }
+
+    void complete( Recv& recv, const void* data, int bytes );
+
+    int drain( const CommRecMPI& recvs );
+
+    // disable copy and assignment
+    NodeMailbox( const NodeMailbox& );
+    NodeMailbox& operator=( const NodeMailbox& );
+
+    const ProcessorGroup* d_myworld;
+    MPI_Win               d_win;
+    int                   d_nodeSize;
+    int                   d_nodeMe;
+    int                   d_slotsPerPeer;
+    int                   d_slotBytes;
+    long                  d_slotStride;
+
+    std::vector<int>      d_nodeRank;    // world rank -> node rank (MPI_UNDEFINED if elsewhere)
+    std::vector<int>      d_worldRank;   // node rank -> world rank
+    std::vector<char*>    d_inbox;       // node rank -> its inbox
+
+    std::mutex                               d_sendLock;
+    std::vector<int>                         d_sendHead;   // next slot in each peer's inbox
+    std::map<Channel, unsigned int>          d_sendSeq;
+
+    std::mutex                               d_recvLock;
+    std::vector<int>                         d_recvTail;   // next slot from each peer
+    std::map<Channel, unsigned int>          d_recvSeq;
+    std::map<Key, Recv>                      d_posted;
+    std::map<Key, std::vector<char> >        d_early;      // arrived before its scheduler took it
+    std::map<Channel, std::deque<MPI_Message> > d_probed;  // matched MPI messages not received yet
+};
+
+} // End namespace Uintah
+
+#endif // CCA_COMPONENTS_SCHEDULERS_NODEMAILBOX_H
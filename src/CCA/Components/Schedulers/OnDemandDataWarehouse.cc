@@ -904,22 +904,12 @@ OnDemandDataWarehouse::reduceMPI( const VarLabel       * label,
   MPI_Op op = MPI_OP_NULL;
   MPI_Datatype datatype = MPI_DATATYPE_NULL;
 
-  for( int m = 0; m < nmatls; m++ ) {
-
-    int matlIndex = matls->get( m );
+  std::vector<ReductionVariableBase*> vars;
+  getReductionVariablesForMPI( label, level, matls, vars );
 
-    ReductionVariableBase* var;
-    if( d_levelDB.exists( label, matlIndex, level ) ) {
-      var = dynamic_cast<ReductionVariableBase*>( d_levelDB.get( label, matlIndex, level ) );
-    }
-    else {
-      var = dynamic_cast<ReductionVariableBase*>( label->typeDescription()->createInstance() );
-      var->setBenignValue();
+  for( int m = 0; m < nmatls; m++ ) {
 
-      // put it in the db so the next get won't fail and so we won't 
-      // have to delete it manually
-      d_levelDB.put( label, matlIndex, level, var, d_scheduler->isCopyDataTimestep(), true );
-    }
+    ReductionVariableBase* var = vars[m];
 
     int sendcount;
     MPI_Datatype senddatatype = MPI_DATATYPE_NULL;
@@ -1006,6 +996,48 @@ OnDemandDataWarehouse::reduceMPI( const VarLabel       * label,
   }
 }
 
+//______________________________________________________________________
+//
+void
+OnDemandDataWarehouse::getReductionVariablesForMPI( const VarLabel                      * label,
+                                                    const Level                         * level,
+                                                    const MaterialSubset                * inmatls,
+                                                          std::vector<ReductionVariableBase*> & vars )
+{
+  vars.clear();
+
+  if( !inmatls ) {
+    vars.push_back( getReductionVariableForMPI( label, level, -1 ) );
+    return;
+  }
+
+  for( int m = 0; m < inmatls->size(); m++ ) {
+    vars.push_back( getReductionVariableForMPI( label, level, inmatls->get( m ) ) );
+  }
+}
+
+//______________________________________________________________________
+//
+ReductionVariableBase*
+OnDemandDataWarehouse::getReductionVariableForMPI( const VarLabel * label,
+                                                   const Level    * level,
+                                                         int        matlIndex )
+{
+  ReductionVariableBase* var;
+  if( d_levelDB.exists( label, matlIndex, level ) ) {
+    var = dynamic_cast<ReductionVariableBase*>( d_levelDB.get( label, matlIndex, level ) );
+  }
+  else {
+    var = dynamic_cast<ReductionVariableBase*>( label->typeDescription()->createInstance() );
+    var->setBenignValue();
+
+    // put it in the db so the next get won't fail and so we won't 
+    // have to delete it manually
+    d_levelDB.put( label, matlIndex, level, var, d_scheduler->isCopyDataTimestep(), true );
+  }
+  return var;
+}
+
 //______________________________________________________________________
 //
 void
@@ -430,6 +430,14 @@ class OnDemandDataWarehouse : public DataWarehouse {
                    const MaterialSubset* matls,
                    int nComm);
 
+    // Returns the reduction variables (one per matl) that reduceMPI would
+    // reduce, creating benign values for the ones not computed locally.
+    // Used when several reductions are fused into one message.
+    void getReductionVariablesForMPI(const VarLabel* label,
+                                     const Level* level,
+                                     const MaterialSubset* matls,
+                                     std::vector<ReductionVariableBase*>& vars);
+
     // Scrub counter manipulator functions -- when the scrub count goes to
     // zero, the data is deleted
     void setScrubCount(const VarLabel* label,
@@ -561,6 +569,10 @@ class OnDemandDataWarehouse : public DataWarehouse {
                     Ghost::GhostType gtype,
                     int numGhostCells);
 
+    ReductionVariableBase* getReductionVariableForMPI(const VarLabel* label,
+                                                      const Level* level,
+                                                      int matlIndex);
+
     inline Task::WhichDW getWhichDW(RunningTaskInfo *info);
 
     // These will throw an exception if access is not allowed for the
@@ -25,6 +25,7 @@
 #include <CCA/Components/Schedulers/SchedulerCommon.h>
 
 #include <CCA/Components/Schedulers/DetailedTasks.h>
+#include <CCA/Components/Schedulers/GhostRegionCache.h>
 #include <CCA/Components/Schedulers/OnDemandDataWarehouse.h>
 #include <CCA/Components/Schedulers/OnDemandDataWarehouseP.h>
 #include <CCA/Components/Schedulers/TaskGraph.h>
@@ -38,6 +39,7 @@
 #include <Core/Exceptions/ProblemSetupException.h>
 #include <Core/Grid/Patch.h>
 #include <Core/Grid/Task.h>
+#include <Core/Grid/Variables/BlockRange.hpp>
 #include <Core/Grid/Variables/LocallyComputedPatchVarMap.h>
 #include <Core/Grid/Variables/CellIterator.h>
 #include <Core/Grid/Variables/CCVariable.h>
@@ -46,6 +48,7 @@
 #include <Core/Grid/Variables/SFCYVariable.h>
 #include <Core/Grid/Variables/SFCZVariable.h>
 #include <Core/Malloc/Allocator.h>
+#include <Core/Parallel/PackBufferInfo.h>
 #include <Core/Parallel/ProcessorGroup.h>
 #include <Core/ProblemSpec/ProblemSpec.h>
 #include <Core/OS/ProcessInfo.h>
@@ -53,6 +56,8 @@
 #include <Core/Util/DebugStream.h>
 #include <Core/Util/FancyAssert.h>
 
+#include <sci_defs/mpi_defs.h>
+
 #include <cerrno>
 #include <cstdlib>
 #include <fstream>
@@ -89,6 +94,7 @@ SchedulerCommon::SchedulerCommon( const ProcessorGroup* myworld,
 
   emit_taskgraph_    = false;
   d_useSmallMessages = true;
+  d_fuseReductions   = false;
   restartable        = false;
   memlogfile_        = nullptr;
 
@@ -104,6 +110,7 @@ SchedulerCommon::SchedulerCommon( const ProcessorGroup* myworld,
   d_isRestartInitTimestep = false;
 
   m_locallyComputedPatchVarMap = scinew LocallyComputedPatchVarMap;
+  m_ghostRegionCache = nullptr;
   reloc_new_posLabel_ = 0;
 
   // TODO replace after MiraDDT problem is debugged (APH - 03/24/15)
@@ -136,6 +143,7 @@ SchedulerCommon::~SchedulerCommon()
   label_matls_.clear();
 
   delete m_locallyComputedPatchVarMap;
+  delete m_ghostRegionCache;
 }
 
 //______________________________________________________________________
@@ -304,6 +312,62 @@ SchedulerCommon::problemSetup( const ProblemSpecP     & prob_spec,
     else {
       proc0cout << "   Using large, combined MPI messages\n";
     }
+
+    bool incrementalCompile = false;
+    params->getWithDefault("incremental_compile", incrementalCompile, false);
+    if( incrementalCompile ) {
+      m_ghostRegionCache = scinew GhostRegionCache();
+      proc0cout << "   Reusing ghost dependency regions of unchanged patches across taskgraph compiles\n";
+    }
+
+    params->getWithDefault("fuse_reductions", d_fuseReductions, false);
+#if UINTAH_ENABLE_MPI3
+    if( d_fuseReductions ) {
+      proc0cout << "   Fusing independent reduction tasks into combined allreduce messages\n";
+    }
+#else
+    // A blocking fused allreduce would stall unrelated tasks, and the sends
+    // peers wait on, so the per-variable reductions are kept instead.
+    if( d_fuseReductions ) {
+      proc0cout << "   WARNING: fuse_reductions needs a build with UINTAH_ENABLE_MPI3 and is ignored\n";
+      d_fuseReductions = false;
+    }
+#endif
+
+    // default iteration policy of the BlockRange parallel_for/parallel_reduce
+    // calls that do not pass one; set here, before any task runs
+    ProblemSpecP iteration = params->findBlock("iteration_policy");
+    if( iteration ) {
+      std::string schedule;
+      IntVector   tile(0, 8, 8);
+      int         chunk = 2;
+      iteration->getWithDefault("schedule",   schedule, "k_slab");
+      iteration->getWithDefault("tile_size",  tile,     tile);
+      iteration->getWithDefault("chunk_size", chunk,    chunk);
+
+      BlockRangePolicy::Schedule type;
+      if( schedule == "k_slab" ) {
+        type = BlockRangePolicy::KSlab;
+      }
+      else if( schedule == "collapsed_kj" ) {
+        type = BlockRangePolicy::CollapsedKJ;
+      }
+      else if( schedule == "tiled" ) {
+        type = BlockRangePolicy::Tiled;
+      }
+      else {
+        throw ProblemSetupException("Unknown iteration_policy schedule: " + schedule, __FILE__, __LINE__);
+      }
+      BlockRangePolicy::setDefault( BlockRangePolicy(type, tile.x(), tile.y(), tile.z(), chunk) );
+      proc0cout << "   Using the " << schedule << " iteration policy (tile " << tile << ", chunk " << chunk << ")\n";
+    }
+
+    bool explicitPacking = false;
+    params->getWithDefault("explicit_packing", explicitPacking, false);
+    if( explicitPacking ) {
+      PackBufferInfo::setExplicitPacking( true );
+      proc0cout << "   Packing ghost regions and particles with plain copies instead of MPI datatypes\n";
+    }
     
     ProblemSpecP track = params->findBlock("VarTracker");
     if (track) {
@@ -1177,6 +1241,12 @@ SchedulerCommon::compile()
 
     schedulercommon_dbg << d_myworld->myrank() << " SchedulerCommon starting compile\n";
     
+    // find out which parts of the grid moved since the last compile
+    if (m_ghostRegionCache) {
+      m_ghostRegionCache->resetCounters();
+      m_ghostRegionCache->update(grid.get_rep());
+    }
+
     // pass the first to the rest, so we can share the scrubcountTable
     DetailedTasks* first = 0;
     for (unsigned i = 0; i < graphs.size(); i++) {
@@ -1191,6 +1261,12 @@ SchedulerCommon::compile()
       }
     }
     verifyChecksum();
+
+    if (m_ghostRegionCache) {
+      schedulercommon_dbg << d_myworld->myrank() << " Ghost region cache hits: " << m_ghostRegionCache->numHits()
+                          << ", misses: " << m_ghostRegionCache->numMisses()
+                          << ", evictions: " << m_ghostRegionCache->numEvictions() << "\n";
+    }
     schedulercommon_dbg << d_myworld->myrank() << " SchedulerCommon finished compile\n";
   }
   else {
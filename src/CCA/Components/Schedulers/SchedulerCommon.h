@@ -46,6 +46,7 @@ class DetailedTask;
 class DetailedTasks;
 class TaskGraph;
 class LocallyComputedPatchVarMap;
+class GhostRegionCache;
 
 /**************************************
 
@@ -118,6 +119,9 @@ class SchedulerCommon : public Scheduler, public UintahParallelComponent {
 
     virtual bool useSmallMessages() { return d_useSmallMessages; }
 
+    // whether the reduction tasks of a phase are reduced in one fused message
+    bool fuseReductions() const { return d_fuseReductions; }
+
     /// Get all of the requires needed from the old data warehouse (carried forward).
     virtual const std::vector<const Task::Dependency*>&         getInitialRequires() const     { return d_initRequires; }
     virtual const std::set<const VarLabel*, VarLabel::Compare>& getInitialRequiredVars() const { return d_initRequiredVars; }
@@ -235,6 +239,10 @@ class SchedulerCommon : public Scheduler, public UintahParallelComponent {
     virtual const std::set<std::string>& getNotCheckPointVars() const { return notCheckpointVars_;}
 
     virtual bool useInternalDeps();
+
+    // Returns the cache of same-level ghost dependency regions kept across
+    // taskgraph compiles, or null when incremental compilation is disabled.
+    GhostRegionCache* getGhostRegionCache() { return m_ghostRegionCache; }
     
     const VarLabel* reloc_new_posLabel_;
 
@@ -272,6 +280,9 @@ class SchedulerCommon : public Scheduler, public UintahParallelComponent {
     
     bool d_isInitTimestep;
     bool d_isRestartInitTimestep;
+
+    // whether reduction tasks that can run together share one allreduce
+    bool d_fuseReductions;
    
     /**
     * output the task name and the level it's executing on.
@@ -346,6 +357,7 @@ class SchedulerCommon : public Scheduler, public UintahParallelComponent {
     bool                        emit_taskgraph_;
 
     LocallyComputedPatchVarMap* m_locallyComputedPatchVarMap;
+    GhostRegionCache*           m_ghostRegionCache;
     Relocate                    reloc1_;
     Relocate                    reloc2_;
 
@@ -24,6 +24,7 @@
 
 #include <CCA/Components/Schedulers/TaskGraph.h>
 #include <CCA/Components/Schedulers/DetailedTasks.h>
+#include <CCA/Components/Schedulers/GhostRegionCache.h>
 #include <CCA/Components/Schedulers/SchedulerCommon.h>
 #include <CCA/Components/Schedulers/OnDemandDataWarehouse.h>
 #include <CCA/Ports/DataWarehouse.h>
@@ -1045,6 +1046,71 @@ CompTable::findReductionComps(       Task::Dependency*      req,
   return creators.size() > 0;
 }
 
+//______________________________________________________________________
+//
+namespace {
+
+  // does any dependency in the list name one of the labels?
+  bool touchesLabels( const Task::Dependency* dep, const set<const VarLabel*>& labels )
+  {
+    for (; dep != 0; dep = dep->next) {
+      if (labels.find(dep->var) != labels.end()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+}
+
+//______________________________________________________________________
+//
+void
+TaskGraph::assignFusedReductionPhases()
+{
+  // The reduction tasks of a phase are reduced together once every other
+  // task of that phase is done.  A phase stays open across reduction tasks
+  // until a task needs (or changes) one of the variables being reduced, or
+  // needs MPI itself.  The detailed tasks are in the same (sorted) order on
+  // every rank, so every rank groups the same reductions.
+  int currphase = 0;
+  int currcomm = 0;
+  set<const VarLabel*> reducing;
+
+  for (int i = 0; i < dts_->numTasks(); i++) {
+    DetailedTask* dtask = dts_->getTask(i);
+    Task* task = dtask->task;
+
+    if (!reducing.empty()) {
+      bool close = task->usesMPI() ||
+                   touchesLabels(task->getRequires(), reducing) ||
+                   touchesLabels(task->getComputes(), reducing) ||
+                   touchesLabels(task->getModifies(), reducing);
+      if (close) {
+        currphase++;
+        reducing.clear();
+      }
+    }
+
+    task->d_phase = currphase;
+    if (tgphasedbg.active()) {
+      tgphasedbg << "Rank-" << d_myworld->myrank() << " Task: " << *dtask << " phase: " << currphase << "\n";
+    }
+
+    if (task->getType() == Task::Reduction) {
+      // the communicator of the first reduction of a phase carries the fused message
+      task->d_comm = currcomm;
+      currcomm++;
+      reducing.insert(task->getModifies()->var);
+    }
+    else if (task->usesMPI()) {
+      currphase++;
+    }
+  }
+  d_myworld->setgComm(currcomm);
+  d_numtaskphases = currphase + 1;
+}
+
 //______________________________________________________________________
 //
 void
@@ -1066,25 +1132,30 @@ TaskGraph::createDetailedDependencies()
 
   // Assign task phase number based on the reduction tasks so a mixed thread/mpi
   // scheduler won't have out of order reduction problems.
-  int currphase = 0;
-  int currcomm = 0;
-  for (int i = 0; i < dts_->numTasks(); i++) {
-    DetailedTask* task = dts_->getTask(i);
-    task->task->d_phase = currphase;
-    if (tgphasedbg.active()) {
-      tgphasedbg << "Rank-" << d_myworld->myrank() << " Task: " << *task << " phase: " << currphase << "\n";
-    }
-    if (task->task->getType() == Task::Reduction) {
-      task->task->d_comm = currcomm;
-      currcomm++;
-      currphase++;
-    }
-    else if (task->task->usesMPI()) {
-      currphase++;
+  if (sc->fuseReductions()) {
+    assignFusedReductionPhases();
+  }
+  else {
+    int currphase = 0;
+    int currcomm = 0;
+    for (int i = 0; i < dts_->numTasks(); i++) {
+      DetailedTask* task = dts_->getTask(i);
+      task->task->d_phase = currphase;
+      if (tgphasedbg.active()) {
+        tgphasedbg << "Rank-" << d_myworld->myrank() << " Task: " << *task << " phase: " << currphase << "\n";
+      }
+      if (task->task->getType() == Task::Reduction) {
+        task->task->d_comm = currcomm;
+        currcomm++;
+        currphase++;
+      }
+      else if (task->task->usesMPI()) {
+        currphase++;
+      }
     }
+    d_myworld->setgComm(currcomm);
+    d_numtaskphases = currphase + 1;
   }
-  d_myworld->setgComm(currcomm);
-  d_numtaskphases = currphase + 1;
 
   // Go through the modifies/requires and create data dependencies as appropriate
   for (int i = 0; i < dts_->numTasks(); i++) {
@@ -1294,6 +1365,10 @@ TaskGraph::createDetailedDependencies( DetailedTask*     task,
         static Patch::selectType neighbors;
         neighbors.resize(0);
 
+        // the regions this patch requires from each (from)neighbor
+        static vector<DependencyRegion> depRegions;
+        depRegions.resize(0);
+
         IntVector low, high;
 
         Patch::VariableBasis basis = Patch::translateTypeToBasis(req->var->typeDescription()->getType(), false);
@@ -1301,243 +1376,282 @@ TaskGraph::createDetailedDependencies( DetailedTask*     task,
         patch->computeVariableExtents(req->var->typeDescription()->getType(), req->var->getBoundaryLayer(), req->gtype,
                                       req->numGhostCells, low, high);
 
-        if (req->patches_dom == Task::CoarseLevel || req->patches_dom == Task::FineLevel) {
-          // make sure the bounds of the dep are limited to the original patch's (see above)
-          // also limit to current patch, as patches already loops over all patches
-          IntVector origlow = low, orighigh = high;
-          if (req->patches_dom == Task::FineLevel) {
-            // don't coarsen the extra cells
-            low = patch->getLowIndex(basis);
-            high = patch->getHighIndex(basis);
-          }
-          else {
-            low = Max(low, otherLevelLow);
-            high = Min(high, otherLevelHigh);
-          }
-
-          if (high.x() <= low.x() || high.y() <= low.y() || high.z() <= low.z()) {
-            continue;
+        // same-level ghost regions only depend on the patch layout around this patch, so
+        // they can be replayed from previous compiles if that part of the grid did not change
+        GhostRegionCache* regionCache = sc->getGhostRegionCache();
+        bool cacheable = regionCache && req->patches_dom == Task::ThisLevel && req->numGhostCells > 0;
+        static vector<GhostRegionCache::GhostRegion> cachedRegions;
+        cachedRegions.resize(0);
+
+        if (cacheable && regionCache->find(patch, basis, req->var->getBoundaryLayer(), low, high, cachedRegions)) {
+          for (unsigned r = 0; r < cachedRegions.size(); r++) {
+            DependencyRegion region = { cachedRegions[r].neighbor, cachedRegions[r].neighbor, cachedRegions[r].low, cachedRegions[r].high };
+            depRegions.push_back(region);
           }
-
-          // don't need to selectPatches.  Just use the current patch, as we're
-          // already looping over our required patches.
-          neighbors.push_back(patch);
         }
         else {
-          origPatch = patch;
-          if (req->numGhostCells > 0) {
-            patch->getLevel()->selectPatches(low, high, neighbors);
-          }
-          else {
-            neighbors.push_back(patch);
-          }
-        }
-        ASSERT(std::is_sorted(neighbors.begin(), neighbors.end(), Patch::Compare()));
-        if (detaileddbg.active()) {
-          detaileddbg << d_myworld->myrank() << "    Creating dependency on " << neighbors.size() << " neighbors\n";
-          detaileddbg << d_myworld->myrank() << "      Low=" << low << ", high=" << high << ", var=" << req->var->getName()
-                      << "\n";
-        }
-
-        for (int i = 0; i < neighbors.size(); i++) {
-          const Patch* neighbor = neighbors[i];
-
-          //if neighbor is not in my neighborhood just continue as its dependencies are not important to this processor
-          if (!lb->inNeighborhood(neighbor->getRealPatch())) {
-            continue;
-          }
+          if (req->patches_dom == Task::CoarseLevel || req->patches_dom == Task::FineLevel) {
+            // make sure the bounds of the dep are limited to the original patch's (see above)
+            // also limit to current patch, as patches already loops over all patches
+            IntVector origlow = low, orighigh = high;
+            if (req->patches_dom == Task::FineLevel) {
+              // don't coarsen the extra cells
+              low = patch->getLowIndex(basis);
+              high = patch->getHighIndex(basis);
+            }
+            else {
+              low = Max(low, otherLevelLow);
+              high = Min(high, otherLevelHigh);
+            }
 
-          static Patch::selectType fromNeighbors;
-          fromNeighbors.resize(0);
+            if (high.x() <= low.x() || high.y() <= low.y() || high.z() <= low.z()) {
+              continue;
+            }
 
-          IntVector l = Max(neighbor->getExtraLowIndex(basis, req->var->getBoundaryLayer()), low);
-          IntVector h = Min(neighbor->getExtraHighIndex(basis, req->var->getBoundaryLayer()), high);
-          if (neighbor->isVirtual()) {
-            l -= neighbor->getVirtualOffset();
-            h -= neighbor->getVirtualOffset();
-            neighbor = neighbor->getRealPatch();
-          }
-          if (req->patches_dom == Task::OtherGridDomain) {
-            // this is when we are copying data between two grids (currently between timesteps)
-            // the grid assigned to the old dw should be the old grid.
-            // This should really only impact things required from the OldDW.
-            LevelP fromLevel = sc->get_dw(0)->getGrid()->getLevel(patch->getLevel()->getIndex());
-            fromLevel->selectPatches(Max(neighbor->getExtraLowIndex(basis, req->var->getBoundaryLayer()), l),
-                                     Min(neighbor->getExtraHighIndex(basis, req->var->getBoundaryLayer()), h), fromNeighbors);
+            // don't need to selectPatches.  Just use the current patch, as we're
+            // already looping over our required patches.
+            neighbors.push_back(patch);
           }
           else {
-            fromNeighbors.push_back(neighbor);
+            origPatch = patch;
+            if (req->numGhostCells > 0) {
+              patch->getLevel()->selectPatches(low, high, neighbors);
+            }
+            else {
+              neighbors.push_back(patch);
+            }
+          }
+          ASSERT(std::is_sorted(neighbors.begin(), neighbors.end(), Patch::Compare()));
+          if (detaileddbg.active()) {
+            detaileddbg << d_myworld->myrank() << "    Creating dependency on " << neighbors.size() << " neighbors\n";
+            detaileddbg << d_myworld->myrank() << "      Low=" << low << ", high=" << high << ", var=" << req->var->getName()
+                        << "\n";
           }
 
-          for (int j = 0; j < fromNeighbors.size(); j++) {
-            const Patch* fromNeighbor = fromNeighbors[j];
+          for (int i = 0; i < neighbors.size(); i++) {
+            const Patch* neighbor = neighbors[i];
+
+            // periodic neighbors are not worth remembering
+            if (neighbor->isVirtual()) {
+              cacheable = false;
+            }
 
-            //only add the requirements both fromNeighbor is in my neighborhood
-            if (!lb->inNeighborhood(fromNeighbor)) {
+            //if neighbor is not in my neighborhood just continue as its dependencies are not important to this processor
+            //(cacheable regions are filtered below, as the neighborhood may differ on the next compile)
+            if (!cacheable && !lb->inNeighborhood(neighbor->getRealPatch())) {
               continue;
             }
 
-            IntVector from_l;
-            IntVector from_h;
+            static Patch::selectType fromNeighbors;
+            fromNeighbors.resize(0);
 
-            if (req->patches_dom == Task::OtherGridDomain && fromNeighbor->getLevel()->getIndex() > 0) {
-              // DON'T send extra cells (unless they're on the domain boundary)
-              from_l = Max(fromNeighbor->getLowIndexWithDomainLayer(basis), l);
-              from_h = Min(fromNeighbor->getHighIndexWithDomainLayer(basis), h);
+            IntVector l = Max(neighbor->getExtraLowIndex(basis, req->var->getBoundaryLayer()), low);
+            IntVector h = Min(neighbor->getExtraHighIndex(basis, req->var->getBoundaryLayer()), high);
+            if (neighbor->isVirtual()) {
+              l -= neighbor->getVirtualOffset();
+              h -= neighbor->getVirtualOffset();
+              neighbor = neighbor->getRealPatch();
             }
-            else {
-              // TODO - APH This intersection should not be needed, but let's clean this up if not
-              //from_l = Max(fromNeighbor->getExtraLowIndex(basis, req->var->getBoundaryLayer()), l);
-              //from_h = Min(fromNeighbor->getExtraHighIndex(basis, req->var->getBoundaryLayer()), h);
-              from_l = l;
-              from_h = h;
-              //verify in debug mode that the intersection is unneeded
-              ASSERT(Max(fromNeighbor->getExtraLowIndex(basis, req->var->getBoundaryLayer()), l) == l);
-              ASSERT(Min(fromNeighbor->getExtraHighIndex(basis, req->var->getBoundaryLayer()), h) == h);
+            if (req->patches_dom == Task::OtherGridDomain) {
+              // this is when we are copying data between two grids (currently between timesteps)
+              // the grid assigned to the old dw should be the old grid.
+              // This should really only impact things required from the OldDW.
+              LevelP fromLevel = sc->get_dw(0)->getGrid()->getLevel(patch->getLevel()->getIndex());
+              fromLevel->selectPatches(Max(neighbor->getExtraLowIndex(basis, req->var->getBoundaryLayer()), l),
+                                       Min(neighbor->getExtraHighIndex(basis, req->var->getBoundaryLayer()), h), fromNeighbors);
             }
-            if (patch->getLevel()->getIndex() > 0 && patch != fromNeighbor && req->patches_dom == Task::ThisLevel) {
-              // cull annoying overlapping AMR patch dependencies
-              patch->cullIntersection(basis, req->var->getBoundaryLayer(), fromNeighbor, from_l, from_h);
-              if (from_l == from_h) {
-                continue;
-              }
+            else {
+              fromNeighbors.push_back(neighbor);
             }
 
-            for (int m = 0; m < matls->size(); m++) {
-              int matl = matls->get(m);
-
-              // creator is the task that performs the original compute.
-              // If the require is for the OldDW, then it will be a send old
-              // data task
-              DetailedTask* creator = 0;
-              Task::Dependency* comp = 0;
-
-              // look in old dw or in old TG.  Legal to modify across TG boundaries
-              int proc = -1;
-              if (sc->isOldDW(req->mapDataWarehouse())) {
-                ASSERT(!modifies);
-                proc = findVariableLocation(req, fromNeighbor, matl, 0);
-                creator = dts_->getOldDWSendTask(proc);
-                comp = 0;
+            for (int j = 0; j < fromNeighbors.size(); j++) {
+              const Patch* fromNeighbor = fromNeighbors[j];
+
+              IntVector from_l;
+              IntVector from_h;
+
+              if (req->patches_dom == Task::OtherGridDomain && fromNeighbor->getLevel()->getIndex() > 0) {
+                // DON'T send extra cells (unless they're on the domain boundary)
+                from_l = Max(fromNeighbor->getLowIndexWithDomainLayer(basis), l);
+                from_h = Min(fromNeighbor->getHighIndexWithDomainLayer(basis), h);
               }
               else {
-                if (!ct.findcomp(req, neighbor, matl, creator, comp, d_myworld)) {
-                  if (type_ == Scheduler::IntermediateTaskGraph && req->lookInOldTG) {
-                    // same stuff as above - but do the check for findcomp first, as this is a "if you don't find it here, assign it
-                    // from the old TG" dependency
-                    proc = findVariableLocation(req, fromNeighbor, matl, 0);
-                    creator = dts_->getOldDWSendTask(proc);
-                    comp = 0;
-                  }
-                  else {
+                // TODO - APH This intersection should not be needed, but let's clean this up if not
+                //from_l = Max(fromNeighbor->getExtraLowIndex(basis, req->var->getBoundaryLayer()), l);
+                //from_h = Min(fromNeighbor->getExtraHighIndex(basis, req->var->getBoundaryLayer()), h);
+                from_l = l;
+                from_h = h;
+                //verify in debug mode that the intersection is unneeded
+                ASSERT(Max(fromNeighbor->getExtraLowIndex(basis, req->var->getBoundaryLayer()), l) == l);
+                ASSERT(Min(fromNeighbor->getExtraHighIndex(basis, req->var->getBoundaryLayer()), h) == h);
+              }
+              if (patch->getLevel()->getIndex() > 0 && patch != fromNeighbor && req->patches_dom == Task::ThisLevel) {
+                // cull annoying overlapping AMR patch dependencies
+                patch->cullIntersection(basis, req->var->getBoundaryLayer(), fromNeighbor, from_l, from_h);
+                if (from_l == from_h) {
+                  continue;
+                }
+              }
 
-                    //if neither the patch or the neighbor are on this processor then the computing task doesn't exist so just continue
-                    if (lb->getPatchwiseProcessorAssignment(patch) != d_myworld->myrank() &&
-                        lb->getPatchwiseProcessorAssignment(neighbor) != d_myworld->myrank()) {
-                      continue;
-                    }
+              DependencyRegion region = { neighbor, fromNeighbor, from_l, from_h };
+              depRegions.push_back(region);
+            }
+          }
 
-                    cout << "Failure finding " << *req << " for " << *task << "\n";
-                    if (creator) {
-                      cout << "creator=" << *creator << "\n";
-                    }
-                    cout << "neighbor=" << *fromNeighbor << ", matl=" << matl << "\n";
-                    cout << "me=" << me << "\n";
-                    //WAIT_FOR_DEBUGGER();
-                    SCI_THROW(InternalError("Failed to find comp for dep!", __FILE__, __LINE__));
-                  }
+          if (cacheable) {
+            for (unsigned r = 0; r < depRegions.size(); r++) {
+              GhostRegionCache::GhostRegion region = { depRegions[r].neighbor, depRegions[r].from_l, depRegions[r].from_h };
+              cachedRegions.push_back(region);
+            }
+            regionCache->insert(patch, basis, req->var->getBoundaryLayer(), low, high, cachedRegions);
+          }
+        }
+
+        for (unsigned r = 0; r < depRegions.size(); r++) {
+          const Patch* neighbor     = depRegions[r].neighbor;
+          const Patch* fromNeighbor = depRegions[r].fromNeighbor;
+          const IntVector& from_l   = depRegions[r].from_l;
+          const IntVector& from_h   = depRegions[r].from_h;
+
+          //only add the requirements when both the neighbor and the fromNeighbor are in my neighborhood
+          if (!lb->inNeighborhood(neighbor) || !lb->inNeighborhood(fromNeighbor)) {
+            continue;
+          }
+
+          for (int m = 0; m < matls->size(); m++) {
+            int matl = matls->get(m);
+
+            // creator is the task that performs the original compute.
+            // If the require is for the OldDW, then it will be a send old
+            // data task
+            DetailedTask* creator = 0;
+            Task::Dependency* comp = 0;
+
+            // look in old dw or in old TG.  Legal to modify across TG boundaries
+            int proc = -1;
+            if (sc->isOldDW(req->mapDataWarehouse())) {
+              ASSERT(!modifies);
+              proc = findVariableLocation(req, fromNeighbor, matl, 0);
+              creator = dts_->getOldDWSendTask(proc);
+              comp = 0;
+            }
+            else {
+              if (!ct.findcomp(req, neighbor, matl, creator, comp, d_myworld)) {
+                if (type_ == Scheduler::IntermediateTaskGraph && req->lookInOldTG) {
+                  // same stuff as above - but do the check for findcomp first, as this is a "if you don't find it here, assign it
+                  // from the old TG" dependency
+                  proc = findVariableLocation(req, fromNeighbor, matl, 0);
+                  creator = dts_->getOldDWSendTask(proc);
+                  comp = 0;
                 }
-              }
+                else {
 
-              if (modifies && comp) {  // comp means NOT send-old-data tasks
-
-                // find the tasks that up to this point require the variable
-                // that we are modifying (i.e., the ones that use the computed
-                // variable before we modify it), and put a dependency between
-                // those tasks and this tasks
-                // i.e., the task that requires data computed by a task on this processor
-                // needs to finish its task before this task, which modifies the data
-                // computed by the same task
-                list<DetailedTask*> requireBeforeModifiedTasks;
-                creator->findRequiringTasks(req->var, requireBeforeModifiedTasks);
-
-                list<DetailedTask*>::iterator reqTaskIter;
-                for (reqTaskIter = requireBeforeModifiedTasks.begin(); reqTaskIter != requireBeforeModifiedTasks.end(); ++reqTaskIter) {
-                  DetailedTask* prevReqTask = *reqTaskIter;
-                  if (prevReqTask == task) {
+                  //if neither the patch or the neighbor are on this processor then the computing task doesn't exist so just continue
+                  if (lb->getPatchwiseProcessorAssignment(patch) != d_myworld->myrank() &&
+                      lb->getPatchwiseProcessorAssignment(neighbor) != d_myworld->myrank()) {
                     continue;
                   }
-                  if (prevReqTask->task == task->task) {
-                    if (!task->task->getHasSubScheduler()) {
-                      ostringstream message;
-                      message << " WARNING - task (" << task->getName()
-                              << ") requires with Ghost cells *and* modifies and may not be correct" << endl;
-                      static ProgressiveWarning warn(message.str(), 10);
-                      warn.invoke();
-                      if (detaileddbg.active()) {
-                        detaileddbg << d_myworld->myrank() << " Task that requires with ghost cells and modifies\n";
-                        detaileddbg << d_myworld->myrank() << " RGM: var: " << *req->var << " compute: " << *creator << " mod "
-                                    << *task << " PRT " << *prevReqTask << " " << from_l << " " << from_h << "\n";
-                      }
-                    }
+
+                  cout << "Failure finding " << *req << " for " << *task << "\n";
+                  if (creator) {
+                    cout << "creator=" << *creator << "\n";
                   }
-                  else {
-                    // dep requires what is to be modified before it is to be
-                    // modified so create a dependency between them so the
-                    // modifying won't conflict with the previous require.
+                  cout << "neighbor=" << *fromNeighbor << ", matl=" << matl << "\n";
+                  cout << "me=" << me << "\n";
+                  //WAIT_FOR_DEBUGGER();
+                  SCI_THROW(InternalError("Failed to find comp for dep!", __FILE__, __LINE__));
+                }
+              }
+            }
+
+            if (modifies && comp) {  // comp means NOT send-old-data tasks
+
+              // find the tasks that up to this point require the variable
+              // that we are modifying (i.e., the ones that use the computed
+              // variable before we modify it), and put a dependency between
+              // those tasks and this tasks
+              // i.e., the task that requires data computed by a task on this processor
+              // needs to finish its task before this task, which modifies the data
+              // computed by the same task
+              list<DetailedTask*> requireBeforeModifiedTasks;
+              creator->findRequiringTasks(req->var, requireBeforeModifiedTasks);
+
+              list<DetailedTask*>::iterator reqTaskIter;
+              for (reqTaskIter = requireBeforeModifiedTasks.begin(); reqTaskIter != requireBeforeModifiedTasks.end(); ++reqTaskIter) {
+                DetailedTask* prevReqTask = *reqTaskIter;
+                if (prevReqTask == task) {
+                  continue;
+                }
+                if (prevReqTask->task == task->task) {
+                  if (!task->task->getHasSubScheduler()) {
+                    ostringstream message;
+                    message << " WARNING - task (" << task->getName()
+                            << ") requires with Ghost cells *and* modifies and may not be correct" << endl;
+                    static ProgressiveWarning warn(message.str(), 10);
+                    warn.invoke();
                     if (detaileddbg.active()) {
-                      detaileddbg << d_myworld->myrank() << "       Requires to modifies dependency from " << prevReqTask->getName()
-                                  << " to " << task->getName() << " (created by " << creator->getName() << ")\n";
+                      detaileddbg << d_myworld->myrank() << " Task that requires with ghost cells and modifies\n";
+                      detaileddbg << d_myworld->myrank() << " RGM: var: " << *req->var << " compute: " << *creator << " mod "
+                                  << *task << " PRT " << *prevReqTask << " " << from_l << " " << from_h << "\n";
                     }
-                    if (creator->getPatches() && creator->getPatches()->size() > 1) {
-                      // if the creator works on many patches, then don't create links between patches that don't touch
-                      const PatchSubset* psub = task->getPatches();
-                      const PatchSubset* req_sub = prevReqTask->getPatches();
-                      if (psub->size() == 1 && req_sub->size() == 1) {
-                        const Patch* p = psub->get(0);
-                        const Patch* req_patch = req_sub->get(0);
-                        Patch::selectType n;
-                        IntVector low, high;
-
-                        req_patch->computeVariableExtents(req->var->typeDescription()->getType(), req->var->getBoundaryLayer(),
-                                                          Ghost::AroundCells, 2, low, high);
-
-                        req_patch->getLevel()->selectPatches(low, high, n);
-                        bool found = false;
-                        for (int i = 0; i < n.size(); i++) {
-                          if (n[i]->getID() == p->getID()) {
-                            found = true;
-                            break;
-                          }
-                        }
-                        if (!found) {
-                          continue;
+                  }
+                }
+                else {
+                  // dep requires what is to be modified before it is to be
+                  // modified so create a dependency between them so the
+                  // modifying won't conflict with the previous require.
+                  if (detaileddbg.active()) {
+                    detaileddbg << d_myworld->myrank() << "       Requires to modifies dependency from " << prevReqTask->getName()
+                                << " to " << task->getName() << " (created by " << creator->getName() << ")\n";
+                  }
+                  if (creator->getPatches() && creator->getPatches()->size() > 1) {
+                    // if the creator works on many patches, then don't create links between patches that don't touch
+                    const PatchSubset* psub = task->getPatches();
+                    const PatchSubset* req_sub = prevReqTask->getPatches();
+                    if (psub->size() == 1 && req_sub->size() == 1) {
+                      const Patch* p = psub->get(0);
+                      const Patch* req_patch = req_sub->get(0);
+                      Patch::selectType n;
+                      IntVector low, high;
+
+                      req_patch->computeVariableExtents(req->var->typeDescription()->getType(), req->var->getBoundaryLayer(),
+                                                        Ghost::AroundCells, 2, low, high);
+
+                      req_patch->getLevel()->selectPatches(low, high, n);
+                      bool found = false;
+                      for (int i = 0; i < n.size(); i++) {
+                        if (n[i]->getID() == p->getID()) {
+                          found = true;
+                          break;
                         }
                       }
+                      if (!found) {
+                        continue;
+                      }
                     }
-                    dts_->possiblyCreateDependency(prevReqTask, 0, 0, task, req, 0, matl, from_l, from_h, DetailedDep::Always);
                   }
+                  dts_->possiblyCreateDependency(prevReqTask, 0, 0, task, req, 0, matl, from_l, from_h, DetailedDep::Always);
                 }
               }
+            }
 
-              DetailedDep::CommCondition cond = DetailedDep::Always;
-              if (proc != -1 && req->patches_dom != Task::OtherGridDomain) {
-                // for OldDW tasks - see comment in class DetailedDep by CommCondition
-                int subsequentProc = findVariableLocation(req, fromNeighbor, matl, 1);
-                if (subsequentProc != proc) {
-                  cond = DetailedDep::FirstIteration;  // change outer cond from always to first-only
-                  DetailedTask* subsequentCreator = dts_->getOldDWSendTask(subsequentProc);
-                  dts_->possiblyCreateDependency(subsequentCreator, comp, fromNeighbor,
-                      task, req, patch,
-                      matl, from_l, from_h, DetailedDep::SubsequentIterations);
-                  detaileddbg << d_myworld->myrank() << "   Adding condition reqs for " << *req->var << " task : " << *creator
-                              << "  to " << *task << "\n";
-                }
+            DetailedDep::CommCondition cond = DetailedDep::Always;
+            if (proc != -1 && req->patches_dom != Task::OtherGridDomain) {
+              // for OldDW tasks - see comment in class DetailedDep by CommCondition
+              int subsequentProc = findVariableLocation(req, fromNeighbor, matl, 1);
+              if (subsequentProc != proc) {
+                cond = DetailedDep::FirstIteration;  // change outer cond from always to first-only
+                DetailedTask* subsequentCreator = dts_->getOldDWSendTask(subsequentProc);
+                dts_->possiblyCreateDependency(subsequentCreator, comp, fromNeighbor,
+                    task, req, patch,
+                    matl, from_l, from_h, DetailedDep::SubsequentIterations);
+                detaileddbg << d_myworld->myrank() << "   Adding condition reqs for " << *req->var << " task : " << *creator
+                            << "  to " << *task << "\n";
               }
-              dts_->possiblyCreateDependency(creator, comp, fromNeighbor,
-                  task, req, patch,
-                  matl, from_l, from_h, cond);
             }
+            dts_->possiblyCreateDependency(creator, comp, fromNeighbor,
+                task, req, patch,
+                matl, from_l, from_h, cond);
           }
         }
       }
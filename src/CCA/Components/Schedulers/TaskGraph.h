@@ -218,6 +218,16 @@ class TaskGraph {
 
     typedef std::map<VarLabelMatl<Level>, Task*> ReductionTasksMap;
 
+    /// The region of a requirement that comes from one neighboring patch,
+    /// as found (or replayed from the GhostRegionCache) by
+    /// createDetailedDependencies.
+    struct DependencyRegion {
+      const Patch* neighbor;
+      const Patch* fromNeighbor;
+      IntVector    from_l;
+      IntVector    from_h;
+    };
+
     /// Helper function for processTasks, processing the dependencies
     /// for the given task in the dependency list whose head is req.
     /// Will call processTask (recursively, as this is a helper for
@@ -254,6 +264,11 @@ class TaskGraph {
                                      CompTable&        ct,
                                      bool              modifies );
 
+    /// Assigns task phases (and reduction communicators) when reductions
+    /// are fused: consecutive reduction tasks share one phase until a task
+    /// touches one of the variables being reduced or uses MPI itself.
+    void assignFusedReductionPhases();
+
     /// Makes a DetailedTask from task with given PatchSubset and
     /// MaterialSubset.
     void createDetailedTask(       Task*           task,
@@ -274,6 +274,13 @@ ThreadedMPIScheduler::problemSetup( const ProblemSpecP     & prob_spec
   }
 
   SchedulerCommon::problemSetup(prob_spec, state);
+  setupNodeMailbox(prob_spec);
+
+  // phase sync here runs a single reduction task per phase
+  if (d_fuseReductions) {
+    proc0cout << "   WARNING: fuse_reductions is not supported by the ThreadedMPI scheduler and is ignored\n";
+    d_fuseReductions = false;
+  }
 
   // this spawns threads, sets affinity, etc
   init_threads(this, m_num_threads);
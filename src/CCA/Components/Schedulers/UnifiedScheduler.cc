@@ -24,6 +24,7 @@
 
 #include <CCA/Components/Schedulers/UnifiedScheduler.h>
 #include <CCA/Components/Schedulers/OnDemandDataWarehouse.h>
+#include <CCA/Components/Schedulers/FusedReduction.h>
 #include <CCA/Components/Schedulers/TaskGraph.h>
 #include <CCA/Ports/Output.h>
 
@@ -428,6 +429,7 @@ UnifiedScheduler::problemSetup( const ProblemSpecP&     prob_spec,
   }
 
   SchedulerCommon::problemSetup(prob_spec, state);
+  setupNodeMailbox(prob_spec);
 
 #ifdef HAVE_CUDA
   //Now pick out the materials out of the file.  This is done with an assumption that there
@@ -690,11 +692,18 @@ UnifiedScheduler::execute( int tgnum     /* = 0 */,
   phaseTasksDone.resize(numPhases, 0);
   phaseSyncTask.clear();
   phaseSyncTask.resize(numPhases, NULL);
+  phaseReductions.clear();
+  phaseReductions.resize(numPhases, 0);
+  phaseFusedTasks.clear();
+  phaseFusedTasks.resize(numPhases);
   dts->setTaskPriorityAlg(taskQueueAlg_);
 
   // get the number of tasks in each task phase
   for (int i = 0; i < ntasks; ++i) {
     phaseTasks[dts->localTask(i)->getTask()->d_phase]++;
+    if (fuseReductions() && dts->localTask(i)->getTask()->getType() == Task::Reduction) {
+      phaseReductions[dts->localTask(i)->getTask()->d_phase]++;
+    }
   }
 
   if (unified_dbg.active()) {
@@ -873,6 +882,7 @@ UnifiedScheduler::runTasks( int thread_id )
 
     DetailedTask* readyTask = NULL;
     DetailedTask* initTask = NULL;
+    std::vector<DetailedTask*> fusedTasks;
 
     int pendingMPIMsgs = 0;
     bool havework = false;
@@ -915,6 +925,23 @@ UnifiedScheduler::runTasks( int thread_id )
         break;
       }
 
+      /*
+       * (1.1.1)
+       *
+       * With fused reductions, once everything else in this phase is done, reduce
+       * all of the phase's reduction tasks together.
+       *
+       */
+      else if ((phaseReductions[currphase] > 0) && ((int)phaseFusedTasks[currphase].size() == phaseReductions[currphase])
+               && (phaseTasksDone[currphase] == phaseTasks[currphase] - phaseReductions[currphase])) {
+        fusedTasks.swap(phaseFusedTasks[currphase]);
+        havework = true;
+        for (size_t i = 0; i < fusedTasks.size(); i++) {
+          markTaskConsumed(numTasksDone, currphase, numPhases, fusedTasks[i]);
+        }
+        break;
+      }
+
       /*
        * (1.2)
        *
@@ -983,7 +1010,12 @@ UnifiedScheduler::runTasks( int thread_id )
                 taskdbg << myRankThread() << " Task internal ready 1 " << *initTask << std::endl;
               }
             }
-            phaseSyncTask[initTask->getTask()->d_phase] = initTask;
+            if (phaseReductions[initTask->getTask()->d_phase] > 0 && initTask->getTask()->getType() == Task::Reduction) {
+              phaseFusedTasks[initTask->getTask()->d_phase].push_back(initTask);
+            }
+            else {
+              phaseSyncTask[initTask->getTask()->d_phase] = initTask;
+            }
             ASSERT(initTask->getRequires().size() == 0)
             initTask = NULL;
           }
@@ -1147,7 +1179,13 @@ UnifiedScheduler::runTasks( int thread_id )
     //      Each thread does its own thing here... modify this code with caution
     // ----------------------------------------------------------------------------------
 
-    if (initTask != NULL) {
+    if (!fusedTasks.empty()) {
+      FusedReduction* fused = startFusedReduction(fusedTasks);
+      if (fused) {
+        finishFusedReduction(fused);
+      }
+    }
+    else if (initTask != NULL) {
       initiateTask(initTask, abort, abort_point, currentIteration);
       if (taskdbg.active()) {
         std::lock_guard<std::mutex> lock(g_main_io_mutex);
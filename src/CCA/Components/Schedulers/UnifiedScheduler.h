@@ -132,6 +132,8 @@ class UnifiedScheduler : public MPIScheduler  {
     std::vector<int>           phaseTasks;
     std::vector<int>           phaseTasksDone;
     std::vector<DetailedTask*> phaseSyncTask;
+    std::vector<int>           phaseReductions;   // local reduction tasks per phase, when fusing reductions
+    std::vector<std::vector<DetailedTask*> > phaseFusedTasks;
     std::vector<int>           histogram;
     DetailedTasks*             dts{nullptr};
 
@@ -33,9 +33,12 @@ SRCS += \
         $(SRCDIR)/DependencyException.cc      \
         $(SRCDIR)/DetailedTasks.cc            \
         $(SRCDIR)/DynamicMPIScheduler.cc      \
+        $(SRCDIR)/FusedReduction.cc           \
+        $(SRCDIR)/GhostRegionCache.cc         \
         $(SRCDIR)/IncorrectAllocation.cc      \
         $(SRCDIR)/MemoryLog.cc                \
         $(SRCDIR)/MPIScheduler.cc             \
+        $(SRCDIR)/NodeMailbox.cc              \
         $(SRCDIR)/OnDemandDataWarehouse.cc    \
         $(SRCDIR)/Relocate.cc                 \
         $(SRCDIR)/SchedulerCommon.cc          \
@@ -335,8 +335,9 @@ SimulationController::gridSetup( void )
 
     Dir restartFromDir( d_fromDir );
     Dir checkpointRestartDir = restartFromDir.getSubdir( "checkpoints" );
+    // Rank 0 reads index.xml, timestep.xml and the grid, and broadcasts them.
     d_archive = scinew DataArchive( checkpointRestartDir.getName(),
-                                    d_myworld->myrank(), d_myworld->size() );
+                                    d_myworld->myrank(), d_myworld->size(), true, d_myworld );
 
     vector<int>    indices;
     vector<double> times;
@@ -470,6 +471,9 @@ SimulationController::postGridSetup( GridP& grid, double& t )
     // delt will be off if it doesn't match.
     d_sharedState->d_prev_delt = d_archive->getOldDelt( d_restartIndex );
 
+    // the grid, timestep.xml and the data are read: drop the broadcast copies
+    d_archive->releaseMetadata();
+
     d_sharedState->setCurrentTopLevelTimeStep( d_restartTimestep );
     // Tell the scheduler the generation of the re-started simulation.
     // (Add +1 because the scheduler will be starting on the next
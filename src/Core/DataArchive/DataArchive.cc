@@ -38,6 +38,7 @@
 #include <Core/Containers/OffsetArray1.h>
 #include <Core/Grid/Grid.h>
 #include <Core/Grid/Level.h>
+#include <Core/Grid/UdaSidecar.h>
 #include <Core/Grid/UnknownVariable.h>
 #include <Core/Grid/Variables/StaticInstantiate.h>
 #include <Core/Grid/Variables/VarLabel.h>
@@ -49,7 +50,10 @@
 #include <Core/Util/XMLUtils.h>
 #include <libxml/xmlreader.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
@@ -73,7 +77,8 @@ bool        DataArchive::d_types_initialized = false;
 DataArchive::DataArchive( const string & filebase,
                           const int      processor     /* = 0 */,
                           const int      numProcessors /* = 1 */,
-                          const bool     verbose       /* = true */ ) :
+                          const bool     verbose       /* = true */,
+                          const ProcessorGroup * metadataGroup /* = nullptr */ ) :
   ref_cnt(0),
   timestep_cache_size(10),
   default_cache_size(10),
@@ -81,6 +86,7 @@ DataArchive::DataArchive( const string & filebase,
   d_cell_scale( Vector(1.0,1.0,1.0) ),
   d_processor(processor),
   d_numProcessors(numProcessors),
+  d_metadataGroup(metadataGroup),
   d_particlePositionName("p.x")
 {
 #ifdef STATIC_BUILD
@@ -107,7 +113,7 @@ DataArchive::DataArchive( const string & filebase,
   //   proc0cout << "Parsing " << index << "\n";
   //}
 
-  d_indexFile = fopen( index.c_str(), "r" ); // Was: ProblemSpecReader().readInputFile( index );
+  d_indexFile = openMetadata( index ); // Was: ProblemSpecReader().readInputFile( index );
   if( d_indexFile == nullptr ) {
     throw InternalError( "DataArchive::DataArchive() failed to open index xml file.", __FILE__, __LINE__ );
   }
@@ -138,6 +144,97 @@ DataArchive::~DataArchive()
   for( ; vm_iter != d_createdVarLabels.end(); vm_iter++ ) {
     VarLabel::destroy( vm_iter->second );
   }
+
+  // Closed before d_metadataFiles, which it may be reading from, goes away.
+  fclose( d_indexFile );
+}
+//______________________________________________________________________
+//
+void
+DataArchive::releaseMetadata()
+{
+  const string index = d_filebase + "/index.xml";
+
+  size_t bytes = 0;
+  map<string, vector<char> >::iterator iter = d_metadataFiles.begin();
+  while( iter != d_metadataFiles.end() ) {
+    if( iter->first == index ) {
+      iter++;
+    }
+    else {
+      bytes += iter->second.size();
+      d_metadataFiles.erase( iter++ );
+    }
+  }
+  d_missingMetadataFiles.clear();
+
+  if( d_metadataGroup != nullptr ) {
+    dbg << "Rank-" << d_metadataGroup->myrank() << " DataArchive::releaseMetadata: freed " << bytes << " bytes\n";
+  }
+}
+//______________________________________________________________________
+//
+FILE *
+DataArchive::openMetadata( const string & filename )
+{
+  if( d_metadataGroup == nullptr || d_metadataGroup->size() <= 1 ) {
+    return fopen( filename.c_str(), "r" );
+  }
+
+  if( d_missingMetadataFiles.count( filename ) > 0 ) {
+    return nullptr;
+  }
+
+  map<string, vector<char> >::iterator iter = d_metadataFiles.find( filename );
+
+  if( iter == d_metadataFiles.end() ) {
+    double start = Time::currentSeconds();
+
+    // Rank 0 reads the file; a size of -1 tells the others it could not.
+    vector<char> contents;
+    long         size = -1;
+
+    if( d_metadataGroup->myrank() == 0 ) {
+      FILE * fp = fopen( filename.c_str(), "r" );
+      if( fp != nullptr ) {
+        fseek( fp, 0, SEEK_END );
+        size = ftell( fp );
+        fseek( fp, 0, SEEK_SET );
+        contents.resize( size > 0 ? size : 0 );
+        if( size > 0 && fread( &contents[0], 1, size, fp ) != (size_t)size ) {
+          size = -1;
+        }
+        fclose( fp );
+      }
+    }
+
+    MPI_Comm comm = d_metadataGroup->getComm();
+    Uintah::MPI::Bcast( &size, 1, MPI_LONG, 0, comm );
+
+    if( size < 0 ) {
+      d_missingMetadataFiles.insert( filename );
+      return nullptr;
+    }
+
+    // in pieces, as MPI counts are ints
+    const long chunk = 1L << 30;
+    contents.resize( size );
+    for( long offset = 0; offset < size; offset += chunk ) {
+      Uintah::MPI::Bcast( &contents[offset], (int)std::min( chunk, size - offset ), MPI_CHAR, 0, comm );
+    }
+
+    dbg << "Rank-" << d_metadataGroup->myrank() << " DataArchive::openMetadata: received " << filename << " ("
+        << size << " bytes) in " << Time::currentSeconds() - start << " seconds\n";
+
+    iter = d_metadataFiles.insert( make_pair( filename, vector<char>() ) ).first;
+    iter->second.swap( contents );
+  }
+
+  vector<char> & contents = iter->second;
+  if( contents.empty() ) {
+    return tmpfile();   // fmemopen() does not take an empty buffer
+  }
+  return fmemopen( &contents[0], contents.size(), "r" );
 }
 //______________________________________________________________________
 //
@@ -363,30 +460,40 @@ DataArchive::queryGrid( int index, const ProblemSpecP & ups /* = nullptr */, boo
   double     start    = Time::currentSeconds();
   TimeData & timedata = getTimeData( index );
 
-  FILE* fp = 0;
-  FILE* fp_grid = fopen( timedata.d_grid_path_and_filename.c_str(), "r" );
-
-  // Check if the grid.xml is present, and use that, if it isn't, then use the grid information
-  // that is stored in timestep.xml.
+  GridP grid = scinew Grid;
 
-  if (fp_grid == nullptr) {
-    fp = fopen( timedata.d_ts_path_and_filename.c_str(), "r" );
-  } else {
+  vector< vector<int> > procMap; // One vector<int> per level.
 
-    fp = fp_grid;
+  // Use the binary grid.bin if the DataArchiver wrote one, else parse the xml.
+  FILE * fp_bin    = openMetadata( UdaSidecar::gridFilename( timedata.d_ts_directory ) );
+  bool   fromBinary = fp_bin != nullptr && UdaSidecar::readGrid( fp_bin, grid, procMap );
+  if( fp_bin != nullptr ) {
+    fclose( fp_bin );
   }
 
-  if( fp == nullptr ) {
-    throw InternalError("DataArchive::queryGrid() failed to open input file.\n", __FILE__, __LINE__);
-  }
+  if( !fromBinary ) {
 
-  GridP grid = scinew Grid;
+    FILE* fp = 0;
+    FILE* fp_grid = openMetadata( timedata.d_grid_path_and_filename );
 
-  vector< vector<int> > procMap; // One vector<int> per level.
+    // Check if the grid.xml is present, and use that, if it isn't, then use the grid information
+    // that is stored in timestep.xml.
 
-  grid->readLevelsFromFile( fp, procMap );
+    if (fp_grid == nullptr) {
+      fp = openMetadata( timedata.d_ts_path_and_filename );
+    } else {
 
-  fclose( fp );
+      fp = fp_grid;
+    }
+
+    if( fp == nullptr ) {
+      throw InternalError("DataArchive::queryGrid() failed to open input file.\n", __FILE__, __LINE__);
+    }
+
+    grid->readLevelsFromFile( fp, procMap );
+
+    fclose( fp );
+  }
 
   // Check to see if the grid has already been reconstructed and that
   // the cell scaling has not changed. Cell scale check can be removed
@@ -564,7 +671,8 @@ DataArchive::query(       Variable     & var,
                     const int            matlIndex,
                     const Patch        * patch,
                     const int            timeIndex,
-                          DataFileInfo * dfi /* = 0 */ )
+                          DataFileInfo * dfi /* = 0 */,
+                          int            fd  /* = -1 */ )
 {
   double tstart = Time::currentSeconds();
 
@@ -667,7 +775,12 @@ DataArchive::query(       Variable     & var,
   //__________________________________
   // open data file Standard Uda Format
   if( d_outputFileFormat == UDA || varType == REDUCTION_VAR) {
-    int fd = open( data_filename.c_str(), O_RDONLY );
+    // The caller may already hold the file open (restartInitialize reads
+    // all of a file's variables in offset order through one descriptor).
+    const bool ownFd = ( fd == -1 );
+    if( ownFd ) {
+      fd = open( data_filename.c_str(), O_RDONLY );
+    }
 
     if(fd == -1) {
       cerr << "Error opening file: " << data_filename.c_str() << ", errno=" << errno << '\n';
@@ -690,10 +803,12 @@ DataArchive::query(       Variable     & var,
     dbg << "DataArchive::query: time to read raw data: "<<Time::currentSeconds() - starttime<<endl;
     ASSERTEQ( dfi->end, ic.cur );
 
-    int result = close( fd );
-    if( result == -1 ) {
-      cerr << "Error closing file: " << data_filename.c_str() << ", errno=" << errno << '\n';
-      throw ErrnoException("DataArchive::query (close call)", errno, __FILE__, __LINE__);
+    if( ownFd ) {
+      int result = close( fd );
+      if( result == -1 ) {
+        cerr << "Error closing file: " << data_filename.c_str() << ", errno=" << errno << '\n';
+        throw ErrnoException("DataArchive::query (close call)", errno, __FILE__, __LINE__);
+      }
     }
   }
 
@@ -1055,19 +1170,41 @@ DataArchive::restartInitialize( const int             index,
   dw->setID( ts_indices[index] );
 
   // Make sure to load all the data so we can iterate through it.
-  for( int l = 0; l < grid->numLevels(); l++ ) {
-    LevelP level = grid->getLevel( l );
-    for( int p = 0; p < level->numPatches(); p++ ) {
-      const Patch* patch = level->getPatch( p );
-      if( lb->getPatchwiseProcessorAssignment( patch ) == d_processor ) {
+  const ProcessorGroup * pg = Parallel::getRootProcessorGroup();
+
+  if( lb && d_numProcessors > 1 && pg && pg->size() == d_numProcessors ) {
+    // Parse each data xml file once across all ranks and exchange the entries.
+    timedata.exchangePatchMetadata( grid, lb, pg );
+  }
+  else {
+    for( int l = 0; l < grid->numLevels(); l++ ) {
+      LevelP level = grid->getLevel( l );
+      for( int p = 0; p < level->numPatches(); p++ ) {
+        const Patch* patch = level->getPatch( p );
+        if( !lb || lb->getPatchwiseProcessorAssignment( patch ) == d_processor ) {
 
-        timedata.parsePatch( patch );
+          timedata.parsePatch( patch );
+        }
       }
     }
   }
 
-  // Iterate through all entries in the VarData hash table, and load the
-  // variables if that data belongs on this processor.
+  // Collect the entries in the VarData hash table whose data belongs on
+  // this processor, and read them ordered by (data file, offset) so each
+  // file is opened once and read front to back.
+
+  struct RestartRead {
+    VarnameMatlPatch key;
+    DataFileInfo     data;
+    const Patch    * patch;
+    string           filename;
+
+    bool operator<( const RestartRead & other ) const {
+      return filename < other.filename || ( filename == other.filename && data.start < other.data.start );
+    }
+  };
+
+  vector<RestartRead> reads;
 
   VarHashMapIterator iter( &timedata.d_datafileInfo );
 
@@ -1087,23 +1224,75 @@ DataArchive::restartInitialize( const int             index,
     }
 
     if( !patch || !lb || lb->getPatchwiseProcessorAssignment( patch ) == d_processor ) {
+      RestartRead read = { key, data, patch, "" };
+      if( patch ) {
+        const Patch * real_patch = patch->getRealPatch();
+        const PatchData & patchinfo = timedata.d_patchInfo[ real_patch->getLevel()->getIndex() ][ real_patch->getLevelIndex() ];
+        ostringstream ostr;
+        ostr << timedata.d_ts_directory << "l" << patch->getLevel()->getIndex() << "/" << patchinfo.datafilename;
+        read.filename = ostr.str();
+      }
+      else {
+        read.filename = timedata.d_ts_directory + timedata.d_globaldata;
+      }
+      reads.push_back( read );
+    }
+  }
 
-      Variable * var = label->typeDescription()->createInstance();
+  sort( reads.begin(), reads.end() );
 
-      query( *var, key.name_, matl, patch, index, &data );
+  int    fd = -1;
+  string fd_filename;
 
-      ParticleVariableBase* particles;
-      if ((particles = dynamic_cast<ParticleVariableBase*>(var))) {
-        if (!dw->haveParticleSubset(matl, patch)) {
-          dw->saveParticleSubset(particles->getParticleSubset(), matl, patch);
-        }
-        else {
-          ASSERTEQ(dw->getParticleSubset(matl, patch), particles->getParticleSubset());
-        }
+  for( unsigned r = 0; r < reads.size(); r++ ) {
+    RestartRead & read = reads[r];
+    int matl = read.key.matlIndex_;
+
+    // PIDX patch data is not read through a file descriptor.
+    const bool useFd = d_outputFileFormat == UDA || read.patch == nullptr;
+
+    if( useFd && read.filename != fd_filename ) {
+      if( fd != -1 ) {
+        close( fd );
+      }
+      fd_filename = read.filename;
+      fd = open( fd_filename.c_str(), O_RDONLY );
+      if( fd == -1 ) {
+        cerr << "Error opening file: " << fd_filename << ", errno=" << errno << '\n';
+        throw ErrnoException( "DataArchive::restartInitialize (open call)", errno, __FILE__, __LINE__ );
+      }
+#ifdef POSIX_FADV_SEQUENTIAL
+      // The whole span this processor needs from the file is requested up
+      // front, so the reads below are served from large sequential reads.
+      unsigned last = r;
+      while( last + 1 < reads.size() && reads[last + 1].filename == fd_filename ) {
+        last++;
+      }
+      posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+      posix_fadvise( fd, read.data.start, reads[last].data.end - read.data.start, POSIX_FADV_WILLNEED );
+#endif
+    }
+
+    VarLabel * label = varMap[ read.key.name_ ];
+    Variable * var   = label->typeDescription()->createInstance();
+
+    query( *var, read.key.name_, matl, read.patch, index, &read.data, useFd ? fd : -1 );
+
+    ParticleVariableBase* particles;
+    if ((particles = dynamic_cast<ParticleVariableBase*>(var))) {
+      if (!dw->haveParticleSubset(matl, read.patch)) {
+        dw->saveParticleSubset(particles->getParticleSubset(), matl, read.patch);
+      }
+      else {
+        ASSERTEQ(dw->getParticleSubset(matl, read.patch), particles->getParticleSubset());
       }
-      dw->put( var, label, matl, patch );
-      delete var; // should have been cloned when it was put
     }
+    dw->put( var, label, matl, read.patch );
+    delete var; // should have been cloned when it was put
+  }
+
+  if( fd != -1 ) {
+    close( fd );
   }
 } // end restartInitialize()
 
@@ -1318,8 +1507,8 @@ DataArchive::TimeData::init()
 
   // Pull the list of data xml files from the timestep.xml file.
 
-  FILE * ts_file = fopen( d_ts_path_and_filename.c_str(), "r" );
-  FILE * grid_file = fopen( d_grid_path_and_filename.c_str(), "r" );
+  FILE * ts_file = d_parent_da->openMetadata( d_ts_path_and_filename );
+  FILE * grid_file = d_parent_da->openMetadata( d_grid_path_and_filename );
 
   if( ts_file == nullptr ) {
     // FIXME: add more info to exception.
@@ -1418,13 +1607,26 @@ DataArchive::TimeData::init()
 #endif
 
 #if 1
-  bool found = false;
+  // The binary grid.bin carries the <Data> file list, so the (large) grid.xml
+  // does not have to be scanned for it.
+  vector<string> datafiles;
+  FILE * bin_file    = d_parent_da->openMetadata( UdaSidecar::gridFilename( d_ts_directory ) );
+  bool   fromSidecar = bin_file != nullptr && UdaSidecar::readDatafiles( bin_file, datafiles );
+  if( bin_file != nullptr ) {
+    fclose( bin_file );
+  }
+
+  for( unsigned i = 0; i < datafiles.size(); i++ ) {
+    addDatafile( datafiles[i] );
+  }
+
+  bool found = fromSidecar;
   string data_file_name = "";
   if (grid_file != nullptr) {
-    found = ProblemSpec::findBlock( "<Data>", grid_file );
+    found = found || ProblemSpec::findBlock( "<Data>", grid_file );
     data_file_name = d_grid_path_and_filename;
   } else {
-    found = ProblemSpec::findBlock( "<Data>", ts_file );
+    found = found || ProblemSpec::findBlock( "<Data>", ts_file );
     data_file_name = d_ts_path_and_filename;
   }
 
@@ -1432,7 +1634,7 @@ DataArchive::TimeData::init()
     throw InternalError( "Cannot find <Data> in " + data_file_name, __FILE__, __LINE__ );
   }
 
-  bool done = false;
+  bool done = fromSidecar;
   while( !done ) {
 
     string line = "";
@@ -1468,30 +1670,7 @@ DataArchive::TimeData::init()
              }
           }
       */
-      if( datafile == "global.xml" ) {
-        // Assuming that global.xml will always be small and thus using normal
-        // xml lib parsing...
-        parseFile( d_ts_directory + datafile, -1, -1 );
-      }
-      else {
-
-        // Get the level info out of the xml file: should be lX/pxxxxx.xml.
-        unsigned level = 0;
-        string::size_type start = datafile.find_first_of("l",0, datafile.length()-3);
-        string::size_type end = datafile.find_first_of("/");
-        if (start != string::npos && end != string::npos && end > start && end-start <= 2) {
-          level = atoi(datafile.substr(start+1, end-start).c_str());
-        }
-
-        if( level >= d_xmlFilenames.size() ) {
-          d_xmlFilenames.resize( level +1 );
-          d_xmlParsed.resize(    level + 1 );
-        }
-
-        string filename = d_ts_directory + datafile;
-        d_xmlFilenames[ level ].push_back( filename );
-        d_xmlParsed[    level ].push_back( false );
-      }
+      addDatafile( datafile );
     }
     else {
       throw InternalError("DataArchive::TimeData::init() - bad line in <Data> block...", __FILE__, __LINE__);
@@ -1507,6 +1686,36 @@ DataArchive::TimeData::init()
 //______________________________________________________________________
 //
 void
+DataArchive::TimeData::addDatafile( const string & datafile )
+{
+  if( datafile == "global.xml" ) {
+    // Assuming that global.xml will always be small and thus using normal
+    // xml lib parsing...
+    parseFile( d_ts_directory + datafile, -1, -1 );
+  }
+  else {
+
+    // Get the level info out of the xml file: should be lX/pxxxxx.xml.
+    unsigned level = 0;
+    string::size_type start = datafile.find_first_of("l",0, datafile.length()-3);
+    string::size_type end = datafile.find_first_of("/");
+    if (start != string::npos && end != string::npos && end > start && end-start <= 2) {
+      level = atoi(datafile.substr(start+1, end-start).c_str());
+    }
+
+    if( level >= d_xmlFilenames.size() ) {
+      d_xmlFilenames.resize( level +1 );
+      d_xmlParsed.resize(    level + 1 );
+    }
+
+    string filename = d_ts_directory + datafile;
+    d_xmlFilenames[ level ].push_back( filename );
+    d_xmlParsed[    level ].push_back( false );
+  }
+}
+//______________________________________________________________________
+//
+void
 DataArchive::TimeData::purgeCache()
 {
   d_grid = 0;
@@ -1524,111 +1733,60 @@ DataArchive::TimeData::purgeCache()
 void
 DataArchive::TimeData::parseFile( const string & filename, int levelNum, int basePatch )
 {
-  // Parse the file.
-  ProblemSpecP top = ProblemSpecReader().readInputFile( filename );
-
   // Materials are the same for all patches on a level - only parse them from one file.
   bool addMaterials = levelNum >= 0 && d_matlInfo[levelNum].size() == 0;
 
+  // Use the binary p*****.idx written alongside the xml if there is one.
+  vector<UdaSidecar::VariableEntry> entries;
+  if( UdaSidecar::readIndex( UdaSidecar::indexFilename( filename ), entries ) ) {
+    for( unsigned e = 0; e < entries.size(); e++ ) {
+      addVariable( entries[e], levelNum, basePatch, addMaterials );
+    }
+    return;
+  }
+
+  // Parse the file.
+  ProblemSpecP top = ProblemSpecReader().readInputFile( filename );
+
   for( ProblemSpecP vnode = top->getFirstChild(); vnode != 0; vnode=vnode->getNextSibling() ){
     if(vnode->getNodeName() == "Variable") {
-      string varname;
-      if( !vnode->get("variable", varname) ) {
+      UdaSidecar::VariableEntry entry;
+
+      if( !vnode->get("variable", entry.name) ) {
         throw InternalError("Cannot get variable name", __FILE__, __LINE__);
       }
 
-      int patchid;
-      if(!vnode->get("patch", patchid) && !vnode->get("region", patchid)) {
+      if(!vnode->get("patch", entry.patchid) && !vnode->get("region", entry.patchid)) {
         throw InternalError("Cannot get patch id", __FILE__, __LINE__);
       }
 
-      int index;
-      if(!vnode->get("index", index)) {
+      if(!vnode->get("index", entry.matl)) {
         throw InternalError("Cannot get index", __FILE__, __LINE__);
       }
 
-      if (addMaterials) {
-        // set the material to existing.  index+1 to use matl -1
-        if (index+1 >= (int)d_matlInfo[levelNum].size()) {
-          d_matlInfo[levelNum].resize(index+2);
-        }
-        d_matlInfo[levelNum][index] = true;
-      }
-
       map<string,string> attributes;
       vnode->getAttributes(attributes);
 
-      string type = attributes["type"];
-      if( type == "" ) {
+      entry.type = attributes["type"];
+      if( entry.type == "" ) {
         throw InternalError("DataArchive::query:Variable doesn't have a type", __FILE__, __LINE__);
       }
-      long start;
-      if( !vnode->get("start", start) ) {
+      if( !vnode->get("start", entry.start) ) {
         throw InternalError("DataArchive::query:Cannot get start", __FILE__, __LINE__);
       }
-      long end;
-      if( !vnode->get("end", end) ) {
+      if( !vnode->get("end", entry.end) ) {
         throw InternalError("DataArchive::query:Cannot get end", __FILE__, __LINE__);
       }
-      string filename;
-      if( !vnode->get("filename", filename) ) {
+      if( !vnode->get("filename", entry.filename) ) {
         throw InternalError("DataArchive::query:Cannot get filename", __FILE__, __LINE__);
       }
 
       // Not required
-      string    compressionMode = "";
-      IntVector boundary(0,0,0);
-      int       numParticles = -1;
-
-      vnode->get( "compression", compressionMode );
-      vnode->get( "boundaryLayer", boundary );
-      vnode->get( "numParticles", numParticles );
-
-      if( d_varInfo.find(varname) == d_varInfo.end() ) {
-        VarData& varinfo      = d_varInfo[varname];
-        varinfo.type          = type;
-        varinfo.compression   = compressionMode;
-        varinfo.boundaryLayer = boundary;
-        varinfo.filename      = filename;
-      }
-      else if (compressionMode != "") {
-        // For particles variables of size 0, the uda doesn't say it
-        // has a compressionMode...  (FYI, why is this?  Because it is
-        // ambiguous... if there is no data, is it compressed?)
-        //
-        // To the best of my understanding, we only look at the variables stats
-        // the first time we encounter it... even if there are multiple materials.
-        // So we run into a problem is the variable has 0 data the first time it
-        // is looked at... The problem there is that it doesn't mark it as being
-        // compressed, and therefore the next time we see that variable (eg, in
-        // another material) we (used to) assume it was not compressed... the
-        // following lines compenstate for this problem:
-        VarData& varinfo = d_varInfo[varname];
-        varinfo.compression = compressionMode;
-      }
-
-      if (levelNum == -1) { // global file (reduction vars)
-        d_globaldata = filename;
-      }
-      else {
-        ASSERTRANGE(patchid-basePatch, 0, (int)d_patchInfo[levelNum].size());
+      vnode->get( "compression", entry.compression );
+      vnode->get( "boundaryLayer", entry.boundaryLayer );
+      vnode->get( "numParticles", entry.numParticles );
 
-        PatchData& patchinfo = d_patchInfo[levelNum][patchid-basePatch];
-        if (!patchinfo.parsed) {
-          patchinfo.parsed = true;
-          patchinfo.datafilename = filename;
-        }
-      }
-      VarnameMatlPatch vmp(varname, index, patchid);
-      DataFileInfo     dummy;
-
-      if (d_datafileInfo.lookup(vmp, dummy) == 1) {
-        //cerr << "Duplicate variable name: " << name << endl;
-      }
-      else {
-        DataFileInfo dfi(start, end, numParticles);
-        d_datafileInfo.insert(vmp, dfi);
-      }
+      addVariable( entry, levelNum, basePatch, addMaterials );
     }
     else if( vnode->getNodeType() != ProblemSpec::TEXT_NODE ) {
       cerr << "WARNING: Unknown element in Variables section: " << vnode->getNodeName() << '\n';
@@ -1636,6 +1794,71 @@ DataArchive::TimeData::parseFile( const string & filename, int levelNum, int bas
   }
 } // end TimeData::parseFile()
 
+//______________________________________________________________________
+// Load one <Variable> of a p*****.xml file into the tables.
+void
+DataArchive::TimeData::addVariable( const UdaSidecar::VariableEntry & entry, int levelNum, int basePatch, bool addMaterials )
+{
+  const string & varname = entry.name;
+  const string & filename = entry.filename;
+  int            patchid = entry.patchid;
+  int            index   = entry.matl;
+
+  if (addMaterials) {
+    // set the material to existing.  index+1 to use matl -1
+    if (index+1 >= (int)d_matlInfo[levelNum].size()) {
+      d_matlInfo[levelNum].resize(index+2);
+    }
+    d_matlInfo[levelNum][index] = true;
+  }
+
+  if( d_varInfo.find(varname) == d_varInfo.end() ) {
+    VarData& varinfo      = d_varInfo[varname];
+    varinfo.type          = entry.type;
+    varinfo.compression   = entry.compression;
+    varinfo.boundaryLayer = entry.boundaryLayer;
+    varinfo.filename      = filename;
+  }
+  else if (entry.compression != "") {
+    // For particles variables of size 0, the uda doesn't say it
+    // has a compressionMode...  (FYI, why is this?  Because it is
+    // ambiguous... if there is no data, is it compressed?)
+    //
+    // To the best of my understanding, we only look at the variables stats
+    // the first time we encounter it... even if there are multiple materials.
+    // So we run into a problem is the variable has 0 data the first time it
+    // is looked at... The problem there is that it doesn't mark it as being
+    // compressed, and therefore the next time we see that variable (eg, in
+    // another material) we (used to) assume it was not compressed... the
+    // following lines compenstate for this problem:
+    VarData& varinfo = d_varInfo[varname];
+    varinfo.compression = entry.compression;
+  }
+
+  if (levelNum == -1) { // global file (reduction vars)
+    d_globaldata = filename;
+  }
+  else {
+    ASSERTRANGE(patchid-basePatch, 0, (int)d_patchInfo[levelNum].size());
+
+    PatchData& patchinfo = d_patchInfo[levelNum][patchid-basePatch];
+    if (!patchinfo.parsed) {
+      patchinfo.parsed = true;
+      patchinfo.datafilename = filename;
+    }
+  }
+  VarnameMatlPatch vmp(varname, index, patchid);
+  DataFileInfo     dummy;
+
+  if (d_datafileInfo.lookup(vmp, dummy) == 1) {
+    //cerr << "Duplicate variable name: " << name << endl;
+  }
+  else {
+    DataFileInfo dfi(entry.start, entry.end, entry.numParticles);
+    d_datafileInfo.insert(vmp, dfi);
+  }
+} // end TimeData::addVariable()
+
 //______________________________________________________________________
 //
 void
@@ -1684,6 +1907,225 @@ DataArchive::TimeData::parsePatch( const Patch * patch )
   }
 }
 
+//______________________________________________________________________
+//  Compact binary form of the data xml entries exchanged on restart.
+//  Strings (variable names, types, compression modes and data file
+//  names) are sent once per message and referenced by index.
+namespace {
+
+  class MetadataBuffer {
+  public:
+    template<class T> void put( const T & value ) {
+      const char * c = reinterpret_cast<const char*>( &value );
+      d_data.insert( d_data.end(), c, c + sizeof(T) );
+    }
+
+    int putString( const string & str ) {
+      map<string, int>::iterator iter = d_stringIndex.find( str );
+      if( iter != d_stringIndex.end() ) {
+        return iter->second;
+      }
+      int index = d_strings.size();
+      d_stringIndex[str] = index;
+      d_strings.push_back( str );
+      return index;
+    }
+
+    // string table followed by the records
+    void finish( vector<char> & out ) const {
+      MetadataBuffer header;
+      header.put( (int)d_strings.size() );
+      for( unsigned i = 0; i < d_strings.size(); i++ ) {
+        header.put( (int)d_strings[i].size() );
+        header.d_data.insert( header.d_data.end(), d_strings[i].begin(), d_strings[i].end() );
+      }
+      out.insert( out.end(), header.d_data.begin(), header.d_data.end() );
+      out.insert( out.end(), d_data.begin(), d_data.end() );
+    }
+
+    vector<char> d_data;
+
+  private:
+    map<string, int> d_stringIndex;
+    vector<string>   d_strings;
+  };
+
+  template<class T> T get( const char * buffer, size_t & pos ) {
+    T value;
+    memcpy( &value, buffer + pos, sizeof(T) );
+    pos += sizeof(T);
+    return value;
+  }
+
+} // end anonymous namespace
+
+//______________________________________________________________________
+//
+void
+DataArchive::TimeData::exchangePatchMetadata( const GridP          & grid,
+                                                    LoadBalancer   * lb,
+                                              const ProcessorGroup * pg )
+{
+  ASSERT(d_grid != 0);
+
+  const int myrank = pg->myrank();
+  const int nranks = pg->size();
+
+  double start = Time::currentSeconds();
+
+  // Parse this rank's share of the data xml files, dealt round robin
+  // over all levels so that the small files are spread evenly.
+  int fileCount = 0;
+  int numParsed = 0;
+  for( unsigned l = 0; l < d_xmlFilenames.size(); l++ ) {
+    if( (int)l >= grid->numLevels() ) {
+      break;
+    }
+    int levelBasePatchID = grid->getLevel( l )->getPatch( 0 )->getID();
+    for( unsigned f = 0; f < d_xmlFilenames[l].size(); f++, fileCount++ ) {
+      if( fileCount % nranks == myrank && !d_xmlParsed[l][f] ) {
+        parseFile( d_xmlFilenames[l][f], l, levelBasePatchID );
+        d_xmlParsed[l][f] = true;
+        numParsed++;
+      }
+    }
+  }
+
+  // Sort the patch entries by the rank that owns the patch.
+  vector<MetadataBuffer> buffers( nranks );
+
+  VarHashMapIterator iter( &d_datafileInfo );
+  for( ; iter.ok(); ++iter ) {
+    VarnameMatlPatch & key  = iter.get_key();
+    DataFileInfo     & data = iter.get_data();
+
+    if( key.patchid_ == -1 ) {
+      continue;     // reduction variables, every rank has read global.xml
+    }
+
+    const Patch * patch = grid->getPatchByID( key.patchid_, 0 );
+    int owner = lb->getPatchwiseProcessorAssignment( patch );
+    if( owner == myrank ) {
+      continue;
+    }
+
+    const VarData   & varinfo   = d_varInfo[ key.name_ ];
+    const PatchData & patchinfo = d_patchInfo[ patch->getLevel()->getIndex() ][ patch->getLevelIndex() ];
+
+    MetadataBuffer & buffer = buffers[owner];
+    buffer.put( buffer.putString( key.name_ ) );
+    buffer.put( buffer.putString( varinfo.type ) );
+    buffer.put( buffer.putString( varinfo.compression ) );
+    buffer.put( buffer.putString( varinfo.filename ) );
+    buffer.put( buffer.putString( patchinfo.datafilename ) );
+    buffer.put( varinfo.boundaryLayer.x() );
+    buffer.put( varinfo.boundaryLayer.y() );
+    buffer.put( varinfo.boundaryLayer.z() );
+    buffer.put( key.matlIndex_ );
+    buffer.put( key.patchid_ );
+    buffer.put( data.start );
+    buffer.put( data.end );
+    buffer.put( data.numParticles );
+  }
+
+  vector<char> sendbuf;
+  vector<int>  sendcounts( nranks ), senddispls( nranks );
+  for( int r = 0; r < nranks; r++ ) {
+    senddispls[r] = sendbuf.size();
+    if( !buffers[r].d_data.empty() ) {
+      buffers[r].finish( sendbuf );
+    }
+    sendcounts[r] = sendbuf.size() - senddispls[r];
+  }
+  buffers.clear();
+
+  vector<int> recvcounts( nranks ), recvdispls( nranks );
+  Uintah::MPI::Alltoall( &sendcounts[0], 1, MPI_INT, &recvcounts[0], 1, MPI_INT, pg->getComm() );
+
+  int recvsize = 0;
+  for( int r = 0; r < nranks; r++ ) {
+    recvdispls[r] = recvsize;
+    recvsize += recvcounts[r];
+  }
+  vector<char> recvbuf( std::max( recvsize, 1 ) );
+
+  sendbuf.resize( std::max( (int)sendbuf.size(), 1 ) );
+  Uintah::MPI::Alltoallv( &sendbuf[0], &sendcounts[0], &senddispls[0], MPI_BYTE,
+                          &recvbuf[0], &recvcounts[0], &recvdispls[0], MPI_BYTE, pg->getComm() );
+
+  // Load the received entries as parseFile() would have.
+  const int recordSize = 10 * sizeof(int) + 2 * sizeof(long) + sizeof(int);
+  int numReceived = 0;
+
+  for( int r = 0; r < nranks; r++ ) {
+    const char * buffer = &recvbuf[ recvdispls[r] ];
+    size_t       pos    = 0;
+    if( recvcounts[r] == 0 ) {
+      continue;
+    }
+
+    vector<string> strings( get<int>( buffer, pos ) );
+    for( unsigned i = 0; i < strings.size(); i++ ) {
+      int length = get<int>( buffer, pos );
+      strings[i].assign( buffer + pos, length );
+      pos += length;
+    }
+
+    while( pos + recordSize <= (size_t)recvcounts[r] ) {
+      const string & varname      = strings[ get<int>( buffer, pos ) ];
+      const string & type         = strings[ get<int>( buffer, pos ) ];
+      const string & compression  = strings[ get<int>( buffer, pos ) ];
+      const string & varfilename  = strings[ get<int>( buffer, pos ) ];
+      const string & datafilename = strings[ get<int>( buffer, pos ) ];
+      int  bx                     = get<int>( buffer, pos );
+      int  by                     = get<int>( buffer, pos );
+      int  bz                     = get<int>( buffer, pos );
+      IntVector boundary( bx, by, bz );
+      int  matl                   = get<int>( buffer, pos );
+      int  patchid                = get<int>( buffer, pos );
+      long start                  = get<long>( buffer, pos );
+      long end                    = get<long>( buffer, pos );
+      int  numParticles           = get<int>( buffer, pos );
+
+      VarData & varinfo = d_varInfo[varname];
+      if( varinfo.type == "" ) {
+        varinfo.type          = type;
+        varinfo.compression   = compression;
+        varinfo.boundaryLayer = boundary;
+        varinfo.filename      = varfilename;
+      }
+      else if( compression != "" ) {
+        // see parseFile() - 0 sized particle variables carry no compression mode
+        varinfo.compression = compression;
+      }
+
+      const Patch * patch = grid->getPatchByID( patchid, 0 );
+      int levelIndex = patch->getLevel()->getIndex();
+
+      if( matl + 1 >= (int)d_matlInfo[levelIndex].size() ) {
+        d_matlInfo[levelIndex].resize( matl + 2 );
+      }
+      d_matlInfo[levelIndex][matl] = true;
+
+      PatchData & patchinfo = d_patchInfo[levelIndex][ patch->getLevelIndex() ];
+      if( !patchinfo.parsed ) {
+        patchinfo.parsed       = true;
+        patchinfo.datafilename = datafilename;
+      }
+
+      VarnameMatlPatch vmp( varname, matl, patchid );
+      DataFileInfo     dummy;
+      if( d_datafileInfo.lookup( vmp, dummy ) != 1 ) {
+        d_datafileInfo.insert( vmp, DataFileInfo( start, end, numParticles ) );
+      }
+      numReceived++;
+    }
+  }
+
+  dbg << "Rank-" << myrank << " DataArchive::exchangePatchMetadata: parsed " << numParsed << " of " << fileCount
+      << " data files, received " << numReceived << " entries in " << Time::currentSeconds() - start << " seconds\n";
+}
+
 //______________________________________________________________________
 // Parses the timestep xml file for <oldDelt>
 //
@@ -1691,7 +2133,7 @@ double
 DataArchive::getOldDelt( int restart_index )
 {
   TimeData& timedata = getTimeData( restart_index );
-  FILE * fp = fopen( timedata.d_ts_path_and_filename.c_str(), "r" );
+  FILE * fp = openMetadata( timedata.d_ts_path_and_filename );
   if( fp == nullptr ) {
     throw InternalError("DataArchive::setOldDelt() failed open datafile.", __FILE__, __LINE__);
   }
@@ -1727,7 +2169,7 @@ ProblemSpecP
 DataArchive::getTimestepDocForComponent( int restart_index )
 {
   TimeData& timedata = getTimeData( restart_index );
-  FILE * fp = fopen( timedata.d_ts_path_and_filename.c_str(), "r" );
+  FILE * fp = openMetadata( timedata.d_ts_path_and_filename );
 
   if( fp == nullptr ) {
     throw InternalError("DataArchive::getTimespecDocForComponent() failed open datafile.", __FILE__, __LINE__);
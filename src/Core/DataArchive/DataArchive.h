@@ -34,6 +34,7 @@
 #include <Core/Grid/Level.h>
 #include <Core/Grid/Grid.h>
 #include <Core/Grid/GridP.h>
+#include <Core/Grid/UdaSidecar.h>
 #include <Core/Grid/Variables/VarnameMatlPatch.h>
 #include <Core/Parallel/ProcessorGroup.h>
 #include <Core/ProblemSpec/ProblemSpec.h>
@@ -45,7 +46,9 @@
 #include <Core/Containers/HashTable.h>
 
 #include <list>
+#include <map>
 #include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -96,7 +99,10 @@ public:
   DataArchive( const std::string & filebase,               // <- Name to save UDA under.
                const int           processor     = 0,      // use if you want to different processors to read different parts of the archive.
                const int           numProcessors = 1,
-               const bool          verbose       = true ); // If you want error messages printed to the screen.
+               const bool          verbose       = true,   // If you want error messages printed to the screen.
+               const ProcessorGroup * metadataGroup = nullptr ); // Restart: read index.xml, timestep.xml and the grid
+                                                                 // on rank 0 of this group and broadcast them.  Every
+                                                                 // rank of it must then make the same queries.
 
   // GROUP: Destructors
   //////////
@@ -179,13 +185,16 @@ public:
 
   // Queries a variable for a material, patch, and index in time.
   // Optionally pass in DataFileInfo if you're iterating over
-  // entries in the hash table (like restartInitialize does).
+  // entries in the hash table (like restartInitialize does), and an
+  // already open descriptor of the data file to read from it instead
+  // of opening the file for this one variable.
   void query(       Variable     & var,
               const std::string  & name,
               const int            matlIndex, 
               const Patch        * patch,
               const int            timeIndex,
-                    DataFileInfo * dfi = 0 );
+                    DataFileInfo * dfi = 0,
+                    int            fd  = -1 );
 
   void query(       Variable         & var,
               const std::string      & name,
@@ -264,6 +273,13 @@ public:
   // a problem spec with the Component's portion (ie: the portion after </Data>).
   ProblemSpecP getTimestepDocForComponent( int restart_index );
 
+  // Frees the broadcast copies of the metadata files (see openMetadata()),
+  // except index.xml, which d_indexFile reads from.  Called once a restart
+  // has read its grid, timestep.xml and data; a file opened again later is
+  // broadcast again.  All the ranks of the metadata group call it at the
+  // same point, so that they keep the same copies.
+  void releaseMetadata();
+
   // Only cache a single timestep
   void turnOnXMLCaching();
       
@@ -354,6 +370,18 @@ private:
     // Parse an individual data file and load appropriate storage.
     void parseFile( const std::string & filename, int levelNum, int basePatch );
 
+    // Load one variable entry of a data file (parsed or from its binary sidecar).
+    void addVariable( const UdaSidecar::VariableEntry & entry, int levelNum, int basePatch, bool addMaterials );
+
+    // Record a <Datafile> of the <Data> section (global.xml is parsed right away).
+    void addDatafile( const std::string & datafile );
+
+    // Restart: every rank parses its share of the data xml files (each
+    // file is parsed exactly once across the job), then the entries are
+    // exchanged in a compact binary form so that each rank ends up with
+    // the entries of the patches it owns.
+    void exchangePatchMetadata( const GridP & grid, LoadBalancer * lb, const ProcessorGroup * pg );
+
     // This would be private data, except we want DataArchive to have access,
     // so we would mark DataArchive as 'friend', but we're already a private
     // nested class of DataArchive...
@@ -420,6 +448,20 @@ private:
 
   TimeData & getTimeData( int index );
 
+  // Opens one of the uda's metadata files (index.xml, timestep.xml,
+  // grid.xml, grid.bin) for reading.  With a metadata group the file is
+  // read on its rank 0, broadcast, and opened from memory; the copy is
+  // kept, until releaseMetadata(), so that opening it again needs no
+  // communication.  Returns nullptr, on every rank, if the file cannot
+  // be opened.
+  //
+  // With a metadata group every call that is not answered from a kept
+  // copy is collective: all the ranks of the group must open the same
+  // files in the same order, so the queries that reach it (the
+  // constructor, queryGrid(), getTimestepDocForComponent(), getOldDelt()
+  // and the first access to a timestep) must be made by all of them.
+  FILE * openMetadata( const std::string & filename );
+
   std::string   d_filebase;
   FILE        * d_indexFile; // File pointer to XML index document.
 
@@ -441,6 +483,11 @@ private:
   int d_processor;
   int d_numProcessors;
 
+  // if used, the metadata files are read once and broadcast (see openMetadata())
+  const ProcessorGroup                     * d_metadataGroup;
+  std::map<std::string, std::vector<char> > d_metadataFiles;
+  std::set<std::string>                     d_missingMetadataFiles;
+
   std::mutex d_lock{};
     
   std::string d_particlePositionName;
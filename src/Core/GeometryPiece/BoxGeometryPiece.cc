@@ -99,6 +99,22 @@ BoxGeometryPiece::inside(const Point& p) const
                
 }
 
+GeometryPiece::Classification
+BoxGeometryPiece::classify(const Box& region) const
+{
+  const Point& lo = d_box.lower();
+  const Point& hi = d_box.upper();
+
+  if (region.lower() == Max(region.lower(), lo) && region.upper() == Min(region.upper(), hi))
+    return Inside;
+
+  if (region.upper().x() < lo.x() || region.upper().y() < lo.y() || region.upper().z() < lo.z() ||
+      region.lower().x() > hi.x() || region.lower().y() > hi.y() || region.lower().z() > hi.z())
+    return Outside;
+
+  return Boundary;
+}
+
 Box
 BoxGeometryPiece::getBoundingBox() const
 {
@@ -95,6 +95,10 @@ WARNING
 	 //////////
 	 // Determines whether a point is inside the box.
 	 virtual bool inside(const Point &p) const;
+
+	 //////////
+	 // Classifies a region exactly.
+	 virtual Classification classify(const Box& region) const;
 	 
 	 //////////
 	 //  Returns the bounding box surrounding the box (ie, the box itself).
@@ -108,6 +108,21 @@ DifferenceGeometryPiece::inside(const Point &p) const
   return (left_->inside(p) && !right_->inside(p));
 }
 
+GeometryPiece::Classification
+DifferenceGeometryPiece::classify(const Box& region) const
+{
+  Classification left = left_->classify(region);
+  if (left == Outside)
+    return Outside;
+
+  Classification right = right_->classify(region);
+  if (right == Inside)
+    return Outside;
+  if (left == Inside && right == Outside)
+    return Inside;
+  return Boundary;
+}
+
 Box
 DifferenceGeometryPiece::getBoundingBox() const
 {
@@ -107,6 +107,10 @@ WARNING
 	 //////////
 	 // Determines whether a point is inside the union Piece.
 	 virtual bool inside(const Point &p) const;
+
+	 //////////
+	 // Combines the classifications of the left and right pieces.
+	 virtual Classification classify(const Box& region) const;
 	 
 	 //////////
 	 // Returns the bounding box surrounding the union Piece.
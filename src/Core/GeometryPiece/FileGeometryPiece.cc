@@ -23,6 +23,8 @@
  */
 #include <Core/Exceptions/ProblemSetupException.h>
 #include <Core/GeometryPiece/FileGeometryPiece.h>
+#include <Core/GeometryPiece/PointBlockFile.h>
+#include <Core/Grid/Patch.h>
 #include <Core/Malloc/Allocator.h>
 #include <Core/Math/Matrix3.h>
 #include <Core/Parallel/Parallel.h>
@@ -124,7 +126,28 @@ FileGeometryPiece::FileGeometryPiece( ProblemSpecP & ps )
   ps->getWithDefault("usePFS",d_usePFS,true);
 
   Point min(1e30,1e30,1e30), max(-1e30,-1e30,-1e30);
-  if(d_usePFS){
+  if(d_file_format=="blocked"){
+    // A single file, written by ptsToBlocked, that every process maps.
+    // Only the header is read here, the points are read by patch.
+    d_usePFS = false;
+
+    PointBlockFile file;
+    file.open(d_file_name);
+
+    list<string> file_vars(file.vars().begin(), file.vars().end());
+    if(file_vars != d_vars){
+      std::ostringstream warn;
+      warn << "ERROR: the variables of the blocked points file (" << d_file_name << ")\n"
+           << "do not match the <var> tags of the geometry piece; the file has";
+      for(list<string>::const_iterator vit(file_vars.begin());vit!=file_vars.end();vit++){
+        warn << " " << *vit;
+      }
+      throw ProblemSetupException(warn.str(),__FILE__, __LINE__);
+    }
+
+    min = file.getBoundingBox().lower();
+    max = file.getBoundingBox().upper();
+  } else if(d_usePFS){
     // We must first read in the min and max from file.0 so
     // that we can determine the BoundingBox for the geometry
     string file_name = numbered_str(d_file_name+".", 0);
@@ -237,93 +260,49 @@ FileGeometryPiece::read_bbox(std::istream & source, Point & min,
   }
 }
 //______________________________________________________________________
+//  Number of columns (doubles) of each per point variable in the file
+int
+FileGeometryPiece::varColumns(const string& var)
+{
+  if (var=="p.volume" || var=="p.temperature" || var=="p.color") {
+    return 1;
+  } else if (var=="p.externalforce" || var=="p.fiberdir" || var=="p.velocity" ||
+             var=="p.rvec1" || var=="p.rvec2" || var=="p.rvec3") {
+    return 3;
+  }
+  return 0;
+}
+//______________________________________________________________________
+//  Columns of a point record: the position and the <var> columns
+int
+FileGeometryPiece::recordColumns() const
+{
+  int ncols = 3;
+  for(list<string>::const_iterator vit(d_vars.begin());vit!=d_vars.end();vit++) {
+    ncols += varColumns(*vit);
+  }
+  return ncols;
+}
+//______________________________________________________________________
 //
 bool
 FileGeometryPiece::read_line(std::istream & is, Point & xmin, Point & xmax)
 {
-  double x1,x2,x3;
+  int ncols = recordColumns();
+  vector<double> rec(ncols);
 
-  // CPTI and CPDI can pass the size matrix columns containing rvec1, rvec2, rvec3
-  // Other interpolators will default to grid spacing and default orientation
-  Matrix3 size(d_DX.x(),0.,0.,0.,d_DX.y(),0.,0.,0.,d_DX.z());
-  // grid spacing for normalizing size
-  Matrix3 gsize((1./d_DX.x()),0.,0.,0.,(1./d_DX.y()),0.,0.,0.,(1./d_DX.z()));
-  bool file_has_size=false;
-  bool file_has_volume=false;
- 
   //__________________________________
   //  TEXT FILE
   if(d_file_format=="text") {
-    double v1,v2,v3;
     
     // line always starts with coordinates
-    is >> x1 >> x2 >> x3;
+    is >> rec[0] >> rec[1] >> rec[2];
     if(is.eof()){
      return false; // out of points
     }
-    // Particle coordinates
-    d_points.push_back(Point(x1,x2,x3));
-    
-
-    for(list<string>::const_iterator vit(d_vars.begin());vit!=d_vars.end();vit++) {
-      if (*vit=="p.volume") {
-        if(is >> v1) {
-          cout << "v1 = " << v1 << endl;
-          d_volume.push_back(v1);
-          file_has_volume=true;
-        }
-      } else if(*vit=="p.temperature") {
-        if(is >> v1){
-          d_temperature.push_back(v1);
-        }
-      } else if(*vit=="p.color") {
-        if(is >> v1){
-          d_color.push_back(v1);
-        }
-      } else if(*vit=="p.externalforce") {
-        if(is >> v1 >> v2 >> v3){
-          d_forces.push_back(Vector(v1,v2,v3));
-        }
-      } else if(*vit=="p.fiberdir") {
-        if(is >> v1 >> v2 >> v3){
-          d_fiberdirs.push_back(Vector(v1,v2,v3));
-        }  
-      } else if(*vit=="p.rvec1") {
-        if(is >> v1 >> v2 >> v3){
-          d_rvec1.push_back(Vector(v1,v2,v3));
-          size(0,0)=v1;
-          size(1,0)=v2;
-          size(2,0)=v3;
-          file_has_size=true;
-        }  
-      } else if(*vit=="p.rvec2") {
-        if(is >> v1 >> v2 >> v3){
-          d_rvec2.push_back(Vector(v1,v2,v3));
-          size(0,1)=v1;
-          size(1,1)=v2;
-          size(2,1)=v3;
-          file_has_size=true;
-        }  
-      } else if(*vit=="p.rvec3") {
-        if(is >> v1 >> v2 >> v3){
-          d_rvec3.push_back(Vector(v1,v2,v3));
-          size(0,2)=v1;
-          size(1,2)=v2;
-          size(2,2)=v3;
-          file_has_size=true;
-        }  
-      } else if(*vit=="p.velocity") {
-        if(is >> v1 >> v2 >> v3){
-          d_velocity.push_back(Vector(v1,v2,v3));
-        }
-      }
 
-      if(!is) {
-        std::ostringstream warn;
-        warn << "Failed while reading point text point file \n"
-             << "Position: "<< Point(x1,x2,x3) << "\n"; 
-        throw ProblemSetupException(warn.str(), __FILE__, __LINE__);
-      }
+    for(int c = 3; c < ncols; c++) {
+      is >> rec[c];
     }
 
     //__________________________________
@@ -331,127 +310,91 @@ FileGeometryPiece::read_line(std::istream & is, Point & xmin, Point & xmax)
   } else if(d_file_format=="lsb" || d_file_format=="msb") {
     // read unformatted binary numbers
     
-    double v[3];
-    
     // never changes, should save this !
     const bool iamlittle = isLittleEndian();
     const bool needflip = (iamlittle && (d_file_format=="msb")) || (!iamlittle && (d_file_format=="lsb"));
 
-    is.read((char*)&x1, sizeof(double)); 
+    is.read((char*)&rec[0], sizeof(double)); 
     
     if(!is){
       return false;  // out of points
     }
     
-    is.read((char*)&x2, sizeof(double));
-    is.read((char*)&x3, sizeof(double));
+    is.read((char*)&rec[1], sizeof(double)*(ncols-1));
     if(needflip) {
-      swapbytes(x1);
-      swapbytes(x2);
-      swapbytes(x3);
-    }
-    d_points.push_back(Point(x1,x2,x3));
-    //__________________________________
-    //
-    for(list<string>::const_iterator vit(d_vars.begin());vit!=d_vars.end();vit++) {
-      if (*vit=="p.volume") {
-        if(is.read((char*)&v[0], sizeof(double))) {
-          if(needflip){ 
-            swapbytes(v[0]);
-          }
-          d_volume.push_back(v[0]);
-          file_has_volume=true;
-        }
-      } else if(*vit=="p.temperature") {
-        if(is.read((char*)&v[0], sizeof(double))) {
-          if(needflip){
-            swapbytes(v[0]);
-          }
-          d_temperature.push_back(v[0]);
-        }
-      } else if(*vit=="p.color") {
-        if(is.read((char*)&v[0], sizeof(double))) {
-          if(needflip){
-            swapbytes(v[0]);
-          }
-          d_color.push_back(v[0]);
-        }
-      } else if(*vit=="p.externalforce") {
-        if(is.read((char*)&v[0], sizeof(double)*3)) {
-          if(needflip) {
-            swapbytes(v[0]);
-            swapbytes(v[1]);
-            swapbytes(v[2]);
-          }
-          d_forces.push_back(Vector(v[0],v[1],v[2]));
-        }
-      } else if(*vit=="p.fiberdir") {
-        if(is.read((char*)&v[0], sizeof(double)*3)) {
-          if(needflip) {
-            swapbytes(v[0]);
-            swapbytes(v[1]);
-            swapbytes(v[2]);
-          }
-          d_fiberdirs.push_back(Vector(v[0],v[1],v[2]));
-        }
-      } else if(*vit=="p.rvec1") {
-        if(is.read((char*)&v[0], sizeof(double)*3)) {
-          if(needflip) {
-            swapbytes(v[0]);
-            swapbytes(v[1]);
-            swapbytes(v[2]);
-          }
-          d_rvec1.push_back(Vector(v[0],v[1],v[2]));
-          size(0,0)=v[0];
-          size(1,0)=v[1];
-          size(2,0)=v[2];
-          file_has_size=true;
-        }
-      } else if(*vit=="p.rvec2") {
-        if(is.read((char*)&v[0], sizeof(double)*3)) {
-          if(needflip) {
-            swapbytes(v[0]);
-            swapbytes(v[1]);
-            swapbytes(v[2]);
-          }
-          d_rvec2.push_back(Vector(v[0],v[1],v[2]));
-          size(0,1)=v[0];
-          size(1,1)=v[1];
-          size(2,1)=v[2];
-          file_has_size=true;
-        }
-      } else if(*vit=="p.rvec3") {
-        if(is.read((char*)&v[0], sizeof(double)*3)) {
-          if(needflip) {
-            swapbytes(v[0]);
-            swapbytes(v[1]);
-            swapbytes(v[2]);
-          }
-          d_rvec3.push_back(Vector(v[0],v[1],v[2]));
-          size(0,2)=v[0];
-          size(1,2)=v[1];
-          size(2,2)=v[2];
-          file_has_size=true;
-        }
-      } else if(*vit=="p.velocity") {
-        if(is.read((char*)&v[0], sizeof(double)*3)) {
-          if(needflip) {
-            swapbytes(v[0]);
-            swapbytes(v[1]);
-            swapbytes(v[2]);
-          }
-          d_velocity.push_back(Vector(v[0],v[1],v[2]));
-        }  
-      }          
-      if(!is){
-        std::ostringstream warn;
-        warn << "Failed while reading point text point file \n"
-             << "Position: "<< Point(x1,x2,x3) << "\n";
-        throw ProblemSetupException(warn.str(), __FILE__, __LINE__);
+      for(int c = 0; c < ncols; c++) {
+        swapbytes(rec[c]);
       }
-      
     }
   }
+
+  if(!is) {
+    std::ostringstream warn;
+    warn << "Failed while reading point text point file \n"
+         << "Position: "<< Point(rec[0],rec[1],rec[2]) << "\n"; 
+    throw ProblemSetupException(warn.str(), __FILE__, __LINE__);
+  }
+
+  addRecord(&rec[0]);
+
+  xmin = Min(xmin, Point(rec[0],rec[1],rec[2]));
+  xmax = Max(xmax, Point(rec[0],rec[1],rec[2]));
+  return true;
+}
+//______________________________________________________________________
+//  Add a point and its variables, from one record (x, y, z, then the
+//  columns of the vars, in order) of the file
+void
+FileGeometryPiece::addRecord(const double* rec)
+{
+  // CPTI and CPDI can pass the size matrix columns containing rvec1, rvec2, rvec3
+  // Other interpolators will default to grid spacing and default orientation
+  Matrix3 size(d_DX.x(),0.,0.,0.,d_DX.y(),0.,0.,0.,d_DX.z());
+  // grid spacing for normalizing size
+  Matrix3 gsize((1./d_DX.x()),0.,0.,0.,(1./d_DX.y()),0.,0.,0.,(1./d_DX.z()));
+  bool file_has_size=false;
+  bool file_has_volume=false;
+
+  // Particle coordinates
+  d_points.push_back(Point(rec[0],rec[1],rec[2]));
+
+  const double* v = rec + 3;
+  for(list<string>::const_iterator vit(d_vars.begin());vit!=d_vars.end();vit++) {
+    if (*vit=="p.volume") {
+      d_volume.push_back(v[0]);
+      file_has_volume=true;
+    } else if(*vit=="p.temperature") {
+      d_temperature.push_back(v[0]);
+    } else if(*vit=="p.color") {
+      d_color.push_back(v[0]);
+    } else if(*vit=="p.externalforce") {
+      d_forces.push_back(Vector(v[0],v[1],v[2]));
+    } else if(*vit=="p.fiberdir") {
+      d_fiberdirs.push_back(Vector(v[0],v[1],v[2]));
+    } else if(*vit=="p.rvec1") {
+      d_rvec1.push_back(Vector(v[0],v[1],v[2]));
+      size(0,0)=v[0];
+      size(1,0)=v[1];
+      size(2,0)=v[2];
+      file_has_size=true;
+    } else if(*vit=="p.rvec2") {
+      d_rvec2.push_back(Vector(v[0],v[1],v[2]));
+      size(0,1)=v[0];
+      size(1,1)=v[1];
+      size(2,1)=v[2];
+      file_has_size=true;
+    } else if(*vit=="p.rvec3") {
+      d_rvec3.push_back(Vector(v[0],v[1],v[2]));
+      size(0,2)=v[0];
+      size(1,2)=v[1];
+      size(2,2)=v[2];
+      file_has_size=true;
+    } else if(*vit=="p.velocity") {
+      d_velocity.push_back(Vector(v[0],v[1],v[2]));
+    }
+    v += varColumns(*vit);
+  }
+
   if(file_has_size){
     // CPTI and CPDI populate size matrix with Rvectors defining the particle domain in columns
     // proc0cout << endl << "<res> is ignored for CPDI and CPTI particle domain import." << endl;
@@ -478,10 +421,6 @@ FileGeometryPiece::read_line(std::istream & is, Point & xmin, Point & xmax)
     size = gsize*size;
     d_size.push_back(size);
   }
-
-  xmin = Min(xmin, Point(x1,x2,x3));
-  xmax = Max(xmax, Point(x1,x2,x3));
-  return true;
 }
 //______________________________________________________________________
 //
@@ -518,6 +457,69 @@ FileGeometryPiece::readPoints(int patchID)
 }
 //______________________________________________________________________
 //
+void
+FileGeometryPiece::readPoints(const Patch* patch)
+{
+  if(d_file_format!="blocked"){
+    readPoints(patch->getID());
+    return;
+  }
+
+  // Replace the points of the previous patch with those of the blocks
+  // that intersect this patch.  Only those blocks are paged in.
+  clearPoints();
+
+  Box region = patch->getExtraBox();
+
+  PointBlockFile file;
+  file.open(d_file_name);
+  int ncols = file.recordLength();
+
+  // addRecord() reads recordColumns() values of every record
+  if(ncols != recordColumns()){
+    std::ostringstream warn;
+    warn << "ERROR: the records of the blocked points file (" << d_file_name << ") have "
+         << ncols << " columns, the <var> tags of the geometry piece need " << recordColumns();
+    throw ProblemSetupException(warn.str(),__FILE__, __LINE__);
+  }
+
+  vector<double> values;
+  for(int b = 0; b < file.numBlocks(); b++){
+    if(!file.intersects(b, region)){
+      continue;
+    }
+    file.readBlock(b, values);
+
+    for(size_t r = 0; r < values.size(); r += ncols){
+      const double* rec = &values[r];
+      if(rec[0] < region.lower().x() || rec[0] > region.upper().x() ||
+         rec[1] < region.lower().y() || rec[1] > region.upper().y() ||
+         rec[2] < region.lower().z() || rec[2] > region.upper().z()){
+        continue;
+      }
+      addRecord(rec);
+    }
+  }
+}
+//______________________________________________________________________
+//
+void
+FileGeometryPiece::clearPoints()
+{
+  d_points.clear();
+  d_volume.clear();
+  d_temperature.clear();
+  d_color.clear();
+  d_forces.clear();
+  d_fiberdirs.clear();
+  d_velocity.clear();
+  d_rvec1.clear();
+  d_rvec2.clear();
+  d_rvec3.clear();
+  d_size.clear();
+}
+//______________________________________________________________________
+//
 unsigned int
 FileGeometryPiece::createPoints()
 {
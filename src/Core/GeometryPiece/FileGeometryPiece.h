@@ -35,6 +35,8 @@
 
 namespace Uintah {
 
+class Patch;
+
 /////////////////////////////////////////////////////////////////////////////
 /*!
 	
@@ -77,9 +79,15 @@ namespace Uintah {
     lsb   - least significant byte binary double
     msb   - most significant byte binary double
     bin   - use native binary ordering.
+    blocked - one binary file of points binned into spatial blocks, with
+              an index of the blocks in its header (see PointBlockFile).
+              It is mapped by every process, which only reads the blocks
+              that intersect its patches.  Make it from a text file with
+              StandAlone/tools/pfs/ptsToBlocked; usePFS is ignored.
     
-    Note, for all formats (text and binary), there needs to be a 128 line
-    buffer containing the bounding box of the whole data set in every file.
+    Note, for the split (PFS) formats (text and binary), there needs to be
+    a 128 line buffer containing the bounding box of the whole data set in
+    every file.
   
   If <var?> tags are present, extra fields values can be assigned to each 
   point.
@@ -128,6 +136,16 @@ namespace Uintah {
 
     void readPoints(int pid);
 
+    //////////
+    // Reads the points for a patch.  For blocked files the points of the
+    // previous patch are replaced with those in the patch's extra box,
+    // otherwise this is readPoints(patch->getID()).
+    void readPoints(const Patch* patch);
+
+    //////////
+    // True for blocked files, whose points are only read by readPoints(patch).
+    bool isBlocked() const { return d_file_format == "blocked"; }
+
     unsigned int createPoints();
 
     //////////////////////////////////////////////////////////////////////
@@ -147,6 +165,10 @@ namespace Uintah {
     void checkFileType(std::ifstream & source, std::string& fileType, std::string& filename);
     
     bool read_line(std::istream & is, Point & xmin, Point & xmax);
+    void addRecord(const double* rec);
+    void clearPoints();
+    static int varColumns(const std::string& var);
+    int recordColumns() const;
     void read_bbox(std::istream & source, Point & lowpt, Point & highpt) const;
     virtual void outputHelper( ProblemSpecP & ps ) const;
   };
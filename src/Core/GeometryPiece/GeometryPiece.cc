@@ -24,6 +24,7 @@
 
 
 #include <Core/GeometryPiece/GeometryPiece.h>
+#include <Core/Grid/Box.h>
 #include <Core/Util/DebugStream.h>
 
 using namespace Uintah;
@@ -72,3 +73,28 @@ GeometryPiece::outputProblemSpec( ProblemSpecP & ps ) const
   }
 }
 
+void
+GeometryPiece::insideBatch( const std::vector<Point> & points,
+                                  std::vector<bool>  & result ) const
+{
+  result.resize( points.size() );
+  for( unsigned i = 0; i < points.size(); i++ ) {
+    result[i] = inside( points[i] );
+  }
+}
+
+GeometryPiece::Classification
+GeometryPiece::classify( const Box & region ) const
+{
+  // pad the bounding box a little, for points on its faces
+  Box    box = getBoundingBox();
+  Vector pad = ( box.upper() - box.lower() ) * 1.e-12;
+  Point  lo  = box.lower() - pad;
+  Point  hi  = box.upper() + pad;
+
+  if( region.upper().x() < lo.x() || region.upper().y() < lo.y() || region.upper().z() < lo.z() ||
+      region.lower().x() > hi.x() || region.lower().y() > hi.y() || region.lower().z() > hi.z() ) {
+    return Outside;
+  }
+  return Boundary;
+}
@@ -34,6 +34,7 @@
 #include <Core/Geometry/Vector.h>
 
 #include   <string>
+#include   <vector>
 
 namespace Uintah {
 
@@ -97,6 +98,21 @@ public:
     // Insert Documentation Here:
   virtual bool inside(const Point &p) const = 0;
 
+  //////////
+  // Sets result[i] to inside(points[i]).  Pieces with an expensive
+  // inside() override this to test the points together.
+  virtual void insideBatch(const std::vector<Point>& points,
+                           std::vector<bool>& result) const;
+
+  // Classification of a region of space against the piece
+  enum Classification { Outside, Inside, Boundary };
+
+  //////////
+  // Classifies the closed, axis aligned region: Inside (Outside) only if
+  // inside() is true (false) for every point in it, otherwise Boundary.
+  // The default only finds the regions outside of the bounding box.
+  virtual Classification classify(const Box& region) const;
+
   std::string getName() const {
     return name_;
   }
@@ -93,6 +93,20 @@ IntersectionGeometryPiece::inside(const Point &p) const
   return true;
 }
 
+GeometryPiece::Classification
+IntersectionGeometryPiece::classify(const Box& region) const
+{
+  Classification result = Inside;
+  for( unsigned int i = 0; i < child_.size(); i++ ) {
+    Classification c = child_[i]->classify(region);
+    if (c == Outside)
+      return Outside;
+    if (c == Boundary)
+      result = Boundary;
+  }
+  return result;
+}
+
 Box
 IntersectionGeometryPiece::getBoundingBox() const
 {
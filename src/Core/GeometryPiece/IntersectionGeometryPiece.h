@@ -104,6 +104,10 @@ WARNING
          //////////
          // Determines whether a point is inside the intersection piece.  
          virtual bool inside(const Point &p) const;
+
+         //////////
+         // Combines the classifications of the children.
+         virtual Classification classify(const Box& region) const;
          
          //////////
          // Returns the bounding box surrounding the intersection piece.
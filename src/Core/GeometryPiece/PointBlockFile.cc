@@ -0,0 +1,232 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <Core/GeometryPiece/PointBlockFile.h>
+#include <Core/Exceptions/ProblemSetupException.h>
+#include <Core/Util/Endian.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Uintah;
+using namespace std;
+
+const char     PointBlockFile::MAGIC[8]      = { 'U', 'P', 'T', 'S', 'B', 'L', 'K', '1' };
+const uint64_t PointBlockFile::ENDIAN_MARKER = 0x0102030405060708ULL;
+
+//______________________________________________________________________
+//
+PointBlockFile::PointBlockFile()
+  : d_data( 0 )
+  , d_size( 0 )
+  , d_needFlip( false )
+  , d_recordLength( 0 )
+  , d_numPoints( 0 )
+{
+}
+
+PointBlockFile::~PointBlockFile()
+{
+  close();
+}
+
+//______________________________________________________________________
+//
+bool
+PointBlockFile::isPointBlockFile( const string & filename )
+{
+  ifstream source( filename.c_str(), ios::binary );
+  char magic[8];
+  if( !source.read( magic, sizeof(magic) ) ) {
+    return false;
+  }
+  return memcmp( magic, MAGIC, sizeof(magic) ) == 0;
+}
+
+//______________________________________________________________________
+//
+void
+PointBlockFile::open( const string & filename )
+{
+  close();
+  d_filename = filename;
+
+  int fd = ::open( filename.c_str(), O_RDONLY );
+  if( fd < 0 ) {
+    throw ProblemSetupException( "ERROR: opening points file '" + filename + "'\nFailed to find points file",
+                                 __FILE__, __LINE__ );
+  }
+
+  struct stat st;
+  if( fstat( fd, &st ) != 0 || st.st_size < (off_t)sizeof(Header) ) {
+    ::close( fd );
+    throw ProblemSetupException( "ERROR: points file '" + filename + "' is too short to be a blocked points file",
+                                 __FILE__, __LINE__ );
+  }
+
+  d_size = st.st_size;
+  void* data = mmap( 0, d_size, PROT_READ, MAP_SHARED, fd, 0 );
+  ::close( fd );
+  if( data == MAP_FAILED ) {
+    d_size = 0;
+    throw ProblemSetupException( "ERROR: mapping points file '" + filename + "' failed",
+                                 __FILE__, __LINE__ );
+  }
+  d_data = (char*)data;
+
+  //__________________________________
+  //  header
+  Header header;
+  memcpy( &header, d_data, sizeof(Header) );
+
+  if( memcmp( header.magic, MAGIC, sizeof(header.magic) ) != 0 ) {
+    close();
+    throw ProblemSetupException( "ERROR: '" + filename + "' is not a blocked points file",
+                                 __FILE__, __LINE__ );
+  }
+
+  d_needFlip = ( header.endian != ENDIAN_MARKER );
+  if( d_needFlip ) {
+    swapbytes( header.endian );
+    swapbytes( header.numVars );
+    swapbytes( header.recordLength );
+    swapbytes( header.numPoints );
+    swapbytes( header.numBlocks );
+    for( int i = 0; i < 3; i++ ) {
+      swapbytes( header.low[i] );
+      swapbytes( header.high[i] );
+    }
+  }
+
+  size_t index_end = sizeof(Header) + header.numVars * VAR_NAME_LENGTH + header.numBlocks * sizeof(Block);
+  if( header.endian != ENDIAN_MARKER || index_end > d_size ) {
+    close();
+    throw ProblemSetupException( "ERROR: the header of points file '" + filename + "' is corrupt",
+                                 __FILE__, __LINE__ );
+  }
+
+  d_recordLength = (int)header.recordLength;
+  d_numPoints    = (long)header.numPoints;
+  for( int i = 0; i < 3; i++ ) {
+    d_low[i]  = header.low[i];
+    d_high[i] = header.high[i];
+  }
+
+  //__________________________________
+  //  variable names and the block index
+  const char* names = d_data + sizeof(Header);
+  for( uint64_t v = 0; v < header.numVars; v++ ) {
+    const char* name = names + v * VAR_NAME_LENGTH;
+    d_vars.push_back( string( name, strnlen( name, VAR_NAME_LENGTH ) ) );
+  }
+
+  d_blocks.resize( header.numBlocks );
+  if( header.numBlocks > 0 ) {
+    memcpy( &d_blocks[0], names + header.numVars * VAR_NAME_LENGTH, header.numBlocks * sizeof(Block) );
+  }
+
+  for( unsigned b = 0; b < d_blocks.size(); b++ ) {
+    Block& block = d_blocks[b];
+    if( d_needFlip ) {
+      for( int i = 0; i < 3; i++ ) {
+        swapbytes( block.low[i] );
+        swapbytes( block.high[i] );
+      }
+      swapbytes( block.offset );
+      swapbytes( block.count );
+    }
+    if( block.offset + block.count * d_recordLength * sizeof(double) > d_size ) {
+      ostringstream msg;
+      msg << "ERROR: block " << b << " of points file '" << filename << "' extends past the end of the file";
+      close();
+      throw ProblemSetupException( msg.str(), __FILE__, __LINE__ );
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+void
+PointBlockFile::close()
+{
+  if( d_data ) {
+    munmap( d_data, d_size );
+  }
+  d_data = 0;
+  d_size = 0;
+  d_vars.clear();
+  d_blocks.clear();
+  d_recordLength = 0;
+  d_numPoints    = 0;
+}
+
+//______________________________________________________________________
+//
+Box
+PointBlockFile::getBoundingBox() const
+{
+  return Box( Point( d_low[0], d_low[1], d_low[2] ), Point( d_high[0], d_high[1], d_high[2] ) );
+}
+
+//______________________________________________________________________
+//
+bool
+PointBlockFile::intersects( int b, const Box & region ) const
+{
+  const Block& block = d_blocks[b];
+  for( int i = 0; i < 3; i++ ) {
+    if( block.high[i] < region.lower()(i) || block.low[i] > region.upper()(i) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//______________________________________________________________________
+//
+void
+PointBlockFile::readBlock( int b, vector<double> & values ) const
+{
+  const Block& block = d_blocks[b];
+  size_t n = block.count * d_recordLength;
+
+  values.resize( n );
+  if( n == 0 ) {
+    return;
+  }
+  memcpy( &values[0], d_data + block.offset, n * sizeof(double) );
+
+  if( d_needFlip ) {
+    for( size_t i = 0; i < n; i++ ) {
+      swapbytes( values[i] );
+    }
+  }
+}
@@ -0,0 +1,153 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef __POINT_BLOCK_FILE_H__
+#define __POINT_BLOCK_FILE_H__
+
+#include <Core/Grid/Box.h>
+#include <Core/Geometry/Point.h>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace Uintah {
+
+/**************************************
+
+CLASS
+   PointBlockFile
+
+   Read only, memory mapped access to a "blocked" particle points file.
+
+GENERAL INFORMATION
+
+   PointBlockFile.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+KEYWORDS
+   FileGeometryPiece points binary mmap
+
+DESCRIPTION
+   The points of a FileGeometryPiece, binned into spatial blocks so that
+   a process only has to read the blocks that intersect its patches.
+   The file (written by StandAlone/tools/pfs/ptsToBlocked) is:
+
+     Header                                     (see below)
+     char  varNames[numVars][VAR_NAME_LENGTH]   p.volume, p.fiberdir, ...
+     Block blocks[numBlocks]                    bounds, offset and count
+     double records[numPoints][recordLength]    x, y, z, var columns
+
+   The records of each block are contiguous.  Values are stored in the
+   byte order of the machine that wrote the file; the endian marker
+   tells the reader whether they need to be swapped.
+
+   open() maps the file and reads the header and the block index, the
+   records are only paged in by readBlock().
+
+WARNING
+   Instances can not be copied; open a file where it is needed.
+
+****************************************/
+
+class PointBlockFile {
+
+public:
+
+  enum { VAR_NAME_LENGTH = 32 };
+
+  struct Header {
+    char     magic[8];          // "UPTSBLK1"
+    uint64_t endian;            // ENDIAN_MARKER, as written
+    uint64_t numVars;
+    uint64_t recordLength;      // doubles per point
+    uint64_t numPoints;
+    uint64_t numBlocks;
+    double   low[3];            // bounds of all of the points
+    double   high[3];
+  };
+
+  struct Block {
+    double   low[3];            // bounds of the points in the block
+    double   high[3];
+    uint64_t offset;            // of the first record, in bytes from the start of the file
+    uint64_t count;             // number of records
+  };
+
+  static const char     MAGIC[8];
+  static const uint64_t ENDIAN_MARKER;
+
+  PointBlockFile();
+  ~PointBlockFile();
+
+  // Maps the file and reads its index.  Throws a ProblemSetupException
+  // if the file can not be read or is not a blocked points file.
+  void open( const std::string & filename );
+  void close();
+
+  // Is the file a blocked points file?  (Checks the magic number.)
+  static bool isPointBlockFile( const std::string & filename );
+
+  const std::vector<std::string> & vars() const { return d_vars; }
+  int  recordLength() const { return d_recordLength; }
+  long numPoints() const    { return d_numPoints; }
+  Box  getBoundingBox() const;
+
+  int  numBlocks() const { return (int)d_blocks.size(); }
+  const Block & getBlock( int b ) const { return d_blocks[b]; }
+
+  // Does the block's bounding box intersect the (closed) region?
+  bool intersects( int b, const Box & region ) const;
+
+  // Copies the records of block b, in native byte order, into values
+  // (recordLength() doubles per point).
+  void readBlock( int b, std::vector<double> & values ) const;
+
+private:
+
+  PointBlockFile( const PointBlockFile & );
+  PointBlockFile & operator=( const PointBlockFile & );
+
+  std::string              d_filename;
+  char                   * d_data;      // the mapped file
+  size_t                   d_size;
+  bool                     d_needFlip;
+
+  std::vector<std::string> d_vars;
+  int                      d_recordLength;
+  long                     d_numPoints;
+  double                   d_low[3];
+  double                   d_high[3];
+  std::vector<Block>       d_blocks;
+};
+
+} // End namespace Uintah
+
+#endif // __POINT_BLOCK_FILE_H__
@@ -29,6 +29,9 @@
 #include <Core/Exceptions/ProblemSetupException.h>
 #include <Core/Malloc/Allocator.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace Uintah;
 using namespace std;
 
@@ -91,6 +94,32 @@ SphereGeometryPiece::inside(const Point& p) const
   
 }
 
+GeometryPiece::Classification
+SphereGeometryPiece::classify(const Box& region) const
+{
+  const Point& lo = region.lower();
+  const Point& hi = region.upper();
+
+  double near2 = 0;
+  double far2  = 0;
+  for (int i = 0; i < 3; i++) {
+    double dlo = lo(i) - d_origin(i);
+    double dhi = hi(i) - d_origin(i);
+    double dnear = (dlo > 0) ? dlo : ((dhi < 0) ? dhi : 0);
+    double dfar  = std::max(std::fabs(dlo), std::fabs(dhi));
+    near2 += dnear * dnear;
+    far2  += dfar * dfar;
+  }
+
+  // leave the points within round off of the surface to inside()
+  double r2 = d_radius * d_radius;
+  if (far2 < r2 * (1.0 - 1.e-10))
+    return Inside;
+  if (near2 > r2 * (1.0 + 1.e-10))
+    return Outside;
+  return Boundary;
+}
+
 Box SphereGeometryPiece::getBoundingBox() const
 {
     Point lo(d_origin.x()-d_radius,d_origin.y()-d_radius,
@@ -98,6 +98,10 @@ public:
   //////////
   // Determines whether a point is inside the sphere. 
   virtual bool inside(const Point &p) const;
+
+  //////////
+  // Classifies a region by its nearest and farthest points from the origin.
+  virtual Classification classify(const Box& region) const;
          
   //////////
   // Returns the bounding box surrounding the box.
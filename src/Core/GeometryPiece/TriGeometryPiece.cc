@@ -55,14 +55,7 @@ TriGeometryPiece::TriGeometryPiece(ProblemSpecP &ps)
   
   // cout << "Triangulated surfaces read: \t" <<d_tri.size() <<endl;
 
-  list<Tri> tri_list;
-  Tri tri;
-
-  tri_list = tri.makeTriList(d_tri,d_points);
-  d_grid = scinew UniformGrid(d_box);
-  d_grid->buildUniformGrid(tri_list);
-			      
-
+  d_bvh.build(d_points,d_tri);
 }
 
 TriGeometryPiece::TriGeometryPiece(const TriGeometryPiece& copy)
@@ -72,9 +65,7 @@ TriGeometryPiece::TriGeometryPiece(const TriGeometryPiece& copy)
   d_tri = copy.d_tri;
   d_planes = copy.d_planes;
   d_boxes = copy.d_boxes;
-
-  d_grid = scinew UniformGrid(*copy.d_grid);
-
+  d_bvh = copy.d_bvh;
 }
 
 TriGeometryPiece& TriGeometryPiece::operator=(const TriGeometryPiece& rhs)
@@ -89,23 +80,19 @@ TriGeometryPiece& TriGeometryPiece::operator=(const TriGeometryPiece& rhs)
   d_planes.clear();
   d_boxes.clear();
 
-  delete d_grid;
-
   // Copy the rhs stuff
   d_box = rhs.d_box;
   d_points = rhs.d_points;
   d_tri = rhs.d_tri;
   d_planes = rhs.d_planes;
   d_boxes = rhs.d_boxes;
-
-  d_grid = scinew UniformGrid(*rhs.d_grid);
+  d_bvh = rhs.d_bvh;
 
   return *this;
 }
 
 TriGeometryPiece::~TriGeometryPiece()
 {
-  delete d_grid;
 }
 
 void
@@ -132,12 +119,33 @@ TriGeometryPiece::insideNew(const Point &p,int& cross) const
   if (!(p == Max(p,d_box.lower()) && p == Min(p,d_box.upper())))
     return false;
 
-  d_grid->countIntersections(p,cross);
-  //  cout << "Point " << p << " has " << cross << " crossings " << endl;
-  if (cross % 2)
-    return true;
-  else
-    return false;
+  return d_bvh.inside(p,cross);
+}
+
+void
+TriGeometryPiece::insideBatch(const std::vector<Point>& points,
+                              std::vector<bool>& result) const
+{
+  // the points inside the bounding box go to the BVH as one packet
+  std::vector<Point>    candidates;
+  std::vector<unsigned> index;
+  candidates.reserve(points.size());
+  index.reserve(points.size());
+
+  result.assign(points.size(), false);
+  for (unsigned i = 0; i < points.size(); i++) {
+    const Point& p = points[i];
+    if (p == Max(p,d_box.lower()) && p == Min(p,d_box.upper())) {
+      candidates.push_back(p);
+      index.push_back(i);
+    }
+  }
+
+  std::vector<bool> in;
+  d_bvh.insideBatch(candidates, in);
+  for (unsigned k = 0; k < index.size(); k++) {
+    result[index[k]] = in[k];
+  }
 }
 
 
@@ -158,10 +166,7 @@ TriGeometryPiece::inside(const Point &p) const
   if (!(p == Max(p,d_box.lower()) && p == Min(p,d_box.upper())))
     return false;
 #if 1
-  int cross_new = 0;
-  bool inside_new = insideNew(p,cross_new);
-
-  return inside_new;
+  return d_bvh.inside(p);
 #else 
       
   Vector infinity = Vector(1e10,0.,0.) - p.asVector();
@@ -221,6 +226,20 @@ TriGeometryPiece::inside(const Point &p) const
 #endif
 }
 
+GeometryPiece::Classification
+TriGeometryPiece::classify(const Box& region) const
+{
+  if (GeometryPiece::classify(region) == Outside)
+    return Outside;
+
+  // if no triangle is near the region, the whole region is on one side
+  // of the surface
+  if (d_bvh.overlaps(region))
+    return Boundary;
+
+  Point center = region.lower() + 0.5*(region.upper() - region.lower());
+  return inside(center) ? Inside : Outside;
+}
 
 Box
 TriGeometryPiece::getBoundingBox() const
@@ -362,10 +381,6 @@ TriGeometryPiece::insideTriangle( Point& q,int num,int& NCS,
   p[1] = d_points[d_tri[num].y()];
   p[2] = d_points[d_tri[num].z()];
 
-  Tri tri(p[0],p[1],p[2]);
-  //bool inside = tri.inside(q);
-  //  cout << "inside = " << inside << endl;
-
   // Now translate the points that make up the vertices of the triangle.
   Point trans_pt(0.,0.,0.), trans_vt[3];
   trans_vt[0] = Point(0.,0.,0.);
@@ -494,6 +509,7 @@ void TriGeometryPiece::scale(const double factor)
        itr++) {
     *itr = factor*(*itr - origin) + origin;
   }
+  d_bvh.build(d_points,d_tri);
 }
 
 double TriGeometryPiece::surfaceArea() const
@@ -26,7 +26,7 @@
 #define __TRI_GEOMETRY_OBJECT_H__
 
 #include <Core/GeometryPiece/GeometryPiece.h>
-#include <Core/GeometryPiece/UniformGrid.h>
+#include <Core/GeometryPiece/TriangleBVH.h>
 #include <Core/Grid/Box.h>
 
 #include <Core/Geometry/Point.h>
@@ -64,7 +64,9 @@ DESCRIPTION
    Creates a triangulated surface piece from the xml input file description.
    Requires one input: file name (convetion use suffix .dat).  
    There are methods for checking if a point is inside the surface
-   and also for determining the bounding box for the surface.
+   and also for determining the bounding box for the surface.  Inside
+   tests are done by ray casting against a bounding volume hierarchy of
+   the triangles (see TriangleBVH).
    The input form looks like this:
        <tri>
          <file>surface.dat</file>
@@ -99,6 +101,17 @@ WARNING
          // Determins whether a point is inside the triangulated surface.
          virtual bool inside(const Point &p) const;
          bool insideNew(const Point &p, int& cross) const;
+
+         //////////
+         // inside() for each of the points, with the rays of the points
+         // in the bounding box cast through the BVH together.
+         virtual void insideBatch(const std::vector<Point>& points,
+                                  std::vector<bool>& result) const;
+
+         //////////
+         // Boxes that no triangle's bounds intersect are entirely inside
+         // or outside of the surface.
+         virtual Classification classify(const Box& region) const;
          
          //////////
          // Returns the bounding box surrounding the triangulated surface.
@@ -125,7 +138,7 @@ WARNING
          std::vector<Plane>     d_planes;
          std::vector<Box>       d_boxes;
 
-         UniformGrid* d_grid;
+         TriangleBVH            d_bvh;
          
       };
 
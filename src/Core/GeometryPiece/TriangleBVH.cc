@@ -0,0 +1,667 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <Core/GeometryPiece/TriangleBVH.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace Uintah;
+using namespace std;
+
+namespace {
+
+  const int    MAX_LEAF_SIZE = 4;     // always make a leaf at this size
+  const int    MAX_SAH_LEAF  = 16;    // largest leaf the SAH may choose
+  const int    NUM_BINS      = 16;
+  const int    MAX_DEPTH     = 48;    // below this, split at the median
+  const int    STACK_SIZE    = 128;   // > MAX_DEPTH + log2(number of triangles)
+  const int    NUM_RAYS      = 4;
+  const int    NUM_FALLBACK  = 16;    // more directions, for points whose first rays are all ambiguous
+  const double BARY_TOL      = 1.e-9; // barycentric distance from an edge that is ambiguous
+
+  // Ray directions, chosen away from the coordinate axes and planes that
+  // meshes of man made objects are aligned with.
+  const double RAY_DIRS[NUM_RAYS][3] = { {  1.0,           0.3141592654,  0.2718281828 },
+                                         { -0.2718281828,  1.0,           0.3141592654 },
+                                         {  0.3141592654, -0.2718281828,  1.0          },
+                                         { -1.0,          -0.6180339887,  0.4142135624 } };
+
+  // The k-th of NUM_FALLBACK directions spread over the sphere (a
+  // Fibonacci lattice), none of them along an axis.
+  inline void fallbackDir( int k, double d[3] )
+  {
+    const double z   = 1.0 - ( 2.0 * k + 1.0 ) / NUM_FALLBACK;
+    const double r   = sqrt( 1.0 - z * z );
+    const double phi = 0.1 + 2.399963229728653 * k;     // golden angle
+    d[0] = r * cos( phi );
+    d[1] = r * sin( phi );
+    d[2] = z;
+  }
+
+  // the dir-th ray direction tried for a point
+  inline void rayDirection( int dir, double d[3] )
+  {
+    if( dir < NUM_RAYS ) {
+      d[0] = RAY_DIRS[dir][0];
+      d[1] = RAY_DIRS[dir][1];
+      d[2] = RAY_DIRS[dir][2];
+    }
+    else {
+      fallbackDir( dir - NUM_RAYS, d );
+    }
+  }
+
+  inline double dot( const double a[3], const double b[3] )
+  {
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+  }
+
+  inline void cross( const double a[3], const double b[3], double c[3] )
+  {
+    c[0] = a[1]*b[2] - a[2]*b[1];
+    c[1] = a[2]*b[0] - a[0]*b[2];
+    c[2] = a[0]*b[1] - a[1]*b[0];
+  }
+
+  inline double area( const double lo[3], const double hi[3] )
+  {
+    double dx = hi[0] - lo[0];
+    double dy = hi[1] - lo[1];
+    double dz = hi[2] - lo[2];
+    return dx*dy + dy*dz + dz*dx;
+  }
+
+  inline void emptyBounds( double lo[3], double hi[3] )
+  {
+    for( int i = 0; i < 3; i++ ) {
+      lo[i] =  DBL_MAX;
+      hi[i] = -DBL_MAX;
+    }
+  }
+
+  inline void grow( double lo[3], double hi[3], const double plo[3], const double phi[3] )
+  {
+    for( int i = 0; i < 3; i++ ) {
+      lo[i] = min( lo[i], plo[i] );
+      hi[i] = max( hi[i], phi[i] );
+    }
+  }
+}
+
+struct TriangleBVH::BuildItem {
+  double lo[3];
+  double hi[3];
+  double c[3];
+  int    tri;
+};
+
+//______________________________________________________________________
+//
+TriangleBVH::TriangleBVH() : d_eps(0)
+{
+}
+
+//______________________________________________________________________
+//
+void
+TriangleBVH::build( const vector<Point>     & points,
+                    const vector<IntVector> & triangles )
+{
+  d_nodes.clear();
+  d_tris.clear();
+
+  int n = (int)triangles.size();
+  if( n == 0 ) {
+    return;
+  }
+
+  vector<Triangle>  tris( n );
+  vector<BuildItem> items( n );
+  double lo[3], hi[3];
+  emptyBounds( lo, hi );
+
+  for( int t = 0; t < n; t++ ) {
+    const Point& p0 = points[ triangles[t].x() ];
+    const Point& p1 = points[ triangles[t].y() ];
+    const Point& p2 = points[ triangles[t].z() ];
+
+    BuildItem& item = items[t];
+    item.tri = t;
+    for( int i = 0; i < 3; i++ ) {
+      tris[t].v0[i] = p0(i);
+      tris[t].e1[i] = p1(i) - p0(i);
+      tris[t].e2[i] = p2(i) - p0(i);
+
+      item.lo[i] = min( p0(i), min( p1(i), p2(i) ) );
+      item.hi[i] = max( p0(i), max( p1(i), p2(i) ) );
+      item.c[i]  = 0.5 * ( item.lo[i] + item.hi[i] );
+    }
+    grow( lo, hi, item.lo, item.hi );
+  }
+
+  double diag = sqrt( (hi[0]-lo[0])*(hi[0]-lo[0]) + (hi[1]-lo[1])*(hi[1]-lo[1]) + (hi[2]-lo[2])*(hi[2]-lo[2]) );
+  d_eps = 1.e-10 * diag;
+
+  d_nodes.reserve( 2 * n / MAX_LEAF_SIZE + 1 );
+  buildNode( items, 0, n, 0 );
+
+  // store the triangles in the order of the leaves
+  d_tris.resize( n );
+  for( int t = 0; t < n; t++ ) {
+    d_tris[t] = tris[ items[t].tri ];
+  }
+}
+
+//______________________________________________________________________
+//
+int
+TriangleBVH::buildNode( vector<BuildItem> & items, int begin, int end, int depth )
+{
+  int index = (int)d_nodes.size();
+  d_nodes.push_back( Node() );
+
+  double lo[3], hi[3], clo[3], chi[3];
+  emptyBounds( lo, hi );
+  emptyBounds( clo, chi );
+  for( int t = begin; t < end; t++ ) {
+    grow( lo, hi, items[t].lo, items[t].hi );
+    grow( clo, chi, items[t].c, items[t].c );
+  }
+
+  Node& node = d_nodes[index];
+  for( int i = 0; i < 3; i++ ) {
+    node.lo[i] = lo[i];
+    node.hi[i] = hi[i];
+  }
+
+  int n = end - begin;
+  if( n <= MAX_LEAF_SIZE ) {
+    node.offset = begin;
+    node.count  = n;
+    return index;
+  }
+
+  //__________________________________
+  //  binned SAH split
+  int    best_axis = -1;
+  int    best_bin  = -1;
+  double best_cost = DBL_MAX;
+
+  for( int axis = 0; axis < 3; axis++ ) {
+    double extent = chi[axis] - clo[axis];
+    if( extent <= 0 ) {
+      continue;
+    }
+    double scale = NUM_BINS / extent;
+
+    int    counts[NUM_BINS];
+    double blo[NUM_BINS][3], bhi[NUM_BINS][3];
+    for( int b = 0; b < NUM_BINS; b++ ) {
+      counts[b] = 0;
+      emptyBounds( blo[b], bhi[b] );
+    }
+    for( int t = begin; t < end; t++ ) {
+      int b = min( NUM_BINS - 1, (int)( ( items[t].c[axis] - clo[axis] ) * scale ) );
+      counts[b]++;
+      grow( blo[b], bhi[b], items[t].lo, items[t].hi );
+    }
+
+    // areas and counts to the right of each bin boundary
+    double right_area[NUM_BINS];
+    int    right_count[NUM_BINS];
+    double rlo[3], rhi[3];
+    emptyBounds( rlo, rhi );
+    int count = 0;
+    for( int b = NUM_BINS - 1; b > 0; b-- ) {
+      grow( rlo, rhi, blo[b], bhi[b] );
+      count += counts[b];
+      right_area[b]  = count ? area( rlo, rhi ) : 0;
+      right_count[b] = count;
+    }
+
+    double llo[3], lhi[3];
+    emptyBounds( llo, lhi );
+    count = 0;
+    for( int b = 1; b < NUM_BINS; b++ ) {
+      grow( llo, lhi, blo[b-1], bhi[b-1] );
+      count += counts[b-1];
+      if( count == 0 || right_count[b] == 0 ) {
+        continue;
+      }
+      double cost = area( llo, lhi ) * count + right_area[b] * right_count[b];
+      if( cost < best_cost ) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin  = b;
+      }
+    }
+  }
+
+  // cost relative to making a leaf (one traversal step + the children)
+  double parent_area = area( lo, hi );
+  double split_cost  = parent_area > 0 ? 1.0 + best_cost / parent_area : DBL_MAX;
+
+  if( best_axis < 0 || ( split_cost >= n && n <= MAX_SAH_LEAF ) ) {
+    // (if all the centroids coincide, large lists are still split in two)
+    if( best_axis >= 0 || n <= MAX_SAH_LEAF ) {
+      node.offset = begin;
+      node.count  = n;
+      return index;
+    }
+  }
+
+  int mid = begin;
+  if( best_axis >= 0 && depth < MAX_DEPTH ) {
+    double scale = NUM_BINS / ( chi[best_axis] - clo[best_axis] );
+    double split_lo = clo[best_axis];
+    int    axis     = best_axis;
+    int    bin      = best_bin;
+    mid = (int)( std::partition( items.begin() + begin, items.begin() + end,
+                                 [=]( const BuildItem & item ) {
+                                   return min( NUM_BINS - 1, (int)( ( item.c[axis] - split_lo ) * scale ) ) < bin;
+                                 } ) - items.begin() );
+  }
+
+  if( mid == begin || mid == end ) {
+    // median split on the widest axis
+    int axis = 0;
+    for( int i = 1; i < 3; i++ ) {
+      if( chi[i] - clo[i] > chi[axis] - clo[axis] ) {
+        axis = i;
+      }
+    }
+    mid = begin + n / 2;
+    std::nth_element( items.begin() + begin, items.begin() + mid, items.begin() + end,
+                      [=]( const BuildItem & a, const BuildItem & b ) { return a.c[axis] < b.c[axis]; } );
+  }
+
+  buildNode( items, begin, mid, depth + 1 );
+  int right = buildNode( items, mid, end, depth + 1 );
+
+  // the node array may have been reallocated by the children
+  d_nodes[index].offset = right;
+  d_nodes[index].count  = 0;
+  return index;
+}
+
+//______________________________________________________________________
+//  Slab test of the ray o + t d, t in [-eps, infinity), against the node.
+bool
+TriangleBVH::hitsNode( const Node & node, const double o[3], const double inv_d[3] ) const
+{
+  double tmin = -d_eps;
+  double tmax = DBL_MAX;
+  for( int i = 0; i < 3; i++ ) {
+    double t0 = ( node.lo[i] - d_eps - o[i] ) * inv_d[i];
+    double t1 = ( node.hi[i] + d_eps - o[i] ) * inv_d[i];
+    if( t0 > t1 ) {
+      std::swap( t0, t1 );
+    }
+    tmin = max( tmin, t0 );
+    tmax = min( tmax, t1 );
+  }
+  return tmin <= tmax;
+}
+
+//______________________________________________________________________
+//  The parts of the Moller-Trumbore test that depend only on the
+//  triangle and the ray direction, shared by all the rays of a packet.
+void
+TriangleBVH::prepare( const Triangle & tri, const double d[3], TriRay & tr ) const
+{
+  cross( d, tri.e2, tr.pvec );
+  tr.det = dot( tri.e1, tr.pvec );
+
+  cross( tri.e1, tri.e2, tr.normal );
+  tr.norm     = sqrt( dot( tr.normal, tr.normal ) );
+  tr.parallel = tr.norm == 0 || fabs( tr.det ) <= 1.e-12 * tr.norm;
+  tr.inv_det  = tr.parallel ? 0 : 1.0 / tr.det;
+}
+
+//______________________________________________________________________
+//
+TriangleBVH::Hit
+TriangleBVH::intersect( const Triangle & tri, const TriRay & tr, const double d[3], const double o[3] ) const
+{
+  if( tr.norm == 0 ) {
+    return Miss;   // degenerate triangle
+  }
+
+  double tvec[3], qvec[3];
+  for( int i = 0; i < 3; i++ ) {
+    tvec[i] = o[i] - tri.v0[i];
+  }
+
+  if( tr.parallel ) {
+    // the ray is parallel to the triangle; ambiguous only if it lies in its plane
+    return fabs( dot( tvec, tr.normal ) ) / tr.norm <= d_eps ? Ambiguous : Miss;
+  }
+
+  double u = dot( tvec, tr.pvec ) * tr.inv_det;
+  if( u < -BARY_TOL || u > 1.0 + BARY_TOL ) {
+    return Miss;
+  }
+  cross( tvec, tri.e1, qvec );
+  double v = dot( d, qvec ) * tr.inv_det;
+  if( v < -BARY_TOL || u + v > 1.0 + BARY_TOL ) {
+    return Miss;
+  }
+  double dist = dot( tri.e2, qvec ) * tr.inv_det;
+
+  if( fabs( dist ) <= d_eps ) {
+    return OnSurface;
+  }
+  if( dist < 0 ) {
+    return Miss;
+  }
+  if( u < BARY_TOL || v < BARY_TOL || u + v > 1.0 - BARY_TOL ) {
+    return Ambiguous;   // through an edge or a vertex
+  }
+  return Crossing;
+}
+
+//______________________________________________________________________
+//
+bool
+TriangleBVH::castRay( const Point & p, const double dir[3], int & crossings, bool & onSurface ) const
+{
+  crossings = 0;
+  onSurface = false;
+  bool ambiguous = false;
+
+  double d[3], inv_d[3], o[3];
+  double len = sqrt( dot( dir, dir ) );
+  for( int i = 0; i < 3; i++ ) {
+    d[i]     = dir[i] / len;
+    inv_d[i] = 1.0 / d[i];
+    o[i]     = p(i);
+  }
+
+  int stack[STACK_SIZE];
+  int top = 0;
+  stack[top++] = 0;
+
+  while( top > 0 ) {
+    const Node& node = d_nodes[ stack[--top] ];
+
+    if( !hitsNode( node, o, inv_d ) ) {
+      continue;
+    }
+
+    if( node.count == 0 ) {
+      stack[top++] = (int)( &node - &d_nodes[0] ) + 1;
+      stack[top++] = node.offset;
+      continue;
+    }
+
+    for( int t = node.offset; t < node.offset + node.count; t++ ) {
+      TriRay tr;
+      prepare( d_tris[t], d, tr );
+
+      switch( intersect( d_tris[t], tr, d, o ) ) {
+        case OnSurface : onSurface = true; return true;
+        case Ambiguous : ambiguous = true; break;
+        case Crossing  : crossings++;      break;
+        case Miss      :                   break;
+      }
+    }
+  }
+  // the whole surface is traversed either way, so a point on the surface
+  // is found even when the count is ambiguous
+  return !ambiguous;
+}
+
+//______________________________________________________________________
+//  castRay() for many points in the same direction at once.  The packet
+//  of rays goes down the tree together: each node keeps the rays that
+//  hit its bounds, and each triangle is prepared once for all of them.
+void
+TriangleBVH::castRays( const vector<Point> & points, const double dir[3], vector<RayState> & rays ) const
+{
+  int n = (int)points.size();
+  rays.assign( n, RayState() );
+
+  double d[3], inv_d[3];
+  double len = sqrt( dot( dir, dir ) );
+  for( int i = 0; i < 3; i++ ) {
+    d[i]     = dir[i] / len;
+    inv_d[i] = 1.0 / d[i];
+  }
+
+  // the ray indices of the packets on the stack, each a segment of ids
+  struct Packet {
+    int node;
+    int begin;
+    int count;
+  };
+  vector<Packet> stack;
+  vector<int>    ids( n );
+  for( int r = 0; r < n; r++ ) {
+    ids[r] = r;
+  }
+  Packet root = { 0, 0, n };
+  stack.push_back( root );
+
+  while( !stack.empty() ) {
+    Packet packet = stack.back();
+    stack.pop_back();
+
+    // segments above this one belong to packets that are done
+    ids.resize( packet.begin + packet.count );
+
+    const Node& node = d_nodes[ packet.node ];
+
+    int begin = (int)ids.size();
+    for( int k = packet.begin; k < packet.begin + packet.count; k++ ) {
+      int r = ids[k];
+      if( rays[r].onSurface ) {
+        continue;
+      }
+      double o[3] = { points[r].x(), points[r].y(), points[r].z() };
+      if( hitsNode( node, o, inv_d ) ) {
+        ids.push_back( r );
+      }
+    }
+    int count = (int)ids.size() - begin;
+    if( count == 0 ) {
+      continue;
+    }
+
+    if( node.count == 0 ) {
+      Packet right = { node.offset, begin, count };
+      Packet left  = { packet.node + 1, begin, count };
+      stack.push_back( right );
+      stack.push_back( left );
+      continue;
+    }
+
+    for( int t = node.offset; t < node.offset + node.count; t++ ) {
+      const Triangle& tri = d_tris[t];
+      TriRay tr;
+      prepare( tri, d, tr );
+
+      for( int k = begin; k < begin + count; k++ ) {
+        RayState& ray = rays[ ids[k] ];
+        if( ray.onSurface ) {
+          continue;
+        }
+        double o[3] = { points[ ids[k] ].x(), points[ ids[k] ].y(), points[ ids[k] ].z() };
+        switch( intersect( tri, tr, d, o ) ) {
+          case OnSurface : ray.onSurface = true; break;
+          case Ambiguous : ray.ambiguous = true; break;
+          case Crossing  : ray.crossings++;      break;
+          case Miss      :                       break;
+        }
+      }
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+bool
+TriangleBVH::cleanCrossings( const Point & p, int & crossings, bool & onSurface, int firstDir ) const
+{
+  for( int dir = firstDir; dir < NUM_RAYS + NUM_FALLBACK; dir++ ) {
+    double d[3];
+    rayDirection( dir, d );
+
+    if( castRay( p, d, crossings, onSurface ) || onSurface ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//______________________________________________________________________
+//
+bool
+TriangleBVH::inside( const Point & p, int & crossings ) const
+{
+  crossings = 0;
+  if( d_nodes.empty() ) {
+    return false;
+  }
+
+  bool on_surface;
+  if( cleanCrossings( p, crossings, on_surface, 0 ) ) {
+    return on_surface || ( crossings % 2 == 1 );
+  }
+  // every direction grazes an edge, a vertex or lies in a triangle's
+  // plane: p is within round off of the surface
+  crossings = -1;
+  return true;
+}
+
+//______________________________________________________________________
+//
+bool
+TriangleBVH::inside( const Point & p ) const
+{
+  int crossings;
+  return inside( p, crossings );
+}
+
+//______________________________________________________________________
+//
+int
+TriangleBVH::crossings( const Point & p ) const
+{
+  int crossings;
+  inside( p, crossings );
+  return crossings;
+}
+
+//______________________________________________________________________
+//
+void
+TriangleBVH::insideBatch( const vector<Point> & points, vector<bool> & result ) const
+{
+  result.assign( points.size(), false );
+  if( d_nodes.empty() ) {
+    return;
+  }
+
+  // all the points along the first direction together, then the few
+  // with an ambiguous count one by one along the others
+  double d[3];
+  rayDirection( 0, d );
+  vector<RayState> rays;
+  castRays( points, d, rays );
+
+  for( unsigned r = 0; r < points.size(); r++ ) {
+    if( rays[r].onSurface ) {
+      result[r] = true;
+    }
+    else if( !rays[r].ambiguous ) {
+      result[r] = ( rays[r].crossings % 2 == 1 );
+    }
+    else {
+      int  count;
+      bool on_surface;
+      result[r] = !cleanCrossings( points[r], count, on_surface, 1 ) || on_surface || ( count % 2 == 1 );
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+bool
+TriangleBVH::overlaps( const Box & box ) const
+{
+  if( d_nodes.empty() ) {
+    return false;
+  }
+
+  double blo[3], bhi[3];
+  for( int i = 0; i < 3; i++ ) {
+    blo[i] = box.lower()(i) - d_eps;
+    bhi[i] = box.upper()(i) + d_eps;
+  }
+
+  int stack[STACK_SIZE];
+  int top = 0;
+  stack[top++] = 0;
+
+  while( top > 0 ) {
+    int index = stack[--top];
+    const Node& node = d_nodes[index];
+
+    bool hit = true;
+    for( int i = 0; i < 3; i++ ) {
+      if( node.hi[i] < blo[i] || node.lo[i] > bhi[i] ) {
+        hit = false;
+      }
+    }
+    if( !hit ) {
+      continue;
+    }
+
+    if( node.count == 0 ) {
+      stack[top++] = index + 1;
+      stack[top++] = node.offset;
+      continue;
+    }
+
+    for( int t = node.offset; t < node.offset + node.count; t++ ) {
+      const Triangle& tri = d_tris[t];
+      bool tri_hit = true;
+      for( int i = 0; i < 3; i++ ) {
+        double v0 = tri.v0[i];
+        double v1 = v0 + tri.e1[i];
+        double v2 = v0 + tri.e2[i];
+        if( max( v0, max( v1, v2 ) ) < blo[i] || min( v0, min( v1, v2 ) ) > bhi[i] ) {
+          tri_hit = false;
+        }
+      }
+      if( tri_hit ) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
@@ -0,0 +1,184 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef __TRIANGLE_BVH_H__
+#define __TRIANGLE_BVH_H__
+
+#include <Core/Grid/Box.h>
+#include <Core/Geometry/Point.h>
+#include <Core/Geometry/IntVector.h>
+#include <Core/Geometry/Vector.h>
+
+#include <vector>
+
+namespace Uintah {
+
+/**************************************
+        
+CLASS
+   TriangleBVH
+        
+   Bounding volume hierarchy over the triangles of a closed surface, for
+   point in solid tests.
+        
+GENERAL INFORMATION
+        
+   TriangleBVH.h
+        
+   Department of Computer Science
+   University of Utah
+        
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+        
+KEYWORDS
+   TriangleBVH TriGeometryPiece inside
+        
+DESCRIPTION
+   The hierarchy is built top down with the surface area heuristic
+   (binned over the triangle centroids) and stored as a flat array of
+   nodes in depth first order: the left child of an interior node follows
+   it, the index of the right child is stored in the node.
+
+   inside() counts the crossings of a ray from the point with the surface.
+   When the ray passes within round off of an edge or a vertex of a
+   triangle, or lies in its plane, the crossing count is ambiguous and the
+   ray is cast again in another direction; the first ray with a clean
+   count decides.  A few fixed directions are tried first, then more
+   spread over the sphere.  Points on the surface are inside, and so are
+   the (near surface) points for which no direction gives a clean count.
+
+   insideBatch() answers inside() for many points.  Their rays in the
+   first direction go down the tree together, as a packet that keeps at
+   each node only the rays that hit its bounds, so each node's bounds are
+   loaded and each triangle's direction dependent terms are computed once
+   for all of them.  Only the points with an ambiguous first count are
+   cast again, one by one.
+
+   overlaps() finds whether any triangle's bounds intersect a box, which
+   TriGeometryPiece::classify uses to find the boxes that are entirely
+   inside or outside of the surface.
+        
+WARNING
+   The surface is assumed to be closed (watertight).
+        
+****************************************/
+
+class TriangleBVH {
+
+public:
+
+  TriangleBVH();
+
+  // Builds the hierarchy over the triangles (vertex indices into points).
+  void build( const std::vector<Point>     & points,
+              const std::vector<IntVector> & triangles );
+
+  // Is the point inside the closed surface?
+  bool inside( const Point & p ) const;
+
+  // inside(), also returning the number of crossings of the surface by
+  // the first ray from p with a clean count, or -1 if there is none.
+  bool inside( const Point & p, int & crossings ) const;
+
+  // Number of crossings of the surface by the first ray from p with a
+  // clean count, or -1 if there is none.
+  int crossings( const Point & p ) const;
+
+  // inside() for each of the points, with the rays cast as a packet.
+  void insideBatch( const std::vector<Point> & points, std::vector<bool> & result ) const;
+
+  // Do the bounds of any triangle intersect the (closed) box?
+  bool overlaps( const Box & box ) const;
+
+  int numTriangles() const { return (int)d_tris.size(); }
+  int numNodes() const { return (int)d_nodes.size(); }
+
+private:
+
+  struct Node {
+    double lo[3];
+    double hi[3];
+    int    offset;      // first triangle (leaf), or right child (interior)
+    int    count;       // number of triangles, 0 for interior nodes
+  };
+
+  // a triangle, with its vertices copied for locality
+  struct Triangle {
+    double v0[3];
+    double e1[3];       // v1 - v0
+    double e2[3];       // v2 - v0
+  };
+
+  // the parts of the ray-triangle test that do not depend on the origin
+  struct TriRay {
+    double pvec[3];     // dir x e2
+    double det;
+    double inv_det;
+    double normal[3];   // e1 x e2
+    double norm;
+    bool   parallel;    // is the ray parallel to the triangle (or is it degenerate)?
+  };
+
+  enum Hit { Miss, Crossing, Ambiguous, OnSurface };
+
+  // the crossings of one ray of a packet
+  struct RayState {
+    RayState() : crossings(0), ambiguous(false), onSurface(false) {}
+    int  crossings;
+    bool ambiguous;
+    bool onSurface;
+  };
+
+  struct BuildItem;
+
+  int buildNode( std::vector<BuildItem> & items, int begin, int end, int depth );
+
+  bool hitsNode( const Node & node, const double o[3], const double inv_d[3] ) const;
+
+  void prepare( const Triangle & tri, const double d[3], TriRay & tr ) const;
+
+  // Does the ray from o in the (unit) direction d cross the triangle?
+  Hit intersect( const Triangle & tri, const TriRay & tr, const double d[3], const double o[3] ) const;
+
+  // Counts the crossings of the ray p + t dir (t > 0) over the whole
+  // surface.  Returns false if the count is ambiguous; sets onSurface if
+  // p is on a triangle.
+  bool castRay( const Point & p, const double dir[3], int & crossings, bool & onSurface ) const;
+
+  // castRay() for each of the points, all in the same direction.
+  void castRays( const std::vector<Point> & points, const double dir[3], std::vector<RayState> & rays ) const;
+
+  // castRay() in each direction from firstDir on until the count is clean
+  // or p is found on the surface; false if no direction gives a clean count.
+  bool cleanCrossings( const Point & p, int & crossings, bool & onSurface, int firstDir ) const;
+
+  std::vector<Node>     d_nodes;
+  std::vector<Triangle> d_tris;
+  double                d_eps;      // distance below which points are on the surface
+};
+
+} // End namespace Uintah
+
+#endif // __TRIANGLE_BVH_H__
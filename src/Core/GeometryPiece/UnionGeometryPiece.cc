@@ -102,6 +102,24 @@ UnionGeometryPiece::inside(const Point &p) const
 
 //------------------------------------------------------------------
 
+GeometryPiece::Classification
+UnionGeometryPiece::classify(const Box& region) const
+{
+  Classification result = Outside;
+  for (int i = 0; i < (int)child_.size(); i++) {
+    Classification c = child_[i]->classify(region);
+    if (c == Inside) {
+      return Inside;
+    }
+    if (c == Boundary) {
+      result = Boundary;
+    }
+  }
+  return result;
+}
+
+//------------------------------------------------------------------
+
 Box UnionGeometryPiece::getBoundingBox() const
 {
 
@@ -43,6 +43,7 @@ SRCS += \
 	$(SRCDIR)/NaaBoxGeometryPiece.cc         \
 	$(SRCDIR)/NullGeometryPiece.cc           \
 	$(SRCDIR)/PlaneShellPiece.cc             \
+	$(SRCDIR)/PointBlockFile.cc              \
 	$(SRCDIR)/ShellGeometryFactory.cc        \
 	$(SRCDIR)/ShellGeometryPiece.cc          \
 	$(SRCDIR)/SmoothCylGeomPiece.cc          \
@@ -52,6 +53,7 @@ SRCS += \
 	$(SRCDIR)/SphereShellPiece.cc            \
 	$(SRCDIR)/TorusGeometryPiece.cc          \
 	$(SRCDIR)/TriGeometryPiece.cc            \
+	$(SRCDIR)/TriangleBVH.cc                 \
 	$(SRCDIR)/UniformGrid.cc                 \
 	$(SRCDIR)/UnionGeometryPiece.cc          \
         $(SRCDIR)/EllipsoidGeometryPiece.cc      
@@ -29,8 +29,10 @@
 #include <CCA/Ports/DataWarehouse.h>
 #include <CCA/Ports/DataWarehouseP.h>
 #include <Core/Grid/Level.h>
+#include <Core/Grid/Variables/BlockRange.hpp>
 #include <Core/Grid/Variables/CCVariable.h>
 #include <Core/Grid/Variables/CellIterator.h>
+#include <Core/Grid/Variables/StencilView.h>
 #include <Core/Math/FastMatrix.h>
 #include <Core/Exceptions/InternalError.h>
 #include <Core/Geometry/IntVector.h>
@@ -43,6 +45,100 @@
 #define is_rightFace(face) ( (face == "xminus" || face == "yminus" ||  face == "zminus" ) ?1:0  )
 namespace Uintah {
 
+// find the normalized distance between the coarse and the fine cell cell-center
+ void normalizedDistance_CC(const int refineRatio,std::vector<double>& norm_dist);
+
+/*___________________________________________________________________
+ Class~ RefineStencil--
+ The interpolation stencils of the refine operators, for refinement
+ ratios of 1, 2 or 4 in each direction.  Every quantity the general
+ loops compute per fine cell depends on one index only, so it is
+ tabulated once per direction over the fine cells [fl, fh):  the coarse
+ cell, the normalized distance to its center and, for the linear
+ interpolation, the direction to the second coarse cell.  The kernels
+ using the tables do the same arithmetic as the general loops.
+ ____________________________________________________________________*/
+class RefineStencil {
+public:
+  static bool isCommonRatio(const Uintah::IntVector& r)
+  {
+    for (int d = 0; d < 3; d++) {
+      if (r[d] != 1 && r[d] != 2 && r[d] != 4) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // the tables are for the refinement ratio of the fine level
+  static bool applies(const Level* fineLevel, const Uintah::IntVector& refineRatio)
+  {
+    return refineRatio == fineLevel->getRefinementRatio() && isCommonRatio(refineRatio);
+  }
+
+  RefineStencil(const Uintah::IntVector& refineRatio,
+                const Uintah::IntVector& fl,
+                const Uintah::IntVector& fh)
+    : d_low(fl)
+  {
+    for (int d = 0; d < 3; d++) {
+      const int r = refineRatio[d];
+      std::vector<double> norm_dist(r);
+      normalizedDistance_CC(r, norm_dist);
+
+      const int n = fh[d] - fl[d];
+      d_coarse[d].resize(n);
+      d_dist[d].resize(n);
+      d_offset[d].resize(n);
+
+      for (int f = fl[d]; f < fh[d]; f++) {
+        // Level::mapCellToCoarser
+        const int c = (f >= 0) ? f / r : -((r - 1 - f) / r);
+        const double dist = norm_dist[f - c * r];
+
+        int i = Uintah::Sign(dist);
+        i *= Uintah::RoundUp(fabs(dist));
+
+        d_coarse[d][f - fl[d]] = c;
+        d_dist[d][f - fl[d]]   = dist;
+        d_offset[d][f - fl[d]] = i;
+      }
+    }
+  }
+
+  //__________________________________
+  //  At the edge of the computational domain the quadratic interpolation
+  //  shifts the base coarse cell inward one cell; the distance is then
+  //  measured from the center of the shifted cell.
+  void shiftInward(const Uintah::IntVector& gridLo,
+                   const Uintah::IntVector& gridHi)
+  {
+    for (int d = 0; d < 3; d++) {
+      for (unsigned f = 0; f < d_coarse[d].size(); f++) {
+        int shift = 0;
+        if ((d_coarse[d][f] - gridLo[d]) == 0) {
+          shift = 1;
+        }
+        if ((gridHi[d] - d_coarse[d][f]) == 0) {
+          shift = -1;
+        }
+        d_coarse[d][f] += shift;
+        d_dist[d][f]   -= shift;
+      }
+    }
+  }
+
+  inline int    coarse(const int d, const int f) const { return d_coarse[d][f - d_low[d]]; }
+  inline double dist(const int d, const int f)   const { return d_dist[d][f - d_low[d]]; }
+  inline int    offset(const int d, const int f) const { return d_offset[d][f - d_low[d]]; }
+
+private:
+  Uintah::IntVector   d_low;
+  std::vector<int>    d_coarse[3];    // coarse (base) cell
+  std::vector<double> d_dist[3];      // normalized distance to its center
+  std::vector<int>    d_offset[3];    // linear: -1, 0 or 1
+};
+
 /*___________________________________________________________________
  Function~ piecewiseConstantInterpolation--
  ____________________________________________________________________*/
@@ -53,6 +149,20 @@ template<class T>
                            const Uintah::IntVector& fh,
                            CCVariable<T>& q_FineLevel)
 {
+  //__________________________________
+  //  common refinement ratios
+  const Uintah::IntVector refineRatio = fineLevel->getRefinementRatio();
+  if (RefineStencil::applies(fineLevel, refineRatio)) {
+    const RefineStencil stencil(refineRatio, fl, fh);
+    StencilView<const T> q_coarse(q_CL);
+    StencilView<T>       q_fine(q_FineLevel);
+
+    Uintah::parallel_for(BlockRange(fl, fh), [&](int i, int j, int k) {
+      q_fine(i, j, k) = q_coarse(stencil.coarse(0, i), stencil.coarse(1, j), stencil.coarse(2, k));
+    });
+    return;
+  }
+
   for(CellIterator iter(fl,fh); !iter.done(); iter++){
     Uintah::IntVector f_cell = *iter;
     Uintah::IntVector c_cell = fineLevel->mapCellToCoarser(f_cell);
@@ -60,9 +170,6 @@ template<class T>
   }
 }
 
-// find the normalized distance between the coarse and the fine cell cell-center
- void normalizedDistance_CC(const int refineRatio,std::vector<double>& norm_dist);
-
 
 /*___________________________________________________________________
  Function~ linearInterpolation--
@@ -112,6 +219,38 @@ template<class T>
                            const Uintah::IntVector& fh,
                            CCVariable<T>& q_FineLevel)
 {
+  //__________________________________
+  //  common refinement ratios
+  if (RefineStencil::applies(fineLevel, refineRatio)) {
+    const RefineStencil stencil(refineRatio, fl, fh);
+    StencilView<const T> q_coarse(q_CL);
+    StencilView<T>       q_fine(q_FineLevel);
+    const long strideJ = q_coarse.strideJ();
+    const long strideK = q_coarse.strideK();
+
+    Uintah::parallel_for(BlockRange(fl, fh), [&](int fi, int fj, int fk) {
+      const T* q = &q_coarse(stencil.coarse(0, fi), stencil.coarse(1, fj), stencil.coarse(2, fk));
+      const long i = stencil.offset(0, fi);
+      const long j = stencil.offset(1, fj) * strideJ;
+      const long k = stencil.offset(2, fk) * strideK;
+
+      const double x = fabs(stencil.dist(0, fi));
+      const double y = fabs(stencil.dist(1, fj));
+      const double z = fabs(stencil.dist(2, fk));
+
+      const double w0 = (1.0 - x) * (1.0 - y);
+      const double w1 = x * (1.0 - y);
+      const double w2 = y * (1.0 - x);
+      const double w3 = x * y;
+
+      T q_XY_Plane_1 = w0 * q[0]     + w1 * q[i]     + w2 * q[j]     + w3 * q[i + j];
+      T q_XY_Plane_2 = w0 * q[k]     + w1 * q[i + k] + w2 * q[j + k] + w3 * q[i + j + k];
+
+      q_fine(fi, fj, fk) = (1.0 - z) * q_XY_Plane_1 + z * q_XY_Plane_2;
+    });
+    return;
+  }
+
   // compute the normalized distance between the fine and coarse cell centers
   std::vector<double> norm_dist_x(refineRatio.x());
   std::vector<double> norm_dist_y(refineRatio.y());
@@ -250,6 +389,55 @@ template<class T>
 
   gridHi -= Uintah::IntVector(1,1,1);
 
+  //__________________________________
+  //  common refinement ratios
+  if (RefineStencil::applies(fineLevel, refineRatio)) {
+    RefineStencil stencil(refineRatio, fl, fh);
+    stencil.shiftInward(gridLo, gridHi);
+
+    StencilView<const T> q_coarse(q_CL);
+    StencilView<T>       q_fine(q_FineLevel);
+    const long strideJ = q_coarse.strideJ();
+    const long strideK = q_coarse.strideK();
+
+    Uintah::parallel_for(BlockRange(fl, fh), [&](int fi, int fj, int fk) {
+      const T* q = &q_coarse(stencil.coarse(0, fi), stencil.coarse(1, fj), stencil.coarse(2, fk));
+
+      const double x = stencil.dist(0, fi);
+      const double y = stencil.dist(1, fj);
+      const double z = stencil.dist(2, fk);
+
+      const double w0_x =  0.5 * x  * (x - 1.0);
+      const double w1_x = -(x + 1.0)* (x - 1.0);
+      const double w2_x =  0.5 * x  * (x + 1.0);
+
+      const double w0_y =  0.5 * y  * (y - 1.0);
+      const double w1_y = -(y + 1.0)* (y - 1.0);
+      const double w2_y =  0.5 * y  * (y + 1.0);
+
+      const double w0_z =  0.5 * z  * (z - 1.0);
+      const double w1_z = -(z + 1.0)* (z - 1.0);
+      const double w2_z =  0.5 * z  * (z + 1.0);
+
+      const double w00 = w0_x * w0_y, w10 = w1_x * w0_y, w20 = w2_x * w0_y;
+      const double w01 = w0_x * w1_y, w11 = w1_x * w1_y, w21 = w2_x * w1_y;
+      const double w02 = w0_x * w2_y, w12 = w1_x * w2_y, w22 = w2_x * w2_y;
+
+      T q_XY_Plane[3];
+      for (int p = 0; p < 3; p++) {
+        const T* qk = q + (p - 1) * strideK;
+        q_XY_Plane[p] = w00 * qk[-1 - strideJ] + w10 * qk[-strideJ] + w20 * qk[1 - strideJ]
+                      + w01 * qk[-1]           + w11 * qk[0]        + w21 * qk[1]
+                      + w02 * qk[-1 + strideJ] + w12 * qk[strideJ]  + w22 * qk[1 + strideJ];
+      }
+
+      q_fine(fi, fj, fk) = w0_z * q_XY_Plane[0]
+                         + w1_z * q_XY_Plane[1]
+                         + w2_z * q_XY_Plane[2];
+    });
+    return;
+  }
+
   // compute the normalized distance between the fine and coarse cell centers
   std::vector<double> norm_dist_x(refineRatio.x());
   std::vector<double> norm_dist_y(refineRatio.y());
@@ -281,13 +469,14 @@ template<class T>
     //__________________________________
     // compute the index of the fine cell, relative to the
     // coarse cell center.  Find the distance the normalized distance between
-    // the coarse and fine cell-centers
-    Uintah::IntVector relativeIndx = f_cell - (baseCell * refineRatio);
+    // the coarse and fine cell-centers; a shifted base cell is (shift)
+    // coarse cells further away.
+    Uintah::IntVector relativeIndx = f_cell - (c_cell * refineRatio);
 
     Vector dist;
-    dist.x(norm_dist_x[relativeIndx.x()]);
-    dist.y(norm_dist_y[relativeIndx.y()]);
-    dist.z(norm_dist_z[relativeIndx.z()]);
+    dist.x(norm_dist_x[relativeIndx.x()] - shift.x());
+    dist.y(norm_dist_y[relativeIndx.y()] - shift.y());
+    dist.z(norm_dist_z[relativeIndx.z()] - shift.z());
 
     //__________________________________
     //  Find the weights
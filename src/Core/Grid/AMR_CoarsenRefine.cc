@@ -28,6 +28,8 @@
 #include <Core/Geometry/Vector.h>
 #include <Core/Grid/AMR.h>
 #include <Core/Grid/Level.h>
+#include <Core/Grid/Variables/BlockRange.hpp>
+#include <Core/Grid/Variables/StencilView.h>
 #include <Core/Util/DebugStream.h>
 
 using namespace std;
@@ -35,6 +37,103 @@ using namespace std;
 namespace Uintah {
 
 static Uintah::DebugStream cout_dbg("AMR_CoarsenRefine", false);
+
+namespace {
+
+//______________________________________________________________________
+//  The coarsening kernels for refinement ratios of 1, 2 or 4 in each
+//  direction.  They are used when every fine cell of the coarse cells
+//  [cl, ch) lies inside the fine range [fl, fh) and the coarse indices are not
+//  negative, so the fine cells of coarse cell c are c*r to c*r + r - 1.
+//  The fine cells are added in the same order as the general loops,
+//  so the results are identical.
+bool isCommonRatio( const IntVector& r )
+{
+  for (int d = 0; d < 3; d++) {
+    if ( r[d] != 1 && r[d] != 2 && r[d] != 4 ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool coversCoarseRange( const IntVector& cl,
+                        const IntVector& ch,
+                        const IntVector& fl,
+                        const IntVector& fh,
+                        const IntVector& r )
+{
+  for (int d = 0; d < 3; d++) {
+    if ( cl[d] < 0 || ch[d] <= cl[d] ||
+         cl[d] * r[d] < fl[d] || ch[d] * r[d] > fh[d] ) {
+      return false;
+    }
+  }
+  return isCommonRatio( r );
+}
+
+template<typename T, int RX>
+void coarsenBlock( const IntVector& cl,
+                   const IntVector& ch,
+                   const IntVector& r,
+                   const double ratio,
+                   constCCVariable<T>& fine_q_CC,
+                   CCVariable<T>& coarse_q_CC )
+{
+  StencilView<const T> fine( fine_q_CC );
+  StencilView<T>       coarse( coarse_q_CC );
+  const int ry = r.y();
+  const int rz = r.z();
+  const T zero( 0.0 );
+
+  Uintah::parallel_for( BlockRange( cl, ch ), [&]( int i, int j, int k ) {
+    T q_CC_tmp( zero );
+    for (int kk = 0; kk < rz; kk++) {
+      for (int jj = 0; jj < ry; jj++) {
+        StencilLine<const T> line = fine.line( j * ry + jj, k * rz + kk );
+        for (int ii = 0; ii < RX; ii++) {
+          q_CC_tmp += line[i * RX + ii];
+        }
+      }
+    }
+    coarse(i, j, k) = q_CC_tmp * ratio;
+  });
+}
+
+template<typename T, int RX>
+void coarsenBlock_massWeighted( const IntVector& cl,
+                                const IntVector& ch,
+                                const IntVector& r,
+                                constCCVariable<double>& cMass,
+                                constCCVariable<T>& fine_q_CC,
+                                CCVariable<T>& coarse_q_CC )
+{
+  StencilView<const T>      fine( fine_q_CC );
+  StencilView<const double> mass( cMass );
+  StencilView<T>            coarse( coarse_q_CC );
+  const int ry = r.y();
+  const int rz = r.z();
+  const T zero( 0.0 );
+
+  Uintah::parallel_for( BlockRange( cl, ch ), [&]( int i, int j, int k ) {
+    T q_CC_tmp( zero );
+    double mass_CC_tmp = 0.;
+    for (int kk = 0; kk < rz; kk++) {
+      for (int jj = 0; jj < ry; jj++) {
+        StencilLine<const T>      q_line = fine.line( j * ry + jj, k * rz + kk );
+        StencilLine<const double> m_line = mass.line( j * ry + jj, k * rz + kk );
+        for (int ii = 0; ii < RX; ii++) {
+          q_CC_tmp    += q_line[i * RX + ii] * m_line[i * RX + ii];
+          mass_CC_tmp += m_line[i * RX + ii];
+        }
+      }
+    }
+    coarse(i, j, k) = q_CC_tmp / mass_CC_tmp;
+  });
+}
+
+}  // end anonymous namespace
+
 //______________________________________________________________________
 //
 template<typename T>
@@ -48,6 +147,28 @@ void coarsenDriver_std(const IntVector& cl,
                        constCCVariable<T>& fine_q_CC,
                        CCVariable<T>& coarse_q_CC )
 {
+  //__________________________________
+  //  common refinement ratios
+  if ( coversCoarseRange( cl, ch, fl, fh, refinementRatio ) ) {
+    #if SCI_ASSERTION_LEVEL > 0
+      double count = refinementRatio.x() * refinementRatio.y() * refinementRatio.z();
+      if ( (fabs(ratio - 1.0/count) > 2 * DBL_EPSILON) && ratio != 1 ) {
+        std::ostringstream msg;
+        msg << " ERROR:  coarsenDriver_std: coarse cells " << cl << " " << ch << "\n"
+            <<  "(" << count << ") fine level cells are used to compute each coarse cell value."
+            << " There should have been ("<< 1/ratio << ") cells used";
+        throw InternalError(msg.str(),__FILE__,__LINE__);
+      }
+    #endif
+
+    switch ( refinementRatio.x() ) {
+      case 1: coarsenBlock<T, 1>( cl, ch, refinementRatio, ratio, fine_q_CC, coarse_q_CC ); break;
+      case 2: coarsenBlock<T, 2>( cl, ch, refinementRatio, ratio, fine_q_CC, coarse_q_CC ); break;
+      case 4: coarsenBlock<T, 4>( cl, ch, refinementRatio, ratio, fine_q_CC, coarse_q_CC ); break;
+    }
+    return;
+  }
+
   T zero(0.0);
   // iterate over coarse level cells
   for(CellIterator iter(cl, ch); !iter.done(); iter++){
@@ -99,6 +220,17 @@ void coarsenDriver_massWeighted( const IntVector & cl,
                                  constCCVariable<T>& fine_q_CC,
                                  CCVariable<T>& coarse_q_CC )
 {
+  //__________________________________
+  //  common refinement ratios
+  if ( coversCoarseRange( cl, ch, fl, fh, refinementRatio ) ) {
+    switch ( refinementRatio.x() ) {
+      case 1: coarsenBlock_massWeighted<T, 1>( cl, ch, refinementRatio, cMass, fine_q_CC, coarse_q_CC ); break;
+      case 2: coarsenBlock_massWeighted<T, 2>( cl, ch, refinementRatio, cMass, fine_q_CC, coarse_q_CC ); break;
+      case 4: coarsenBlock_massWeighted<T, 4>( cl, ch, refinementRatio, cMass, fine_q_CC, coarse_q_CC ); break;
+    }
+    return;
+  }
+
   T zero(0.0);
   // iterate over coarse level cells
   for(CellIterator iter(cl, ch); !iter.done(); iter++){
@@ -46,6 +46,7 @@
 #include <atomic>
 #include <mutex>
 #include <algorithm>
+#include <climits>
 #include <cmath>
 #include <iostream>
 #include <map>
@@ -64,6 +65,7 @@ static std::atomic<int32_t> ids{0};
 static std::mutex           ids_init{};
 static DebugStream bcout{  "BCTypes", false};
 static DebugStream rgtimes{"RGTimes", false};
+static DebugStream neighborhood_dbg{"LevelNeighborhood", false};
 
 //______________________________________________________________________
 //
@@ -84,6 +86,7 @@ Level::Level(       Grid      * grid,
   d_each_patch  = 0;
   d_all_patches = 0;
   d_bvh         = nullptr;
+  d_neighborhoodBVH = nullptr;
   d_finalized   = false;
   d_extraCells  = IntVector(0,0,0);
   d_totalCells  = 0;
@@ -106,6 +109,7 @@ Level::~Level()
   }
 
   delete d_bvh;
+  delete d_neighborhoodBVH;
   
   if( d_each_patch && d_each_patch->removeReference()) {
     delete d_each_patch;
@@ -223,7 +227,7 @@ Level::getPatchFromPoint( const Point& p, const bool includeExtraCells ) const
   selectType patch;
   IntVector c=getCellIndex(p);
   //point is within the bounding box so query the bvh
-  d_bvh->query(c,c+IntVector(1,1,1), patch,includeExtraCells);
+  queryBVH(c,c+IntVector(1,1,1), patch,includeExtraCells);
 
   if(patch.size()==0){
     return 0;
@@ -240,7 +244,7 @@ Level::getPatchFromIndex( const IntVector& c, const bool includeExtraCells ) con
   selectType patch;
   
   // Point is within the bounding box so query the bvh.
-  d_bvh->query(c,c+IntVector(1,1,1), patch,includeExtraCells);
+  queryBVH(c,c+IntVector(1,1,1), patch,includeExtraCells);
 
   if(patch.size()==0){
     return 0;
@@ -521,6 +525,9 @@ Level::positionToIndex( const Point & p ) const
 void Level::selectPatches(const IntVector& low, const IntVector& high,
                           selectType& neighbors, bool withExtraCells, bool cache) const
 {
+  // with a neighborhood, only the queries in it are cached
+  cache = cache && (d_neighborhoodBVH == nullptr || inNeighborhood(low, high));
+
   if (cache) {
     // look it up in the cache first
     patch_cache_monitor patch_cache_read_lock{ Uintah::CrowdMonitor<patch_cache_tag>::READER };
@@ -539,7 +546,7 @@ void Level::selectPatches(const IntVector& low, const IntVector& high,
   }
 
    //cout << Parallel::getMPIRank() << " Level Query: " << low << " " << high << endl;
-   d_bvh->query(low, high, neighbors, withExtraCells);
+   queryBVH(low, high, neighbors, withExtraCells);
    sort(neighbors.begin(), neighbors.end(), Patch::Compare());
 
 #ifdef CHECK_SELECT
@@ -580,6 +587,123 @@ void Level::selectPatches(const IntVector& low, const IntVector& high,
   }
 }
 
+//______________________________________________________________________
+//  Query the neighborhood's BVH if [low, high) lies in one of its regions,
+//  otherwise the level's, which is built on demand and kept.
+void
+Level::queryBVH( const IntVector & low, const IntVector & high,
+                 selectType & patches, bool withExtraCells ) const
+{
+  if (d_neighborhoodBVH != nullptr && inNeighborhood(low, high)) {
+    d_neighborhoodBVH->query(low, high, patches, withExtraCells);
+    return;
+  }
+
+  PatchBVH* bvh = nullptr;
+  {
+    patch_cache_monitor bvh_read_lock{ Uintah::CrowdMonitor<patch_cache_tag>::READER };
+    bvh = d_bvh;
+  }
+
+  if (bvh == nullptr) {
+    patch_cache_monitor bvh_write_lock{ Uintah::CrowdMonitor<patch_cache_tag>::WRITER };
+    if (d_bvh == nullptr) {
+      if (d_neighborhoodBVH != nullptr) {
+        static ProgressiveWarning warn("Level: a patch query outside of this rank's neighborhood rebuilt the BVH of the whole level"
+                                       " (<LoadBalancer><neighborhoodPatchQueries>)", 10);
+        warn.invoke();
+      }
+      d_bvh = scinew PatchBVH(d_virtualAndRealPatches);
+    }
+    bvh = d_bvh;
+  }
+
+  bvh->query(low, high, patches, withExtraCells);
+}
+
+//______________________________________________________________________
+//  Is [low, high) in one of the neighborhood's regions?  Then every patch
+//  it can select is in the neighborhood.
+bool
+Level::inNeighborhood( const IntVector & low, const IntVector & high ) const
+{
+  if (low.x() >= high.x() || low.y() >= high.y() || low.z() >= high.z()) {
+    return true;   // selects nothing
+  }
+  if (low.x()  < d_neighborhoodLow.x()  || low.y()  < d_neighborhoodLow.y()  || low.z()  < d_neighborhoodLow.z() ||
+      high.x() > d_neighborhoodHigh.x() || high.y() > d_neighborhoodHigh.y() || high.z() > d_neighborhoodHigh.z()) {
+    return false;
+  }
+
+  for (unsigned i = 0; i < d_neighborhoodRegions.size(); i++) {
+    const IntVector& l = d_neighborhoodRegions[i].first;
+    const IntVector& h = d_neighborhoodRegions[i].second;
+    if (low.x()  >= l.x() && low.y()  >= l.y() && low.z()  >= l.z() &&
+        high.x() <= h.x() && high.y() <= h.y() && high.z() <= h.z()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//______________________________________________________________________
+//
+bool
+Level::inNeighborhood( const Patch * patch ) const
+{
+  return binary_search(d_neighborhood.begin(), d_neighborhood.end(), patch);
+}
+
+//______________________________________________________________________
+//
+void
+Level::setNeighborhood( const vector<const Patch*> & patches, const IntVector & halo ) const
+{
+  // the queries are not running: this is between timesteps, but the
+  // cache and the BVHs change under the lock that guards them anyway
+  patch_cache_monitor neighborhood_write_lock{ Uintah::CrowdMonitor<patch_cache_tag>::WRITER };
+
+  delete d_neighborhoodBVH;
+  d_neighborhoodBVH = nullptr;
+  d_neighborhood.clear();
+  d_neighborhoodRegions.clear();
+  d_neighborhoodLow  = IntVector(INT_MAX, INT_MAX, INT_MAX);
+  d_neighborhoodHigh = IntVector(INT_MIN, INT_MIN, INT_MIN);
+
+  if (d_bvh == nullptr) {
+    d_bvh = scinew PatchBVH(d_virtualAndRealPatches);
+  }
+
+  // the patches and every patch that a query in their halo can select
+  for (unsigned i = 0; i < patches.size(); i++) {
+    IntVector low  = patches[i]->getExtraCellLowIndex()  - halo;
+    IntVector high = patches[i]->getExtraCellHighIndex() + halo;
+    d_neighborhoodRegions.push_back(make_pair(low, high));
+    d_neighborhoodLow  = Min(d_neighborhoodLow, low);
+    d_neighborhoodHigh = Max(d_neighborhoodHigh, high);
+
+    selectType selected;
+    d_bvh->query(low, high, selected, true);
+    for (int j = 0; j < selected.size(); j++) {
+      d_neighborhood.push_back(selected[j]);
+    }
+  }
+  sort(d_neighborhood.begin(), d_neighborhood.end());
+  d_neighborhood.erase(unique(d_neighborhood.begin(), d_neighborhood.end()), d_neighborhood.end());
+
+  d_neighborhoodBVH = scinew PatchBVH(d_neighborhood);
+
+  // The level's BVH and the cached queries outside of the neighborhood
+  // are released, the BVH until a query outside of the neighborhood.
+  d_selectCache.clear();
+  delete d_bvh;
+  d_bvh = nullptr;
+
+  neighborhood_dbg << Parallel::getMPIRank() << " Level " << d_index << " neighborhood of " << patches.size()
+                   << " patches and their halo " << halo << ": " << d_neighborhood.size() << " of "
+                   << d_virtualAndRealPatches.size() << " patches\n";
+}
+
 //______________________________________________________________________
 //
 bool Level::containsPointIncludingExtraCells(const Point& p) const
@@ -838,8 +962,9 @@ void Level::setBCTypes()
       
       patch->getFace(face, IntVector(0,0,0), IntVector(1,1,1), l, h);
       
+      // (these queries are not repeated, so they are not cached)
       Patch::selectType neighbors;
-      selectPatches(l, h, neighbors);
+      selectPatches(l, h, neighbors, false, false);
       
       if(neighbors.size() == 0){
         if(d_index != 0){
@@ -867,7 +992,7 @@ void Level::setBCTypes()
             coarseHigh[2]++;
           }
 #endif
-          coarseLevel->selectPatches(coarseLow, coarseHigh, neighbors);
+          coarseLevel->selectPatches(coarseLow, coarseHigh, neighbors, false, false);
           
           if(neighbors.size() == 0){
             bitfield|=Patch::None;
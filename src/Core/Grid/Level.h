@@ -228,6 +228,23 @@ public:
   void selectPatches(const IntVector&, const IntVector&,
                      selectType&, bool withExtraCells=false, bool cache=true) const;
 
+  //////////
+  // Restrict the patch query structures this process keeps to the patches
+  // it works with and their halo: the neighborhood is the list of those
+  // patches and of every patch within halo cells of them.  Queries that
+  // lie within halo cells of one of the patches are answered from a BVH
+  // of the neighborhood, and only they are cached.  The BVH of the whole
+  // level is released; a query outside of the neighborhood builds it
+  // again (it is kept from then on) and raises a progressive warning.
+  // Called between timesteps, when no patch queries run.
+  void setNeighborhood(const std::vector<const Patch*>& patches, const IntVector& halo) const;
+
+  // The neighborhood's patches (sorted by address), empty without one.
+  const std::vector<const Patch*>& getNeighborhood() const { return d_neighborhood; }
+
+  // Is the patch in the neighborhood?
+  bool inNeighborhood(const Patch* patch) const;
+
   bool containsPointIncludingExtraCells(const Point&) const;
   bool containsPoint(const Point&) const;
   bool containsCell(const IntVector&) const;
@@ -261,6 +278,10 @@ private:
 
   Level(const Level&);
   Level& operator=(const Level&);
+
+  void queryBVH(const IntVector& low, const IntVector& high,
+                selectType& patches, bool withExtraCells) const;
+  bool inNeighborhood(const IntVector& low, const IntVector& high) const;
       
   std::vector<Patch*> d_patches;
 
@@ -318,7 +339,14 @@ private:
 
   typedef std::map<std::pair<IntVector, IntVector>, std::vector<const Patch*>, IntVectorCompare> selectCache;
   mutable selectCache d_selectCache; // we like const Levels in most places :) 
-  PatchBVH* d_bvh;
+  mutable PatchBVH* d_bvh;           // built on demand, released by setNeighborhood()
+
+  // see setNeighborhood() - like the cache, changes only how queries are answered
+  mutable std::vector<const Patch*> d_neighborhood;
+  mutable std::vector<std::pair<IntVector, IntVector> > d_neighborhoodRegions;  // the patches grown by the halo
+  mutable PatchBVH* d_neighborhoodBVH;
+  mutable IntVector d_neighborhoodLow;     // bounds of the regions
+  mutable IntVector d_neighborhoodHigh;
 };
 
 const Level * getLevel(const PatchSubset* subset);
@@ -0,0 +1,499 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <Core/Grid/UdaSidecar.h>
+
+#include <Core/Exceptions/Exception.h>
+#include <Core/Exceptions/InternalError.h>
+#include <Core/Grid/Grid.h>
+#include <Core/Grid/Level.h>
+#include <Core/Grid/Patch.h>
+#include <Core/ProblemSpec/ProblemSpec.h>
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <map>
+
+using namespace Uintah;
+
+namespace {
+
+  const char         GRID_MAGIC[8]  = { 'U','G','R','I','D','B','N','1' };
+  const char         INDEX_MAGIC[8] = { 'U','V','A','R','I','D','X','1' };
+  const unsigned int ENDIAN_MARKER  = 0x01020304;
+
+  // Appends fixed size values and length prefixed strings.
+  class Writer {
+  public:
+    template<class T> void put( const T & value ) {
+      const char * c = reinterpret_cast<const char*>( &value );
+      d_data.insert( d_data.end(), c, c + sizeof(T) );
+    }
+    void put( const IntVector & v ) {
+      put( v.x() ); put( v.y() ); put( v.z() );
+    }
+    void putString( const std::string & str ) {
+      put( (int)str.size() );
+      d_data.insert( d_data.end(), str.begin(), str.end() );
+    }
+    void putHeader( const char magic[8] ) {
+      d_data.insert( d_data.end(), magic, magic + 8 );
+      put( ENDIAN_MARKER );
+    }
+    bool write( const std::string & filename ) const {
+      FILE * fp = fopen( filename.c_str(), "wb" );
+      if( fp == nullptr ) {
+        return false;
+      }
+      bool ok = fwrite( &d_data[0], 1, d_data.size(), fp ) == d_data.size();
+      return fclose( fp ) == 0 && ok;
+    }
+
+    std::vector<char> d_data;
+  };
+
+  // Reads back what the Writer produced, the whole file at once.
+  class Reader {
+  public:
+    Reader() : d_pos(0) {}
+
+    bool open( const std::string & filename, const char magic[8] ) {
+      FILE * fp = fopen( filename.c_str(), "rb" );
+      if( fp == nullptr ) {
+        return false;
+      }
+      bool ok = open( fp, magic );
+      fclose( fp );
+      return ok;
+    }
+
+    // from an already open file, which is left open
+    bool open( FILE * fp, const char magic[8] ) {
+      fseek( fp, 0, SEEK_END );
+      long size = ftell( fp );
+      fseek( fp, 0, SEEK_SET );
+      d_data.resize( size > 0 ? size : 0 );
+      bool ok = size > 0 && fread( &d_data[0], 1, size, fp ) == (size_t)size;
+
+      if( !ok || d_data.size() < 8 + sizeof(unsigned int) || memcmp( &d_data[0], magic, 8 ) != 0 ) {
+        return false;
+      }
+      d_pos = 8;
+      // written on a machine of the other byte order: use the XML
+      return get<unsigned int>() == ENDIAN_MARKER;
+    }
+
+    template<class T> T get() {
+      check( sizeof(T) );
+      T value;
+      memcpy( &value, &d_data[d_pos], sizeof(T) );
+      d_pos += sizeof(T);
+      return value;
+    }
+    IntVector getIntVector() {
+      int x = get<int>();
+      int y = get<int>();
+      int z = get<int>();
+      return IntVector( x, y, z );
+    }
+    std::string getString() {
+      int length = getCount( 1 );
+      std::string str( &d_data[d_pos], length );
+      d_pos += length;
+      return str;
+    }
+    // a count of records of at least recordBytes each that must fit in the rest of the file
+    int getCount( size_t recordBytes ) {
+      int count = get<int>();
+      if( count < 0 || count * recordBytes > d_data.size() - d_pos ) {
+        throw InternalError( "UdaSidecar: bad record count", __FILE__, __LINE__ );
+      }
+      return count;
+    }
+    void skip( size_t bytes ) {
+      check( bytes );
+      d_pos += bytes;
+    }
+
+  private:
+    void check( size_t bytes ) const {
+      if( d_pos + bytes > d_data.size() ) {
+        throw InternalError( "UdaSidecar: file is truncated", __FILE__, __LINE__ );
+      }
+    }
+
+    std::vector<char> d_data;
+    size_t            d_pos;
+  };
+
+  // id, proc, extra cell low/high, interior low/high
+  const size_t PATCH_RECORD_SIZE = 14 * sizeof(int);
+  // id, anchor, dcell, extra cells, periodic, number of patches
+  const size_t LEVEL_RECORD_SIZE = sizeof(int) + 6 * sizeof(double) + 7 * sizeof(int);
+  // 4 string indices, matl, patch, start, end, numParticles, boundary layer
+  const size_t INDEX_RECORD_SIZE = 7 * sizeof(int) + 2 * sizeof(long) + 3 * sizeof(int);
+
+} // end anonymous namespace
+
+//______________________________________________________________________
+//
+bool
+UdaSidecar::writeGrid( const std::string                     & filename,
+                       const Grid                            * grid,
+                       const std::vector< std::vector<int> > & procMap,
+                       const std::vector<std::string>        & datafiles )
+{
+  for( int l = 0; l < grid->numLevels(); l++ ) {
+    if( grid->getLevel( l )->isStretched() ) {
+      return false;
+    }
+  }
+
+  Writer out;
+  out.putHeader( GRID_MAGIC );
+  out.put( grid->numLevels() );
+
+  for( int l = 0; l < grid->numLevels(); l++ ) {
+    const LevelP & level = grid->getLevel( l );
+    Point  anchor = level->getAnchor();
+    Vector dcell  = level->dCell();
+
+    out.put( level->getID() );
+    out.put( anchor.x() ); out.put( anchor.y() ); out.put( anchor.z() );
+    out.put( dcell.x() );  out.put( dcell.y() );  out.put( dcell.z() );
+    out.put( level->getExtraCells() );
+    out.put( level->getPeriodicBoundaries() );
+    out.put( level->numPatches() );
+
+    for( int p = 0; p < level->numPatches(); p++ ) {
+      const Patch * patch = level->getPatch( p );
+      out.put( patch->getID() );
+      out.put( procMap[l][p] );
+      out.put( patch->getExtraCellLowIndex() );
+      out.put( patch->getExtraCellHighIndex() );
+      out.put( patch->getCellLowIndex() );
+      out.put( patch->getCellHighIndex() );
+    }
+  }
+
+  out.put( (int)datafiles.size() );
+  for( unsigned i = 0; i < datafiles.size(); i++ ) {
+    out.putString( datafiles[i] );
+  }
+
+  return out.write( filename );
+}
+
+//______________________________________________________________________
+//
+bool
+UdaSidecar::readGrid( const std::string                     & filename,
+                            GridP                           & grid,
+                            std::vector< std::vector<int> > & procMap )
+{
+  FILE * fp = fopen( filename.c_str(), "rb" );
+  if( fp == nullptr ) {
+    return false;
+  }
+  bool ok = readGrid( fp, grid, procMap );
+  fclose( fp );
+  return ok;
+}
+
+//______________________________________________________________________
+//
+bool
+UdaSidecar::readGrid( FILE                                  * fp,
+                      GridP                                 & grid,
+                      std::vector< std::vector<int> >       & procMap )
+{
+  Reader in;
+  if( !in.open( fp, GRID_MAGIC ) ) {
+    return false;
+  }
+
+  // built aside, so a damaged file leaves the caller's grid untouched
+  GridP                           newGrid = scinew Grid;
+  std::vector< std::vector<int> > newProcMap;
+
+  try {
+    int numLevels = in.getCount( LEVEL_RECORD_SIZE );
+    newProcMap.resize( numLevels );
+
+    for( int l = 0; l < numLevels; l++ ) {
+      int    id = in.get<int>();
+      double ax = in.get<double>(), ay = in.get<double>(), az = in.get<double>();
+      double dx = in.get<double>(), dy = in.get<double>(), dz = in.get<double>();
+      IntVector extraCells = in.getIntVector();
+      IntVector periodic   = in.getIntVector();
+      int numPatches       = in.getCount( PATCH_RECORD_SIZE );
+
+      LevelP level = newGrid->addLevel( Point( ax, ay, az ), Vector( dx, dy, dz ), id );
+      level->setExtraCells( extraCells );
+
+      newProcMap[l].resize( numPatches );
+      for( int p = 0; p < numPatches; p++ ) {
+        int patchID = in.get<int>();
+        newProcMap[l][p] = in.get<int>();
+        IntVector low          = in.getIntVector();
+        IntVector high         = in.getIntVector();
+        IntVector interiorLow  = in.getIntVector();
+        IntVector interiorHigh = in.getIntVector();
+        level->addPatch( low, high, interiorLow, interiorHigh, newGrid.get_rep(), patchID );
+      }
+
+      level->finalizeLevel( periodic.x() != 0, periodic.y() != 0, periodic.z() != 0 );
+    }
+  }
+  catch( const Exception & ) {
+    return false;   // truncated or damaged: use the XML
+  }
+  catch( const std::exception & ) {
+    return false;
+  }
+
+  grid = newGrid;
+  procMap.swap( newProcMap );
+  return true;
+}
+
+//______________________________________________________________________
+//
+bool
+UdaSidecar::readDatafiles( const std::string              & filename,
+                                 std::vector<std::string> & datafiles )
+{
+  FILE * fp = fopen( filename.c_str(), "rb" );
+  if( fp == nullptr ) {
+    return false;
+  }
+  bool ok = readDatafiles( fp, datafiles );
+  fclose( fp );
+  return ok;
+}
+
+//______________________________________________________________________
+//
+bool
+UdaSidecar::readDatafiles( FILE                           * fp,
+                           std::vector<std::string>       & datafiles )
+{
+  Reader in;
+  if( !in.open( fp, GRID_MAGIC ) ) {
+    return false;
+  }
+
+  std::vector<std::string> names;
+  try {
+    int numLevels = in.getCount( LEVEL_RECORD_SIZE );
+    for( int l = 0; l < numLevels; l++ ) {
+      in.skip( LEVEL_RECORD_SIZE - sizeof(int) );
+      int numPatches = in.getCount( PATCH_RECORD_SIZE );
+      in.skip( numPatches * PATCH_RECORD_SIZE );
+    }
+
+    int numDatafiles = in.getCount( sizeof(int) );
+    names.resize( numDatafiles );
+    for( int i = 0; i < numDatafiles; i++ ) {
+      names[i] = in.getString();
+    }
+  }
+  catch( const Exception & ) {
+    return false;   // truncated or damaged: use the XML
+  }
+  catch( const std::exception & ) {
+    return false;
+  }
+
+  datafiles.swap( names );
+  return true;
+}
+
+//______________________________________________________________________
+//
+void
+UdaSidecar::writeIndex( const std::string & filename, const ProblemSpecP & doc )
+{
+  std::vector<VariableEntry> entries;
+  parseVariables( doc, entries );
+
+  // Strings (names, types, compression modes, data files) repeat for
+  // every patch and material - store each once and refer to it by index.
+  std::map<std::string, int> stringIndex;
+  std::vector<std::string>   strings;
+  Writer records;
+
+  for( unsigned e = 0; e < entries.size(); e++ ) {
+    const VariableEntry & entry = entries[e];
+
+    const std::string * fields[4] = { &entry.name, &entry.type, &entry.compression, &entry.filename };
+    for( int f = 0; f < 4; f++ ) {
+      std::map<std::string, int>::iterator iter = stringIndex.find( *fields[f] );
+      if( iter == stringIndex.end() ) {
+        iter = stringIndex.insert( std::make_pair( *fields[f], (int)strings.size() ) ).first;
+        strings.push_back( *fields[f] );
+      }
+      records.put( iter->second );
+    }
+    records.put( entry.matl );
+    records.put( entry.patchid );
+    records.put( entry.start );
+    records.put( entry.end );
+    records.put( entry.numParticles );
+    records.put( entry.boundaryLayer );
+  }
+
+  Writer out;
+  out.putHeader( INDEX_MAGIC );
+  out.put( (int)strings.size() );
+  for( unsigned i = 0; i < strings.size(); i++ ) {
+    out.putString( strings[i] );
+  }
+  out.put( (int)entries.size() );
+  out.d_data.insert( out.d_data.end(), records.d_data.begin(), records.d_data.end() );
+
+  if( !out.write( filename ) ) {
+    // not fatal, readers fall back to the xml
+    remove( filename.c_str() );
+  }
+}
+
+//______________________________________________________________________
+//
+void
+UdaSidecar::parseVariables( const ProblemSpecP & doc, std::vector<VariableEntry> & entries )
+{
+  for( ProblemSpecP vnode = doc->findBlock( "Variable" ); vnode != nullptr; vnode = vnode->findNextBlock( "Variable" ) ) {
+    VariableEntry entry;
+    std::map<std::string, std::string> attributes;
+    vnode->getAttributes( attributes );
+    entry.type = attributes["type"];
+
+    if( !vnode->get( "variable", entry.name ) || !vnode->get( "index", entry.matl ) ||
+        !vnode->get( "patch", entry.patchid ) || !vnode->get( "start", entry.start ) ||
+        !vnode->get( "end", entry.end ) || !vnode->get( "filename", entry.filename ) ) {
+      throw InternalError( "UdaSidecar::parseVariables: incomplete <Variable> entry", __FILE__, __LINE__ );
+    }
+    vnode->get( "compression",   entry.compression );
+    vnode->get( "boundaryLayer", entry.boundaryLayer );
+    vnode->get( "numParticles",  entry.numParticles );
+
+    entries.push_back( entry );
+  }
+}
+
+//______________________________________________________________________
+//  The elements in the order the DataArchiver writes them.
+void
+UdaSidecar::appendVariable( ProblemSpecP & doc, const VariableEntry & entry )
+{
+  ProblemSpecP vnode = doc->appendChild( "Variable" );
+
+  vnode->appendElement( "variable", entry.name );
+  vnode->appendElement( "index",    entry.matl );
+  vnode->appendElement( "patch",    entry.patchid );
+  vnode->setAttribute( "type", entry.type );
+
+  if( entry.boundaryLayer != IntVector( 0, 0, 0 ) ) {
+    vnode->appendElement( "boundaryLayer", entry.boundaryLayer );
+  }
+  vnode->appendElement( "start", entry.start );
+  if( entry.numParticles >= 0 ) {
+    vnode->appendElement( "numParticles", entry.numParticles );
+  }
+  if( entry.compression != "" ) {
+    vnode->appendElement( "compression", entry.compression );
+  }
+  vnode->appendElement( "end",      entry.end );
+  vnode->appendElement( "filename", entry.filename );
+}
+
+//______________________________________________________________________
+//
+bool
+UdaSidecar::readIndex( const std::string & filename, std::vector<VariableEntry> & entries )
+{
+  Reader in;
+  if( !in.open( filename, INDEX_MAGIC ) ) {
+    return false;
+  }
+
+  std::vector<VariableEntry> read;
+  try {
+    std::vector<std::string> strings( in.getCount( sizeof(int) ) );
+    for( unsigned i = 0; i < strings.size(); i++ ) {
+      strings[i] = in.getString();
+    }
+
+    int numEntries = in.getCount( INDEX_RECORD_SIZE );
+    read.resize( numEntries );
+    for( int e = 0; e < numEntries; e++ ) {
+      VariableEntry & entry = read[e];
+      entry.name         = strings.at( in.get<int>() );
+      entry.type         = strings.at( in.get<int>() );
+      entry.compression  = strings.at( in.get<int>() );
+      entry.filename     = strings.at( in.get<int>() );
+      entry.matl         = in.get<int>();
+      entry.patchid      = in.get<int>();
+      entry.start        = in.get<long>();
+      entry.end          = in.get<long>();
+      entry.numParticles = in.get<int>();
+      entry.boundaryLayer = in.getIntVector();
+    }
+  }
+  catch( const Exception & ) {
+    return false;   // truncated or damaged: use the XML
+  }
+  catch( const std::exception & ) {
+    return false;
+  }
+
+  entries.swap( read );
+  return true;
+}
+
+//______________________________________________________________________
+//
+std::string
+UdaSidecar::indexFilename( const std::string & xmlFilename )
+{
+  std::string::size_type dot = xmlFilename.rfind( ".xml" );
+  if( dot == std::string::npos || dot + 4 != xmlFilename.size() ) {
+    return xmlFilename + ".idx";
+  }
+  return xmlFilename.substr( 0, dot ) + ".idx";
+}
+
+//______________________________________________________________________
+//
+std::string
+UdaSidecar::gridFilename( const std::string & timestepDirectory )
+{
+  if( !timestepDirectory.empty() && timestepDirectory[ timestepDirectory.size() - 1 ] != '/' ) {
+    return timestepDirectory + "/grid.bin";
+  }
+  return timestepDirectory + "grid.bin";
+}
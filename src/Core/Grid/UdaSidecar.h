@@ -0,0 +1,140 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef UINTAH_HOMEBREW_UdaSidecar_H
+#define UINTAH_HOMEBREW_UdaSidecar_H
+
+#include <Core/Geometry/IntVector.h>
+#include <Core/Grid/GridP.h>
+#include <Core/ProblemSpec/ProblemSpecP.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Uintah {
+
+class Grid;
+
+/**************************************
+
+CLASS
+   UdaSidecar
+
+GENERAL INFORMATION
+
+   UdaSidecar.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+KEYWORDS
+   DataArchive, DataArchiver, uda, grid.xml
+
+DESCRIPTION
+   Compact binary copies of the uda metadata that otherwise has to be
+   parsed out of XML:
+
+     tXXXXX/grid.bin       - the <Grid> (levels, patch extents, IDs and
+                             output procs) and the <Data> file list of
+                             grid.xml.
+     tXXXXX/lN/pNNNNN.idx  - the <Variable> entries (type, matl, patch,
+                             offsets, ...) of the matching pNNNNN.xml.
+     tXXXXX/global.idx     - the same for global.xml.
+
+   The DataArchiver writes them next to the XML, and the DataArchive
+   prefers them when present.  The read functions return false, leaving
+   their outputs untouched, when a file is missing, truncated or damaged,
+   or was written by a machine of the other byte order, in which case the
+   caller falls back to the XML.
+
+WARNING
+   Stretched grids are not represented; no grid.bin is written for them.
+
+****************************************/
+
+class UdaSidecar {
+
+public:
+
+  // One <Variable> of a pNNNNN.xml / global.xml file.
+  struct VariableEntry {
+    VariableEntry() : matl(-1), patchid(-1), start(0), end(0), numParticles(-1), boundaryLayer(0,0,0) {}
+
+    std::string name;
+    std::string type;
+    std::string compression;
+    std::string filename;
+    int         matl;
+    int         patchid;
+    long        start;
+    long        end;
+    int         numParticles;
+    IntVector   boundaryLayer;
+  };
+
+  // procMap[level][patch] is the output proc of the patch, datafiles the
+  // hrefs of the <Data> section.  Returns false (writing nothing) if the
+  // grid cannot be represented.
+  static bool writeGrid( const std::string                     & filename,
+                         const Grid                            * grid,
+                         const std::vector< std::vector<int> > & procMap,
+                         const std::vector<std::string>        & datafiles );
+
+  // On success, grid is replaced by a new grid with the levels and patches.
+  static bool readGrid( const std::string                     & filename,
+                              GridP                           & grid,
+                              std::vector< std::vector<int> > & procMap );
+  // from an open file (e.g. one DataArchive broadcast), left open
+  static bool readGrid( FILE                                  * fp,
+                        GridP                                 & grid,
+                        std::vector< std::vector<int> >       & procMap );
+
+  // Only the <Data> file list, without building the grid.
+  static bool readDatafiles( const std::string              & filename,
+                                   std::vector<std::string> & datafiles );
+  static bool readDatafiles( FILE                           * fp,
+                             std::vector<std::string>       & datafiles );
+
+  // Written from the Uintah_Output document of a pNNNNN.xml file.
+  static void writeIndex( const std::string & filename, const ProblemSpecP & doc );
+
+  // The <Variable> entries of a Uintah_Output document, and the reverse.
+  static void parseVariables( const ProblemSpecP & doc, std::vector<VariableEntry> & entries );
+  static void appendVariable(       ProblemSpecP & doc, const VariableEntry & entry );
+
+  static bool readIndex( const std::string & filename, std::vector<VariableEntry> & entries );
+
+  // pNNNNN.xml -> pNNNNN.idx, grid.xml -> grid.bin
+  static std::string indexFilename( const std::string & xmlFilename );
+  static std::string gridFilename( const std::string & timestepDirectory );
+};
+
+} // End namespace Uintah
+
+#endif
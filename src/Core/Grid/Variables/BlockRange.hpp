@@ -65,6 +65,176 @@ private:
   int m_dim[rank];
 };
 
+//______________________________________________________________________
+//  Iteration policies for parallel_for/parallel_reduce over a BlockRange.
+//
+//  KSlab       - chunks of whole (i,j) planes along k.  This is the
+//                original schedule and the built-in default.
+//  CollapsedKJ - the (k,j) index space is collapsed and each work item is
+//                a single i-pencil, which keeps all threads busy on thin
+//                patches.
+//  Tiled       - the range is cut into tile(0) x tile(1) x tile(2) blocks,
+//                each traversed k,j,i, for cache reuse by stencils.  A tile
+//                size of 0 spans the whole range in that direction.
+//
+//  The calls that do not pass a policy use getDefault(), which the
+//  <Scheduler><iteration_policy> block sets once, in problemSetup, before
+//  any task runs; it is read only afterwards.
+//
+//  The innermost i loop of a parallel_for carries a vectorization hint
+//  (ivdep) only if the call site asks for it with vectorized(), which
+//  asserts that the functor's iterations along i are independent.  The
+//  default policy never vectorizes.
+class BlockRangePolicy
+{
+public:
+
+  enum Schedule { KSlab, CollapsedKJ, Tiled };
+
+  BlockRangePolicy( Schedule schedule = KSlab, int tile_i = 0, int tile_j = 8, int tile_k = 8, int chunk = 2 )
+    : m_schedule( schedule )
+    , m_chunk( chunk > 0 ? chunk : 1 )
+    , m_vectorize( false )
+  {
+    m_tile[0] = tile_i;
+    m_tile[1] = tile_j;
+    m_tile[2] = tile_k;
+  }
+
+  // A copy of this policy that vectorizes the i loop
+  BlockRangePolicy vectorized() const
+  {
+    BlockRangePolicy p( *this );
+    p.m_vectorize = true;
+    return p;
+  }
+
+  Schedule schedule()  const { return m_schedule; }
+  int      tile( int r ) const { return m_tile[r]; }
+  int      chunkSize() const { return m_chunk; }
+  bool     vectorize() const { return m_vectorize; }
+
+  // The policy used by the calls that do not pass one.
+  static const BlockRangePolicy & getDefault() { return defaultPolicy(); }
+
+  // Only from problemSetup, before any task runs.
+  static void setDefault( const BlockRangePolicy & policy )
+  {
+    defaultPolicy() = policy;
+    defaultPolicy().m_vectorize = false;
+  }
+
+private:
+
+  static BlockRangePolicy & defaultPolicy()
+  {
+    static BlockRangePolicy policy;
+    return policy;
+  }
+
+  Schedule m_schedule;
+  int      m_tile[3];
+  int      m_chunk;
+  bool     m_vectorize;
+};
+
+#if defined( __CUDACC__ )
+#  define UINTAH_VECTORIZE_LOOP
+#elif defined( __INTEL_COMPILER )
+#  define UINTAH_VECTORIZE_LOOP _Pragma("ivdep")
+#elif defined( __clang__ )
+#  define UINTAH_VECTORIZE_LOOP _Pragma("clang loop vectorize(enable)")
+#elif defined( __GNUC__ ) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+#  define UINTAH_VECTORIZE_LOOP _Pragma("GCC ivdep")
+#else
+#  define UINTAH_VECTORIZE_LOOP
+#endif
+
+namespace detail {
+
+// Splits a BlockRange into the work items of a policy: tiles numbered with
+// i fastest so that consecutive items are adjacent in memory.
+class BlockTiling
+{
+public:
+
+  BlockTiling( BlockRange const & r, BlockRangePolicy const & p )
+  {
+    for (int d=0; d<BlockRange::rank; ++d) {
+      m_begin[d] = r.begin(d);
+      m_end[d]   = r.end(d);
+      const int extent = m_end[d] - m_begin[d];
+
+      int t;
+      switch ( p.schedule() ) {
+        case BlockRangePolicy::CollapsedKJ : t = ( d == 0 ) ? extent : 1;         break;
+        case BlockRangePolicy::Tiled       : t = p.tile(d) > 0 ? p.tile(d) : extent; break;
+        default                            : t = ( d < 2 ) ? extent : 1;         break;
+      }
+      m_tile[d]  = t > 0 ? t : 1;
+      m_count[d] = extent > 0 ? ( extent + m_tile[d] - 1 ) / m_tile[d] : 0;
+    }
+  }
+
+  int size() const { return m_count[0] * m_count[1] * m_count[2]; }
+
+  void bounds( int t, int lo[3], int hi[3] ) const
+  {
+    int n[3];
+    n[0] = t % m_count[0];  t /= m_count[0];
+    n[1] = t % m_count[1];
+    n[2] = t / m_count[1];
+    for (int d=0; d<3; ++d) {
+      lo[d] = m_begin[d] + n[d] * m_tile[d];
+      hi[d] = lo[d] + m_tile[d] < m_end[d] ? lo[d] + m_tile[d] : m_end[d];
+    }
+  }
+
+private:
+  int m_begin[3];
+  int m_end[3];
+  int m_tile[3];
+  int m_count[3];
+};
+
+template <typename Functor>
+inline void tile_for( BlockTiling const & tiling, int t, bool vectorize, const Functor & f )
+{
+  int lo[3], hi[3];
+  tiling.bounds( t, lo, hi );
+
+  const int ib = lo[0]; const int ie = hi[0];
+  for (int k=lo[2]; k<hi[2]; ++k) {
+  for (int j=lo[1]; j<hi[1]; ++j) {
+    if ( vectorize ) {
+      UINTAH_VECTORIZE_LOOP
+      for (int i=ib; i<ie; ++i) {
+        f(i,j,k);
+      }
+    }
+    else {
+      for (int i=ib; i<ie; ++i) {
+        f(i,j,k);
+      }
+    }
+  }}
+}
+
+template <typename Functor, typename ReductionType>
+inline void tile_reduce( BlockTiling const & tiling, int t, const Functor & f, ReductionType & red )
+{
+  int lo[3], hi[3];
+  tiling.bounds( t, lo, hi );
+
+  for (int k=lo[2]; k<hi[2]; ++k) {
+  for (int j=lo[1]; j<hi[1]; ++j) {
+  for (int i=lo[0]; i<hi[0]; ++i) {
+    f(i,j,k,red);
+  }}}
+}
+
+} // namespace detail
+
 template <typename Functor>
 void serial_for( BlockRange const & r, const Functor & f )
 {
@@ -82,70 +252,69 @@ void serial_for( BlockRange const & r, const Functor & f )
 #if defined( UINTAH_ENABLE_KOKKOS )
 
 template <typename Functor>
-void parallel_for( BlockRange const & r, const Functor & f )
+void parallel_for( BlockRange const & r, BlockRangePolicy const & p, const Functor & f )
 {
-  const int ib = r.begin(0); const int ie = r.end(0);
-  const int jb = r.begin(1); const int je = r.end(1);
-  const int kb = r.begin(2); const int ke = r.end(2);
+  const detail::BlockTiling tiling( r, p );
+  const bool vectorize = p.vectorize();
 
-  Kokkos::parallel_for( Kokkos::RangePolicy<Kokkos::OpenMP, int>(kb, ke).set_chunk_size(2), KOKKOS_LAMBDA(int k) {
-    for (int j=jb; j<je; ++j) {
-    for (int i=ib; i<ie; ++i) {
-      f(i,j,k);
-    }}
+  Kokkos::parallel_for( Kokkos::RangePolicy<Kokkos::OpenMP, int>(0, tiling.size()).set_chunk_size(p.chunkSize()), KOKKOS_LAMBDA(int t) {
+    detail::tile_for( tiling, t, vectorize, f );
   });
 };
 
 template <typename Functor, typename ReductionType>
-void parallel_reduce( BlockRange const & r, const Functor & f, ReductionType & red  )
+void parallel_reduce( BlockRange const & r, BlockRangePolicy const & p, const Functor & f, ReductionType & red  )
 {
-  const int ib = r.begin(0); const int ie = r.end(0);
-  const int jb = r.begin(1); const int je = r.end(1);
-  const int kb = r.begin(2); const int ke = r.end(2);
+  const detail::BlockTiling tiling( r, p );
 
   ReductionType tmp = red;
-  Kokkos::parallel_reduce( Kokkos::RangePolicy<Kokkos::OpenMP, int>(kb, ke).set_chunk_size(2), KOKKOS_LAMBDA(int k, ReductionType & tmp) {
-    for (int j=jb; j<je; ++j) {
-    for (int i=ib; i<ie; ++i) {
-      f(i,j,k,tmp);
-    }}
+  Kokkos::parallel_reduce( Kokkos::RangePolicy<Kokkos::OpenMP, int>(0, tiling.size()).set_chunk_size(p.chunkSize()), KOKKOS_LAMBDA(int t, ReductionType & tmp) {
+    detail::tile_reduce( tiling, t, f, tmp );
   }, tmp);
   red = tmp;
 };
+
 #else
 
 template <typename Functor>
-void parallel_for( BlockRange const & r, const Functor & f )
+void parallel_for( BlockRange const & r, BlockRangePolicy const & p, const Functor & f )
 {
-  const int ib = r.begin(0); const int ie = r.end(0);
-  const int jb = r.begin(1); const int je = r.end(1);
-  const int kb = r.begin(2); const int ke = r.end(2);
+  const detail::BlockTiling tiling( r, p );
+  const bool vectorize = p.vectorize();
 
-  for (int k=kb; k<ke; ++k) {
-  for (int j=jb; j<je; ++j) {
-  for (int i=ib; i<ie; ++i) {
-    f(i,j,k);
-  }}}
+  const int n = tiling.size();
+  for (int t=0; t<n; ++t) {
+    detail::tile_for( tiling, t, vectorize, f );
+  }
 };
 
 template <typename Functor, typename ReductionType>
-void parallel_reduce( BlockRange const & r, const Functor & f, ReductionType & red  )
+void parallel_reduce( BlockRange const & r, BlockRangePolicy const & p, const Functor & f, ReductionType & red  )
 {
-  const int ib = r.begin(0); const int ie = r.end(0);
-  const int jb = r.begin(1); const int je = r.end(1);
-  const int kb = r.begin(2); const int ke = r.end(2);
+  const detail::BlockTiling tiling( r, p );
 
   ReductionType tmp = red;
-  for (int k=kb; k<ke; ++k) {
-  for (int j=jb; j<je; ++j) {
-  for (int i=ib; i<ie; ++i) {
-    f(i,j,k,tmp);
-  }}}
+  const int n = tiling.size();
+  for (int t=0; t<n; ++t) {
+    detail::tile_reduce( tiling, t, f, tmp );
+  }
   red = tmp;
 };
 
 #endif
 
+template <typename Functor>
+void parallel_for( BlockRange const & r, const Functor & f )
+{
+  parallel_for( r, BlockRangePolicy::getDefault(), f );
+};
+
+template <typename Functor, typename ReductionType>
+void parallel_reduce( BlockRange const & r, const Functor & f, ReductionType & red  )
+{
+  parallel_reduce( r, BlockRangePolicy::getDefault(), f, red );
+};
+
 
 } // namespace Uintah
 
@@ -28,10 +28,66 @@
 
 #include <Core/Geometry/IntVector.h>
 #include <Core/Exceptions/InternalError.h>
+#include <Core/Parallel/Parallel.h>
+
+#include <map>
+#include <mutex>
+#include <tuple>
 
 using namespace Uintah;
 
 
+namespace {
+
+  // Committed ghost region types, by (element type, region size, strides).
+  // The same few shapes are sent over and over, so they are built once and
+  // kept for the run; freeRegionTypes() frees them before MPI_Finalize.
+  typedef std::tuple<MPI_Datatype, int, int, int, int, int, int> RegionKey;
+
+  std::map<RegionKey, MPI_Datatype> regionTypes;
+  std::mutex                        regionTypesLock;
+
+  void freeRegionTypes()
+  {
+    std::lock_guard<std::mutex> lock(regionTypesLock);
+    for (std::map<RegionKey, MPI_Datatype>::iterator iter = regionTypes.begin(); iter != regionTypes.end(); iter++) {
+      Uintah::MPI::Type_free(&iter->second);
+    }
+    regionTypes.clear();
+  }
+
+  MPI_Datatype regionType( MPI_Datatype basetype, const IntVector& d, const IntVector& strides )
+  {
+    RegionKey key(basetype, d.x(), d.y(), d.z(), strides.x(), strides.y(), strides.z());
+
+    std::lock_guard<std::mutex> lock(regionTypesLock);
+    std::map<RegionKey, MPI_Datatype>::iterator iter = regionTypes.find(key);
+    if (iter != regionTypes.end()) {
+      return iter->second;
+    }
+
+    if (regionTypes.empty()) {
+      static std::once_flag registered;
+      std::call_once(registered, [] { Uintah::Parallel::addFinalizeHook(freeRegionTypes); });
+    }
+
+    MPI_Datatype type1d;
+    Uintah::MPI::Type_create_hvector(d.x(), 1, strides.x(), basetype, &type1d);
+
+    MPI_Datatype type2d;
+    Uintah::MPI::Type_create_hvector(d.y(), 1, strides.y(), type1d, &type2d);
+    Uintah::MPI::Type_free(&type1d);
+    MPI_Datatype type3d;
+    Uintah::MPI::Type_create_hvector(d.z(), 1, strides.z(), type2d, &type3d);
+    Uintah::MPI::Type_free(&type2d);
+    Uintah::MPI::Type_commit(&type3d);
+
+    regionTypes[key] = type3d;
+    return type3d;
+  }
+
+}
+
 void GridVariableBase::getMPIBuffer(BufferInfo& buffer,
                                     const IntVector& low, const IntVector& high)
 {
@@ -44,15 +100,14 @@ void GridVariableBase::getMPIBuffer(BufferInfo& buffer,
   char* startbuf = (char*)getBasePointer();
   startbuf += strides.x()*off.x()+strides.y()*off.y()+strides.z()*off.z();
   IntVector d = high-low;
-  MPI_Datatype type1d;
-  Uintah::MPI::Type_create_hvector(d.x(), 1, strides.x(), basetype, &type1d);
-
-  MPI_Datatype type2d;
-  Uintah::MPI::Type_create_hvector(d.y(), 1, strides.y(), type1d, &type2d);
-  Uintah::MPI::Type_free(&type1d);
-  MPI_Datatype type3d;
-  Uintah::MPI::Type_create_hvector(d.z(), 1, strides.z(), type2d, &type3d);
-  Uintah::MPI::Type_free(&type2d);
-  Uintah::MPI::Type_commit(&type3d);
-  buffer.add(startbuf, 1, type3d, true);
+
+  // the same region, for packing without the datatype
+  BufferLayout layout;
+  layout.elemBytes = strides.x();
+  for (int i = 0; i < 3; i++) {
+    layout.extent[i] = d[i];
+    layout.stride[i] = strides[i];
+  }
+
+  buffer.add(startbuf, 1, regionType(basetype, d, strides), false, layout);
 }
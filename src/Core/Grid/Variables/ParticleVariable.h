@@ -45,6 +45,7 @@
 #include <Core/IO/SpecializedRunLengthEncoder.h>
 #include <iostream>
 #include <cstring>
+#include <vector>
 
 
 namespace Uintah {
@@ -446,12 +447,18 @@ template<class T>
     // This should be fixed for variable sized types!
     const TypeDescription* td = getTypeDescription()->getSubType();
     if(td->isFlat()){
-      for(ParticleSubset::iterator iter = pset->begin();
-          iter != pset->end(); iter++){
+      // unpack all of them with one call and scatter them from there
+      std::vector<T> elems(pset->numParticles());
+      if(!elems.empty()){
         Uintah::MPI::Unpack(buf, bufsize, bufpos,
-                   &d_pdata->data[*iter], 1, td->getMPIType(),
+                   &elems[0], elems.size(), td->getMPIType(),
                    pg->getComm());
       }
+      int n = 0;
+      for(ParticleSubset::iterator iter = pset->begin();
+          iter != pset->end(); iter++){
+        d_pdata->data[*iter] = elems[n++];
+      }
     } else {
       SCI_THROW(InternalError("packMPI not finished\n", __FILE__, __LINE__));
     }
@@ -482,9 +489,15 @@ template<class T>
     // This should be fixed for variable sized types!
     const TypeDescription* td = getTypeDescription()->getSubType();
     if(td->isFlat()){
+      // gather them and pack them with one call
+      std::vector<T> elems;
+      elems.reserve(pset->numParticles());
       for(ParticleSubset::iterator iter = pset->begin();
           iter != pset->end(); iter++){
-        Uintah::MPI::Pack(&d_pdata->data[*iter], 1, td->getMPIType(),
+        elems.push_back(d_pdata->data[*iter]);
+      }
+      if(!elems.empty()){
+        Uintah::MPI::Pack(&elems[0], elems.size(), td->getMPIType(),
                  buf, bufsize, bufpos, pg->getComm());
       }
     } else {
@@ -90,8 +90,18 @@ void ParticleVariableBase::getMPIBuffer(BufferInfo& buffer,
   }
   void* buf = getBasePointer();
   int count = sendset->numParticles();
+
+  // the elements, for packing without the datatype
+  MPI_Aint lb, extent;
+  Uintah::MPI::Type_get_extent(td->getMPIType(), &lb, &extent);
+  BufferLayout layout;
+  layout.elemBytes = extent;
+
   if(linear){
-    buffer.add(buf, count, td->getMPIType(), false);
+    layout.extent[0] = count;
+    layout.extent[1] = layout.extent[2] = 1;
+    layout.stride[0] = extent;
+    buffer.add(buf, count, td->getMPIType(), false, layout);
   } else {
     vector<int> blocklens( count, 1);
     MPI_Datatype datatype;
@@ -101,7 +111,8 @@ void ParticleVariableBase::getMPIBuffer(BufferInfo& buffer,
                         sendset->getPointer(), td->getMPIType(), &datatype );
     Uintah::MPI::Type_commit(&datatype);
 
-    buffer.add(buf, 1, datatype, true);
+    layout.indices.assign(sendset->begin(), sendset->end());
+    buffer.add(buf, 1, datatype, true, layout);
   }
 }
 
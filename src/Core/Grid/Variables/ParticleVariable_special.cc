@@ -49,10 +49,14 @@ using namespace std;
       Vector offset = forPatch->getVirtualOffsetVector();
       const TypeDescription* td = getTypeDescription()->getSubType();
       if(td->isFlat()){
+        vector<Point> elems;
+        elems.reserve(pset->numParticles());
         for(ParticleSubset::iterator iter = pset->begin();
             iter != pset->end(); iter++){
-          Point p = d_pdata->data[*iter] - offset;
-          Uintah::MPI::Pack(&p, 1, td->getMPIType(), buf, bufsize, bufpos, pg->getComm());
+          elems.push_back(d_pdata->data[*iter] - offset);
+        }
+        if(!elems.empty()){
+          Uintah::MPI::Pack(&elems[0], elems.size(), td->getMPIType(), buf, bufsize, bufpos, pg->getComm());
         }
       } else {
         SCI_THROW(InternalError("packMPI not finished\n", __FILE__, __LINE__));
@@ -0,0 +1,158 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UINTAH_HOMEBREW_STENCILVIEW_H
+#define UINTAH_HOMEBREW_STENCILVIEW_H
+
+#include <Core/Grid/Variables/Array3.h>
+#include <Core/Grid/Variables/BlockRange.hpp>
+#include <Core/Geometry/IntVector.h>
+
+#include <type_traits>
+
+namespace Uintah {
+
+/**************************************
+
+CLASS
+   StencilView
+
+GENERAL INFORMATION
+
+   StencilView.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+KEYWORDS
+   Array3, Stencil, Vectorization
+
+DESCRIPTION
+   Raw access to the contiguous i-lines of an Array3 (CCVariable,
+   NCVariable, SFC*Variable and their const versions).  The j and k
+   strides are computed once, neighbors are addressed by a precomputed
+   linear offset, and the innermost loop is plain pointer indexing that
+   compilers can vectorize:
+
+     StencilView<const double> q(q_CC);
+     StencilView<double>       q_FC(q_XFC);
+     const long L = q.neighbor(IntVector(-1, 0, 0));
+
+     for (int k = low.z(); k < high.z(); k++) {
+       for (int j = low.y(); j < high.y(); j++) {
+         StencilLine<const double> q_line    = q.line(j, k);
+         StencilLine<double>       q_FC_line = q_FC.line(j, k);
+
+         UINTAH_VECTORIZE_LOOP
+         for (int i = low.x(); i < high.x(); i++) {
+           q_FC_line[i] = 0.5 * (q_line[i] + q_line(i, L));
+         }
+       }
+     }
+
+   Each variable computes its own neighbor offsets, since two variables
+   may be allocated over different windows.  Use the const element type
+   for read-only (const*Variable) data.
+
+WARNING
+   No bounds checking is done, and a view is only valid as long as the
+   variable it was created from is not reallocated.
+
+****************************************/
+
+template<class T>
+class StencilLine {
+
+  public:
+
+    StencilLine( T* row, int i0 ) : d_row( row ), d_i0( i0 ) {}
+
+    // element (i, j, k) of the line
+    inline T& operator[]( int i ) const { return d_row[i - d_i0]; }
+
+    // element (i, j, k) + the neighbor whose offset is given
+    inline T& operator()( int i, long neighbor ) const { return d_row[i - d_i0 + neighbor]; }
+
+  private:
+
+    T*  d_row;     // element (i0, j, k)
+    int d_i0;
+};
+
+template<class T>
+class StencilView {
+
+  public:
+
+    typedef typename std::remove_const<T>::type value_type;
+
+    typedef typename std::conditional< std::is_const<T>::value,
+                                       const Array3<value_type>,
+                                       Array3<value_type> >::type array_type;
+
+    StencilView( array_type& var )
+    {
+      const Array3Window<value_type>* window = var.getWindow();
+      IntVector size = window->getData()->size();
+
+      d_data    = var.getPointer();
+      d_offset  = window->getOffset();
+      d_strideJ = size.x();
+      d_strideK = (long)size.x() * size.y();
+    }
+
+    // linear offset of the neighbor at relative position d
+    inline long neighbor( const IntVector& d ) const
+    {
+      return d.x() + d.y() * d_strideJ + d.z() * d_strideK;
+    }
+
+    inline StencilLine<T> line( int j, int k ) const
+    {
+      return StencilLine<T>( d_data + (j - d_offset.y()) * d_strideJ + (k - d_offset.z()) * d_strideK,
+                             d_offset.x() );
+    }
+
+    inline T& operator()( int i, int j, int k ) const
+    {
+      return d_data[(i - d_offset.x()) + (j - d_offset.y()) * d_strideJ + (k - d_offset.z()) * d_strideK];
+    }
+
+    inline long strideJ() const { return d_strideJ; }
+    inline long strideK() const { return d_strideK; }
+
+  private:
+
+    T*        d_data;      // start of the underlying allocation
+    IntVector d_offset;    // index of its first element
+    long      d_strideJ;
+    long      d_strideK;
+};
+
+} // End namespace Uintah
+
+#endif
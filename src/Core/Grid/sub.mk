@@ -61,6 +61,7 @@ SRCS += \
         $(SRCDIR)/SimulationTime.cc        \
         $(SRCDIR)/Task.cc                  \
         $(SRCDIR)/TOBSplineInterpolator.cc \
+        $(SRCDIR)/UdaSidecar.cc            \
         $(SRCDIR)/UnknownVariable.cc       \
         $(SRCDIR)/cptiInterpolator.cc      \
         $(SRCDIR)/axiCptiInterpolator.cc   \
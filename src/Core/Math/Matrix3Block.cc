@@ -0,0 +1,445 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <Core/Math/Matrix3Block.h>
+#include <Core/Exceptions/InternalError.h>
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+// Same definition as in Core/Grid/Variables/BlockRange.hpp, which
+// Core/Math can not include.
+#ifndef UINTAH_VECTORIZE_LOOP
+#  if defined( __CUDACC__ )
+#    define UINTAH_VECTORIZE_LOOP
+#  elif defined( __INTEL_COMPILER )
+#    define UINTAH_VECTORIZE_LOOP _Pragma("ivdep")
+#  elif defined( __clang__ )
+#    define UINTAH_VECTORIZE_LOOP _Pragma("clang loop vectorize(enable)")
+#  elif defined( __GNUC__ ) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+#    define UINTAH_VECTORIZE_LOOP _Pragma("GCC ivdep")
+#  else
+#    define UINTAH_VECTORIZE_LOOP
+#  endif
+#endif
+
+using namespace Uintah;
+
+namespace {
+
+const int W = Matrix3Block::width;
+
+// component index of (i,j) in a Matrix3Block, and of the identity
+inline int ij( int i, int j ) { return 3*i + j; }
+const double identity[9] = { 1, 0, 0,  0, 1, 0,  0, 0, 1 };
+
+void singular( const Matrix3Block& A, int lane, const char* where, double det )
+{
+  std::ostringstream msg;
+  msg << "Matrix3Batch::" << where << ": singular matrix " << A.get(lane)
+      << " (det = " << det << ")";
+  throw InternalError(msg.str(), __FILE__, __LINE__);
+}
+
+// (1/2) E:E with the off diagonal terms of a symmetric E counted twice,
+// the error measure of Matrix3::polarRotationRMB
+inline double polarError( const Matrix3Block& E, int l )
+{
+  return E.m[0][l]*E.m[0][l] + E.m[4][l]*E.m[4][l] + E.m[8][l]*E.m[8][l]
+       + 2.0*(E.m[1][l]*E.m[1][l] + E.m[5][l]*E.m[5][l] + E.m[6][l]*E.m[6][l]);
+}
+
+//______________________________________________________________________
+//  One Jacobi rotation in the (p,q) plane of the symmetric tensors a
+//  (r is the remaining index), accumulated into the eigenvectors v.
+//  The rotation angle is computed branch free, and is zero when a_pq is.
+void jacobiRotate( double a[3][3][W], double v[3][3][W], int p, int q, int r, int n )
+{
+  const double tiny = std::numeric_limits<double>::min();
+
+  UINTAH_VECTORIZE_LOOP
+  for (int l = 0; l < n; l++) {
+    const double apq = a[p][q][l];
+    const double tau = a[q][q][l] - a[p][p][l];
+    const double sgn = (tau < 0.0) ? -1.0 : 1.0;
+    const double t   = sgn*2.0*apq/(std::fabs(tau) + std::sqrt(tau*tau + 4.0*apq*apq) + tiny);
+    const double c   = 1.0/std::sqrt(1.0 + t*t);
+    const double s   = t*c;
+
+    a[p][p][l] -= t*apq;
+    a[q][q][l] += t*apq;
+    a[p][q][l] = a[q][p][l] = 0.0;
+
+    const double arp = a[r][p][l];
+    const double arq = a[r][q][l];
+    a[r][p][l] = a[p][r][l] = c*arp - s*arq;
+    a[r][q][l] = a[q][r][l] = s*arp + c*arq;
+
+    for (int k = 0; k < 3; k++) {
+      const double vkp = v[k][p][l];
+      const double vkq = v[k][q][l];
+      v[k][p][l] = c*vkp - s*vkq;
+      v[k][q][l] = s*vkp + c*vkq;
+    }
+  }
+}
+
+// A = evec*diag(f)*evec^T
+void assemble( const double f[3][W], const Matrix3Block& evec, SymmMatrix3Block& A, int n )
+{
+  static const int row[6] = { 0, 1, 2, 1, 2, 0 };
+  static const int col[6] = { 0, 1, 2, 2, 0, 1 };
+
+  for (int c = 0; c < 6; c++) {
+    const double* vi0 = evec.m[ij(row[c], 0)];
+    const double* vi1 = evec.m[ij(row[c], 1)];
+    const double* vi2 = evec.m[ij(row[c], 2)];
+    const double* vj0 = evec.m[ij(col[c], 0)];
+    const double* vj1 = evec.m[ij(col[c], 1)];
+    const double* vj2 = evec.m[ij(col[c], 2)];
+
+    UINTAH_VECTORIZE_LOOP
+    for (int l = 0; l < n; l++) {
+      A.m[c][l] = vi0[l]*f[0][l]*vj0[l] + vi1[l]*f[1][l]*vj1[l] + vi2[l]*f[2][l]*vj2[l];
+    }
+  }
+}
+
+} // End anonymous namespace
+
+//______________________________________________________________________
+//
+void
+Matrix3Batch::determinant( const Matrix3Block& A, double det[], int n )
+{
+  UINTAH_VECTORIZE_LOOP
+  for (int l = 0; l < n; l++) {
+    det[l] = A.m[0][l]*A.m[4][l]*A.m[8][l] +
+             A.m[1][l]*A.m[5][l]*A.m[6][l] +
+             A.m[2][l]*A.m[3][l]*A.m[7][l] -
+             A.m[2][l]*A.m[4][l]*A.m[6][l] -
+             A.m[1][l]*A.m[3][l]*A.m[8][l] -
+             A.m[0][l]*A.m[5][l]*A.m[7][l];
+  }
+}
+
+//______________________________________________________________________
+//
+void
+Matrix3Batch::inverse( const Matrix3Block& A, Matrix3Block& Ainv, int n )
+{
+  double det[W];
+  determinant(A, det, n);
+  for (int l = 0; l < n; l++) {
+    if (det[l] == 0.0) {
+      singular(A, l, "inverse", det[l]);
+    }
+  }
+
+  UINTAH_VECTORIZE_LOOP
+  for (int l = 0; l < n; l++) {
+    const double a00 = A.m[0][l], a01 = A.m[1][l], a02 = A.m[2][l];
+    const double a10 = A.m[3][l], a11 = A.m[4][l], a12 = A.m[5][l];
+    const double a20 = A.m[6][l], a21 = A.m[7][l], a22 = A.m[8][l];
+    const double rdet = 1.0/det[l];
+
+    Ainv.m[0][l] = ( a11*a22 - a12*a21)*rdet;
+    Ainv.m[1][l] = (-a01*a22 + a21*a02)*rdet;
+    Ainv.m[2][l] = ( a01*a12 - a11*a02)*rdet;
+    Ainv.m[3][l] = (-a10*a22 + a20*a12)*rdet;
+    Ainv.m[4][l] = ( a00*a22 - a02*a20)*rdet;
+    Ainv.m[5][l] = (-a00*a12 + a10*a02)*rdet;
+    Ainv.m[6][l] = ( a10*a21 - a20*a11)*rdet;
+    Ainv.m[7][l] = (-a00*a21 + a20*a01)*rdet;
+    Ainv.m[8][l] = ( a00*a11 - a01*a10)*rdet;
+  }
+}
+
+//______________________________________________________________________
+//
+void
+Matrix3Batch::multiply( const Matrix3Block& A, const Matrix3Block& B, Matrix3Block& C, int n )
+{
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      UINTAH_VECTORIZE_LOOP
+      for (int l = 0; l < n; l++) {
+        C.m[ij(i,j)][l] = A.m[ij(i,0)][l]*B.m[ij(0,j)][l]
+                        + A.m[ij(i,1)][l]*B.m[ij(1,j)][l]
+                        + A.m[ij(i,2)][l]*B.m[ij(2,j)][l];
+      }
+    }
+  }
+}
+
+void
+Matrix3Batch::multiplyTranspose( const Matrix3Block& A, const Matrix3Block& B, Matrix3Block& C, int n )
+{
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      UINTAH_VECTORIZE_LOOP
+      for (int l = 0; l < n; l++) {
+        C.m[ij(i,j)][l] = A.m[ij(i,0)][l]*B.m[ij(j,0)][l]
+                        + A.m[ij(i,1)][l]*B.m[ij(j,1)][l]
+                        + A.m[ij(i,2)][l]*B.m[ij(j,2)][l];
+      }
+    }
+  }
+}
+
+void
+Matrix3Batch::transposeMultiply( const Matrix3Block& A, const Matrix3Block& B, Matrix3Block& C, int n )
+{
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      UINTAH_VECTORIZE_LOOP
+      for (int l = 0; l < n; l++) {
+        C.m[ij(i,j)][l] = A.m[ij(0,i)][l]*B.m[ij(0,j)][l]
+                        + A.m[ij(1,i)][l]*B.m[ij(1,j)][l]
+                        + A.m[ij(2,i)][l]*B.m[ij(2,j)][l];
+      }
+    }
+  }
+}
+
+void
+Matrix3Batch::scale( const Matrix3Block& A, const double s[], Matrix3Block& B, int n )
+{
+  for (int c = 0; c < 9; c++) {
+    UINTAH_VECTORIZE_LOOP
+    for (int l = 0; l < n; l++) {
+      B.m[c][l] = A.m[c][l]*s[l];
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+void
+Matrix3Batch::polarDecompositionRMB( const Matrix3Block& F, Matrix3Block& U, Matrix3Block& R, int n )
+{
+  polarRotationRMB(F, R, n);
+
+  // Stretch: U = R^T*F
+  transposeMultiply(R, F, U, n);
+}
+
+//______________________________________________________________________
+//  The scaled Bjorck and Bowie iteration of Matrix3::polarRotationRMB
+//  (see there for the references), run on all lanes together.  A lane
+//  stops being updated once it has converged, and the block is done
+//  when all of its lanes have.
+void
+Matrix3Batch::polarRotationRMB( const Matrix3Block& F, Matrix3Block& R, int n )
+{
+  double det[W];
+  determinant(F, det, n);
+  for (int l = 0; l < n; l++) {
+    if (det[l] <= 0.0) {
+      singular(F, l, "polarRotationRMB", det[l]);
+    }
+  }
+
+  Matrix3Block& A = R;
+  Matrix3Block  E, X;
+  double        S[W], ERRZ[W];
+  int           active[W];
+
+  // E = (1/2)(S F^T F - I) and A = sqrt(S) F, with F scaled by
+  // S = 3/trace(F^T F) to guarantee convergence
+  transposeMultiply(F, F, E, n);
+
+  UINTAH_VECTORIZE_LOOP
+  for (int l = 0; l < n; l++) {
+    S[l] = 3.0/(E.m[0][l] + E.m[4][l] + E.m[8][l]);
+  }
+  for (int c = 0; c < 9; c++) {
+    UINTAH_VECTORIZE_LOOP
+    for (int l = 0; l < n; l++) {
+      E.m[c][l] = (E.m[c][l]*S[l] - identity[c])*0.5;
+      A.m[c][l] = F.m[c][l]*std::sqrt(S[l]);
+    }
+  }
+
+  // scaling alone is enough when the stretch is isotropic
+  int nActive = 0;
+  for (int l = 0; l < n; l++) {
+    ERRZ[l]   = polarError(E, l);
+    active[l] = (ERRZ[l] + 1.0 == 1.0) ? 0 : 1;
+    nActive  += active[l];
+  }
+
+  for (int iter = 0; nActive > 0; iter++) {
+
+    // X = A(I - E), and A = X in the lanes still iterating
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        UINTAH_VECTORIZE_LOOP
+        for (int l = 0; l < n; l++) {
+          X.m[ij(i,j)][l] = A.m[ij(i,0)][l]*(identity[ij(0,j)] - E.m[ij(0,j)][l])
+                          + A.m[ij(i,1)][l]*(identity[ij(1,j)] - E.m[ij(1,j)][l])
+                          + A.m[ij(i,2)][l]*(identity[ij(2,j)] - E.m[ij(2,j)][l]);
+        }
+      }
+    }
+    for (int c = 0; c < 9; c++) {
+      UINTAH_VECTORIZE_LOOP
+      for (int l = 0; l < n; l++) {
+        A.m[c][l] = active[l] ? X.m[c][l] : A.m[c][l];
+      }
+    }
+
+    // E = (1/2)(A^T A - I)
+    transposeMultiply(A, A, E, n);
+    for (int c = 0; c < 9; c++) {
+      UINTAH_VECTORIZE_LOOP
+      for (int l = 0; l < n; l++) {
+        E.m[c][l] = (E.m[c][l] - identity[c])*0.5;
+      }
+    }
+
+    // a lane has converged to machine precision once its error stops
+    // decreasing
+    nActive = 0;
+    for (int l = 0; l < n; l++) {
+      if (active[l]) {
+        const double ERR = polarError(E, l);
+        if (ERR >= ERRZ[l] || ERR + 1.0 == 1.0) {
+          active[l] = 0;
+        }
+        ERRZ[l]  = ERR;
+        nActive += active[l];
+      }
+    }
+
+    if (nActive > 0 && iter == 200) {
+      for (int l = 0; l < n; l++) {
+        if (active[l]) {
+          std::ostringstream msg;
+          msg.precision(15);
+          msg << "Matrix3Batch::polarRotationRMB not converging with matrix " << F.get(l)
+              << " (ERR = " << ERRZ[l] << ")";
+          throw InternalError(msg.str(), __FILE__, __LINE__);
+        }
+      }
+    }
+  }
+}
+
+//______________________________________________________________________
+//  Cyclic Jacobi eigen solve.  A fixed number of sweeps, rather than a
+//  convergence test, keeps the lanes in lock step; for 3x3 tensors the
+//  off diagonal terms are at round off after four or five sweeps.
+void
+Matrix3Batch::eigen( const SymmMatrix3Block& A, double eval[3][Matrix3Block::width], Matrix3Block& evec, int n )
+{
+  const int sweeps = 6;
+
+  double a[3][3][W];
+  double v[3][3][W];
+
+  UINTAH_VECTORIZE_LOOP
+  for (int l = 0; l < n; l++) {
+    a[0][0][l] = A.m[0][l];
+    a[1][1][l] = A.m[1][l];
+    a[2][2][l] = A.m[2][l];
+    a[1][2][l] = a[2][1][l] = A.m[3][l];
+    a[2][0][l] = a[0][2][l] = A.m[4][l];
+    a[0][1][l] = a[1][0][l] = A.m[5][l];
+  }
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      UINTAH_VECTORIZE_LOOP
+      for (int l = 0; l < n; l++) {
+        v[i][j][l] = identity[ij(i,j)];
+      }
+    }
+  }
+
+  for (int sweep = 0; sweep < sweeps; sweep++) {
+    jacobiRotate(a, v, 0, 1, 2, n);
+    jacobiRotate(a, v, 0, 2, 1, n);
+    jacobiRotate(a, v, 1, 2, 0, n);
+  }
+
+  for (int k = 0; k < 3; k++) {
+    UINTAH_VECTORIZE_LOOP
+    for (int l = 0; l < n; l++) {
+      eval[k][l] = a[k][k][l];
+    }
+  }
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      UINTAH_VECTORIZE_LOOP
+      for (int l = 0; l < n; l++) {
+        evec.m[ij(i,j)][l] = v[i][j][l];
+      }
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+void
+Matrix3Batch::expSymmetric( const SymmMatrix3Block& A, SymmMatrix3Block& expA, int n )
+{
+  double       eval[3][W];
+  Matrix3Block evec;
+  eigen(A, eval, evec, n);
+
+  for (int k = 0; k < 3; k++) {
+    UINTAH_VECTORIZE_LOOP
+    for (int l = 0; l < n; l++) {
+      eval[k][l] = std::exp(eval[k][l]);
+    }
+  }
+  assemble(eval, evec, expA, n);
+}
+
+void
+Matrix3Batch::logSymmetric( const SymmMatrix3Block& A, SymmMatrix3Block& logA, int n )
+{
+  double       eval[3][W];
+  Matrix3Block evec;
+  eigen(A, eval, evec, n);
+
+  for (int l = 0; l < n; l++) {
+    if (!(eval[0][l] > 0.0 && eval[1][l] > 0.0 && eval[2][l] > 0.0)) {
+      std::ostringstream msg;
+      msg << "Matrix3Batch::logSymmetric: matrix " << A.getMatrix3(l)
+          << " is not positive definite";
+      throw InternalError(msg.str(), __FILE__, __LINE__);
+    }
+  }
+
+  for (int k = 0; k < 3; k++) {
+    UINTAH_VECTORIZE_LOOP
+    for (int l = 0; l < n; l++) {
+      eval[k][l] = std::log(eval[k][l]);
+    }
+  }
+  assemble(eval, evec, logA, n);
+}
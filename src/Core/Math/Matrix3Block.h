@@ -0,0 +1,183 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef UINTAH_CORE_MATH_MATRIX3BLOCK_H
+#define UINTAH_CORE_MATH_MATRIX3BLOCK_H
+
+#include <Core/Math/Matrix3.h>
+#include <Core/Math/SymmMatrix3.h>
+
+namespace Uintah {
+
+/**************************************
+
+CLASS
+   Matrix3Block, SymmMatrix3Block
+
+GENERAL INFORMATION
+
+   Matrix3Block.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+KEYWORDS
+   Matrix3, SymmMatrix3, Vectorization, Constitutive Models
+
+DESCRIPTION
+   Structure of arrays storage for a block of up to "width" tensors,
+   one per particle, and the Matrix3Batch kernels that operate on a
+   whole block at a time.  Component (i,j) of every tensor in the
+   block is contiguous, so the lane loops inside the kernels vectorize
+   where the per particle Matrix3 code does not:
+
+     Matrix3Block F, R;
+     int n = 0;
+     for (; n < Matrix3Block::width && iter != pset->end(); n++, iter++) {
+       F.set(n, pDefGrad[*iter]);
+     }
+     Matrix3Batch::polarRotationRMB(F, R, n);
+     ... R.get(l) is the rotation of the l-th particle of the block ...
+
+   The kernels give the same results as their Matrix3 counterparts
+   (up to round off), but report a singular tensor by throwing an
+   InternalError rather than exiting.
+
+   SymmMatrix3Block uses the SymmMatrix3 component order,
+   (0,0), (1,1), (2,2), (1,2), (2,0), (0,1).
+
+WARNING
+   The output block of a kernel may not be one of its input blocks,
+   except for scale().
+
+****************************************/
+
+class Matrix3Block {
+
+  public:
+
+    enum { width = 16 };
+
+    // component (i,j) of lane l is m[3*i+j][l]
+    double m[9][width];
+
+    inline void set( int lane, const Matrix3& A )
+    {
+      for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+          m[3*i+j][lane] = A(i,j);
+        }
+      }
+    }
+
+    inline Matrix3 get( int lane ) const
+    {
+      return Matrix3(m[0][lane], m[1][lane], m[2][lane],
+                     m[3][lane], m[4][lane], m[5][lane],
+                     m[6][lane], m[7][lane], m[8][lane]);
+    }
+};
+
+class SymmMatrix3Block {
+
+  public:
+
+    enum { width = Matrix3Block::width };
+
+    // component c (in SymmMatrix3 order) of lane l is m[c][l]
+    double m[6][width];
+
+    inline void set( int lane, const SymmMatrix3& A )
+    {
+      for (int c = 0; c < 6; c++) {
+        m[c][lane] = A[c];
+      }
+    }
+
+    // the symmetric part of A
+    inline void set( int lane, const Matrix3& A )
+    {
+      m[0][lane] = A(0,0);
+      m[1][lane] = A(1,1);
+      m[2][lane] = A(2,2);
+      m[3][lane] = 0.5*(A(1,2) + A(2,1));
+      m[4][lane] = 0.5*(A(2,0) + A(0,2));
+      m[5][lane] = 0.5*(A(0,1) + A(1,0));
+    }
+
+    inline SymmMatrix3 get( int lane ) const
+    {
+      SymmMatrix3 A;
+      for (int c = 0; c < 6; c++) {
+        A[c] = m[c][lane];
+      }
+      return A;
+    }
+
+    inline Matrix3 getMatrix3( int lane ) const
+    {
+      return Matrix3(m[0][lane], m[5][lane], m[4][lane],
+                     m[5][lane], m[1][lane], m[3][lane],
+                     m[4][lane], m[3][lane], m[2][lane]);
+    }
+};
+
+namespace Matrix3Batch {
+
+  // det[l] = determinant of lane l, for the first n lanes
+  void determinant( const Matrix3Block& A, double det[], int n );
+
+  // Ainv = inverse of A
+  void inverse( const Matrix3Block& A, Matrix3Block& Ainv, int n );
+
+  // C = A*B, C = A*B^T and C = A^T*B
+  void multiply( const Matrix3Block& A, const Matrix3Block& B, Matrix3Block& C, int n );
+  void multiplyTranspose( const Matrix3Block& A, const Matrix3Block& B, Matrix3Block& C, int n );
+  void transposeMultiply( const Matrix3Block& A, const Matrix3Block& B, Matrix3Block& C, int n );
+
+  // B = s[l]*A in lane l (B may be A)
+  void scale( const Matrix3Block& A, const double s[], Matrix3Block& B, int n );
+
+  // F = RU, as Matrix3::polarDecompositionRMB and Matrix3::polarRotationRMB
+  void polarDecompositionRMB( const Matrix3Block& F, Matrix3Block& U, Matrix3Block& R, int n );
+  void polarRotationRMB( const Matrix3Block& F, Matrix3Block& R, int n );
+
+  // Eigenvalues (unsorted) and eigenvectors (the columns of evec) of a
+  // symmetric tensor, A = evec*diag(eval)*evec^T
+  void eigen( const SymmMatrix3Block& A, double eval[3][Matrix3Block::width], Matrix3Block& evec, int n );
+
+  // Exponential and logarithm of a symmetric tensor, through its
+  // eigen decomposition.  The logarithm requires A to be positive definite.
+  void expSymmetric( const SymmMatrix3Block& A, SymmMatrix3Block& expA, int n );
+  void logSymmetric( const SymmMatrix3Block& A, SymmMatrix3Block& logA, int n );
+
+} // End namespace Matrix3Batch
+
+} // End namespace Uintah
+
+#endif
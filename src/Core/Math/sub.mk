@@ -61,6 +61,7 @@ SRCS += \
         $(SRCDIR)/FastMatrix.cc        \
         $(SRCDIR)/Primes.cc            \
         $(SRCDIR)/Matrix3.cc           \
+        $(SRCDIR)/Matrix3Block.cc      \
         $(SRCDIR)/SymmMatrix3.cc       \
         $(SRCDIR)/CubeRoot.cc          \
         $(SRCDIR)/Sparse.cc            \
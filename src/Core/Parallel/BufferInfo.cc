@@ -80,6 +80,19 @@ BufferInfo::add( void*          startbuf,
   d_counts.push_back( count );
   d_datatypes.push_back( datatype );
   d_free_datatypes.push_back( free_datatype );
+  d_layouts.push_back( BufferLayout() );
+}
+
+void
+BufferInfo::add( void*                startbuf,
+                 int                  count,
+                 MPI_Datatype         datatype,
+                 bool                 free_datatype,
+                 const BufferLayout&  layout
+                 )
+{
+  add( startbuf, count, datatype, free_datatype );
+  d_layouts.back() = layout;
 }
 
 void
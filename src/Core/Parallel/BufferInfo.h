@@ -56,6 +56,31 @@ public:
   RefBase  * obj;
 };
 
+// Where the elements of a buffer entry are in memory, so that it can be
+// packed with plain copies instead of its MPI datatype: elements of
+// elemBytes at start + i*stride[0] + j*stride[1] + k*stride[2], or at
+// start + indices[n]*elemBytes if indices is not empty.
+// elemBytes == 0 means the entry has no such description.
+struct BufferLayout {
+  BufferLayout() : elemBytes(0) {
+    extent[0] = extent[1] = extent[2] = 0;
+    stride[0] = stride[1] = stride[2] = 0;
+  }
+
+  long bytes() const
+  {
+    if( !indices.empty() ) {
+      return (long)indices.size() * elemBytes;
+    }
+    return (long)extent[0] * extent[1] * extent[2] * elemBytes;
+  }
+
+  int               elemBytes;
+  int               extent[3];
+  long              stride[3];
+  std::vector<int>  indices;
+};
+
 class BufferInfo {
 
   public:
@@ -75,6 +100,13 @@ class BufferInfo {
             , bool           free_datatype
             );
 
+    void add( void*                startbuf
+            , int                  count
+            , MPI_Datatype         datatype
+            , bool                 free_datatype
+            , const BufferLayout&  layout
+            );
+
     void addSendlist( RefBase* );
 
     Sendlist* takeSendlist();
@@ -89,6 +121,7 @@ class BufferInfo {
     std::vector<int>            d_counts;
     std::vector<MPI_Datatype>   d_datatypes;
     std::vector<bool>           d_free_datatypes;
+    std::vector<BufferLayout>   d_layouts;
 
     void*          buf;
     int            cnt;
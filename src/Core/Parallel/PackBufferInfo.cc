@@ -30,10 +30,85 @@
 
 using namespace Uintah;
 
+#include <algorithm>
 #include <iostream>
 #include <zlib.h>
 #include <string.h>
 
+bool                     PackBufferInfo::s_explicitPacking = false;
+long                     PackBufferInfo::s_parallelBytes   = 0;
+PackBufferInfo::PackLoop PackBufferInfo::s_packLoop        = 0;
+
+namespace {
+
+  // indexed entries are copied in rows of this many elements
+  const long indexRow = 1024;
+
+  long numRows( const BufferLayout& layout )
+  {
+    if( !layout.indices.empty() ) {
+      return ((long)layout.indices.size() + indexRow - 1) / indexRow;
+    }
+    return (long)layout.extent[1] * layout.extent[2];
+  }
+
+  // copies row r of an entry between its memory and its packed place
+  void copyRow( const BufferLayout& layout, char* start, char* packed, long r, bool packing )
+  {
+    const long elem = layout.elemBytes;
+
+    if( !layout.indices.empty() ) {
+      long end = std::min( (long)layout.indices.size(), (r + 1) * indexRow );
+      for( long n = r * indexRow; n < end; n++ ) {
+        char* mem = start + layout.indices[n] * elem;
+        if( packing ) {
+          memcpy( packed + n * elem, mem, elem );
+        }
+        else {
+          memcpy( mem, packed + n * elem, elem );
+        }
+      }
+      return;
+    }
+
+    long  j   = r % layout.extent[1];
+    long  k   = r / layout.extent[1];
+    char* mem = start + j * layout.stride[1] + k * layout.stride[2];
+    char* row = packed + r * layout.extent[0] * elem;
+
+    if( layout.stride[0] == elem ) {
+      if( packing ) {
+        memcpy( row, mem, layout.extent[0] * elem );
+      }
+      else {
+        memcpy( mem, row, layout.extent[0] * elem );
+      }
+    }
+    else {
+      for( long i = 0; i < layout.extent[0]; i++ ) {
+        if( packing ) {
+          memcpy( row + i * elem, mem + i * layout.stride[0], elem );
+        }
+        else {
+          memcpy( mem + i * layout.stride[0], row + i * elem, elem );
+        }
+      }
+    }
+  }
+
+}
+
+void
+PackBufferInfo::setExplicitPacking( bool      explicitPacking,
+                                    long      parallelBytes,
+                                    PackLoop  loop )
+{
+  s_explicitPacking = explicitPacking;
+  s_parallelBytes   = parallelBytes;
+  s_packLoop        = loop;
+}
+
+
 PackBufferInfo::PackBufferInfo() :
   BufferInfo()
 {
@@ -57,14 +132,7 @@ PackBufferInfo::get_type( void*&         out_buf,
   MALLOC_TRACE_TAG_SCOPE("PackBufferInfo::get_type");
   ASSERT(count() > 0);
   if( !d_have_datatype ) {
-    int packed_size;
-    int total_packed_size = 0;
-    for( unsigned int i = 0; i < d_startbufs.size(); i++ ) {
-      if( d_counts[i] > 0 ) {
-        Uintah::MPI::Pack_size( d_counts[i], d_datatypes[i], comm, &packed_size );
-        total_packed_size += packed_size;
-      }
-    }
+    int total_packed_size = packedSize( comm );
 
     packedBuffer = scinew PackedBuffer(total_packed_size);
     packedBuffer->addReference();
@@ -96,23 +164,57 @@ PackBufferInfo::pack( MPI_Comm   comm,
   MALLOC_TRACE_TAG_SCOPE("PackBufferInfo::pack");
   ASSERT( d_have_datatype );
 
-  int position = 0;
-  int bufsize = packedBuffer->getBufSize();
-  //for each buffer
+  //pack into a contiguous buffer
+  out_count = transfer( (char*)buf, packedBuffer->getBufSize(), comm, true );
+
+  // When it is all packed, only the buffer necessarily needs to be kept
+  // around until after it is sent.
+  delete d_sendlist;
+  d_sendlist = 0;
+  addSendlist( packedBuffer );
+}
+
+int
+PackBufferInfo::packedSize( MPI_Comm comm ) const
+{
+  int packed_size;
+  int total_packed_size = 0;
   for( unsigned int i = 0; i < d_startbufs.size(); i++ ) {
-    //pack into a contiguous buffer
     if( d_counts[i] > 0 ) {
-      Uintah::MPI::Pack( d_startbufs[i], d_counts[i], d_datatypes[i], buf, bufsize, &position, comm );
+      if( s_explicitPacking && d_layouts[i].elemBytes > 0 ) {
+        packed_size = d_layouts[i].bytes();
+      }
+      else {
+        Uintah::MPI::Pack_size( d_counts[i], d_datatypes[i], comm, &packed_size );
+      }
+      total_packed_size += packed_size;
     }
   }
+  return total_packed_size;
+}
 
-  out_count = position;
+void
+PackBufferInfo::pack( void*      dest,
+                      int        size,
+                      MPI_Comm   comm,
+                      int&       out_count )
+{
+  MALLOC_TRACE_TAG_SCOPE("PackBufferInfo::pack");
+
+  out_count = transfer( (char*)dest, size, comm, true );
 
-  // When it is all packed, only the buffer necessarily needs to be kept
-  // around until after it is sent.
   delete d_sendlist;
   d_sendlist = 0;
-  addSendlist( packedBuffer );
+}
+
+void
+PackBufferInfo::unpack( const void*  src,
+                        int          size,
+                        MPI_Comm     comm )
+{
+  MALLOC_TRACE_TAG_SCOPE("PackBufferInfo::unpack");
+
+  transfer( (char*)src, size, comm, false );
 }
 
 void
@@ -122,13 +224,80 @@ PackBufferInfo::unpack( MPI_Comm     comm,
   MALLOC_TRACE_TAG_SCOPE("PackBufferInfo::unpack");
   ASSERT( d_have_datatype );
 
-  unsigned long bufsize = packedBuffer->getBufSize();
+  transfer( (char*)buf, packedBuffer->getBufSize(), comm, false );
+}
+
+int
+PackBufferInfo::transfer( char*     packed,
+                          int       size,
+                          MPI_Comm  comm,
+                          bool      packing )
+{
+  // Entries without a layout go through MPI_Pack/MPI_Unpack, which advance
+  // the position by the same amount on both sides; the others only
+  // reserve their bytes here and are copied below.
+  std::vector<int> offsets( d_startbufs.size(), -1 );
+  long copyBytes = 0;
+  long copyRows  = 0;
 
   int position = 0;
   for( unsigned int i = 0; i < d_startbufs.size(); i++ ) {
-    if( d_counts[i] > 0 ) {
-      Uintah::MPI::Unpack( buf, bufsize, &position, d_startbufs[i], d_counts[i], d_datatypes[i], comm );
+    if( d_counts[i] <= 0 ) {
+      continue;
+    }
+    if( s_explicitPacking && d_layouts[i].elemBytes > 0 ) {
+      offsets[i] = position;
+      position  += d_layouts[i].bytes();
+      copyBytes += d_layouts[i].bytes();
+      copyRows  += numRows( d_layouts[i] );
+    }
+    else if( packing ) {
+      Uintah::MPI::Pack( d_startbufs[i], d_counts[i], d_datatypes[i], packed, size, &position, comm );
     }
+    else {
+      Uintah::MPI::Unpack( packed, size, &position, d_startbufs[i], d_counts[i], d_datatypes[i], comm );
+    }
+  }
+
+  if( copyRows == 0 ) {
+    return position;
   }
+  ASSERT( position <= size );
+
+  // the first row of each copied entry, over all of them
+  std::vector<unsigned int> entries;
+  std::vector<long>         firstRow;
+  long rows = 0;
+  for( unsigned int i = 0; i < d_startbufs.size(); i++ ) {
+    if( offsets[i] >= 0 ) {
+      entries.push_back( i );
+      firstRow.push_back( rows );
+      rows += numRows( d_layouts[i] );
+    }
+  }
+
+  auto copyRange = [&]( long begin, long end ) {
+    unsigned int e = std::upper_bound( firstRow.begin(), firstRow.end(), begin ) - firstRow.begin() - 1;
+    for( long r = begin; r < end; r++ ) {
+      while( e + 1 < entries.size() && firstRow[e + 1] <= r ) {
+        e++;
+      }
+      unsigned int i = entries[e];
+      copyRow( d_layouts[i], (char*)d_startbufs[i], packed + offsets[i], r - firstRow[e], packing );
+    }
+  };
+
+  if( s_packLoop && s_parallelBytes > 0 && copyBytes >= s_parallelBytes ) {
+    // chunks of about s_parallelBytes / 4 for the threads to share
+    long chunks = std::min( copyRows, std::max( 1L, 4 * copyBytes / s_parallelBytes ) );
+    s_packLoop( (int)chunks, [&]( int c ) {
+      copyRange( c * copyRows / chunks, (c + 1) * copyRows / chunks );
+    });
+  }
+  else {
+    copyRange( 0, copyRows );
+  }
+
+  return position;
 }
 
@@ -31,6 +31,8 @@
 #include <Core/Parallel/ProcessorGroup.h>
 #include <Core/Malloc/Allocator.h>
 
+#include <functional>
+
 namespace Uintah {
 
 class PackedBuffer : public RefCounted {
@@ -75,14 +77,45 @@ class PackBufferInfo : public BufferInfo {
     void unpack( MPI_Comm     comm,
                  MPI_Status&  status );
 
+    // Size the buffers would take packed, without allocating the message buffer.
+    int packedSize( MPI_Comm comm ) const;
+
+    // Pack straight into dest (of size bytes) instead of the message buffer,
+    // e.g. a shared memory slot.  The data no longer needs to be kept around.
+    void pack( void*      dest,
+               int        size,
+               MPI_Comm   comm,
+               int&       out_count );
+
+    // Unpack from a buffer other than the message buffer.
+    void unpack( const void*  src,
+                 int          size,
+                 MPI_Comm     comm );
+
     // PackBufferInfo is to be an AfterCommuncationHandler object for the
     // MPI_CommunicationRecord template in MPIScheduler.cc.  After receive
     // requests have finished, then it needs to unpack what got received.
 
     void finishedCommunication( const ProcessorGroup* pg, MPI_Status& status ) { unpack( pg->getComm(), status ); }
 
+    // Runs body(0) .. body(n-1), possibly in parallel.
+    typedef void (*PackLoop)( int n, const std::function<void(int)>& body );
+
+    // Copy the entries that have a BufferLayout with memcpy instead of
+    // MPI_Pack/MPI_Unpack.  Messages with at least parallelBytes of such
+    // data are copied in chunks through loop, if one is given.  All ranks
+    // have to use the same setting and the same data representation.
+    static void setExplicitPacking( bool explicitPacking, long parallelBytes = 0, PackLoop loop = 0 );
+
   private:
 
+    // Packs into (or unpacks from) packed; returns the packed size.
+    int transfer( char* packed, int size, MPI_Comm comm, bool packing );
+
+    static bool     s_explicitPacking;
+    static long     s_parallelBytes;
+    static PackLoop s_packLoop;
+
     // disable copy and assignment
     PackBufferInfo(const PackBufferInfo&);
     PackBufferInfo& operator=(const PackBufferInfo&);
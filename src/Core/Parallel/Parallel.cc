@@ -34,6 +34,7 @@
 #include <iostream>
 #include <sstream>
 #include <thread>
+#include <vector>
 
 using namespace Uintah;
 
@@ -58,6 +59,15 @@ int              Parallel::worldRank_            = -1;
 int              Parallel::worldSize_            = -1;
 ProcessorGroup*  Parallel::rootContext_          = 0;
 
+namespace {
+  // never destroyed, as finalizeManager() may run from an exit handler
+  std::vector< std::function<void()> > & finalizeHooks()
+  {
+    static std::vector< std::function<void()> > * hooks = new std::vector< std::function<void()> >;
+    return *hooks;
+  }
+}
+
 namespace Uintah {
 
   // While worldComm_ should be declared in Parallel.h, I would need to
@@ -351,6 +361,12 @@ Parallel::finalizeManager( Circumstances circumstances /* = NormalShutdown */ )
       Time::waitFor(1.0);
       Uintah::MPI::Abort( Uintah::worldComm_, errorcode );
     } else {
+      while( !finalizeHooks().empty() ) {
+        std::function<void()> hook = finalizeHooks().back();
+        finalizeHooks().pop_back();
+        hook();
+      }
+
       int status;
       if ((status = Uintah::MPI::Finalize()) != MPI_SUCCESS) {
         MpiError(const_cast<char*>("Uinath::MPI::Finalize"), status);
@@ -366,6 +382,12 @@ Parallel::finalizeManager( Circumstances circumstances /* = NormalShutdown */ )
   determinedIfUsingMPI_ = false;
 }
 
+void
+Parallel::addFinalizeHook( const std::function<void()> & hook )
+{
+  finalizeHooks().push_back( hook );
+}
+
 ProcessorGroup*
 Parallel::getRootProcessorGroup()
 {
@@ -25,6 +25,7 @@
 #ifndef CORE_PARALLEL_PARALLEL_H
 #define CORE_PARALLEL_PARALLEL_H
 
+#include <functional>
 #include <thread>
 
 
@@ -102,6 +103,12 @@ class Parallel {
       // Insert Documentation Here:
       static void finalizeManager( Circumstances cirumstances = NormalShutdown );
 
+      //////////
+      // Registers a function that finalizeManager() calls, on a normal
+      // shutdown, before MPI_Finalize - to free MPI objects (datatypes,
+      // ops, ...) kept for the whole run.  Called in reverse order.
+      static void addFinalizeHook( const std::function<void()> & hook );
+
       //////////
       // Insert Documentation here:
       static ProcessorGroup* getRootProcessorGroup();
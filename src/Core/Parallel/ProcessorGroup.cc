@@ -27,6 +27,7 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
 
 
 using namespace Uintah;
@@ -38,14 +39,61 @@ ProcessorGroup::ProcessorGroup( const ProcessorGroup* parent,
 			                                int size,
 			                                int threads )
   : d_parent(parent), d_rank(rank), d_size(size),  d_threads(threads),
-    d_comm(comm),  d_allmpi(allmpi)
+    d_comm(comm),  d_allmpi(allmpi), d_numNodes(1), d_nodeOfRank(size, 0),
+    d_nodeComm(MPI_COMM_NULL)
 {
+  if (d_allmpi) {
+    setupNodeTopology();
+  }
 }
 
 ProcessorGroup::~ProcessorGroup()
 {
 }
 
+void ProcessorGroup::setupNodeTopology()
+{
+  // group the ranks that share memory
+#if UINTAH_ENABLE_MPI3
+  MPI::Comm_split_type(d_comm, MPI_COMM_TYPE_SHARED, d_rank, MPI_INFO_NULL, &d_nodeComm);
+#else
+  // no MPI_Comm_split_type: ranks with the same processor name share a node
+  char name[MPI_MAX_PROCESSOR_NAME];
+  int  length = 0;
+  memset(name, 0, MPI_MAX_PROCESSOR_NAME);
+  MPI::Get_processor_name(name, &length);
+
+  std::vector<char> names(d_size * MPI_MAX_PROCESSOR_NAME);
+  MPI::Allgather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, &names[0], MPI_MAX_PROCESSOR_NAME, MPI_CHAR, d_comm);
+
+  int color = d_rank;
+  for (int r = 0; r < d_rank; r++) {
+    if (strncmp(&names[r * MPI_MAX_PROCESSOR_NAME], name, MPI_MAX_PROCESSOR_NAME) == 0) {
+      color = r;
+      break;
+    }
+  }
+  MPI::Comm_split(d_comm, color, d_rank, &d_nodeComm);
+#endif
+
+  // the lowest rank on each node identifies it
+  int leader;
+  MPI::Allreduce(&d_rank, &leader, 1, MPI_INT, MPI_MIN, d_nodeComm);
+
+  std::vector<int> leaders(d_size);
+  MPI::Allgather(&leader, 1, MPI_INT, &leaders[0], 1, MPI_INT, d_comm);
+
+  // number the nodes in the order of their leaders
+  std::vector<int> nodeOfLeader(d_size, -1);
+  d_numNodes = 0;
+  for (int r = 0; r < d_size; r++) {
+    if (nodeOfLeader[leaders[r]] == -1) {
+      nodeOfLeader[leaders[r]] = d_numNodes++;
+    }
+    d_nodeOfRank[r] = nodeOfLeader[leaders[r]];
+  }
+}
+
 void ProcessorGroup::setgComm( int nComm ) const
 {
   if (d_threads <= 1 || !d_allmpi) {
@@ -86,8 +86,23 @@ class ProcessorGroup {
 
     void setgComm( int i ) const;
 
+    // Shared-memory node topology: ranks that run on the same node get the
+    // same node number (0 .. numNodes()-1, in order of their lowest rank).
+    int numNodes() const { return d_numNodes; }
+
+    int myNode() const { return d_nodeOfRank[d_rank]; }
+
+    int getNode( int rank ) const { return d_nodeOfRank[rank]; }
+
+    bool onMyNode( int rank ) const { return d_nodeOfRank[rank] == d_nodeOfRank[d_rank]; }
+
+    // communicator of the ranks on this node (MPI_COMM_NULL without MPI)
+    MPI_Comm getNodeComm() const { return d_nodeComm; }
+
   private:
 
+    void setupNodeTopology();
+
     const ProcessorGroup* d_parent;
 
     friend class Parallel;
@@ -106,6 +121,10 @@ class ProcessorGroup {
     mutable std::vector<MPI_Comm> d_gComms;
     bool                          d_allmpi;
 
+    int                           d_numNodes;
+    std::vector<int>              d_nodeOfRank;
+    MPI_Comm                      d_nodeComm;
+
     // disable copy and assignment
     ProcessorGroup(const ProcessorGroup&);
     ProcessorGroup& operator=(const ProcessorGroup&);
@@ -1,6 +1,6 @@
 #!/usr/bin/env python
 
-from os import symlink,environ, system
+from os import symlink,environ, system, path
 from sys import argv,exit,platform
 from helpers.runSusTests import runSusTests, inputs_root, generatingGoldStandards
 from helpers.modUPS import modUPS
@@ -40,6 +40,7 @@ else :
 #  massource_var_den: a two-fluid mixing cold channel flow with a constant mass source, used to test mass conservation for pressure solver (with mass source terms)
 #  massource_coal_DQMOM: a coal reacting channel flow with a constant mass source term (or with coal mass source term), used to test mass conservation for pressure solver
 #  methane_RCCE: 3m fire using the westbrook dryer/RCCE model
+#  methane_fire_8patch_sweeprad__NEW: methane_fire_8patch__NEW with the sweep DO solver, compared against the hypre DO result
 
 NIGHTLYTESTS = [
    ("constantMMS__NEW"                  , "mms/constantMMS__NEW.ups"                                , 1.1 , "All"   , ["exactComparison"])   , 
@@ -50,6 +51,7 @@ NIGHTLYTESTS = [
    ("methane_fire__NEW"                 , "methane_fire__NEW.ups"                                   , 1.1 , "All"   , ["exactComparison"])   , 
    ("methane_fire_8patch__NEW"          , "methane_fire_8patch__NEW.ups"                            , 8   , "All"   , ["exactComparison"])   , 
    ("methane_fire_8patch_petscrad__NEW" , "methane_fire_8patch_petscrad__NEW.ups"                   , 8   , "All"   , ["exactComparison"])   , 
+   ("methane_fire_8patch_sweeprad__NEW" , "methane_fire_8patch_sweeprad__NEW.ups"                   , 8   , "All"   , ["abs_tolerance=1e-8", "rel_tolerance=1e-5"]) ,
    ("rmcrt_bm1_1L"                      , "RMCRT/rmcrt_bm1_1L.ups"                                  , 1.1 , "Linux" , ["exactComparison"])   , 
    ("rmcrt_bm1_DO"                      , "RMCRT/rmcrt_bm1_DO.ups"                                  , 8   , "Linux" , ["exactComparison"])   , 
    ("rmcrt_bm1_ML"                      , "RMCRT/rmcrt_bm1_ML.ups"                                  , 1.1 , "Linux" , ["exactComparison"])   , 
@@ -122,6 +124,7 @@ LOCALTESTS = [
    ("methane_fire__NEW"                 , "methane_fire__NEW.ups"                                   , 1.1 , "All"  , ["exactComparison"]) , 
    ("methane_fire_8patch__NEW"          , "methane_fire_8patch__NEW.ups"                            , 8   , "All"  , ["exactComparison"]) , 
    ("methane_fire_8patch_petscrad__NEW" , "methane_fire_8patch_petscrad__NEW.ups"                   , 8   , "All"  , ["exactComparison"]) , 
+   ("methane_fire_8patch_sweeprad__NEW" , "methane_fire_8patch_sweeprad__NEW.ups"                   , 8   , "All"  , ["abs_tolerance=1e-8", "rel_tolerance=1e-5"]) ,
    ("rmcrt_bm1_1L"                      , "RMCRT/rmcrt_bm1_1L.ups"                                  , 1.1 , "All"  , ["exactComparison"]) , 
    ("rmcrt_bm1_DO"                      , "RMCRT/rmcrt_bm1_DO.ups"                                  , 8   , "ALL"  , ["exactComparison"]) , 
    ("rmcrt_bm1_ML"                      , "RMCRT/rmcrt_bm1_ML.ups"                                  , 1.1 , "ALL"  , ["exactComparison"]) , 
@@ -189,6 +192,7 @@ NEWTESTS = [
    ("methane_fire__NEW"           , "methane_fire__NEW.ups"                       , 1.1 , "All"  , ["exactComparison"]) , 
    ("methane_fire_8patch__NEW"    , "methane_fire_8patch__NEW.ups"                , 8   , "All"  , ["exactComparison"]) , 
    ("methane_fire_8patch_petscrad__NEW" , "methane_fire_8patch_petscrad__NEW.ups" , 8   , "All"  , ["exactComparison"]) ,
+   ("methane_fire_8patch_sweeprad__NEW" , "methane_fire_8patch_sweeprad__NEW.ups" , 8   , "All"  , ["abs_tolerance=1e-8", "rel_tolerance=1e-5"]) ,
 ]
 
 DEBUG = [
@@ -250,6 +254,7 @@ NORMCRT = [
    ("methane_fire__NEW"                 , "methane_fire__NEW.ups"                                   , 1.1 , "All"  , ["exactComparison"]) , 
    ("methane_fire_8patch__NEW"          , "methane_fire_8patch__NEW.ups"                            , 8   , "All"  , ["exactComparison"]) , 
    ("methane_fire_8patch_petscrad__NEW" , "methane_fire_8patch_petscrad__NEW.ups"                   , 8   , "All"  , ["exactComparison"]) , 
+   ("methane_fire_8patch_sweeprad__NEW" , "methane_fire_8patch_sweeprad__NEW.ups"                   , 8   , "All"  , ["abs_tolerance=1e-8", "rel_tolerance=1e-5"]) ,
    ("dqmom_test_1"                      , "DQMOM_regression/dqmom_test_1.ups"                       , 1.1 , "All"  , ["exactComparison"]) , 
    ("dqmom_test_2"                      , "DQMOM_regression/dqmom_test_2.ups"                       , 1.1 , "All"  , ["exactComparison"]) , 
    ("dqmom_test_3"                      , "DQMOM_regression/dqmom_test_3.ups"                       , 1.1 , "All"  , ["exactComparison"]) , 
@@ -295,6 +300,34 @@ DEBUG = [
    ("methane_fire_8patch__NEW"          , "methane_fire_8patch__NEW.ups"                            , 8   , "All"  , ["exactComparison"]) , 
 ]
 
+#__________________________________
+# The sweep DO solver tests are compared against the hypre DO solution of the
+# same problem: their gold standard uda is replaced by a link to the one of
+# the hypre test.
+#   sweep test : ( hypre test, hypre uda, sweep uda )
+SWEEP_DO_TESTS = {
+   "methane_fire_8patch_sweeprad__NEW" : ( "methane_fire_8patch__NEW", "methane_fire_8patch.uda", "methane_fire_8patch_sweeprad.uda" ),
+}
+
+def linkHypreGoldStandard(test, susdir, inputsdir, compare_root, dbg_opt, max_parallelism) :
+  testname = test[0]
+  if testname not in SWEEP_DO_TESTS :
+    return
+
+  hypre_test, hypre_uda, sweep_uda = SWEEP_DO_TESTS[testname]
+  hypre_gold = "%s/%s/%s" % (compare_root, hypre_test, hypre_uda)
+  sweep_gold = "%s/%s/%s" % (compare_root, testname, sweep_uda)
+
+  if not path.isdir(hypre_gold) :
+    print( "\tWARNING: the gold standard of (%s) does not exist, (%s) is compared against its own" % (hypre_test, testname) )
+    return
+
+  if path.islink(sweep_gold) and path.realpath(sweep_gold) == path.realpath(hypre_gold) :
+    return
+
+  system( "/bin/rm -rf %s" % sweep_gold )
+  symlink( hypre_gold, sweep_gold )
+
 #__________________________________
 # The following list is parsed by the local RT script
 # and allows the user to select the tests to run
@@ -333,7 +366,7 @@ if __name__ == "__main__":
 
   TESTS = getTestList( environ['WHICH_TESTS'] )
 
-  result = runSusTests(argv, TESTS, "ARCHES")
+  result = runSusTests(argv, TESTS, "ARCHES", linkHypreGoldStandard)
   
   # cleanup modified files
   command = "/bin/rm -rf %s/tmp > /dev/null 2>&1 " % (the_dir)
@@ -0,0 +1,208 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+//
+//  DataBenchmarks.cc: data warehouse database access and the MPI
+//                     pack/unpack of ghost regions.
+//
+
+#include <StandAlone/Benchmarks/KernelBenchmarks.h>
+
+#include <CCA/Components/Schedulers/OnDemandDataWarehouse.h>
+#include <CCA/Components/Schedulers/DWDatabase.h>
+
+#include <Core/Grid/Level.h>
+#include <Core/Grid/Variables/CCVariable.h>
+#include <Core/Grid/Variables/VarLabel.h>
+#include <Core/Parallel/PackBufferInfo.h>
+#include <Core/Parallel/Parallel.h>
+#include <Core/Parallel/ProcessorGroup.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+using namespace Uintah;
+using namespace Uintah::Benchmarks;
+
+namespace {
+
+//______________________________________________________________________
+//  put() and get() of (label, matl, patch) keys, as done for every
+//  variable a task touches.
+void dwDatabase( const Options& opts, std::vector<Result>& results )
+{
+  const int nLabels  = 32;
+  const int nMatls   = 4;
+  const int nPatches = 4;     // per direction
+  const int patchSize = 4;
+
+  Grid grid;
+  LevelP level = grid.addLevel(Point(0, 0, 0), Vector(1, 1, 1));
+  std::vector<const Patch*> patches;
+  for (int i = 0; i < nPatches; i++) {
+    for (int j = 0; j < nPatches; j++) {
+      for (int k = 0; k < nPatches; k++) {
+        IntVector low = IntVector(i, j, k) * patchSize;
+        IntVector high = low + IntVector(patchSize, patchSize, patchSize);
+        patches.push_back(level->addPatch(low, high, low, high, &grid));
+      }
+    }
+  }
+  level->finalizeLevel();
+
+  std::vector<VarLabel*> labels;
+  for (int l = 0; l < nLabels; l++) {
+    std::ostringstream name;
+    name << "benchmark_var" << l;
+    labels.push_back(VarLabel::create(name.str(), CCVariable<double>::getTypeDescription()));
+  }
+
+  KeyDatabase<Patch> keys;
+  for (unsigned p = 0; p < patches.size(); p++) {
+    for (int l = 0; l < nLabels; l++) {
+      for (int m = 0; m < nMatls; m++) {
+        keys.insert(labels[l], m, patches[p]);
+      }
+    }
+  }
+
+  DWDatabase<Patch>* db = scinew DWDatabase<Patch>();
+  db->doReserve(&keys);
+
+  double nkeys = (double)patches.size() * nLabels * nMatls;
+  double minTime, meanTime;
+
+  timeKernel(opts.reps, [&]() {
+    for (unsigned p = 0; p < patches.size(); p++) {
+      for (int l = 0; l < nLabels; l++) {
+        for (int m = 0; m < nMatls; m++) {
+          db->put(labels[l], m, patches[p], scinew CCVariable<double>(), false, true);
+        }
+      }
+    }
+  }, minTime, meanTime);
+  addResult(results, "dw/put", "vars", nkeys, 0, minTime, meanTime, nkeys);
+
+  double found = 0;
+  timeKernel(opts.reps, [&]() {
+    found = 0;
+    for (unsigned p = 0; p < patches.size(); p++) {
+      for (int l = 0; l < nLabels; l++) {
+        for (int m = 0; m < nMatls; m++) {
+          if (db->exists(labels[l], m, patches[p]) && db->get(labels[l], m, patches[p])) {
+            found++;
+          }
+        }
+      }
+    }
+  }, minTime, meanTime);
+  addResult(results, "dw/get", "vars", nkeys, 0, minTime, meanTime, found);
+
+  delete db;
+  for (int l = 0; l < nLabels; l++) {
+    VarLabel::destroy(labels[l]);
+  }
+}
+
+//______________________________________________________________________
+//  Pack the ghost layers (two cells deep, all six faces) of a variable
+//  into a message buffer and unpack them on the "receiving" side.
+void packUnpack( const Options& opts, std::vector<Result>& results )
+{
+  const int ngc = 2;
+  IntVector low(0, 0, 0);
+  IntVector high(opts.size, opts.size, opts.size);
+  IntVector gc(ngc, ngc, ngc);
+
+  CCVariable<double> src, dst;
+  src.allocate(low - gc, high + gc);
+  dst.allocate(low - gc, high + gc);
+  src.initialize(3);
+  dst.initialize(0);
+
+  std::vector<IntVector> slabLow, slabHigh;
+  for (int d = 0; d < 3; d++) {
+    IntVector l = low;
+    IntVector h = high;
+    l[d] = low[d];
+    h[d] = low[d] + ngc;
+    slabLow.push_back(l);
+    slabHigh.push_back(h);
+
+    l[d] = high[d] - ngc;
+    h[d] = high[d];
+    slabLow.push_back(l);
+    slabHigh.push_back(h);
+  }
+
+  MPI_Comm comm = Uintah::Parallel::getRootProcessorGroup()->getComm();
+
+  double ncells = 6.0 * ngc * opts.size * opts.size;
+  double bytes  = 2 * sizeof(double) * ncells;
+  double minTime, meanTime;
+
+  std::vector<char> message;
+
+  timeKernel(opts.reps, [&]() {
+    PackBufferInfo sendbuf;
+    for (unsigned s = 0; s < slabLow.size(); s++) {
+      src.getMPIBuffer(sendbuf, slabLow[s], slabHigh[s]);
+    }
+    void*        buf;
+    int          count;
+    MPI_Datatype datatype;
+    sendbuf.get_type(buf, count, datatype, comm);
+    int packed;
+    sendbuf.pack(comm, packed);
+    message.assign((char*)buf, (char*)buf + packed);
+  }, minTime, meanTime);
+  addResult(results, "comm/pack", "cells", ncells, bytes, minTime, meanTime, (double)message.size());
+
+  timeKernel(opts.reps, [&]() {
+    PackBufferInfo recvbuf;
+    for (unsigned s = 0; s < slabLow.size(); s++) {
+      dst.getMPIBuffer(recvbuf, slabLow[s], slabHigh[s]);
+    }
+    void*        buf;
+    int          count;
+    MPI_Datatype datatype;
+    recvbuf.get_type(buf, count, datatype, comm);
+    memcpy(buf, &message[0], std::min((size_t)count, message.size()));
+    MPI_Status status;
+    recvbuf.unpack(comm, status);
+  }, minTime, meanTime);
+  addResult(results, "comm/unpack", "cells", ncells, bytes, minTime, meanTime, dst[low]);
+}
+
+} // End anonymous namespace
+
+//______________________________________________________________________
+//
+void
+Uintah::Benchmarks::registerDataBenchmarks( Suite& suite )
+{
+  suite.add("dw/database",      dwDatabase);
+  suite.add("comm/pack_unpack", packUnpack);
+}
@@ -0,0 +1,197 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+//
+//  GridBenchmarks.cc: cell iteration, ghost cell copies and the Stencil7
+//                     matrix-vector product used by the linear solvers.
+//
+
+#include <StandAlone/Benchmarks/KernelBenchmarks.h>
+
+#include <Core/Grid/Variables/BlockRange.hpp>
+#include <Core/Grid/Variables/CCVariable.h>
+#include <Core/Grid/Variables/CellIterator.h>
+#include <Core/Grid/Variables/Stencil7.h>
+
+using namespace Uintah;
+using namespace Uintah::Benchmarks;
+
+namespace {
+
+//______________________________________________________________________
+//  result = a * x + b, over the interior cells, three ways.
+void axpy( const Options& opts, std::vector<Result>& results )
+{
+  IntVector low(0, 0, 0);
+  IntVector high(opts.size, opts.size, opts.size);
+  double    ncells = (double)opts.size * opts.size * opts.size;
+  double    bytes  = 3 * sizeof(double) * ncells;
+  double    a      = 5;
+
+  CCVariable<double> result, x, b;
+  result.allocate(low, high);
+  x.allocate(low, high);
+  b.allocate(low, high);
+  result.initialize(0);
+  x.initialize(6);
+  b.initialize(2);
+
+  double minTime, meanTime;
+
+  timeKernel(opts.reps, [&]() {
+    for (CellIterator iter(low, high); !iter.done(); iter++) {
+      result[*iter] = a * x[*iter] + b[*iter];
+    }
+  }, minTime, meanTime);
+  addResult(results, "grid/axpy_CellIterator", "cells", ncells, bytes, minTime, meanTime, result[high - IntVector(1, 1, 1)]);
+
+  BlockRange range(low, high);
+  timeKernel(opts.reps, [&]() {
+    Uintah::parallel_for(range, [&](int i, int j, int k) {
+      result(i, j, k) = a * x(i, j, k) + b(i, j, k);
+    });
+  }, minTime, meanTime);
+  addResult(results, "grid/axpy_BlockRange", "cells", ncells, bytes, minTime, meanTime, result[high - IntVector(1, 1, 1)]);
+
+  timeKernel(opts.reps, [&]() {
+    double*       rr = &result[low];
+    const double* xx = &x[low];
+    const double* bb = &b[low];
+    const long    n  = (long)ncells;
+    for (long i = 0; i < n; i++) {
+      rr[i] = a * xx[i] + bb[i];
+    }
+  }, minTime, meanTime);
+  addResult(results, "grid/axpy_raw", "cells", ncells, bytes, minTime, meanTime, result[high - IntVector(1, 1, 1)]);
+}
+
+//______________________________________________________________________
+//  Fill one layer of ghost cells on every face from a neighbor's
+//  variable, the way the data warehouse assembles ghost regions.
+void ghostCopy( const Options& opts, std::vector<Result>& results )
+{
+  IntVector low(0, 0, 0);
+  IntVector high(opts.size, opts.size, opts.size);
+  IntVector one(1, 1, 1);
+
+  CCVariable<double> src, dst;
+  src.allocate(low - one, high + one);
+  dst.allocate(low - one, high + one);
+  src.initialize(1);
+  dst.initialize(0);
+
+  // the six face slabs (without edges and corners)
+  std::vector<IntVector> slabLow, slabHigh;
+  for (int d = 0; d < 3; d++) {
+    IntVector l = low;
+    IntVector h = high;
+    l[d] = low[d] - 1;
+    h[d] = low[d];
+    slabLow.push_back(l);
+    slabHigh.push_back(h);
+
+    l[d] = high[d];
+    h[d] = high[d] + 1;
+    slabLow.push_back(l);
+    slabHigh.push_back(h);
+  }
+
+  double ncells = 6.0 * opts.size * opts.size;
+  double bytes  = 2 * sizeof(double) * ncells;
+  double minTime, meanTime;
+
+  timeKernel(opts.reps, [&]() {
+    for (unsigned s = 0; s < slabLow.size(); s++) {
+      dst.copyPatch(src, slabLow[s], slabHigh[s]);
+    }
+  }, minTime, meanTime);
+  addResult(results, "grid/ghost_copy", "cells", ncells, bytes, minTime, meanTime, dst[low - IntVector(1, 0, 0)]);
+
+  // whole-variable copy, for reference
+  ncells = (double)(opts.size + 2) * (opts.size + 2) * (opts.size + 2);
+  bytes  = 2 * sizeof(double) * ncells;
+  timeKernel(opts.reps, [&]() {
+    dst.copyData(src);
+  }, minTime, meanTime);
+  addResult(results, "grid/array3_copy", "cells", ncells, bytes, minTime, meanTime, dst[low]);
+}
+
+//______________________________________________________________________
+//  y = A x with a 7 point stencil, as in the CG/hypre preconditioned solves.
+void stencil7MatVec( const Options& opts, std::vector<Result>& results )
+{
+  IntVector low(0, 0, 0);
+  IntVector high(opts.size, opts.size, opts.size);
+  IntVector one(1, 1, 1);
+
+  CCVariable<Stencil7> A;
+  CCVariable<double>   x, y;
+  A.allocate(low, high);
+  x.allocate(low - one, high + one);
+  y.allocate(low, high);
+
+  for (CellIterator iter(low, high); !iter.done(); iter++) {
+    Stencil7& s = A[*iter];
+    s.initialize(-1);
+    s.p = 6.1;
+  }
+  x.initialize(1);
+
+  double ncells = (double)opts.size * opts.size * opts.size;
+  double bytes  = (sizeof(Stencil7) + 2 * sizeof(double)) * ncells;
+  double minTime, meanTime;
+
+  // the default (k slab) policy and the tiled iteration policies
+  std::vector<std::pair<std::string, BlockRangePolicy> > policies;
+  policies.push_back(std::make_pair("", BlockRangePolicy()));
+  policies.push_back(std::make_pair("_collapsed_kj", BlockRangePolicy(BlockRangePolicy::CollapsedKJ).vectorized()));
+  policies.push_back(std::make_pair("_tiled", BlockRangePolicy(BlockRangePolicy::Tiled).vectorized()));
+
+  BlockRange range(low, high);
+  for (unsigned p = 0; p < policies.size(); p++) {
+    const BlockRangePolicy& policy = policies[p].second;
+    timeKernel(opts.reps, [&]() {
+      Uintah::parallel_for(range, policy, [&](int i, int j, int k) {
+        const Stencil7& s = A(i, j, k);
+        y(i, j, k) = s.p * x(i, j, k)
+                   + s.w * x(i - 1, j, k) + s.e * x(i + 1, j, k)
+                   + s.s * x(i, j - 1, k) + s.n * x(i, j + 1, k)
+                   + s.b * x(i, j, k - 1) + s.t * x(i, j, k + 1);
+      });
+    }, minTime, meanTime);
+    addResult(results, "grid/stencil7_matvec" + policies[p].first, "cells", ncells, bytes, minTime, meanTime, y[low + one]);
+  }
+}
+
+} // End anonymous namespace
+
+//______________________________________________________________________
+//
+void
+Uintah::Benchmarks::registerGridBenchmarks( Suite& suite )
+{
+  suite.add("grid/axpy",            axpy);
+  suite.add("grid/ghost_copy",      ghostCopy);
+  suite.add("grid/stencil7_matvec", stencil7MatVec);
+}
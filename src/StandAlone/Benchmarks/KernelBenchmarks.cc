@@ -0,0 +1,308 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ *  KernelBenchmarks.cc: Throughput benchmarks of the hot kernels, with
+ *                       machine readable (JSON) output.
+ *
+ *  Usage: KernelBenchmarks [-size <n>] [-reps <n>] [-ppc <n>] [-rays <n>]
+ *                          [-filter <string>] [-tag <string>]
+ *                          [-o <file.json>] [-list]
+ */
+
+#include <StandAlone/Benchmarks/KernelBenchmarks.h>
+
+#include <Core/Exceptions/Exception.h>
+#include <Core/Grid/Level.h>
+#include <Core/Parallel/Parallel.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace Uintah;
+using namespace Uintah::Benchmarks;
+using namespace std;
+
+//______________________________________________________________________
+//
+void
+Suite::add( const string& name, BenchmarkFunction function )
+{
+  Entry entry;
+  entry.name     = name;
+  entry.function = function;
+  d_entries.push_back(entry);
+}
+
+//______________________________________________________________________
+//
+void
+Suite::list( ostream& out ) const
+{
+  for (unsigned i = 0; i < d_entries.size(); i++) {
+    out << d_entries[i].name << "\n";
+  }
+}
+
+//______________________________________________________________________
+//
+void
+Suite::run( const Options& opts )
+{
+  for (unsigned i = 0; i < d_entries.size(); i++) {
+    const Entry& entry = d_entries[i];
+    if (!opts.filter.empty() && entry.name.find(opts.filter) == string::npos) {
+      continue;
+    }
+    cerr << "Running " << entry.name << "...\n";
+    entry.function(opts, d_results);
+  }
+}
+
+//______________________________________________________________________
+//
+namespace {
+
+  string quote( const string& s )
+  {
+    string result = "\"";
+    for (unsigned i = 0; i < s.size(); i++) {
+      if (s[i] == '"' || s[i] == '\\') {
+        result += '\\';
+      }
+      result += s[i];
+    }
+    return result + "\"";
+  }
+
+}
+
+//______________________________________________________________________
+//
+void
+Suite::writeJSON( ostream& out, const Options& opts, const string& tag ) const
+{
+  out << setprecision(8);
+  out << "{\n"
+      << "  \"suite\": \"KernelBenchmarks\",\n"
+      << "  \"tag\": " << quote(tag) << ",\n"
+      << "  \"options\": { \"size\": " << opts.size << ", \"reps\": " << opts.reps
+      << ", \"ppc\": " << opts.ppc << ", \"rays\": " << opts.nRays << " },\n"
+      << "  \"results\": [\n";
+
+  for (unsigned i = 0; i < d_results.size(); i++) {
+    const Result& r = d_results[i];
+    double rate = r.minTime > 0 ? r.items / r.minTime : 0;
+    double gbs  = r.minTime > 0 ? r.bytes / r.minTime / 1.e9 : 0;
+    out << "    { \"name\": " << quote(r.name)
+        << ", \"unit\": " << quote(r.unit)
+        << ", \"items\": " << r.items
+        << ", \"min_seconds\": " << r.minTime
+        << ", \"mean_seconds\": " << r.meanTime
+        << ", \"throughput\": " << rate
+        << ", \"throughput_unit\": " << quote(r.unit + "/s")
+        << ", \"bandwidth_GBs\": " << gbs
+        << ", \"checksum\": " << r.checksum << " }"
+        << (i + 1 < d_results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n"
+      << "}\n";
+}
+
+//______________________________________________________________________
+//
+void
+Suite::writeSummary( ostream& out ) const
+{
+  for (unsigned i = 0; i < d_results.size(); i++) {
+    const Result& r = d_results[i];
+    double rate = r.minTime > 0 ? r.items / r.minTime : 0;
+    out << setw(40) << left << r.name << right
+        << setw(14) << setprecision(4) << rate << " " << r.unit << "/s";
+    if (r.bytes > 0) {
+      out << setw(10) << setprecision(3) << r.bytes / r.minTime / 1.e9 << " GB/s";
+    }
+    out << "\n";
+  }
+}
+
+//______________________________________________________________________
+//
+void
+Uintah::Benchmarks::addResult( vector<Result>& results,
+                               const string&   name,
+                               const string&   unit,
+                               double          items,
+                               double          bytes,
+                               double          minTime,
+                               double          meanTime,
+                               double          checksum )
+{
+  Result r;
+  r.name     = name;
+  r.unit     = unit;
+  r.items    = items;
+  r.bytes    = bytes;
+  r.minTime  = minTime;
+  r.meanTime = meanTime;
+  r.checksum = checksum;
+  results.push_back(r);
+}
+
+//______________________________________________________________________
+//
+const Patch*
+Uintah::Benchmarks::createPatch( Grid& grid, int size )
+{
+  LevelP level = grid.addLevel(Point(0, 0, 0), Vector(1, 1, 1));
+
+  IntVector low(0, 0, 0);
+  IntVector high(size, size, size);
+  IntVector extraCells(1, 1, 1);
+
+  level->setExtraCells(extraCells);
+  const Patch* patch = level->addPatch(low - extraCells, high + extraCells, low, high, &grid);
+  level->finalizeLevel();
+
+  return patch;
+}
+
+//______________________________________________________________________
+//
+static void usage( const string& badarg, const string& progname )
+{
+  if (badarg != "") {
+    cerr << "Error parsing argument: " << badarg << "\n";
+  }
+  cerr << "Usage: " << progname << " [options]\n\n"
+       << "Valid options are:\n"
+       << "  -size <n>       cells per side of the benchmark patch (default 64)\n"
+       << "  -reps <n>       timed repetitions of each kernel (default 5)\n"
+       << "  -ppc <n>        particles per cell in each direction (default 2)\n"
+       << "  -rays <n>       rays per cell for the RMCRT trace (default 10)\n"
+       << "  -filter <str>   only run the benchmarks whose name contains <str>\n"
+       << "  -tag <str>      label stored in the JSON output (e.g. a commit hash)\n"
+       << "  -o <file>       write the JSON results to <file> (default: stdout)\n"
+       << "  -list           list the benchmarks and exit\n";
+  exit(1);
+}
+
+//______________________________________________________________________
+//
+int
+main( int argc, char** argv )
+{
+  Options opts;
+  opts.size  = 64;
+  opts.reps  = 5;
+  opts.ppc   = 2;
+  opts.nRays = 10;
+
+  string tag;
+  string outfile;
+  bool   listOnly = false;
+
+  for (int i = 1; i < argc; i++) {
+    string s = argv[i];
+    if (s == "-list") {
+      listOnly = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      usage(s, argv[0]);
+    }
+    if (s == "-size") {
+      opts.size = atoi(argv[++i]);
+    }
+    else if (s == "-reps") {
+      opts.reps = atoi(argv[++i]);
+    }
+    else if (s == "-ppc") {
+      opts.ppc = atoi(argv[++i]);
+    }
+    else if (s == "-rays") {
+      opts.nRays = atoi(argv[++i]);
+    }
+    else if (s == "-filter") {
+      opts.filter = argv[++i];
+    }
+    else if (s == "-tag") {
+      tag = argv[++i];
+    }
+    else if (s == "-o") {
+      outfile = argv[++i];
+    }
+    else {
+      usage(s, argv[0]);
+    }
+  }
+
+  if (opts.size < 4 || opts.reps < 1 || opts.ppc < 1 || opts.nRays < 1) {
+    usage("", argv[0]);
+  }
+
+  // the message packing benchmarks need MPI
+  Uintah::Parallel::initializeManager(argc, argv);
+
+  Suite suite;
+  registerGridBenchmarks(suite);
+  registerDataBenchmarks(suite);
+  registerPhysicsBenchmarks(suite);
+
+  if (listOnly) {
+    suite.list(cout);
+    Uintah::Parallel::finalizeManager();
+    return 0;
+  }
+
+  try {
+    suite.run(opts);
+  }
+  catch (Exception& e) {
+    cerr << "Caught exception: " << e.message() << "\n";
+    Uintah::Parallel::finalizeManager(Uintah::Parallel::Abort);
+    return 1;
+  }
+
+  suite.writeSummary(cerr);
+
+  if (outfile.empty()) {
+    suite.writeJSON(cout, opts, tag);
+  }
+  else {
+    ofstream out(outfile.c_str());
+    if (!out) {
+      cerr << "Unable to open " << outfile << " for writing\n";
+      Uintah::Parallel::finalizeManager(Uintah::Parallel::Abort);
+      return 1;
+    }
+    suite.writeJSON(out, opts, tag);
+  }
+
+  Uintah::Parallel::finalizeManager();
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef STANDALONE_BENCHMARKS_KERNELBENCHMARKS_H
+#define STANDALONE_BENCHMARKS_KERNELBENCHMARKS_H
+
+#include <Core/Grid/Grid.h>
+#include <Core/Util/Time.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Uintah {
+
+class Patch;
+
+namespace Benchmarks {
+
+/**************************************
+
+ CLASS
+   Benchmarks::Suite
+
+ GENERAL INFORMATION
+
+   KernelBenchmarks.h
+
+   Department of Computer Science
+   University of Utah
+
+   Center for the Simulation of Accidental Fires and Explosions (C-SAFE)
+
+
+ KEYWORDS
+   Benchmark, Performance Regression
+
+ DESCRIPTION
+   A small registry of kernel benchmarks.  Each benchmark times one of
+   the hot loops the components depend on (grid iteration, ghost copies,
+   data warehouse access, message packing, particle interpolation, EOS
+   solves, ray marching) on a single patch and reports its throughput.
+
+   Results are written as JSON so they can be collected per commit and
+   compared to catch performance regressions.
+
+ ****************************************/
+
+//______________________________________________________________________
+//
+struct Options {
+  int         size;         // cells per side of the benchmark patch
+  int         reps;         // timed repetitions of each kernel
+  int         ppc;          // particles per cell (per direction)
+  int         nRays;        // rays per cell for the RMCRT trace
+  std::string filter;       // only run benchmarks whose name contains this
+};
+
+//______________________________________________________________________
+//
+struct Result {
+  std::string name;         // "<group>/<kernel>"
+  std::string unit;         // what is counted, e.g. "cells", "particles"
+  double      items;        // items processed per repetition
+  double      bytes;        // bytes moved per repetition (0 if not meaningful)
+  double      minTime;      // seconds, fastest repetition
+  double      meanTime;     // seconds, average over all repetitions
+  double      checksum;     // keeps the compiler honest, also useful to spot wrong answers
+};
+
+typedef void (*BenchmarkFunction)( const Options& opts, std::vector<Result>& results );
+
+//______________________________________________________________________
+//
+class Suite {
+
+  public:
+
+    void add( const std::string& name, BenchmarkFunction function );
+
+    void list( std::ostream& out ) const;
+
+    void run( const Options& opts );
+
+    void writeJSON( std::ostream& out, const Options& opts, const std::string& tag ) const;
+
+    void writeSummary( std::ostream& out ) const;
+
+  private:
+
+    struct Entry {
+      std::string       name;
+      BenchmarkFunction function;
+    };
+
+    std::vector<Entry>  d_entries;
+    std::vector<Result> d_results;
+};
+
+//______________________________________________________________________
+// Times kernel() reps times, after one untimed warm up call.
+template<class Kernel>
+void timeKernel( int reps, Kernel kernel, double& minTime, double& meanTime )
+{
+  kernel();
+
+  minTime = 1.e99;
+  double total = 0;
+  for (int r = 0; r < reps; r++) {
+    double start = Time::currentSeconds();
+    kernel();
+    double elapsed = Time::currentSeconds() - start;
+    minTime = elapsed < minTime ? elapsed : minTime;
+    total += elapsed;
+  }
+  meanTime = total / reps;
+}
+
+// Fills in and appends a result.
+void addResult( std::vector<Result>& results,
+                const std::string&   name,
+                const std::string&   unit,
+                double               items,
+                double               bytes,
+                double               minTime,
+                double               meanTime,
+                double               checksum );
+
+// Creates a single level, single patch grid with size^3 cells of unit
+// (physical) size, surrounded by one layer of extra cells.
+const Patch* createPatch( Grid& grid, int size );
+
+// Registration of the benchmark groups (one per source file)
+void registerGridBenchmarks( Suite& suite );
+void registerDataBenchmarks( Suite& suite );
+void registerPhysicsBenchmarks( Suite& suite );
+
+} // End namespace Benchmarks
+
+} // End namespace Uintah
+
+#endif // End STANDALONE_BENCHMARKS_KERNELBENCHMARKS_H
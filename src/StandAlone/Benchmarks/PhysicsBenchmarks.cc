@@ -0,0 +1,306 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+//
+//  PhysicsBenchmarks.cc: the inner loops of the components - MPM particle
+//                        to grid (and back) interpolation, the ICE
+//                        equilibration pressure solve (ICE builds only)
+//                        and RMCRT ray marching.
+//
+
+#include <StandAlone/Benchmarks/KernelBenchmarks.h>
+
+#include <sci_defs/uintah_defs.h>
+
+#ifndef NO_ICE
+#  include <CCA/Components/ICE/ICE.h>
+#  include <CCA/Components/ICE/EOS/IdealGas.h>
+#endif
+#include <CCA/Components/Models/Radiation/RMCRT/RMCRTCommon.h>
+
+#include <Core/Grid/BSplineInterpolator.h>
+#include <Core/Grid/GIMPInterpolator.h>
+#include <Core/Grid/Level.h>
+#include <Core/Grid/LinearInterpolator.h>
+#include <Core/Grid/Patch.h>
+#include <Core/Grid/TOBSplineInterpolator.h>
+#include <Core/Grid/Variables/CCVariable.h>
+#include <Core/Grid/Variables/CellIterator.h>
+#include <Core/Grid/Variables/NCVariable.h>
+#include <Core/Grid/cpdiInterpolator.h>
+#include <Core/Grid/cptiInterpolator.h>
+#include <Core/Math/Matrix3.h>
+#include <Core/Math/MersenneTwister.h>
+
+#include <Core/Containers/StaticArray.h>
+
+#include <cfloat>
+#include <cmath>
+
+using namespace Uintah;
+using namespace Uintah::Benchmarks;
+
+namespace {
+
+//______________________________________________________________________
+//  Particle to grid (mass and momentum) and grid to particle (velocity)
+//  interpolation with each of the MPM interpolators.
+void mpmInterpolation( const Options& opts, std::vector<Result>& results )
+{
+  Grid grid;
+  const Patch* patch = createPatch(grid, opts.size);
+
+  // keep particles two cells away from the patch boundary so that every
+  // interpolator's stencil stays within the allocated nodes
+  const int ngn = 3;
+  IntVector nodeLow  = patch->getNodeLowIndex()  - IntVector(ngn, ngn, ngn);
+  IntVector nodeHigh = patch->getNodeHighIndex() + IntVector(ngn, ngn, ngn);
+
+  int ppc = opts.ppc;
+  std::vector<Point>  px;
+  std::vector<Vector> pvelocity;
+  for (CellIterator iter(IntVector(2, 2, 2), patch->getCellHighIndex() - IntVector(2, 2, 2)); !iter.done(); iter++) {
+    IntVector c = *iter;
+    for (int i = 0; i < ppc; i++) {
+      for (int j = 0; j < ppc; j++) {
+        for (int k = 0; k < ppc; k++) {
+          px.push_back(Point(c.x() + (i + 0.5) / ppc, c.y() + (j + 0.5) / ppc, c.z() + (k + 0.5) / ppc));
+          pvelocity.push_back(Vector(1, 0.5, 0.25));
+        }
+      }
+    }
+  }
+
+  const double pmass = 1.0 / (ppc * ppc * ppc);
+  const Matrix3 psize(1.0 / ppc, 0, 0, 0, 1.0 / ppc, 0, 0, 0, 1.0 / ppc);
+  const Matrix3 defgrad(1, 0, 0, 0, 1, 0, 0, 0, 1);
+
+  NCVariable<double> gmass;
+  NCVariable<Vector> gvelocity;
+  gmass.allocate(nodeLow, nodeHigh);
+  gvelocity.allocate(nodeLow, nodeHigh);
+
+  std::vector<std::pair<std::string, ParticleInterpolator*> > interpolators;
+  interpolators.push_back(std::make_pair("linear",     (ParticleInterpolator*)scinew LinearInterpolator(patch)));
+  interpolators.push_back(std::make_pair("gimp",       (ParticleInterpolator*)scinew GIMPInterpolator(patch)));
+  interpolators.push_back(std::make_pair("3rdorderBS", (ParticleInterpolator*)scinew TOBSplineInterpolator(patch)));
+  interpolators.push_back(std::make_pair("4thorderBS", (ParticleInterpolator*)scinew BSplineInterpolator(patch)));
+  interpolators.push_back(std::make_pair("cpdi",       (ParticleInterpolator*)scinew cpdiInterpolator(patch)));
+  interpolators.push_back(std::make_pair("cpti",       (ParticleInterpolator*)scinew cptiInterpolator(patch)));
+
+  const double nparticles = px.size();
+
+  for (unsigned n = 0; n < interpolators.size(); n++) {
+    ParticleInterpolator* interp = interpolators[n].second;
+    interp->setLcrit(1.e10);
+
+    std::vector<IntVector> ni(interp->size());
+    std::vector<double>    S(interp->size());
+    double minTime, meanTime;
+
+    timeKernel(opts.reps, [&]() {
+      gmass.initialize(0);
+      gvelocity.initialize(Vector(0, 0, 0));
+      for (size_t p = 0; p < px.size(); p++) {
+        interp->findCellAndWeights(px[p], ni, S, psize, defgrad);
+        Vector pmom = pvelocity[p] * pmass;
+        for (unsigned k = 0; k < ni.size(); k++) {
+          gmass[ni[k]]     += pmass * S[k];
+          gvelocity[ni[k]] += pmom  * S[k];
+        }
+      }
+    }, minTime, meanTime);
+    addResult(results, "mpm/p2g_" + interpolators[n].first, "particles", nparticles, 0, minTime, meanTime,
+              gmass[IntVector(opts.size / 2, opts.size / 2, opts.size / 2)]);
+
+    double sum = 0;
+    timeKernel(opts.reps, [&]() {
+      sum = 0;
+      for (size_t p = 0; p < px.size(); p++) {
+        interp->findCellAndWeights(px[p], ni, S, psize, defgrad);
+        Vector vel(0, 0, 0);
+        for (unsigned k = 0; k < ni.size(); k++) {
+          vel += gvelocity[ni[k]] * S[k];
+        }
+        pvelocity[p] = vel;
+        sum += vel.x();
+      }
+    }, minTime, meanTime);
+    addResult(results, "mpm/g2p_" + interpolators[n].first, "particles", nparticles, 0, minTime, meanTime, sum);
+
+    delete interp;
+  }
+}
+
+#ifndef NO_ICE
+//______________________________________________________________________
+//  ICE::solveEquilibrationPressure, the per cell Newton iteration of
+//  ICE::computeEquilibrationPressure, for two ideal gases that start out
+//  of pressure equilibrium.
+void iceEquilibration( const Options& opts, std::vector<Result>& results )
+{
+  const int    numMatls         = 2;
+  const int    maxIter          = 100;
+  const double convergence_crit = 15 * DBL_EPSILON;
+  const double d_SMALL_NUM      = 1e-100;
+
+  ProblemSpecP ps = 0;
+  IdealGas idealGas(ps);
+  StaticArray<EquationOfState*> eos(numMatls);
+
+  IntVector low(0, 0, 0);
+  IntVector high(opts.size, opts.size, opts.size);
+
+  CCVariable<double> press;
+  StaticArray<CCVariable<double> >      rho_micro(numMatls), vol_frac(numMatls), speedSound(numMatls);
+  StaticArray<CCVariable<double> >      rho_CC_var(numMatls), Temp_var(numMatls), gamma_var(numMatls), cv_var(numMatls);
+  StaticArray<constCCVariable<double> > rho_CC(numMatls), Temp(numMatls), gamma(numMatls), cv(numMatls);
+  press.allocate(low, high);
+  for (int m = 0; m < numMatls; m++) {
+    eos[m] = &idealGas;
+    rho_micro[m].allocate(low, high);
+    vol_frac[m].allocate(low, high);
+    speedSound[m].allocate(low, high);
+    rho_CC_var[m].allocate(low, high);
+    Temp_var[m].allocate(low, high);
+    gamma_var[m].allocate(low, high);
+    cv_var[m].allocate(low, high);
+    gamma_var[m].initialize(1.4);
+    cv_var[m].initialize(716.0);
+    // views of the same data, as the task gets them from the data warehouse
+    rho_CC[m] = rho_CC_var[m];
+    Temp[m]   = Temp_var[m];
+    gamma[m]  = gamma_var[m];
+    cv[m]     = cv_var[m];
+  }
+
+  double ncells = (double)opts.size * opts.size * opts.size;
+  double minTime, meanTime;
+  double iterations = 0;
+
+  timeKernel(opts.reps, [&]() {
+    // reset to the same (unequilibrated) state every repetition
+    for (CellIterator iter(low, high); !iter.done(); iter++) {
+      IntVector c = *iter;
+      double x = (double)c.x() / opts.size;
+      press[c]       = 101325.0;
+      Temp_var[0][c] = 300.0;
+      Temp_var[1][c] = 1000.0 + 500.0 * x;
+      vol_frac[0][c] = 0.3 + 0.4 * x;
+      vol_frac[1][c] = 1.0 - vol_frac[0][c];
+      for (int m = 0; m < numMatls; m++) {
+        rho_micro[m][c]  = idealGas.computeRhoMicro(press[c], gamma[m][c], cv[m][c], Temp[m][c], 1.0) * (m == 0 ? 1.2 : 0.9);
+        rho_CC_var[m][c] = rho_micro[m][c] * vol_frac[m][c];
+      }
+    }
+
+    iterations = 0;
+    for (CellIterator iter(low, high); !iter.done(); iter++) {
+      double sum;
+      iterations += ICE::solveEquilibrationPressure(*iter, eos, gamma, cv, Temp, rho_CC,
+                                                    rho_micro, vol_frac, speedSound, press,
+                                                    maxIter, convergence_crit, d_SMALL_NUM, sum);
+    }
+  }, minTime, meanTime);
+  addResult(results, "ice/equilibration_pressure", "cells", ncells, 0, minTime, meanTime, iterations / ncells);
+}
+#endif
+
+//______________________________________________________________________
+//  Trace rays from every cell of a gray, non-scattering medium enclosed
+//  by hot black walls (the inner loop of Ray::rayTrace).
+void rmcrtTrace( const Options& opts, std::vector<Result>& results )
+{
+  Grid grid;
+  const Patch* patch = createPatch(grid, opts.size);
+  const Level* level = patch->getLevel();
+
+  RMCRTCommon rmcrt(TypeDescription::double_type);
+  RMCRTCommon::d_threshold    = 0.01;
+  RMCRTCommon::d_sigma        = 5.670367e-8;
+  RMCRTCommon::d_sigmaScat    = 0;
+  RMCRTCommon::d_isSeedRandom = false;
+  RMCRTCommon::d_allowReflect = false;
+  rmcrt.d_sigma_over_pi = RMCRTCommon::d_sigma / M_PI;
+
+  const int wall = 8;
+
+  CCVariable<double> sigmaT4OverPi_var, abskg_var, divQ;
+  CCVariable<int>    celltype_var;
+  sigmaT4OverPi_var.allocate(patch->getExtraCellLowIndex(), patch->getExtraCellHighIndex());
+  abskg_var.allocate(patch->getExtraCellLowIndex(), patch->getExtraCellHighIndex());
+  celltype_var.allocate(patch->getExtraCellLowIndex(), patch->getExtraCellHighIndex());
+  divQ.allocate(patch->getCellLowIndex(), patch->getCellHighIndex());
+
+  for (CellIterator iter = patch->getExtraCellIterator(); !iter.done(); iter++) {
+    IntVector c = *iter;
+    bool interior = patch->containsCell(c);
+    double T = interior ? 1000.0 : 1500.0;
+    sigmaT4OverPi_var[c] = rmcrt.d_sigma_over_pi * T * T * T * T;
+    abskg_var[c]         = interior ? 0.5 : 1.0;
+    celltype_var[c]      = interior ? rmcrt.d_flowCell : wall;
+  }
+
+  constCCVariable<double> sigmaT4OverPi = sigmaT4OverPi_var;
+  constCCVariable<double> abskg         = abskg_var;
+  constCCVariable<int>    celltype      = celltype_var;
+
+  Vector Dx = patch->dCell();
+  MTRand mTwister;
+
+  double nrays = (double)opts.size * opts.size * opts.size * opts.nRays;
+  unsigned long nRaySteps = 0;
+  double minTime, meanTime;
+
+  timeKernel(opts.reps, [&]() {
+    nRaySteps = 0;
+    for (CellIterator iter = patch->getCellIterator(); !iter.done(); iter++) {
+      IntVector origin = *iter;
+      double sumI = 0;
+      for (int iRay = 0; iRay < opts.nRays; iRay++) {
+        Vector direction = rmcrt.findRayDirection(mTwister, origin, iRay);
+        Vector rayOrigin;
+        rmcrt.ray_Origin(mTwister, level->getCellPosition(origin), Dx, false, rayOrigin);
+        rmcrt.updateSumI<double>(level, direction, rayOrigin, origin, Dx, sigmaT4OverPi, abskg, celltype,
+                                 nRaySteps, sumI, mTwister);
+      }
+      divQ[origin] = -4.0 * M_PI * abskg[origin] * (sigmaT4OverPi[origin] - (sumI / opts.nRays));
+    }
+  }, minTime, meanTime);
+  addResult(results, "rmcrt/trace", "rays", nrays, 0, minTime, meanTime, (double)nRaySteps / nrays);
+}
+
+} // End anonymous namespace
+
+//______________________________________________________________________
+//
+void
+Uintah::Benchmarks::registerPhysicsBenchmarks( Suite& suite )
+{
+  suite.add("mpm/interpolation",          mpmInterpolation);
+#ifndef NO_ICE
+  suite.add("ice/equilibration_pressure", iceEquilibration);
+#endif
+  suite.add("rmcrt/trace",                rmcrtTrace);
+}
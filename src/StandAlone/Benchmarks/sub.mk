@@ -68,3 +68,40 @@ endif
 include $(SCIRUN_SCRIPTS)/program.mk
 
 SimpleMath: prereqs StandAlone/Benchmarks/SimpleMath
+
+##############################################
+# Kernel Benchmarks (JSON throughput results)
+
+SRCS    := $(SRCDIR)/KernelBenchmarks.cc  \
+           $(SRCDIR)/GridBenchmarks.cc    \
+           $(SRCDIR)/DataBenchmarks.cc    \
+           $(SRCDIR)/PhysicsBenchmarks.cc
+
+PROGRAM := $(SRCDIR)/KernelBenchmarks
+
+ifeq ($(IS_STATIC_BUILD),yes)
+  PSELIBS := $(ALL_STATIC_PSE_LIBS)
+else # Non-static build
+  ifeq ($(LARGESOS),yes)
+    PSELIBS := Datflow Packages/Uintah
+  else
+    PSELIBS := $(ALL_PSE_LIBS)
+  endif
+endif
+
+PSELIBS := $(GPU_EXTRA_LINK) $(PSELIBS)
+
+ifeq ($(IS_STATIC_BUILD),yes)
+  LIBS := $(CORE_STATIC_LIBS) $(ZOLTAN_LIBRARY)    \
+          $(BOOST_LIBRARY)         \
+          $(EXPRLIB_LIBRARY) $(SPATIALOPS_LIBRARY) \
+          $(TABPROPS_LIBRARY) $(RADPROPS_LIBRARY)  \
+          $(PAPI_LIBRARY) $(M_LIBRARY)
+else
+  LIBS := $(XML2_LIBRARY) $(MPI_LIBRARY) $(F_LIBRARY) \
+          $(BLAS_LIBRARY) $(THREAD_LIBRARY) $(CUDA_LIBRARY)
+endif
+
+include $(SCIRUN_SCRIPTS)/program.mk
+
+KernelBenchmarks: prereqs StandAlone/Benchmarks/KernelBenchmarks
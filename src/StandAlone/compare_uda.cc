@@ -48,6 +48,7 @@
 #include <Core/Grid/Variables/SFCZVariable.h>
 #include <Core/Grid/Variables/Stencil7.h>
 #include <Core/Parallel/Parallel.h>
+#include <Core/Parallel/ProcessorGroup.h>
 #include <Core/Math/Matrix3.h>
 #include <Core/Math/MinMax.h>
 #include <Core/OS/Dir.h>
@@ -56,9 +57,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <fstream>
 #include <iomanip>
 #include <iterator>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -105,9 +108,12 @@ usage(const std::string& badarg, const std::string& progname)
   cerr << "  -concise                 (With '-as_warnings', only print first incidence of error per var.)\n";
   cerr << "  -skip_unknown_types      (Skip variable comparisons of unknown types without error)\n";
   cerr << "  -ignoreVariable [string] (Skip this variable)\n";
-  cerr << "  -dont_sort               (Don't sort the variable names before comparing them)";
+  cerr << "  -dont_sort               (Don't sort the variable names before comparing them)\n";
+  cerr << "  -tolerance_file [file]   (Per label tolerances, one '<label> <abs_tolerance> <rel_tolerance>' per line)";
   cerr << "\nNote: The absolute and relative tolerance tests must both fail\n"
-       << "      for a comparison to fail.\n\n";
+       << "      for a comparison to fail.\n"
+       << "      Without -as_warnings the comparison stops at the first failure.\n"
+       << "      Run under mpirun to divide the patches among the ranks.\n\n";
   Parallel::exitAll(1);
 }
 
@@ -120,6 +126,31 @@ bool d_tolerance_error       = false;
 bool d_concise               = false; // If true (and d_tolerance_error), only print 1st error per var.
 bool d_strict_types          = true;
 
+//__________________________________
+//  Tolerances read from the -tolerance_file, and the largest
+//  differences found for each label.
+struct LabelTolerance
+{
+  double abs_tolerance;
+  double rel_tolerance;
+};
+
+struct LabelErrors
+{
+  LabelErrors()
+    : maxAbsError(0), maxRelError(0), abs_tolerance(-1), rel_tolerance(-1), nFailures(0) {}
+
+  double maxAbsError;
+  double maxRelError;
+  double abs_tolerance;   // -1 until the label has been compared
+  double rel_tolerance;
+  double nFailures;
+};
+
+map<string, LabelTolerance> d_labelTolerances;
+map<string, LabelErrors>    d_labelErrors;
+LabelErrors               * d_currentErrors = nullptr;   // label being compared, if any
+
 void
 abort_uncomparable()
 {
@@ -127,15 +158,155 @@ abort_uncomparable()
   Parallel::exitAll(5);
 }
 
+//__________________________________
+// Lines are "<label> <abs_tolerance> <rel_tolerance>"; '#' starts a comment.
+void
+readToleranceFile( const string & filename )
+{
+  ifstream in( filename.c_str() );
+  if( !in ) {
+    cerr << "\nCould not open the tolerance file '" << filename << "'.\n";
+    Parallel::exitAll(1);
+  }
+
+  string line;
+  int    lineNum = 0;
+  while( getline( in, line ) ) {
+    lineNum++;
+    line = line.substr( 0, line.find( '#' ) );
+
+    istringstream  words( line );
+    string         label;
+    LabelTolerance tol;
+    if( !( words >> label ) ) {
+      continue;
+    }
+    if( !( words >> tol.abs_tolerance >> tol.rel_tolerance ) || tol.rel_tolerance < 0 ) {
+      cerr << "\n" << filename << ":" << lineNum << ": expected '<label> <abs_tolerance> <rel_tolerance>'\n";
+      Parallel::exitAll(1);
+    }
+    d_labelTolerances[label] = tol;
+  }
+}
+
+//__________________________________
+// Start recording the differences of var; abs_tolerance and rel_tolerance
+// are replaced by its -tolerance_file entry, if there is one.
+void
+beginLabel( const string & var, double & abs_tolerance, double & rel_tolerance )
+{
+  map<string, LabelTolerance>::const_iterator iter = d_labelTolerances.find( var );
+  if( iter != d_labelTolerances.end() ) {
+    abs_tolerance = iter->second.abs_tolerance;
+    rel_tolerance = iter->second.rel_tolerance;
+  }
+
+  d_currentErrors = &d_labelErrors[var];
+  d_currentErrors->abs_tolerance = abs_tolerance;
+  d_currentErrors->rel_tolerance = rel_tolerance;
+}
+
+void
+endLabel()
+{
+  d_currentErrors = nullptr;
+}
+
+void
+recordDifference( double diff, double max_abs )
+{
+  if( d_currentErrors != nullptr && !std::isnan( diff ) ) {
+    d_currentErrors->maxAbsError = std::max( d_currentErrors->maxAbsError, diff );
+    if( max_abs > 0 ) {
+      d_currentErrors->maxRelError = std::max( d_currentErrors->maxRelError, diff / max_abs );
+    }
+  }
+}
+
+//__________________________________
+// Combine the differences found by all ranks onto rank 0.  Every rank
+// must call this with the same list of variables.
+void
+reduceErrorSummary( const vector<string> & vars )
+{
+  if( !Parallel::usingMPI() ) {
+    return;
+  }
+
+  const int n = vars.size();
+  vector<double> maxes( 4 * n ), maxes_all( 4 * n );
+  vector<double> sums( n ), sums_all( n );
+
+  for( int v = 0; v < n; v++ ) {
+    const LabelErrors & errors = d_labelErrors[vars[v]];
+    maxes[4*v]     = errors.maxAbsError;
+    maxes[4*v + 1] = errors.maxRelError;
+    maxes[4*v + 2] = errors.abs_tolerance;
+    maxes[4*v + 3] = errors.rel_tolerance;
+    sums[v]        = errors.nFailures;
+  }
+
+  MPI_Comm comm = Parallel::getRootProcessorGroup()->getComm();
+  MPI_Reduce( &maxes[0], &maxes_all[0], 4 * n, MPI_DOUBLE, MPI_MAX, 0, comm );
+  MPI_Reduce( &sums[0],  &sums_all[0],  n,     MPI_DOUBLE, MPI_SUM, 0, comm );
+
+  for( int v = 0; v < n; v++ ) {
+    LabelErrors & errors = d_labelErrors[vars[v]];
+    errors.maxAbsError   = maxes_all[4*v];
+    errors.maxRelError   = maxes_all[4*v + 1];
+    errors.abs_tolerance = maxes_all[4*v + 2];
+    errors.rel_tolerance = maxes_all[4*v + 3];
+    errors.nFailures     = sums_all[v];
+  }
+}
+
+void
+printErrorSummary()
+{
+  ios::fmtflags flags = cerr.flags();
+  streamsize    prec  = cerr.precision();
+
+  cerr << "\nLargest differences per label:\n";
+  cerr << left << setw(32) << "  label" << right
+       << setw(11) << "abs_tol" << setw(11) << "rel_tol"
+       << setw(15) << "max abs diff" << setw(15) << "max rel diff"
+       << setw(10) << "failures" << "\n";
+
+  cerr << scientific << setprecision(3);
+  map<string, LabelErrors>::const_iterator iter;
+  for( iter = d_labelErrors.begin(); iter != d_labelErrors.end(); iter++ ) {
+    const LabelErrors & errors = iter->second;
+    cerr << "  " << left << setw(30) << iter->first << right;
+    if( errors.abs_tolerance < 0 ) {
+      cerr << setw(11) << "-" << setw(11) << "-";
+    }
+    else {
+      cerr << setw(11) << errors.abs_tolerance << setw(11) << errors.rel_tolerance;
+    }
+    cerr << setw(15) << errors.maxAbsError << setw(15) << errors.maxRelError
+         << setw(10) << (long)errors.nFailures << "\n";
+  }
+
+  cerr.flags( flags );
+  cerr.precision( prec );
+}
+
 void
 tolerance_failure()
 {
+  if( d_currentErrors != nullptr ) {
+    d_currentErrors->nFailures++;
+  }
+
   if (d_tolerance_as_warnings) {
     d_tolerance_error = true;
     cerr << endl;
   }
-  else
+  else {
+    // early exit: report what this rank has compared so far
+    printErrorSummary();
     Parallel::exitAll(2);
+  }
 }
 
 void
@@ -180,6 +351,8 @@ compare( double a, double b, double abs_tolerance, double rel_tolerance )
   if (fabs(b) > max_abs){
     max_abs = fabs(b);
   }
+  recordDifference(fabs(a - b), max_abs);
+
   if (fabs(a - b) > abs_tolerance) {
     if (max_abs > 0 && (fabs(a-b) / max_abs) > rel_tolerance){
       return false;
@@ -211,6 +384,7 @@ compare( long64 a,
     return false;
   }
 
+  recordDifference(fabs((double)a - (double)b), max(fabs((double)a), fabs((double)b)));
   return (a == b); // longs should use an exact comparison
 }
 
@@ -223,6 +397,7 @@ compare( int a, int b,
     return false;
   }
 
+  recordDifference(fabs((double)a - (double)b), max(fabs((double)a), fabs((double)b)));
   return (a == b); // int should use an exact comparison
 }
 
@@ -449,12 +624,17 @@ void MaterialParticleData::compare(MaterialParticleData& data2,
   sort();
   data2.sort();
 
+  double abs_tol = abs_tolerance;
+  double rel_tol = rel_tolerance;
+  beginLabel("p.particleID", abs_tol, rel_tol);
+
   if (!particleIDs_->compare(*data2.particleIDs_, matl_,
                              time1, time2,
-                             abs_tolerance, rel_tolerance)){
+                             abs_tol, rel_tol)){
     cerr << "ParticleIDs do not match\n";
     abort_uncomparable();
   }
+  endLabel();
 
   map<string, MaterialParticleVarData>::iterator varIter  = vars_.begin();
   map<string, MaterialParticleVarData>::iterator varIter2 = data2.vars_.begin();
@@ -468,9 +648,14 @@ void MaterialParticleData::compare(MaterialParticleData& data2,
     if ((*varIter).first == "p.particleID")
       continue; // already compared
 
+    abs_tol = abs_tolerance;
+    rel_tol = rel_tolerance;
+    beginLabel((*varIter).first, abs_tol, rel_tol);
+
     (*varIter).second.compare((*varIter2).second, matl_,
                                time1, time2,
-                               abs_tolerance, rel_tolerance);
+                               abs_tol, rel_tol);
+    endLabel();
   }
   // should catch this earlier -- vars/materials do not match
   ASSERT((varIter == vars_.end()) && (varIter2 == data2.vars_.end()));
@@ -1245,6 +1430,10 @@ main(int argc, char** argv)
   int  udaLevels[2];                // user can override and specify the levels to compare.  Useful for 1L vs N level comparison
   udaLevels[0]          =-9;
   udaLevels[1]          =-9;
+  string toleranceFile  = "";
+
+  const int rank   = Parallel::getMPIRank();
+  const int nRanks = Parallel::getMPISize();
 
   // Parse Args:
   for( int i = 1; i < argc; i++ ) {
@@ -1290,6 +1479,13 @@ main(int argc, char** argv)
         ignoreVar = argv[i];
       }
     }
+    else if(s == "-tolerance_file") {
+      if (++i == argc){
+        usage("-tolerance_file, no file given", argv[0]);
+      }else{
+        toleranceFile = argv[i];
+      }
+    }
     else if(s[0] == '-' && s[1] == 'h' ) { // lazy check for -h[elp] option
       usage( "", argv[0] );
     }
@@ -1338,6 +1534,14 @@ main(int argc, char** argv)
     Parallel::exitAll(1);
   }
 
+  if( toleranceFile != "" ) {
+    readToleranceFile( toleranceFile );
+    cerr << "Using the tolerances of " << d_labelTolerances.size() << " label(s) from " << toleranceFile << endl;
+  }
+  if( nRanks > 1 ) {
+    cerr << "Dividing the patches among " << nRanks << " ranks\n";
+  }
+
   // default to 16 digits of precision when using exact comparison (i.e. rel_tolerance = 0)
   int digits_precision = (rel_tolerance > 0 ) ? (int)ceil(-log10(rel_tolerance)) + 1 : 16;
   cerr << setprecision(digits_precision);
@@ -1439,6 +1643,13 @@ main(int argc, char** argv)
       }
     }
 
+    map<string, LabelTolerance>::const_iterator tolIter;
+    for( tolIter = d_labelTolerances.begin(); tolIter != d_labelTolerances.end(); tolIter++ ) {
+      if( rank == 0 && find( vars.begin(), vars.end(), tolIter->first ) == vars.end() ) {
+        cerr << "WARNING: " << tolIter->first << " in the tolerance file is not compared\n";
+      }
+    }
+
     vector<int>     index;
     vector<double>  times;
     vector<int>     index2;
@@ -1459,7 +1670,9 @@ main(int argc, char** argv)
 
       double time1 = times[tstep];
       double time2 = times2[tstep];
-      cerr << "time = " << time1 << "\n";
+      if( rank == 0 ) {
+        cerr << "time = " << time1 << "\n";
+      }
 
       GridP grid  = da1->queryGrid(tstep);
       GridP grid2 = da2->queryGrid(tstep);
@@ -1597,7 +1810,9 @@ main(int argc, char** argv)
           const Uintah::TypeDescription* td = types[v];
           const Uintah::TypeDescription* subtype = td->getSubType();
 
-          cerr << "\tVariable: " << var << ", type " << td->getName() << "\n";
+          if( rank == 0 ) {
+            cerr << "\tVariable: " << var << ", type " << td->getName() << "\n";
+          }
 
           if (td->getName() == string("-- unknown type --")) {
             cerr << "\t\tParticleVariable of unknown type";
@@ -1623,9 +1838,19 @@ main(int argc, char** argv)
             }
 
 
+            double abs_tol = abs_tolerance;
+            double rel_tol = rel_tolerance;
+            beginLabel(var, abs_tol, rel_tol);
+
             Level::const_patchIterator iter2 = level2->patchesBegin();
+            int p = 0;
             for(Level::const_patchIterator iter = level->patchesBegin();
-                iter != level->patchesEnd(); iter++, iter2++){
+                iter != level->patchesEnd(); iter++, iter2++, p++){
+
+              // the patches are dealt out to the ranks
+              if (p % nRanks != rank) {
+                continue;
+              }
 
               const Patch* patch  = *iter;
               const Patch* patch2 = *iter2;
@@ -1670,27 +1895,27 @@ main(int argc, char** argv)
                   switch(subtype->getType()){
                   case Uintah::TypeDescription::double_type:
                     compareParticles<double>(da1, da2, var, matl, patch, patch2,
-                                             time1, tstep, abs_tolerance, rel_tolerance);
+                                             time1, tstep, abs_tol, rel_tol);
                     break;
                   case Uintah::TypeDescription::float_type:
                     compareParticles<float>(da1, da2, var, matl, patch, patch2,
-                                            time1, tstep, abs_tolerance, rel_tolerance);
+                                            time1, tstep, abs_tol, rel_tol);
                     break;
                   case Uintah::TypeDescription::int_type:
                     compareParticles<int>(da1, da2, var, matl, patch, patch2,
-                                          time1, tstep, abs_tolerance, rel_tolerance);
+                                          time1, tstep, abs_tol, rel_tol);
                     break;
                   case Uintah::TypeDescription::Point:
                     compareParticles<Point>(da1, da2, var, matl, patch, patch2,
-                                            time1, tstep, abs_tolerance, rel_tolerance);
+                                            time1, tstep, abs_tol, rel_tol);
                     break;
                   case Uintah::TypeDescription::Vector:
                     compareParticles<Vector>(da1, da2, var, matl, patch, patch2,
-                                             time1, tstep, abs_tolerance, rel_tolerance);
+                                             time1, tstep, abs_tol, rel_tol);
                     break;
                   case Uintah::TypeDescription::Matrix3:
                     compareParticles<Matrix3>(da1, da2, var, matl, patch, patch2,
-                                              time1, tstep, abs_tolerance, rel_tolerance);
+                                              time1, tstep, abs_tol, rel_tol);
                     break;
                   default:
                     cerr << "main: ParticleVariable of unsupported type: " << subtype->getName() << '\n';
@@ -1699,15 +1924,21 @@ main(int argc, char** argv)
                 }
               }
             }
+            endLabel();
           }
         }
       }
       else if (hasParticleIDs) {
         // Compare Particle variables with p.particleID -- patches don't
         // need to be cosistent.  It will gather and sort the particles
-        // so they can be compared in particleID order.
+        // so they can be compared in particleID order.  The particles of
+        // a level are gathered on one rank, so the levels are dealt out.
         for( int l1 = minLevel[0], l2 = minLevel[1]; (l1 < maxLevels[0] &&  l2 < maxLevels[1]); l1++, l2++) {
 
+          if ((l1 - minLevel[0]) % nRanks != rank) {
+            continue;
+          }
+
           LevelP level  = grid->getLevel(l1);
           LevelP level2 = grid2->getLevel(l2);
 
@@ -1749,7 +1980,9 @@ main(int argc, char** argv)
 
         if (td->getType() == Uintah::TypeDescription::ParticleVariable)
           continue;
-        cerr << "\tVariable: " << var << ", type " << td->getName() << "\n";
+        if( rank == 0 ) {
+          cerr << "\tVariable: " << var << ", type " << td->getName() << "\n";
+        }
 
         if (td->getName() == string("-- unknown type --")) {
           cerr << "\t\tParticleVariable of unknown type";
@@ -1763,6 +1996,10 @@ main(int argc, char** argv)
 
         Patch::VariableBasis basis=Patch::translateTypeToBasis(td->getType(),false);
 
+        double abs_tol = abs_tolerance;
+        double rel_tol = rel_tolerance;
+        beginLabel(var, abs_tol, rel_tol);
+
         for( int l1 = minLevel[0], l2 = minLevel[1]; (l1 < maxLevels[0] &&  l2 < maxLevels[1]); l1++, l2++) {
 
           LevelP level  = grid->getLevel(l1);
@@ -1814,9 +2051,15 @@ main(int argc, char** argv)
             }
           });
 
+          // the patches are dealt out to the ranks; each rank reads and
+          // compares one patch (and the patches of uda 2 under it) at a time
           Level::const_patchIterator iter;
+          int p = 0;
 
-          for(iter = level->patchesBegin();iter != level->patchesEnd(); iter++) {
+          for(iter = level->patchesBegin();iter != level->patchesEnd(); iter++, p++) {
+            if (p % nRanks != rank) {
+              continue;
+            }
             const Patch* patch = *iter;
 
             ConsecutiveRangeSet matls = da1->queryMaterials(var, patch, tstep);
@@ -1826,11 +2069,12 @@ main(int argc, char** argv)
             if (comparator != 0) {
               comparator->compareFields( da1, da2, var, matls, patch,
                                          patch2Map, time1, tstep,
-                                         abs_tolerance, rel_tolerance );
+                                         abs_tol, rel_tol );
               delete comparator;
             }
           }
         } // end for (l)
+        endLabel();
       } // end for (v)
     } // end for(tstep)
     //__________________________________
@@ -1842,6 +2086,19 @@ main(int argc, char** argv)
       abort_uncomparable();
     }
 
+    //__________________________________
+    //  summary of the differences, and did any rank fail?
+    reduceErrorSummary( vars );
+    if( rank == 0 ) {
+      printErrorSummary();
+    }
+
+    if( Parallel::usingMPI() ) {
+      int failed = d_tolerance_error;
+      MPI_Allreduce( MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, Parallel::getRootProcessorGroup()->getComm() );
+      d_tolerance_error = failed;
+    }
+
     delete da1;
     delete da2;
   } catch (Exception& e) {
@@ -1853,11 +2110,15 @@ main(int argc, char** argv)
   }
 
   if (d_tolerance_error) {
-    cerr << "\nComparison did NOT fully pass.\n";
+    if( rank == 0 ) {
+      cerr << "\nComparison did NOT fully pass.\n";
+    }
     Parallel::exitAll(2);
   }
-  else
+  else if( rank == 0 ) {
     cerr << "\nComparison fully passed!\n";
+  }
 
+  Parallel::finalizeManager();
   return 0;
 }
@@ -0,0 +1,446 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/*
+ *  lbreplay.cc: Replays the patch costs recorded by the DynamicLoadBalancer
+ *               (<LoadBalancer><costTrace>) through a load balancer, and
+ *               reports the load imbalance, migration and communication
+ *               the load balancer would have produced.
+ *
+ *  Usage: mpirun -np <ranks> lbreplay [options] <input.ups> <cost trace>
+ *
+ *  The <LoadBalancer> section of the input file selects and configures the
+ *  load balancer, so different settings can be compared on a workstation
+ *  without rerunning the simulation.  The load balancers are collective,
+ *  so the rank count being evaluated is the number of MPI ranks.
+ */
+
+#include <CCA/Components/LoadBalancers/CostForecasterBase.h>
+#include <CCA/Components/LoadBalancers/CostTrace.h>
+#include <CCA/Components/LoadBalancers/DynamicLoadBalancer.h>
+#include <CCA/Components/LoadBalancers/LoadBalancerCommon.h>
+#include <CCA/Components/LoadBalancers/LoadBalancerFactory.h>
+#include <CCA/Components/ProblemSpecification/ProblemSpecReader.h>
+#include <CCA/Ports/LoadBalancer.h>
+
+#include <Core/Exceptions/Exception.h>
+#include <Core/Grid/Grid.h>
+#include <Core/Grid/Level.h>
+#include <Core/Grid/Patch.h>
+#include <Core/Grid/SimulationState.h>
+#include <Core/Malloc/Allocator.h>
+#include <Core/Parallel/Parallel.h>
+#include <Core/Parallel/ProcessorGroup.h>
+#include <Core/ProblemSpec/ProblemSpec.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace Uintah;
+using namespace std;
+
+//______________________________________________________________________
+//  Hands the recorded costs of the current step to the DLB, in place of
+//  its profiler or cost model.
+class TraceForecaster : public CostForecasterBase {
+public:
+  TraceForecaster( const vector< vector<double> > & costs ) : d_costs(costs) {}
+
+  virtual void getWeights( const Grid* grid, vector< vector<int> > num_particles, vector< vector<double> > & costs )
+  {
+    costs = d_costs;
+  }
+
+private:
+  const vector< vector<double> > & d_costs;
+};
+
+//______________________________________________________________________
+//
+struct Metrics {
+  double imbalance;       // max processor cost / mean processor cost
+  double maxCost;
+  double meanCost;
+  double migratedCells;   // cells that changed processor since the last step
+  int    edges;           // pairs of neighboring patches on different processors
+  double ghostCells;      // ghost cells those pairs exchange
+};
+
+//______________________________________________________________________
+//
+void
+usage( const string & badarg, const string & progname )
+{
+  if( badarg != "" ) {
+    cerr << "Error parsing argument: " << badarg << "\n";
+  }
+  cerr << "Usage: mpirun -np <ranks> " << progname << " [options] <input.ups> <cost trace>\n\n"
+       << "  Replays the patch costs recorded with <LoadBalancer><costTrace> through the\n"
+       << "  load balancer given in <input.ups>, on the number of MPI ranks it is run with.\n\n"
+       << "Options:\n"
+       << "  -interval <n>   let the load balancer reconsider the assignment every <n> steps (default 1)\n"
+       << "  -ghost <n>      ghost cell layers counted for the communication volume (default 1)\n"
+       << "  -o <file>       write the per-step metrics to <file> (default: stdout)\n";
+  exit(1);
+}
+
+//______________________________________________________________________
+//  Builds the grid the costs of a step were recorded on.
+GridP
+buildGrid( const CostTrace::Step & step )
+{
+  GridP grid = scinew Grid();
+
+  // the patches are added through the levels addLevel() returns
+  vector<Level*> levels;
+  for( unsigned l = 0; l < step.levels.size(); l++ ) {
+    const CostTrace::LevelRecord& record = step.levels[l];
+    Level* level = grid->addLevel( record.anchor, record.dcell );
+    level->setExtraCells( record.extraCells );
+    levels.push_back( level );
+  }
+
+  for( unsigned p = 0; p < step.patches.size(); p++ ) {
+    const CostTrace::PatchRecord& record = step.patches[p];
+    levels[record.level]->addPatch( record.extraLow, record.extraHigh, record.low, record.high, grid.get_rep() );
+  }
+
+  for( unsigned l = 0; l < levels.size(); l++ ) {
+    const IntVector& periodic = step.levels[l].periodic;
+    if( periodic != IntVector(0, 0, 0) ) {
+      levels[l]->finalizeLevel( periodic.x() != 0, periodic.y() != 0, periodic.z() != 0 );
+    }
+    else {
+      levels[l]->finalizeLevel();
+    }
+  }
+  return grid;
+}
+
+//______________________________________________________________________
+//
+bool
+sameLayout( const CostTrace::Step & a, const CostTrace::Step & b )
+{
+  if( a.levels.size() != b.levels.size() || a.patches.size() != b.patches.size() ) {
+    return false;
+  }
+  for( unsigned p = 0; p < a.patches.size(); p++ ) {
+    const CostTrace::PatchRecord& pa = a.patches[p];
+    const CostTrace::PatchRecord& pb = b.patches[p];
+    if( pa.level != pb.level || pa.low != pb.low || pa.high != pb.high ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//______________________________________________________________________
+//  Index of a patch in the grid (and trace) order.
+int
+globalIndex( const Grid * grid, const Patch * patch )
+{
+  int index = patch->getLevelIndex();
+  for( int l = 0; l < patch->getLevel()->getIndex(); l++ ) {
+    index += grid->getLevel(l)->numPatches();
+  }
+  return index;
+}
+
+//______________________________________________________________________
+//
+double
+overlapCells( const IntVector & low1, const IntVector & high1, const IntVector & low2, const IntVector & high2 )
+{
+  IntVector low  = Max( low1, low2 );
+  IntVector high = Min( high1, high2 );
+  IntVector size = high - low;
+  if( size.x() <= 0 || size.y() <= 0 || size.z() <= 0 ) {
+    return 0;
+  }
+  return (double)size.x() * size.y() * size.z();
+}
+
+//______________________________________________________________________
+//  Evaluates an assignment of the patches of a step.  The communication
+//  only counts neighbors within a level (not periodic or coarse-fine).
+void
+evaluate( const Grid                * grid,
+          const CostTrace::Step     & step,
+          const vector<int>         & owner,
+                int                   num_procs,
+                int                   ghost,
+          const Grid                * old_grid,
+          const vector<int>         & old_owner,
+                Metrics             & metrics )
+{
+  vector<double> proc_costs( num_procs, 0 );
+  for( unsigned p = 0; p < step.patches.size(); p++ ) {
+    proc_costs[ owner[p] ] += step.patches[p].cost;
+  }
+
+  metrics.maxCost  = *max_element( proc_costs.begin(), proc_costs.end() );
+  metrics.meanCost = 0;
+  for( int r = 0; r < num_procs; r++ ) {
+    metrics.meanCost += proc_costs[r] / num_procs;
+  }
+  metrics.imbalance = metrics.meanCost > 0 ? metrics.maxCost / metrics.meanCost : 1;
+
+  metrics.edges         = 0;
+  metrics.ghostCells    = 0;
+  metrics.migratedCells = 0;
+
+  IntVector g( ghost, ghost, ghost );
+  Level::selectType neighbors;
+
+  for( int l = 0; l < grid->numLevels(); l++ ) {
+    const LevelP& level = grid->getLevel(l);
+
+    for( int p = 0; p < level->numPatches(); p++ ) {
+      const Patch* patch = level->getPatch(p);
+      int index = globalIndex( grid, patch );
+      IntVector low  = patch->getCellLowIndex();
+      IntVector high = patch->getCellHighIndex();
+
+      neighbors.resize(0);
+      level->selectPatches( low - g, high + g, neighbors );
+      for( int n = 0; n < neighbors.size(); n++ ) {
+        const Patch* neighbor = neighbors[n];
+        int neighbor_index = globalIndex( grid, neighbor );
+        if( neighbor == patch || owner[neighbor_index] == owner[index] ) {
+          continue;
+        }
+        metrics.ghostCells += overlapCells( low - g, high + g, neighbor->getCellLowIndex(), neighbor->getCellHighIndex() );
+        if( neighbor_index > index ) {
+          metrics.edges++;
+        }
+      }
+
+      // the data of the old patches this patch covers
+      if( old_grid == 0 || l >= old_grid->numLevels() ) {
+        continue;
+      }
+      const LevelP& old_level = old_grid->getLevel(l);
+      neighbors.resize(0);
+      old_level->selectPatches( low, high, neighbors );
+      for( int n = 0; n < neighbors.size(); n++ ) {
+        const Patch* old_patch = neighbors[n];
+        if( old_owner[ globalIndex( old_grid, old_patch ) ] != owner[index] ) {
+          metrics.migratedCells += overlapCells( low, high, old_patch->getCellLowIndex(), old_patch->getCellHighIndex() );
+        }
+      }
+    }
+  }
+}
+
+//______________________________________________________________________
+//
+int
+main( int argc, char *argv[] )
+{
+  int    interval = 1;
+  int    ghost    = 1;
+  string outfile;
+  vector<string> files;
+
+  for( int i = 1; i < argc; i++ ) {
+    string s = argv[i];
+    if( s == "-interval" || s == "-ghost" || s == "-o" ) {
+      if( i + 1 >= argc ) {
+        usage( s, argv[0] );
+      }
+      if( s == "-interval" ) {
+        interval = atoi( argv[++i] );
+      }
+      else if( s == "-ghost" ) {
+        ghost = atoi( argv[++i] );
+      }
+      else {
+        outfile = argv[++i];
+      }
+    }
+    else if( s[0] == '-' ) {
+      usage( s, argv[0] );
+    }
+    else {
+      files.push_back( s );
+    }
+  }
+  if( files.size() != 2 || interval < 1 || ghost < 0 ) {
+    usage( "", argv[0] );
+  }
+
+  Uintah::Parallel::determineIfRunningUnderMPI( argc, argv );
+  Uintah::Parallel::initializeManager( argc, argv );
+  const ProcessorGroup* world = Uintah::Parallel::getRootProcessorGroup();
+
+  bool failed = false;
+  try {
+    ProblemSpecP ups = ProblemSpecReader().readInputFile( files[0] );
+
+    ProblemSpecP lb_ps = ups->findBlock( "LoadBalancer" );
+    string type;
+    if( lb_ps ) {
+      lb_ps->getAttribute( "type", type );
+
+      // don't record over the trace being replayed
+      ProblemSpecP trace_ps = lb_ps->findBlock( "costTrace" );
+      if( trace_ps ) {
+        lb_ps->removeChild( trace_ps );
+      }
+    }
+    if( type == "PLB" ) {
+      throw InternalError( "lbreplay: the PLB counts particles in the data warehouse and cannot be replayed", __FILE__, __LINE__ );
+    }
+
+    ifstream trace( files[1].c_str() );
+    if( !trace ) {
+      throw InternalError( "lbreplay: unable to open " + files[1], __FILE__, __LINE__ );
+    }
+
+    ofstream outstream;
+    if( !outfile.empty() && world->myrank() == 0 ) {
+      outstream.open( outfile.c_str() );
+    }
+    ostream& out = outfile.empty() ? cout : outstream;
+
+    SimulationStateP    state = scinew SimulationState( ups );
+    LoadBalancerCommon* lb    = LoadBalancerFactory::create( ups, world );
+
+    vector< vector<double> > costs;
+    CostTrace::Step step, previous_step;
+    GridP           grid, old_grid;
+    vector<int>     owner, old_owner;
+    int             num_steps = 0;
+
+    Metrics total;
+    total.imbalance = total.maxCost = total.meanCost = total.migratedCells = total.ghostCells = 0;
+    total.edges = 0;
+    double recorded_imbalance = 0;
+    double worst_imbalance    = 0;
+
+    if( world->myrank() == 0 ) {
+      out << "# timestep imbalance max_cost mean_cost migrated_cells edges ghost_cells recorded_imbalance\n";
+    }
+
+    while( CostTrace::read( trace, step ) ) {
+      bool new_grid = num_steps == 0 || !sameLayout( step, previous_step );
+      int  lb_state = LoadBalancer::check;
+
+      if( new_grid ) {
+        old_grid = grid;
+        grid     = buildGrid( step );
+
+        if( num_steps == 0 ) {
+          const LevelP& level = grid->getLevel(0);
+          IntVector low, high;
+          level->findCellIndexRange( low, high );
+          IntVector size = high - low;
+          state->setDimensionality( size[0] > 1, size[1] > 1, size[2] > 1 );
+
+          lb->problemSetup( ups, grid, state );
+
+          DynamicLoadBalancer* dlb = dynamic_cast<DynamicLoadBalancer*>( lb );
+          if( dlb ) {
+            dlb->setCostForecaster( scinew TraceForecaster( costs ) );
+          }
+          lb_state = LoadBalancer::init;
+        }
+        else {
+          lb_state = LoadBalancer::regrid;
+        }
+      }
+
+      costs.assign( step.levels.size(), vector<double>() );
+      int recorded_procs = 1;
+      for( unsigned p = 0; p < step.patches.size(); p++ ) {
+        costs[ step.patches[p].level ].push_back( step.patches[p].cost );
+        recorded_procs = max( recorded_procs, step.patches[p].processor + 1 );
+      }
+
+      state->setCurrentTopLevelTimeStep( step.timestep );
+      if( new_grid || num_steps % interval == 0 ) {
+        lb->possiblyDynamicallyReallocate( grid, lb_state );
+      }
+
+      old_owner.swap( owner );
+      owner.resize( step.patches.size() );
+      vector<int> recorded_owner( step.patches.size() );
+      for( int l = 0, index = 0; l < grid->numLevels(); l++ ) {
+        const LevelP& level = grid->getLevel(l);
+        for( int p = 0; p < level->numPatches(); p++, index++ ) {
+          owner[index]          = lb->getPatchwiseProcessorAssignment( level->getPatch(p) );
+          recorded_owner[index] = step.patches[index].processor;
+        }
+      }
+
+      if( world->myrank() == 0 ) {
+        Metrics metrics, recorded;
+        const Grid* previous_grid = num_steps == 0 ? 0 : ( new_grid ? old_grid.get_rep() : grid.get_rep() );
+        evaluate( grid.get_rep(), step, owner, world->size(), ghost, previous_grid, old_owner, metrics );
+        evaluate( grid.get_rep(), step, recorded_owner, recorded_procs, ghost, 0, recorded_owner, recorded );
+
+        out << step.timestep << " " << metrics.imbalance << " " << metrics.maxCost << " " << metrics.meanCost << " "
+            << metrics.migratedCells << " " << metrics.edges << " " << metrics.ghostCells << " " << recorded.imbalance << "\n";
+
+        total.imbalance     += metrics.imbalance;
+        total.maxCost       += metrics.maxCost;
+        total.meanCost      += metrics.meanCost;
+        total.migratedCells += metrics.migratedCells;
+        total.edges         += metrics.edges;
+        total.ghostCells    += metrics.ghostCells;
+        recorded_imbalance  += recorded.imbalance;
+        worst_imbalance      = max( worst_imbalance, metrics.imbalance );
+      }
+
+      previous_step = step;
+      num_steps++;
+    }
+
+    if( world->myrank() == 0 && num_steps > 0 ) {
+      cerr << setprecision(4)
+           << "Replayed " << num_steps << " steps on " << world->size() << " processors\n"
+           << "  mean imbalance:        " << total.imbalance / num_steps << " (worst " << worst_imbalance << ")\n"
+           << "  recorded imbalance:    " << recorded_imbalance / num_steps << "\n"
+           << "  predicted time:        " << total.maxCost << " (ideal " << total.meanCost << ")\n"
+           << "  migrated cells:        " << total.migratedCells << "\n"
+           << "  mean edges:            " << (double)total.edges / num_steps << "\n"
+           << "  mean ghost cells:      " << total.ghostCells / num_steps << "\n";
+    }
+
+    delete lb;
+  }
+  catch( Exception & e ) {
+    cerr << "Caught exception: " << e.message() << "\n";
+    failed = true;
+  }
+
+  Uintah::Parallel::finalizeManager( failed ? Uintah::Parallel::Abort : Uintah::Parallel::NormalShutdown );
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,812 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ *  reduce_uda.cc: Copies the selected variables, materials and timesteps
+ *                 of an uda into a new uda, at the file level.
+ *
+ *  Usage: mpirun -np <ranks> reduce_uda [options] <uda in> <uda out>
+ *
+ *  sus -reduce_uda (UdaReducer) runs every timestep through the scheduler,
+ *  reading the variables into a data warehouse and writing them back out
+ *  with the DataArchiver.  Here the byte range of each kept variable is
+ *  copied straight from the pNNNNN.data file, as listed by the pNNNNN.idx
+ *  sidecar (or the pNNNNN.xml), into a new data file, and a new xml and
+ *  sidecar are written for it.  The data is not decoded unless the
+ *  compression is changed.  The timesteps are divided among the MPI ranks,
+ *  and only one variable at a time is held in memory.
+ *
+ *  Checkpoints are not copied.
+ */
+
+#include <CCA/Components/ProblemSpecification/ProblemSpecReader.h>
+
+#include <Core/Containers/ConsecutiveRangeSet.h>
+#include <Core/Exceptions/Exception.h>
+#include <Core/Exceptions/InternalError.h>
+#include <Core/Grid/UdaSidecar.h>
+#include <Core/Parallel/Parallel.h>
+#include <Core/Parallel/ProcessorGroup.h>
+#include <Core/ProblemSpec/ProblemSpec.h>
+#include <Core/Util/Endian.h>
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Uintah;
+
+namespace {
+
+const long PADSIZE = 1024L;        // alignment of the variables in a data file (see DataArchiver)
+
+enum CompressionMode { KeepCompression, Gzip, NoCompression };
+
+//______________________________________________________________________
+//  What to keep.  An empty variable list keeps every variable; a
+//  variable without materials keeps every material.  Entries that are
+//  not per material (index -1) are kept whenever their variable is.
+struct Selection {
+
+  Selection() : allMatls( true ), firstTimestep( 0 ), lastTimestep( INT_MAX ), timestepStride( 1 ) {}
+
+  bool keepVariable( const string & name ) const
+  {
+    if( exclude.count( name ) ) {
+      return false;
+    }
+    return variables.empty() || variables.count( name );
+  }
+
+  bool keep( const UdaSidecar::VariableEntry & entry )
+  {
+    if( !keepVariable( entry.name ) ) {
+      return false;
+    }
+    if( entry.matl < 0 ) {
+      return true;
+    }
+    if( !allMatls && matls.find( entry.matl ) == matls.end() ) {
+      return false;
+    }
+    map<string, ConsecutiveRangeSet>::iterator iter = variables.find( entry.name );
+    if( iter != variables.end() && iter->second.size() > 0 ) {
+      return iter->second.find( entry.matl ) != iter->second.end();
+    }
+    return true;
+  }
+
+  map<string, ConsecutiveRangeSet> variables;    // name -> materials (empty: all)
+  set<string>                      exclude;
+  ConsecutiveRangeSet              matls;
+  bool                             allMatls;
+
+  int firstTimestep;
+  int lastTimestep;
+  int timestepStride;
+};
+
+struct Options {
+  Options() : compression( KeepCompression ), nByteMode( 8 ) {}
+
+  string          udaIn;
+  string          udaOut;
+  Selection       selection;
+  CompressionMode compression;
+  int             nByteMode;      // size of the uncompressed size field of gzip'ed data
+};
+
+struct Stats {
+  Stats() : bytesIn( 0 ), bytesOut( 0 ), variables( 0 ), datafiles( 0 ) {}
+
+  double bytesIn;       // of the kept variables
+  double bytesOut;
+  double variables;
+  double datafiles;
+};
+
+//______________________________________________________________________
+//
+void
+usage( const string & badarg, const string & progname )
+{
+  if( badarg != "" ) {
+    cerr << "\nError parsing argument: " << badarg << '\n';
+  }
+  cerr << "\nUsage: " << progname << " [options] <uda in> <uda out>\n\n";
+  cerr << "Copies a subset of an uda to a new uda without reading the data into a\n";
+  cerr << "data warehouse.  Run it under mpirun to reduce several timesteps at once.\n\n";
+  cerr << "Valid options are:\n";
+  cerr << "  -h[elp]\n";
+  cerr << "  -var       [string]   (Keep this variable; repeat for more.  Default: all)\n";
+  cerr << "  -exclude   [string]   (Drop this variable; repeat for more)\n";
+  cerr << "  -ups       [file]     (Keep the variables, and their materials, of the\n";
+  cerr << "                         <DataArchiver><save> list of this input file)\n";
+  cerr << "  -matls     [set]      (Keep these materials, e.g. 0,2-3.  Default: all)\n";
+  cerr << "  -first     [int]      (First timestep number to keep)\n";
+  cerr << "  -last      [int]      (Last timestep number to keep)\n";
+  cerr << "  -stride    [int]      (Keep every n-th of the remaining timesteps)\n";
+  cerr << "  -compress  [mode]     (keep: leave the data as is (default), gzip: gzip\n";
+  cerr << "                         uncompressed variables, none: uncompress them)\n";
+  cerr << "\nCheckpoints are not copied.\n\n";
+  Parallel::exitAll( 1 );
+}
+
+//______________________________________________________________________
+//  Everything below writes through these; system("cp ...") forks, which
+//  is not safe in every MPI implementation.
+void
+readBytes( int fd, const string & filename, long offset, long size, vector<char> & buffer )
+{
+  buffer.resize( size );
+  long done = 0;
+  while( done < size ) {
+    ssize_t s = pread( fd, &buffer[done], size - done, offset + done );
+    if( s <= 0 ) {
+      throw InternalError( "reduce_uda: error reading " + filename, __FILE__, __LINE__ );
+    }
+    done += s;
+  }
+}
+
+void
+writeBytes( int fd, const string & filename, const char * data, long size )
+{
+  long done = 0;
+  while( done < size ) {
+    ssize_t s = write( fd, data + done, size - done );
+    if( s <= 0 ) {
+      throw InternalError( "reduce_uda: error writing " + filename, __FILE__, __LINE__ );
+    }
+    done += s;
+  }
+}
+
+int
+openFile( const string & filename, int flags )
+{
+  int fd = open( filename.c_str(), flags, 0666 );
+  if( fd == -1 ) {
+    throw InternalError( "reduce_uda: cannot open " + filename, __FILE__, __LINE__ );
+  }
+  return fd;
+}
+
+void
+copyFile( const string & from, const string & to )
+{
+  int in  = openFile( from, O_RDONLY );
+  int out = openFile( to, O_WRONLY | O_CREAT | O_TRUNC );
+
+  vector<char> buffer( 1 << 22 );
+  ssize_t s;
+  while( ( s = read( in, &buffer[0], buffer.size() ) ) > 0 ) {
+    writeBytes( out, to, &buffer[0], s );
+  }
+  close( in );
+  close( out );
+  if( s < 0 ) {
+    throw InternalError( "reduce_uda: error reading " + from, __FILE__, __LINE__ );
+  }
+}
+
+//__________________________________
+// Copies the rows of a global .dat file ("time value...", one per
+// timestep) whose time is one of the kept output times.
+void
+filterDatFile( const string & from, const string & to, const vector<double> & keptTimes )
+{
+  ifstream in( from.c_str() );
+  if( !in ) {
+    throw InternalError( "reduce_uda: cannot open " + from, __FILE__, __LINE__ );
+  }
+  ofstream out( to.c_str() );
+  if( !out ) {
+    throw InternalError( "reduce_uda: cannot open " + to, __FILE__, __LINE__ );
+  }
+
+  string line;
+  while( getline( in, line ) ) {
+    char * end;
+    const double time = strtod( line.c_str(), &end );
+    if( end == line.c_str() ) {
+      continue;
+    }
+    // both files hold the time with 17 digits; allow for the rounding of the last one
+    vector<double>::const_iterator t = lower_bound( keptTimes.begin(), keptTimes.end(), time - 1e-12 * fabs( time ) );
+    if( t != keptTimes.end() && fabs( *t - time ) <= 1e-12 * fabs( time ) ) {
+      out << line << "\n";
+    }
+  }
+  if( !out ) {
+    throw InternalError( "reduce_uda: error writing " + to, __FILE__, __LINE__ );
+  }
+}
+
+void
+makeDirectory( const string & name )
+{
+  if( mkdir( name.c_str(), 0777 ) != 0 && errno != EEXIST ) {
+    throw InternalError( "reduce_uda: cannot create directory " + name, __FILE__, __LINE__ );
+  }
+}
+
+// the entries of a directory, without . and ..
+void
+listDirectory( const string & name, vector<string> & files, vector<string> & subdirs )
+{
+  DIR * dir = opendir( name.c_str() );
+  if( dir == nullptr ) {
+    throw InternalError( "reduce_uda: cannot read directory " + name, __FILE__, __LINE__ );
+  }
+  for( dirent * file = readdir( dir ); file != nullptr; file = readdir( dir ) ) {
+    string entry = file->d_name;
+    if( entry == "." || entry == ".." ) {
+      continue;
+    }
+    struct stat st;
+    if( stat( ( name + "/" + entry ).c_str(), &st ) != 0 ) {
+      continue;
+    }
+    if( S_ISDIR( st.st_mode ) ) {
+      subdirs.push_back( entry );
+    }
+    else {
+      files.push_back( entry );
+    }
+  }
+  closedir( dir );
+}
+
+bool
+endsWith( const string & str, const string & suffix )
+{
+  return str.size() >= suffix.size() && str.compare( str.size() - suffix.size(), suffix.size(), suffix ) == 0;
+}
+
+//______________________________________________________________________
+//  The gzip'ed data of a variable (Variable::gzipCompress) is the
+//  uncompressed size, in nByteMode bytes, followed by the zlib stream.
+bool
+isGzipped( const string & compression )
+{
+  return compression.find( "gzip" ) != string::npos;
+}
+
+bool
+isRLE( const string & compression )
+{
+  return compression.find( "rle" ) != string::npos;
+}
+
+void
+gunzip( const vector<char> & in, int nByteMode, vector<char> & out )
+{
+  uint64_t size64 = 0;
+  uint32_t size32 = 0;
+  if( (long)in.size() < nByteMode ) {
+    throw InternalError( "reduce_uda: truncated gzip'ed variable", __FILE__, __LINE__ );
+  }
+  if( nByteMode == 8 ) {
+    memcpy( &size64, &in[0], 8 );
+  }
+  else {
+    memcpy( &size32, &in[0], 4 );
+    size64 = size32;
+  }
+
+  uLongf size = size64;
+  out.resize( size );
+  if( uncompress( (Bytef*)&out[0], &size, (const Bytef*)&in[nByteMode], in.size() - nByteMode ) != Z_OK || size != size64 ) {
+    throw InternalError( "reduce_uda: uncompress failed", __FILE__, __LINE__ );
+  }
+}
+
+// Returns false, leaving out untouched, if gzip does not make the data smaller.
+bool
+gzip( const vector<char> & in, int nByteMode, vector<char> & out )
+{
+  uLongf size = compressBound( in.size() );
+  out.resize( nByteMode + size );
+  if( compress( (Bytef*)&out[nByteMode], &size, (const Bytef*)&in[0], in.size() ) != Z_OK ) {
+    throw InternalError( "reduce_uda: compress failed", __FILE__, __LINE__ );
+  }
+  if( nByteMode + (long)size >= (long)in.size() ) {
+    return false;
+  }
+  out.resize( nByteMode + size );
+
+  uint64_t size64 = in.size();
+  uint32_t size32 = (uint32_t)in.size();
+  if( nByteMode == 8 ) {
+    memcpy( &out[0], &size64, 8 );
+  }
+  else {
+    memcpy( &out[0], &size32, 4 );
+  }
+  return true;
+}
+
+//______________________________________________________________________
+//  Copies the kept variables of one pNNNNN.xml (or global.xml) and its
+//  data files from inDir to outDir, and writes the new xml and sidecar.
+void
+reduceDatafile( const string  & inDir,
+                const string  & outDir,
+                const string  & xmlName,
+                      Options & opts,
+                      Stats   & stats )
+{
+  const string inXml = inDir + "/" + xmlName;
+
+  vector<UdaSidecar::VariableEntry> entries;
+  if( !UdaSidecar::readIndex( UdaSidecar::indexFilename( inXml ), entries ) ) {
+    ProblemSpecP doc = ProblemSpecReader().readInputFile( inXml );
+    UdaSidecar::parseVariables( doc, entries );
+  }
+
+  ProblemSpecP doc = ProblemSpec::createDocument( "Uintah_Output" );
+
+  // the data files are opened as the entries refer to them
+  map<string, int>  inFiles;
+  map<string, int>  outFiles;
+  map<string, long> outCur;
+  vector<char>      data;
+  vector<char>      converted;
+
+  for( unsigned e = 0; e < entries.size(); e++ ) {
+    UdaSidecar::VariableEntry entry = entries[e];
+    if( !opts.selection.keep( entry ) ) {
+      continue;
+    }
+
+    if( inFiles.find( entry.filename ) == inFiles.end() ) {
+      inFiles[entry.filename]  = openFile( inDir  + "/" + entry.filename, O_RDONLY );
+      outFiles[entry.filename] = openFile( outDir + "/" + entry.filename, O_WRONLY | O_CREAT | O_TRUNC );
+      outCur[entry.filename]   = 0;
+    }
+    const int    in      = inFiles[entry.filename];
+    const int    out     = outFiles[entry.filename];
+    long       & cur     = outCur[entry.filename];
+    const string outName = outDir + "/" + entry.filename;
+
+    readBytes( in, inDir + "/" + entry.filename, entry.start, entry.end - entry.start, data );
+    stats.bytesIn += data.size();
+
+    //__________________________________
+    //  change the compression
+    vector<char> * bytes = &data;
+    if( !data.empty() ) {
+      if( opts.compression == NoCompression && isGzipped( entry.compression ) ) {
+        gunzip( data, opts.nByteMode, converted );
+        bytes = &converted;
+        entry.compression = isRLE( entry.compression ) ? "rle" : "";
+      }
+      else if( opts.compression == Gzip && !isGzipped( entry.compression ) ) {
+        if( gzip( data, opts.nByteMode, converted ) ) {
+          bytes = &converted;
+          entry.compression = isRLE( entry.compression ) ? "rle, gzip" : "gzip";
+        }
+      }
+    }
+
+    //__________________________________
+    //  pad, as the DataArchiver does
+    if( cur % PADSIZE != 0 ) {
+      const long pad = PADSIZE - cur % PADSIZE;
+      vector<char> zero( pad, 0 );
+      writeBytes( out, outName, &zero[0], pad );
+      cur += pad;
+    }
+
+    entry.start = cur;
+    if( !bytes->empty() ) {
+      writeBytes( out, outName, &(*bytes)[0], bytes->size() );
+    }
+    cur += bytes->size();
+    entry.end = cur;
+
+    UdaSidecar::appendVariable( doc, entry );
+
+    stats.bytesOut  += bytes->size();
+    stats.variables += 1;
+  }
+
+  for( map<string, int>::iterator iter = inFiles.begin(); iter != inFiles.end(); iter++ ) {
+    close( iter->second );
+  }
+  for( map<string, int>::iterator iter = outFiles.begin(); iter != outFiles.end(); iter++ ) {
+    if( close( iter->second ) != 0 ) {
+      throw InternalError( "reduce_uda: error closing " + outDir + "/" + iter->first, __FILE__, __LINE__ );
+    }
+  }
+
+  const string outXml = outDir + "/" + xmlName;
+  doc->output( outXml.c_str() );
+  UdaSidecar::writeIndex( UdaSidecar::indexFilename( outXml ), doc );
+  stats.datafiles += 1;
+}
+
+//______________________________________________________________________
+//  A timestep directory: the level directories lN hold the pNNNNN.xml/
+//  .data/.idx triples, global.xml/.data/.idx the reduction variables.
+//  The rest (timestep.xml, grid.xml, grid.bin) is copied as is.
+void
+reduceTimestep( const string & tsDir, Options & opts, Stats & stats )
+{
+  const string inDir  = opts.udaIn  + "/" + tsDir;
+  const string outDir = opts.udaOut + "/" + tsDir;
+  makeDirectory( outDir );
+
+  vector<string> files, subdirs;
+  listDirectory( inDir, files, subdirs );
+
+  for( unsigned f = 0; f < files.size(); f++ ) {
+    const string & file = files[f];
+    if( file == "global.xml" ) {
+      reduceDatafile( inDir, outDir, file, opts, stats );
+    }
+    else if( file != "global.data" && file != "global.idx" ) {
+      copyFile( inDir + "/" + file, outDir + "/" + file );
+    }
+  }
+
+  for( unsigned d = 0; d < subdirs.size(); d++ ) {
+    const string & level = subdirs[d];
+    if( level.size() < 2 || level[0] != 'l' || level.find_first_not_of( "0123456789", 1 ) != string::npos ) {
+      cerr << "WARNING: reduce_uda: skipping unknown directory " << inDir << "/" << level << '\n';
+      continue;
+    }
+
+    const string inLevel  = inDir  + "/" + level;
+    const string outLevel = outDir + "/" + level;
+    makeDirectory( outLevel );
+
+    vector<string> levelFiles, levelSubdirs;
+    listDirectory( inLevel, levelFiles, levelSubdirs );
+
+    for( unsigned f = 0; f < levelFiles.size(); f++ ) {
+      const string & file = levelFiles[f];
+      if( endsWith( file, ".xml" ) ) {
+        reduceDatafile( inLevel, outLevel, file, opts, stats );
+      }
+      else if( !endsWith( file, ".data" ) && !endsWith( file, ".idx" ) ) {
+        copyFile( inLevel + "/" + file, outLevel + "/" + file );
+      }
+    }
+  }
+}
+
+//______________________________________________________________________
+//  Removes the children named 'name' of 'section' for which keep() is false.
+template<class Predicate>
+void
+filterSection( ProblemSpecP & section, const string & name, Predicate keep )
+{
+  if( section == nullptr ) {
+    return;
+  }
+  vector<ProblemSpecP> remove;
+  for( ProblemSpecP node = section->findBlock( name ); node != nullptr; node = node->findNextBlock( name ) ) {
+    if( !keep( node ) ) {
+      remove.push_back( node );
+    }
+  }
+  for( unsigned i = 0; i < remove.size(); i++ ) {
+    section->removeChild( remove[i] );
+  }
+}
+
+//______________________________________________________________________
+//  The timestep directories to reduce, in the order of index.xml.
+void
+selectTimesteps( const ProblemSpecP & index, const Selection & selection, vector<string> & tsDirs, set<int> & kept )
+{
+  ProblemSpecP timesteps = index->findBlock( "timesteps" );
+  if( timesteps == nullptr ) {
+    return;
+  }
+
+  int count = 0;
+  for( ProblemSpecP ts = timesteps->findBlock( "timestep" ); ts != nullptr; ts = ts->findNextBlock( "timestep" ) ) {
+    int timestep;
+    ts->get( timestep );
+    if( timestep < selection.firstTimestep || timestep > selection.lastTimestep ) {
+      continue;
+    }
+    if( count++ % selection.timestepStride != 0 ) {
+      continue;
+    }
+
+    map<string, string> attributes;
+    ts->getAttributes( attributes );
+    string href = attributes["href"];
+    string::size_type slash = href.find_first_of( "/" );
+    if( slash == string::npos ) {
+      throw InternalError( "reduce_uda: bad timestep href '" + href + "' in index.xml", __FILE__, __LINE__ );
+    }
+    tsDirs.push_back( href.substr( 0, slash ) );
+    kept.insert( timestep );
+  }
+}
+
+//______________________________________________________________________
+//  The top level of the new uda: index.xml with the kept variables and
+//  timesteps, the global .dat files of the kept variables, and the
+//  remaining files (input.xml, ...).  The subdirectories are skipped.
+//  When timesteps are dropped, the rows of the .dat files are reduced to
+//  the times of the kept timesteps.
+void
+writeTopLevel( ProblemSpecP & index, const set<int> & keptTimesteps, Options & opts )
+{
+  const Selection & selection = opts.selection;
+
+  ProblemSpecP variables = index->findBlock( "variables" );
+  filterSection( variables, "variable", [&]( ProblemSpecP & node ) {
+    string name;
+    node->getAttribute( "name", name );
+    return selection.keepVariable( name );
+  } );
+
+  set<string> droppedGlobals, keptGlobals;
+  ProblemSpecP globals = index->findBlock( "globals" );
+  filterSection( globals, "variable", [&]( ProblemSpecP & node ) {
+    string name, href;
+    node->getAttribute( "name", name );
+    node->getAttribute( "href", href );
+    if( !selection.keepVariable( name ) ) {
+      droppedGlobals.insert( href );
+      return false;
+    }
+    keptGlobals.insert( href );
+    return true;
+  } );
+
+  vector<double> keptTimes;
+  bool           droppedTimesteps = false;
+  ProblemSpecP timesteps = index->findBlock( "timesteps" );
+  filterSection( timesteps, "timestep", [&]( ProblemSpecP & node ) {
+    int timestep;
+    node->get( timestep );
+    if( keptTimesteps.count( timestep ) == 0 ) {
+      droppedTimesteps = true;
+      return false;
+    }
+    double time;
+    node->getAttribute( "time", time );
+    keptTimes.push_back( time );
+    return true;
+  } );
+  sort( keptTimes.begin(), keptTimes.end() );
+
+  vector<string> files, subdirs;
+  listDirectory( opts.udaIn, files, subdirs );
+  for( unsigned f = 0; f < files.size(); f++ ) {
+    if( files[f] == "index.xml" || droppedGlobals.count( files[f] ) ) {
+      continue;
+    }
+    if( droppedTimesteps && keptGlobals.count( files[f] ) ) {
+      filterDatFile( opts.udaIn + "/" + files[f], opts.udaOut + "/" + files[f], keptTimes );
+    }
+    else {
+      copyFile( opts.udaIn + "/" + files[f], opts.udaOut + "/" + files[f] );
+    }
+  }
+
+  string indexName = opts.udaOut + "/index.xml";
+  index->output( indexName.c_str() );
+}
+
+//______________________________________________________________________
+//  The labels and materials of the <DataArchiver><save> list.
+void
+readSaveLabels( const string & ups, Selection & selection )
+{
+  ProblemSpecP doc = ProblemSpecReader().readInputFile( ups );
+  ProblemSpecP da  = doc->findBlock( "DataArchiver" );
+  if( da == nullptr ) {
+    throw InternalError( "reduce_uda: no <DataArchiver> section in " + ups, __FILE__, __LINE__ );
+  }
+  for( ProblemSpecP save = da->findBlock( "save" ); save != nullptr; save = save->findNextBlock( "save" ) ) {
+    map<string, string> attributes;
+    save->getAttributes( attributes );
+    selection.variables[attributes["label"]] = ConsecutiveRangeSet( attributes["material"] );
+  }
+}
+
+} // End anonymous namespace
+
+//______________________________________________________________________
+//
+int
+main( int argc, char** argv )
+{
+  Uintah::Parallel::determineIfRunningUnderMPI( argc, argv );
+  Uintah::Parallel::initializeManager( argc, argv );
+
+  const int rank   = Parallel::getMPIRank();
+  const int nRanks = Parallel::getMPISize();
+
+  Options    opts;
+  Selection& selection = opts.selection;
+
+  try {
+    //__________________________________
+    // Parse Args:
+    for( int i = 1; i < argc; i++ ) {
+      string s = argv[i];
+      if( s == "-var" ) {
+        if( ++i == argc ) usage( "-var, no value given", argv[0] );
+        selection.variables[argv[i]] = ConsecutiveRangeSet();
+      }
+      else if( s == "-exclude" ) {
+        if( ++i == argc ) usage( "-exclude, no value given", argv[0] );
+        selection.exclude.insert( argv[i] );
+      }
+      else if( s == "-ups" ) {
+        if( ++i == argc ) usage( "-ups, no value given", argv[0] );
+        readSaveLabels( argv[i], selection );
+      }
+      else if( s == "-matls" ) {
+        if( ++i == argc ) usage( "-matls, no value given", argv[0] );
+        selection.matls    = ConsecutiveRangeSet( argv[i] );
+        selection.allMatls = selection.matls.size() == 0;
+      }
+      else if( s == "-first" ) {
+        if( ++i == argc ) usage( "-first, no value given", argv[0] );
+        selection.firstTimestep = atoi( argv[i] );
+      }
+      else if( s == "-last" ) {
+        if( ++i == argc ) usage( "-last, no value given", argv[0] );
+        selection.lastTimestep = atoi( argv[i] );
+      }
+      else if( s == "-stride" ) {
+        if( ++i == argc ) usage( "-stride, no value given", argv[0] );
+        selection.timestepStride = atoi( argv[i] );
+        if( selection.timestepStride < 1 ) usage( "-stride must be at least 1", argv[0] );
+      }
+      else if( s == "-compress" ) {
+        if( ++i == argc ) usage( "-compress, no value given", argv[0] );
+        string mode = argv[i];
+        if( mode == "keep" )      opts.compression = KeepCompression;
+        else if( mode == "gzip" ) opts.compression = Gzip;
+        else if( mode == "none" ) opts.compression = NoCompression;
+        else usage( "-compress " + mode, argv[0] );
+      }
+      else if( s[0] == '-' && s.size() > 1 && s[1] == 'h' ) {
+        usage( "", argv[0] );
+      }
+      else if( s[0] == '-' ) {
+        usage( s, argv[0] );
+      }
+      else if( opts.udaIn == "" ) {
+        opts.udaIn = s;
+      }
+      else if( opts.udaOut == "" ) {
+        opts.udaOut = s;
+      }
+      else {
+        usage( s, argv[0] );
+      }
+    }
+    if( opts.udaOut == "" ) {
+      usage( "two uda directories are required", argv[0] );
+    }
+
+    //__________________________________
+    //  index.xml (every rank reads it, it is small)
+    ProblemSpecP index = ProblemSpecReader().readInputFile( opts.udaIn + "/index.xml" );
+
+    string format = "uda";
+    index->get( "outputFormat", format );
+    if( format != "uda" && format != "UDA" ) {
+      throw InternalError( "reduce_uda: only the standard uda output format can be reduced", __FILE__, __LINE__ );
+    }
+
+    ProblemSpecP meta = index->findBlock( "Meta" );
+    string udaEndianness = endianness();
+    int    nBits         = 8 * sizeof(unsigned long);
+    if( meta != nullptr ) {
+      meta->get( "endianness", udaEndianness );
+      meta->get( "nBits", nBits );
+    }
+    opts.nByteMode = nBits / 8;
+    if( opts.compression != KeepCompression && udaEndianness != endianness() ) {
+      throw InternalError( "reduce_uda: -compress needs an uda written with this machine's byte order", __FILE__, __LINE__ );
+    }
+
+    vector<string> tsDirs;
+    set<int>       keptTimesteps;
+    selectTimesteps( index, selection, tsDirs, keptTimesteps );
+
+    //__________________________________
+    //  rank 0 creates the uda, then the ranks share the timesteps
+    int ok = 1;
+    if( rank == 0 ) {
+      struct stat st;
+      if( stat( opts.udaOut.c_str(), &st ) == 0 ) {
+        cerr << "reduce_uda: " << opts.udaOut << " already exists\n";
+        ok = 0;
+      }
+      else {
+        makeDirectory( opts.udaOut );
+        writeTopLevel( index, keptTimesteps, opts );
+        cout << "Reducing " << tsDirs.size() << " timesteps of " << opts.udaIn
+             << " into " << opts.udaOut << " on " << nRanks << " rank(s)\n";
+      }
+    }
+    if( Parallel::usingMPI() ) {
+      MPI_Bcast( &ok, 1, MPI_INT, 0, Parallel::getRootProcessorGroup()->getComm() );
+    }
+    if( !ok ) {
+      Parallel::exitAll( 1 );
+    }
+
+    Stats stats;
+    for( unsigned t = rank; t < tsDirs.size(); t += nRanks ) {
+      reduceTimestep( tsDirs[t], opts, stats );
+    }
+
+    //__________________________________
+    //  summary
+    double local[4] = { stats.bytesIn, stats.bytesOut, stats.variables, stats.datafiles };
+    double total[4] = { local[0], local[1], local[2], local[3] };
+    if( Parallel::usingMPI() ) {
+      MPI_Reduce( local, total, 4, MPI_DOUBLE, MPI_SUM, 0, Parallel::getRootProcessorGroup()->getComm() );
+    }
+    if( rank == 0 ) {
+      const double MB = 1024.0 * 1024.0;
+      cout << "  copied " << (long)total[2] << " variables from " << (long)total[3] << " data files, "
+           << fixed << setprecision(1) << total[0] / MB << " MB -> " << total[1] / MB << " MB\n";
+    }
+  }
+  catch( Exception & e ) {
+    cerr << "Caught exception: " << e.message() << '\n';
+    Parallel::exitAll( 1 );
+  }
+  catch( ... ) {
+    cerr << "Caught unknown exception\n";
+    Parallel::exitAll( 1 );
+  }
+
+  Parallel::finalizeManager();
+  return 0;
+}
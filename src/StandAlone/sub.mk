@@ -111,6 +111,20 @@ PROGRAM := StandAlone/compare_uda
 
 include $(SCIRUN_SCRIPTS)/program.mk
 
+##############################################
+# reduce_uda
+
+# zlib is added for this program only
+REDUCE_UDA_SAVED_LIBS := $(LIBS)
+
+SRCS    := $(SRCDIR)/reduce_uda.cc
+PROGRAM := StandAlone/reduce_uda
+LIBS    := $(LIBS) $(Z_LIBRARY)
+
+include $(SCIRUN_SCRIPTS)/program.mk
+
+LIBS    := $(REDUCE_UDA_SAVED_LIBS)
+
 ##############################################
 # slb
 
@@ -119,6 +133,14 @@ PROGRAM := StandAlone/slb
 
 include $(SCIRUN_SCRIPTS)/program.mk
 
+##############################################
+# lbreplay
+
+SRCS := $(SRCDIR)/lbreplay.cc
+PROGRAM := StandAlone/lbreplay
+
+include $(SCIRUN_SCRIPTS)/program.mk
+
 ##############################################
 # restart_merger
 
@@ -159,6 +181,7 @@ uintah: sus \
         puda \
         dumpfields \
         compare_uda \
+        reduce_uda \
         compute_Lnorm_udas \
         restart_merger \
         partextract \
@@ -175,6 +198,7 @@ uintah: sus \
         lineextract \
         timeextract \
         faceextract \
+        analysis2text \
         link_inputs \
         link_scripts \
         link_tools \
@@ -218,7 +242,7 @@ sus: prereqs StandAlone/sus
 
 $(OBJTOP)/StandAlone/sus.o : $(OBJTOP_ABS)/include/svn_info.h
 
-tools: puda dumpfields compare_uda compute_Lnorm_udas restart_merger partextract partvarRange selectpart async_mpi_test mpi_test extractV extractF extractS gambitFileReader slb pfs pfs2 rawToUniqueGrains timeextract faceextract lineextract compare_mms compare_scalar fsspeed
+tools: puda dumpfields compare_uda reduce_uda compute_Lnorm_udas restart_merger partextract partvarRange selectpart async_mpi_test mpi_test extractV extractF extractS gambitFileReader slb lbreplay pfs pfs2 rawToUniqueGrains ptsToBlocked timeextract faceextract lineextract analysis2text compare_mms compare_scalar fsspeed
 
 puda: prereqs StandAlone/tools/puda/puda
 
@@ -226,6 +250,8 @@ dumpfields: prereqs StandAlone/tools/dumpfields/dumpfields
 
 compare_uda: prereqs StandAlone/compare_uda
 
+reduce_uda: prereqs StandAlone/reduce_uda
+
 compute_Lnorm_udas: prereqs StandAlone/tools/compute_Lnorm_udas
 
 restart_merger: prereqs StandAlone/restart_merger
@@ -250,18 +276,24 @@ gambitFileReader: prereqs StandAlone/gambitFileReader
 
 slb: prereqs StandAlone/slb
 
+lbreplay: prereqs StandAlone/lbreplay
+
 pfs: prereqs StandAlone/tools/pfs/pfs
 
 pfs2: prereqs StandAlone/tools/pfs/pfs2
 
 rawToUniqueGrains: prereqs StandAlone/tools/pfs/rawToUniqueGrains
 
+ptsToBlocked: prereqs StandAlone/tools/pfs/ptsToBlocked
+
 timeextract: StandAlone/tools/extractors/timeextract
 
 faceextract: StandAlone/tools/extractors/faceextract
 
 lineextract: StandAlone/tools/extractors/lineextract
 
+analysis2text: StandAlone/tools/extractors/analysis2text
+
 particle2tiff: StandAlone/tools/extractors/particle2tiff
 
 compare_mms: StandAlone/tools/compare_mms/compare_mms
@@ -0,0 +1,97 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ *  analysis2text.cc: Convert the binary output of the on-the-fly analysis
+ *                    modules (lineExtract, planeExtract, particleExtract,
+ *                    containerExtract with <analysisOutput format="binary">)
+ *                    to the text files these modules write by default.
+ */
+
+#include <CCA/Components/OnTheFlyAnalysis/AnalysisWriter.h>
+#include <Core/Exceptions/Exception.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace Uintah;
+
+void
+usage( const std::string & badarg, const std::string & progname )
+{
+  if(badarg != "") {
+    cerr << "Error parsing argument: " << badarg << endl;
+  }
+  cerr << "Usage: " << progname << " [options] "
+       << "-uda <archive file>\n\n";
+  cerr << "  Reads <archive file>/binaryAnalysis/*.bin and writes the text files\n";
+  cerr << "  in the uda, as if the modules had written them.  Existing files are overwritten.\n\n";
+  cerr << "Valid options are:\n";
+  cerr << "  -h,        --help\n";
+  cerr << "  -vv,       --verbose:       (prints the files read and written)\n";
+  exit(1);
+}
+
+//______________________________________________________________________
+//
+int
+main( int argc, char** argv )
+{
+  string input_uda_name;
+  bool   verbose = false;
+
+  for( int i = 1; i < argc; i++ ){
+    const string s = argv[i];
+    if( s == "-uda" ) {
+      if( i + 1 >= argc ) {
+        usage( s, argv[0] );
+      }
+      input_uda_name = string( argv[++i] );
+    } else if( s == "-vv" || s == "--verbose" ) {
+      verbose = true;
+    } else if( s == "-h" || s == "--help" ) {
+      usage( "", argv[0] );
+    } else {
+      usage( s, argv[0] );
+    }
+  }
+
+  if( input_uda_name == "" ){
+    cerr << "No archive file specified\n";
+    usage( "", argv[0] );
+  }
+
+  try {
+    AnalysisWriter::convertToText( input_uda_name, verbose );
+  } catch (Exception& e) {
+    cerr << "Caught exception: " << e.message() << endl;
+    exit(1);
+  } catch(...){
+    cerr << "Caught unknown exception\n";
+    exit(1);
+  }
+  return 0;
+}
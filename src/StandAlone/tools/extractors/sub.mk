@@ -117,6 +117,14 @@ PROGRAM := $(SRCDIR)/lineextract
 include $(SCIRUN_SCRIPTS)/program.mk
 
 
+##############################################
+# analysis2text
+
+SRCS    := $(SRCDIR)/analysis2text.cc
+PROGRAM := $(SRCDIR)/analysis2text
+
+include $(SCIRUN_SCRIPTS)/program.mk
+
 ##############################################
 # particle2tiffls
 
@@ -0,0 +1,366 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <Core/Exceptions/ProblemSetupException.h>
+#include <Core/GeometryPiece/PointBlockFile.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Uintah;
+using namespace std;
+
+/*
+ptsToBlocked converts a text points file of a "file" geometry piece (x y z,
+followed by the columns of the <var>s, one point per line) to the blocked
+binary format (<format>blocked</format>, see PointBlockFile.h).  The
+points are binned into a grid of spatial blocks over their bounding box,
+the blocks are written contiguously and indexed in the header, so that
+each process only reads the blocks that intersect its patches.
+
+The text file is read once; the points are staged in a temporary binary
+file (outfile.tmp) which is read twice more, to count the points of each
+block and then to scatter them to their blocks.
+
+  ptsToBlocked [-var p.volume] [-var p.fiberdir] ... [-blocks nx ny nz]
+               [-points_per_block n] infile outfile
+
+The -var options must be given in the order of the columns of the file
+(and of the <var> tags in the input file).
+*/
+
+namespace {
+
+  void
+  usage( const char* prog_name )
+  {
+    cerr << "Usage: " << prog_name << " [-var name]... [-blocks nx ny nz] [-points_per_block n] infile outfile\n"
+         << "   -var name            : a per point variable column, in file order\n"
+         << "                          (p.volume, p.temperature, p.color, p.externalforce,\n"
+         << "                           p.fiberdir, p.velocity, p.rvec1, p.rvec2, p.rvec3)\n"
+         << "   -blocks nx ny nz     : number of blocks in each direction\n"
+         << "   -points_per_block n  : average points per block, if -blocks is not given (default 32768)\n";
+    exit( 1 );
+  }
+
+  int
+  varColumns( const string& var )
+  {
+    if( var == "p.volume" || var == "p.temperature" || var == "p.color" ) {
+      return 1;
+    }
+    if( var == "p.externalforce" || var == "p.fiberdir" || var == "p.velocity" ||
+        var == "p.rvec1" || var == "p.rvec2" || var == "p.rvec3" ) {
+      return 3;
+    }
+    throw ProblemSetupException( "Unexpected field variable of '" + var + "'", __FILE__, __LINE__ );
+  }
+
+  void
+  writeOrDie( FILE* file, const void* data, size_t bytes, const string& filename )
+  {
+    if( bytes > 0 && fwrite( data, 1, bytes, file ) != bytes ) {
+      throw ProblemSetupException( "Failed writing '" + filename + "'", __FILE__, __LINE__ );
+    }
+  }
+
+  // Buffered writes of the records of one block, at its position in the file
+  struct BlockWriter {
+    long           position;    // in bytes
+    vector<double> buffer;
+  };
+
+  void
+  flush( FILE* file, BlockWriter& writer, const string& filename )
+  {
+    if( writer.buffer.empty() ) {
+      return;
+    }
+    if( fseeko( file, writer.position, SEEK_SET ) != 0 ) {
+      throw ProblemSetupException( "Failed seeking in '" + filename + "'", __FILE__, __LINE__ );
+    }
+    size_t bytes = writer.buffer.size() * sizeof(double);
+    writeOrDie( file, &writer.buffer[0], bytes, filename );
+    writer.position += bytes;
+    writer.buffer.clear();
+  }
+}
+
+int
+main( int argc, char *argv[] )
+{
+  vector<string> vars;
+  int            nblocks[3]       = { 0, 0, 0 };
+  double         points_per_block = 32768;
+  vector<string> files;
+
+  for( int i = 1; i < argc; i++ ) {
+    string arg = argv[i];
+    if( arg == "-var" && i + 1 < argc ) {
+      vars.push_back( argv[++i] );
+    }
+    else if( arg == "-blocks" && i + 3 < argc ) {
+      for( int d = 0; d < 3; d++ ) {
+        nblocks[d] = atoi( argv[++i] );
+      }
+      if( nblocks[0] < 1 || nblocks[1] < 1 || nblocks[2] < 1 ) {
+        usage( argv[0] );
+      }
+    }
+    else if( arg == "-points_per_block" && i + 1 < argc ) {
+      points_per_block = atof( argv[++i] );
+      if( points_per_block < 1 ) {
+        usage( argv[0] );
+      }
+    }
+    else if( arg[0] == '-' ) {
+      usage( argv[0] );
+    }
+    else {
+      files.push_back( arg );
+    }
+  }
+  if( files.size() != 2 ) {
+    usage( argv[0] );
+  }
+
+  const string infile   = files[0];
+  const string outfile  = files[1];
+  const string tmpfile  = outfile + ".tmp";
+
+  try {
+    int ncols = 3;
+    for( unsigned v = 0; v < vars.size(); v++ ) {
+      ncols += varColumns( vars[v] );
+      if( vars[v].size() >= PointBlockFile::VAR_NAME_LENGTH ) {
+        throw ProblemSetupException( "Variable name '" + vars[v] + "' is too long", __FILE__, __LINE__ );
+      }
+    }
+
+    //__________________________________
+    //  Pass 1: the text file, to the temporary file, and the bounds
+    ifstream source( infile.c_str() );
+    if( !source ) {
+      throw ProblemSetupException( "Failed to open points file '" + infile + "'", __FILE__, __LINE__ );
+    }
+    FILE* tmp = fopen( tmpfile.c_str(), "w+b" );
+    if( !tmp ) {
+      throw ProblemSetupException( "Failed to create '" + tmpfile + "'", __FILE__, __LINE__ );
+    }
+
+    double low[3]  = {  1e300,  1e300,  1e300 };
+    double high[3] = { -1e300, -1e300, -1e300 };
+    long   npoints = 0;
+
+    vector<double> rec( ncols );
+    while( source >> rec[0] >> rec[1] >> rec[2] ) {
+      for( int c = 3; c < ncols; c++ ) {
+        if( !( source >> rec[c] ) ) {
+          throw ProblemSetupException( "Failed while reading the columns of a point in '" + infile + "'",
+                                       __FILE__, __LINE__ );
+        }
+      }
+      for( int d = 0; d < 3; d++ ) {
+        low[d]  = min( low[d],  rec[d] );
+        high[d] = max( high[d], rec[d] );
+      }
+      writeOrDie( tmp, &rec[0], ncols * sizeof(double), tmpfile );
+      npoints++;
+    }
+    source.close();
+
+    if( npoints == 0 ) {
+      throw ProblemSetupException( "No points in '" + infile + "'", __FILE__, __LINE__ );
+    }
+
+    //__________________________________
+    //  The block grid: roughly cubical blocks of points_per_block points
+    if( nblocks[0] == 0 ) {
+      double extent[3];
+      double volume = 1;
+      int    ndims  = 0;
+      for( int d = 0; d < 3; d++ ) {
+        extent[d] = high[d] - low[d];
+        if( extent[d] > 0 ) {
+          volume *= extent[d];
+          ndims++;
+        }
+      }
+      double target = max( 1.0, npoints / points_per_block );
+      double edge   = ndims > 0 ? pow( volume / target, 1.0 / ndims ) : 1;
+      for( int d = 0; d < 3; d++ ) {
+        nblocks[d] = extent[d] > 0 ? max( 1, (int)( extent[d] / edge + 0.5 ) ) : 1;
+      }
+    }
+    const long total_blocks = (long)nblocks[0] * nblocks[1] * nblocks[2];
+
+    double scale[3];
+    for( int d = 0; d < 3; d++ ) {
+      scale[d] = high[d] > low[d] ? nblocks[d] / ( high[d] - low[d] ) : 0;
+    }
+
+    // the block of a record
+    auto blockOf = [&]( const double* r ) {
+      long b[3];
+      for( int d = 0; d < 3; d++ ) {
+        b[d] = min( nblocks[d] - 1, (int)( ( r[d] - low[d] ) * scale[d] ) );
+      }
+      return ( b[2] * nblocks[1] + b[1] ) * nblocks[0] + b[0];
+    };
+
+    //__________________________________
+    //  Pass 2: count the points and find the bounds of each block
+    vector<PointBlockFile::Block> grid_blocks( total_blocks );
+    for( long b = 0; b < total_blocks; b++ ) {
+      for( int d = 0; d < 3; d++ ) {
+        grid_blocks[b].low[d]  =  1e300;
+        grid_blocks[b].high[d] = -1e300;
+      }
+      grid_blocks[b].offset = 0;
+      grid_blocks[b].count  = 0;
+    }
+
+    const long chunk = 65536;
+    vector<double> records( chunk * ncols );
+
+    rewind( tmp );
+    for( long done = 0; done < npoints; ) {
+      long n = min( chunk, npoints - done );
+      if( fread( &records[0], sizeof(double) * ncols, n, tmp ) != (size_t)n ) {
+        throw ProblemSetupException( "Failed reading '" + tmpfile + "'", __FILE__, __LINE__ );
+      }
+      for( long i = 0; i < n; i++ ) {
+        const double* r = &records[i * ncols];
+        PointBlockFile::Block& block = grid_blocks[ blockOf( r ) ];
+        for( int d = 0; d < 3; d++ ) {
+          block.low[d]  = min( block.low[d],  r[d] );
+          block.high[d] = max( block.high[d], r[d] );
+        }
+        block.count++;
+      }
+      done += n;
+    }
+
+    // the non empty blocks, in grid order, and their place in the file
+    vector<long> block_index( total_blocks, -1 );
+    vector<PointBlockFile::Block> blocks;
+    for( long b = 0; b < total_blocks; b++ ) {
+      if( grid_blocks[b].count > 0 ) {
+        block_index[b] = blocks.size();
+        blocks.push_back( grid_blocks[b] );
+      }
+    }
+    grid_blocks.clear();
+
+    uint64_t offset = sizeof(PointBlockFile::Header) + vars.size() * PointBlockFile::VAR_NAME_LENGTH
+                    + blocks.size() * sizeof(PointBlockFile::Block);
+    for( unsigned b = 0; b < blocks.size(); b++ ) {
+      blocks[b].offset = offset;
+      offset += blocks[b].count * ncols * sizeof(double);
+    }
+
+    //__________________________________
+    //  The header and the index
+    FILE* dest = fopen( outfile.c_str(), "wb" );
+    if( !dest ) {
+      throw ProblemSetupException( "Failed to create '" + outfile + "'", __FILE__, __LINE__ );
+    }
+
+    PointBlockFile::Header header;
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, PointBlockFile::MAGIC, sizeof(header.magic) );
+    header.endian       = PointBlockFile::ENDIAN_MARKER;
+    header.numVars      = vars.size();
+    header.recordLength = ncols;
+    header.numPoints    = npoints;
+    header.numBlocks    = blocks.size();
+    for( int d = 0; d < 3; d++ ) {
+      header.low[d]  = low[d];
+      header.high[d] = high[d];
+    }
+    writeOrDie( dest, &header, sizeof(header), outfile );
+
+    for( unsigned v = 0; v < vars.size(); v++ ) {
+      char name[PointBlockFile::VAR_NAME_LENGTH];
+      memset( name, 0, sizeof(name) );
+      strncpy( name, vars[v].c_str(), sizeof(name) - 1 );
+      writeOrDie( dest, name, sizeof(name), outfile );
+    }
+    writeOrDie( dest, &blocks[0], blocks.size() * sizeof(PointBlockFile::Block), outfile );
+
+    //__________________________________
+    //  Pass 3: scatter the records to their blocks, through a buffer per
+    //  block (about 128 MB in all)
+    const long buffer_records = max( 1L, ( 16L * 1024 * 1024 ) / ( (long)blocks.size() * ncols ) );
+
+    vector<BlockWriter> writers( blocks.size() );
+    for( unsigned b = 0; b < blocks.size(); b++ ) {
+      writers[b].position = blocks[b].offset;
+    }
+
+    rewind( tmp );
+    for( long done = 0; done < npoints; ) {
+      long n = min( chunk, npoints - done );
+      if( fread( &records[0], sizeof(double) * ncols, n, tmp ) != (size_t)n ) {
+        throw ProblemSetupException( "Failed reading '" + tmpfile + "'", __FILE__, __LINE__ );
+      }
+      for( long i = 0; i < n; i++ ) {
+        const double* r = &records[i * ncols];
+        BlockWriter& writer = writers[ block_index[ blockOf( r ) ] ];
+        writer.buffer.insert( writer.buffer.end(), r, r + ncols );
+        if( (long)writer.buffer.size() >= buffer_records * ncols ) {
+          flush( dest, writer, outfile );
+        }
+      }
+      done += n;
+    }
+
+    for( unsigned b = 0; b < writers.size(); b++ ) {
+      flush( dest, writers[b], outfile );
+    }
+
+    fclose( tmp );
+    remove( tmpfile.c_str() );
+    if( fclose( dest ) != 0 ) {
+      throw ProblemSetupException( "Failed writing '" + outfile + "'", __FILE__, __LINE__ );
+    }
+
+    cout << "Wrote " << npoints << " points in " << blocks.size() << " blocks ("
+         << nblocks[0] << " x " << nblocks[1] << " x " << nblocks[2] << " grid) to " << outfile << "\n";
+
+  } catch( Exception& e ) {
+    cerr << "Caught exception: " << e.message() << '\n';
+    remove( tmpfile.c_str() );
+    return 1;
+  }
+  return 0;
+}
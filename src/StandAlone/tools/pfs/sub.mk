@@ -73,6 +73,13 @@ PROGRAM := $(SRCDIR)/rawToUniqueGrains
 
 include $(SCIRUN_SCRIPTS)/program.mk
 
+###############################################
+# ptsToBlocked
+SRCS    := $(SRCDIR)/ptsToBlocked.cc
+PROGRAM := $(SRCDIR)/ptsToBlocked
+
+include $(SCIRUN_SCRIPTS)/program.mk
+
 ###############################################
 # ImageFromGeom
 
@@ -0,0 +1,290 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+// Compares BatchedLU, for every dimension it is instantiated for, with LU,
+// the runtime sized solver DQMOM falls back to for the other dimensions.
+
+#include <CCA/Components/Arches/BatchedLU.h>
+#include <CCA/Components/Arches/LU.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace Uintah;
+
+namespace {
+
+enum Kind { Random, NearSingular, Pivoting, Permutation, ZeroRow, Padding, numKinds };
+
+const char* kindName[numKinds] = { "random", "near-singular", "pivoting", "permutation", "zero row", "padding" };
+
+std::mt19937 gen( 4711 );
+
+double uniform()
+{
+  return std::uniform_real_distribution<double>( -1.0, 1.0 )( gen );
+}
+
+// Fills lane l of A with a system of the given kind
+template <int DIM, int WIDTH>
+void fill( BatchedLU<DIM,WIDTH>& block, int l, Kind kind )
+{
+  for( int i = 0; i < DIM; ++i ) {
+    for( int j = 0; j < DIM; ++j ) {
+      block.A[i][j][l] = uniform();
+    }
+  }
+  switch( kind ) {
+  case NearSingular:
+    // the last row is nearly the first one
+    for( int j = 0; j < DIM; ++j ) {
+      block.A[DIM-1][j][l] = block.A[0][j][l] + 1e-9 * uniform();
+    }
+    break;
+  case Pivoting:
+    // the leading column is zero but for the last row, and the diagonal small:
+    // every column has to swap rows
+    for( int i = 0; i < DIM; ++i ) {
+      block.A[i][0][l] = ( i == DIM-1 ) ? 2.0 + uniform() : 0.0;
+      if( i > 0 ) {
+        block.A[i][i][l] = 1e-3 * uniform();
+      }
+    }
+    break;
+  case Permutation:
+    // reversed rows of a diagonal matrix: all pivots are in the wrong row
+    for( int i = 0; i < DIM; ++i ) {
+      for( int j = 0; j < DIM; ++j ) {
+        block.A[i][j][l] = ( i + j == DIM-1 ) ? 2.0 + uniform() : 0.0;
+      }
+    }
+    break;
+  case ZeroRow:
+    for( int j = 0; j < DIM; ++j ) {
+      block.A[DIM/2][j][l] = 0.0;
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+// Solves lane l with LU, returns the L_infinity norm of the solution
+template <int DIM, int WIDTH>
+double solveLU( const double A[DIM][DIM][WIDTH], const double rhs[DIM][WIDTH], int l,
+                double soln[DIM], bool& singular )
+{
+  LU lu( DIM );
+  double b[DIM];
+  for( int i = 0; i < DIM; ++i ) {
+    for( int j = 0; j < DIM; ++j ) {
+      lu( i, j ) = A[i][j][l];
+    }
+    b[i] = rhs[i][l];
+  }
+  lu.decompose();
+  lu.back_subs( b, soln );
+  singular = lu.isSingular();
+
+  double norm = 0.0;
+  for( int i = 0; i < DIM; ++i ) {
+    norm = std::max( norm, std::fabs( soln[i] ) );
+  }
+  return norm;
+}
+
+// One block of WIDTH systems of the given kinds (the last nlanes - WIDTH are padding)
+template <int DIM>
+int testBlock( const Kind kinds[], int nlanes )
+{
+  const int WIDTH = 8;
+  BatchedLU<DIM,WIDTH> block;
+  for( int l = 0; l < nlanes; ++l ) {
+    fill( block, l, kinds[l] );
+  }
+  for( int l = nlanes; l < WIDTH; ++l ) {
+    // garbage, overwritten by padLanes
+    for( int i = 0; i < DIM; ++i ) {
+      for( int j = 0; j < DIM; ++j ) {
+        block.A[i][j][l] = std::nan( "" );
+      }
+    }
+  }
+  block.padLanes( nlanes );
+
+  double Aorig[DIM][DIM][WIDTH];
+  double rhs[DIM][WIDTH];
+  double soln[DIM][WIDTH];
+  double res[DIM][WIDTH];
+  double norm[WIDTH];
+  std::copy( &block.A[0][0][0], &block.A[0][0][0] + DIM*DIM*WIDTH, &Aorig[0][0][0] );
+  for( int i = 0; i < DIM; ++i ) {
+    for( int l = 0; l < WIDTH; ++l ) {
+      rhs[i][l] = uniform();
+    }
+  }
+
+  block.decompose();
+  block.back_subs( rhs, soln );
+  BatchedLU<DIM,WIDTH>::getResidual( Aorig, rhs, soln, res );
+  BatchedLU<DIM,WIDTH>::getNorm( res, norm );
+
+  int errors = 0;
+  for( int l = 0; l < WIDTH; ++l ) {
+    const Kind kind = ( l < nlanes ) ? kinds[l] : Padding;
+
+    double x[DIM];
+    bool   singular;
+    const double xnorm = solveLU<DIM,WIDTH>( Aorig, rhs, l, x, singular );
+
+    // Both do the same arithmetic in the same order; allow for a different
+    // contraction into fused multiply-adds, amplified by the conditioning
+    const double tol = ( kind == NearSingular ) ? 1e-4 : 1e-10;
+    double diff = 0.0;
+    for( int i = 0; i < DIM; ++i ) {
+      diff = std::max( diff, std::fabs( soln[i][l] - x[i] ) );
+    }
+
+    bool ok = ( block.singular[l] == singular ) && ( singular == ( kind == ZeroRow ) )
+              && diff <= tol * std::max( 1.0, xnorm );
+    if( singular ) {
+      for( int i = 0; i < DIM; ++i ) {
+        ok = ok && soln[i][l] == 0.0;
+      }
+    } else {
+      // the residual is small relative to |A| |x|
+      double anorm = 0.0;
+      for( int i = 0; i < DIM; ++i ) {
+        for( int j = 0; j < DIM; ++j ) {
+          anorm = std::max( anorm, std::fabs( Aorig[i][j][l] ) );
+        }
+      }
+      ok = ok && norm[l] <= 1e-10 * DIM * std::max( 1.0, anorm * xnorm );
+    }
+
+    if( !ok ) {
+      std::cout << "Error: dimension " << DIM << ", lane " << l << " (" << kindName[kind]
+                << "): singular " << block.singular[l] << " (LU " << singular
+                << "), |x - x_LU| " << diff << ", |x_LU| " << xnorm
+                << ", |Ax - b| " << norm[l] << std::endl;
+      errors++;
+    }
+  }
+  return errors;
+}
+
+template <int DIM>
+int testDimension()
+{
+  if( !hasBatchedLU( DIM ) ) {
+    std::cout << "Error: no batched solver for dimension " << DIM << std::endl;
+    return 1;
+  }
+
+  int errors = 0;
+  const Kind mixed[8]   = { Random, NearSingular, Pivoting, Permutation, ZeroRow, Random, Pivoting, NearSingular };
+  const Kind random[8]  = { Random, Random, Random, Random, Random, Random, Random, Random };
+  for( int k = 0; k < 4; ++k ) {
+    errors += testBlock<DIM>( mixed, 8 );
+    errors += testBlock<DIM>( random, 8 );
+  }
+  // partially filled blocks, as at the end of a patch
+  errors += testBlock<DIM>( mixed, 5 );
+  errors += testBlock<DIM>( mixed, 1 );
+  return errors;
+}
+
+// The dimensions without a BatchedLU are solved with LU alone
+int testFallback( int dim )
+{
+  if( hasBatchedLU( dim ) ) {
+    std::cout << "Error: dimension " << dim << " unexpectedly has a batched solver" << std::endl;
+    return 1;
+  }
+
+  int errors = 0;
+  for( int k = 0; k < 8; ++k ) {
+    LU lu( dim ), A( dim );
+    std::vector<double> b( dim ), x( dim ), res( dim );
+    for( int i = 0; i < dim; ++i ) {
+      for( int j = 0; j < dim; ++j ) {
+        lu( i, j ) = A( i, j ) = ( k % 2 == 1 && j == 0 && i != dim-1 ) ? 0.0 : uniform();
+      }
+      b[i] = uniform();
+    }
+    lu.decompose();
+    lu.back_subs( &b[0], &x[0] );
+    A.getResidual( &b[0], &x[0], &res[0] );
+
+    double rnorm = 0.0, xnorm = 0.0;
+    for( int i = 0; i < dim; ++i ) {
+      rnorm = std::max( rnorm, std::fabs( res[i] ) );
+      xnorm = std::max( xnorm, std::fabs( x[i] ) );
+    }
+    if( lu.isSingular() || rnorm > 1e-10 * dim * std::max( 1.0, xnorm ) ) {
+      std::cout << "Error: fallback dimension " << dim << ", |Ax - b| " << rnorm << std::endl;
+      errors++;
+    }
+  }
+  return errors;
+}
+
+} // end anonymous namespace
+
+int main()
+{
+  int errors = 0;
+
+#define TEST_DIMENSION(DIM) errors += testDimension<DIM>();
+  BATCHEDLU_DIMENSIONS(TEST_DIMENSION)
+#undef TEST_DIMENSION
+
+  // DQMOM systems are (N_xi+1)*N_: up to six environments and four internal
+  // coordinates are batched, everything else falls back to LU
+  std::set<int> dqmom;
+  for( int N = 1; N <= 6; ++N ) {
+    for( int N_xi = 1; N_xi <= 4; ++N_xi ) {
+      dqmom.insert( ( N_xi + 1 ) * N );
+    }
+  }
+  for( int dim = 1; dim <= 40; ++dim ) {
+    if( dqmom.count( dim ) ) {
+      if( !hasBatchedLU( dim ) ) {
+        std::cout << "Error: no batched solver for DQMOM dimension " << dim << std::endl;
+        errors++;
+      }
+    } else {
+      errors += testFallback( dim );
+    }
+  }
+
+  if( errors == 0 ) {
+    std::cout << "All tests passed" << std::endl;
+  }
+  return errors == 0 ? 0 : 1;
+}
@@ -23,17 +23,22 @@
  */
 
 #include <testprograms/TestMatrix3/testmatrix3.h>
+#include <Core/Exceptions/InternalError.h>
 #include <Core/Math/Matrix3.h>
+#include <Core/Math/Matrix3Block.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cmath>
 #include <iostream>
+#include <vector>
 #include <unistd.h>
 
 void doMatrixSolvingTests(Suite& suite);
 void doEigenTests(Suite& suite);
 void doPolarDecompTests(Suite& suite);
 void doEigenPlaneTests(Suite& suite);
+void doMatrix3BlockTests(Suite& suite);
 
 void addSolveTests(Suite& suite, const std::string& test_name,
 	       const Uintah::Matrix3& M, const Uintah::Vector& rhs, bool exp_return,
@@ -136,15 +141,18 @@ SuiteTree* matrix3TestTree()
   Suite* eigenTests = new Suite("Eigen values/vectors");
   Suite* eigenPlaneTests = new Suite("Eigen plane values");
   Suite* polarDecompTests = new Suite("Polar Decomposition Tests");
+  Suite* blockTests = new Suite("Matrix3Block kernels");
 
   doMatrixSolvingTests(*solvingTests);
   doEigenTests(*eigenTests);
   doEigenPlaneTests(*eigenPlaneTests);
   doPolarDecompTests(*polarDecompTests);
+  doMatrix3BlockTests(*blockTests);
   matrix3Tests->addSuite(solvingTests);
   matrix3Tests->addSuite(eigenTests);
   matrix3Tests->addSuite(eigenPlaneTests);
   matrix3Tests->addSuite(polarDecompTests);
+  matrix3Tests->addSuite(blockTests);
 
   return matrix3Tests;
 
@@ -348,6 +356,119 @@ void doPolarDecompTests(Suite& suite)
 
 }
 
+bool equal_enough(const Uintah::Matrix3& A, const Uintah::Matrix3& B, double rel_scale)
+{
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      if (!equal_enough(A(i, j), B(i, j), rel_scale))
+        return false;
+    }
+  }
+  return true;
+}
+
+// The Matrix3Batch kernels against their Matrix3 counterparts, on a
+// batch of random tensors that is not a multiple of the block width, so
+// the last block is partly filled.  The lanes past the end of a block
+// must be left alone.
+void doMatrix3BlockTests(Suite& suite)
+{
+  using Uintah::Matrix3;
+  using Uintah::Matrix3Block;
+
+  Test* detTest      = suite.addTest("determinant");
+  Test* inverseTest  = suite.addTest("inverse");
+  Test* polarTest    = suite.addTest("polarDecompositionRMB");
+  Test* rotationTest = suite.addTest("polarRotationRMB");
+  Test* laneTest     = suite.addTest("lanes past n untouched");
+  Test* singularTest = suite.addTest("singular inverse throws");
+
+  const int    batch    = 5 * Matrix3Block::width + 7;
+  const double sentinel = 12345.0;
+
+  Matrix3 I;
+  I.Identity();
+
+  std::vector<Matrix3> F(batch);
+  for (int i = 0; i < batch; i++) {
+    // well away from singular, as the deformation gradients are
+    Matrix3 A(drand48() - 0.5, drand48() - 0.5, drand48() - 0.5,
+              drand48() - 0.5, drand48() - 0.5, drand48() - 0.5,
+              drand48() - 0.5, drand48() - 0.5, drand48() - 0.5);
+    F[i] = I + A;
+    if (F[i].Determinant() <= 0.1) {
+      F[i] = F[i] + I * 2.0;
+    }
+  }
+
+  for (int start = 0; start < batch; start += Matrix3Block::width) {
+    int n = std::min((int)Matrix3Block::width, batch - start);
+
+    Matrix3Block FB, inv, U, R, R2;
+    double det[Matrix3Block::width];
+    for (int c = 0; c < 9; c++) {
+      for (int l = 0; l < Matrix3Block::width; l++) {
+        FB.m[c][l] = inv.m[c][l] = U.m[c][l] = R.m[c][l] = R2.m[c][l] = sentinel;
+      }
+    }
+    for (int l = 0; l < Matrix3Block::width; l++) {
+      det[l] = sentinel;
+    }
+    for (int l = 0; l < n; l++) {
+      FB.set(l, F[start + l]);
+    }
+
+    Uintah::Matrix3Batch::determinant(FB, det, n);
+    Uintah::Matrix3Batch::inverse(FB, inv, n);
+    Uintah::Matrix3Batch::polarDecompositionRMB(FB, U, R, n);
+    Uintah::Matrix3Batch::polarRotationRMB(FB, R2, n);
+
+    for (int l = 0; l < n; l++) {
+      const Matrix3& A = F[start + l];
+      double scale = A.MaxAbsElem();
+
+      detTest->setResults(equal_enough(det[l], A.Determinant(), scale * scale * scale));
+
+      Matrix3 Ainv = A.Inverse();
+      inverseTest->setResults(equal_enough(inv.get(l), Ainv, Ainv.MaxAbsElem()));
+
+      Matrix3 Uref, Rref;
+      A.polarDecompositionRMB(Uref, Rref);
+      polarTest->setResults(equal_enough(U.get(l), Uref, scale) && equal_enough(R.get(l), Rref, 1.0));
+
+      Matrix3 Rrot;
+      A.polarRotationRMB(Rrot);
+      rotationTest->setResults(equal_enough(R2.get(l), Rrot, 1.0));
+    }
+
+    bool untouched = true;
+    for (int l = n; l < Matrix3Block::width; l++) {
+      untouched = untouched && det[l] == sentinel;
+      for (int c = 0; c < 9; c++) {
+        untouched = untouched && inv.m[c][l] == sentinel && U.m[c][l] == sentinel
+                              && R.m[c][l] == sentinel && R2.m[c][l] == sentinel;
+      }
+    }
+    laneTest->setResults(untouched);
+  }
+
+  // a singular tensor in the middle of a block
+  Matrix3Block S, Sinv;
+  int n = 3;
+  for (int l = 0; l < n; l++) {
+    S.set(l, F[l]);
+  }
+  S.set(1, Matrix3(1, 2, 3, 2, 4, 6, 0, 0, 1));
+  bool threw = false;
+  try {
+    Uintah::Matrix3Batch::inverse(S, Sinv, n);
+  }
+  catch (const Uintah::InternalError&) {
+    threw = true;
+  }
+  singularTest->setResults(threw);
+}
+
 void doEigenPlaneTests(Suite& suite)
 {  
   Test* eigenValueOrderTest = suite.addTest("e1 > e2");
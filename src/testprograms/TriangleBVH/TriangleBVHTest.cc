@@ -0,0 +1,237 @@
+/*
+ * The MIT License
+ *
+ * Copyright (c) 1997-2016 The University of Utah
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include <Core/GeometryPiece/TriangleBVH.h>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Uintah;
+
+// A closed mesh
+struct Mesh {
+  std::vector<Point>     points;
+  std::vector<IntVector> tris;
+};
+
+// The icosahedron, with each triangle split into four n times and the
+// vertices pushed out to the unit sphere.
+Mesh sphere(int n)
+{
+  const double t = ( 1.0 + std::sqrt( 5.0 ) ) / 2.0;
+  Mesh m;
+  double v[12][3] = { {-1, t, 0}, { 1, t, 0}, {-1,-t, 0}, { 1,-t, 0},
+                      { 0,-1, t}, { 0, 1, t}, { 0,-1,-t}, { 0, 1,-t},
+                      { t, 0,-1}, { t, 0, 1}, {-t, 0,-1}, {-t, 0, 1} };
+  int f[20][3] = { {0,11,5}, {0,5,1}, {0,1,7}, {0,7,10}, {0,10,11},
+                   {1,5,9}, {5,11,4}, {11,10,2}, {10,7,6}, {7,1,8},
+                   {3,9,4}, {3,4,2}, {3,2,6}, {3,6,8}, {3,8,9},
+                   {4,9,5}, {2,4,11}, {6,2,10}, {8,6,7}, {9,8,1} };
+  for( int i = 0; i < 12; i++ ) {
+    Vector p( v[i][0], v[i][1], v[i][2] );
+    m.points.push_back( Point( p / p.length() ) );
+  }
+  for( int i = 0; i < 20; i++ ) {
+    m.tris.push_back( IntVector( f[i][0], f[i][1], f[i][2] ) );
+  }
+
+  for( int level = 0; level < n; level++ ) {
+    std::vector<IntVector> tris;
+    for( unsigned i = 0; i < m.tris.size(); i++ ) {
+      int a = m.tris[i].x(), b = m.tris[i].y(), c = m.tris[i].z();
+      int ab = (int)m.points.size();
+      int bc = ab + 1;
+      int ca = ab + 2;
+      // edges shared by two triangles get two (coincident) vertices,
+      // the surface is still closed
+      Vector pab = ( m.points[a].asVector() + m.points[b].asVector() ) / 2.0;
+      Vector pbc = ( m.points[b].asVector() + m.points[c].asVector() ) / 2.0;
+      Vector pca = ( m.points[c].asVector() + m.points[a].asVector() ) / 2.0;
+      m.points.push_back( Point( pab / pab.length() ) );
+      m.points.push_back( Point( pbc / pbc.length() ) );
+      m.points.push_back( Point( pca / pca.length() ) );
+      tris.push_back( IntVector( a,  ab, ca ) );
+      tris.push_back( IntVector( b,  bc, ab ) );
+      tris.push_back( IntVector( c,  ca, bc ) );
+      tris.push_back( IntVector( ab, bc, ca ) );
+    }
+    m.tris = tris;
+  }
+  return m;
+}
+
+// A torus (not convex) with radii R and r, n x n quads.
+Mesh torus(double R, double r, int n)
+{
+  Mesh m;
+  for( int i = 0; i < n; i++ ) {
+    double u = 2 * M_PI * i / n;
+    for( int j = 0; j < n; j++ ) {
+      double v = 2 * M_PI * j / n;
+      m.points.push_back( Point( ( R + r * cos( v ) ) * cos( u ),
+                                 ( R + r * cos( v ) ) * sin( u ),
+                                 r * sin( v ) ) );
+    }
+  }
+  for( int i = 0; i < n; i++ ) {
+    for( int j = 0; j < n; j++ ) {
+      int a = i * n + j;
+      int b = ( ( i + 1 ) % n ) * n + j;
+      int c = ( ( i + 1 ) % n ) * n + ( j + 1 ) % n;
+      int d = i * n + ( j + 1 ) % n;
+      m.tris.push_back( IntVector( a, b, c ) );
+      m.tris.push_back( IntVector( a, c, d ) );
+    }
+  }
+  return m;
+}
+
+// Brute force: crossings of the ray from p in direction d with every
+// triangle.  Returns false if the ray passes near an edge or a vertex
+// (the count is ambiguous); sets onSurface if p is on a triangle.
+bool bruteCrossings(const Mesh& m, const Point& p, const Vector& d, int& crossings, bool& onSurface)
+{
+  crossings = 0;
+  onSurface = false;
+  for( unsigned i = 0; i < m.tris.size(); i++ ) {
+    const Point& v0 = m.points[ m.tris[i].x() ];
+    Vector e1 = m.points[ m.tris[i].y() ] - v0;
+    Vector e2 = m.points[ m.tris[i].z() ] - v0;
+    Vector n  = Cross( e1, e2 );
+
+    Vector pvec = Cross( d, e2 );
+    double det  = Dot( e1, pvec );
+    Vector tvec = p - v0;
+    if( std::fabs( det ) < 1.e-14 ) {
+      if( std::fabs( Dot( tvec, n ) ) / n.length() < 1.e-12 ) {
+        return false;
+      }
+      continue;
+    }
+    double u = Dot( tvec, pvec ) / det;
+    Vector qvec = Cross( tvec, e1 );
+    double v = Dot( d, qvec ) / det;
+    double t = Dot( e2, qvec ) / det;
+    if( u < -1.e-7 || v < -1.e-7 || u + v > 1 + 1.e-7 ) {
+      continue;
+    }
+    if( std::fabs( t ) < 1.e-12 ) {
+      onSurface = true;
+      return true;
+    }
+    if( t < 0 ) {
+      continue;
+    }
+    if( u < 1.e-7 || v < 1.e-7 || u + v > 1 - 1.e-7 ) {
+      return false;
+    }
+    crossings++;
+  }
+  return true;
+}
+
+// Brute force inside test, with random directions until one is clean.
+bool bruteInside(const Mesh& m, const Point& p, std::mt19937& gen)
+{
+  std::normal_distribution<double> normal;
+  for( int tries = 0; tries < 100; tries++ ) {
+    Vector d( normal( gen ), normal( gen ), normal( gen ) );
+    d /= d.length();
+    int  crossings;
+    bool onSurface;
+    if( bruteCrossings( m, p, d, crossings, onSurface ) ) {
+      return onSurface || crossings % 2 == 1;
+    }
+  }
+  return true;
+}
+
+// Compares inside(), inside(p, crossings) and insideBatch() with the
+// brute force test at random points around the mesh and at its vertices.
+int test(const char* name, const Mesh& m, int npoints)
+{
+  TriangleBVH bvh;
+  bvh.build( m.points, m.tris );
+
+  std::mt19937 gen( 12345 );
+  std::uniform_real_distribution<double> coord( -1.5, 1.5 );
+
+  std::vector<Point> points;
+  for( int i = 0; i < npoints; i++ ) {
+    points.push_back( Point( coord( gen ), coord( gen ), coord( gen ) ) );
+  }
+  // on the surface, and ambiguous for every ray
+  for( unsigned i = 0; i < m.points.size(); i += 7 ) {
+    points.push_back( m.points[i] );
+  }
+
+  std::vector<bool> batch;
+  bvh.insideBatch( points, batch );
+
+  int errors = 0;
+  for( unsigned i = 0; i < points.size(); i++ ) {
+    const Point& p = points[i];
+    bool expected  = ( i < (unsigned)npoints ) ? bruteInside( m, p, gen ) : true;
+
+    int  crossings;
+    bool in = bvh.inside( p, crossings );
+    // inside follows from the crossing count, off the surface
+    bool parity_ok = i >= (unsigned)npoints || crossings == -1 || in == ( crossings % 2 == 1 );
+
+    if( in != expected || bvh.inside( p ) != in || batch[i] != in || !parity_ok
+        || bvh.crossings( p ) != crossings ) {
+      std::cout << "Error " << name << ": point " << p << " brute force inside=" << expected
+                << " inside=" << in << " insideBatch=" << batch[i]
+                << " crossings=" << crossings << std::endl;
+      errors++;
+    }
+  }
+  std::cout << name << ": " << bvh.numTriangles() << " triangles, "
+            << bvh.numNodes() << " nodes, " << points.size() << " points, "
+            << errors << " errors" << std::endl;
+  return errors;
+}
+
+int main()
+{
+  int errors = 0;
+  errors += test( "sphere", sphere( 3 ), 20000 );
+  errors += test( "torus", torus( 1.0, 0.4, 48 ), 20000 );
+
+  // empty surface: nothing is inside
+  TriangleBVH empty;
+  empty.build( std::vector<Point>(), std::vector<IntVector>() );
+  std::vector<bool> batch;
+  empty.insideBatch( std::vector<Point>( 1, Point( 0, 0, 0 ) ), batch );
+  if( empty.inside( Point( 0, 0, 0 ) ) || batch[0] ) {
+    std::cout << "Error: point inside an empty surface" << std::endl;
+    errors++;
+  }
+
+  if( errors == 0 ) {
+    std::cout << "All tests passed" << std::endl;
+  }
+  return errors == 0 ? 0 : 1;
+}
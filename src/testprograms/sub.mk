@@ -38,7 +38,12 @@ SUBDIRS := \
         $(SRCDIR)/IteratorTest            \
         $(SRCDIR)/RegionTest              \
         $(SRCDIR)/CubeRootTest            \
-        $(SRCDIR)/PatchBVH
+        $(SRCDIR)/PatchBVH                \
+        $(SRCDIR)/TriangleBVH
+
+ifeq ($(BUILD_ARCHES),yes)
+  SUBDIRS += $(SRCDIR)/BatchedLU
+endif
 
 include $(SCIRUN_SCRIPTS)/recurse.mk
 